@@ -25,6 +25,10 @@ void FPLATEAUCityObjectGroupDetails::CustomizeDetails(IDetailLayoutBuilder& Deta
     auto& CityObjectGroupCategory = DetailBuilder.EditCategory("PLATEAU", FText::GetEmpty(), ECategoryPriority::Important);
     DetailBuilder.GetObjectsBeingCustomized(ObjectsBeingCustomized);
     TWeakObjectPtr<UPLATEAUCityObjectGroup> CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(ObjectsBeingCustomized[0]);
+    // 属性情報はバイナリ形式で保持しているため、表示用のJsonは一度だけ作成
+    const FText SerializedCityObjectsText = CityObjectGroup.IsValid()
+        ? FText::FromString(CityObjectGroup->GetSerializedCityObjectsJson())
+        : FText::GetEmpty();
 
     CityObjectGroupCategory.AddCustomRow(FText::FromString("CityObjectGroup")).WholeRowContent()
     [
@@ -37,9 +41,7 @@ void FPLATEAUCityObjectGroupDetails::CustomizeDetails(IDetailLayoutBuilder& Deta
                 SNew(SBox).MaxDesiredHeight(TextBoxDesiredHeight).MinDesiredHeight(TextBoxDesiredHeight)
                 [
                     SNew(SMultiLineEditableTextBox)
-                    .Text_Lambda([CityObjectGroup] {
-                        return FText::FromString(CityObjectGroup->SerializedCityObjects);
-                    })
+                    .Text(SerializedCityObjectsText)
                     .IsReadOnly(true)
                 ]
             ]
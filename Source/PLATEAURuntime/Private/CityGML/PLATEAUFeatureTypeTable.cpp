@@ -0,0 +1,79 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "CityGML/PLATEAUFeatureTypeTable.h"
+#include "Algo/StableSort.h"
+
+#include <citygml/citymodel.h>
+#include <citygml/cityobject.h>
+
+namespace {
+    void CollectCityObjectsRecursive(const citygml::CityObject& CityObject, TArray<const citygml::CityObject*>& OutCityObjects) {
+        OutCityObjects.Add(&CityObject);
+        for (unsigned int i = 0; i < CityObject.getChildCityObjectsCount(); ++i) {
+            CollectCityObjectsRecursive(CityObject.getChildCityObject(i), OutCityObjects);
+        }
+    }
+
+    // memcmpと同じくバイトを符号なしとして比較します
+    int32 CompareBytes(const ANSICHAR* A, const int32 ALength, const ANSICHAR* B, const int32 BLength) {
+        const int32 Result = FMemory::Memcmp(A, B, FMath::Min(ALength, BLength));
+        if (Result != 0)
+            return Result;
+        return ALength - BLength;
+    }
+}
+
+FPLATEAUFeatureTypeTable FPLATEAUFeatureTypeTable::Create(const citygml::CityModel& CityModel) {
+    TArray<const citygml::CityObject*> CityObjects;
+    for (const auto& RootCityObject : CityModel.getRootCityObjects()) {
+        CollectCityObjectsRecursive(*RootCityObject, CityObjects);
+    }
+
+    // 先に見つかったものを優先するため安定ソート
+    Algo::StableSort(CityObjects, [](const citygml::CityObject* A, const citygml::CityObject* B) {
+        const auto& AId = A->getId();
+        const auto& BId = B->getId();
+        return CompareBytes(AId.data(), static_cast<int32>(AId.size()), BId.data(), static_cast<int32>(BId.size())) < 0;
+        });
+
+    FPLATEAUFeatureTypeTable Table;
+    Table.GmlIDEnds.Reserve(CityObjects.Num());
+    Table.Types.Reserve(CityObjects.Num());
+    const std::string* PreviousId = nullptr;
+    for (const auto CityObject : CityObjects) {
+        const auto& Id = CityObject->getId();
+        if (PreviousId != nullptr && *PreviousId == Id)
+            continue;
+        PreviousId = &Id;
+
+        Table.GmlIDBytes.Append(reinterpret_cast<const uint8*>(Id.data()), static_cast<int32>(Id.size()));
+        Table.GmlIDEnds.Add(Table.GmlIDBytes.Num());
+        Table.Types.Add(static_cast<int64>(CityObject->getType()));
+    }
+    Table.GmlIDBytes.Shrink();
+    return Table;
+}
+
+bool FPLATEAUFeatureTypeTable::TryGetType(const FString& GmlID, int64& OutType) const {
+    if (Types.Num() != GmlIDEnds.Num())
+        return false;
+
+    const FTCHARToUTF8 Utf8(*GmlID);
+    const auto Bytes = reinterpret_cast<const ANSICHAR*>(GmlIDBytes.GetData());
+    int32 Low = 0;
+    int32 High = GmlIDEnds.Num();
+    while (Low < High) {
+        const int32 Middle = Low + (High - Low) / 2;
+        const int32 Begin = Middle == 0 ? 0 : GmlIDEnds[Middle - 1];
+        const int32 Result = CompareBytes(Bytes + Begin, GmlIDEnds[Middle] - Begin, Utf8.Get(), Utf8.Length());
+        if (Result == 0) {
+            OutType = Types[Middle];
+            return true;
+        }
+        if (Result < 0)
+            Low = Middle + 1;
+        else
+            High = Middle;
+    }
+    return false;
+}
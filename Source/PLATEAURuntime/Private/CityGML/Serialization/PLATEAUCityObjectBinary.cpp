@@ -0,0 +1,492 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
+#include "CityGML/Serialization/PLATEAUCityObjectDeserialization.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "Serialization/JsonWriter.h"
+
+namespace {
+    constexpr const TCHAR* AttributeTypeNames[] = {
+        TEXT("String"), TEXT("Double"), TEXT("Integer"), TEXT("Date"), TEXT("Uri"), TEXT("Measure"), TEXT("AttributeSets"), TEXT("Boolean")
+    };
+
+    int64 AlignSection(const int64 Offset) {
+        return Align(Offset, 8);
+    }
+
+    bool IsIntegerType(const EPLATEAUAttributeType Type) {
+        return Type == EPLATEAUAttributeType::Integer || Type == EPLATEAUAttributeType::Boolean;
+    }
+
+    bool IsNumberType(const EPLATEAUAttributeType Type) {
+        return Type == EPLATEAUAttributeType::Double || Type == EPLATEAUAttributeType::Measure;
+    }
+
+    /**
+     * @brief 各セクションの先頭オフセット
+     */
+    struct FLayout {
+        int64 OutsideChildren;
+        int64 StringEnds;
+        int64 StringBytes;
+        int64 Objects;
+        int64 AttributeKeys;
+        int64 AttributeTypes;
+        int64 AttributeRefs;
+        int64 AttributeCounts;
+        int64 AttributeNumbers;
+        int64 Total;
+
+        explicit FLayout(const FPLATEAUCityObjectBinary::FHeader& Header) {
+            const int64 AttributeCount = Header.AttributeCount;
+            OutsideChildren = AlignSection(sizeof(FPLATEAUCityObjectBinary::FHeader));
+            StringEnds = AlignSection(OutsideChildren + sizeof(int32) * static_cast<int64>(Header.OutsideChildrenCount));
+            StringBytes = AlignSection(StringEnds + sizeof(int32) * static_cast<int64>(Header.StringCount));
+            Objects = AlignSection(StringBytes + Header.StringBytes);
+            AttributeKeys = AlignSection(Objects + sizeof(FPLATEAUCityObjectBinary::FObjectRecord) * static_cast<int64>(Header.ObjectCount));
+            AttributeTypes = AlignSection(AttributeKeys + sizeof(int32) * AttributeCount);
+            AttributeRefs = AlignSection(AttributeTypes + AttributeCount);
+            AttributeCounts = AlignSection(AttributeRefs + sizeof(int32) * AttributeCount);
+            AttributeNumbers = AlignSection(AttributeCounts + sizeof(int32) * AttributeCount);
+            Total = AttributeNumbers + sizeof(double) * AttributeCount;
+        }
+    };
+
+    /**
+     * @brief 文字列の重複を除きながらテーブルを作成します。
+     */
+    class FWriter {
+    public:
+        int32 AddString(const FString& String) {
+            if (const auto Found = StringToIndex.Find(String))
+                return *Found;
+
+            const FTCHARToUTF8 Utf8(*String);
+            StringBytes.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+            const int32 Index = StringEnds.Add(StringBytes.Num());
+            StringToIndex.Add(String, Index);
+            return Index;
+        }
+
+        // 子は親のレコードの後に連続して格納する
+        int32 AddObjects(const TArray<FPLATEAUCityObject>& CityObjects) {
+            const int32 First = Objects.AddZeroed(CityObjects.Num());
+            for (int32 i = 0; i < CityObjects.Num(); ++i) {
+                const auto& CityObject = CityObjects[i];
+                const int32 GmlID = AddString(CityObject.GmlID);
+                const int32 FirstAttribute = AddAttributes(CityObject.Attributes);
+                const int32 FirstChild = AddObjects(CityObject.Children);
+
+                auto& Record = Objects[First + i];
+                Record.GmlID = GmlID;
+                Record.PrimaryIndex = CityObject.CityObjectIndex.PrimaryIndex;
+                Record.AtomicIndex = CityObject.CityObjectIndex.AtomicIndex;
+                Record.Type = static_cast<int32>(CityObject.Type);
+                Record.FirstAttribute = FirstAttribute;
+                Record.AttributeCount = CityObject.Attributes.AttributeMap.Num();
+                Record.FirstChild = FirstChild;
+                Record.ChildCount = CityObject.Children.Num();
+            }
+            return First;
+        }
+
+        // 入れ子の属性は親の属性の後に連続して格納する
+        int32 AddAttributes(const FPLATEAUAttributeMap& AttributeMap) {
+            const int32 Count = AttributeMap.AttributeMap.Num();
+            const int32 First = AttributeKeys.AddZeroed(Count);
+            AttributeTypes.AddZeroed(Count);
+            AttributeRefs.AddZeroed(Count);
+            AttributeCounts.AddZeroed(Count);
+            AttributeNumbers.AddZeroed(Count);
+
+            int32 Attribute = First;
+            for (const auto& [Key, Value] : AttributeMap.AttributeMap) {
+                AttributeKeys[Attribute] = AddString(Key);
+                AttributeTypes[Attribute] = static_cast<uint8>(Value.Type);
+                if (Value.Type == EPLATEAUAttributeType::AttributeSets) {
+                    if (Value.Attributes.IsValid()) {
+                        const int32 NestedCount = Value.Attributes->AttributeMap.Num();
+                        const int32 NestedFirst = AddAttributes(*Value.Attributes);
+                        AttributeRefs[Attribute] = NestedFirst;
+                        AttributeCounts[Attribute] = NestedCount;
+                    } else {
+                        AttributeRefs[Attribute] = AttributeKeys.Num();
+                    }
+                } else {
+                    AttributeRefs[Attribute] = AddString(Value.StringValue);
+                    AttributeNumbers[Attribute] = IsIntegerType(Value.Type) ? Value.IntValue : Value.DoubleValue;
+                }
+                ++Attribute;
+            }
+            return First;
+        }
+
+        void Write(const int32 OutsideParent, const TArray<int32>& OutsideChildren, const int32 RootCount, TArray<uint8>& OutBytes) const {
+            FPLATEAUCityObjectBinary::FHeader Header;
+            Header.Magic = FPLATEAUCityObjectBinary::Magic;
+            Header.Version = FPLATEAUCityObjectBinary::Version;
+            Header.StringCount = StringEnds.Num();
+            Header.StringBytes = StringBytes.Num();
+            Header.ObjectCount = Objects.Num();
+            Header.RootCount = RootCount;
+            Header.AttributeCount = AttributeKeys.Num();
+            Header.OutsideParent = OutsideParent;
+            Header.OutsideChildrenCount = OutsideChildren.Num();
+            Header.Reserved = 0;
+
+            const FLayout Layout(Header);
+            OutBytes.SetNumZeroed(Layout.Total);
+            uint8* Data = OutBytes.GetData();
+            FMemory::Memcpy(Data, &Header, sizeof(Header));
+            FMemory::Memcpy(Data + Layout.OutsideChildren, OutsideChildren.GetData(), OutsideChildren.Num() * sizeof(int32));
+            FMemory::Memcpy(Data + Layout.StringEnds, StringEnds.GetData(), StringEnds.Num() * sizeof(int32));
+            FMemory::Memcpy(Data + Layout.StringBytes, StringBytes.GetData(), StringBytes.Num());
+            FMemory::Memcpy(Data + Layout.Objects, Objects.GetData(), Objects.Num() * sizeof(FPLATEAUCityObjectBinary::FObjectRecord));
+            FMemory::Memcpy(Data + Layout.AttributeKeys, AttributeKeys.GetData(), AttributeKeys.Num() * sizeof(int32));
+            FMemory::Memcpy(Data + Layout.AttributeTypes, AttributeTypes.GetData(), AttributeTypes.Num());
+            FMemory::Memcpy(Data + Layout.AttributeRefs, AttributeRefs.GetData(), AttributeRefs.Num() * sizeof(int32));
+            FMemory::Memcpy(Data + Layout.AttributeCounts, AttributeCounts.GetData(), AttributeCounts.Num() * sizeof(int32));
+            FMemory::Memcpy(Data + Layout.AttributeNumbers, AttributeNumbers.GetData(), AttributeNumbers.Num() * sizeof(double));
+        }
+
+    private:
+        TMap<FString, int32, FDefaultSetAllocator, TPLATEAUCaseSensitiveStringKeyFuncs<int32>> StringToIndex;
+        TArray<int32> StringEnds;
+        TArray<uint8> StringBytes;
+        TArray<FPLATEAUCityObjectBinary::FObjectRecord> Objects;
+        TArray<int32> AttributeKeys;
+        TArray<uint8> AttributeTypes;
+        TArray<int32> AttributeRefs;
+        TArray<int32> AttributeCounts;
+        TArray<double> AttributeNumbers;
+    };
+}
+
+void FPLATEAUCityObjectBinary::Write(const TArray<FPLATEAUCityObject>& RootCityObjects, const FString& OutsideParent,
+    const TArray<FString>& OutsideChildren, TArray<uint8>& OutBytes) {
+    FWriter Writer;
+    Writer.AddObjects(RootCityObjects);
+
+    const int32 OutsideParentString = OutsideParent.IsEmpty() ? INDEX_NONE : Writer.AddString(OutsideParent);
+    TArray<int32> OutsideChildrenStrings;
+    for (const auto& OutsideChild : OutsideChildren) {
+        OutsideChildrenStrings.Add(Writer.AddString(OutsideChild));
+    }
+
+    Writer.Write(OutsideParentString, OutsideChildrenStrings, RootCityObjects.Num(), OutBytes);
+}
+
+bool FPLATEAUCityObjectBinary::FromJson(const FString& SerializedCityObjects, TArray<uint8>& OutBytes) {
+    TArray<FPLATEAUCityObject> RootCityObjects;
+    FString OutsideParent;
+    TArray<FString> OutsideChildren;
+    FPLATEAUCityObjectDeserialization Deserializer;
+    if (!Deserializer.DeserializeCityObjects(SerializedCityObjects, RootCityObjects, OutsideParent, OutsideChildren))
+        return false;
+
+    Write(RootCityObjects, OutsideParent, OutsideChildren, OutBytes);
+    return true;
+}
+
+FPLATEAUCityObjectBinary::FPLATEAUCityObjectBinary(const TConstArrayView<uint8> InBytes) {
+    const auto InHeader = GetHeader(InBytes);
+    if (InHeader == nullptr)
+        return;
+
+    const uint8* Data = InBytes.GetData();
+    if (InHeader->StringCount < 0 || InHeader->StringBytes < 0 || InHeader->ObjectCount < 0 || InHeader->AttributeCount < 0 ||
+        InHeader->RootCount < 0 || InHeader->ObjectCount < InHeader->RootCount || InHeader->OutsideChildrenCount < 0)
+        return;
+
+    const FLayout Layout(*InHeader);
+    if (InBytes.Num() < Layout.Total)
+        return;
+
+    const auto InStringEnds = reinterpret_cast<const int32*>(Data + Layout.StringEnds);
+    const auto InObjects = reinterpret_cast<const FObjectRecord*>(Data + Layout.Objects);
+    const auto InAttributeKeys = reinterpret_cast<const int32*>(Data + Layout.AttributeKeys);
+    const auto InAttributeTypes = Data + Layout.AttributeTypes;
+    const auto InAttributeRefs = reinterpret_cast<const int32*>(Data + Layout.AttributeRefs);
+    const auto InAttributeCounts = reinterpret_cast<const int32*>(Data + Layout.AttributeCounts);
+    const auto InOutsideChildren = reinterpret_cast<const int32*>(Data + Layout.OutsideChildren);
+
+    // 範囲外を参照しないよう全レコードを検証する
+    const auto IsValidString = [InHeader](const int32 String) {
+        return 0 <= String && String < InHeader->StringCount;
+    };
+    const auto IsValidRange = [](const int32 First, const int32 Count, const int32 Num) {
+        return 0 <= First && 0 <= Count && First <= Num - Count;
+    };
+
+    int32 PreviousEnd = 0;
+    for (int32 i = 0; i < InHeader->StringCount; ++i) {
+        if (InStringEnds[i] < PreviousEnd || InHeader->StringBytes < InStringEnds[i])
+            return;
+        PreviousEnd = InStringEnds[i];
+    }
+
+    if (InHeader->OutsideParent != INDEX_NONE && !IsValidString(InHeader->OutsideParent))
+        return;
+
+    for (int32 i = 0; i < InHeader->OutsideChildrenCount; ++i) {
+        if (!IsValidString(InOutsideChildren[i]))
+            return;
+    }
+
+    for (int32 i = 0; i < InHeader->ObjectCount; ++i) {
+        const auto& Record = InObjects[i];
+        if (!IsValidString(Record.GmlID) ||
+            !IsValidRange(Record.FirstAttribute, Record.AttributeCount, InHeader->AttributeCount) ||
+            !IsValidRange(Record.FirstChild, Record.ChildCount, InHeader->ObjectCount) ||
+            (0 < Record.ChildCount && Record.FirstChild <= i))
+            return;
+    }
+
+    for (int32 i = 0; i < InHeader->AttributeCount; ++i) {
+        if (!IsValidString(InAttributeKeys[i]) || static_cast<int32>(EPLATEAUAttributeType::Boolean) < InAttributeTypes[i])
+            return;
+
+        if (static_cast<EPLATEAUAttributeType>(InAttributeTypes[i]) == EPLATEAUAttributeType::AttributeSets) {
+            if (!IsValidRange(InAttributeRefs[i], InAttributeCounts[i], InHeader->AttributeCount) ||
+                (0 < InAttributeCounts[i] && InAttributeRefs[i] <= i))
+                return;
+        } else if (!IsValidString(InAttributeRefs[i])) {
+            return;
+        }
+    }
+
+    Bind(Data);
+}
+
+FPLATEAUCityObjectBinary FPLATEAUCityObjectBinary::FromValidatedBytes(const TConstArrayView<uint8> InBytes) {
+    FPLATEAUCityObjectBinary Binary;
+    if (const auto InHeader = GetHeader(InBytes); InHeader != nullptr && FLayout(*InHeader).Total <= InBytes.Num())
+        Binary.Bind(InBytes.GetData());
+    return Binary;
+}
+
+const FPLATEAUCityObjectBinary::FHeader* FPLATEAUCityObjectBinary::GetHeader(const TConstArrayView<uint8> InBytes) {
+    if (InBytes.Num() < static_cast<int32>(sizeof(FHeader)))
+        return nullptr;
+
+    const auto InHeader = reinterpret_cast<const FHeader*>(InBytes.GetData());
+    if (InHeader->Magic != Magic || InHeader->Version != Version)
+        return nullptr;
+    return InHeader;
+}
+
+void FPLATEAUCityObjectBinary::Bind(const uint8* Data) {
+    Header = reinterpret_cast<const FHeader*>(Data);
+    const FLayout Layout(*Header);
+    OutsideChildren = reinterpret_cast<const int32*>(Data + Layout.OutsideChildren);
+    StringEnds = reinterpret_cast<const int32*>(Data + Layout.StringEnds);
+    StringBytes = reinterpret_cast<const ANSICHAR*>(Data + Layout.StringBytes);
+    Objects = reinterpret_cast<const FObjectRecord*>(Data + Layout.Objects);
+    AttributeKeys = reinterpret_cast<const int32*>(Data + Layout.AttributeKeys);
+    AttributeTypes = Data + Layout.AttributeTypes;
+    AttributeRefs = reinterpret_cast<const int32*>(Data + Layout.AttributeRefs);
+    AttributeCounts = reinterpret_cast<const int32*>(Data + Layout.AttributeCounts);
+    AttributeNumbers = Data + Layout.AttributeNumbers;
+}
+
+int32 FPLATEAUCityObjectBinary::GetObjectCount() const {
+    return Header != nullptr ? Header->ObjectCount : 0;
+}
+
+int32 FPLATEAUCityObjectBinary::GetRootCount() const {
+    return Header != nullptr ? Header->RootCount : 0;
+}
+
+FString FPLATEAUCityObjectBinary::GetOutsideParent() const {
+    if (Header == nullptr || Header->OutsideParent == INDEX_NONE)
+        return FString();
+    return GetString(Header->OutsideParent);
+}
+
+TArray<FString> FPLATEAUCityObjectBinary::GetOutsideChildren() const {
+    TArray<FString> Result;
+    if (Header == nullptr)
+        return Result;
+
+    Result.Reserve(Header->OutsideChildrenCount);
+    for (int32 i = 0; i < Header->OutsideChildrenCount; ++i) {
+        Result.Add(GetString(OutsideChildren[i]));
+    }
+    return Result;
+}
+
+int32 FPLATEAUCityObjectBinary::FindByIndex(const FPLATEAUCityObjectIndex& Index) const {
+    for (int32 i = 0; i < GetObjectCount(); ++i) {
+        if (Objects[i].PrimaryIndex == Index.PrimaryIndex && Objects[i].AtomicIndex == Index.AtomicIndex)
+            return i;
+    }
+    return INDEX_NONE;
+}
+
+int32 FPLATEAUCityObjectBinary::FindByGmlID(const FString& GmlID) const {
+    const FTCHARToUTF8 Utf8(*GmlID);
+    for (int32 i = 0; i < GetObjectCount(); ++i) {
+        if (EqualsString(Objects[i].GmlID, Utf8.Get(), Utf8.Length()))
+            return i;
+    }
+    return INDEX_NONE;
+}
+
+FString FPLATEAUCityObjectBinary::GetGmlID(const int32 Object) const {
+    return GetString(Objects[Object].GmlID);
+}
+
+FPLATEAUCityObjectIndex FPLATEAUCityObjectBinary::GetCityObjectIndex(const int32 Object) const {
+    return FPLATEAUCityObjectIndex(Objects[Object].PrimaryIndex, Objects[Object].AtomicIndex);
+}
+
+EPLATEAUCityObjectsType FPLATEAUCityObjectBinary::GetType(const int32 Object) const {
+    return static_cast<EPLATEAUCityObjectsType>(Objects[Object].Type);
+}
+
+int32 FPLATEAUCityObjectBinary::GetChildCount(const int32 Object) const {
+    return Objects[Object].ChildCount;
+}
+
+int32 FPLATEAUCityObjectBinary::GetChild(const int32 Object, const int32 ChildIndex) const {
+    return Objects[Object].FirstChild + ChildIndex;
+}
+
+bool FPLATEAUCityObjectBinary::TryGetAttribute(const int32 Object, const FString& Key, FPLATEAUAttributeValue& OutValue) const {
+    const FTCHARToUTF8 Utf8(*Key);
+    const auto& Record = Objects[Object];
+    for (int32 i = Record.FirstAttribute; i < Record.FirstAttribute + Record.AttributeCount; ++i) {
+        if (EqualsString(AttributeKeys[i], Utf8.Get(), Utf8.Length())) {
+            OutValue = GetAttributeValue(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+FPLATEAUCityObject FPLATEAUCityObjectBinary::ToCityObject(const int32 Object) const {
+    const auto& Record = Objects[Object];
+    FPLATEAUCityObject CityObject;
+    CityObject.GmlID = GetString(Record.GmlID);
+    CityObject.CityObjectIndex = FPLATEAUCityObjectIndex(Record.PrimaryIndex, Record.AtomicIndex);
+    CityObject.Type = static_cast<EPLATEAUCityObjectsType>(Record.Type);
+    GetAttributeMap(Record.FirstAttribute, Record.AttributeCount, CityObject.Attributes);
+
+    CityObject.Children.Reserve(Record.ChildCount);
+    for (int32 i = 0; i < Record.ChildCount; ++i) {
+        CityObject.Children.Add(ToCityObject(Record.FirstChild + i));
+    }
+    return CityObject;
+}
+
+void FPLATEAUCityObjectBinary::ToCityObjects(TArray<FPLATEAUCityObject>& OutRootCityObjects) const {
+    OutRootCityObjects.Reserve(OutRootCityObjects.Num() + GetRootCount());
+    for (int32 i = 0; i < GetRootCount(); ++i) {
+        OutRootCityObjects.Add(ToCityObject(i));
+    }
+}
+
+FString FPLATEAUCityObjectBinary::ToJson() const {
+    FString SerializedCityObjects;
+    if (Header == nullptr)
+        return SerializedCityObjects;
+
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SerializedCityObjects);
+
+    TFunction<void(int32, int32)> WriteAttributes = [&](const int32 FirstAttribute, const int32 AttributeCount) {
+        for (int32 i = FirstAttribute; i < FirstAttribute + AttributeCount; ++i) {
+            Writer->WriteObjectStart();
+            Writer->WriteValue(plateau::CityObjectGroup::KeyFieldName, GetString(AttributeKeys[i]));
+            Writer->WriteValue(plateau::CityObjectGroup::TypeFieldName, FString(AttributeTypeNames[AttributeTypes[i]]));
+            if (static_cast<EPLATEAUAttributeType>(AttributeTypes[i]) == EPLATEAUAttributeType::AttributeSets) {
+                Writer->WriteArrayStart(plateau::CityObjectGroup::ValueFieldName);
+                WriteAttributes(AttributeRefs[i], AttributeCounts[i]);
+                Writer->WriteArrayEnd();
+            } else {
+                Writer->WriteValue(plateau::CityObjectGroup::ValueFieldName, GetString(AttributeRefs[i]));
+            }
+            Writer->WriteObjectEnd();
+        }
+    };
+
+    TFunction<void(int32)> WriteObject = [&](const int32 Object) {
+        const auto& Record = Objects[Object];
+        Writer->WriteObjectStart();
+        Writer->WriteValue(plateau::CityObjectGroup::GmlIdFieldName, GetString(Record.GmlID));
+        Writer->WriteArrayStart(plateau::CityObjectGroup::CityObjectIndexFieldName);
+        Writer->WriteValue(Record.PrimaryIndex);
+        Writer->WriteValue(Record.AtomicIndex);
+        Writer->WriteArrayEnd();
+        Writer->WriteValue(plateau::CityObjectGroup::CityObjectTypeFieldName,
+            plateau::CityObject::CityObjectsTypeToString(static_cast<EPLATEAUCityObjectsType>(Record.Type)));
+        Writer->WriteArrayStart(plateau::CityObjectGroup::AttributesFieldName);
+        WriteAttributes(Record.FirstAttribute, Record.AttributeCount);
+        Writer->WriteArrayEnd();
+        if (0 < Record.ChildCount) {
+            Writer->WriteArrayStart(plateau::CityObjectGroup::ChildrenFieldName);
+            for (int32 i = 0; i < Record.ChildCount; ++i) {
+                WriteObject(Record.FirstChild + i);
+            }
+            Writer->WriteArrayEnd();
+        }
+        Writer->WriteObjectEnd();
+    };
+
+    Writer->WriteObjectStart();
+    Writer->WriteValue(plateau::CityObjectGroup::OutsideParentFieldName, GetOutsideParent());
+    Writer->WriteArrayStart(plateau::CityObjectGroup::OutsideChildrenFieldName);
+    for (const auto& OutsideChild : GetOutsideChildren()) {
+        Writer->WriteValue(OutsideChild);
+    }
+    Writer->WriteArrayEnd();
+    Writer->WriteArrayStart(plateau::CityObjectGroup::CityObjectsFieldName);
+    for (int32 i = 0; i < Header->RootCount; ++i) {
+        WriteObject(i);
+    }
+    Writer->WriteArrayEnd();
+    Writer->WriteObjectEnd();
+    Writer->Close();
+    return SerializedCityObjects;
+}
+
+FString FPLATEAUCityObjectBinary::GetString(const int32 String) const {
+    const int32 Start = String == 0 ? 0 : StringEnds[String - 1];
+    const FUTF8ToTCHAR Converted(StringBytes + Start, StringEnds[String] - Start);
+    return FString(Converted.Length(), Converted.Get());
+}
+
+bool FPLATEAUCityObjectBinary::EqualsString(const int32 String, const ANSICHAR* Utf8, const int32 Length) const {
+    const int32 Start = String == 0 ? 0 : StringEnds[String - 1];
+    return StringEnds[String] - Start == Length && FMemory::Memcmp(StringBytes + Start, Utf8, Length) == 0;
+}
+
+double FPLATEAUCityObjectBinary::GetAttributeNumber(const int32 Attribute) const {
+    double Number;
+    FMemory::Memcpy(&Number, AttributeNumbers + sizeof(double) * Attribute, sizeof(double));
+    return Number;
+}
+
+void FPLATEAUCityObjectBinary::GetAttributeMap(const int32 FirstAttribute, const int32 AttributeCount, FPLATEAUAttributeMap& OutAttributeMap) const {
+    OutAttributeMap.AttributeMap.Reserve(AttributeCount);
+    for (int32 i = FirstAttribute; i < FirstAttribute + AttributeCount; ++i) {
+        OutAttributeMap.AttributeMap.Add(GetString(AttributeKeys[i]), GetAttributeValue(i));
+    }
+}
+
+FPLATEAUAttributeValue FPLATEAUCityObjectBinary::GetAttributeValue(const int32 Attribute) const {
+    FPLATEAUAttributeValue Value;
+    Value.Type = static_cast<EPLATEAUAttributeType>(AttributeTypes[Attribute]);
+    if (Value.Type == EPLATEAUAttributeType::AttributeSets) {
+        Value.Attributes = MakeShared<FPLATEAUAttributeMap>();
+        GetAttributeMap(AttributeRefs[Attribute], AttributeCounts[Attribute], *Value.Attributes);
+        return Value;
+    }
+
+    Value.StringValue = GetString(AttributeRefs[Attribute]);
+    if (IsIntegerType(Value.Type)) {
+        Value.IntValue = static_cast<int>(GetAttributeNumber(Attribute));
+    } else if (IsNumberType(Value.Type)) {
+        Value.DoubleValue = GetAttributeNumber(Attribute);
+    }
+    return Value;
+}
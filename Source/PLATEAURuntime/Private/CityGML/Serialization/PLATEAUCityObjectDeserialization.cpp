@@ -8,9 +8,26 @@
 void FPLATEAUCityObjectDeserialization::DeserializeCityObjects(const FString InSerializedCityObjects, const TArray<TObjectPtr<USceneComponent>> InAttachChildren, 
     TArray<FPLATEAUCityObject>& OutRootCityObjects, FString& OutOutsideParent) {
 
+    TArray<FString> OutsideChildren;
+    if (!DeserializeCityObjects(InSerializedCityObjects, OutRootCityObjects, OutOutsideParent, OutsideChildren))
+        return;
+
+    // 最小地物単位
+    if (0 < OutsideChildren.Num() && 0 < OutRootCityObjects.Num()) {
+        for (const auto& ChildComponent : InAttachChildren) {
+            const auto& PLATEAUCityObjectGroup = Cast<UPLATEAUCityObjectGroup>(ChildComponent);
+            OutRootCityObjects[0].Children.Append(PLATEAUCityObjectGroup->GetAllRootCityObjects());
+        }
+    }
+}
+
+bool FPLATEAUCityObjectDeserialization::DeserializeCityObjects(const FString& InSerializedCityObjects, TArray<FPLATEAUCityObject>& OutRootCityObjects,
+    FString& OutOutsideParent, TArray<FString>& OutOutsideChildren) {
+
     TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(InSerializedCityObjects);
     TSharedPtr<FJsonObject> JsonRootObject;
-    FJsonSerializer::Deserialize(JsonReader, JsonRootObject);
+    if (!FJsonSerializer::Deserialize(JsonReader, JsonRootObject) || !JsonRootObject.IsValid())
+        return false;
 
     const auto& CityObjectsJsonArray = JsonRootObject->GetArrayField(plateau::CityObjectGroup::CityObjectsFieldName);
     for (const auto& CityJsonValue : CityObjectsJsonArray) {
@@ -19,14 +36,11 @@ void FPLATEAUCityObjectDeserialization::DeserializeCityObjects(const FString InS
 
     OutOutsideParent = JsonRootObject->GetStringField(plateau::CityObjectGroup::OutsideParentFieldName);
 
-    // 最小地物単位
     const auto& OutsideChildrenJsonArray = JsonRootObject->GetArrayField(plateau::CityObjectGroup::OutsideChildrenFieldName);
-    if (0 < OutsideChildrenJsonArray.Num() && 0 < OutRootCityObjects.Num()) {
-        for (const auto& ChildComponent : InAttachChildren) {
-            const auto& PLATEAUCityObjectGroup = Cast<UPLATEAUCityObjectGroup>(ChildComponent);
-            OutRootCityObjects[0].Children.Append(PLATEAUCityObjectGroup->GetAllRootCityObjects());
-        }
+    for (const auto& OutsideChildJsonValue : OutsideChildrenJsonArray) {
+        OutOutsideChildren.Add(OutsideChildJsonValue->AsString());
     }
+    return true;
 }
 
 /**
@@ -1,60 +1,44 @@
 // Copyright 2023 Ministry of Land, Infrastructure and Transport
 #include "CityGML/Serialization/PLATEAUNativeCityObjectSerialization.h"
-#include <Component/PLATEAUCityObjectGroup.h>
-#include "Util/PLATEAUGmlUtil.h"
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
+#include <plateau/polygon_mesh/mesh.h>
+#include <plateau/polygon_mesh/node.h>
 #include <citygml/citymodel.h>
 #include <citygml/cityobject.h>
 
-FString FPLATEAUNativeCityObjectSerialization::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject, const plateau::polygonMesh::MeshGranularity& Granularity) {
-
-    const TSharedPtr<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
-    // 親はなし
-    JsonRootObject->SetStringField(plateau::CityObjectGroup::OutsideParentFieldName, "");
-
+TArray<uint8> FPLATEAUNativeCityObjectSerialization::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject, const plateau::polygonMesh::MeshGranularity& Granularity) {
     // 子コンポーネント名取得
-    TArray<TSharedPtr<FJsonValue>> OutsideChildrenJsonArray;
+    TArray<FString> OutsideChildren;
     for (int32 i = 0; i < InNode.getChildCount(); i++) {
-        OutsideChildrenJsonArray.Emplace(MakeShared<FJsonValueString>(UTF8_TO_TCHAR(InNode.getChildAt(i).getName().c_str())));
+        OutsideChildren.Add(UTF8_TO_TCHAR(InNode.getChildAt(i).getName().c_str()));
     }
-    JsonRootObject->SetArrayField(plateau::CityObjectGroup::OutsideChildrenFieldName, OutsideChildrenJsonArray);
 
-    // CityObjects取得
-    TArray<TSharedPtr<FJsonValue>> CityObjectsJsonArray;
-    CityObjectsJsonArray.Emplace(MakeShared<FJsonValueObject>(GetCityJsonObject(InCityObject)));
-    JsonRootObject->SetArrayField(plateau::CityObjectGroup::CityObjectsFieldName, CityObjectsJsonArray);
-
-    // Json書き出し
-    FString SerializedCityObjects;
-    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SerializedCityObjects);
-    FJsonSerializer::Serialize(JsonRootObject.ToSharedRef(), Writer);
+    // 親はなし
+    TArray<uint8> SerializedCityObjects;
+    FPLATEAUCityObjectBinary::Write({ GetCityObject(InCityObject) }, FString(), OutsideChildren, SerializedCityObjects);
     return SerializedCityObjects;
 }
 
-FString FPLATEAUNativeCityObjectSerialization::SerializeCityObject(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh,
+TArray<uint8> FPLATEAUNativeCityObjectSerialization::SerializeCityObject(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh,
     const plateau::polygonMesh::MeshGranularity& Granularity, std::shared_ptr<const citygml::CityModel> InCityModel) {
 
     const auto& CityObjectList = InMesh.getCityObjectList();
     const std::vector<plateau::polygonMesh::CityObjectIndex> CityObjectIndices = *CityObjectList.getAllKeys();
-    const TSharedPtr<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
-
-    JsonRootObject->SetStringField(plateau::CityObjectGroup::OutsideParentFieldName, "");
-    JsonRootObject->SetArrayField(plateau::CityObjectGroup::OutsideChildrenFieldName, {});
+    TArray<FPLATEAUCityObject> RootCityObjects;
+    FString OutsideParent;
 
     // 最小地物単位の親を求める（主要地物のIDを設定）
     if (plateau::polygonMesh::MeshGranularity::PerAtomicFeatureObject == Granularity) {
         for (const auto& CityObjectIndex : CityObjectIndices) {
             const auto& AtomicGmlId = CityObjectList.getAtomicGmlID(CityObjectIndex);
             if (AtomicGmlId != InNodeName) {
-                JsonRootObject->SetStringField(plateau::CityObjectGroup::OutsideParentFieldName, UTF8_TO_TCHAR(AtomicGmlId.c_str()));
+                OutsideParent = UTF8_TO_TCHAR(AtomicGmlId.c_str());
             }
         }
     }
 
     if (plateau::polygonMesh::MeshGranularity::PerCityModelArea == Granularity) {
         // 地域単位
-        TArray<TSharedPtr<FJsonValue>> CityObjectJsonArray;
-        TSharedPtr<FJsonObject> CityJsonObjectParent = MakeShareable(new FJsonObject);
-        TArray<TSharedPtr<FJsonValue>> CityJsonObjectChildren;
         int32 CurrentPrimaryIndex = -1;
         for (int32 i = 0; i < CityObjectIndices.size(); i++) {
             const auto& CityObjectIndex = CityObjectIndices[i];
@@ -66,32 +50,21 @@ FString FPLATEAUNativeCityObjectSerialization::SerializeCityObject(const std::st
             if (CityObjectIndex.primary_index != CurrentPrimaryIndex) {
                 // 主要地物
                 CurrentPrimaryIndex = CityObjectIndex.primary_index;
-                CityJsonObjectParent = GetCityJsonObject(CityObject, CityObjectIndex);
-                CityObjectJsonArray.Emplace(MakeShared<FJsonValueObject>(CityJsonObjectParent));
-                CityJsonObjectChildren.Empty();
+                RootCityObjects.Add(GetCityObject(CityObject, CityObjectIndex));
             }
             else {
                 // 最小地物
-                CityJsonObjectChildren.Emplace(MakeShared<FJsonValueObject>(GetCityJsonObject(CityObject, CityObjectIndex)));
-            }
-
-            // データの区切りか？
-            if (i + 1 == CityObjectIndices.size() || CityObjectIndices[i + 1].primary_index != CurrentPrimaryIndex) {
-                CityJsonObjectParent->SetArrayField(plateau::CityObjectGroup::ChildrenFieldName, CityJsonObjectChildren);
+                RootCityObjects.Last().Children.Add(GetCityObject(CityObject, CityObjectIndex));
             }
         }
-        JsonRootObject->SetArrayField(plateau::CityObjectGroup::CityObjectsFieldName, CityObjectJsonArray);
     }
     else {
         // 最小地物単位・主要地物単位共通
         if (const auto& CityObjectParent = InCityModel->getCityObjectById(InNodeName); CityObjectParent != nullptr) {
             const auto& CityObjectParentIndex = CityObjectList.getCityObjectIndex(InNodeName);
-            const auto& CityJsonObjectParent = GetCityJsonObject(CityObjectParent, CityObjectParentIndex);
-            TArray<TSharedPtr<FJsonValue>> CityObjectJsonArray;
-            CityObjectJsonArray.Emplace(MakeShared<FJsonValueObject>(CityJsonObjectParent));
+            auto& ParentCityObject = RootCityObjects.Add_GetRef(GetCityObject(CityObjectParent, CityObjectParentIndex));
 
             if (plateau::polygonMesh::MeshGranularity::PerPrimaryFeatureObject == Granularity) {
-                TArray<TSharedPtr<FJsonValue>> CityObjectsChildrenJsonArray;
                 for (const auto& CityObjectIndex : CityObjectIndices) {
                     const auto& AtomicGmlId = CityObjectList.getAtomicGmlID(CityObjectIndex);
                     if (AtomicGmlId == InNodeName)
@@ -102,115 +75,84 @@ FString FPLATEAUNativeCityObjectSerialization::SerializeCityObject(const std::st
                     if (CityObject == nullptr)
                         continue;
 
-                    CityObjectsChildrenJsonArray.Emplace(MakeShared<FJsonValueObject>(GetCityJsonObject(CityObject, CityObjectIndex)));
+                    ParentCityObject.Children.Add(GetCityObject(CityObject, CityObjectIndex));
                 }
-                CityJsonObjectParent->SetArrayField(plateau::CityObjectGroup::ChildrenFieldName, CityObjectsChildrenJsonArray);
             }
-            JsonRootObject->SetArrayField(plateau::CityObjectGroup::CityObjectsFieldName, CityObjectJsonArray);
         }
     }
 
-    FString SerializedCityObjects;
-    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SerializedCityObjects);
-    FJsonSerializer::Serialize(JsonRootObject.ToSharedRef(), Writer);
+    TArray<uint8> SerializedCityObjects;
+    FPLATEAUCityObjectBinary::Write(RootCityObjects, OutsideParent, {}, SerializedCityObjects);
     return SerializedCityObjects;
 }
 
 /**
 * @brief 再帰的に属性マップから属性情報を取得
+* 値は従来のJson形式と同じくcitygml::AttributeValue::asStringの文字列から変換します。
 * @param InAttributesMap 属性マップ
-* @param InAttributesJsonObjectArray 属性情報を格納する配列
+* @param OutAttributeMap 属性情報を格納するマップ
 */
-void FPLATEAUNativeCityObjectSerialization::GetAttributesJsonObjectRecursive(const citygml::AttributesMap& InAttributesMap, TArray<TSharedPtr<FJsonValue>>& InAttributesJsonObjectArray) {
+void FPLATEAUNativeCityObjectSerialization::GetAttributesRecursive(const citygml::AttributesMap& InAttributesMap, FPLATEAUAttributeMap& OutAttributeMap) {
+    OutAttributeMap.AttributeMap.Reserve(InAttributesMap.size());
     for (const auto& [key, value] : InAttributesMap) {
-        TSharedRef<FJsonObject> AttributesJsonObject = MakeShared<FJsonObject>();
+        FPLATEAUAttributeValue AttributeValue;
         if (citygml::AttributeType::AttributeSet == value.getType()) {
-            TArray<TSharedPtr<FJsonValue>> AttributeSetJsonObjectArray;
-            GetAttributesJsonObjectRecursive(value.asAttributeSet(), AttributeSetJsonObjectArray);
-            AttributesJsonObject->SetStringField(plateau::CityObjectGroup::KeyFieldName, UTF8_TO_TCHAR(key.c_str()));
-            AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "AttributeSets");
-            AttributesJsonObject->SetArrayField(plateau::CityObjectGroup::ValueFieldName, AttributeSetJsonObjectArray);
-            InAttributesJsonObjectArray.Emplace(MakeShared<FJsonValueObject>(AttributesJsonObject));
+            AttributeValue.Type = EPLATEAUAttributeType::AttributeSets;
+            AttributeValue.Attributes = MakeShared<FPLATEAUAttributeMap>();
+            GetAttributesRecursive(value.asAttributeSet(), *AttributeValue.Attributes);
         }
         else {
-            AttributesJsonObject->SetStringField(plateau::CityObjectGroup::KeyFieldName, UTF8_TO_TCHAR(key.c_str()));
-
             switch (value.getType()) {
             case citygml::AttributeType::String:
-                AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "String");
+                AttributeValue.Type = EPLATEAUAttributeType::String;
                 break;
             case citygml::AttributeType::Double:
-                AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "Double");
+                AttributeValue.Type = EPLATEAUAttributeType::Double;
                 break;
             case citygml::AttributeType::Integer:
-                AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "Integer");
+                AttributeValue.Type = EPLATEAUAttributeType::Integer;
                 break;
             case citygml::AttributeType::Date:
-                AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "Date");
+                AttributeValue.Type = EPLATEAUAttributeType::Date;
                 break;
             case citygml::AttributeType::Uri:
-                AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "Uri");
+                AttributeValue.Type = EPLATEAUAttributeType::Uri;
                 break;
             case citygml::AttributeType::Measure:
-                AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "Measure");
+                AttributeValue.Type = EPLATEAUAttributeType::Measure;
                 break;
             case citygml::AttributeType::Boolean:
-                AttributesJsonObject->SetStringField(plateau::CityObjectGroup::TypeFieldName, "Boolean");
+                AttributeValue.Type = EPLATEAUAttributeType::Boolean;
                 break;
             default: UE_LOG(LogTemp, Log, TEXT("Error citygml::AttributeType"));
             }
 
-            AttributesJsonObject->SetStringField(plateau::CityObjectGroup::ValueFieldName, UTF8_TO_TCHAR(value.asString().c_str()));
-            InAttributesJsonObjectArray.Emplace(MakeShared<FJsonValueObject>(AttributesJsonObject));
+            AttributeValue.SetValue(AttributeValue.Type, UTF8_TO_TCHAR(value.asString().c_str()));
         }
+        OutAttributeMap.AttributeMap.Add(UTF8_TO_TCHAR(key.c_str()), MoveTemp(AttributeValue));
     }
 }
 
 /**
-* @brief シティオブジェクトからシリアライズに必要な情報を抽出してJsonValue配列として返却
+* @brief シティオブジェクトからシリアライズに必要な情報を抽出して返却
 * @param InCityObject CityModelから得られるシティオブジェクト情報
 * @return シティオブジェクト情報
 */
-TSharedRef<FJsonObject> FPLATEAUNativeCityObjectSerialization::GetCityJsonObject(const citygml::CityObject* InCityObject) {
-    TSharedRef<FJsonObject> CityJsonObject = MakeShared<FJsonObject>();
-
-    CityJsonObject->SetStringField(plateau::CityObjectGroup::GmlIdFieldName, UTF8_TO_TCHAR(InCityObject->getId().c_str()));
-
-    TArray<TSharedPtr<FJsonValue>> CityObjectIndexArray;
-    CityObjectIndexArray.Emplace(MakeShared<FJsonValueNumber>(0));
-    CityObjectIndexArray.Emplace(MakeShared<FJsonValueNumber>(-1));
-    CityJsonObject->SetArrayField(plateau::CityObjectGroup::CityObjectIndexFieldName, CityObjectIndexArray);
-
-    CityJsonObject->SetStringField(plateau::CityObjectGroup::CityObjectTypeFieldName, plateau::CityObject::CityObjectsTypeToString(InCityObject->getType()));
-
-    TArray<TSharedPtr<FJsonValue>> AttributesJsonObjectArray;
-    GetAttributesJsonObjectRecursive(InCityObject->getAttributes(), AttributesJsonObjectArray);
-    CityJsonObject->SetArrayField(plateau::CityObjectGroup::AttributesFieldName, AttributesJsonObjectArray);
-
-    return CityJsonObject;
+FPLATEAUCityObject FPLATEAUNativeCityObjectSerialization::GetCityObject(const citygml::CityObject* InCityObject) {
+    return GetCityObject(InCityObject, plateau::polygonMesh::CityObjectIndex(0, -1));
 }
 
 /**
-* @brief シティオブジェクトからシリアライズに必要な情報を抽出してJsonValue配列として返却
+* @brief シティオブジェクトからシリアライズに必要な情報を抽出して返却
 * @param InCityObject CityModelから得られるシティオブジェクト情報
 * @param CityObjectIndex CityObjectListが持つインデックス情報
 * @return シティオブジェクト情報
 */
-TSharedRef<FJsonObject> FPLATEAUNativeCityObjectSerialization::GetCityJsonObject(const citygml::CityObject* InCityObject, const plateau::polygonMesh::CityObjectIndex& CityObjectIndex) {
-    TSharedRef<FJsonObject> CityJsonObject = MakeShared<FJsonObject>();
-
-    CityJsonObject->SetStringField(plateau::CityObjectGroup::GmlIdFieldName, UTF8_TO_TCHAR(InCityObject->getId().c_str()));
-
-    TArray<TSharedPtr<FJsonValue>> CityObjectIndexArray;
-    CityObjectIndexArray.Emplace(MakeShared<FJsonValueNumber>(CityObjectIndex.primary_index));
-    CityObjectIndexArray.Emplace(MakeShared<FJsonValueNumber>(CityObjectIndex.atomic_index));
-    CityJsonObject->SetArrayField(plateau::CityObjectGroup::CityObjectIndexFieldName, CityObjectIndexArray);
-
-    CityJsonObject->SetStringField(plateau::CityObjectGroup::CityObjectTypeFieldName, plateau::CityObject::CityObjectsTypeToString(InCityObject->getType()));
-
-    TArray<TSharedPtr<FJsonValue>> AttributesJsonObjectArray;
-    GetAttributesJsonObjectRecursive(InCityObject->getAttributes(), AttributesJsonObjectArray);
-    CityJsonObject->SetArrayField(plateau::CityObjectGroup::AttributesFieldName, AttributesJsonObjectArray);
-
-    return CityJsonObject;
-}
\ No newline at end of file
+FPLATEAUCityObject FPLATEAUNativeCityObjectSerialization::GetCityObject(const citygml::CityObject* InCityObject, const plateau::polygonMesh::CityObjectIndex& CityObjectIndex) {
+    FPLATEAUCityObject CityObject;
+    CityObject.SetGmlID(UTF8_TO_TCHAR(InCityObject->getId().c_str()));
+    CityObject.SetCityObjectIndex(CityObjectIndex);
+    CityObject.SetCityObjectsType(plateau::CityObject::CityObjectsTypeToString(InCityObject->getType()));
+    GetAttributesRecursive(InCityObject->getAttributes(), CityObject.Attributes);
+    return CityObject;
+}
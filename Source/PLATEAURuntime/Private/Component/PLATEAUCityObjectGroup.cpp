@@ -55,50 +55,57 @@ void UPLATEAUCityObjectGroup::FindCollisionUV(const FHitResult& HitResult, FVect
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const FPLATEAUCityObject& InCityObject, const FString InOutsideParent, const TArray<FString> InOutsideChildren) {
-    SerializedCityObjects = PlateauSerializer.SerializeCityObject(InCityObject, InOutsideParent, InOutsideChildren);
+    TArray<uint8> Serialized;
+    FPLATEAUCityObjectBinary::Write({ InCityObject }, InOutsideParent, InOutsideChildren, Serialized);
+    SetSerializedCityObjectsBinary(MoveTemp(Serialized));
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const FPLATEAUCityObject& InCityObject, const plateau::granularityConvert::ConvertGranularity& Granularity) {
     SetConvertGranularity(Granularity);
-    SerializedCityObjects = PlateauSerializer.SerializeCityObject(InNode, InCityObject);
+    SetSerializedCityObjectsBinary(PlateauSerializer.SerializeCityObject(InNode, InCityObject));
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const FPLATEAUCityObject& InCityObject, const plateau::polygonMesh::MeshGranularity& Granularity) {
     SetMeshGranularity(Granularity);
-    SerializedCityObjects = PlateauSerializer.SerializeCityObject(InNode, InCityObject);
+    SetSerializedCityObjectsBinary(PlateauSerializer.SerializeCityObject(InNode, InCityObject));
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const FPLATEAUCityObject& InCityObject) {
-    SerializedCityObjects = PlateauSerializer.SerializeCityObject(InNode, InCityObject);
+    SetSerializedCityObjectsBinary(PlateauSerializer.SerializeCityObject(InNode, InCityObject));
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const FString& InNodeName, const plateau::polygonMesh::Mesh& InMesh, 
     const plateau::granularityConvert::ConvertGranularity& Granularity, TMap<FString, FPLATEAUCityObject> CityObjMap) {
     SetConvertGranularity(Granularity);
     const plateau::polygonMesh::MeshGranularity MeshGranularity = (const plateau::polygonMesh::MeshGranularity)Granularity;
-    SerializedCityObjects = PlateauSerializer.SerializeCityObject(InNodeName, InMesh, MeshGranularity, CityObjMap);
+    SetSerializedCityObjectsBinary(PlateauSerializer.SerializeCityObject(InNodeName, InMesh, MeshGranularity, CityObjMap));
 }
 void UPLATEAUCityObjectGroup::SerializeCityObject(const FString& InNodeName, const plateau::polygonMesh::Mesh& InMesh,
     const plateau::polygonMesh::MeshGranularity& Granularity, TMap<FString, FPLATEAUCityObject> CityObjMap) {
     SetMeshGranularity(Granularity);
-    SerializedCityObjects = PlateauSerializer.SerializeCityObject(InNodeName, InMesh, Granularity, CityObjMap);
+    SetSerializedCityObjectsBinary(PlateauSerializer.SerializeCityObject(InNodeName, InMesh, Granularity, CityObjMap));
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const FLoadInputData& InLoadInputData, const std::shared_ptr<const citygml::CityModel> InCityModel) {
     const plateau::polygonMesh::MeshGranularity& Granularity = InLoadInputData.ExtractOptions.mesh_granularity;
     SetMeshGranularity(Granularity);
-    SerializedCityObjects = CityModelSerializer.SerializeCityObject(InNodeName, InMesh, Granularity, InCityModel);
+    SetSerializedCityObjectsBinary(CityModelSerializer.SerializeCityObject(InNodeName, InMesh, Granularity, InCityModel));
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject, const plateau::polygonMesh::MeshGranularity& Granularity) {
     SetMeshGranularity(Granularity);
-    SerializedCityObjects = CityModelSerializer.SerializeCityObject(InNode, InCityObject, Granularity);
+    SetSerializedCityObjectsBinary(CityModelSerializer.SerializeCityObject(InNode, InCityObject, Granularity));
+}
+
+void UPLATEAUCityObjectGroup::SetSerializedCityObjects(const TArray<uint8>& InSerializedCityObjects, const plateau::polygonMesh::MeshGranularity& Granularity) {
+    SetMeshGranularity(Granularity);
+    SetSerializedCityObjectsBinary(TArray<uint8>(InSerializedCityObjects));
+    // モデルキャッシュのファイルから読み込んだ値のため参照前に一度検証する
+    bSerializedCityObjectsValidated = false;
 }
 
 FPLATEAUCityObject UPLATEAUCityObjectGroup::GetPrimaryCityObjectByRaycast(const FHitResult& HitResult) {
-    if (RootCityObjects.Num() <= 0) {
-        GetAllRootCityObjects();
-    }
+    BuildCityObjectCache();
 
     if (OutsideParent.IsEmpty()) {
         FVector2d UV;
@@ -110,7 +117,7 @@ FPLATEAUCityObject UPLATEAUCityObjectGroup::GetPrimaryCityObjectByRaycast(const
     // 親を探す
     USceneComponent* ParentIterator = GetAttachParent();
     while (ParentIterator != nullptr) {
-        if (const auto& Parent = Cast<UPLATEAUCityObjectGroup>(ParentIterator); Parent->GetName().Contains(OutsideParent)) {
+        if (const auto& Parent = Cast<UPLATEAUCityObjectGroup>(ParentIterator); Parent != nullptr && Parent->GetName().Contains(OutsideParent)) {
             return Parent->GetCityObjectByID(OutsideParent);
         }
         ParentIterator = ParentIterator->GetAttachParent();
@@ -131,20 +138,8 @@ FPLATEAUCityObject UPLATEAUCityObjectGroup::GetCityObjectByUV(const FVector2d& U
 }
 
 FPLATEAUCityObject UPLATEAUCityObjectGroup::GetCityObjectByIndex(const FPLATEAUCityObjectIndex Index) {
-    if (RootCityObjects.Num() <= 0) {
-        GetAllRootCityObjects();
-    }
-
-    for (const auto& RootCityObject : RootCityObjects) {
-        if (RootCityObject.CityObjectIndex == Index) {
-            return RootCityObject;
-        }
-
-        for (const auto& ChildCityObject : RootCityObject.Children) {
-            if (ChildCityObject.CityObjectIndex == Index) {
-                return ChildCityObject;
-            }
-        }
+    if (const auto CityObject = FindCityObjectByIndex(Index)) {
+        return *CityObject;
     }
 
     UE_LOG(LogTemp, Error, TEXT("There is no index (%d, %d)."), Index.PrimaryIndex, Index.AtomicIndex);
@@ -152,11 +147,12 @@ FPLATEAUCityObject UPLATEAUCityObjectGroup::GetCityObjectByIndex(const FPLATEAUC
 }
 
 FPLATEAUCityObject UPLATEAUCityObjectGroup::GetCityObjectByID(const FString& GmlID) {
-    if (RootCityObjects.Num() <= 0) {
-        GetAllRootCityObjects();
+    if (const auto CityObject = FindCityObjectByID(GmlID)) {
+        return *CityObject;
     }
 
-    for (const auto& RootCityObject : RootCityObjects) {
+    // 完全一致しない場合は従来通りGML IDを含むルートを探す
+    for (const auto& RootCityObject : GetRootCityObjects()) {
         if (GmlID.Contains(RootCityObject.GmlID)) {
             return RootCityObject;
         }
@@ -166,14 +162,134 @@ FPLATEAUCityObject UPLATEAUCityObjectGroup::GetCityObjectByID(const FString& Gml
 }
 
 TArray<FPLATEAUCityObject> UPLATEAUCityObjectGroup::GetAllRootCityObjects() {
-    if (0 < RootCityObjects.Num()) {
-        return RootCityObjects;
-    }
+    return GetRootCityObjects();
+}
 
-    Deserializer.DeserializeCityObjects(SerializedCityObjects, GetAttachChildren(), RootCityObjects, OutsideParent);
+const TArray<FPLATEAUCityObject>& UPLATEAUCityObjectGroup::GetRootCityObjects() {
+    BuildCityObjectCache();
     return RootCityObjects;
 }
 
+const FPLATEAUCityObject* UPLATEAUCityObjectGroup::FindCityObjectByIndex(const FPLATEAUCityObjectIndex& Index) {
+    BuildCityObjectCache();
+    const auto Found = CityObjectIndexMap.Find(Index);
+    return Found != nullptr ? *Found : nullptr;
+}
+
+const FPLATEAUCityObject* UPLATEAUCityObjectGroup::FindCityObjectByID(const FString& GmlID) {
+    BuildCityObjectCache();
+    const auto Found = CityObjectIdMap.Find(GmlID);
+    return Found != nullptr ? *Found : nullptr;
+}
+
+void UPLATEAUCityObjectGroup::BuildCityObjectCache() {
+    ValidateSerializedCityObjects();
+    if (bCityObjectCacheBuilt)
+        return;
+
+    bCityObjectCacheBuilt = true;
+    const auto CityObjectsBinary = GetCityObjectsBinary();
+    if (!CityObjectsBinary.IsValid())
+        return;
+
+    CityObjectsBinary.ToCityObjects(RootCityObjects);
+    OutsideParent = CityObjectsBinary.GetOutsideParent();
+
+    // 最小地物単位
+    if (!CityObjectsBinary.GetOutsideChildren().IsEmpty() && 0 < RootCityObjects.Num()) {
+        for (const auto& ChildComponent : GetAttachChildren()) {
+            if (const auto& PLATEAUCityObjectGroup = Cast<UPLATEAUCityObjectGroup>(ChildComponent)) {
+                RootCityObjects[0].Children.Append(PLATEAUCityObjectGroup->GetRootCityObjects());
+            }
+        }
+    }
+
+    // ツリーの変更はここまでのため、以降は要素へのポインタを保持できる
+    // 同じキーが複数ある場合は従来の線形探索と同じくルート、子の順で先に見つかるものを優先
+    const int32 CityObjectCount = CityObjectsBinary.GetObjectCount();
+    CityObjectIndexMap.Reserve(CityObjectCount);
+    CityObjectIdMap.Reserve(CityObjectCount);
+    const auto AddToIndices = [this](const FPLATEAUCityObject& CityObject) {
+        if (!CityObjectIndexMap.Contains(CityObject.CityObjectIndex))
+            CityObjectIndexMap.Add(CityObject.CityObjectIndex, &CityObject);
+        if (!CityObjectIdMap.Contains(CityObject.GmlID))
+            CityObjectIdMap.Add(CityObject.GmlID, &CityObject);
+    };
+    for (const auto& RootCityObject : RootCityObjects) {
+        AddToIndices(RootCityObject);
+    }
+    for (const auto& RootCityObject : RootCityObjects) {
+        for (const auto& ChildCityObject : RootCityObject.Children) {
+            AddToIndices(ChildCityObject);
+        }
+    }
+}
+
+void UPLATEAUCityObjectGroup::ResetCityObjectCache() {
+    bCityObjectCacheBuilt = false;
+    RootCityObjects.Empty();
+    CityObjectIndexMap.Empty();
+    CityObjectIdMap.Empty();
+}
+
+FPLATEAUCityObjectBinary UPLATEAUCityObjectGroup::GetCityObjectsBinary() {
+    ValidateSerializedCityObjects();
+    return FPLATEAUCityObjectBinary::FromValidatedBytes(SerializedCityObjectsBinary);
+}
+
+FString UPLATEAUCityObjectGroup::GetSerializedCityObjectsJson() {
+    return GetCityObjectsBinary().ToJson();
+}
+
+bool UPLATEAUCityObjectGroup::HasSerializedCityObjects() const {
+    return !SerializedCityObjects.IsEmpty() || !SerializedCityObjectsBinary.IsEmpty();
+}
+
+void UPLATEAUCityObjectGroup::CopySerializedCityObjects(const UPLATEAUCityObjectGroup& Source) {
+    SerializedCityObjects = Source.SerializedCityObjects;
+    SerializedCityObjectsBinary = Source.SerializedCityObjectsBinary;
+    bSerializedCityObjectsValidated = Source.bSerializedCityObjectsValidated;
+    ResetCityObjectCache();
+}
+
+void UPLATEAUCityObjectGroup::PostLoad() {
+    Super::PostLoad();
+    ValidateSerializedCityObjects();
+}
+
+void UPLATEAUCityObjectGroup::SetSerializedCityObjectsBinary(TArray<uint8>&& InSerializedCityObjects) {
+    SerializedCityObjects.Empty();
+    ResetCityObjectCache();
+    SerializedCityObjectsBinary = MoveTemp(InSerializedCityObjects);
+    // FPLATEAUCityObjectBinary::Writeで作成したバイト列のため検証不要
+    bSerializedCityObjectsValidated = true;
+}
+
+void UPLATEAUCityObjectGroup::MigrateSerializedCityObjects() {
+    if (SerializedCityObjects.IsEmpty())
+        return;
+
+    TArray<uint8> Serialized;
+    if (!FPLATEAUCityObjectBinary::FromJson(SerializedCityObjects, Serialized)) {
+        UE_LOG(LogTemp, Error, TEXT("Failed to migrate SerializedCityObjects: %s"), *GetName());
+        Serialized.Empty();
+    }
+    SetSerializedCityObjectsBinary(MoveTemp(Serialized));
+}
+
+void UPLATEAUCityObjectGroup::ValidateSerializedCityObjects() {
+    MigrateSerializedCityObjects();
+    if (bSerializedCityObjectsValidated)
+        return;
+
+    bSerializedCityObjectsValidated = true;
+    if (!SerializedCityObjectsBinary.IsEmpty() && !FPLATEAUCityObjectBinary(SerializedCityObjectsBinary).IsValid()) {
+        UE_LOG(LogTemp, Error, TEXT("Invalid SerializedCityObjectsBinary: %s"), *GetName());
+        ResetCityObjectCache();
+        SerializedCityObjectsBinary.Empty();
+    }
+}
+
 const plateau::granularityConvert::ConvertGranularity UPLATEAUCityObjectGroup::GetConvertGranularity() {
     return static_cast<plateau::granularityConvert::ConvertGranularity>(MeshGranularityIntValue);
 }
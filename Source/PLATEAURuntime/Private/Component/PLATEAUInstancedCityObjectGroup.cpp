@@ -0,0 +1,212 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "Util/PLATEAUComponentUtil.h"
+
+namespace {
+    FPLATEAUCityObject FindCityObjectByIndex(const FPLATEAUCityObjectBinary& Binary, const FPLATEAUCityObjectIndex& Index) {
+        if (!Binary.IsValid())
+            return FPLATEAUCityObject();
+
+        const int32 Object = Binary.FindByIndex(Index);
+        return Object == INDEX_NONE ? FPLATEAUCityObject() : Binary.ToCityObject(Object);
+    }
+}
+
+UPLATEAUInstancedCityObjectGroup::UPLATEAUInstancedCityObjectGroup(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer) {
+    NumCustomDataFloats = 1;
+}
+
+int32 UPLATEAUInstancedCityObjectGroup::AddCityObjectInstance(const FTransform& InstanceTransform, const FString& NodeName, const TArray<uint8>& SerializedCityObjects) {
+    ResetCityObjectCache();
+    const int32 Entry = CityObjectNames.Add(NodeName);
+
+    // FPLATEAUCityObjectBinaryはセクションを8バイト境界に揃えているため、各属性情報の先頭も揃える
+    SerializedCityObjectsBinary.SetNumZeroed(Align(SerializedCityObjectsBinary.Num(), 8));
+    SerializedCityObjectsBegins.Add(SerializedCityObjectsBinary.Num());
+    // 参照時は検証を省略するため、追加時に一度だけ検証する
+    if (FPLATEAUCityObjectBinary(SerializedCityObjects).IsValid())
+        SerializedCityObjectsBinary.Append(SerializedCityObjects);
+    SerializedCityObjectsEnds.Add(SerializedCityObjectsBinary.Num());
+
+    if (NumCustomDataFloats < 1)
+        SetNumCustomDataFloats(1);
+
+    const int32 InstanceIndex = AddInstance(InstanceTransform, false);
+    // floatで正確に表せる範囲(2^24)を超えるシティオブジェクトは想定しない
+    SetCustomDataValue(InstanceIndex, 0, static_cast<float>(Entry), false);
+    return InstanceIndex;
+}
+
+void UPLATEAUInstancedCityObjectGroup::PostLoad() {
+    Super::PostLoad();
+
+    // 保存されていた属性情報を一度だけ検証し、不正なものは属性情報なしにする
+    const int32 EntryCount = FMath::Min(SerializedCityObjectsBegins.Num(), SerializedCityObjectsEnds.Num());
+    for (int32 Entry = 0; Entry < EntryCount; ++Entry) {
+        const int32 Begin = SerializedCityObjectsBegins[Entry];
+        const int32 End = SerializedCityObjectsEnds[Entry];
+        // 範囲外はGetCityObjectsBinaryで無効として扱う
+        if (Begin < 0 || End <= Begin || End > SerializedCityObjectsBinary.Num())
+            continue;
+
+        if (!FPLATEAUCityObjectBinary(TConstArrayView<uint8>(SerializedCityObjectsBinary.GetData() + Begin, End - Begin)).IsValid()) {
+            UE_LOG(LogTemp, Error, TEXT("Invalid SerializedCityObjectsBinary: %s[%d]"), *GetName(), Entry);
+            SerializedCityObjectsEnds[Entry] = Begin;
+        }
+    }
+}
+
+int32 UPLATEAUInstancedCityObjectGroup::GetCityObjectEntry(const int32 InstanceIndex) const {
+    const int32 CustomDataIndex = InstanceIndex * NumCustomDataFloats;
+    if (NumCustomDataFloats < 1 || InstanceIndex < 0 || !PerInstanceSMCustomData.IsValidIndex(CustomDataIndex))
+        return INDEX_NONE;
+
+    const int32 Entry = FMath::RoundToInt(PerInstanceSMCustomData[CustomDataIndex]);
+    return CityObjectNames.IsValidIndex(Entry) ? Entry : INDEX_NONE;
+}
+
+FString UPLATEAUInstancedCityObjectGroup::GetInstanceNodeName(const int32 InstanceIndex) const {
+    const int32 Entry = GetCityObjectEntry(InstanceIndex);
+    return Entry == INDEX_NONE ? FString() : CityObjectNames[Entry];
+}
+
+TConstArrayView<uint8> UPLATEAUInstancedCityObjectGroup::GetSerializedCityObjects(const int32 Entry) const {
+    if (!SerializedCityObjectsBegins.IsValidIndex(Entry) || !SerializedCityObjectsEnds.IsValidIndex(Entry))
+        return TConstArrayView<uint8>();
+
+    const int32 Begin = SerializedCityObjectsBegins[Entry];
+    const int32 End = SerializedCityObjectsEnds[Entry];
+    if (Begin < 0 || End < Begin || End > SerializedCityObjectsBinary.Num())
+        return TConstArrayView<uint8>();
+
+    return TConstArrayView<uint8>(SerializedCityObjectsBinary.GetData() + Begin, End - Begin);
+}
+
+FPLATEAUCityObjectBinary UPLATEAUInstancedCityObjectGroup::GetCityObjectsBinary(const int32 InstanceIndex) const {
+    const auto SerializedCityObjects = GetSerializedCityObjects(GetCityObjectEntry(InstanceIndex));
+    if (SerializedCityObjects.IsEmpty())
+        return FPLATEAUCityObjectBinary();
+
+    // 追加時・読み込み時に検証済み
+    return FPLATEAUCityObjectBinary::FromValidatedBytes(SerializedCityObjects);
+}
+
+FPLATEAUCityObject UPLATEAUInstancedCityObjectGroup::GetCityObjectByInstance(const int32 InstanceIndex) const {
+    const auto Binary = GetCityObjectsBinary(InstanceIndex);
+    if (!Binary.IsValid() || Binary.GetRootCount() == 0)
+        return FPLATEAUCityObject();
+
+    return Binary.ToCityObject(0);
+}
+
+FPLATEAUCityObject UPLATEAUInstancedCityObjectGroup::GetPrimaryCityObjectByRaycast(const FHitResult& HitResult) const {
+    // HISMのヒット結果ではItemがインスタンスの番号
+    FVector2d UV = FVector2d::ZeroVector;
+    UPLATEAUCityObjectGroup::FindCollisionUV(HitResult, UV);
+    UV.Y = -1;
+    return FindCityObjectByIndex(GetCityObjectsBinary(HitResult.Item),
+        FPLATEAUCityObjectIndex(static_cast<int32>(UV.X), static_cast<int32>(UV.Y)));
+}
+
+FPLATEAUCityObject UPLATEAUInstancedCityObjectGroup::GetAtomicCityObjectByRaycast(const FHitResult& HitResult) const {
+    FVector2d UV = FVector2d::ZeroVector;
+    UPLATEAUCityObjectGroup::FindCollisionUV(HitResult, UV);
+    return FindCityObjectByIndex(GetCityObjectsBinary(HitResult.Item),
+        FPLATEAUCityObjectIndex(static_cast<int32>(UV.X), static_cast<int32>(UV.Y)));
+}
+
+const TArray<FPLATEAUCityObject>& UPLATEAUInstancedCityObjectGroup::GetRootCityObjects() {
+    BuildCityObjectCache();
+    return RootCityObjects;
+}
+
+const FPLATEAUCityObject* UPLATEAUInstancedCityObjectGroup::FindCityObjectByID(const FString& GmlID) {
+    BuildCityObjectCache();
+    const auto Found = CityObjectIdMap.Find(GmlID);
+    return Found != nullptr ? *Found : nullptr;
+}
+
+TArray<UPLATEAUCityObjectGroup*> UPLATEAUInstancedCityObjectGroup::ExpandInstancesInGameThread() {
+    check(IsInGameThread());
+
+    TArray<UPLATEAUCityObjectGroup*> Expanded;
+    const auto Actor = GetOwner();
+    const auto ParentComponent = GetAttachParent();
+    if (Actor == nullptr || ParentComponent == nullptr)
+        return Expanded;
+
+    for (int32 InstanceIndex = 0; InstanceIndex < GetInstanceCount(); ++InstanceIndex) {
+        const int32 Entry = GetCityObjectEntry(InstanceIndex);
+        FTransform InstanceTransform;
+        if (Entry == INDEX_NONE || !GetInstanceTransform(InstanceIndex, InstanceTransform, true))
+            continue;
+
+        // FPLATEAUMeshLoaderでインスタンス化しない場合と同じ名前・設定で作成
+        const auto Component = NewObject<UPLATEAUCityObjectGroup>(Actor, NAME_None);
+        Component->Mobility = Mobility;
+        Component->SetStaticMesh(GetStaticMesh());
+        for (int32 MaterialIndex = 0; MaterialIndex < GetNumMaterials(); ++MaterialIndex) {
+            Component->SetMaterial(MaterialIndex, GetMaterial(MaterialIndex));
+        }
+        const auto SerializedCityObjects = GetSerializedCityObjects(Entry);
+        Component->SetSerializedCityObjects(TArray<uint8>(SerializedCityObjects.GetData(), SerializedCityObjects.Num()),
+            static_cast<plateau::polygonMesh::MeshGranularity>(MeshGranularityIntValue));
+        Component->SetVisibility(GetVisibleFlag());
+        Component->SetCollisionResponseToChannel(ECC_Visibility, GetCollisionResponseToChannel(ECC_Visibility));
+        Component->DepthPriorityGroup = DepthPriorityGroup;
+
+        const FString NewUniqueName = FPLATEAUComponentUtil::MakeUniqueGmlObjectName(Actor, UPLATEAUCityObjectGroup::StaticClass(), CityObjectNames[Entry]);
+        Component->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
+        // インスタンスの頂点座標は基準位置からの相対座標のため、インスタンスの位置に配置する
+        Component->SetWorldTransform(InstanceTransform);
+        Actor->AddInstanceComponent(Component);
+        Component->RegisterComponent();
+        Component->AttachToComponent(ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
+        Expanded.Add(Component);
+    }
+
+    DestroyComponent();
+    return Expanded;
+}
+
+void UPLATEAUInstancedCityObjectGroup::BuildCityObjectCache() {
+    if (bCityObjectCacheBuilt)
+        return;
+
+    // 削除されたインスタンスのシティオブジェクトは含めない
+    bCityObjectCacheBuilt = true;
+    TBitArray<> UsedEntries(false, CityObjectNames.Num());
+    for (int32 InstanceIndex = 0; InstanceIndex < GetInstanceCount(); ++InstanceIndex) {
+        const int32 Entry = GetCityObjectEntry(InstanceIndex);
+        if (Entry != INDEX_NONE)
+            UsedEntries[Entry] = true;
+    }
+    for (TConstSetBitIterator<> It(UsedEntries); It; ++It) {
+        const auto SerializedCityObjects = GetSerializedCityObjects(It.GetIndex());
+        if (!SerializedCityObjects.IsEmpty())
+            FPLATEAUCityObjectBinary::FromValidatedBytes(SerializedCityObjects).ToCityObjects(RootCityObjects);
+    }
+
+    // ツリーの変更はここまでのため、以降は要素へのポインタを保持できる
+    const auto AddToIndex = [this](const FPLATEAUCityObject& CityObject) {
+        if (!CityObjectIdMap.Contains(CityObject.GmlID))
+            CityObjectIdMap.Add(CityObject.GmlID, &CityObject);
+    };
+    for (const auto& RootCityObject : RootCityObjects) {
+        AddToIndex(RootCityObject);
+    }
+    for (const auto& RootCityObject : RootCityObjects) {
+        for (const auto& ChildCityObject : RootCityObject.Children) {
+            AddToIndex(ChildCityObject);
+        }
+    }
+}
+
+void UPLATEAUInstancedCityObjectGroup::ResetCityObjectCache() {
+    bCityObjectCacheBuilt = false;
+    RootCityObjects.Empty();
+    CityObjectIdMap.Empty();
+}
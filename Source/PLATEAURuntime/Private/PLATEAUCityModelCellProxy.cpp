@@ -0,0 +1,9 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUCityModelCellProxy.h"
+#include "Component/PLATEAUSceneComponent.h"
+
+APLATEAUCityModelCellProxy::APLATEAUCityModelCellProxy() {
+    PrimaryActorTick.bCanEverTick = false;
+    RootComponent = CreateDefaultSubobject<UPLATEAUSceneComponent>(USceneComponent::GetDefaultSceneRootVariableName());
+}
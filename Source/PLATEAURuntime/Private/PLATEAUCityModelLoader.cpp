@@ -13,6 +13,8 @@
 #include "PLATEAUMeshLoader.h"
 #include "citygml/citygml.h"
 #include "Component/PLATEAUSceneComponent.h"
+#include "IImageWrapperModule.h"
+#include "HAL/FileManager.h"
 
 
 #define LOCTEXT_NAMESPACE "PLATEAUCityModelLoader"
@@ -28,6 +30,24 @@ public:
         // ファイル検索
         const auto DatasetSource = LoadDataset(bImportFromServer, Source, ClientRef);
         TArray<FLoadInputData> LoadInputDataArray;
+        // マテリアルキーはインポート全体で共有
+        const auto MaterialKeyTable = MakeShared<FPLATEAUMaterialKeyTable, ESPMode::ThreadSafe>();
+        // テクスチャのデコード結果もインポート全体で共有
+        FPLATEAUTextureDecodeOptions TextureDecodeOptions;
+        TextureDecodeOptions.bGenerateMips = ImportSettings->bGenerateTextureMips;
+        TextureDecodeOptions.Compression = ImportSettings->TextureCompression;
+        const auto TextureCache = MakeShared<FPLATEAUTextureCache, ESPMode::ThreadSafe>(1024ll * 1024 * 1024, 0, TextureDecodeOptions);
+        TSharedPtr<FPLATEAUModelCache, ESPMode::ThreadSafe> ModelCache;
+        if (ImportSettings->bUseModelCache)
+            ModelCache = MakeShared<FPLATEAUModelCache, ESPMode::ThreadSafe>();
+        TSharedPtr<FPLATEAUMemoryBudget, ESPMode::ThreadSafe> MemoryBudget;
+        if (ImportSettings->ImportMemoryBudgetMB > 0)
+            MemoryBudget = MakeShared<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>(static_cast<int64>(ImportSettings->ImportMemoryBudgetMB) * 1024 * 1024);
+        TSharedPtr<FPLATEAUImportProfiler, ESPMode::ThreadSafe> Profiler;
+        if (ImportSettings->bEnableImportProfiling) {
+            Profiler = MakeShared<FPLATEAUImportProfiler, ESPMode::ThreadSafe>();
+            TextureCache->SetProfiler(Profiler);
+        }
 
         for (const auto& Package : UPLATEAUImportSettings::GetAllPackages()) {
             const auto Settings = ImportSettings->GetFeatureSettings(Package);
@@ -55,6 +75,17 @@ public:
 
                 LoadInputData.bIncludeAttrInfo = Settings.bIncludeAttrInfo;
                 LoadInputData.FallbackMaterial = Settings.FallbackMaterial;
+                LoadInputData.ComponentCreationBatchSize = ImportSettings->ComponentCreationBatchSize;
+                LoadInputData.ComponentCreationTimeBudgetMs = ImportSettings->ComponentCreationTimeBudgetMs;
+                LoadInputData.bInstanceRepeatedMeshes = ImportSettings->bInstanceRepeatedMeshes;
+                LoadInputData.bRetainMeshSourceData = ImportSettings->bRetainMeshSourceData;
+                LoadInputData.MaterialKeyTable = MaterialKeyTable;
+                LoadInputData.TextureCache = TextureCache;
+                LoadInputData.ModelCache = ModelCache;
+                LoadInputData.MemoryBudget = MemoryBudget;
+                LoadInputData.Profiler = Profiler;
+                if (Profiler.IsValid())
+                    Profiler->RegisterGml(FPaths::GetCleanFilename(LoadInputData.GmlPath), UTF8_TO_TCHAR(GmlFile.getFeatureType().c_str()));
                 auto& ExtractOptions = LoadInputData.ExtractOptions;
                 ExtractOptions.reference_point = GeoReference.GetData().getReferencePoint();
                 ExtractOptions.mesh_axes = plateau::geometry::CoordinateSystem::ESU;
@@ -227,6 +258,9 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
     Phase = ECityModelLoadingPhase::Start;
     bCanceled.Exchange(false);
 
+    // テクスチャはワーカースレッドでデコードするため、事前にゲームスレッドでモジュールをロードしておく
+    FModuleManager::Get().LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
     // アクター生成
     APLATEAUInstancedCityModel* ModelActor = GetWorld()->SpawnActor<APLATEAUInstancedCityModel>();
     CreateRootComponent(*ModelActor);
@@ -251,8 +285,7 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                 ImportGmlFilesDelegate = ImportGmlFilesDelegate,
                 ImportGmlProgressDelegate = ImportGmlProgressDelegate,
                 ImportFailedGmlFileDelegate = ImportFailedGmlFileDelegate,
-                ImportFinishedDelegate = ImportFinishedDelegate,
-                LoadMeshSection = &LoadMeshSection
+                ImportFinishedDelegate = ImportFinishedDelegate
         ]() mutable {
 
                 auto LoadInputDataArray = FCityModelLoaderImpl::PrepareInputData(
@@ -274,139 +307,171 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                         Loader->Status.TotalGmlCount = GmlCount;
                     });
 
-                TArray<TFuture<bool>> Futures;
+                // GMLの処理は固定数のワーカースレッドで実行し、見積もりメモリ量がメモリ予算に収まる分だけ同時に開始する
+                const auto Scheduler = MakeShared<FPLATEAUImportScheduler, ESPMode::ThreadSafe>(
+                    ImportSettings->ImportWorkerCount, LoadInputDataArray.Num() > 0 ? LoadInputDataArray[0].MemoryBudget : nullptr);
+                ExecuteInGameThread(OwnerLoader,
+                    [&Scheduler](auto Loader) {
+                        Loader->ImportScheduler = Scheduler;
+                    });
+
                 TArray<FString> GmlNames;
 
                 bool bHasDatasetNameSet = false;
                 FCriticalSection SetDatasetNameSection;
 
                 for (int Index = 0; Index < LoadInputDataArray.Num(); ++Index) {
-                    if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
-                        FFunctionGraphTask::CreateAndDispatchWhenReady(
-                            [Index, ImportGmlProgressDelegate] {
-                                ImportGmlProgressDelegate.Broadcast(Index, 0, LOCTEXT("Cancel", "キャンセルされました"));
-                            }, TStatId(), nullptr, ENamedThreads::GameThread);
-                        continue;
-                    }
+                    const FLoadInputData& InputData = LoadInputDataArray[Index];
+                    // TODO: fldでgml名被る
+                    GmlNames.Add(FPaths::GetCleanFilename(InputData.GmlPath));
 
-                    FGenericPlatformProcess::ConditionalSleep(
-                        [&Futures, &GmlNames, OwnerLoader, &bCanceledRef] {
-                            TArray<FString> CurrentLoadingGmls;
-                            int LoadCompletedCount = 0;
-                            for (int i = 0; i < Futures.Num(); ++i) {
-
-                                if (bCanceledRef->Load(EMemoryOrder::Relaxed))
-                                    return true;
-
-                                if (!Futures[i].IsReady())
-                                    CurrentLoadingGmls.Add(GmlNames[i]);
-                                else
-                                    ++LoadCompletedCount;
-
-                                ExecuteInGameThread(OwnerLoader,
-                                    [&CurrentLoadingGmls, &LoadCompletedCount](TWeakObjectPtr<APLATEAUCityModelLoader> Loader) {
-                                        Loader->Status.LoadedGmlCount = LoadCompletedCount;
-                                        Loader->Status.LoadingGmls = CurrentLoadingGmls;
-                                    });
-                            }
-                            return CurrentLoadingGmls.Num() < 4;
-                        }, 3);
-
-                    if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
-                        FFunctionGraphTask::CreateAndDispatchWhenReady(
-                            [Index, ImportGmlProgressDelegate] {
-                                ImportGmlProgressDelegate.Broadcast(Index, 0, LOCTEXT("Cancel", "キャンセルされました"));
-                            }, TStatId(), nullptr, ENamedThreads::GameThread);
-                        continue;
-                    }
+                    // サーバーからのインポートではダウンロード前のためファイルサイズが分からず、見積もりは0となる
+                    Scheduler->Enqueue(FPLATEAUMemoryBudget::EstimateGmlBytes(InputData.GmlPath),
+                        [InputData, Source, ModelActor, OwnerLoader, bImportFromServer, bAutomationTest, bCanceledRef, Index,
+                        &bHasDatasetNameSet, &SetDatasetNameSection, ImportGmlProgressDelegate, ImportFailedGmlFileDelegate]
+                        (const FPLATEAUImportScheduler::FReservationPtr& Reservation) {
 
-                    FFunctionGraphTask::CreateAndDispatchWhenReady(
-                        [Index, ImportGmlProgressDelegate] {
-                            ImportGmlProgressDelegate.Broadcast(Index, 0, LOCTEXT("CopyGmlFile", "ファイル取得中..."));
-                        }, TStatId(), nullptr, ENamedThreads::GameThread);
-
-                    FLoadInputData InputData = LoadInputDataArray[Index];
-                    const auto CopiedGmlPath = FCityModelLoaderImpl::CopyGmlFile(Source, InputData.GmlPath, bImportFromServer);
-                    const auto GmlName = FPaths::GetCleanFilename(InputData.GmlPath);
-
-                    {
-                        FScopeLock Lock(&SetDatasetNameSection);
-                        if (!bHasDatasetNameSet) {
-                            bHasDatasetNameSet = true;
-
-                            // データセット名をGMLファイルパスから取得
-                            // TODO: libplateauに委譲。データセット名を取得するAPI実装
-                            auto DatasetName =
-                                CopiedGmlPath.RightChop((FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()) + "PLATEAU/Datasets/").Len());
-
-                            // 最初のパスの区切りを探す。
-                            int32 FirstSlashIndex, FirstBackSlashIndex;
-                            if (!DatasetName.FindChar(static_cast<TCHAR>('/'), FirstSlashIndex)) {
-                                FirstSlashIndex = TNumericLimits<int32>::Max();
-                            }
-                            if (!DatasetName.FindChar(static_cast<TCHAR>('\\'), FirstBackSlashIndex)) {
-                                FirstBackSlashIndex = TNumericLimits<int32>::Max();
+                            const auto GmlName = FPaths::GetCleanFilename(InputData.GmlPath);
+                            FPLATEAUImportProfiler* const Profiler = InputData.Profiler.Get();
+                            FPLATEAUImportProfiler::FScope ImportScope(Profiler, EPLATEAUImportStage::Import, GmlName);
+
+                            if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
+                                FFunctionGraphTask::CreateAndDispatchWhenReady(
+                                    [Index, ImportGmlProgressDelegate] {
+                                        ImportGmlProgressDelegate.Broadcast(Index, 0, LOCTEXT("Cancel", "キャンセルされました"));
+                                    }, TStatId(), nullptr, ENamedThreads::GameThread);
+                                return;
                             }
-                            DatasetName = DatasetName.Left(FMath::Min(FirstSlashIndex, FirstBackSlashIndex));
 
-                            // 3D都市モデルアクタにデータセット名を登録
                             FFunctionGraphTask::CreateAndDispatchWhenReady(
-                                [ModelActor, DatasetName]() {
-                                    ModelActor->DatasetName = DatasetName;
-                                    ModelActor->SetActorLabel(DatasetName);
+                                [Index, ImportGmlProgressDelegate] {
+                                    ImportGmlProgressDelegate.Broadcast(Index, 0, LOCTEXT("CopyGmlFile", "ファイル取得中..."));
                                 }, TStatId(), nullptr, ENamedThreads::GameThread);
-                        }
-                    }
-
-                    if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
-                        FFunctionGraphTask::CreateAndDispatchWhenReady(
-                            [Index, ImportGmlProgressDelegate] {
-                                ImportGmlProgressDelegate.Broadcast(Index, 0.25, LOCTEXT("Cancel", "キャンセルされました"));
-                            }, TStatId(), nullptr, ENamedThreads::GameThread);
-                        continue;
-                    }
 
-                    FFunctionGraphTask::CreateAndDispatchWhenReady(
-                        [Index, ImportGmlProgressDelegate] {
-                            ImportGmlProgressDelegate.Broadcast(Index, 0.25, LOCTEXT("ParseCityGml", "CityGMLパース中..."));
-                        }, TStatId(), nullptr, ENamedThreads::GameThread);
+                            FString CopiedGmlPath;
+                            {
+                                FPLATEAUImportProfiler::FScope Scope(Profiler, EPLATEAUImportStage::CopyGml, GmlName);
+                                CopiedGmlPath = FCityModelLoaderImpl::CopyGmlFile(Source, InputData.GmlPath, bImportFromServer);
+                            }
+                            if (Profiler != nullptr)
+                                Profiler->AddCounter(GmlName, EPLATEAUImportCounter::Bytes, FMath::Max<int64>(IFileManager::Get().FileSize(*CopiedGmlPath), 0));
 
-                    // TODO: fldでgml名被る
-                    GmlNames.Add(GmlName);
-                    Futures.Add(Async(EAsyncExecution::Thread,
-                        [InputData, &LoadInputDataArray, Source, ModelActor, GmlName, OwnerLoader,
-                        CopiedGmlPath, &LoadMeshSection, bAutomationTest, &bCanceledRef, Index, ImportGmlProgressDelegate, ImportFailedGmlFileDelegate] {
-
-                            if (bCanceledRef->Load(EMemoryOrder::Relaxed))
-                                return false;
-
-                            const auto CityModel = FCityModelLoaderImpl::ParseCityGml(CopiedGmlPath);
-                            if (CityModel == nullptr) {
-                                ExecuteInGameThread(OwnerLoader,
-                                    [GmlName, Index, ImportFailedGmlFileDelegate](auto Loader) {
-                                        ++Loader->Status.LoadedGmlCount;
-                                        Loader->Status.LoadingGmls.Remove(GmlName);
-                                        Loader->Status.FailedGmls.Add(GmlName);
-                                        ImportFailedGmlFileDelegate.Broadcast(Index);
-                                    });
-                                return false;
+                            {
+                                FScopeLock Lock(&SetDatasetNameSection);
+                                if (!bHasDatasetNameSet) {
+                                    bHasDatasetNameSet = true;
+
+                                    // データセット名をGMLファイルパスから取得
+                                    // TODO: libplateauに委譲。データセット名を取得するAPI実装
+                                    auto DatasetName =
+                                        CopiedGmlPath.RightChop((FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()) + "PLATEAU/Datasets/").Len());
+
+                                    // 最初のパスの区切りを探す。
+                                    int32 FirstSlashIndex, FirstBackSlashIndex;
+                                    if (!DatasetName.FindChar(static_cast<TCHAR>('/'), FirstSlashIndex)) {
+                                        FirstSlashIndex = TNumericLimits<int32>::Max();
+                                    }
+                                    if (!DatasetName.FindChar(static_cast<TCHAR>('\\'), FirstBackSlashIndex)) {
+                                        FirstBackSlashIndex = TNumericLimits<int32>::Max();
+                                    }
+                                    DatasetName = DatasetName.Left(FMath::Min(FirstSlashIndex, FirstBackSlashIndex));
+
+                                    // 3D都市モデルアクタにデータセット名を登録
+                                    FFunctionGraphTask::CreateAndDispatchWhenReady(
+                                        [ModelActor, DatasetName]() {
+                                            ModelActor->DatasetName = DatasetName;
+                                            ModelActor->SetActorLabel(DatasetName);
+                                        }, TStatId(), nullptr, ENamedThreads::GameThread);
+                                }
                             }
 
                             if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
                                 FFunctionGraphTask::CreateAndDispatchWhenReady(
                                     [Index, ImportGmlProgressDelegate] {
-                                        ImportGmlProgressDelegate.Broadcast(Index, 0.5, LOCTEXT("Cancel", "キャンセルされました"));
+                                        ImportGmlProgressDelegate.Broadcast(Index, 0.25, LOCTEXT("Cancel", "キャンセルされました"));
                                     }, TStatId(), nullptr, ENamedThreads::GameThread);
-                                return false;
+                                return;
                             }
 
                             FFunctionGraphTask::CreateAndDispatchWhenReady(
                                 [Index, ImportGmlProgressDelegate] {
-                                    ImportGmlProgressDelegate.Broadcast(Index, 0.5, LOCTEXT("MeshExtractorExtract", "ポリゴンメッシュ変換中..."));
+                                    ImportGmlProgressDelegate.Broadcast(Index, 0.25, LOCTEXT("ParseCityGml", "CityGMLパース中..."));
                                 }, TStatId(), nullptr, ENamedThreads::GameThread);
 
-                            // 注: 名前空間plateau::polygonMeshをusingで省略しないこと。Packageビルドで問題となる。
-                            const auto Model = plateau::polygonMesh::MeshExtractor::extractInExtents(*CityModel, InputData.ExtractOptions, InputData.Extents);
+                            // キャッシュにあればパースとメッシュ抽出を省略
+                            std::shared_ptr<plateau::polygonMesh::Model> Model;
+                            std::shared_ptr<const citygml::CityModel> CityModel;
+                            TSharedPtr<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe> CachedCityObjects;
+                            // 属性情報を含めない場合に、フィルタリングでGMLを再度パースせずに済むよう保存する地物タイプの表
+                            FPLATEAUFeatureTypeTable FeatureTypes;
+                            FString ModelCacheKey;
+                            if (InputData.ModelCache.IsValid()) {
+                                FPLATEAUImportProfiler::FScope Scope(Profiler, EPLATEAUImportStage::ModelCache, GmlName);
+                                ModelCacheKey = FPLATEAUModelCache::MakeKey(CopiedGmlPath, InputData.ExtractOptions, InputData.Extents, InputData.bIncludeAttrInfo);
+                                InputData.ModelCache->TryLoad(ModelCacheKey, CopiedGmlPath, Model, CachedCityObjects, &FeatureTypes);
+                            }
+
+                            if (Model == nullptr) {
+                                {
+                                    FPLATEAUImportProfiler::FScope Scope(Profiler, EPLATEAUImportStage::ParseGml, GmlName);
+                                    CityModel = FCityModelLoaderImpl::ParseCityGml(CopiedGmlPath);
+                                }
+                                if (CityModel == nullptr) {
+                                    ExecuteInGameThread(OwnerLoader,
+                                        [GmlName, Index, ImportFailedGmlFileDelegate](auto Loader) {
+                                            // 読み込み数はジョブの完了としてスケジューラの進捗で数える
+                                            Loader->Status.LoadingGmls.Remove(GmlName);
+                                            Loader->Status.FailedGmls.Add(GmlName);
+                                            ImportFailedGmlFileDelegate.Broadcast(Index);
+                                        });
+                                    return;
+                                }
+
+                                if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
+                                    FFunctionGraphTask::CreateAndDispatchWhenReady(
+                                        [Index, ImportGmlProgressDelegate] {
+                                            ImportGmlProgressDelegate.Broadcast(Index, 0.5, LOCTEXT("Cancel", "キャンセルされました"));
+                                        }, TStatId(), nullptr, ENamedThreads::GameThread);
+                                    return;
+                                }
+
+                                FFunctionGraphTask::CreateAndDispatchWhenReady(
+                                    [Index, ImportGmlProgressDelegate] {
+                                        ImportGmlProgressDelegate.Broadcast(Index, 0.5, LOCTEXT("MeshExtractorExtract", "ポリゴンメッシュ変換中..."));
+                                    }, TStatId(), nullptr, ENamedThreads::GameThread);
+
+                                // 注: 名前空間plateau::polygonMeshをusingで省略しないこと。Packageビルドで問題となる。
+                                {
+                                    FPLATEAUImportProfiler::FScope Scope(Profiler, EPLATEAUImportStage::ExtractMesh, GmlName);
+                                    Model = plateau::polygonMesh::MeshExtractor::extractInExtents(*CityModel, InputData.ExtractOptions, InputData.Extents);
+                                }
+
+                                if (!InputData.bIncludeAttrInfo)
+                                    FeatureTypes = FPLATEAUFeatureTypeTable::Create(*CityModel);
+
+                                if (InputData.ModelCache.IsValid()) {
+                                    FPLATEAUImportProfiler::FScope Scope(Profiler, EPLATEAUImportStage::ModelCache, GmlName);
+                                    // 属性情報もキャッシュに保存し、このインポートでもシリアライズ結果を使い回す
+                                    if (InputData.bIncludeAttrInfo)
+                                        CachedCityObjects = FPLATEAUModelCache::SerializeCityObjects(*Model, CityModel, InputData.ExtractOptions.mesh_granularity);
+                                    InputData.ModelCache->Save(ModelCacheKey, CopiedGmlPath, *Model, CachedCityObjects.Get(), InputData.bIncludeAttrInfo ? nullptr : &FeatureTypes);
+                                }
+
+                                if (InputData.MemoryBudget.IsValid()) {
+                                    // 属性情報をシリアライズしておき、CityModelはComponent作成前に解放する
+                                    if (InputData.bIncludeAttrInfo && !CachedCityObjects.IsValid())
+                                        CachedCityObjects = FPLATEAUModelCache::SerializeCityObjects(*Model, CityModel, InputData.ExtractOptions.mesh_granularity);
+                                    CityModel.reset();
+                                }
+                            }
+
+                            // 以降はメッシュ分のメモリのみ確保したままにする
+                            if (Reservation.IsValid())
+                                Reservation->Shrink(FPLATEAUMemoryBudget::EstimateModelBytes(*Model));
+
+                            // 抽出直後からテクスチャのデコードを開始
+                            if (InputData.TextureCache.IsValid())
+                                InputData.TextureCache->Prefetch(FPLATEAUTextureCache::CollectTexturePaths(*Model));
 
                             // 各GMLについて親Componentを作成
                             // コンポーネントは拡張子無しgml名に設定
@@ -418,7 +483,7 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                                     [Index, ImportGmlProgressDelegate] {
                                         ImportGmlProgressDelegate.Broadcast(Index, 0.75, LOCTEXT("Cancel", "キャンセルされました"));
                                     }, TStatId(), nullptr, ENamedThreads::GameThread);
-                                return false;
+                                return;
                             }
 
                             FFunctionGraphTask::CreateAndDispatchWhenReady(
@@ -426,10 +491,20 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                                     ImportGmlProgressDelegate.Broadcast(Index, 0.75, LOCTEXT("LoadModel", "ワールドに読み込み中..."));
                                 }, TStatId(), nullptr, ENamedThreads::GameThread);
 
-                            {
-                                FScopeLock Lock(LoadMeshSection);
-                                FPLATEAUMeshLoader(bAutomationTest).LoadModel(ModelActor, GmlRootComponent, Model, InputData, CityModel, bCanceledRef);
-                            }
+                            // メッシュ変換はGML毎に並列実行し、Component作成のみゲームスレッドで行う
+                            FPLATEAUMeshLoader MeshLoader(bAutomationTest);
+                            MeshLoader.SetCachedCityObjects(CachedCityObjects);
+                            if (InputData.MemoryBudget.IsValid())
+                                MeshLoader.SetMemoryReservation(Reservation);
+                            MeshLoader.LoadModel(ModelActor, GmlRootComponent, Model, InputData, CityModel, bCanceledRef);
+
+                            // 追加したコンポーネントがGML IDで検索されるよう索引を破棄する(フィルタリング用の索引はインポート完了時に作り直す)
+                            FFunctionGraphTask::CreateAndDispatchWhenReady(
+                                [ModelActor, GmlFileName = FPaths::GetCleanFilename(CopiedGmlPath), FeatureTypes = MoveTemp(FeatureTypes)]() mutable {
+                                    if (!FeatureTypes.IsEmpty())
+                                        ModelActor->AddFeatureTypeTable(GmlFileName, MoveTemp(FeatureTypes));
+                                    ModelActor->InvalidateCityObjectIndex();
+                                }, TStatId(), nullptr, ENamedThreads::GameThread);
 
                             FFunctionGraphTask::CreateAndDispatchWhenReady(
                                 [bCanceledRef, Index, ImportGmlProgressDelegate] {
@@ -440,37 +515,74 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                                         ImportGmlProgressDelegate.Broadcast(Index, 0.75, LOCTEXT("Cancel", "キャンセルされました"));
                                     }
                                 }, TStatId(), nullptr, ENamedThreads::GameThread);
-
-                            return true;
-                        }));
+                        },
+                        [Index, ImportGmlProgressDelegate] {
+                            // 開始前にキャンセルされたGML
+                            FFunctionGraphTask::CreateAndDispatchWhenReady(
+                                [Index, ImportGmlProgressDelegate] {
+                                    ImportGmlProgressDelegate.Broadcast(Index, 0, LOCTEXT("Cancel", "キャンセルされました"));
+                                }, TStatId(), nullptr, ENamedThreads::GameThread);
+                        });
                 }
 
-                FGenericPlatformProcess::ConditionalSleep(
-                    [&Futures, &GmlNames, OwnerLoader, &bCanceledRef]() {
+                // ジョブの完了・キャンセル毎に進捗を更新
+                Scheduler->Run(bCanceledRef,
+                    [&GmlNames, OwnerLoader](const TArray<int32>& RunningJobIds, const int32 CompletedCount) {
                         TArray<FString> CurrentLoadingGmls;
-                        int LoadCompletedCount = 0;
-                        for (int i = 0; i < Futures.Num(); ++i) {
-                            if (!Futures[i].IsReady()) {
-                                CurrentLoadingGmls.Add(GmlNames[i]);
-                            }
-                            else {
-                                ++LoadCompletedCount;
-                            }
-
-                            ExecuteInGameThread(OwnerLoader,
-                                [&CurrentLoadingGmls, &LoadCompletedCount](TWeakObjectPtr<APLATEAUCityModelLoader> Loader) {
-                                    Loader->Status.LoadedGmlCount = LoadCompletedCount;
-                                    Loader->Status.LoadingGmls = CurrentLoadingGmls;
-                                });
+                        for (const auto JobId : RunningJobIds) {
+                            CurrentLoadingGmls.Add(GmlNames[JobId]);
                         }
 
-                        return CurrentLoadingGmls.Num() == 0;
-                    }, 3);
+                        ExecuteInGameThread(OwnerLoader,
+                            [&CurrentLoadingGmls, CompletedCount](TWeakObjectPtr<APLATEAUCityModelLoader> Loader) {
+                                Loader->Status.LoadedGmlCount = CompletedCount;
+                                Loader->Status.LoadingGmls = CurrentLoadingGmls;
+                            });
+                    });
+
+                UE_LOG(LogTemp, Log, TEXT("Import scheduler: %s"), *Scheduler->GetStatsString());
+                ExecuteInGameThread(OwnerLoader,
+                    [](auto Loader) {
+                        Loader->ImportScheduler.Reset();
+                    });
+
+                if (LoadInputDataArray.Num() > 0 && LoadInputDataArray[0].MaterialKeyTable.IsValid()) {
+                    UE_LOG(LogTemp, Log, TEXT("Import materials: %s"), *LoadInputDataArray[0].MaterialKeyTable->GetStatsString());
+                }
+                if (LoadInputDataArray.Num() > 0 && LoadInputDataArray[0].TextureCache.IsValid()) {
+                    UE_LOG(LogTemp, Log, TEXT("Import textures: %s"), *LoadInputDataArray[0].TextureCache->GetStatsString());
+                }
+                if (LoadInputDataArray.Num() > 0 && LoadInputDataArray[0].ModelCache.IsValid()) {
+                    UE_LOG(LogTemp, Log, TEXT("Import model cache: %s"), *LoadInputDataArray[0].ModelCache->GetStatsString());
+                }
+                if (LoadInputDataArray.Num() > 0 && LoadInputDataArray[0].MemoryBudget.IsValid()) {
+                    UE_LOG(LogTemp, Log, TEXT("Import memory: %s"), *LoadInputDataArray[0].MemoryBudget->GetStatsString());
+                }
+                if (LoadInputDataArray.Num() > 0 && LoadInputDataArray[0].Profiler.IsValid()) {
+                    // SDKのバージョン間で比較できるよう、インポート毎にトレースと集計表を保存
+                    const auto& Profiler = LoadInputDataArray[0].Profiler;
+                    const auto ProfileDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PLATEAU/ImportProfile"));
+                    const auto BaseName = FString::Printf(TEXT("Import_%s"), *FDateTime::Now().ToString());
+                    if (Profiler->WriteReport(ProfileDirectory, BaseName))
+                        UE_LOG(LogTemp, Log, TEXT("Import profile: %s"), *FPaths::Combine(ProfileDirectory, BaseName));
+                    UE_LOG(LogTemp, Log, TEXT("Import profile summary:\n%s"), *Profiler->GetSummaryTable());
+                }
 
                 *Phase = ECityModelLoadingPhase::Finished;
                 FFunctionGraphTask::CreateAndDispatchWhenReady(
-                    [ImportFinishedDelegate] {
+                    [ImportFinishedDelegate, ModelActor = TWeakObjectPtr<APLATEAUInstancedCityModel>(ModelActor),
+                    bBuildSpatialCells = ImportSettings->bBuildSpatialCells && !bCanceledRef->Load(EMemoryOrder::Relaxed),
+                    SpatialCellSettings = ImportSettings->SpatialCellSettings] {
+                        // フィルタリング時に全コンポーネントを走査しないよう、追加したコンポーネントを含めて索引を作成しておく
+                        if (ModelActor.IsValid()) {
+                            ModelActor->InvalidateFilterIndex();
+                            ModelActor->BuildFilterIndex();
+                        }
                         ImportFinishedDelegate.Broadcast();
+
+                        // セル分割・プロキシ生成はインポート完了後に非同期で行い、完了はOnSpatialCellsBuiltで通知する
+                        if (bBuildSpatialCells && ModelActor.IsValid())
+                            ModelActor->BuildSpatialCells(SpatialCellSettings);
                     }, TStatId(), nullptr, ENamedThreads::GameThread);
             });
 
@@ -529,7 +641,12 @@ void APLATEAUCityModelLoader::LoadGmlAsync(const FString& GmlPath) {
             *Phase = ECityModelLoadingPhase::Finished;
 
             FFunctionGraphTask::CreateAndDispatchWhenReady(
-                [ImportFinishedDelegate] {
+                [ImportFinishedDelegate, ModelActor = TWeakObjectPtr<APLATEAUInstancedCityModel>(ModelActor)] {
+                    if (ModelActor.IsValid()) {
+                        ModelActor->InvalidateCityObjectIndex();
+                        ModelActor->InvalidateFilterIndex();
+                        ModelActor->BuildFilterIndex();
+                    }
                     ImportFinishedDelegate.Broadcast();
                 }, TStatId(), nullptr, ENamedThreads::GameThread);
 
@@ -542,6 +659,8 @@ void APLATEAUCityModelLoader::Cancel() {
     if (Phase == ECityModelLoadingPhase::Start) {
         bCanceled.Store(true);
         Phase = ECityModelLoadingPhase::Cancelling;
+        if (ImportScheduler.IsValid())
+            ImportScheduler->Cancel();
     }
 }
 
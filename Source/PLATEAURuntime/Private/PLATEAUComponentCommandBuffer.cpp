@@ -0,0 +1,73 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUComponentCommandBuffer.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+
+FPLATEAUComponentCommandBuffer::FState::FState() {
+    DrainedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FPLATEAUComponentCommandBuffer::FState::~FState() {
+    FPlatformProcess::ReturnSynchEventToPool(DrainedEvent);
+    DrainedEvent = nullptr;
+}
+
+FPLATEAUComponentCommandBuffer::FPLATEAUComponentCommandBuffer(const int32 InBatchSize, const float InTimeBudgetMs)
+    : BatchSize(FMath::Max(1, InBatchSize))
+    , TimeBudgetMs(FMath::Max(0.1f, InTimeBudgetMs))
+    , State(MakeShared<FState, ESPMode::ThreadSafe>()) {
+
+    // Tick毎にBatchSize個、またはTimeBudgetMsを超えるまでコマンドを実行
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda(
+        [WeakState = TWeakPtr<FState, ESPMode::ThreadSafe>(State), MaxCount = BatchSize, TimeBudgetSeconds = TimeBudgetMs / 1000.0](float) {
+            const auto PinnedState = WeakState.Pin();
+            if (!PinnedState.IsValid())
+                return false;
+
+            ExecuteBatch(*PinnedState, MaxCount, TimeBudgetSeconds);
+            return true;
+        }));
+}
+
+FPLATEAUComponentCommandBuffer::~FPLATEAUComponentCommandBuffer() {
+    Flush();
+    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+void FPLATEAUComponentCommandBuffer::Enqueue(TUniqueFunction<void()>&& Command) {
+    ++State->PendingCount;
+    State->Commands.Enqueue(MoveTemp(Command));
+}
+
+void FPLATEAUComponentCommandBuffer::Flush() {
+    if (IsInGameThread()) {
+        while (State->PendingCount.Load() > 0) {
+            if (!ExecuteBatch(*State, MAX_int32, TNumericLimits<double>::Max()))
+                break;
+        }
+        return;
+    }
+
+    while (State->PendingCount.Load() > 0) {
+        State->DrainedEvent->Wait(100);
+    }
+}
+
+bool FPLATEAUComponentCommandBuffer::ExecuteBatch(FState& State, const int32 MaxCount, const double TimeBudgetSeconds) {
+    const double StartSeconds = FPlatformTime::Seconds();
+    int32 ExecutedCount = 0;
+    TUniqueFunction<void()> Command;
+    while (ExecutedCount < MaxCount && State.Commands.Dequeue(Command)) {
+        Command();
+        Command.Reset();
+        ++ExecutedCount;
+
+        if (--State.PendingCount == 0)
+            State.DrainedEvent->Trigger();
+
+        if (FPlatformTime::Seconds() - StartSeconds > TimeBudgetSeconds)
+            break;
+    }
+    return ExecutedCount > 0;
+}
@@ -0,0 +1,242 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUImportProfiler.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+namespace {
+    const FString SharedGmlName = TEXT("(shared)");
+    constexpr int32 StageCount = static_cast<int32>(EPLATEAUImportStage::Count);
+    constexpr int32 CounterCount = static_cast<int32>(EPLATEAUImportCounter::Count);
+
+    FString FormatRow(const FString& Name, const double* StageSeconds, const int64* Counters) {
+        FString Row = FString::Printf(TEXT("%-40s"), *Name.Left(40));
+        for (int32 i = 0; i < StageCount; ++i) {
+            Row += FString::Printf(TEXT(" %12.1f"), StageSeconds[i] * 1000.0);
+        }
+        for (int32 i = 0; i < CounterCount; ++i) {
+            Row += FString::Printf(TEXT(" %12lld"), Counters[i]);
+        }
+        return Row + TEXT("\n");
+    }
+}
+
+FPLATEAUImportProfiler::FScope::FScope(FPLATEAUImportProfiler* InProfiler, const EPLATEAUImportStage InStage, const FString& InGmlName)
+    : Profiler(InProfiler)
+    , Stage(InStage) {
+    if (Profiler == nullptr)
+        return;
+
+    GmlName = InGmlName;
+    StartSeconds = FPlatformTime::Seconds();
+}
+
+FPLATEAUImportProfiler::FScope::~FScope() {
+    if (Profiler == nullptr)
+        return;
+
+    Profiler->AddEvent(Stage, GmlName, StartSeconds, FPlatformTime::Seconds());
+}
+
+void FPLATEAUImportProfiler::FStats::Append(const FStats& Other) {
+    for (int32 i = 0; i < StageCount; ++i) {
+        StageSeconds[i] += Other.StageSeconds[i];
+    }
+    for (int32 i = 0; i < CounterCount; ++i) {
+        Counters[i] += Other.Counters[i];
+    }
+}
+
+FPLATEAUImportProfiler::FPLATEAUImportProfiler()
+    : StartSeconds(FPlatformTime::Seconds()) {
+}
+
+void FPLATEAUImportProfiler::RegisterGml(const FString& GmlName, const FString& PackageName) {
+    FScopeLock Lock(&Section);
+    FindOrAddGml(GmlName).PackageName = PackageName;
+}
+
+void FPLATEAUImportProfiler::AddEvent(const EPLATEAUImportStage Stage, const FString& GmlName, const double InStartSeconds, const double EndSeconds) {
+    const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+
+    FScopeLock Lock(&Section);
+    int32 GmlIndex;
+    auto& Gml = FindOrAddGml(GmlName, &GmlIndex);
+    Gml.Stats.StageSeconds[static_cast<int32>(Stage)] += EndSeconds - InStartSeconds;
+    Events.Add({ Stage, GmlIndex, ThreadId, InStartSeconds, EndSeconds });
+}
+
+void FPLATEAUImportProfiler::AddCounter(const FString& GmlName, const EPLATEAUImportCounter Counter, const int64 Value) {
+    FScopeLock Lock(&Section);
+    FindOrAddGml(GmlName).Stats.Counters[static_cast<int32>(Counter)] += Value;
+}
+
+const TCHAR* FPLATEAUImportProfiler::GetStageName(const EPLATEAUImportStage Stage) {
+    switch (Stage) {
+    case EPLATEAUImportStage::Import: return TEXT("Import");
+    case EPLATEAUImportStage::CopyGml: return TEXT("CopyGml");
+    case EPLATEAUImportStage::ModelCache: return TEXT("ModelCache");
+    case EPLATEAUImportStage::ParseGml: return TEXT("ParseGml");
+    case EPLATEAUImportStage::ExtractMesh: return TEXT("ExtractMesh");
+    case EPLATEAUImportStage::ConvertMesh: return TEXT("ConvertMesh");
+    case EPLATEAUImportStage::CreateComponent: return TEXT("CreateComponent");
+    case EPLATEAUImportStage::CreateMaterial: return TEXT("CreateMaterial");
+    case EPLATEAUImportStage::BuildMesh: return TEXT("BuildMesh");
+    case EPLATEAUImportStage::DecodeTexture: return TEXT("DecodeTexture");
+    default: return TEXT("Unknown");
+    }
+}
+
+const TCHAR* FPLATEAUImportProfiler::GetCounterName(const EPLATEAUImportCounter Counter) {
+    switch (Counter) {
+    case EPLATEAUImportCounter::Vertices: return TEXT("Vertices");
+    case EPLATEAUImportCounter::Triangles: return TEXT("Triangles");
+    case EPLATEAUImportCounter::Components: return TEXT("Components");
+    case EPLATEAUImportCounter::Materials: return TEXT("Materials");
+    case EPLATEAUImportCounter::Textures: return TEXT("Textures");
+    case EPLATEAUImportCounter::Bytes: return TEXT("Bytes");
+    case EPLATEAUImportCounter::InstancedMeshes: return TEXT("UniqueMeshes");
+    case EPLATEAUImportCounter::Instances: return TEXT("Instances");
+    case EPLATEAUImportCounter::SavedDrawCalls: return TEXT("SavedDraws");
+    default: return TEXT("Unknown");
+    }
+}
+
+double FPLATEAUImportProfiler::GetStageSeconds(const EPLATEAUImportStage Stage, const FString& GmlName) const {
+    FScopeLock Lock(&Section);
+    double Seconds = 0.0;
+    for (int32 i = 0; i < GmlStats.Num(); ++i) {
+        if (GmlName.IsEmpty() || GmlNames[i] == GmlName)
+            Seconds += GmlStats[i].Stats.StageSeconds[static_cast<int32>(Stage)];
+    }
+    return Seconds;
+}
+
+int64 FPLATEAUImportProfiler::GetCounter(const EPLATEAUImportCounter Counter, const FString& GmlName) const {
+    FScopeLock Lock(&Section);
+    int64 Value = 0;
+    for (int32 i = 0; i < GmlStats.Num(); ++i) {
+        if (GmlName.IsEmpty() || GmlNames[i] == GmlName)
+            Value += GmlStats[i].Stats.Counters[static_cast<int32>(Counter)];
+    }
+    return Value;
+}
+
+FString FPLATEAUImportProfiler::GetChromeTrace() const {
+    FScopeLock Lock(&Section);
+
+    FString Json;
+    const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+    Writer->WriteObjectStart();
+    Writer->WriteValue(TEXT("displayTimeUnit"), FString(TEXT("ms")));
+    Writer->WriteArrayStart(TEXT("traceEvents"));
+
+    // 処理段階: 完了イベント(ph: X)。時間はインポート開始からのマイクロ秒
+    for (const auto& Event : Events) {
+        Writer->WriteObjectStart();
+        Writer->WriteValue(TEXT("name"), FString(GetStageName(Event.Stage)));
+        Writer->WriteValue(TEXT("cat"), GmlStats[Event.GmlIndex].PackageName.IsEmpty() ? SharedGmlName : GmlStats[Event.GmlIndex].PackageName);
+        Writer->WriteValue(TEXT("ph"), FString(TEXT("X")));
+        Writer->WriteValue(TEXT("ts"), (Event.StartSeconds - StartSeconds) * 1000000.0);
+        Writer->WriteValue(TEXT("dur"), (Event.EndSeconds - Event.StartSeconds) * 1000000.0);
+        Writer->WriteValue(TEXT("pid"), 1);
+        Writer->WriteValue(TEXT("tid"), static_cast<int64>(Event.ThreadId));
+        Writer->WriteObjectStart(TEXT("args"));
+        Writer->WriteValue(TEXT("gml"), GmlNames[Event.GmlIndex]);
+        Writer->WriteObjectEnd();
+        Writer->WriteObjectEnd();
+    }
+
+    // 処理量: GML毎にインスタントイベント(ph: i)の引数として出力
+    for (int32 i = 0; i < GmlStats.Num(); ++i) {
+        Writer->WriteObjectStart();
+        Writer->WriteValue(TEXT("name"), GmlNames[i]);
+        Writer->WriteValue(TEXT("cat"), FString(TEXT("Counters")));
+        Writer->WriteValue(TEXT("ph"), FString(TEXT("i")));
+        Writer->WriteValue(TEXT("s"), FString(TEXT("g")));
+        Writer->WriteValue(TEXT("ts"), (FPlatformTime::Seconds() - StartSeconds) * 1000000.0);
+        Writer->WriteValue(TEXT("pid"), 1);
+        Writer->WriteValue(TEXT("tid"), 0);
+        Writer->WriteObjectStart(TEXT("args"));
+        Writer->WriteValue(TEXT("package"), GmlStats[i].PackageName);
+        for (int32 j = 0; j < CounterCount; ++j) {
+            Writer->WriteValue(FString(GetCounterName(static_cast<EPLATEAUImportCounter>(j))), GmlStats[i].Stats.Counters[j]);
+        }
+        Writer->WriteObjectEnd();
+        Writer->WriteObjectEnd();
+    }
+
+    Writer->WriteArrayEnd();
+    Writer->WriteObjectEnd();
+    Writer->Close();
+    return Json;
+}
+
+FString FPLATEAUImportProfiler::GetSummaryTable() const {
+    FScopeLock Lock(&Section);
+
+    FString Header = FString::Printf(TEXT("%-40s"), TEXT("Package / GML"));
+    for (int32 i = 0; i < StageCount; ++i) {
+        Header += FString::Printf(TEXT(" %12s"), *FString::Printf(TEXT("%s(ms)"), GetStageName(static_cast<EPLATEAUImportStage>(i))).Right(12));
+    }
+    for (int32 i = 0; i < CounterCount; ++i) {
+        Header += FString::Printf(TEXT(" %12s"), GetCounterName(static_cast<EPLATEAUImportCounter>(i)));
+    }
+
+    // パッケージ毎に集計し、パッケージ名、GML名順に出力
+    TMap<FString, TArray<int32>> PackageToGmls;
+    for (int32 i = 0; i < GmlStats.Num(); ++i) {
+        PackageToGmls.FindOrAdd(GmlStats[i].PackageName.IsEmpty() ? SharedGmlName : GmlStats[i].PackageName).Add(i);
+    }
+    PackageToGmls.KeySort(TLess<FString>());
+
+    FString Table = Header + TEXT("\n");
+    FStats Total;
+    for (auto& Package : PackageToGmls) {
+        Package.Value.Sort([this](const int32 A, const int32 B) {
+            return GmlNames[A] < GmlNames[B];
+        });
+
+        FStats PackageTotal;
+        for (const auto GmlIndex : Package.Value) {
+            PackageTotal.Append(GmlStats[GmlIndex].Stats);
+        }
+        Total.Append(PackageTotal);
+
+        Table += FormatRow(FString::Printf(TEXT("[%s] (%d)"), *Package.Key, Package.Value.Num()), PackageTotal.StageSeconds, PackageTotal.Counters);
+        for (const auto GmlIndex : Package.Value) {
+            Table += FormatRow(TEXT("  ") + GmlNames[GmlIndex], GmlStats[GmlIndex].Stats.StageSeconds, GmlStats[GmlIndex].Stats.Counters);
+        }
+    }
+    Table += FormatRow(TEXT("Total"), Total.StageSeconds, Total.Counters);
+    Table += FString::Printf(TEXT("Wall time: %.3f s\n"), FPlatformTime::Seconds() - StartSeconds);
+    return Table;
+}
+
+bool FPLATEAUImportProfiler::WriteReport(const FString& Directory, const FString& BaseName) const {
+    const bool bTraceWritten = FFileHelper::SaveStringToFile(GetChromeTrace(), *FPaths::Combine(Directory, BaseName + TEXT(".json")),
+        FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    const bool bSummaryWritten = FFileHelper::SaveStringToFile(GetSummaryTable(), *FPaths::Combine(Directory, BaseName + TEXT(".txt")),
+        FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    return bTraceWritten && bSummaryWritten;
+}
+
+FPLATEAUImportProfiler::FGmlStats& FPLATEAUImportProfiler::FindOrAddGml(const FString& GmlName, int32* OutGmlIndex) {
+    const FString& Name = GmlName.IsEmpty() ? SharedGmlName : GmlName;
+    int32 GmlIndex;
+    if (const auto Found = GmlNameToIndex.Find(Name)) {
+        GmlIndex = *Found;
+    }
+    else {
+        GmlIndex = GmlNames.Add(Name);
+        GmlStats.AddDefaulted();
+        GmlNameToIndex.Add(Name, GmlIndex);
+    }
+
+    if (OutGmlIndex != nullptr)
+        *OutGmlIndex = GmlIndex;
+    return GmlStats[GmlIndex];
+}
@@ -0,0 +1,204 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUImportScheduler.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/QueuedThreadPool.h"
+
+namespace {
+    // CityGMLのパースは再帰が深いため、ワーカースレッドのスタックは大きめに確保する
+    constexpr uint32 WorkerStackSize = 8 * 1024 * 1024;
+
+    TSharedRef<FPLATEAUMemoryBudget, ESPMode::ThreadSafe> CreateDefaultMemoryBudget() {
+        const int64 AvailableBytes = static_cast<int64>(FPlatformMemory::GetStats().AvailablePhysical);
+        return MakeShared<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>(AvailableBytes / 2);
+    }
+}
+
+class FPLATEAUImportScheduler::FWork : public IQueuedWork {
+public:
+    FWork(FPLATEAUImportScheduler& InScheduler, const int32 InJobId, FJob&& InJob, FReservationPtr&& InReservation)
+        : Scheduler(InScheduler)
+        , JobId(InJobId)
+        , Job(MoveTemp(InJob))
+        , Reservation(MoveTemp(InReservation)) {
+    }
+
+    virtual void DoThreadedWork() override {
+        Job(Reservation);
+
+        // 完了通知の前にメモリとジョブが保持するデータを解放し、次のジョブを開始できるようにする
+        Job = nullptr;
+        Reservation.Reset();
+        Scheduler.OnJobFinished(JobId);
+        delete this;
+    }
+
+    virtual void Abandon() override {
+        Job = nullptr;
+        Reservation.Reset();
+        Scheduler.OnJobFinished(JobId);
+        delete this;
+    }
+
+private:
+    FPLATEAUImportScheduler& Scheduler;
+    int32 JobId;
+    FJob Job;
+    FReservationPtr Reservation;
+};
+
+FPLATEAUImportScheduler::FPLATEAUImportScheduler(const int32 InNumWorkers, const TSharedPtr<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>& InMemoryBudget)
+    : NumWorkers(InNumWorkers > 0 ? InNumWorkers : FMath::Max(1, FPlatformMisc::NumberOfCores()))
+    , MemoryBudget(InMemoryBudget.IsValid() ? InMemoryBudget.ToSharedRef() : CreateDefaultMemoryBudget()) {
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    ThreadPool = FQueuedThreadPool::Allocate();
+    verify(ThreadPool->Create(NumWorkers, WorkerStackSize, TPri_Normal, TEXT("PLATEAUImportWorker")));
+}
+
+FPLATEAUImportScheduler::~FPLATEAUImportScheduler() {
+    CancelPendingJobs();
+    ThreadPool->Destroy();
+    delete ThreadPool;
+    ThreadPool = nullptr;
+    FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    WakeEvent = nullptr;
+}
+
+int32 FPLATEAUImportScheduler::Enqueue(const int64 EstimatedBytes, FJob&& Job, FOnCanceled&& OnCanceled) {
+    int32 JobId;
+    {
+        FScopeLock Lock(&Section);
+        JobId = NextJobId++;
+        if (!bCanceled) {
+            PendingJobs.Add({ JobId, EstimatedBytes, MoveTemp(Job), MoveTemp(OnCanceled) });
+            WakeEvent->Trigger();
+            return JobId;
+        }
+        ++CanceledCount;
+        ++CompletedCount;
+    }
+
+    if (OnCanceled)
+        OnCanceled();
+    return JobId;
+}
+
+void FPLATEAUImportScheduler::Run(const TAtomic<bool>* bExternalCanceled, FOnProgress OnProgress) {
+    const double StartSeconds = FPlatformTime::Seconds();
+
+    // メモリが返却されたら待機中のジョブを開始できるか再確認する
+    FEvent* Event = WakeEvent;
+    MemoryBudget->SetOnReleased([Event] {
+        Event->Trigger();
+    });
+
+    TArray<int32> CurrentRunningJobIds;
+    while (true) {
+        if (bExternalCanceled != nullptr && bExternalCanceled->Load(EMemoryOrder::Relaxed))
+            CancelPendingJobs();
+
+        DispatchJobs();
+
+        int32 CurrentCompletedCount;
+        bool bFinished;
+        {
+            FScopeLock Lock(&Section);
+            CurrentRunningJobIds = RunningJobIds;
+            CurrentCompletedCount = CompletedCount;
+            bFinished = PendingHead == PendingJobs.Num() && RunningJobIds.Num() == 0;
+        }
+
+        OnProgress(CurrentRunningJobIds, CurrentCompletedCount);
+        if (bFinished)
+            break;
+
+        WakeEvent->Wait();
+    }
+
+    MemoryBudget->SetOnReleased(nullptr);
+
+    FScopeLock Lock(&Section);
+    WallSeconds += FPlatformTime::Seconds() - StartSeconds;
+}
+
+void FPLATEAUImportScheduler::Cancel() {
+    CancelPendingJobs();
+}
+
+void FPLATEAUImportScheduler::DispatchJobs() {
+    TArray<FWork*> Works;
+    {
+        FScopeLock Lock(&Section);
+        while (PendingHead < PendingJobs.Num() && RunningJobIds.Num() < NumWorkers) {
+            auto& PendingJob = PendingJobs[PendingHead];
+
+            // 積まれた順に開始するため、先頭のジョブが確保できない場合は後続も待機する
+            auto Reservation = MemoryBudget->TryAcquire(PendingJob.EstimatedBytes);
+            if (!Reservation.IsValid())
+                break;
+
+            RunningJobIds.Add(PendingJob.JobId);
+            PeakRunningJobs = FMath::Max(PeakRunningJobs, RunningJobIds.Num());
+            Works.Add(new FWork(*this, PendingJob.JobId, MoveTemp(PendingJob.Job), MoveTemp(Reservation)));
+            ++PendingHead;
+        }
+
+        if (PendingHead == PendingJobs.Num()) {
+            PendingJobs.Reset();
+            PendingHead = 0;
+        }
+    }
+
+    for (const auto Work : Works) {
+        ThreadPool->AddQueuedWork(Work);
+    }
+}
+
+void FPLATEAUImportScheduler::OnJobFinished(const int32 JobId) {
+    {
+        FScopeLock Lock(&Section);
+        RunningJobIds.Remove(JobId);
+        ++CompletedCount;
+    }
+    WakeEvent->Trigger();
+}
+
+void FPLATEAUImportScheduler::CancelPendingJobs() {
+    TArray<FOnCanceled> CanceledCallbacks;
+    {
+        FScopeLock Lock(&Section);
+        bCanceled = true;
+        for (int32 i = PendingHead; i < PendingJobs.Num(); ++i) {
+            CanceledCallbacks.Add(MoveTemp(PendingJobs[i].OnCanceled));
+        }
+        // 開始前に破棄したジョブも完了数に含め、進捗が全ジョブ数に達するようにする
+        CanceledCount += PendingJobs.Num() - PendingHead;
+        CompletedCount += PendingJobs.Num() - PendingHead;
+        PendingJobs.Reset();
+        PendingHead = 0;
+    }
+
+    for (auto& OnCanceled : CanceledCallbacks) {
+        if (OnCanceled)
+            OnCanceled();
+    }
+    WakeEvent->Trigger();
+}
+
+int32 FPLATEAUImportScheduler::GetPeakRunningJobs() const {
+    FScopeLock Lock(&Section);
+    return PeakRunningJobs;
+}
+
+int64 FPLATEAUImportScheduler::GetPeakBytes() const {
+    return MemoryBudget->GetPeakBytes();
+}
+
+FString FPLATEAUImportScheduler::GetStatsString() const {
+    FScopeLock Lock(&Section);
+    return FString::Printf(TEXT("Workers: %d, Jobs: %d (Canceled: %d), Peak running: %d, Peak in-flight: %.2f MB / %.2f MB, Wall time: %.3f s"),
+        NumWorkers, NextJobId, CanceledCount, PeakRunningJobs,
+        MemoryBudget->GetPeakBytes() / (1024.0 * 1024.0), MemoryBudget->GetBudgetBytes() / (1024.0 * 1024.0), WallSeconds);
+}
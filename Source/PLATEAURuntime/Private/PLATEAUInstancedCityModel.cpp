@@ -18,10 +18,14 @@
 #include <Reconstruct/PLATEAUMeshLoaderForLandscapeMesh.h>
 #include <Reconstruct/PLATEAUModelAlignLand.h>
 #include <PLATEAUModelFiltering.h>
+#include "PLATEAUCityModelCellProxy.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
 #include <Util/PLATEAUReconstructUtil.h>
 #include <Util/PLATEAUComponentUtil.h>
 #include <Util/PLATEAUGmlUtil.h>
 #include "Tasks/Pipe.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 
 using namespace UE::Tasks;
 using namespace plateau::granularityConvert;
@@ -71,12 +75,132 @@ TArray<FPLATEAUCityObject>& APLATEAUInstancedCityModel::GetAllRootCityObjects()
     return RootCityObjects;
 }
 
+bool APLATEAUInstancedCityModel::GetCityObjectByGmlID(const FString& GmlID, UPLATEAUCityObjectGroup*& OutComponent, FPLATEAUCityObject& OutCityObject) {
+    OutComponent = nullptr;
+    if (const auto CityObject = FindCityObjectByGmlID(GmlID, &OutComponent)) {
+        OutCityObject = *CityObject;
+        return true;
+    }
+    return false;
+}
+
+const FPLATEAUCityObject* APLATEAUInstancedCityModel::FindCityObjectByGmlID(const FString& GmlID, UPLATEAUCityObjectGroup** OutComponent) {
+    USceneComponent* Component = nullptr;
+    const auto CityObject = FindCityObjectByGmlID(GmlID, Component);
+    if (OutComponent != nullptr)
+        *OutComponent = Cast<UPLATEAUCityObjectGroup>(Component);
+    return CityObject;
+}
+
+const FPLATEAUCityObject* APLATEAUInstancedCityModel::FindCityObjectByGmlID(const FString& GmlID, USceneComponent*& OutComponent) {
+    OutComponent = nullptr;
+
+    // 同じGML IDを持つコンポーネントが複数ある場合(複数Lodなど)は表示中のものを優先する
+    const auto FindComponent = [this, &GmlID]() -> USceneComponent* {
+        BuildCityObjectIndex();
+        const auto Components = GmlIdToComponents.Find(GmlID);
+        if (Components == nullptr)
+            return nullptr;
+
+        USceneComponent* Result = nullptr;
+        for (const auto& Component : *Components) {
+            if (!Component.IsValid())
+                continue;
+
+            if (Result == nullptr || (!Result->IsVisible() && Component->IsVisible()))
+                Result = Component.Get();
+        }
+        return Result;
+    };
+
+    // コンポーネントの追加時は索引が破棄されるため、見つかったコンポーネントが全て削除済みの場合のみ作り直す
+    auto Found = FindComponent();
+    if (Found == nullptr && GmlIdToComponents.Contains(GmlID)) {
+        InvalidateCityObjectIndex();
+        Found = FindComponent();
+    }
+    if (Found == nullptr)
+        return nullptr;
+
+    OutComponent = Found;
+    if (const auto InstancedGroup = Cast<UPLATEAUInstancedCityObjectGroup>(Found))
+        return InstancedGroup->FindCityObjectByID(GmlID);
+    return CastChecked<UPLATEAUCityObjectGroup>(Found)->FindCityObjectByID(GmlID);
+}
+
+void APLATEAUInstancedCityModel::InvalidateCityObjectIndex() {
+    bCityObjectIndexBuilt = false;
+    GmlIdToComponents.Empty();
+    RootCityObjects.Empty();
+}
+
+void APLATEAUInstancedCityModel::InvalidateFilterIndex() {
+    FilterIndex.Reset();
+    RuntimeLod.Reset();
+}
+
+void APLATEAUInstancedCityModel::BuildFilterIndex() {
+    if (FilterIndex.IsBuilt())
+        return;
+    FilterIndex.Build(GetGmlComponents(), &FeatureTypeTables);
+}
+
+void APLATEAUInstancedCityModel::AddFeatureTypeTable(const FString& GmlFileName, FPLATEAUFeatureTypeTable&& FeatureTypeTable) {
+    FeatureTypeTables.Add(GmlFileName, MoveTemp(FeatureTypeTable));
+    InvalidateFilterIndex();
+}
+
+const FPLATEAUFeatureTypeTable* APLATEAUInstancedCityModel::FindFeatureTypeTable(const FString& GmlFileName) const {
+    return FeatureTypeTables.Find(GmlFileName);
+}
+
+void APLATEAUInstancedCityModel::BuildCityObjectIndex() {
+    if (bCityObjectIndexBuilt)
+        return;
+    bCityObjectIndexBuilt = true;
+
+    // 属性情報のツリーは作らず、各コンポーネントが自身で保持するGML IDのみ登録する
+    const auto AddToIndex = [this](const FPLATEAUCityObjectBinary& CityObjectsBinary, USceneComponent* Component) {
+        for (int32 i = 0; i < CityObjectsBinary.GetObjectCount(); ++i) {
+            auto& Components = GmlIdToComponents.FindOrAdd(CityObjectsBinary.GetGmlID(i));
+            if (!Components.Contains(Component))
+                Components.Add(Component);
+        }
+    };
+    TInlineComponentArray<UPLATEAUCityObjectGroup*> CityObjectGroups(this);
+    for (const auto& CityObjectGroup : CityObjectGroups) {
+        AddToIndex(CityObjectGroup->GetCityObjectsBinary(), CityObjectGroup);
+    }
+    TInlineComponentArray<UPLATEAUInstancedCityObjectGroup*> InstancedGroups(this);
+    for (const auto& InstancedGroup : InstancedGroups) {
+        for (int32 i = 0; i < InstancedGroup->GetInstanceCount(); ++i) {
+            AddToIndex(InstancedGroup->GetCityObjectsBinary(i), InstancedGroup);
+        }
+    }
+}
+
 void APLATEAUInstancedCityModel::BeginPlay() {
     Super::BeginPlay();
 }
 
 void APLATEAUInstancedCityModel::Tick(float DeltaTime) {
     Super::Tick(DeltaTime);
+
+    if (!bEnableRuntimeLod || bIsFiltering)
+        return;
+
+    const auto PlayerController = GetWorld()->GetFirstPlayerController();
+    if (PlayerController == nullptr || PlayerController->PlayerCameraManager == nullptr)
+        return;
+
+    UpdateRuntimeLod(PlayerController->PlayerCameraManager->GetCameraLocation(), PlayerController->PlayerCameraManager->GetFOVAngle());
+}
+
+int32 APLATEAUInstancedCityModel::UpdateRuntimeLod(const FVector& ViewOrigin, const float FOVDegrees) {
+    BuildFilterIndex();
+    if (!RuntimeLod.IsBuilt())
+        RuntimeLod.Build(FilterIndex);
+    return RuntimeLod.Update(FilterIndex, ViewOrigin, FOVDegrees, RuntimeLodSettings);
 }
 
 plateau::dataset::PredefinedCityModelPackage APLATEAUInstancedCityModel::GetCityModelPackages() const {
@@ -89,18 +213,37 @@ plateau::dataset::PredefinedCityModelPackage APLATEAUInstancedCityModel::GetCity
 
 APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByLods(const plateau::dataset::PredefinedCityModelPackage InPackage, const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod) {
     bIsFiltering = true;
+    BuildFilterIndex();
     FPLATEAUModelFiltering Filter;
-    Filter.FilterByLods(GetGmlComponents(), InPackage, PackageToLodRangeMap, bOnlyMaxLod);
+    Filter.FilterByLods(FilterIndex, InPackage, PackageToLodRangeMap, bOnlyMaxLod);
+    // フィルタリング後の表示状態から作り直す
+    RuntimeLod.Reset();
     bIsFiltering = false;
     return this;
 }
 
 APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByFeatureTypes(const citygml::CityObject::CityObjectsType InCityObjectType) {
-    if (!HasAttributeInfo())
+    if (!HasAttributeInfo() && !HasFeatureTypeTables())
         return FilterByFeatureTypesLegacy(InCityObjectType);
     bIsFiltering = true;
+    BuildFilterIndex();
+    FPLATEAUModelFiltering Filter;
+    Filter.FilterByFeatureTypes(FilterIndex, InCityObjectType);
+    // フィルタリング後の表示状態から作り直す
+    RuntimeLod.Reset();
+    bIsFiltering = false;
+    return this;
+}
+
+APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByLodsAndFeatureTypes(const plateau::dataset::PredefinedCityModelPackage InPackage, const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod, const citygml::CityObject::CityObjectsType InCityObjectType) {
+    if (!HasAttributeInfo() && !HasFeatureTypeTables())
+        return FilterByLods(InPackage, PackageToLodRangeMap, bOnlyMaxLod)->FilterByFeatureTypesLegacy(InCityObjectType);
+    bIsFiltering = true;
+    BuildFilterIndex();
     FPLATEAUModelFiltering Filter;
-    Filter.FilterByFeatureTypes(GetGmlComponents(), InCityObjectType);
+    Filter.FilterByLodsAndFeatureTypes(FilterIndex, InPackage, PackageToLodRangeMap, bOnlyMaxLod, InCityObjectType);
+    // フィルタリング後の表示状態から作り直す
+    RuntimeLod.Reset();
     bIsFiltering = false;
     return this;
 }
@@ -118,6 +261,7 @@ APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByFeatureTypesLega
                 FFunctionGraphTask::CreateAndDispatchWhenReady(
                     [this, InCityObjectType, &Filter] {
                         Filter.FilterByFeatureTypesLegacyMain(GetGmlComponents(), InCityObjectType, DatasetName);
+                        RuntimeLod.Reset();
                     }, TStatId(), nullptr, ENamedThreads::GameThread);
             GameThreadTask->Wait();
             bIsFiltering = false;
@@ -150,6 +294,22 @@ bool APLATEAUInstancedCityModel::HasAttributeInfo() {
         });
 }
 
+bool APLATEAUInstancedCityModel::HasFeatureTypeTables() const {
+    if (FeatureTypeTables.IsEmpty())
+        return false;
+
+    for (const auto& GmlComponent : GetGmlComponents()) {
+        // 起伏は地物タイプによるフィルタリングの対象外
+        if (GmlComponent.GetName().Contains("BillboardComponent") ||
+            FPLATEAUGmlUtil::GetCityModelPackage(GmlComponent) == plateau::dataset::PredefinedCityModelPackage::Relief)
+            continue;
+
+        if (!FeatureTypeTables.Contains(FPLATEAUGmlUtil::GetGmlFileName(GmlComponent)))
+            return false;
+    }
+    return true;
+}
+
 TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ReconstructModel(const TArray<USceneComponent*>& TargetComponents, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal)  {
 
     UE_LOG(LogTemp, Log, TEXT("ReconstructModel: %d %d %s"), TargetComponents.Num(), static_cast<int>(ReconstructType), bDestroyOriginal ? TEXT("True") : TEXT("False"));
@@ -160,6 +320,8 @@ TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ReconstructModel(con
         AddNested(Task);
         Task.Wait();
         FFunctionGraphTask::CreateAndDispatchWhenReady([&]() {
+            InvalidateCityObjectIndex();
+            InvalidateFilterIndex();
             //終了イベント通知
             OnReconstructFinished.Broadcast();
             }, TStatId(), NULL, ENamedThreads::GameThread);
@@ -181,6 +343,8 @@ TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ClassifyModel(const
         Task.Wait();
         
         FFunctionGraphTask::CreateAndDispatchWhenReady([&]() {
+            InvalidateCityObjectIndex();
+            InvalidateFilterIndex();
             //終了イベント通知
             OnClassifyFinished.Broadcast();
             }, TStatId(), NULL, ENamedThreads::GameThread);
@@ -202,6 +366,8 @@ UE::Tasks::TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ClassifyM
         Task.Wait();
 
         FFunctionGraphTask::CreateAndDispatchWhenReady([&]() {
+            InvalidateCityObjectIndex();
+            InvalidateFilterIndex();
             //終了イベント通知
             OnClassifyFinished.Broadcast();
             }, TStatId(), NULL, ENamedThreads::GameThread);
@@ -324,6 +490,8 @@ UE::Tasks::FTask APLATEAUInstancedCityModel::CreateLandscape(const TArray<UScene
             if (Param.ConvertTerrain)
                 FPLATEAUComponentUtil::DestroyOrHideComponents(TargetCityObjects, bDestroyOriginal);
 
+            InvalidateCityObjectIndex();
+            InvalidateFilterIndex();
             //終了イベント通知
             EPLATEAULandscapeCreationResult Res = Results.Num() > 0 ? EPLATEAULandscapeCreationResult::Success : EPLATEAULandscapeCreationResult::Fail;
             OnLandscapeCreationFinished.Broadcast(Res);
@@ -333,6 +501,49 @@ UE::Tasks::FTask APLATEAUInstancedCityModel::CreateLandscape(const TArray<UScene
     return CreateLandscapeTask;
 }
 
+TTask<FPLATEAUSpatialCellStats> APLATEAUInstancedCityModel::BuildSpatialCells(const FPLATEAUSpatialCellSettings& Settings) {
+    check(IsInGameThread());
+
+    UE_LOG(LogTemp, Log, TEXT("BuildSpatialCells: %d %s"), Settings.Subdivision, Settings.bGenerateProxies ? TEXT("True") : TEXT("False"));
+    ClearSpatialCells();
+
+    // コンポーネント構造の走査はゲームスレッドで行い、プロキシのメッシュ生成のみワーカースレッドで行う
+    const FPLATEAUSpatialCellBuilder Builder(this, Settings);
+    auto Cells = Builder.Partition();
+    TArray<TArray<UPLATEAUCityObjectGroup*>> ProxySources;
+    if (Settings.bGenerateProxies) {
+        for (const auto& Cell : Cells) {
+            ProxySources.Add(Builder.CollectProxySources(Cell));
+        }
+    }
+
+    TTask<FPLATEAUSpatialCellStats> BuildSpatialCellsTask = Launch(TEXT("BuildSpatialCellsTask"), [this, Builder, Cells = MoveTemp(Cells), ProxySources = MoveTemp(ProxySources)]() mutable {
+        for (int32 i = 0; i < ProxySources.Num(); ++i) {
+            Builder.GenerateProxy(Cells[i], ProxySources[i]);
+        }
+
+        FPLATEAUSpatialCellStats Stats;
+        FFunctionGraphTask::CreateAndDispatchWhenReady([&]() {
+            Stats = Builder.Finalize(Cells);
+            SpatialCells = MoveTemp(Cells);
+            UE_LOG(LogTemp, Log, TEXT("Spatial cells: %s"), *Stats.ToString());
+            //終了イベント通知
+            OnSpatialCellsBuilt.Broadcast();
+            }, TStatId(), NULL, ENamedThreads::GameThread)->Wait();
+        return Stats;
+    });
+    return BuildSpatialCellsTask;
+}
+
+void APLATEAUInstancedCityModel::ClearSpatialCells() {
+    for (const auto& Cell : SpatialCells) {
+        FPLATEAUSpatialCellBuilder::ResetDrawDistances(Cell);
+        if (IsValid(Cell.Proxy))
+            Cell.Proxy->Destroy();
+    }
+    SpatialCells.Reset();
+}
+
 TArray<UPLATEAUCityObjectGroup*> APLATEAUInstancedCityModel::AlignLand(TArray<HeightmapCreationResult>& Results, const FPLATEAULandscapeParam& Param, bool bDestroyOriginal) {
 
     FPLATEAUModelAlignLand ModelAlign(this);
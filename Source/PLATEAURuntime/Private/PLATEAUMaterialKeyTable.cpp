@@ -0,0 +1,70 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUMaterialKeyTable.h"
+#include <citygml/material.h>
+
+namespace {
+    int32 Quantize(const double Value) {
+        const double Scaled = FMath::RoundToDouble(Value * FPLATEAUMaterialKeyTable::QuantizationScale);
+        return static_cast<int32>(FMath::Clamp(Scaled, static_cast<double>(MIN_int32), static_cast<double>(MAX_int32)));
+    }
+
+    void QuantizeVector(int32* OutValues, const TVec3f& Value) {
+        OutValues[0] = Quantize(Value.x);
+        OutValues[1] = Quantize(Value.y);
+        OutValues[2] = Quantize(Value.z);
+    }
+}
+
+void FPLATEAUMaterialKey::UpdateHash() {
+    Hash = FCrc::MemCrc32(this, STRUCT_OFFSET(FPLATEAUMaterialKey, Hash));
+}
+
+int32 FPLATEAUMaterialKeyTable::InternTexturePath(const FString& TexturePath) {
+    if (TexturePath.IsEmpty())
+        return INDEX_NONE;
+
+    {
+        FReadScopeLock ReadLock(TexturePathLock);
+        if (const auto FoundID = TexturePathToID.Find(TexturePath))
+            return *FoundID;
+    }
+
+    FWriteScopeLock WriteLock(TexturePathLock);
+    if (const auto FoundID = TexturePathToID.Find(TexturePath))
+        return *FoundID;
+    return TexturePathToID.Add(TexturePath, TexturePathToID.Num());
+}
+
+FPLATEAUMaterialKey FPLATEAUMaterialKeyTable::MakeKey(const std::shared_ptr<const citygml::Material>& Material,
+    const FString& TexturePath, const int32 GameMaterialID) {
+    FPLATEAUMaterialKey Key;
+    Key.TexturePathID = InternTexturePath(TexturePath);
+    Key.GameMaterialID = GameMaterialID;
+    if (Material != nullptr) {
+        Key.bHasMaterial = 1;
+        Key.bIsSmooth = Material->isSmooth() ? 1 : 0;
+        QuantizeVector(&Key.QuantizedParameters[FPLATEAUMaterialKey::DiffuseOffset], Material->getDiffuse());
+        QuantizeVector(&Key.QuantizedParameters[FPLATEAUMaterialKey::SpecularOffset], Material->getSpecular());
+        QuantizeVector(&Key.QuantizedParameters[FPLATEAUMaterialKey::EmissiveOffset], Material->getEmissive());
+        Key.QuantizedParameters[FPLATEAUMaterialKey::ShininessOffset] = Quantize(Material->getShininess());
+        Key.QuantizedParameters[FPLATEAUMaterialKey::TransparencyOffset] = Quantize(Material->getTransparency());
+        Key.QuantizedParameters[FPLATEAUMaterialKey::AmbientOffset] = Quantize(Material->getAmbientIntensity());
+    }
+    Key.UpdateHash();
+    return Key;
+}
+
+int32 FPLATEAUMaterialKeyTable::GetTexturePathCount() const {
+    FReadScopeLock ReadLock(TexturePathLock);
+    return TexturePathToID.Num();
+}
+
+FString FPLATEAUMaterialKeyTable::GetStatsString() const {
+    return FString::Printf(
+        TEXT("Textures: %d, SubMesh material dedup: %.1f%% (%lld/%lld), Material cache hit: %.1f%% (%lld/%lld), Material instances created: %lld"),
+        GetTexturePathCount(),
+        GetSubMeshHitRate() * 100.0, SubMeshHitCount.Load(), SubMeshLookupCount.Load(),
+        GetMaterialCacheHitRate() * 100.0, MaterialCacheHitCount.Load(), MaterialCacheLookupCount.Load(),
+        MaterialInstanceCount.Load());
+}
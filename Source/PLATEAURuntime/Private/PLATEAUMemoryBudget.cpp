@@ -0,0 +1,172 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUMemoryBudget.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+
+namespace {
+    // CityGMLのパース結果(テッセレーション済み)とメッシュ抽出結果を合わせた、ファイルサイズに対するメモリ量の倍率
+    constexpr int64 GmlMemoryExpansionFactor = 8;
+
+    // キャンセルはイベントで通知されないため、キャンセル可能な待機ではこの間隔で確認する
+    constexpr uint32 CancelCheckIntervalMs = 50;
+}
+
+FPLATEAUMemoryReservation::FPLATEAUMemoryReservation(const TSharedRef<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>& InBudget, const int64 InBytes)
+    : Budget(InBudget)
+    , Bytes(InBytes) {
+}
+
+FPLATEAUMemoryReservation::~FPLATEAUMemoryReservation() {
+    Budget->Release(Bytes);
+}
+
+void FPLATEAUMemoryReservation::Shrink(const int64 NewBytes) {
+    const int64 ClampedBytes = FMath::Max<int64>(NewBytes, 0);
+    if (ClampedBytes >= Bytes)
+        return;
+
+    Budget->Release(Bytes - ClampedBytes);
+    Bytes = ClampedBytes;
+}
+
+FPLATEAUMemoryBudget::FPLATEAUMemoryBudget(const int64 InBudgetBytes)
+    : BudgetBytes(FMath::Max<int64>(InBudgetBytes, 1)) {
+}
+
+TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe> FPLATEAUMemoryBudget::Acquire(const int64 Bytes, const TAtomic<bool>* bCanceled) {
+    const double StartSeconds = FPlatformTime::Seconds();
+
+    const int64 RequestedBytes = FMath::Max<int64>(Bytes, 0);
+    WarnIfOversized(RequestedBytes);
+
+    // 確保できない場合は待機者として登録し、メモリの返却時にイベントで起こされるまで待つ
+    // 登録は確保の判定と同じロック内で行うため、その間の返却を取りこぼさない
+    FEvent* ReleasedEvent = nullptr;
+    bool bReserved = false;
+    while (true) {
+        {
+            FScopeLock Lock(&Section);
+            if (ReleasedEvent != nullptr)
+                Waiters.Remove(ReleasedEvent);
+
+            bReserved = TryReserveLocked(RequestedBytes);
+            if (bReserved || (bCanceled != nullptr && bCanceled->Load(EMemoryOrder::Relaxed)))
+                break;
+
+            if (ReleasedEvent == nullptr)
+                ReleasedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+            Waiters.Add(ReleasedEvent);
+        }
+        ReleasedEvent->Wait(bCanceled != nullptr ? CancelCheckIntervalMs : MAX_uint32);
+    }
+
+    if (ReleasedEvent != nullptr)
+        FPlatformProcess::ReturnSynchEventToPool(ReleasedEvent);
+
+    {
+        FScopeLock Lock(&Section);
+        WaitMicroseconds += static_cast<int64>((FPlatformTime::Seconds() - StartSeconds) * 1000000.0);
+    }
+    if (!bReserved)
+        return nullptr;
+    return MakeShared<FPLATEAUMemoryReservation, ESPMode::ThreadSafe>(AsShared(), RequestedBytes);
+}
+
+TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe> FPLATEAUMemoryBudget::TryAcquire(const int64 Bytes) {
+    const int64 RequestedBytes = FMath::Max<int64>(Bytes, 0);
+    {
+        FScopeLock Lock(&Section);
+        if (!TryReserveLocked(RequestedBytes))
+            return nullptr;
+    }
+    WarnIfOversized(RequestedBytes);
+    return MakeShared<FPLATEAUMemoryReservation, ESPMode::ThreadSafe>(AsShared(), RequestedBytes);
+}
+
+bool FPLATEAUMemoryBudget::TryReserveLocked(const int64 RequestedBytes) {
+    // 予算を超える要求は予算に切り詰めず、他の確保が無い時に単独で確保して実際の量を記録する
+    if (UsedBytes > 0 && UsedBytes + RequestedBytes > BudgetBytes)
+        return false;
+
+    if (RequestedBytes > BudgetBytes) {
+        ++OversizedCount;
+        OversizedBytes += RequestedBytes - BudgetBytes;
+    }
+    UsedBytes += RequestedBytes;
+    PeakBytes = FMath::Max(PeakBytes, UsedBytes);
+    return true;
+}
+
+void FPLATEAUMemoryBudget::WarnIfOversized(const int64 RequestedBytes) const {
+    if (RequestedBytes <= BudgetBytes)
+        return;
+
+    UE_LOG(LogTemp, Warning, TEXT("Memory request exceeds import memory budget: %.2f MB > %.2f MB. It is processed alone."),
+        RequestedBytes / (1024.0 * 1024.0), BudgetBytes / (1024.0 * 1024.0));
+}
+
+void FPLATEAUMemoryBudget::SetOnReleased(TFunction<void()> InOnReleased) {
+    FScopeLock Lock(&Section);
+    OnReleased = MoveTemp(InOnReleased);
+}
+
+int64 FPLATEAUMemoryBudget::EstimateGmlBytes(const FString& GmlPath) {
+    const int64 FileSize = IFileManager::Get().FileSize(*GmlPath);
+    return FileSize > 0 ? FileSize * GmlMemoryExpansionFactor : 0;
+}
+
+int64 FPLATEAUMemoryBudget::EstimateModelBytes(const plateau::polygonMesh::Model& Model) {
+    int64 Bytes = 0;
+    for (const auto Mesh : Model.getAllMeshes()) {
+        if (Mesh == nullptr)
+            continue;
+
+        Bytes += Mesh->getVertices().capacity() * sizeof(TVec3d);
+        Bytes += Mesh->getIndices().capacity() * sizeof(unsigned);
+        Bytes += Mesh->getUV1().capacity() * sizeof(TVec2f);
+        Bytes += Mesh->getUV4().capacity() * sizeof(TVec2f);
+        Bytes += Mesh->getVertexColors().capacity() * sizeof(TVec3d);
+    }
+    return Bytes;
+}
+
+int64 FPLATEAUMemoryBudget::GetUsedBytes() const {
+    FScopeLock Lock(&Section);
+    return UsedBytes;
+}
+
+int64 FPLATEAUMemoryBudget::GetPeakBytes() const {
+    FScopeLock Lock(&Section);
+    return PeakBytes;
+}
+
+int32 FPLATEAUMemoryBudget::GetOversizedCount() const {
+    FScopeLock Lock(&Section);
+    return OversizedCount;
+}
+
+FString FPLATEAUMemoryBudget::GetStatsString() const {
+    FScopeLock Lock(&Section);
+    return FString::Printf(TEXT("Budget: %.2f MB, Peak: %.2f MB, Wait time: %.3f s, Oversized: %d (+%.2f MB)"),
+        BudgetBytes / (1024.0 * 1024.0), PeakBytes / (1024.0 * 1024.0), WaitMicroseconds / 1000000.0,
+        OversizedCount, OversizedBytes / (1024.0 * 1024.0));
+}
+
+void FPLATEAUMemoryBudget::Release(const int64 Bytes) {
+    TFunction<void()> Callback;
+    {
+        FScopeLock Lock(&Section);
+        UsedBytes -= Bytes;
+        check(UsedBytes >= 0);
+        Callback = OnReleased;
+        // 待機者はロック内でのみ登録・解除されるため、ロック中はイベントが有効
+        for (const auto Waiter : Waiters)
+            Waiter->Trigger();
+    }
+    if (Callback)
+        Callback();
+}
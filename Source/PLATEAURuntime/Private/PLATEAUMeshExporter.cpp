@@ -17,8 +17,13 @@
 #include "StaticMeshResources.h"
 #include "UObject/UObjectBaseUtility.h"
 #include "Util/PLATEAUComponentUtil.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "PLATEAUMeshSourceData.h"
 #include "Algo/Reverse.h"
 #include "Misc/EngineVersionComparison.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
 
 #if WITH_EDITOR
 #include "HAL/FileManager.h"
@@ -29,39 +34,142 @@
 
 namespace {
     /**
-     * @brief NodeのChildに同名が存在する場合はindexを返します。ない場合は-1を返します。
+     * @brief CityObjectIndexとGML IDをCityObjectListに追加します。
      */
-    int GetChildIndex(const FString& name, plateau::polygonMesh::Node* Node) {
-        int num = Node->getChildCount();
-        for (int i = 0; i < num; i++) {
-            if (Node->getChildAt(i).getName() == TCHAR_TO_UTF8(*name))
-                return i;
+    void SetCityObjectIndex(const FPLATEAUCityObjectIndex& Index, const FString& GmlID, plateau::polygonMesh::CityObjectList& cityObjList) {
+        
+        // 注: 名前空間plateau::polygonMeshをusingで省略しないこと。Packageビルドで問題となる。
+        plateau::polygonMesh::CityObjectIndex cityObjIdx;
+        
+        cityObjIdx.primary_index = Index.PrimaryIndex;
+        cityObjIdx.atomic_index = Index.AtomicIndex;
+        cityObjList.add(cityObjIdx, TCHAR_TO_UTF8(*GmlID));
+    }
+
+    /**
+     * @brief Unreal Engineの座標(ESU, cm)から出力先の座標系への変換行列です。軸の入れ替えと反転、glTFの単位変換のみのため各軸の変換先で表します。
+     */
+    struct FVertexTransform {
+        FVector3d AxisX;
+        FVector3d AxisY;
+        FVector3d AxisZ;
+    };
+
+    FVertexTransform CreateVertexTransform(const FPLATEAUMeshExportOptions& Option) {
+        // glTFの場合はm単位で出力
+        const double Scale = Option.FileFormat == EMeshFileFormat::GLTF ? 0.01 : 1.0;
+        const auto ConvertAxis = [&](const TVec3d& Axis) {
+            auto Vertex = plateau::geometry::GeoReference::convertAxisToENU(plateau::geometry::CoordinateSystem::ESU, Axis);
+            Vertex = plateau::geometry::GeoReference::convertAxisFromENUTo(StaticCast<plateau::geometry::CoordinateSystem>(Option.CoordinateSystem), Vertex);
+            return FVector3d(Vertex.x, Vertex.y, Vertex.z) * Scale;
+        };
+        return { ConvertAxis(TVec3d(1, 0, 0)), ConvertAxis(TVec3d(0, 1, 0)), ConvertAxis(TVec3d(0, 0, 1)) };
+    }
+
+    TVec3d TransformVertex(const FVertexTransform& Transform, const double X, const double Y, const double Z) {
+        return TVec3d(
+            Transform.AxisX.X * X + Transform.AxisY.X * Y + Transform.AxisZ.X * Z,
+            Transform.AxisX.Y * X + Transform.AxisY.Y * Y + Transform.AxisZ.Y * Z,
+            Transform.AxisX.Z * X + Transform.AxisY.Z * Y + Transform.AxisZ.Z * Z);
+    }
+
+    /**
+     * @brief コンポーネントの変換をアクターのルートコンポーネント基準で返します。インポートしたコンポーネントは単位変換です。
+     */
+    FTransform GetTransformInActor(const USceneComponent& Component, const FTransform& ComponentTransform) {
+        const auto Actor = Component.GetOwner();
+        const auto RootComponent = Actor != nullptr ? Actor->GetRootComponent() : nullptr;
+        return RootComponent != nullptr ? ComponentTransform.GetRelativeTransform(RootComponent->GetComponentTransform()) : ComponentTransform;
+    }
+
+    void TransformPositions(FPLATEAUExportMeshSnapshot& Snapshot, const FTransform& Transform) {
+        if (Transform.Equals(FTransform::Identity))
+            return;
+
+        for (auto& Position : Snapshot.Positions) {
+            Position = FVector3f(Transform.TransformPosition(FVector(Position)));
         }
-        return -1;
     }
+
     /**
-     * @brief ModelのRootChildに同名が存在する場合はindexを返します。ない場合は-1を返します。
+     * @brief マテリアルがテクスチャを持っているようなら、テクスチャの元ファイルの絶対パスを返します。ない場合は空文字列を返します。
      */
-    int GetChildIndex(FString name, plateau::polygonMesh::Model* Model) {
-        int num = Model->getRootNodeCount();
-        for (int i = 0; i < num; i++) {
-            if (Model->getRootNodeAt(i).getName() == TCHAR_TO_UTF8(*name))
-                return i;
+    FString GetTextureFilePath(UMaterialInterface* MaterialInterface) {
+        FString TextureFilePath = FString("");
+        const auto  MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
+        if (MaterialInstance == nullptr || MaterialInstance->TextureParameterValues.Num() == 0)
+            return TextureFilePath;
+
+        FMaterialParameterMetadata MetaData;
+        MaterialInstance->TextureParameterValues[0].GetValue(MetaData);
+        if (const auto Texture = MetaData.Value.Texture; Texture != nullptr) {
+#if WITH_EDITOR
+            const auto TextureSourceFiles = Texture->AssetImportData->GetSourceData().SourceFiles;
+            if (TextureSourceFiles.Num() == 0) {
+                UE_LOG(LogTemp, Error, TEXT("SourceFilePath is missing in AssetImportData: %s"), *Texture->GetName());
+                return TextureFilePath;
+            }
+
+            const auto AssetBasePath = FPaths::GetPath(Texture->GetPackage()->GetLoadedPath().GetLocalFullPath());
+            const auto TextureFileRelativePath = TextureSourceFiles[0].RelativeFilename;
+            TextureFilePath = AssetBasePath / TextureFileRelativePath;
+            TextureFilePath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*TextureFilePath);
+#endif
         }
-        return -1;
+        return TextureFilePath;
     }
 
+    // 溶接時に同じ位置とみなす格子の幅(cm)
+    constexpr double WeldGridSize = 0.01;
+
+    struct FWeldKey {
+        int64 X;
+        int64 Y;
+        int64 Z;
+        TVec2f UV1;
+        TVec2f UV4;
+
+        bool operator==(const FWeldKey& Other) const {
+            return X == Other.X && Y == Other.Y && Z == Other.Z &&
+                UV1.x == Other.UV1.x && UV1.y == Other.UV1.y && UV4.x == Other.UV4.x && UV4.y == Other.UV4.y;
+        }
+
+        friend uint32 GetTypeHash(const FWeldKey& Key) {
+            uint32 Hash = HashCombineFast(GetTypeHash(Key.X), GetTypeHash(Key.Y));
+            Hash = HashCombineFast(Hash, GetTypeHash(Key.Z));
+            Hash = HashCombineFast(Hash, HashCombineFast(GetTypeHash(Key.UV1.x), GetTypeHash(Key.UV1.y)));
+            return HashCombineFast(Hash, HashCombineFast(GetTypeHash(Key.UV4.x), GetTypeHash(Key.UV4.y)));
+        }
+    };
+
     /**
-     * @brief FPLATEAUCityObjectからCityObjectIndexを取得してCityObjectListに追加します。
+     * @brief 位置を格子に量子化した座標とUV1, UV4(都市オブジェクトのインデックス)が同じ頂点を1つにまとめます。
+     * 読み込み時に面毎に複製された頂点を出力前に結合するためのものです。
+     * @param OutSourceVertices 出力する頂点毎の元の頂点番号
+     * @param OutRemap 元の頂点番号から出力する頂点番号への対応
      */
-    void SetCityObjectIndex(const FPLATEAUCityObject& cityObj, plateau::polygonMesh::CityObjectList& cityObjList) {
-        
-        // 注: 名前空間plateau::polygonMeshをusingで省略しないこと。Packageビルドで問題となる。
-        plateau::polygonMesh::CityObjectIndex cityObjIdx;
-        
-        cityObjIdx.primary_index = cityObj.CityObjectIndex.PrimaryIndex;
-        cityObjIdx.atomic_index = cityObj.CityObjectIndex.AtomicIndex;
-        cityObjList.add(cityObjIdx, TCHAR_TO_UTF8(*cityObj.GmlID));
+    void WeldVertices(const TArray<FVector3f>& Positions, const plateau::polygonMesh::UV& UV1, const plateau::polygonMesh::UV& UV4,
+                      TArray<uint32>& OutSourceVertices, TArray<uint32>& OutRemap) {
+        const uint32 NumVertices = Positions.Num();
+        TMap<FWeldKey, uint32> KeyToVertex;
+        KeyToVertex.Reserve(NumVertices);
+        OutSourceVertices.Reset(NumVertices);
+        OutRemap.SetNumUninitialized(NumVertices);
+        for (uint32 i = 0; i < NumVertices; ++i) {
+            const FVector3f& Position = Positions[i];
+            const FWeldKey Key{
+                FMath::RoundToInt64(Position.X / WeldGridSize),
+                FMath::RoundToInt64(Position.Y / WeldGridSize),
+                FMath::RoundToInt64(Position.Z / WeldGridSize),
+                i < UV1.size() ? UV1[i] : TVec2f(0.f, 0.f),
+                i < UV4.size() ? UV4[i] : TVec2f(0.f, 0.f) };
+            if (const auto Found = KeyToVertex.Find(Key)) {
+                OutRemap[i] = *Found;
+                continue;
+            }
+            OutRemap[i] = OutSourceVertices.Add(i);
+            KeyToVertex.Add(Key, OutRemap[i]);
+        }
     }
 }
 
@@ -82,31 +190,24 @@ bool FPLATEAUMeshExporter::Export(const FString& ExportPath, APLATEAUInstancedCi
 
 
 bool FPLATEAUMeshExporter::ExportAsOBJ(const FString& ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option) {
-    plateau::meshWriter::ObjWriter Writer;
     if (Option.TransformType == EMeshTransformType::PlaneRect) {
         ReferencePoint = ModelActor->GeoReference.ReferencePoint;
     } else {
         ReferencePoint = FVector::ZeroVector;
     }
-    const auto ModelDataArray = CreateModelFromActor(ModelActor, Option);
-    for (int i = 0; i < ModelDataArray.Num(); i++) {
-        if (ModelDataArray[i]->getRootNodeCount() != 0) {
-            const FString ExportPathWithName = ExportPath + "/" + ModelNames[i] + ".obj";
-            try {
-                if (!Writer.write(TCHAR_TO_UTF8(*ExportPathWithName), *ModelDataArray[i])) {
-                    return false;
-                }
-            } catch (const std::exception& e) {
-                UE_LOG(LogTemp, Error, TEXT("ExportAsOBJ Error : %s"), *FString(e.what()));
-                return false;
-            }
+    return ExportModels(ModelActor, Option, [&ExportPath](const FString& ModelName, const plateau::polygonMesh::Model& Model) {
+        plateau::meshWriter::ObjWriter Writer;
+        const FString ExportPathWithName = ExportPath + "/" + ModelName + ".obj";
+        try {
+            return Writer.write(TCHAR_TO_UTF8(*ExportPathWithName), Model);
+        } catch (const std::exception& e) {
+            UE_LOG(LogTemp, Error, TEXT("ExportAsOBJ Error : %s"), *FString(e.what()));
+            return false;
         }
-    }
-    return true;
+    });
 }
 
 bool FPLATEAUMeshExporter::ExportAsFBX(const FString& ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option) {
-    plateau::meshWriter::FbxWriter Writer;
     if (Option.TransformType == EMeshTransformType::PlaneRect) {
         ReferencePoint = ModelActor->GeoReference.ReferencePoint;
     } else {
@@ -115,195 +216,296 @@ bool FPLATEAUMeshExporter::ExportAsFBX(const FString& ExportPath, APLATEAUInstan
     plateau::meshWriter::FbxWriteOptions FbxOptions;
     FbxOptions.file_format = Option.bExportAsBinary ? plateau::meshWriter::FbxFileFormat::Binary : plateau::meshWriter::FbxFileFormat::ASCII;
     FbxOptions.coordinate_system = static_cast<plateau::geometry::CoordinateSystem>(Option.CoordinateSystem);
-    const auto ModelDataArray = CreateModelFromActor(ModelActor, Option);
-    for (int i = 0; i < ModelDataArray.Num(); i++) {
-        if (ModelDataArray[i]->getRootNodeCount() != 0) {
-            const FString ExportPathWithName = ExportPath + "/" + ModelNames[i] + ".fbx";
-            try {
-                if (!Writer.write(TCHAR_TO_UTF8(*ExportPathWithName), *ModelDataArray[i], FbxOptions)) {
-                    return false;
-                }
-            } catch (const std::exception& e) {
-                UE_LOG(LogTemp, Error, TEXT("ExportAsFBX Error : %s"), *FString(e.what()));
-                return false;
-            }
+    // FBX SDKは同時に書き出すとスレッドセーフでないため、書き出しのみ直列化する(Modelの作成は並列)
+    FCriticalSection WriterSection;
+    return ExportModels(ModelActor, Option, [&ExportPath, &FbxOptions, &WriterSection](const FString& ModelName, const plateau::polygonMesh::Model& Model) {
+        FScopeLock Lock(&WriterSection);
+        plateau::meshWriter::FbxWriter Writer;
+        const FString ExportPathWithName = ExportPath + "/" + ModelName + ".fbx";
+        try {
+            return Writer.write(TCHAR_TO_UTF8(*ExportPathWithName), Model, FbxOptions);
+        } catch (const std::exception& e) {
+            UE_LOG(LogTemp, Error, TEXT("ExportAsFBX Error : %s"), *FString(e.what()));
+            return false;
         }
-    }
-    return true;
+    });
 }
 
 bool FPLATEAUMeshExporter::ExportAsGLTF(const FString& ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option) {
-    plateau::meshWriter::GltfWriter Writer;
-    const auto ModelDataArray = CreateModelFromActor(ModelActor, Option);
     plateau::meshWriter::GltfWriteOptions GltfOptions;
     GltfOptions.mesh_file_format = Option.bExportAsBinary ? plateau::meshWriter::GltfFileFormat::GLTF : plateau::meshWriter::GltfFileFormat::GLB;
     GltfOptions.texture_directory_path = "./textures";
-    for (int i = 0; i < ModelDataArray.Num(); i++) {
-        if (ModelDataArray[i]->getRootNodeCount() != 0) {
+    return ExportModels(ModelActor, Option, [&ExportPath, &GltfOptions](const FString& ModelName, const plateau::polygonMesh::Model& Model) {
 #if WITH_EDITOR
-            const FString ExportPathWithFolder = ExportPath + "/" + ModelNames[i];
-            IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-            if (!PlatformFile.DirectoryExists(*ExportPathWithFolder)) {
-                PlatformFile.CreateDirectory(*ExportPathWithFolder);
-            }
+        const FString ExportPathWithFolder = ExportPath + "/" + ModelName;
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        if (!PlatformFile.DirectoryExists(*ExportPathWithFolder)) {
+            PlatformFile.CreateDirectory(*ExportPathWithFolder);
+        }
 #endif
-            const FString ExportPathWithName = ExportPath + "/" + ModelNames[i] + "/" + ModelNames[i] + ".gltf";
-            try {
-                if (!Writer.write(TCHAR_TO_UTF8(*ExportPathWithName), *ModelDataArray[i], GltfOptions)) {
-                    return false;
-                }
-            } catch (const std::exception& e) {
-                UE_LOG(LogTemp, Error, TEXT("ExportAsGLTF Error : %s"), *FString(e.what()));
-                return false;
-            }
+        plateau::meshWriter::GltfWriter Writer;
+        const FString ExportPathWithName = ExportPath + "/" + ModelName + "/" + ModelName + ".gltf";
+        try {
+            return Writer.write(TCHAR_TO_UTF8(*ExportPathWithName), Model, GltfOptions);
+        } catch (const std::exception& e) {
+            UE_LOG(LogTemp, Error, TEXT("ExportAsGLTF Error : %s"), *FString(e.what()));
+            return false;
         }
+    });
+}
+
+bool FPLATEAUMeshExporter::ExportModels(APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option,
+                                        const TFunction<bool(const FString&, const plateau::polygonMesh::Model&)>& WriteModel) {
+    const auto ModelComponents = GetModelComponents(ModelActor);
+    // コンポーネントの読み出しはゲームスレッドで行い、ワーカー数分のGML毎にModelの作成と書き出しのみ並列に行う
+    const int32 BatchSize = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+    TArray<TArray<FPLATEAUExportNodeSnapshot>> Snapshots;
+    TAtomic<bool> bSucceeded(true);
+    for (int32 BatchStart = 0; BatchStart < ModelComponents.Num() && bSucceeded; BatchStart += BatchSize) {
+        const int32 BatchCount = FMath::Min(BatchSize, ModelComponents.Num() - BatchStart);
+        Snapshots.Reset();
+        for (int32 i = 0; i < BatchCount; ++i) {
+            Snapshots.Add(CreateModelSnapshot(ModelComponents[BatchStart + i], Option));
+        }
+
+        ParallelFor(BatchCount, [&](const int32 Index) {
+            if (!bSucceeded)
+                return;
+
+            // 書き出し後すぐに解放する
+            const auto Model = plateau::polygonMesh::Model::createModel();
+            for (const auto& RootNode : Snapshots[Index]) {
+                CreateNode(Model->addEmptyNode(TCHAR_TO_UTF8(*RootNode.Name)), RootNode, Option);
+            }
+            if (Model->getRootNodeCount() != 0 && !WriteModel(ModelNames[BatchStart + Index], *Model))
+                bSucceeded = false;
+        });
     }
-    return true;
+    return bSucceeded;
 }
 
-TArray<std::shared_ptr<plateau::polygonMesh::Model>> FPLATEAUMeshExporter::CreateModelFromActor(APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions Option) {
-    TArray<std::shared_ptr<plateau::polygonMesh::Model>> ModelArray;
+TArray<USceneComponent*> FPLATEAUMeshExporter::GetModelComponents(APLATEAUInstancedCityModel* ModelActor) {
+    TArray<USceneComponent*> ModelComponents;
     const auto RootComponent = ModelActor->GetRootComponent();
     const auto Components = RootComponent->GetAttachChildren();
     for (int i = 0; i < Components.Num(); i++) {
         //BillboardComponentなるコンポーネントがついていることがあるので無視
         if (Components[i]->GetName().Contains("BillboardComponent")) continue;
 
-        ModelArray.Add(CreateModel(Components[i], Option));
+        ModelComponents.Add(Components[i]);
         ModelNames.Add(FPLATEAUComponentUtil::GetOriginalComponentName(Components[i]));
     }
-    return ModelArray;
+    return ModelComponents;
 }
 
-std::shared_ptr<plateau::polygonMesh::Model> FPLATEAUMeshExporter::CreateModel(USceneComponent* ModelRootComponent, const FPLATEAUMeshExportOptions Option) {
-    auto OutModel = plateau::polygonMesh::Model::createModel();
-    const auto Components = ModelRootComponent->GetAttachChildren();
-    for (int i = 0; i < Components.Num(); i++) {
-        auto& Node = OutModel->addEmptyNode(TCHAR_TO_UTF8(*FPLATEAUComponentUtil::GetOriginalComponentName(Components[i])));
-        CreateNode(Node, Components[i], Option);
-    }
-    return OutModel;
-}
-
-void FPLATEAUMeshExporter::CreateNode(plateau::polygonMesh::Node& OutNode, USceneComponent* NodeRootComponent, const FPLATEAUMeshExportOptions Option) {
-    for (const auto& Component : NodeRootComponent->GetAttachChildren()) {
-        if (!Option.bExportHiddenObjects && !Component->IsVisible())
-            continue;
+TArray<FPLATEAUExportNodeSnapshot> FPLATEAUMeshExporter::CreateModelSnapshot(USceneComponent* ModelRootComponent, const FPLATEAUMeshExportOptions& Option) {
+    TArray<FPLATEAUExportNodeSnapshot> RootNodes;
+    for (const auto& Component : ModelRootComponent->GetAttachChildren()) {
+        auto& RootNode = RootNodes.AddDefaulted_GetRef();
+        RootNode.Name = FPLATEAUComponentUtil::GetOriginalComponentName(Component);
+        for (const auto& MeshComponent : Component->GetAttachChildren()) {
+            if (!Option.bExportHiddenObjects && !MeshComponent->IsVisible())
+                continue;
+
+            if (const auto InstancedGroup = Cast<UPLATEAUInstancedCityObjectGroup>(MeshComponent)) {
+                AddInstanceSnapshots(RootNode.Children, InstancedGroup, Option);
+                continue;
+            }
 
-        auto& Node = OutNode.addEmptyChildNode(TCHAR_TO_UTF8(*Component->GetName()));
-        auto Mesh = plateau::polygonMesh::Mesh();
-        CreateMesh(Mesh, Component, Option);
-        auto MeshPtr = std::make_unique<plateau::polygonMesh::Mesh>(Mesh);
-        Node.setMesh(std::move(MeshPtr));
+            auto& Node = RootNode.Children.AddDefaulted_GetRef();
+            Node.Name = MeshComponent->GetName();
+            CreateMeshSnapshot(Node.Mesh.Emplace(), MeshComponent, Option);
+        }
     }
+    return RootNodes;
 }
 
-void FPLATEAUMeshExporter::CreateMesh(plateau::polygonMesh::Mesh& OutMesh, USceneComponent* MeshComponent, const FPLATEAUMeshExportOptions Option) {
+void FPLATEAUMeshExporter::CreateMeshSnapshot(FPLATEAUExportMeshSnapshot& OutSnapshot, USceneComponent* MeshComponent, const FPLATEAUMeshExportOptions& Option) {
     const auto StaticMeshComponent = Cast<UStaticMeshComponent>(MeshComponent);
 
     if (StaticMeshComponent == nullptr || StaticMeshComponent->GetStaticMesh() == nullptr)
         return;
 
-    //渡すためのデータ各種
-    std::vector<TVec3d> Vertices;
-    std::vector<unsigned int> OutIndices;
-    plateau::polygonMesh::UV UV1;
-    plateau::polygonMesh::UV UV2;
-    plateau::polygonMesh::UV UV3;
-    plateau::polygonMesh::UV UV4;
+    //マテリアルがテクスチャを持っているようなら取得、設定によってはスキップ
+    const auto AddSubMesh = [&](const int32 FirstIndex, const int32 EndIndex, UMaterialInterface* MaterialInterface) {
+        OutSnapshot.SubMeshStarts.Add(FirstIndex);
+        OutSnapshot.SubMeshEnds.Add(EndIndex);
+        OutSnapshot.SubMeshTextureFilePaths.Add(Option.bExportTexture ? GetTextureFilePath(MaterialInterface) : FString(""));
+        // TODO マテリアル対応
+        OutSnapshot.SubMeshMaterialIDs.Add(MaterialInterface == nullptr ? -1 : CachedMaterials.Add(MaterialInterface));
+    };
+
+    // 作成元のメッシュを保持していれば、描画用データを読み戻さずに作成する
+    if (const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(MeshComponent)) {
+        const auto& SourceData = CityObjectGroup->GetMeshSourceData();
+        if (SourceData.IsValid() && SourceData->GetMaterialSlotCount() <= StaticMeshComponent->GetNumMaterials()) {
+            OutSnapshot.SourceData = SourceData;
+            for (int32 k = 0; k < SourceData->SubMeshStarts.Num(); ++k) {
+                if (SourceData->SubMeshEnds[k] < SourceData->SubMeshStarts[k])
+                    continue;
+
+                AddSubMesh(SourceData->SubMeshStarts[k], SourceData->SubMeshEnds[k], StaticMeshComponent->GetMaterial(SourceData->SubMeshMaterialSlots[k]));
+            }
+            return;
+        }
+    }
 
     const auto& RenderMesh = StaticMeshComponent->GetStaticMesh()->GetLODForExport(0);
+    const auto& InPositions = RenderMesh.VertexBuffers.PositionVertexBuffer;
+    const auto& InVertices = RenderMesh.VertexBuffers.StaticMeshVertexBuffer;
+
+    OutSnapshot.Positions.SetNumUninitialized(InPositions.GetNumVertices());
+    for (uint32 i = 0; i < InPositions.GetNumVertices(); ++i) {
+        OutSnapshot.Positions[i] = InPositions.VertexPosition(i);
+    }
 
-    auto& InVertices = RenderMesh.VertexBuffers.StaticMeshVertexBuffer;
+    OutSnapshot.UV1.SetNumUninitialized(InVertices.GetNumVertices());
+    OutSnapshot.UV4.SetNumUninitialized(InVertices.GetNumVertices());
     for (uint32 i = 0; i < InVertices.GetNumVertices(); ++i) {
         const FVector2f& UV = InVertices.GetVertexUV(i, 0);
-        UV1.push_back(TVec2f(UV.X, 1.0f - UV.Y));
+        OutSnapshot.UV1[i] = FVector2f(UV.X, 1.0f - UV.Y);
+        //UV4
+        OutSnapshot.UV4[i] = InVertices.GetVertexUV(i, 3);
     }
 
-    //UV4
-    for (uint32 i = 0; i < InVertices.GetNumVertices(); ++i) {
-        const FVector2f& UV = InVertices.GetVertexUV(i, 3);
-        UV4.push_back(TVec2f(UV.X, UV.Y));
+    RenderMesh.IndexBuffer.GetCopy(OutSnapshot.Indices);
+
+    for (int k = 0; k < RenderMesh.Sections.Num(); k++) {
+        const auto& Section = RenderMesh.Sections[k];
+        if (Section.NumTriangles <= 0) continue;
+
+        //サブメッシュの開始・終了インデックス計算
+        const int FirstIndex = Section.FirstIndex;
+        const int EndIndex = Section.FirstIndex + Section.NumTriangles * 3 - 1;
+        ensureAlwaysMsgf((EndIndex - FirstIndex + 1) % 3 == 0, TEXT("SubMesh indices size should be multiple of 3."));
+
+        AddSubMesh(FirstIndex, EndIndex, StaticMeshComponent->GetMaterial(k));
     }
 
-    auto GeoRef = TargetActor->GeoReference.GetData();
-    for (uint32 i = 0; i < RenderMesh.VertexBuffers.PositionVertexBuffer.GetNumVertices(); i++) {
-        const auto VertexPosition = RenderMesh.VertexBuffers.PositionVertexBuffer.VertexPosition(i);
-        TVec3d Vertex;
-        if (Option.TransformType == EMeshTransformType::PlaneRect)
-            Vertex = TVec3d(VertexPosition.X + ReferencePoint.X, VertexPosition.Y + ReferencePoint.Y, VertexPosition.Z + ReferencePoint.Z);
-        else
-            Vertex = TVec3d(VertexPosition.X, VertexPosition.Y, VertexPosition.Z);
-        Vertex = GeoRef.convertAxisToENU(plateau::geometry::CoordinateSystem::ESU, Vertex);
-        Vertex = GeoRef.convertAxisFromENUTo(StaticCast<plateau::geometry::CoordinateSystem>(Option.CoordinateSystem), Vertex);
+    // インスタンスを展開したコンポーネントは頂点座標が基準位置からの相対座標のため、配置された位置に変換する
+    // インスタンス化したコンポーネントはインスタンス毎に変換する(AddInstanceSnapshots参照)
+    if (!MeshComponent->IsA<UPLATEAUInstancedCityObjectGroup>())
+        TransformPositions(OutSnapshot, GetTransformInActor(*MeshComponent, MeshComponent->GetComponentTransform()));
+}
 
-        // glTFの場合はm単位で出力
-        if (Option.FileFormat == EMeshFileFormat::GLTF)
-            Vertex = TVec3d(Vertex.x * 0.01f, Vertex.y * 0.01f, Vertex.z * 0.01f);
+void FPLATEAUMeshExporter::AddInstanceSnapshots(TArray<FPLATEAUExportNodeSnapshot>& OutNodes, UPLATEAUInstancedCityObjectGroup* InstancedGroup, const FPLATEAUMeshExportOptions& Option) {
+    // 描画用データの読み出しは一度のみ行い、インスタンス毎に頂点座標のみ変換する
+    FPLATEAUExportMeshSnapshot MeshSnapshot;
+    CreateMeshSnapshot(MeshSnapshot, InstancedGroup, Option);
+    for (int32 InstanceIndex = 0; InstanceIndex < InstancedGroup->GetInstanceCount(); ++InstanceIndex) {
+        FTransform InstanceTransform;
+        if (!InstancedGroup->GetInstanceTransform(InstanceIndex, InstanceTransform, true))
+            continue;
 
-        Vertices.push_back(Vertex);
+        // インスタンス化しない場合と同じくノード名で出力する
+        auto& Node = OutNodes.AddDefaulted_GetRef();
+        Node.Name = InstancedGroup->GetInstanceNodeName(InstanceIndex);
+        auto& Mesh = Node.Mesh.Emplace(MeshSnapshot);
+        TransformPositions(Mesh, GetTransformInActor(*InstancedGroup, InstanceTransform));
     }
+}
 
-    bool invertMesh = (Option.CoordinateSystem == ECoordinateSystem::EUN || Option.CoordinateSystem == ECoordinateSystem::ESU);
-    for (int32 TriangleIndex = 0; TriangleIndex < RenderMesh.IndexBuffer.GetNumIndices() / 3; ++TriangleIndex) {
-        if (!invertMesh) {
-            OutIndices.push_back(RenderMesh.IndexBuffer.GetIndex(TriangleIndex * 3));
-            OutIndices.push_back(RenderMesh.IndexBuffer.GetIndex(TriangleIndex * 3 + 1));
-            OutIndices.push_back(RenderMesh.IndexBuffer.GetIndex(TriangleIndex * 3 + 2));
+void FPLATEAUMeshExporter::AddCityObjectsToSnapshot(FPLATEAUExportMeshSnapshot& OutSnapshot, UPLATEAUCityObjectGroup* CityObjectGroup) {
+    const auto AddCityObject = [&OutSnapshot](const FPLATEAUCityObject& CityObject) {
+        OutSnapshot.CityObjectIndices.Add(CityObject.CityObjectIndex);
+        OutSnapshot.CityObjectGmlIDs.Add(CityObject.GmlID);
+    };
+    for (const auto& CityObject : CityObjectGroup->GetAllRootCityObjects()) {
+        AddCityObject(CityObject);
+        for (const auto& Child : CityObject.Children) {
+            AddCityObject(Child);
         }
-        else {
-            OutIndices.push_back(RenderMesh.IndexBuffer.GetIndex(TriangleIndex * 3 + 2));
-            OutIndices.push_back(RenderMesh.IndexBuffer.GetIndex(TriangleIndex * 3 + 1));
-            OutIndices.push_back(RenderMesh.IndexBuffer.GetIndex(TriangleIndex * 3));
+    }
+}
+
+void FPLATEAUMeshExporter::CreateNode(plateau::polygonMesh::Node& OutNode, const FPLATEAUExportNodeSnapshot& Snapshot, const FPLATEAUMeshExportOptions& Option) const {
+    if (Snapshot.Mesh.IsSet()) {
+        auto MeshPtr = std::make_unique<plateau::polygonMesh::Mesh>();
+        CreateMesh(*MeshPtr, Snapshot.Mesh.GetValue(), Option);
+        OutNode.setMesh(std::move(MeshPtr));
+    }
+    for (const auto& Child : Snapshot.Children) {
+        CreateNode(OutNode.addEmptyChildNode(TCHAR_TO_UTF8(*Child.Name)), Child, Option);
+    }
+}
+
+void FPLATEAUMeshExporter::CreateMesh(plateau::polygonMesh::Mesh& OutMesh, const FPLATEAUExportMeshSnapshot& Snapshot, const FPLATEAUMeshExportOptions& Option) const {
+    // StaticMeshでないコンポーネントはメッシュを持たない
+    if (Snapshot.SourceData.IsValid() || Snapshot.Positions.Num() > 0) {
+        for (int32 k = 0; k < Snapshot.SubMeshStarts.Num(); ++k) {
+            // TODO マテリアル対応、下のnullptrをマテリアルに置き換える
+            OutMesh.addSubMesh(TCHAR_TO_UTF8(*Snapshot.SubMeshTextureFilePaths[k]), nullptr, Snapshot.SubMeshStarts[k], Snapshot.SubMeshEnds[k], Snapshot.SubMeshMaterialIDs[k]);
+        }
+
+        if (Snapshot.SourceData.IsValid()) {
+            CreateMeshFromSourceData(OutMesh, *Snapshot.SourceData, Option);
+        } else {
+            CreateMeshFromRenderData(OutMesh, Snapshot, Option);
         }
     }
 
-    for (int k = 0; k < RenderMesh.Sections.Num(); k++) {
-        const auto& Section = RenderMesh.Sections[k];
-        if (Section.NumTriangles <= 0) continue;
+    if (Snapshot.CityObjectGmlIDs.Num() > 0) {
+        plateau::polygonMesh::CityObjectList cityObjList;
+        for (int32 i = 0; i < Snapshot.CityObjectGmlIDs.Num(); ++i) {
+            SetCityObjectIndex(Snapshot.CityObjectIndices[i], Snapshot.CityObjectGmlIDs[i], cityObjList);
+        }
+        OutMesh.setCityObjectList(cityObjList);
+    }
+}
 
-        //サブメッシュの開始・終了インデックス計算
-        const int FirstIndex = Section.FirstIndex;
-        const int EndIndex = Section.FirstIndex + Section.NumTriangles * 3 - 1;
-        ensureAlwaysMsgf((EndIndex - FirstIndex + 1) % 3 == 0, TEXT("SubMesh indices size should be multiple of 3."));
+void FPLATEAUMeshExporter::CreateMeshFromRenderData(plateau::polygonMesh::Mesh& OutMesh, const FPLATEAUExportMeshSnapshot& Snapshot, const FPLATEAUMeshExportOptions& Option) const {
+    const int32 NumVertices = Snapshot.Positions.Num();
 
-        //マテリアルがテクスチャを持っているようなら取得、設定によってはスキップ
-        FString TextureFilePath = FString("");
+    //渡すためのデータ各種
+    std::vector<TVec3d> Vertices(NumVertices);
+    plateau::polygonMesh::UV UV1(Snapshot.UV1.Num());
+    plateau::polygonMesh::UV UV4(Snapshot.UV4.Num());
 
-        auto MaterialInterface =  StaticMeshComponent->GetMaterial(k);
-        if (Option.bExportTexture) {
-            
-            if (MaterialInterface != nullptr) {
-                
-                const auto  MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
-                if (MaterialInstance != nullptr && MaterialInstance->TextureParameterValues.Num() > 0) {
-
-                    FMaterialParameterMetadata MetaData;
-                    MaterialInstance->TextureParameterValues[0].GetValue(MetaData);
-                    if (const auto Texture = MetaData.Value.Texture; Texture != nullptr) {
-#if WITH_EDITOR
-                        const auto TextureSourceFiles = Texture->AssetImportData->GetSourceData().SourceFiles;
-                        if (TextureSourceFiles.Num() == 0) {
-                            UE_LOG(LogTemp, Error, TEXT("SourceFilePath is missing in AssetImportData: %s"), *Texture->GetName());
-                            // TODO マテリアル対応、下のnullptrをマテリアルに置き換える
-                            OutMesh.addSubMesh("", nullptr, FirstIndex, EndIndex, CachedMaterials.Add(MaterialInterface));
-                            continue;
-                        }
-
-                        const auto AssetBasePath = FPaths::GetPath(Texture->GetPackage()->GetLoadedPath().GetLocalFullPath());
-                        const auto TextureFileRelativePath = TextureSourceFiles[0].RelativeFilename;
-                        TextureFilePath = AssetBasePath / TextureFileRelativePath;
-                        TextureFilePath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*TextureFilePath);
-#endif
-                    }
-                }
-            }
+    for (int32 i = 0; i < Snapshot.UV1.Num(); ++i) {
+        UV1[i] = TVec2f(Snapshot.UV1[i].X, Snapshot.UV1[i].Y);
+        UV4[i] = TVec2f(Snapshot.UV4[i].X, Snapshot.UV4[i].Y);
+    }
+
+    // 溶接する場合は代表の頂点のみを出力する
+    TArray<uint32> SourceVertices;
+    TArray<uint32> Remap;
+    if (Option.bWeldVertices) {
+        WeldVertices(Snapshot.Positions, UV1, UV4, SourceVertices, Remap);
+        Vertices.resize(SourceVertices.Num());
+        plateau::polygonMesh::UV WeldedUV1(SourceVertices.Num());
+        plateau::polygonMesh::UV WeldedUV4(SourceVertices.Num());
+        for (int32 i = 0; i < SourceVertices.Num(); ++i) {
+            WeldedUV1[i] = UV1[SourceVertices[i]];
+            WeldedUV4[i] = UV4[SourceVertices[i]];
         }
-        std::string TextureFilePathStr = TCHAR_TO_UTF8(*TextureFilePath);
+        UV1 = std::move(WeldedUV1);
+        UV4 = std::move(WeldedUV4);
+    }
 
-        // TODO マテリアル対応、下のnullptrをマテリアルに置き換える
-        int gameMaterialID = MaterialInterface == nullptr ? -1 : CachedMaterials.Add(MaterialInterface);
-        OutMesh.addSubMesh(TextureFilePathStr, nullptr, FirstIndex, EndIndex, gameMaterialID);
+    // 頂点毎の座標系変換の代わりに、変換行列を求めてまとめて変換する
+    const auto Transform = CreateVertexTransform(Option);
+    const FVector3d Offset = Option.TransformType == EMeshTransformType::PlaneRect ? ReferencePoint : FVector3d::ZeroVector;
+    for (uint32 i = 0; i < Vertices.size(); i++) {
+        const FVector3f& VertexPosition = Snapshot.Positions[Option.bWeldVertices ? SourceVertices[i] : i];
+        const double X = VertexPosition.X + Offset.X;
+        const double Y = VertexPosition.Y + Offset.Y;
+        const double Z = VertexPosition.Z + Offset.Z;
+        Vertices[i] = TransformVertex(Transform, X, Y, Z);
+    }
+
+    TArray<uint32> InIndices = Snapshot.Indices;
+    if (Option.bWeldVertices) {
+        for (auto& Index : InIndices) {
+            Index = Remap[Index];
+        }
+    }
+    std::vector<unsigned int> OutIndices(InIndices.Num() / 3 * 3);
+    bool invertMesh = (Option.CoordinateSystem == ECoordinateSystem::EUN || Option.CoordinateSystem == ECoordinateSystem::ESU);
+    for (int32 TriangleIndex = 0; TriangleIndex < InIndices.Num() / 3; ++TriangleIndex) {
+        const int32 First = TriangleIndex * 3;
+        OutIndices[First] = InIndices[invertMesh ? First + 2 : First];
+        OutIndices[First + 1] = InIndices[First + 1];
+        OutIndices[First + 2] = InIndices[invertMesh ? First : First + 2];
     }
 
     OutMesh.addVerticesList(Vertices);
@@ -315,88 +517,105 @@ void FPLATEAUMeshExporter::CreateMesh(plateau::polygonMesh::Mesh& OutMesh, UScen
     ensureAlwaysMsgf(OutMesh.getVertices().size() == OutMesh.getUV1().size(), TEXT("Size of vertices and uv1 should be same."));
 }
 
+void FPLATEAUMeshExporter::CreateMeshFromSourceData(plateau::polygonMesh::Mesh& OutMesh, const FPLATEAUMeshSourceData& SourceData, const FPLATEAUMeshExportOptions& Option) const {
+    const int32 NumVertices = SourceData.Positions.Num();
+    std::vector<TVec3d> Vertices(NumVertices);
+    plateau::polygonMesh::UV UV1(NumVertices);
+    plateau::polygonMesh::UV UV4(NumVertices);
+    const auto Transform = CreateVertexTransform(Option);
+    const FVector3d Offset = Option.TransformType == EMeshTransformType::PlaneRect ? ReferencePoint : FVector3d::ZeroVector;
+    for (int32 i = 0; i < NumVertices; ++i) {
+        const auto& Position = SourceData.Positions[i];
+        Vertices[i] = TransformVertex(Transform, Position.X + Offset.X, Position.Y + Offset.Y, Position.Z + Offset.Z);
+        UV1[i] = TVec2f(SourceData.UV1[i].X, SourceData.UV1[i].Y);
+        UV4[i] = TVec2f(SourceData.UV4[i].X, SourceData.UV4[i].Y);
+    }
+
+    // 作成元のメッシュの面の向きは、描画用データから出力した場合のESU, EUNでの向きと同じ
+    const bool invertMesh = !(Option.CoordinateSystem == ECoordinateSystem::EUN || Option.CoordinateSystem == ECoordinateSystem::ESU);
+    std::vector<unsigned int> OutIndices(SourceData.Indices.Num() / 3 * 3);
+    for (int32 TriangleIndex = 0; TriangleIndex < SourceData.Indices.Num() / 3; ++TriangleIndex) {
+        const int32 First = TriangleIndex * 3;
+        OutIndices[First] = SourceData.Indices[invertMesh ? First + 2 : First];
+        OutIndices[First + 1] = SourceData.Indices[First + 1];
+        OutIndices[First + 2] = SourceData.Indices[invertMesh ? First : First + 2];
+    }
+
+    OutMesh.addVerticesList(Vertices);
+    OutMesh.addIndicesList(OutIndices, 0, false);
+    OutMesh.addUV1(UV1, Vertices.size());
+    OutMesh.addUV4(UV4, Vertices.size());
+}
+
 /**
  * @brief UPLATEAUCityObjectGroupのリストからplateauのModelを生成
  */
 std::shared_ptr<plateau::polygonMesh::Model> FPLATEAUMeshExporter::CreateModelFromComponents(APLATEAUInstancedCityModel* ModelActor, const TArray<UPLATEAUCityObjectGroup*> ModelComponents, const FPLATEAUMeshExportOptions Option) {
+    return CreateModelFromSnapshot(CreateSnapshotFromComponents(ModelActor, ModelComponents, Option), Option);
+}
 
-    TargetActor = ModelActor;
-    auto OutModel = plateau::polygonMesh::Model::createModel();
+/**
+ * @brief UPLATEAUCityObjectGroupのリストから、Modelのノード階層とMeshの作成に必要なデータを読み出します。
+ */
+TArray<FPLATEAUExportNodeSnapshot> FPLATEAUMeshExporter::CreateSnapshotFromComponents(APLATEAUInstancedCityModel* ModelActor, const TArray<UPLATEAUCityObjectGroup*>& ModelComponents, const FPLATEAUMeshExportOptions& Option) {
+    check(IsInGameThread());
 
-    for (const auto comp : ModelComponents) {
+    TargetActor = ModelActor;
+    TArray<FPLATEAUExportNodeSnapshot> RootNodes;
 
-        plateau::polygonMesh::Node* Root;
-        plateau::polygonMesh::Node* Lod; 
-        FString RootName;
-        FString LodName;
+    // 同名のノードがあればそれを使い、なければ追加する
+    const auto FindOrAddNode = [](TArray<FPLATEAUExportNodeSnapshot>& Nodes, const FString& Name) -> FPLATEAUExportNodeSnapshot& {
+        if (const auto Found = Nodes.FindByPredicate([&Name](const FPLATEAUExportNodeSnapshot& Node) { return Node.Name == Name; }))
+            return *Found;
+        auto& Node = Nodes.AddDefaulted_GetRef();
+        Node.Name = Name;
+        return Node;
+    };
 
+    for (const auto comp : ModelComponents) {
         TArray<USceneComponent*> Parents;
         comp->GetParentComponents(Parents);
         int LodCompIndex = Parents.IndexOfByPredicate([](const auto& Parent) {
             return Parent->GetName().StartsWith("LOD");
             });
-        if (LodCompIndex == -1) {
-
-            //LOD Nodeが存在しない場合 Nodeを１つ作ってModelに入れる
-            auto& Node = OutModel->addEmptyNode(TCHAR_TO_UTF8(*comp->GetName()));
-            auto Mesh = plateau::polygonMesh::Mesh();
-            CreateMesh(Mesh, comp, Option);
-            auto MeshPtr = std::make_unique<plateau::polygonMesh::Mesh>(Mesh);
-            plateau::polygonMesh::CityObjectList cityObjList;
-            for (auto cityObj : comp->GetAllRootCityObjects()) {
-                SetCityObjectIndex(cityObj, cityObjList);
-                for (auto child : cityObj.Children) {
-                    SetCityObjectIndex(child, cityObjList);
-                }
-            }
-            MeshPtr->setCityObjectList(cityObjList);
-            Node.setMesh(std::move(MeshPtr));
-        }
-        else  {
+
+        //LOD Nodeが存在しない場合 Nodeを１つ作ってModelに入れる
+        TArray<FPLATEAUExportNodeSnapshot>* Siblings = &RootNodes;
+        FString NodeName = comp->GetName();
+        if (LodCompIndex != -1) {
             auto LodComp = Parents[LodCompIndex];
-            LodName = FPLATEAUComponentUtil::GetOriginalComponentName(LodComp);
-            RootName = LodComp->GetAttachParent()->GetName();
+            const FString LodName = FPLATEAUComponentUtil::GetOriginalComponentName(LodComp);
+            const FString RootName = LodComp->GetAttachParent()->GetName();
 #if UE_VERSION_NEWER_THAN(5, 5, 0)
             Parents.RemoveAt(LodCompIndex, Parents.Num() - LodCompIndex, EAllowShrinking::Yes); //LOD削除
 #else
             Parents.RemoveAt(LodCompIndex, Parents.Num() - LodCompIndex, true); //LOD削除
 #endif
 
-            int RootIndex = GetChildIndex(RootName, OutModel.get());
-            Root = (RootIndex == -1) ?
-                &OutModel->addEmptyNode(TCHAR_TO_UTF8(*RootName)) :
-                &OutModel->getRootNodeAt(RootIndex);
-
-            int LodIndex = GetChildIndex(LodName, Root);
-            Lod = (LodIndex == -1) ?
-                &Root->addEmptyChildNode(TCHAR_TO_UTF8(*LodName)) :
-                &Root->getChildAt(LodIndex);
-
-            plateau::polygonMesh::Node* Parent = Lod;
-            if (Parents.Num() > 0) {    //最小地物の場合
-                Algo::Reverse(Parents);
-                for (auto p : Parents) {
-                    int ParentIndex = GetChildIndex(FPLATEAUComponentUtil::GetOriginalComponentName(p), Parent);
-                    Parent = (ParentIndex == -1) ?
-                        &Parent->addEmptyChildNode(TCHAR_TO_UTF8(*FPLATEAUComponentUtil::GetOriginalComponentName(p))) :
-                        &Parent->getChildAt(ParentIndex);
-                }
+            auto& Root = FindOrAddNode(RootNodes, RootName);
+            auto* Parent = &FindOrAddNode(Root.Children, LodName);
+            //最小地物の場合
+            Algo::Reverse(Parents);
+            for (auto p : Parents) {
+                Parent = &FindOrAddNode(Parent->Children, FPLATEAUComponentUtil::GetOriginalComponentName(p));
             }
-            auto& Node = Parent->addEmptyChildNode(TCHAR_TO_UTF8(*FPLATEAUComponentUtil::GetOriginalComponentName(comp)));
-            auto Mesh = plateau::polygonMesh::Mesh();
-            CreateMesh(Mesh, comp, Option);
-            auto MeshPtr = std::make_unique<plateau::polygonMesh::Mesh>(Mesh);
-
-            plateau::polygonMesh::CityObjectList cityObjList;
-            for (auto cityObj : comp->GetAllRootCityObjects()) {
-                SetCityObjectIndex(cityObj, cityObjList);
-                for (auto child : cityObj.Children) {
-                    SetCityObjectIndex(child, cityObjList);
-                }
-            }
-            MeshPtr->setCityObjectList(cityObjList);
-            Node.setMesh(std::move(MeshPtr));
+            Siblings = &Parent->Children;
+            NodeName = FPLATEAUComponentUtil::GetOriginalComponentName(comp);
         }
+
+        auto& Node = Siblings->AddDefaulted_GetRef();
+        Node.Name = NodeName;
+        auto& Mesh = Node.Mesh.Emplace();
+        CreateMeshSnapshot(Mesh, comp, Option);
+        AddCityObjectsToSnapshot(Mesh, comp);
+    }
+    return RootNodes;
+}
+
+std::shared_ptr<plateau::polygonMesh::Model> FPLATEAUMeshExporter::CreateModelFromSnapshot(const TArray<FPLATEAUExportNodeSnapshot>& RootNodes, const FPLATEAUMeshExportOptions& Option) const {
+    auto OutModel = plateau::polygonMesh::Model::createModel();
+    for (const auto& RootNode : RootNodes) {
+        CreateNode(OutModel->addEmptyNode(TCHAR_TO_UTF8(*RootNode.Name)), RootNode, Option);
     }
     OutModel->assignNodeHierarchy();
     return OutModel;
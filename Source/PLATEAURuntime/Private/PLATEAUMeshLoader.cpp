@@ -21,6 +21,16 @@
 #include "Util/PLATEAUGmlUtil.h"
 #include "PLATEAUModelFiltering.h"
 #include "Math/UnrealMathUtility.h"
+#include "Async/ParallelFor.h"
+#include "PLATEAUComponentCommandBuffer.h"
+#include "PLATEAUTextureCache.h"
+#include "PLATEAUModelCache.h"
+#include "PLATEAUMemoryBudget.h"
+#include "PLATEAUImportProfiler.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "CityGML/Serialization/PLATEAUNativeCityObjectSerialization.h"
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
+#include "Hash/CityHash.h"
 
 #if WITH_EDITOR
 #include "EditorFramework/AssetImportData.h"
@@ -31,10 +41,84 @@ DECLARE_STATS_GROUP(TEXT("PLATEAUMeshLoader"), STATGROUP_PLATEAUMeshLoader, STAT
 
 DECLARE_CYCLE_STAT(TEXT("Mesh.Build"), STAT_Mesh_Build, STATGROUP_PLATEAUMeshLoader);
 
+namespace {
+    // ノード以下のメッシュを解放します
+    void ReleaseMeshesRecursive(plateau::polygonMesh::Node& Node) {
+        Node.setMesh(nullptr);
+        for (unsigned int i = 0; i < Node.getChildCount(); ++i) {
+            ReleaseMeshesRecursive(Node.getChildAt(i));
+        }
+    }
+
+    // インスタンス化のための形状比較に用いる、頂点座標の量子化単位の逆数
+    constexpr double GeometryQuantizationScale = 100.0;
+
+    // 基準位置からの形状を表すバイト列とそのハッシュ
+    struct FGeometrySignature {
+        TArray<uint8> Bytes;
+        uint64 Hash = 0;
+        FVector Origin = FVector::ZeroVector;
+    };
+
+    template <typename T>
+    void AppendBytes(TArray<uint8>& Bytes, const T& Value) {
+        Bytes.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+    }
+
+    template <typename T>
+    void AppendArrayBytes(TArray<uint8>& Bytes, const std::vector<T>& Values) {
+        AppendBytes(Bytes, static_cast<int32>(Values.size()));
+        Bytes.Append(reinterpret_cast<const uint8*>(Values.data()), static_cast<int32>(Values.size() * sizeof(T)));
+    }
+
+    /**
+     * @brief 頂点の最小座標を基準位置とし、基準位置からの量子化した頂点座標、インデックス、UV、SubMesh毎の範囲とマテリアルキーを連結します。
+     * バイト列が一致するメッシュは平行移動を除いて同じ形状・マテリアルになります。
+     */
+    FGeometrySignature MakeGeometrySignature(const plateau::polygonMesh::Mesh& InMesh, FPLATEAUMaterialKeyTable& KeyTable) {
+        FGeometrySignature Signature;
+        const auto& Vertices = InMesh.getVertices();
+        const auto& Indices = InMesh.getIndices();
+        const auto& SubMeshes = InMesh.getSubMeshes();
+
+        FVector Origin(TNumericLimits<double>::Max());
+        for (const auto& Vertex : Vertices) {
+            Origin = Origin.ComponentMin(FVector(Vertex.x, Vertex.y, Vertex.z));
+        }
+        Signature.Origin = Origin;
+
+        auto& Bytes = Signature.Bytes;
+        Bytes.Reserve(static_cast<int32>(Vertices.size() * (sizeof(int64) * 3 + sizeof(float) * 4) + Indices.size() * sizeof(Indices[0]) +
+            SubMeshes.size() * (sizeof(int32) * 2 + sizeof(FPLATEAUMaterialKey)) + 64));
+        AppendBytes(Bytes, static_cast<int32>(Vertices.size()));
+        for (const auto& Vertex : Vertices) {
+            AppendBytes(Bytes, FMath::RoundToInt64((Vertex.x - Origin.X) * GeometryQuantizationScale));
+            AppendBytes(Bytes, FMath::RoundToInt64((Vertex.y - Origin.Y) * GeometryQuantizationScale));
+            AppendBytes(Bytes, FMath::RoundToInt64((Vertex.z - Origin.Z) * GeometryQuantizationScale));
+        }
+        AppendArrayBytes(Bytes, Indices);
+        AppendArrayBytes(Bytes, InMesh.getUV1());
+        AppendArrayBytes(Bytes, InMesh.getUV4());
+
+        AppendBytes(Bytes, static_cast<int32>(SubMeshes.size()));
+        for (const auto& SubMesh : SubMeshes) {
+            const auto& TexturePath = SubMesh.getTexturePath();
+            const FPLATEAUMaterialKey Key = KeyTable.MakeKey(SubMesh.getMaterial(),
+                TexturePath.empty() ? FString() : FString(UTF8_TO_TCHAR(TexturePath.c_str())), SubMesh.getGameMaterialID());
+            AppendBytes(Bytes, static_cast<int32>(SubMesh.getStartIndex()));
+            AppendBytes(Bytes, static_cast<int32>(SubMesh.getEndIndex()));
+            AppendBytes(Bytes, Key);
+        }
+
+        Signature.Hash = CityHash64(reinterpret_cast<const char*>(Bytes.GetData()), Bytes.Num());
+        return Signature;
+    }
+}
+
 FSubMeshMaterialSet::FSubMeshMaterialSet() {
 }
 
-FSubMeshMaterialSet::FSubMeshMaterialSet(std::shared_ptr<const citygml::Material> mat, FString texPath, int matId) {
+FSubMeshMaterialSet::FSubMeshMaterialSet(std::shared_ptr<const citygml::Material> mat, FString texPath, int matId, FPLATEAUMaterialKeyTable& KeyTable) {
     hasMaterial = mat != nullptr;
     if (hasMaterial) {
         auto dif = mat->getDiffuse();
@@ -50,6 +134,7 @@ FSubMeshMaterialSet::FSubMeshMaterialSet(std::shared_ptr<const citygml::Material
     }
     TexturePath = texPath;
     GameMaterialID = matId;
+    Key = KeyTable.MakeKey(mat, TexturePath, GameMaterialID);
 }
 
 bool FSubMeshMaterialSet::operator==(const FSubMeshMaterialSet& Other) const {
@@ -57,35 +142,7 @@ bool FSubMeshMaterialSet::operator==(const FSubMeshMaterialSet& Other) const {
 }
 
 bool FSubMeshMaterialSet::Equals(const FSubMeshMaterialSet& Other) const {
-    float tl = 0.f;
-    return Diffuse.Equals(Other.Diffuse, tl) &&
-        Specular.Equals(Other.Specular, tl) &&
-        Emissive.Equals(Other.Emissive, tl) &&
-        FMath::IsNearlyEqual(Shininess, Other.Shininess, tl) &&
-        FMath::IsNearlyEqual(Transparency, Other.Transparency, tl) &&
-        FMath::IsNearlyEqual(Ambient, Other.Ambient, tl) &&
-        isSmooth == Other.isSmooth &&
-        hasMaterial == Other.hasMaterial &&
-        TexturePath.Equals(Other.TexturePath) &&
-        GameMaterialID == Other.GameMaterialID;
-}
-
-FORCEINLINE uint32 GetTypeHash(const FSubMeshMaterialSet& Value) {
-    TArray<uint32> HashArray;
-    HashArray.Add(FCrc::MemCrc32(&Value.Diffuse, sizeof(FVector3f)));
-    HashArray.Add(FCrc::MemCrc32(&Value.Specular, sizeof(FVector3f)));
-    HashArray.Add(FCrc::MemCrc32(&Value.Emissive, sizeof(FVector3f)));
-    HashArray.Add(FCrc::MemCrc32(&Value.Shininess, sizeof(float)));
-    HashArray.Add(FCrc::MemCrc32(&Value.Transparency, sizeof(float)));
-    HashArray.Add(FCrc::MemCrc32(&Value.Ambient, sizeof(float)));
-    HashArray.Add(FCrc::MemCrc32(&Value.isSmooth, sizeof(bool)));
-    HashArray.Add(FCrc::MemCrc32(&Value.TexturePath, sizeof(FString)));
-    HashArray.Add(FCrc::MemCrc32(&Value.GameMaterialID, sizeof(int)));
-    uint32 Hash = 0;
-    for (auto h : HashArray) {
-        Hash = HashCombine(Hash, h);
-    }
-    return Hash;
+    return Key == Other.Key;
 }
 
 FNodeHierarchy::FNodeHierarchy() {
@@ -108,52 +165,41 @@ std::string FNodeHierarchy::GetNameAsStandardString() {
 
 
 void FPLATEAUMeshLoader::ComputeNormals(FStaticMeshAttributes& Attributes, bool InvertNormal) {
-    const auto Normals = Attributes.GetVertexInstanceNormals();
-    const auto Indices = Attributes.GetVertexInstanceVertexIndices();
-    const auto Vertices = Attributes.GetVertexPositions();
-
-    const uint32 NumFaces = Indices.GetNumElements() / 3;
-    for (uint32 FaceIndex = 0; FaceIndex < NumFaces; ++FaceIndex) {
-        const int32 FaceOffset = FaceIndex * 3;
-
-        FVector3f VertexPositions[3];
-        int32 VertexIndices[3];
-
-        // Retrieve vertex indices and positions
-        VertexIndices[0] = Indices[FaceOffset];
-        VertexPositions[0] = Vertices[VertexIndices[0]];
-
-        VertexIndices[1] = Indices[FaceOffset + 1];
-        VertexPositions[1] = Vertices[VertexIndices[1]];
-
-        VertexIndices[2] = Indices[FaceOffset + 2];
-        VertexPositions[2] = Vertices[VertexIndices[2]];
-
-        // Calculate normal for triangle face	
-        FVector3f N = InvertNormal ?
-            FVector3f::CrossProduct((VertexPositions[0] - VertexPositions[1]),
-                (VertexPositions[0] - VertexPositions[2])) :
-            FVector3f::CrossProduct((VertexPositions[0] - VertexPositions[2]),
-                (VertexPositions[0] - VertexPositions[1]));
-
-        N.Normalize();
-
-        // Unrolled loop
-        Normals[FaceOffset + 0] += N;
-        Normals[FaceOffset + 1] += N;
-        Normals[FaceOffset + 2] += N;
-    }
-
-    for (int i = 0; i < Normals.GetNumElements(); ++i) {
-        Normals[i].Normalize();
-    }
+    // 頂点インスタンスは面毎に独立しているため、面単位で並列に計算できる
+    const auto Normals = Attributes.GetVertexInstanceNormals().GetRawArray();
+    const auto Indices = Attributes.GetVertexInstanceVertexIndices().GetRawArray();
+    const auto Vertices = Attributes.GetVertexPositions().GetRawArray();
+
+    const int32 NumFaces = Indices.Num() / 3;
+    constexpr int32 FacesPerBatch = 4096;
+    const int32 NumBatches = FMath::DivideAndRoundUp(NumFaces, FacesPerBatch);
+    ParallelFor(NumBatches, [&](const int32 BatchIndex) {
+        const int32 FaceEnd = FMath::Min(NumFaces, (BatchIndex + 1) * FacesPerBatch);
+        for (int32 FaceIndex = BatchIndex * FacesPerBatch; FaceIndex < FaceEnd; ++FaceIndex) {
+            const int32 FaceOffset = FaceIndex * 3;
+
+            const FVector3f& P0 = Vertices[Indices[FaceOffset].GetValue()];
+            const FVector3f& P1 = Vertices[Indices[FaceOffset + 1].GetValue()];
+            const FVector3f& P2 = Vertices[Indices[FaceOffset + 2].GetValue()];
+
+            // Calculate normal for triangle face
+            FVector3f N = InvertNormal
+                ? FVector3f::CrossProduct(P0 - P1, P0 - P2)
+                : FVector3f::CrossProduct(P0 - P2, P0 - P1);
+            N.Normalize();
+
+            Normals[FaceOffset + 0] = N;
+            Normals[FaceOffset + 1] = N;
+            Normals[FaceOffset + 2] = N;
+        }
+        });
 }
 
 bool FPLATEAUMeshLoader::ConvertMesh(const plateau::polygonMesh::Mesh& InMesh, FMeshDescription& OutMeshDescription,
-    TArray<FSubMeshMaterialSet>& SubMeshMaterialSets, bool InvertNormal, bool MergeTriangles) {
+    TArray<FSubMeshMaterialSet>& SubMeshMaterialSets, bool InvertNormal, bool MergeTriangles, const FVector& Origin) {
     FStaticMeshAttributes Attributes(OutMeshDescription);
 
-    // UVチャンネル数を3に設定
+    // UVチャンネル数を4に設定
     const auto VertexInstanceUVs = Attributes.GetVertexInstanceUVs();
     if (VertexInstanceUVs.GetNumChannels() < 4) {
         VertexInstanceUVs.SetNumChannels(4);
@@ -161,35 +207,30 @@ bool FPLATEAUMeshLoader::ConvertMesh(const plateau::polygonMesh::Mesh& InMesh, F
 
     const auto& InVertices = InMesh.getVertices();
     const auto& InIndices = InMesh.getIndices();
-
-    const auto FaceCount = InIndices.size() / 3;
-    // 同じ頂点は複数の面に利用されないように複製されるため、頂点数はインデックス数と同じサイズになる。
-    const auto VertexCount = InIndices.size();
-
-    OutMeshDescription.ReserveNewVertices(VertexCount);
-    OutMeshDescription.ReserveNewPolygons(FaceCount);
-    OutMeshDescription.ReserveNewVertexInstances(VertexCount);
-    OutMeshDescription.ReserveNewEdges(VertexCount);
-
-    const auto VertexPositions = Attributes.GetVertexPositions();
-    for (const auto& Vertex : InVertices) {
-        const auto VertexID = OutMeshDescription.CreateVertex();
-        VertexPositions[VertexID] = FVector3f(Vertex.x, Vertex.y, Vertex.z);
+    const auto& InUV1 = InMesh.getUV1();
+    const auto& InUV4 = InMesh.getUV4();
+    const auto& InSubMeshes = InMesh.getSubMeshes();
+    const int32 InVertexCount = static_cast<int32>(InVertices.size());
+
+    // SubMesh毎のPolygonGroupを決定
+    TMap<FPLATEAUMaterialKey, int32> MaterialSetIndices;
+    for (int32 Index = 0; Index < SubMeshMaterialSets.Num(); ++Index) {
+        MaterialSetIndices.Add(SubMeshMaterialSets[Index].Key, Index);
     }
-
-    // 頂点の再利用を防ぐため使用済みの頂点を保持
-    TSet<unsigned> UsedVertexIDs;
-
-    for (const auto& SubMesh : InMesh.getSubMeshes()) {
+    TArray<FPolygonGroupID> SubMeshPolygonGroupIDs;
+    SubMeshPolygonGroupIDs.Reserve(InSubMeshes.size());
+    for (const auto& SubMesh : InSubMeshes) {
         const auto& TexturePath = SubMesh.getTexturePath();
         const auto MaterialValue = SubMesh.getMaterial();
         const auto GameMaterialID = SubMesh.getGameMaterialID();
         FPolygonGroupID PolygonGroupID = 0;
         FSubMeshMaterialSet MaterialSet(MaterialValue,
             TexturePath.empty() ? FString() : FString(UTF8_TO_TCHAR(TexturePath.c_str())),
-            GameMaterialID);
-           
-        if (!SubMeshMaterialSets.Contains(MaterialSet)) {
+            GameMaterialID, *MaterialKeyTable);
+
+        const int32* FoundIndex = MaterialSetIndices.Find(MaterialSet.Key);
+        MaterialKeyTable->RecordSubMeshLookup(FoundIndex != nullptr);
+        if (FoundIndex == nullptr) {
             // マテリアル設定
             PolygonGroupID = OutMeshDescription.CreatePolygonGroup();
             FString MaterialName = "DefaultMaterial";
@@ -201,79 +242,130 @@ bool FPLATEAUMeshLoader::ConvertMesh(const plateau::polygonMesh::Mesh& InMesh, F
             }
             MaterialSet.PolygonGroupID = PolygonGroupID;
             MaterialSet.MaterialSlot = MaterialName;
-            SubMeshMaterialSets.Add(MaterialSet);
+            MaterialSetIndices.Add(MaterialSet.Key, SubMeshMaterialSets.Add(MaterialSet));
         }
         else {
-            int32 FoundIndex = SubMeshMaterialSets.Find(MaterialSet);
-            check(FoundIndex != -1);
-            FSubMeshMaterialSet* Found = &SubMeshMaterialSets[FoundIndex];
-            PolygonGroupID = Found->PolygonGroupID;
-            MaterialSet = *Found;
+            const FSubMeshMaterialSet& Found = SubMeshMaterialSets[*FoundIndex];
+            PolygonGroupID = Found.PolygonGroupID;
+            MaterialSet = Found;
         }
-            
+
         //BPのUStaticMeshDescriptionのSetPolygonGroupMaterialSlotNameと同様の処理
         if (OutMeshDescription.IsPolygonGroupValid(PolygonGroupID)) {
             const FName& SlotName = *MaterialSet.MaterialSlot;
             OutMeshDescription.PolygonGroupAttributes().SetAttribute(
                 PolygonGroupID, MeshAttribute::PolygonGroup::ImportedMaterialSlotName, 0, SlotName);
         }
+        SubMeshPolygonGroupIDs.Add(PolygonGroupID);
+    }
 
-        // インデックス、UV設定
-        const auto& StartIndex = SubMesh.getStartIndex();
-        const auto& EndIndex = SubMesh.getEndIndex();
-        TArray<FVertexInstanceID> VertexInstanceIDs;
-        for (int InIndexIndex = StartIndex; InIndexIndex <= EndIndex; ++InIndexIndex) {
-            auto VertexID = InIndices[InIndexIndex];
-
-            // 頂点が使用済みの場合は複製
-            if (UsedVertexIDs.Contains(VertexID) && !MergeTriangles) {
-                const auto NewVertexID = OutMeshDescription.CreateVertex();
-                VertexPositions[NewVertexID] = VertexPositions[VertexID];
-                VertexID = NewVertexID;
+    // 頂点インスタンス毎の参照元インデックスと頂点を決定
+    // 同じ頂点は複数の面に利用されないよう、使用済みの頂点は末尾に複製する
+    int32 InstanceCount = 0;
+    for (const auto& SubMesh : InSubMeshes) {
+        InstanceCount += FMath::Max(0, static_cast<int32>(SubMesh.getEndIndex()) - static_cast<int32>(SubMesh.getStartIndex()) + 1);
+    }
+    TArray<int32> InstanceSourceIndices;
+    TArray<int32> InstanceVertexIndices;
+    InstanceSourceIndices.SetNumUninitialized(InstanceCount);
+    InstanceVertexIndices.SetNumUninitialized(InstanceCount);
+    TArray<int32> DuplicatedVertexSources;
+    TBitArray<> UsedVertices(false, InVertexCount);
+    int32 InstanceIndex = 0;
+    for (const auto& SubMesh : InSubMeshes) {
+        const int32 StartIndex = static_cast<int32>(SubMesh.getStartIndex());
+        const int32 EndIndex = static_cast<int32>(SubMesh.getEndIndex());
+        for (int32 InIndexIndex = StartIndex; InIndexIndex <= EndIndex; ++InIndexIndex) {
+            const int32 VertexIndex = static_cast<int32>(InIndices[InIndexIndex]);
+            int32 OutVertexIndex = VertexIndex;
+            if (UsedVertices[VertexIndex] && !MergeTriangles) {
+                OutVertexIndex = InVertexCount + DuplicatedVertexSources.Add(VertexIndex);
             }
+            UsedVertices[VertexIndex] = true;
 
-            const auto NewVertexInstanceID = OutMeshDescription.CreateVertexInstance(VertexID);
-            VertexInstanceIDs.Add(NewVertexInstanceID);
-
-            const auto InUV1 = InMesh.getUV1()[InIndices[InIndexIndex]];
-            const auto UV1 = FVector2f(InUV1.x, 1.0f - InUV1.y);
-            VertexInstanceUVs.Set(NewVertexInstanceID, 0, UV1);
-                
-            const auto InUV4 = InMesh.getUV4()[InIndices[InIndexIndex]];
-            const auto UV4 = FVector2f(InUV4.x, InUV4.y);
-            VertexInstanceUVs.Set(NewVertexInstanceID, 3, UV4);
-
-            UsedVertexIDs.Add(VertexID);
+            InstanceSourceIndices[InstanceIndex] = InIndexIndex;
+            InstanceVertexIndices[InstanceIndex] = OutVertexIndex;
+            ++InstanceIndex;
         }
+    }
+
+    // 要素をまとめて確保
+    const int32 OutVertexCount = InVertexCount + DuplicatedVertexSources.Num();
+    int32 TriangleCount = 0;
+    for (const auto& SubMesh : InSubMeshes) {
+        TriangleCount += FMath::Max(0, static_cast<int32>(SubMesh.getEndIndex()) - static_cast<int32>(SubMesh.getStartIndex()) + 1) / 3;
+    }
+    OutMeshDescription.ReserveNewVertices(OutVertexCount);
+    OutMeshDescription.ReserveNewVertexInstances(InstanceCount);
+    OutMeshDescription.ReserveNewTriangles(TriangleCount);
+    OutMeshDescription.ReserveNewPolygons(TriangleCount);
+    OutMeshDescription.ReserveNewEdges(InstanceCount);
+
+    TArray<FVertexID> VertexIDs;
+    VertexIDs.SetNumUninitialized(OutVertexCount);
+    for (int32 Index = 0; Index < OutVertexCount; ++Index) {
+        VertexIDs[Index] = OutMeshDescription.CreateVertex();
+    }
+    TArray<FVertexInstanceID> VertexInstanceIDs;
+    VertexInstanceIDs.SetNumUninitialized(InstanceCount);
+    for (int32 Index = 0; Index < InstanceCount; ++Index) {
+        VertexInstanceIDs[Index] = OutMeshDescription.CreateVertexInstance(VertexIDs[InstanceVertexIndices[Index]]);
+    }
 
-        // 3頂点毎にPolygonを生成
-        TArray<FVertexInstanceID> VertexInstanceIDsCache;
-        VertexInstanceIDsCache.SetNumUninitialized(3);
-        TArray<FVector3f> TriangleVerticesCache;
-        TriangleVerticesCache.SetNumUninitialized(3);
-        for (int32 TriangleIndex = 0; TriangleIndex < (EndIndex - StartIndex + 1) / 3; ++TriangleIndex) {
-            FMemory::Memcpy(VertexInstanceIDsCache.GetData(), VertexInstanceIDs.GetData() + TriangleIndex * 3,
+    // 頂点座標、UVを連続領域に書き込み
+    const auto VertexPositions = Attributes.GetVertexPositions().GetRawArray();
+    const auto UV0s = VertexInstanceUVs.GetRawArray(0);
+    const auto UV3s = VertexInstanceUVs.GetRawArray(3);
+    ParallelFor(OutVertexCount, [&](const int32 Index) {
+        const auto& Vertex = InVertices[Index < InVertexCount ? Index : DuplicatedVertexSources[Index - InVertexCount]];
+        // 基準位置からの相対座標はdoubleで計算してからfloatにする
+        VertexPositions[VertexIDs[Index].GetValue()] = FVector3f(Vertex.x - Origin.X, Vertex.y - Origin.Y, Vertex.z - Origin.Z);
+        }, OutVertexCount < 16384);
+    ParallelFor(InstanceCount, [&](const int32 Index) {
+        const auto SourceVertexIndex = InIndices[InstanceSourceIndices[Index]];
+        const int32 InstanceRawIndex = VertexInstanceIDs[Index].GetValue();
+        const auto& UV1 = InUV1[SourceVertexIndex];
+        UV0s[InstanceRawIndex] = FVector2f(UV1.x, 1.0f - UV1.y);
+        const auto& UV4 = InUV4[SourceVertexIndex];
+        UV3s[InstanceRawIndex] = FVector2f(UV4.x, UV4.y);
+        }, InstanceCount < 16384);
+
+    // 3頂点毎にTriangleを生成
+    InstanceIndex = 0;
+    for (int32 SubMeshIndex = 0; SubMeshIndex < SubMeshPolygonGroupIDs.Num(); ++SubMeshIndex) {
+        const auto& SubMesh = InSubMeshes[SubMeshIndex];
+        const FPolygonGroupID PolygonGroupID = SubMeshPolygonGroupIDs[SubMeshIndex];
+        const int32 SubMeshInstanceCount = FMath::Max(0, static_cast<int32>(SubMesh.getEndIndex()) - static_cast<int32>(SubMesh.getStartIndex()) + 1);
+        for (int32 TriangleIndex = 0; TriangleIndex < SubMeshInstanceCount / 3; ++TriangleIndex) {
+            FVertexInstanceID TriangleInstanceIDs[3];
+            FMemory::Memcpy(TriangleInstanceIDs, VertexInstanceIDs.GetData() + InstanceIndex + TriangleIndex * 3,
                 sizeof(FVertexInstanceID) * 3);
 
             if (InvertNormal) {
                 // Invert winding order for triangles
-                VertexInstanceIDsCache.Swap(0, 2);
+                Swap(TriangleInstanceIDs[0], TriangleInstanceIDs[2]);
             }
 
-            const FPolygonID NewPolygonID = OutMeshDescription.
-                CreatePolygon(PolygonGroupID, VertexInstanceIDsCache);
-            // Fill in the polygon's Triangles - this won't actually do any polygon triangulation as we always give it triangles
-            OutMeshDescription.ComputePolygonTriangulation(NewPolygonID);
-
-            check(OutMeshDescription.GetPolygonPolygonGroup(NewPolygonID) == PolygonGroupID); //Polygon Group IDチェック
+            OutMeshDescription.CreateTriangle(PolygonGroupID, TriangleInstanceIDs);
         }
+        InstanceIndex += SubMeshInstanceCount;
     }
 
     ComputeNormals(Attributes, InvertNormal);
 
     //Compact the MeshDescription, if there was visibility mask or some bounding box clip, it need to be compacted so the sparse array are from 0 to n with no invalid data in between. 
-    FElementIDRemappings ElementIDRemappings;
-    OutMeshDescription.Compact(ElementIDRemappings);
+    // 一括生成した要素には欠番が生じないため、欠番がある場合のみ行う
+    const bool bNeedsCompact =
+        OutMeshDescription.Vertices().Num() != OutMeshDescription.Vertices().GetArraySize() ||
+        OutMeshDescription.VertexInstances().Num() != OutMeshDescription.VertexInstances().GetArraySize() ||
+        OutMeshDescription.Edges().Num() != OutMeshDescription.Edges().GetArraySize() ||
+        OutMeshDescription.Triangles().Num() != OutMeshDescription.Triangles().GetArraySize() ||
+        OutMeshDescription.Polygons().Num() != OutMeshDescription.Polygons().GetArraySize() ||
+        OutMeshDescription.PolygonGroups().Num() != OutMeshDescription.PolygonGroups().GetArraySize();
+    if (bNeedsCompact) {
+        FElementIDRemappings ElementIDRemappings;
+        OutMeshDescription.Compact(ElementIDRemappings);
+    }
 
     return OutMeshDescription.Polygons().Num() > 0;
 }
@@ -310,23 +402,108 @@ void FPLATEAUMeshLoader::LoadModel(AActor* ModelActor, USceneComponent* ParentCo
 
     UE_LOG(LogTemp, Log, TEXT("Model->getRootNodeCount(): %d"), Model->getRootNodeCount());
     LastCreatedComponents.Empty();
+    CreatedComponentCount = 0;
+    CreatedMaterialCount = 0;
+    CreatedTextureCount = 0;
     this->PathToTexture = FPathToTexture();
+    if (LoadInputData.MaterialKeyTable.IsValid())
+        MaterialKeyTable = LoadInputData.MaterialKeyTable.ToSharedRef();
+    TextureCache = LoadInputData.TextureCache;
+    Profiler = LoadInputData.Profiler;
+    ProfileGmlName = FPaths::GetCleanFilename(LoadInputData.GmlPath);
+    bInstanceRepeatedMeshes = LoadInputData.bInstanceRepeatedMeshes;
+    bRetainMeshSourceData = LoadInputData.bRetainMeshSourceData;
+    InstancingStats = FPLATEAUInstancingStats();
+    // ルートノードはLod毎のため、複数のルートノード直下に同じ名前で存在する地物を求めておく
+    MultiLodNodeNames.Reset();
+    if (bInstanceRepeatedMeshes) {
+        TMap<FString, int32> NodeNameToRoot;
+        for (int i = 0; i < Model->getRootNodeCount(); i++) {
+            const auto& RootNode = Model->getRootNodeAt(i);
+            for (int j = 0; j < RootNode.getChildCount(); j++) {
+                const FString NodeName = UTF8_TO_TCHAR(RootNode.getChildAt(j).getName().c_str());
+                if (const int32* Root = NodeNameToRoot.Find(NodeName); Root == nullptr)
+                    NodeNameToRoot.Add(NodeName, i);
+                else if (*Root != i)
+                    MultiLodNodeNames.Add(NodeName);
+            }
+        }
+    }
+    TArray<FString> TexturePaths;
+    if (TextureCache.IsValid()) {
+        // 抽出後に先読み済みであれば何もしない
+        TexturePaths = FPLATEAUTextureCache::CollectTexturePaths(*Model);
+        TextureCache->Prefetch(TexturePaths);
+    }
+
+    // Component作成をメッシュ毎にゲームスレッドで待機せず、Tick毎にまとめて実行する
+    TUniquePtr<FPLATEAUComponentCommandBuffer> CommandBuffer;
+    if (LoadInputData.ComponentCreationBatchSize > 0) {
+        CommandBuffer = MakeUnique<FPLATEAUComponentCommandBuffer>(
+            LoadInputData.ComponentCreationBatchSize, LoadInputData.ComponentCreationTimeBudgetMs);
+    }
+
     for (int i = 0; i < Model->getRootNodeCount(); i++) {
         if (bCanceled->Load(EMemoryOrder::Relaxed))
             break;
 
-        LoadNodeRecursive(ParentComponent, Model->getRootNodeAt(i), LoadInputData, CityModel, *ModelActor);
+        // メッシュ変換はワーカースレッドで並列に行い、ゲームスレッドではComponent作成のみ行う
+        {
+            FPLATEAUImportProfiler::FScope Scope(Profiler.Get(), EPLATEAUImportStage::ConvertMesh, ProfileGmlName);
+            PrepareMeshesInParallel(Model->getRootNodeAt(i), bCanceled);
+        }
+
+        // ゲームスレッドでデコードを待たないよう、テクスチャのデコード完了をこのスレッドで待機
+        if (TextureCache.IsValid())
+            TextureCache->Wait(TexturePaths);
+
+        {
+            FPLATEAUImportProfiler::FScope Scope(Profiler.Get(), EPLATEAUImportStage::CreateComponent, ProfileGmlName);
+            if (CommandBuffer.IsValid()) {
+                EnqueueNodeRecursive(*CommandBuffer, MakeShared<USceneComponent*, ESPMode::ThreadSafe>(ParentComponent),
+                    Model->getRootNodeAt(i), LoadInputData, CityModel, *ModelActor);
+                CommandBuffer->Flush();
+            }
+            else {
+                LoadNodeRecursive(ParentComponent, Model->getRootNodeAt(i), LoadInputData, CityModel, *ModelActor);
+            }
+        }
+        PreparedMeshes.Reset();
+        InstancedMeshGroups.Reset();
+        MeshInstances.Reset();
 
         // メッシュをワールド内にビルド
-        const auto CopiedStaticMeshes = StaticMeshes;
-        FFunctionGraphTask::CreateAndDispatchWhenReady(
-            [CopiedStaticMeshes, &bCanceled]() {
-                UStaticMesh::BatchBuild(CopiedStaticMeshes, true, [&bCanceled](UStaticMesh* mesh) {
-                    return bCanceled->Load(EMemoryOrder::Relaxed);
-                    });
-            }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+        {
+            FPLATEAUImportProfiler::FScope Scope(Profiler.Get(), EPLATEAUImportStage::BuildMesh, ProfileGmlName);
+            const auto CopiedStaticMeshes = StaticMeshes;
+            FFunctionGraphTask::CreateAndDispatchWhenReady(
+                [CopiedStaticMeshes, &bCanceled]() {
+                    SCOPE_CYCLE_COUNTER(STAT_Mesh_Build);
+                    UStaticMesh::BatchBuild(CopiedStaticMeshes, true, [&bCanceled](UStaticMesh* mesh) {
+                        return bCanceled->Load(EMemoryOrder::Relaxed);
+                        });
+                }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+        }
         StaticMeshes.Reset();
+
+        // Component作成済みのメッシュは不要なため解放し、確保しているメモリを減らす
+        if (MemoryReservation.IsValid()) {
+            ReleaseMeshesRecursive(Model->getRootNodeAt(i));
+            MemoryReservation->Shrink(FPLATEAUMemoryBudget::EstimateModelBytes(*Model));
+        }
+    }
+
+    // ゲームスレッドで数えた作成数はゲームスレッドの待機後に記録する
+    if (Profiler.IsValid()) {
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::Components, CreatedComponentCount);
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::Materials, CreatedMaterialCount);
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::Textures, CreatedTextureCount);
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::InstancedMeshes, InstancingStats.InstancedMeshes);
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::Instances, InstancingStats.Instances);
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::SavedDrawCalls, InstancingStats.SavedDrawCalls);
     }
+    if (InstancingStats.Instances > 0)
+        UE_LOG(LogTemp, Log, TEXT("Instancing %s: %s"), *ProfileGmlName, *InstancingStats.ToString());
 
     FFunctionGraphTask::CreateAndDispatchWhenReady(
         [ParentComponent, PathToTexture=this->PathToTexture, OverwriteTexture=OverwriteTexture()]() {
@@ -342,6 +519,14 @@ void FPLATEAUMeshLoader::LoadModel(AActor* ModelActor, USceneComponent* ParentCo
         }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
 }
 
+void FPLATEAUMeshLoader::SetCachedCityObjects(const TSharedPtr<const FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>& InCachedCityObjects) {
+    CachedCityObjects = InCachedCityObjects;
+}
+
+void FPLATEAUMeshLoader::SetMemoryReservation(const TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe>& InMemoryReservation) {
+    MemoryReservation = InMemoryReservation;
+}
+
 void FPLATEAUMeshLoader::LoadNodeRecursive(
     USceneComponent* InParentComponent,
     const plateau::polygonMesh::Node& InNode,
@@ -357,174 +542,439 @@ void FPLATEAUMeshLoader::LoadNodeRecursive(
     }
 }
 
+void FPLATEAUMeshLoader::EnqueueNodeRecursive(
+    FPLATEAUComponentCommandBuffer& CommandBuffer,
+    const TSharedRef<USceneComponent*, ESPMode::ThreadSafe>& ParentSlot,
+    const plateau::polygonMesh::Node& InNode,
+    const FLoadInputData& InLoadInputData,
+    const std::shared_ptr<const citygml::CityModel> InCityModel,
+    AActor& InActor) {
+    const auto Slot = MakeShared<USceneComponent*, ESPMode::ThreadSafe>(nullptr);
+    CommandBuffer.Enqueue([this, Slot, ParentSlot, &InNode, &InLoadInputData, InCityModel, &InActor] {
+        *Slot = LoadNodeInGameThread(*ParentSlot, InNode, InLoadInputData, InCityModel, InActor);
+        });
+
+    const size_t ChildNodeCount = InNode.getChildCount();
+    for (int i = 0; i < ChildNodeCount; i++) {
+        EnqueueNodeRecursive(CommandBuffer, Slot, InNode.getChildAt(i), InLoadInputData, InCityModel, InActor);
+    }
+}
+
+void FPLATEAUMeshLoader::PrepareMeshesInParallel(const plateau::polygonMesh::Node& RootNode, TAtomic<bool>* bCanceled) {
+    // 変換対象のメッシュを収集
+    TArray<const plateau::polygonMesh::Mesh*> Meshes;
+    // 子を持たないノードのメッシュのみインスタンス化できる
+    TBitArray<> InstanceableMeshes;
+    // 他のLodに同じ名前の地物が存在するLod直下のノードは、Lodによるフィルタリングで対応付けられるようインスタンス化しない
+    TArray<TPair<const plateau::polygonMesh::Node*, bool>> NodeStack;
+    NodeStack.Emplace(&RootNode, false);
+    while (NodeStack.Num() > 0) {
+        const auto [Node, bIsFeature] = NodeStack.Pop();
+        if (Node->getMesh() != nullptr && Node->getMesh()->getVertices().size() > 0) {
+            Meshes.Add(Node->getMesh());
+            InstanceableMeshes.Add(Node->getChildCount() == 0 &&
+                !(bIsFeature && MultiLodNodeNames.Contains(UTF8_TO_TCHAR(Node->getName().c_str()))));
+        }
+        for (int i = 0; i < Node->getChildCount(); ++i)
+            NodeStack.Emplace(&Node->getChildAt(i), Node == &RootNode);
+    }
+
+    InstancedMeshGroups.Reset();
+    MeshInstances.Reset();
+    if (bInstanceRepeatedMeshes)
+        GroupInstancedMeshes(Meshes, InstanceableMeshes, bCanceled);
+
+    if (Profiler.IsValid()) {
+        int64 VertexCount = 0;
+        int64 TriangleCount = 0;
+        for (const auto Mesh : Meshes) {
+            VertexCount += Mesh->getVertices().size();
+            TriangleCount += Mesh->getIndices().size() / 3;
+        }
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::Vertices, VertexCount);
+        Profiler->AddCounter(ProfileGmlName, EPLATEAUImportCounter::Triangles, TriangleCount);
+    }
+
+    TArray<TSharedPtr<FPLATEAUPreparedMesh>> Results;
+    Results.SetNum(Meshes.Num());
+
+    ParallelFor(Meshes.Num(), [&](const int32 Index) {
+        if (bCanceled->Load(EMemoryOrder::Relaxed))
+            return;
+
+        // インスタンス化するメッシュはグループ毎に1つだけ変換する
+        if (const auto Instance = MeshInstances.Find(Meshes[Index])) {
+            auto& Group = InstancedMeshGroups[Instance->Group];
+            if (Group.Representative == Meshes[Index])
+                Group.PreparedMesh = PrepareMesh(*Meshes[Index], Instance->Origin);
+            return;
+        }
+
+        Results[Index] = PrepareMesh(*Meshes[Index]);
+        });
+
+    PreparedMeshes.Reset();
+    for (int32 Index = 0; Index < Meshes.Num(); ++Index) {
+        if (Results[Index].IsValid())
+            PreparedMeshes.Add(Meshes[Index], Results[Index]);
+    }
+}
+
+void FPLATEAUMeshLoader::GroupInstancedMeshes(const TArray<const plateau::polygonMesh::Mesh*>& Meshes, const TBitArray<>& InstanceableMeshes, TAtomic<bool>* bCanceled) {
+    TArray<FGeometrySignature> Signatures;
+    Signatures.SetNum(Meshes.Num());
+    ParallelFor(Meshes.Num(), [&](const int32 Index) {
+        if (!InstanceableMeshes[Index] || bCanceled->Load(EMemoryOrder::Relaxed))
+            return;
+
+        Signatures[Index] = MakeGeometrySignature(*Meshes[Index], *MaterialKeyTable);
+        });
+
+    // ハッシュが一致した場合はバイト列を比較し、一致するグループに追加
+    TArray<TArray<int32>> Candidates;
+    TMap<uint64, TArray<int32, TInlineAllocator<1>>> HashToCandidates;
+    for (int32 Index = 0; Index < Meshes.Num(); ++Index) {
+        if (Signatures[Index].Bytes.IsEmpty())
+            continue;
+
+        auto& CandidateIndices = HashToCandidates.FindOrAdd(Signatures[Index].Hash);
+        int32 Found = INDEX_NONE;
+        for (const int32 CandidateIndex : CandidateIndices) {
+            if (Signatures[Candidates[CandidateIndex][0]].Bytes == Signatures[Index].Bytes) {
+                Found = CandidateIndex;
+                break;
+            }
+        }
+        if (Found == INDEX_NONE) {
+            Found = Candidates.AddDefaulted();
+            CandidateIndices.Add(Found);
+        }
+        Candidates[Found].Add(Index);
+    }
+
+    for (const auto& Members : Candidates) {
+        if (Members.Num() < 2)
+            continue;
+
+        const int32 GroupIndex = InstancedMeshGroups.AddDefaulted();
+        auto& Group = InstancedMeshGroups[GroupIndex];
+        Group.Representative = Meshes[Members[0]];
+        Group.MeshCount = Members.Num();
+        for (const int32 Member : Members) {
+            MeshInstances.Add(Meshes[Member], { GroupIndex, Signatures[Member].Origin });
+        }
+    }
+}
+
+TSharedPtr<FPLATEAUPreparedMesh> FPLATEAUMeshLoader::PrepareMesh(const plateau::polygonMesh::Mesh& InMesh, const FVector& Origin) {
+    const auto Prepared = MakeShared<FPLATEAUPreparedMesh>();
+    FStaticMeshAttributes(Prepared->MeshDescription).Register();
+    Prepared->bHasPolygons = ConvertMesh(InMesh, Prepared->MeshDescription, Prepared->SubMeshMaterialSets, InvertMeshNormal(), MergeTriangles(), Origin);
+    ModifyMeshDescription(Prepared->MeshDescription);
+
+    // インスタンス化するメッシュは基準位置が、面を反転しないメッシュは面の向きが描画用データと異なるため保持しない
+    if (bRetainMeshSourceData && Origin.IsZero() && InvertMeshNormal()) {
+        // SubMesh毎のマテリアルスロット(ConvertMeshで作成したPolygonGroup)
+        TArray<int32> MaterialSlots;
+        for (const auto& SubMesh : InMesh.getSubMeshes()) {
+            const auto& TexturePath = SubMesh.getTexturePath();
+            const FSubMeshMaterialSet MaterialSet(SubMesh.getMaterial(),
+                TexturePath.empty() ? FString() : FString(UTF8_TO_TCHAR(TexturePath.c_str())),
+                SubMesh.getGameMaterialID(), *MaterialKeyTable);
+            const auto Found = Prepared->SubMeshMaterialSets.FindByPredicate([&MaterialSet](const FSubMeshMaterialSet& Value) {
+                return Value.Key == MaterialSet.Key;
+                });
+            MaterialSlots.Add(Found != nullptr ? Found->PolygonGroupID.GetValue() : 0);
+        }
+        Prepared->SourceData = FPLATEAUMeshSourceData::Create(InMesh, MaterialSlots);
+    }
+    return Prepared;
+}
+
 UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Actor, USceneComponent& ParentComponent,
     const plateau::polygonMesh::Mesh& InMesh,
     const FLoadInputData& LoadInputData,
     const std::shared_ptr<const citygml::CityModel>
     CityModel, FNodeHierarchy NodeHier) {
+
+    // ワーカースレッドで変換済みであればそれを利用し、なければこのスレッドで変換
+    TSharedPtr<FPLATEAUPreparedMesh> PreparedMesh;
+    if (!PreparedMeshes.RemoveAndCopyValue(&InMesh, PreparedMesh))
+        PreparedMesh = PrepareMesh(InMesh);
+
+    // ゲームスレッドでの処理は1回の待機にまとめる
+    UStaticMeshComponent* Component = nullptr;
+    FFunctionGraphTask::CreateAndDispatchWhenReady(
+        [this, &Actor, &ParentComponent, &InMesh, &LoadInputData, &CityModel, &NodeHier, &PreparedMesh, &Component]() {
+            Component = CreateStaticMeshComponentInGameThread(Actor, ParentComponent, InMesh, LoadInputData, CityModel, NodeHier, *PreparedMesh);
+        }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+
+    return Component;
+}
+
+UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponentInGameThread(AActor& Actor, USceneComponent& ParentComponent,
+    const plateau::polygonMesh::Mesh& InMesh,
+    const FLoadInputData& LoadInputData,
+    const std::shared_ptr<const citygml::CityModel> CityModel,
+    const FNodeHierarchy& NodeHier,
+    FPLATEAUPreparedMesh& PreparedMesh) {
+    check(IsInGameThread());
+
     // コンポーネント作成
     const FString NodeName = NodeHier.NodeName;
-    UStaticMesh* StaticMesh;
-    UStaticMeshComponent* Component = nullptr;
-    UStaticMeshComponent* ComponentRef = nullptr;
-    TArray<FSubMeshMaterialSet> SubMeshMaterialSets;
-    FMeshDescription* MeshDescription;
-    {
-        FFunctionGraphTask::CreateAndDispatchWhenReady(
-            [this, &LoadInputData, &NodeHier, &InMesh, &CityModel, &Component, &Actor, &StaticMesh, &MeshDescription,
-            &NodeName]() {
+    UStaticMeshComponent* Component = GetStaticMeshComponentForCondition(Actor, NAME_None, NodeHier, InMesh, LoadInputData, CityModel);
+    if (bAutomationTest) {
+        Component->Mobility = EComponentMobility::Movable;
+    }
+    else {
+        Component->Mobility = EComponentMobility::Static;
+    }
 
-                Component = GetStaticMeshComponentForCondition(Actor, NAME_None, NodeHier, InMesh, LoadInputData, CityModel);
-                if (bAutomationTest) {
-                    Component->Mobility = EComponentMobility::Movable;
-                }
-                else {
-                    Component->Mobility = EComponentMobility::Static;
-                }
-                // StaticMesh作成
-                StaticMesh = CreateStaticMesh(InMesh, Component, FName(NodeName));
+    // StaticMesh作成
+    UStaticMesh* StaticMesh = CreateStaticMesh(InMesh, Component, FName(NodeName));
+    const TArray<FSubMeshMaterialSet> SubMeshMaterialSets = MoveTemp(PreparedMesh.SubMeshMaterialSets);
+    FMeshDescription* MeshDescription = &PreparedMesh.MeshDescription;
 #if WITH_EDITOR
-                Component->bVisualizeComponent = true;
-                MeshDescription = StaticMesh->CreateMeshDescription(0);
+    Component->bVisualizeComponent = true;
+    MeshDescription = StaticMesh->CreateMeshDescription(0, MoveTemp(PreparedMesh.MeshDescription));
+    StaticMesh->CommitMeshDescription(0);
 #endif
-            }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+    StaticMeshes.Add(StaticMesh);
+#if WITH_EDITOR
+    StaticMesh->OnPostMeshBuild().AddLambda(
+        [Component](UStaticMesh* Mesh) {
+            if (Component == nullptr)
+                return;
+            // Runtime用にSetStaticMeshを行う際にMobilityを適切な値に変更
+            Component->SetMobility(EComponentMobility::Type::Stationary);
+            Component->SetStaticMesh(Mesh);
+            Component->SetMobility(EComponentMobility::Type::Static);
+
+            // Collision情報設定
+            Mesh->CreateBodySetup();
+            Mesh->GetBodySetup()->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
+        });
+
+    // ビルド前にImportVersionを設定する必要がある。
+    StaticMesh->ImportVersion = EImportStaticMeshVersion::LastVersion;
+
+    // TODO: 適切なフラグの設定
+    // https://docs.unrealengine.com/4.26/ja/ProgrammingAndScripting/ProgrammingWithCPP/UnrealArchitecture/Objects/Creation/
+    //StaticMesh->SetFlags();
+#endif
+    AddMaterialsInGameThread(*StaticMesh, *Component, ParentComponent, SubMeshMaterialSets, *MeshDescription, LoadInputData, NodeHier);
+    if (PreparedMesh.SourceData.IsValid()) {
+        if (const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Component))
+            CityObjectGroup->SetMeshSourceData(MoveTemp(PreparedMesh.SourceData));
     }
 
-    ConvertMesh(InMesh, *MeshDescription, SubMeshMaterialSets, InvertMeshNormal(), MergeTriangles());
-    ModifyMeshDescription(*MeshDescription);
+    // 名前設定、ヒエラルキー設定など
+    Component->DepthPriorityGroup = SDPG_World;
+    const FString NewUniqueName = 
+        FPLATEAUComponentUtil::MakeUniqueGmlObjectName(&Actor, UPLATEAUCityObjectGroup::StaticClass(),
+        StaticMesh->GetName());
 
+    Component->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
+    Actor.AddInstanceComponent(Component);
+    Component->RegisterComponent();
+    Component->AttachToComponent(&ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
 #if WITH_EDITOR
-    FFunctionGraphTask::CreateAndDispatchWhenReady(
-        [&StaticMesh]() {
-            StaticMesh->CommitMeshDescription(0);
-        }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+    Component->PostEditChange();
 #endif
-        StaticMeshes.Add(StaticMesh);
-#if WITH_EDITOR
-        StaticMesh->OnPostMeshBuild().AddLambda(
-            [Component](UStaticMesh* Mesh) {
-                if (Component == nullptr)
-                    return;
-                // Runtime用にSetStaticMeshを行う際にMobilityを適切な値に変更
-                Component->SetMobility(EComponentMobility::Type::Stationary);
-                Component->SetStaticMesh(Mesh);
-                Component->SetMobility(EComponentMobility::Type::Static);
-
-                // Collision情報設定
-                Mesh->CreateBodySetup();
-                Mesh->GetBodySetup()->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
-            });
 
-        const FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([&StaticMesh] {
-            // ビルド前にImportVersionを設定する必要がある。
-            StaticMesh->ImportVersion = EImportStaticMeshVersion::LastVersion;
+    LastCreatedComponents.Add(Component);
+    ++CreatedComponentCount;
+    return Component;
+}
 
-            // TODO: 適切なフラグの設定
-            // https://docs.unrealengine.com/4.26/ja/ProgrammingAndScripting/ProgrammingWithCPP/UnrealArchitecture/Objects/Creation/
-            //StaticMesh->SetFlags();
-            }, TStatId(), nullptr, ENamedThreads::GameThread);
-        Task->Wait();
-#endif
-        //PolygonGroup数の整合性チェック
-        if (SubMeshMaterialSets.Num() != MeshDescription->PolygonGroups().Num())
-            UE_LOG(LogTemp, Error, TEXT("SubMesh/PolygonGroups size wrong => %s %s SubMesh: %d PolygonGroups: %d "), *ParentComponent.GetName(), *NodeName, SubMeshMaterialSets.Num(), MeshDescription->PolygonGroups().Num());
+void FPLATEAUMeshLoader::AddMaterialsInGameThread(UStaticMesh& StaticMesh, UStaticMeshComponent& Component, USceneComponent& ParentComponent,
+    const TArray<FSubMeshMaterialSet>& SubMeshMaterialSets,
+    const FMeshDescription& MeshDescription,
+    const FLoadInputData& LoadInputData,
+    const FNodeHierarchy& NodeHier) {
+    check(IsInGameThread());
+
+    //PolygonGroup数の整合性チェック
+    if (SubMeshMaterialSets.Num() != MeshDescription.PolygonGroups().Num())
+        UE_LOG(LogTemp, Error, TEXT("SubMesh/PolygonGroups size wrong => %s %s SubMesh: %d PolygonGroups: %d "), *ParentComponent.GetName(), *NodeHier.NodeName, SubMeshMaterialSets.Num(), MeshDescription.PolygonGroups().Num());
 
-        const auto ComponentSetupTask = FFunctionGraphTask::CreateAndDispatchWhenReady(
-            [&SubMeshMaterialSets, this, &Component, &StaticMesh, &MeshDescription, &Actor, &ParentComponent, &
-                ComponentRef, &LoadInputData, &NodeHier]
+    for (const auto& SubMeshValue : SubMeshMaterialSets)
+    {
+        UMaterialInterface** SharedMatPtr = CachedMaterials.Find(SubMeshValue);
+        MaterialKeyTable->RecordMaterialCacheLookup(SharedMatPtr != nullptr);
+        if (SharedMatPtr == nullptr)
+        {
+            // マテリアル作成
+            UMaterialInterface* MaterialInterface;
+
+            // 変換前のマテリアルを使う箇所で、変換前のマテリアル情報があればそれを利用
+            int gameMatID = SubMeshValue.GameMaterialID;
+            if (const auto PreCachedMaterial = GetPreCachedMaterial(gameMatID))
             {
-                for (const auto& SubMeshValue : SubMeshMaterialSets)
+                MaterialInterface = PreCachedMaterial;
+            }
+            // 新規マテリアル作成
+            else 
+            {
+                FPLATEAUImportProfiler::FScope Scope(Profiler.Get(), EPLATEAUImportStage::CreateMaterial, ProfileGmlName);
+                ++CreatedMaterialCount;
+                FString TexturePath = SubMeshValue.TexturePath;
+                UTexture2D* Texture;
+                if (TexturePath.IsEmpty())
+                {
+                    Texture = nullptr;
+                }
+                else
                 {
-                    UMaterialInterface** SharedMatPtr = CachedMaterials.Find(SubMeshValue);
-                    if (SharedMatPtr == nullptr)
+                    const bool TextureInCache = PathToTexture.Contains(TexturePath);
+                    if (TextureInCache) // テクスチャをすでにロード済みの場合、使い回します。
                     {
-                        // マテリアル作成
-                        UMaterialInterface* MaterialInterface;
-
-                        // 変換前のマテリアルを使う箇所で、変換前のマテリアル情報があればそれを利用
-                        int gameMatID = SubMeshValue.GameMaterialID;
-                        if (const auto PreCachedMaterial = GetPreCachedMaterial(gameMatID))
-                        {
-                            MaterialInterface = PreCachedMaterial;
-                        }
-                        // 新規マテリアル作成
-                        else 
-                        {
-                            FString TexturePath = SubMeshValue.TexturePath;
-                            UTexture2D* Texture;
-                            if (TexturePath.IsEmpty())
-                            {
-                                Texture = nullptr;
-                            }
-                            else
-                            {
-                                const bool TextureInCache = PathToTexture.Contains(TexturePath);
-                                if (TextureInCache) // テクスチャをすでにロード済みの場合、使い回します。
-                                {
-                                    Texture = PathToTexture[TexturePath]; // nullptrの場合もあります。
-                                }
-                                else // テクスチャ未ロードの場合、ロードします。
-                                {
-                                    Texture = FPLATEAUTextureLoader::Load(TexturePath, OverwriteTexture());
-                                    // なければnullptrを返します。
-                                    PathToTexture.Add(TexturePath, Texture);
-                                }
-                            }
-
-                            MaterialInterface = GetMaterialForSubMesh(SubMeshValue, Component, LoadInputData, Texture,
-                                                                      NodeHier, &ParentComponent);
-
-                            if (auto DynMaterial = Cast<UMaterialInstanceDynamic>(MaterialInterface))
-                            {
-                                //Textureが存在する場合
-                                if (Texture != nullptr)
-                                    DynMaterial->SetTextureParameterValue("Texture", Cast<UTexture>(Texture));
-
-                                DynMaterial->TwoSided = false;
-                            }
-                        }
-                        
-                        
-                        StaticMesh->AddMaterial(MaterialInterface);
-
-                        if (UseCachedMaterial()) {
-                            //Materialをキャッシュに保存
-                            CachedMaterials.Add(SubMeshValue, MaterialInterface);
-                        }
-
-                        //SubMeshのPolygonGroupIDとMeshDescriptionのPolygonGroupIDの整合性チェック
-                        TAttributesSet<FPolygonGroupID> PolygonGroupAttributes = MeshDescription->PolygonGroupAttributes();
-                        if (PolygonGroupAttributes.HasAttribute(MeshAttribute::PolygonGroup::ImportedMaterialSlotName)) {
-                            FName AttributeValue = PolygonGroupAttributes.GetAttribute<FName>(
-                                SubMeshValue.PolygonGroupID, MeshAttribute::PolygonGroup::ImportedMaterialSlotName, 0);
-                            check(SubMeshValue.MaterialSlot == AttributeValue.ToString());
+                        Texture = PathToTexture[TexturePath]; // nullptrの場合もあります。
+                    }
+                    else if (TextureCache.IsValid()) // インポート全体のキャッシュから取得します。デコードはワーカースレッドで済んでいます。
+                    {
+                        bool bCreated = false;
+                        Texture = TextureCache->FindOrCreateTexture(TexturePath, OverwriteTexture(), bCreated);
+                        // このLoadModelで作成したテクスチャのみ保存対象とします。
+                        if (bCreated) {
+                            PathToTexture.Add(TexturePath, Texture);
+                            ++CreatedTextureCount;
                         }
                     }
-                    else {
-                        //キャッシュのMaterialを使用
-                        StaticMesh->AddMaterial(*SharedMatPtr);
+                    else // テクスチャ未ロードの場合、ロードします。
+                    {
+                        Texture = FPLATEAUTextureLoader::Load(TexturePath, OverwriteTexture());
+                        // なければnullptrを返します。
+                        PathToTexture.Add(TexturePath, Texture);
+                        if (Texture != nullptr)
+                            ++CreatedTextureCount;
                     }
                 }
 
-                // 名前設定、ヒエラルキー設定など
-                Component->DepthPriorityGroup = SDPG_World;
-                const FString NewUniqueName = 
-                    FPLATEAUComponentUtil::MakeUniqueGmlObjectName(&Actor, UPLATEAUCityObjectGroup::StaticClass(),
-                    StaticMesh->GetName());
+                MaterialInterface = GetMaterialForSubMesh(SubMeshValue, &Component, LoadInputData, Texture,
+                                                          NodeHier, &ParentComponent);
+
+                if (auto DynMaterial = Cast<UMaterialInstanceDynamic>(MaterialInterface))
+                {
+                    MaterialKeyTable->RecordMaterialInstanceCreated();
+
+                    //Textureが存在する場合
+                    if (Texture != nullptr)
+                        DynMaterial->SetTextureParameterValue("Texture", Cast<UTexture>(Texture));
+
+                    DynMaterial->TwoSided = false;
+                }
+            }
+            
+            
+            StaticMesh.AddMaterial(MaterialInterface);
+
+            if (UseCachedMaterial()) {
+                //Materialをキャッシュに保存
+                CachedMaterials.Add(SubMeshValue, MaterialInterface);
+            }
+
+            //SubMeshのPolygonGroupIDとMeshDescriptionのPolygonGroupIDの整合性チェック
+            const auto& PolygonGroupAttributes = MeshDescription.PolygonGroupAttributes();
+            if (PolygonGroupAttributes.HasAttribute(MeshAttribute::PolygonGroup::ImportedMaterialSlotName)) {
+                FName AttributeValue = PolygonGroupAttributes.GetAttribute<FName>(
+                    SubMeshValue.PolygonGroupID, MeshAttribute::PolygonGroup::ImportedMaterialSlotName, 0);
+                check(SubMeshValue.MaterialSlot == AttributeValue.ToString());
+            }
+        }
+        else {
+            //キャッシュのMaterialを使用
+            StaticMesh.AddMaterial(*SharedMatPtr);
+        }
+    }
+}
 
-                Component->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
-                Actor.AddInstanceComponent(Component);
-                Component->RegisterComponent();
-                Component->AttachToComponent(&ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
+UPLATEAUInstancedCityObjectGroup* FPLATEAUMeshLoader::AddInstanceInGameThread(AActor& Actor, USceneComponent& ParentComponent,
+    const plateau::polygonMesh::Node& Node,
+    const FPLATEAUMeshInstance& Instance,
+    const FLoadInputData& LoadInputData,
+    const std::shared_ptr<const citygml::CityModel> CityModel) {
+    check(IsInGameThread());
+
+    auto& Group = InstancedMeshGroups[Instance.Group];
+    const FString NodeName = UTF8_TO_TCHAR(Node.getName().c_str());
+    UPLATEAUInstancedCityObjectGroup*& Component = Group.ParentToComponent.FindOrAdd(&ParentComponent);
+    if (Component == nullptr) {
+        Component = NewObject<UPLATEAUInstancedCityObjectGroup>(&Actor, NAME_None);
+        Component->Mobility = bAutomationTest ? EComponentMobility::Movable : EComponentMobility::Static;
+        Component->MeshGranularityIntValue = static_cast<int>(LoadInputData.ExtractOptions.mesh_granularity);
+        Group.Components->Add(Component);
+
+        // StaticMeshはグループで共有し、最初のコンポーネント作成時に作成
+        if (Group.StaticMesh == nullptr && Group.PreparedMesh.IsValid()) {
+            const FNodeHierarchy NodeHier(Node);
+            UStaticMesh* StaticMesh = CreateStaticMesh(*Group.Representative, Component, FName(TEXT("Instanced_") + NodeName));
+            const TArray<FSubMeshMaterialSet> SubMeshMaterialSets = MoveTemp(Group.PreparedMesh->SubMeshMaterialSets);
+            FMeshDescription* MeshDescription = &Group.PreparedMesh->MeshDescription;
 #if WITH_EDITOR
-                Component->PostEditChange();
+            MeshDescription = StaticMesh->CreateMeshDescription(0, MoveTemp(Group.PreparedMesh->MeshDescription));
+            StaticMesh->CommitMeshDescription(0);
 #endif
-                ComponentRef = Component;
-            }, TStatId(), nullptr, ENamedThreads::GameThread);
-        ComponentSetupTask->Wait();
+            StaticMeshes.Add(StaticMesh);
+#if WITH_EDITOR
+            StaticMesh->OnPostMeshBuild().AddLambda(
+                [Components = Group.Components](UStaticMesh* Mesh) {
+                    for (const auto& WeakComponent : *Components) {
+                        const auto InstancedComponent = WeakComponent.Get();
+                        if (InstancedComponent == nullptr)
+                            continue;
+                        const auto Mobility = InstancedComponent->Mobility;
+                        InstancedComponent->SetMobility(EComponentMobility::Type::Stationary);
+                        InstancedComponent->SetStaticMesh(Mesh);
+                        InstancedComponent->SetMobility(Mobility);
+                    }
+
+                    // Collision情報設定
+                    Mesh->CreateBodySetup();
+                    Mesh->GetBodySetup()->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
+                });
+            StaticMesh->ImportVersion = EImportStaticMeshVersion::LastVersion;
+#endif
+            AddMaterialsInGameThread(*StaticMesh, *Component, ParentComponent, SubMeshMaterialSets, *MeshDescription, LoadInputData, NodeHier);
+            Group.StaticMesh = StaticMesh;
+            Group.SectionCount = SubMeshMaterialSets.Num();
+            Group.PreparedMesh.Reset();
+            ++InstancingStats.InstancedMeshes;
+        }
 
-        LastCreatedComponents.Add(ComponentRef);
-        return ComponentRef;
+        Component->DepthPriorityGroup = SDPG_World;
+        // 複数のインスタンスをまとめたコンポーネントのため、地物名と区別できるよう接頭辞を付ける
+        const FString NewUniqueName = FPLATEAUComponentUtil::MakeUniqueGmlObjectName(
+            &Actor, UPLATEAUCityObjectGroup::StaticClass(), TEXT("Instanced_") + NodeName);
+        Component->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
+        Actor.AddInstanceComponent(Component);
+        Component->RegisterComponent();
+        Component->AttachToComponent(&ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
+
+        LastCreatedComponents.Add(Component);
+        ++CreatedComponentCount;
+    }
+    else {
+        ++InstancingStats.SavedComponents;
+        InstancingStats.SavedDrawCalls += Group.SectionCount;
+    }
+
+    // 属性情報はインスタンス毎にバイナリ形式で保持
+    TArray<uint8> SerializedCityObjects;
+    if (LoadInputData.bIncludeAttrInfo) {
+        const TArray<uint8>* CachedCityObject = CachedCityObjects.IsValid()
+            ? CachedCityObjects->MeshToSerializedCityObjects.Find(Node.getMesh())
+            : nullptr;
+        if (CachedCityObject != nullptr)
+            SerializedCityObjects = *CachedCityObject;
+        else if (CityModel != nullptr)
+            SerializedCityObjects = FPLATEAUNativeCityObjectSerialization().SerializeCityObject(Node.getName(), *Node.getMesh(), LoadInputData.ExtractOptions.mesh_granularity, CityModel);
+    }
+
+    // 頂点座標は基準位置からの相対座標のため、基準位置をインスタンスの位置とする
+    Component->AddCityObjectInstance(FTransform(Instance.Origin), NodeName, SerializedCityObjects);
+    ++InstancingStats.Instances;
+    return Component;
 }
 
 UStaticMeshComponent* FPLATEAUMeshLoader::GetStaticMeshComponentForCondition(AActor& Actor, EName Name, FNodeHierarchy NodeHier,
@@ -532,7 +982,13 @@ UStaticMeshComponent* FPLATEAUMeshLoader::GetStaticMeshComponentForCondition(AAc
     const FLoadInputData& LoadInputData, const std::shared_ptr <const citygml::CityModel> CityModel) {
     if (LoadInputData.bIncludeAttrInfo) {
         const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
-        PLATEAUCityObjectGroup->SerializeCityObject(NodeHier.GetNameAsStandardString(), InMesh, LoadInputData, CityModel);
+        const TArray<uint8>* CachedCityObject = CachedCityObjects.IsValid()
+            ? CachedCityObjects->MeshToSerializedCityObjects.Find(&InMesh)
+            : nullptr;
+        if (CachedCityObject != nullptr)
+            PLATEAUCityObjectGroup->SetSerializedCityObjects(*CachedCityObject, LoadInputData.ExtractOptions.mesh_granularity);
+        else if (CityModel != nullptr)
+            PLATEAUCityObjectGroup->SerializeCityObject(NodeHier.GetNameAsStandardString(), InMesh, LoadInputData, CityModel);
         return PLATEAUCityObjectGroup;
     }
     //属性情報を追加しない場合は、UPLATEAUStaticMeshComponentとする
@@ -608,58 +1064,125 @@ UMaterialInterface* FPLATEAUMeshLoader::GetMaterialForSubMesh(const FSubMeshMate
     return DynMaterial;
 }
 
-USceneComponent* FPLATEAUMeshLoader::LoadNode(USceneComponent* ParentComponent,
+bool FPLATEAUMeshLoader::TryLoadNodeWithoutStaticMesh(USceneComponent* ParentComponent,
     const plateau::polygonMesh::Node& Node,
     const FLoadInputData& LoadInputData,
     const std::shared_ptr<const citygml::CityModel> CityModel,
-    AActor& Actor) {
+    AActor& Actor,
+    const bool bInGameThread,
+    USceneComponent*& OutComponent) {
+    const auto RunInGameThread = [bInGameThread](TFunctionRef<void()> Function) {
+        if (bInGameThread) {
+            Function();
+            return;
+        }
+        FFunctionGraphTask::CreateAndDispatchWhenReady([&Function] {
+            Function();
+            }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+    };
+
+    OutComponent = nullptr;
     if (Node.getMesh() == nullptr) {
-        const auto& CityObject = CityModel->getCityObjectById(Node.getName());
-        USceneComponent* Comp = nullptr;
-        UClass* StaticClass;
-        const FString DesiredName = FString(UTF8_TO_TCHAR(Node.getName().c_str()));
-        const FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([&, DesiredName] {
-            // CityObjectがある場合はUPLATEAUCityObjectGroupとする
-            if (CityObject != nullptr && LoadInputData.bIncludeAttrInfo) { 
-                StaticClass = UPLATEAUCityObjectGroup::StaticClass();
-                const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
-                PLATEAUCityObjectGroup->SerializeCityObject(Node, CityObject, LoadInputData.ExtractOptions.mesh_granularity);
-                Comp = PLATEAUCityObjectGroup;
-            }
-            else {
-                // CityObjectがない場合はUPLATEAUSceneComponentとする
-                StaticClass = UPLATEAUSceneComponent::StaticClass();
-                Comp = NewObject<UPLATEAUSceneComponent>(&Actor, NAME_None);
-            }
+        RunInGameThread([&] {
+            OutComponent = CreateSceneComponentInGameThread(ParentComponent, Node, LoadInputData, CityModel, Actor);
+            });
+        return true;
+    }
 
-            const FString NewUniqueName = FPLATEAUComponentUtil::MakeUniqueGmlObjectName(
-                &Actor, UPLATEAUCityObjectGroup::StaticClass(),
-                DesiredName);
+    // TODO: 空のMeshが入っている問題
+    if (Node.getMesh()->getVertices().size() == 0 || ParentComponent == nullptr)
+        return true;
 
-            Comp->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
+    if (const auto Instance = MeshInstances.Find(Node.getMesh())) {
+        RunInGameThread([&] {
+            OutComponent = AddInstanceInGameThread(Actor, *ParentComponent, Node, *Instance, LoadInputData, CityModel);
+            });
+        return true;
+    }
+    return false;
+}
 
-            check(Comp != nullptr);
-            if (bAutomationTest) {
-                Comp->Mobility = EComponentMobility::Movable;
-            }
-            else {
-                Comp->Mobility = EComponentMobility::Static;
-            }
+USceneComponent* FPLATEAUMeshLoader::LoadNode(USceneComponent* ParentComponent,
+    const plateau::polygonMesh::Node& Node,
+    const FLoadInputData& LoadInputData,
+    const std::shared_ptr<const citygml::CityModel> CityModel,
+    AActor& Actor) {
+    USceneComponent* Comp;
+    if (TryLoadNodeWithoutStaticMesh(ParentComponent, Node, LoadInputData, CityModel, Actor, false, Comp))
+        return Comp;
+
+    return CreateStaticMeshComponent(Actor, *ParentComponent, *Node.getMesh(), LoadInputData, CityModel,
+        FNodeHierarchy(Node));
+}
 
-            Actor.AddInstanceComponent(Comp);
-            Comp->RegisterComponent();
-            Comp->AttachToComponent(ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
-            }, TStatId(), nullptr, ENamedThreads::GameThread);
-        Task->Wait();
+USceneComponent* FPLATEAUMeshLoader::LoadNodeInGameThread(USceneComponent* ParentComponent,
+    const plateau::polygonMesh::Node& Node,
+    const FLoadInputData& LoadInputData,
+    const std::shared_ptr<const citygml::CityModel> CityModel,
+    AActor& Actor) {
+    USceneComponent* Comp;
+    if (TryLoadNodeWithoutStaticMesh(ParentComponent, Node, LoadInputData, CityModel, Actor, true, Comp))
         return Comp;
+
+    TSharedPtr<FPLATEAUPreparedMesh> PreparedMesh;
+    if (!PreparedMeshes.RemoveAndCopyValue(Node.getMesh(), PreparedMesh))
+        PreparedMesh = PrepareMesh(*Node.getMesh());
+
+    return CreateStaticMeshComponentInGameThread(Actor, *ParentComponent, *Node.getMesh(), LoadInputData, CityModel,
+        FNodeHierarchy(Node), *PreparedMesh);
+}
+
+USceneComponent* FPLATEAUMeshLoader::CreateSceneComponentInGameThread(USceneComponent* ParentComponent,
+    const plateau::polygonMesh::Node& Node,
+    const FLoadInputData& LoadInputData,
+    const std::shared_ptr<const citygml::CityModel> CityModel,
+    AActor& Actor) {
+    check(IsInGameThread());
+
+    const TArray<uint8>* CachedCityObject = CachedCityObjects.IsValid()
+        ? CachedCityObjects->NodeToSerializedCityObjects.Find(&Node)
+        : nullptr;
+    const auto& CityObject = CachedCityObject == nullptr && CityModel != nullptr
+        ? CityModel->getCityObjectById(Node.getName())
+        : nullptr;
+    const FString DesiredName = FString(UTF8_TO_TCHAR(Node.getName().c_str()));
+    USceneComponent* Comp = nullptr;
+
+    // CityObjectがある場合はUPLATEAUCityObjectGroupとする
+    if (CachedCityObject != nullptr && LoadInputData.bIncludeAttrInfo) {
+        const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
+        PLATEAUCityObjectGroup->SetSerializedCityObjects(*CachedCityObject, LoadInputData.ExtractOptions.mesh_granularity);
+        Comp = PLATEAUCityObjectGroup;
+    }
+    else if (CityObject != nullptr && LoadInputData.bIncludeAttrInfo) { 
+        const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
+        PLATEAUCityObjectGroup->SerializeCityObject(Node, CityObject, LoadInputData.ExtractOptions.mesh_granularity);
+        Comp = PLATEAUCityObjectGroup;
+    }
+    else {
+        // CityObjectがない場合はUPLATEAUSceneComponentとする
+        Comp = NewObject<UPLATEAUSceneComponent>(&Actor, NAME_None);
     }
 
-    // TODO: 空のMeshが入っている問題
-    if (Node.getMesh()->getVertices().size() == 0)
-        return nullptr;
+    const FString NewUniqueName = FPLATEAUComponentUtil::MakeUniqueGmlObjectName(
+        &Actor, UPLATEAUCityObjectGroup::StaticClass(),
+        DesiredName);
 
-    return CreateStaticMeshComponent(Actor, *ParentComponent, *Node.getMesh(), LoadInputData, CityModel,
-        FNodeHierarchy(Node));
+    Comp->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
+
+    check(Comp != nullptr);
+    if (bAutomationTest) {
+        Comp->Mobility = EComponentMobility::Movable;
+    }
+    else {
+        Comp->Mobility = EComponentMobility::Static;
+    }
+
+    Actor.AddInstanceComponent(Comp);
+    Comp->RegisterComponent();
+    Comp->AttachToComponent(ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
+    ++CreatedComponentCount;
+    return Comp;
 }
 
 void FPLATEAUMeshLoader::ModifyMeshDescription(FMeshDescription& MeshDescription) {
@@ -0,0 +1,50 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUMeshSourceData.h"
+#include <plateau/polygon_mesh/mesh.h>
+
+TSharedRef<const FPLATEAUMeshSourceData, ESPMode::ThreadSafe> FPLATEAUMeshSourceData::Create(const plateau::polygonMesh::Mesh& InMesh, const TArray<int32>& MaterialSlots) {
+    const auto Data = MakeShared<FPLATEAUMeshSourceData, ESPMode::ThreadSafe>();
+
+    const auto& InVertices = InMesh.getVertices();
+    const auto& InUV1 = InMesh.getUV1();
+    const auto& InUV4 = InMesh.getUV4();
+    const int32 VertexCount = static_cast<int32>(InVertices.size());
+    Data->Positions.SetNumUninitialized(VertexCount);
+    Data->UV1.SetNumUninitialized(VertexCount);
+    Data->UV4.SetNumUninitialized(VertexCount);
+    for (int32 i = 0; i < VertexCount; ++i) {
+        const auto& Vertex = InVertices[i];
+        Data->Positions[i] = FVector3f(Vertex.x, Vertex.y, Vertex.z);
+        Data->UV1[i] = i < InUV1.size() ? FVector2f(InUV1[i].x, InUV1[i].y) : FVector2f::ZeroVector;
+        Data->UV4[i] = i < InUV4.size() ? FVector2f(InUV4[i].x, InUV4[i].y) : FVector2f::ZeroVector;
+    }
+
+    const auto& InIndices = InMesh.getIndices();
+    Data->Indices.SetNumUninitialized(InIndices.size());
+    FMemory::Memcpy(Data->Indices.GetData(), InIndices.data(), InIndices.size() * sizeof(uint32));
+
+    const auto& InSubMeshes = InMesh.getSubMeshes();
+    Data->SubMeshStarts.Reserve(InSubMeshes.size());
+    Data->SubMeshEnds.Reserve(InSubMeshes.size());
+    Data->SubMeshMaterialSlots.Reserve(InSubMeshes.size());
+    for (int32 i = 0; i < InSubMeshes.size(); ++i) {
+        Data->SubMeshStarts.Add(static_cast<int32>(InSubMeshes[i].getStartIndex()));
+        Data->SubMeshEnds.Add(static_cast<int32>(InSubMeshes[i].getEndIndex()));
+        Data->SubMeshMaterialSlots.Add(MaterialSlots.IsValidIndex(i) ? MaterialSlots[i] : 0);
+    }
+    return Data;
+}
+
+int32 FPLATEAUMeshSourceData::GetMaterialSlotCount() const {
+    int32 Count = 0;
+    for (const auto Slot : SubMeshMaterialSlots) {
+        Count = FMath::Max(Count, Slot + 1);
+    }
+    return Count;
+}
+
+SIZE_T FPLATEAUMeshSourceData::GetAllocatedSize() const {
+    return Positions.GetAllocatedSize() + UV1.GetAllocatedSize() + UV4.GetAllocatedSize() + Indices.GetAllocatedSize() +
+        SubMeshStarts.GetAllocatedSize() + SubMeshEnds.GetAllocatedSize() + SubMeshMaterialSlots.GetAllocatedSize();
+}
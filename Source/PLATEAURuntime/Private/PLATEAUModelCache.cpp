@@ -0,0 +1,630 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUModelCache.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "CityGML/Serialization/PLATEAUNativeCityObjectSerialization.h"
+#include "CityGML/PLATEAUFeatureTypeTable.h"
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+#include <citygml/citymodel.h>
+#include <citygml/material.h>
+#include <type_traits>
+
+using namespace plateau::polygonMesh;
+
+namespace {
+    constexpr uint32 CacheMagic = 0x434D4C50; // "PLMC"
+    // 保存形式を変更した場合は更新すること
+    constexpr uint32 CacheVersion = 4;
+
+    static_assert(sizeof(TVec3d) == sizeof(double) * 3, "TVec3d must be tightly packed");
+    static_assert(sizeof(TVec2f) == sizeof(float) * 2, "TVec2f must be tightly packed");
+
+    /**
+     * @brief キャッシュから復元するマテリアル。citygml::Materialのコンストラクタはprotectedのため派生して生成します。
+     */
+    class FPLATEAUCachedMaterial : public citygml::Material {
+    public:
+        explicit FPLATEAUCachedMaterial(const std::string& Id)
+            : Material(Id) {
+        }
+    };
+
+    class FCacheWriter {
+    public:
+        explicit FCacheWriter(TArray64<uint8>& InData)
+            : Data(InData) {
+        }
+
+        template<typename T>
+        void Write(const T& Value) {
+            static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+            WriteBytes(&Value, sizeof(T));
+        }
+
+        void WriteBytes(const void* Src, const int64 Size) {
+            const int64 Offset = Data.AddUninitialized(Size);
+            FMemory::Memcpy(Data.GetData() + Offset, Src, Size);
+        }
+
+        void WriteString(const std::string& Value) {
+            Write(static_cast<uint32>(Value.size()));
+            WriteBytes(Value.data(), Value.size());
+        }
+
+        void WriteByteArray(const TArray<uint8>& Value) {
+            Write(static_cast<uint32>(Value.Num()));
+            WriteBytes(Value.GetData(), Value.Num());
+        }
+
+        template<typename T>
+        void WriteArray(const std::vector<T>& Values) {
+            Write(static_cast<uint64>(Values.size()));
+            WriteBytes(Values.data(), static_cast<int64>(Values.size() * sizeof(T)));
+        }
+
+    private:
+        TArray64<uint8>& Data;
+    };
+
+    class FCacheReader {
+    public:
+        FCacheReader(const uint8* InData, const int64 InSize)
+            : Data(InData)
+            , Size(InSize) {
+        }
+
+        template<typename T>
+        bool Read(T& OutValue) {
+            return ReadBytes(&OutValue, sizeof(T));
+        }
+
+        bool ReadBytes(void* Dst, const int64 Count) {
+            if (Count < 0 || Offset + Count > Size)
+                return false;
+            FMemory::Memcpy(Dst, Data + Offset, Count);
+            Offset += Count;
+            return true;
+        }
+
+        bool ReadString(std::string& OutValue) {
+            uint32 Length;
+            if (!Read(Length) || Offset + Length > Size)
+                return false;
+            OutValue.assign(reinterpret_cast<const char*>(Data + Offset), Length);
+            Offset += Length;
+            return true;
+        }
+
+        bool ReadByteArray(TArray<uint8>& OutValue) {
+            uint32 Length;
+            if (!Read(Length) || Offset + Length > Size)
+                return false;
+            OutValue.SetNumUninitialized(Length);
+            return ReadBytes(OutValue.GetData(), Length);
+        }
+
+        template<typename T>
+        bool ReadArray(std::vector<T>& OutValues) {
+            uint64 Count;
+            if (!Read(Count) || Count > static_cast<uint64>(Size - Offset) / sizeof(T))
+                return false;
+            OutValues.resize(Count);
+            return ReadBytes(OutValues.data(), static_cast<int64>(Count * sizeof(T)));
+        }
+
+    private:
+        const uint8* Data;
+        const int64 Size;
+        int64 Offset = 0;
+    };
+
+    // 深さ優先(行きがけ順)でノードを列挙します。保存時と読み込み時でノードの対応を取るために利用します。
+    void CollectNodesRecursive(const Node& InNode, TArray<const Node*>& OutNodes) {
+        OutNodes.Add(&InNode);
+        for (unsigned int i = 0; i < InNode.getChildCount(); ++i) {
+            CollectNodesRecursive(InNode.getChildAt(i), OutNodes);
+        }
+    }
+
+    TArray<const Node*> CollectNodes(const Model& InModel) {
+        TArray<const Node*> Nodes;
+        for (size_t i = 0; i < InModel.getRootNodeCount(); ++i) {
+            CollectNodesRecursive(InModel.getRootNodeAt(i), Nodes);
+        }
+        return Nodes;
+    }
+
+    void WriteMaterial(FCacheWriter& Writer, const citygml::Material& Material) {
+        Writer.WriteString(Material.getId());
+        Writer.Write(Material.getDiffuse());
+        Writer.Write(Material.getEmissive());
+        Writer.Write(Material.getSpecular());
+        Writer.Write(Material.getAmbientIntensity());
+        Writer.Write(Material.getShininess());
+        Writer.Write(Material.getTransparency());
+        Writer.Write(static_cast<uint8>(Material.isSmooth()));
+    }
+
+    bool ReadMaterial(FCacheReader& Reader, std::shared_ptr<const citygml::Material>& OutMaterial) {
+        std::string Id;
+        TVec3f Diffuse, Emissive, Specular;
+        float Ambient, Shininess, Transparency;
+        uint8 bIsSmooth;
+        if (!Reader.ReadString(Id) || !Reader.Read(Diffuse) || !Reader.Read(Emissive) || !Reader.Read(Specular) ||
+            !Reader.Read(Ambient) || !Reader.Read(Shininess) || !Reader.Read(Transparency) || !Reader.Read(bIsSmooth))
+            return false;
+
+        const auto Material = std::make_shared<FPLATEAUCachedMaterial>(Id);
+        Material->setDiffuse(Diffuse);
+        Material->setEmissive(Emissive);
+        Material->setSpecular(Specular);
+        Material->setAmbientIntensity(Ambient);
+        Material->setShininess(Shininess);
+        Material->setTransparency(Transparency);
+        Material->setIsSmooth(bIsSmooth != 0);
+        OutMaterial = Material;
+        return true;
+    }
+
+    /**
+     * @brief テクスチャのパスをGMLのディレクトリからの相対パスにします。
+     * キーはGMLの内容のみから作るため、データセットを移動・再ダウンロードしても読み込み時のGMLの場所から解決できるようにします。
+     * @return 相対パスにできない場合(別ドライブ等)はfalse
+     */
+    bool MakeRelativeTexturePath(const std::string& TexturePath, const FString& GmlDirectory, std::string& OutPath) {
+        OutPath = TexturePath;
+        if (TexturePath.empty() || GmlDirectory.IsEmpty())
+            return false;
+
+        FString Path = UTF8_TO_TCHAR(TexturePath.c_str());
+        FPaths::NormalizeFilename(Path);
+        if (FPaths::IsRelative(Path) || !FPaths::MakePathRelativeTo(Path, *(GmlDirectory / TEXT(""))))
+            return false;
+
+        OutPath = TCHAR_TO_UTF8(*Path);
+        return true;
+    }
+
+    std::string ResolveTexturePath(const std::string& TexturePath, const bool bIsRelative, const FString& GmlDirectory) {
+        if (!bIsRelative || GmlDirectory.IsEmpty())
+            return TexturePath;
+
+        FString Path = FPaths::Combine(GmlDirectory, UTF8_TO_TCHAR(TexturePath.c_str()));
+        FPaths::CollapseRelativeDirectories(Path);
+        return TCHAR_TO_UTF8(*Path);
+    }
+
+    void WriteMesh(FCacheWriter& Writer, const Mesh& InMesh, const TMap<const citygml::Material*, int32>& MaterialIndices, const FString& GmlDirectory) {
+        Writer.WriteArray(InMesh.getVertices());
+        Writer.WriteArray(InMesh.getIndices());
+        Writer.WriteArray(InMesh.getUV1());
+        Writer.WriteArray(InMesh.getUV4());
+        Writer.WriteArray(InMesh.getVertexColors());
+
+        const auto& SubMeshes = InMesh.getSubMeshes();
+        Writer.Write(static_cast<uint32>(SubMeshes.size()));
+        for (const auto& SubMesh : SubMeshes) {
+            Writer.Write(static_cast<uint64>(SubMesh.getStartIndex()));
+            Writer.Write(static_cast<uint64>(SubMesh.getEndIndex()));
+            std::string TexturePath;
+            const bool bIsRelative = MakeRelativeTexturePath(SubMesh.getTexturePath(), GmlDirectory, TexturePath);
+            Writer.Write(static_cast<uint8>(bIsRelative));
+            Writer.WriteString(TexturePath);
+            const auto MaterialIndex = MaterialIndices.Find(SubMesh.getMaterial().get());
+            Writer.Write(MaterialIndex != nullptr ? *MaterialIndex : INDEX_NONE);
+            Writer.Write(static_cast<int32>(SubMesh.getGameMaterialID()));
+        }
+
+        // getIdMapはconstで取得できないため複製して列挙する
+        CityObjectList CityObjects = InMesh.getCityObjectList();
+        Writer.Write(static_cast<uint32>(CityObjects.size()));
+        for (const auto& [Key, GmlId] : CityObjects.getIdMap()) {
+            Writer.Write(static_cast<int32>(Key.primary_index));
+            Writer.Write(static_cast<int32>(Key.atomic_index));
+            Writer.WriteString(GmlId);
+        }
+    }
+
+    bool ReadMesh(FCacheReader& Reader, const std::vector<std::shared_ptr<const citygml::Material>>& Materials, const FString& GmlDirectory,
+        std::unique_ptr<Mesh>& OutMesh) {
+        std::vector<TVec3d> Vertices;
+        std::vector<unsigned> Indices;
+        UV UV1, UV4;
+        std::vector<TVec3d> VertexColors;
+        if (!Reader.ReadArray(Vertices) || !Reader.ReadArray(Indices) || !Reader.ReadArray(UV1) || !Reader.ReadArray(UV4) ||
+            !Reader.ReadArray(VertexColors))
+            return false;
+
+        uint32 SubMeshCount;
+        if (!Reader.Read(SubMeshCount))
+            return false;
+        std::vector<SubMesh> SubMeshes;
+        SubMeshes.reserve(SubMeshCount);
+        for (uint32 i = 0; i < SubMeshCount; ++i) {
+            uint64 StartIndex, EndIndex;
+            uint8 bIsRelative;
+            std::string TexturePath;
+            int32 MaterialIndex, GameMaterialID;
+            if (!Reader.Read(StartIndex) || !Reader.Read(EndIndex) || !Reader.Read(bIsRelative) || !Reader.ReadString(TexturePath) ||
+                !Reader.Read(MaterialIndex) || !Reader.Read(GameMaterialID))
+                return false;
+            if (MaterialIndex >= static_cast<int32>(Materials.size()))
+                return false;
+
+            SubMeshes.emplace_back(StartIndex, EndIndex, ResolveTexturePath(TexturePath, bIsRelative != 0, GmlDirectory),
+                MaterialIndex >= 0 ? Materials[MaterialIndex] : nullptr, GameMaterialID);
+        }
+
+        uint32 CityObjectCount;
+        if (!Reader.Read(CityObjectCount))
+            return false;
+        CityObjectList CityObjects;
+        for (uint32 i = 0; i < CityObjectCount; ++i) {
+            int32 PrimaryIndex, AtomicIndex;
+            std::string GmlId;
+            if (!Reader.Read(PrimaryIndex) || !Reader.Read(AtomicIndex) || !Reader.ReadString(GmlId))
+                return false;
+            CityObjects.add(CityObjectIndex(PrimaryIndex, AtomicIndex), GmlId);
+        }
+
+        OutMesh = std::make_unique<Mesh>(std::move(Vertices), std::move(Indices), std::move(UV1), std::move(UV4),
+            std::move(SubMeshes), std::move(CityObjects));
+        if (!VertexColors.empty())
+            OutMesh->setVertexColors(VertexColors);
+        return true;
+    }
+
+    void WriteNodeRecursive(FCacheWriter& Writer, const Node& InNode, const TMap<const citygml::Material*, int32>& MaterialIndices, const FString& GmlDirectory) {
+        Writer.WriteString(InNode.getName());
+        Writer.Write(InNode.getLocalPosition());
+        Writer.Write(InNode.getLocalScale());
+        const auto Rotation = InNode.getLocalRotation();
+        Writer.Write(Rotation.getX());
+        Writer.Write(Rotation.getY());
+        Writer.Write(Rotation.getZ());
+        Writer.Write(Rotation.getW());
+        Writer.Write(static_cast<uint8>(InNode.isPrimary()));
+
+        Writer.Write(static_cast<uint8>(InNode.getMesh() != nullptr));
+        if (InNode.getMesh() != nullptr)
+            WriteMesh(Writer, *InNode.getMesh(), MaterialIndices, GmlDirectory);
+
+        Writer.Write(static_cast<uint32>(InNode.getChildCount()));
+        for (unsigned int i = 0; i < InNode.getChildCount(); ++i) {
+            WriteNodeRecursive(Writer, InNode.getChildAt(i), MaterialIndices, GmlDirectory);
+        }
+    }
+
+    bool ReadNodeRecursive(FCacheReader& Reader, const std::vector<std::shared_ptr<const citygml::Material>>& Materials,
+        const FString& GmlDirectory, TOptional<Node>& OutNode, const int32 Depth) {
+        // 破損したファイルで再帰が深くなりすぎないようにする
+        if (Depth > 256)
+            return false;
+
+        std::string Name;
+        TVec3d Position, Scale;
+        double X, Y, Z, W;
+        uint8 bIsPrimary, bHasMesh;
+        if (!Reader.ReadString(Name) || !Reader.Read(Position) || !Reader.Read(Scale) ||
+            !Reader.Read(X) || !Reader.Read(Y) || !Reader.Read(Z) || !Reader.Read(W) ||
+            !Reader.Read(bIsPrimary) || !Reader.Read(bHasMesh))
+            return false;
+
+        std::unique_ptr<Mesh> NodeMesh;
+        if (bHasMesh != 0 && !ReadMesh(Reader, Materials, GmlDirectory, NodeMesh))
+            return false;
+
+        OutNode.Emplace(Name, std::move(NodeMesh));
+        OutNode->setLocalPosition(Position);
+        OutNode->setLocalScale(Scale);
+        OutNode->setLocalRotation(Quaternion(X, Y, Z, W));
+        OutNode->setGranularityConvertInfo(bIsPrimary != 0, true);
+
+        uint32 ChildCount;
+        if (!Reader.Read(ChildCount))
+            return false;
+        OutNode->reserveChild(ChildCount);
+        for (uint32 i = 0; i < ChildCount; ++i) {
+            TOptional<Node> Child;
+            if (!ReadNodeRecursive(Reader, Materials, GmlDirectory, Child, Depth + 1))
+                return false;
+            OutNode->addChildNode(std::move(Child.GetValue()));
+        }
+        return true;
+    }
+
+}
+
+FPLATEAUModelCache::FPLATEAUModelCache(const FString& InCacheDirectory)
+    : CacheDirectory(InCacheDirectory) {
+}
+
+FString FPLATEAUModelCache::GetDefaultCacheDirectory() {
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PLATEAU"), TEXT("ModelCache"));
+}
+
+FString FPLATEAUModelCache::MakeKey(const FString& GmlPath, const MeshExtractOptions& ExtractOptions,
+    const std::vector<plateau::geometry::Extent>& Extents, const bool bIncludeAttrInfo) {
+    const FMD5Hash GmlHash = FMD5Hash::HashFile(*GmlPath);
+    if (!GmlHash.IsValid())
+        return FString();
+
+    // GMLの内容とModelに影響する抽出設定を連結してハッシュ化
+    FString KeySource = FString::Printf(TEXT("%u|%s|%d|%u|%u|%.9f,%.9f,%.9f|%d|%d|%.9f|%d|%d|%d|%d|%u|%d|%d|%s|%d|%d|%d"),
+        CacheVersion, *LexToString(GmlHash),
+        static_cast<int32>(ExtractOptions.mesh_granularity), ExtractOptions.min_lod, ExtractOptions.max_lod,
+        ExtractOptions.reference_point.x, ExtractOptions.reference_point.y, ExtractOptions.reference_point.z,
+        ExtractOptions.coordinate_zone_id, static_cast<int32>(ExtractOptions.mesh_axes), ExtractOptions.unit_scale,
+        ExtractOptions.export_appearance, ExtractOptions.grid_count_of_side,
+        ExtractOptions.exclude_city_object_outside_extent, ExtractOptions.enable_texture_packing,
+        ExtractOptions.texture_packing_resolution, ExtractOptions.attach_map_tile, ExtractOptions.map_tile_zoom_level,
+        UTF8_TO_TCHAR(ExtractOptions.map_tile_url), ExtractOptions.epsg_code,
+        ExtractOptions.exclude_polygons_outside_extent, bIncludeAttrInfo);
+    for (const auto& Extent : Extents) {
+        KeySource += FString::Printf(TEXT("|%.9f,%.9f,%.9f,%.9f,%.9f,%.9f"),
+            Extent.min.latitude, Extent.min.longitude, Extent.min.height,
+            Extent.max.latitude, Extent.max.longitude, Extent.max.height);
+    }
+
+    FSHAHash KeyHash;
+    const FTCHARToUTF8 KeySourceUtf8(*KeySource);
+    FSHA1::HashBuffer(KeySourceUtf8.Get(), KeySourceUtf8.Length(), KeyHash.Hash);
+    return KeyHash.ToString();
+}
+
+TSharedRef<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe> FPLATEAUModelCache::SerializeCityObjects(
+    const Model& InModel, const std::shared_ptr<const citygml::CityModel>& CityModel, const MeshGranularity Granularity) {
+    auto CityObjects = MakeShared<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>();
+    FPLATEAUNativeCityObjectSerialization Serializer;
+    for (const auto Node : CollectNodes(InModel)) {
+        // FPLATEAUMeshLoaderでComponentを作成する際と同じ条件でシリアライズする
+        if (Node->getMesh() == nullptr) {
+            const auto CityObject = CityModel->getCityObjectById(Node->getName());
+            if (CityObject != nullptr)
+                CityObjects->NodeToSerializedCityObjects.Add(Node, Serializer.SerializeCityObject(*Node, CityObject, Granularity));
+        }
+        else if (Node->getMesh()->getVertices().size() > 0) {
+            CityObjects->MeshToSerializedCityObjects.Add(Node->getMesh(),
+                Serializer.SerializeCityObject(Node->getName(), *Node->getMesh(), Granularity, CityModel));
+        }
+    }
+    return CityObjects;
+}
+
+void FPLATEAUModelCache::Serialize(const Model& InModel, const FPLATEAUCachedCityObjects* CityObjects, TArray64<uint8>& OutData,
+    const FPLATEAUFeatureTypeTable* FeatureTypes, const FString& GmlDirectory) {
+    OutData.Reset();
+    FCacheWriter Writer(OutData);
+    Writer.Write(CacheMagic);
+    Writer.Write(CacheVersion);
+
+    // マテリアルは複数のサブメッシュで共有されるためテーブルにまとめる
+    TMap<const citygml::Material*, int32> MaterialIndices;
+    TArray<const citygml::Material*> Materials;
+    for (const auto Mesh : InModel.getAllMeshes()) {
+        for (const auto& SubMesh : Mesh->getSubMeshes()) {
+            const auto Material = SubMesh.getMaterial().get();
+            if (Material != nullptr && !MaterialIndices.Contains(Material)) {
+                MaterialIndices.Add(Material, Materials.Num());
+                Materials.Add(Material);
+            }
+        }
+    }
+    Writer.Write(static_cast<uint32>(Materials.Num()));
+    for (const auto Material : Materials) {
+        WriteMaterial(Writer, *Material);
+    }
+
+    Writer.Write(static_cast<uint32>(InModel.getRootNodeCount()));
+    for (size_t i = 0; i < InModel.getRootNodeCount(); ++i) {
+        WriteNodeRecursive(Writer, InModel.getRootNodeAt(i), MaterialIndices, GmlDirectory);
+    }
+
+    // 属性情報はノードの行きがけ順のインデックスと対応付けて保存
+    Writer.Write(static_cast<uint8>(CityObjects != nullptr));
+    if (CityObjects != nullptr) {
+        const auto Nodes = CollectNodes(InModel);
+        uint32 SerializedCount = 0;
+        const int64 CountOffset = OutData.Num();
+        Writer.Write(SerializedCount);
+        for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex) {
+            const auto Node = Nodes[NodeIndex];
+            const TArray<uint8>* Serialized = Node->getMesh() == nullptr
+                ? CityObjects->NodeToSerializedCityObjects.Find(Node)
+                : CityObjects->MeshToSerializedCityObjects.Find(Node->getMesh());
+            if (Serialized == nullptr)
+                continue;
+
+            Writer.Write(NodeIndex);
+            Writer.WriteByteArray(*Serialized);
+            ++SerializedCount;
+        }
+        FMemory::Memcpy(OutData.GetData() + CountOffset, &SerializedCount, sizeof(SerializedCount));
+    }
+
+    // 地物タイプの表は配列をそのまま保存
+    Writer.Write(static_cast<uint8>(FeatureTypes != nullptr));
+    if (FeatureTypes != nullptr) {
+        Writer.Write(static_cast<uint32>(FeatureTypes->GmlIDBytes.Num()));
+        Writer.WriteBytes(FeatureTypes->GmlIDBytes.GetData(), FeatureTypes->GmlIDBytes.Num());
+        Writer.Write(static_cast<uint32>(FeatureTypes->Types.Num()));
+        Writer.WriteBytes(FeatureTypes->GmlIDEnds.GetData(), FeatureTypes->GmlIDEnds.Num() * sizeof(int32));
+        Writer.WriteBytes(FeatureTypes->Types.GetData(), FeatureTypes->Types.Num() * sizeof(int64));
+    }
+}
+
+bool FPLATEAUModelCache::Deserialize(const uint8* Data, const int64 Size, std::shared_ptr<Model>& OutModel,
+    TSharedPtr<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>& OutCityObjects, FPLATEAUFeatureTypeTable* OutFeatureTypes, const FString& GmlDirectory) {
+    FCacheReader Reader(Data, Size);
+    uint32 Magic, Version;
+    if (!Reader.Read(Magic) || !Reader.Read(Version) || Magic != CacheMagic || Version != CacheVersion)
+        return false;
+
+    uint32 MaterialCount;
+    if (!Reader.Read(MaterialCount))
+        return false;
+    std::vector<std::shared_ptr<const citygml::Material>> Materials;
+    Materials.reserve(MaterialCount);
+    for (uint32 i = 0; i < MaterialCount; ++i) {
+        if (!ReadMaterial(Reader, Materials.emplace_back()))
+            return false;
+    }
+
+    uint32 RootNodeCount;
+    if (!Reader.Read(RootNodeCount))
+        return false;
+    auto NewModel = Model::createModel();
+    NewModel->reserveRootNodes(RootNodeCount);
+    for (uint32 i = 0; i < RootNodeCount; ++i) {
+        TOptional<Node> RootNode;
+        if (!ReadNodeRecursive(Reader, Materials, GmlDirectory, RootNode, 0))
+            return false;
+        NewModel->addNode(std::move(RootNode.GetValue()));
+    }
+
+    uint8 bHasCityObjects;
+    if (!Reader.Read(bHasCityObjects))
+        return false;
+
+    OutCityObjects.Reset();
+    if (bHasCityObjects != 0) {
+        // ノードの追加が完了した後でないとアドレスが確定しないため、ここで対応付ける
+        const auto Nodes = CollectNodes(*NewModel);
+        const auto CityObjects = MakeShared<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>();
+        uint32 SerializedCount;
+        if (!Reader.Read(SerializedCount))
+            return false;
+        for (uint32 i = 0; i < SerializedCount; ++i) {
+            int32 NodeIndex;
+            TArray<uint8> Serialized;
+            if (!Reader.Read(NodeIndex) || !Reader.ReadByteArray(Serialized) || !Nodes.IsValidIndex(NodeIndex))
+                return false;
+
+            const auto Node = Nodes[NodeIndex];
+            if (Node->getMesh() == nullptr)
+                CityObjects->NodeToSerializedCityObjects.Add(Node, MoveTemp(Serialized));
+            else
+                CityObjects->MeshToSerializedCityObjects.Add(Node->getMesh(), MoveTemp(Serialized));
+        }
+        OutCityObjects = CityObjects;
+    }
+
+    uint8 bHasFeatureTypes;
+    if (!Reader.Read(bHasFeatureTypes))
+        return false;
+
+    if (bHasFeatureTypes != 0) {
+        FPLATEAUFeatureTypeTable FeatureTypes;
+        uint32 ByteCount, TypeCount;
+        if (!Reader.Read(ByteCount) || ByteCount > static_cast<uint64>(Size))
+            return false;
+        FeatureTypes.GmlIDBytes.SetNumUninitialized(ByteCount);
+        if (!Reader.ReadBytes(FeatureTypes.GmlIDBytes.GetData(), ByteCount) || !Reader.Read(TypeCount) || TypeCount > static_cast<uint64>(Size))
+            return false;
+        FeatureTypes.GmlIDEnds.SetNumUninitialized(TypeCount);
+        FeatureTypes.Types.SetNumUninitialized(TypeCount);
+        if (!Reader.ReadBytes(FeatureTypes.GmlIDEnds.GetData(), TypeCount * sizeof(int32)) ||
+            !Reader.ReadBytes(FeatureTypes.Types.GetData(), TypeCount * sizeof(int64)))
+            return false;
+        if (OutFeatureTypes != nullptr)
+            *OutFeatureTypes = MoveTemp(FeatureTypes);
+    }
+
+    OutModel = NewModel;
+    return true;
+}
+
+bool FPLATEAUModelCache::TryLoad(const FString& Key, const FString& GmlPath, std::shared_ptr<Model>& OutModel,
+    TSharedPtr<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>& OutCityObjects, FPLATEAUFeatureTypeTable* OutFeatureTypes) {
+    if (Key.IsEmpty()) {
+        ++MissCount;
+        return false;
+    }
+
+    const double StartSeconds = FPlatformTime::Seconds();
+    const FString FilePath = GetCacheFilePath(Key);
+    const FString GmlDirectory = GetGmlDirectory(GmlPath);
+    bool bSucceeded = false;
+    int64 FileSize = 0;
+
+    // メモリマップで読み込み、対応していないプラットフォームではファイル全体を読み込む
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.FileExists(*FilePath)) {
+        ++MissCount;
+        return false;
+    }
+
+    if (TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*FilePath)); MappedFile.IsValid()) {
+        FileSize = MappedFile->GetFileSize();
+        TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile->MapRegion(0, FileSize));
+        if (MappedRegion.IsValid())
+            bSucceeded = Deserialize(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize(), OutModel, OutCityObjects, OutFeatureTypes, GmlDirectory);
+    }
+    else {
+        TArray64<uint8> FileData;
+        if (FFileHelper::LoadFileToArray(FileData, *FilePath)) {
+            FileSize = FileData.Num();
+            bSucceeded = Deserialize(FileData.GetData(), FileData.Num(), OutModel, OutCityObjects, OutFeatureTypes, GmlDirectory);
+        }
+    }
+
+    if (!bSucceeded) {
+        UE_LOG(LogTemp, Warning, TEXT("Failed to load model cache : %s"), *FilePath);
+        ++MissCount;
+        return false;
+    }
+
+    ++HitCount;
+    BytesRead += FileSize;
+    LoadMicroseconds += static_cast<int64>((FPlatformTime::Seconds() - StartSeconds) * 1000000.0);
+    return true;
+}
+
+bool FPLATEAUModelCache::Save(const FString& Key, const FString& GmlPath, const Model& InModel, const FPLATEAUCachedCityObjects* CityObjects,
+    const FPLATEAUFeatureTypeTable* FeatureTypes) {
+    if (Key.IsEmpty())
+        return false;
+
+    TArray64<uint8> Data;
+    Serialize(InModel, CityObjects, Data, FeatureTypes, GetGmlDirectory(GmlPath));
+
+    // 書き込み途中のファイルを読み込まないよう、一時ファイルに書き込んでから置き換える
+    const FString FilePath = GetCacheFilePath(Key);
+    const FString TempFilePath = FilePath + FString::Printf(TEXT(".%u.tmp"), FPlatformTLS::GetCurrentThreadId());
+    if (!FFileHelper::SaveArrayToFile(Data, *TempFilePath)) {
+        UE_LOG(LogTemp, Warning, TEXT("Failed to save model cache : %s"), *FilePath);
+        return false;
+    }
+    if (!IFileManager::Get().Move(*FilePath, *TempFilePath, true)) {
+        IFileManager::Get().Delete(*TempFilePath);
+        return false;
+    }
+
+    BytesWritten += Data.Num();
+    return true;
+}
+
+FString FPLATEAUModelCache::GetGmlDirectory(const FString& GmlPath) {
+    if (GmlPath.IsEmpty())
+        return FString();
+
+    FString GmlDirectory = FPaths::ConvertRelativePathToFull(FPaths::GetPath(GmlPath));
+    FPaths::NormalizeDirectoryName(GmlDirectory);
+    return GmlDirectory;
+}
+
+FString FPLATEAUModelCache::GetStatsString() const {
+    return FString::Printf(TEXT("Hit: %lld, Miss: %lld, Load time: %.3f s, Bytes read: %.2f MB, Bytes written: %.2f MB"),
+        HitCount.Load(), MissCount.Load(), LoadMicroseconds.Load() / 1000000.0,
+        BytesRead.Load() / (1024.0 * 1024.0), BytesWritten.Load() / (1024.0 * 1024.0));
+}
+
+FString FPLATEAUModelCache::GetCacheFilePath(const FString& Key) const {
+    return FPaths::Combine(CacheDirectory, Key + TEXT(".plmc"));
+}
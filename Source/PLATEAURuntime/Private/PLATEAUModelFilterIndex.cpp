@@ -0,0 +1,138 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUModelFilterIndex.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
+#include "CityGML/PLATEAUFeatureTypeTable.h"
+#include "Util/PLATEAUComponentUtil.h"
+#include "Util/PLATEAUGmlUtil.h"
+
+void FPLATEAUModelFilterIndex::Build(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const TMap<FString, FPLATEAUFeatureTypeTable>* FeatureTypeTables) {
+    Reset();
+    bBuilt = true;
+
+    TArray<USceneComponent*> DescendantComponents;
+    // GML毎の地物名から同じ名前の地物が存在するLodへの対応
+    TMap<FString, uint16> NameToLods;
+    TArray<TPair<int32, FString>> FeatureNames;
+    for (const auto& GmlComponent : GmlComponents) {
+        // BillboardComponentを無視
+        if (GmlComponent == nullptr || GmlComponent.GetName().Contains("BillboardComponent"))
+            continue;
+
+        const auto Package = FPLATEAUGmlUtil::GetCityModelPackage(GmlComponent);
+        const auto FeatureTypeTable = FeatureTypeTables != nullptr ? FeatureTypeTables->Find(FPLATEAUGmlUtil::GetGmlFileName(GmlComponent)) : nullptr;
+        NameToLods.Reset();
+        FeatureNames.Reset();
+        for (const auto& LodComponent : GmlComponent->GetAttachChildren()) {
+            const auto Lod = FPLATEAUComponentUtil::ParseLodComponent(LodComponent);
+            for (const auto& FeatureComponent : LodComponent->GetAttachChildren()) {
+                const auto FeatureRecord = AddRecord(FeatureComponent, Package, Lod, INDEX_NONE, FeatureTypeTable);
+                auto& Name = FeatureNames.Emplace_GetRef(FeatureRecord, FPLATEAUComponentUtil::GetOriginalComponentName(FeatureComponent)).Value;
+                NameToLods.FindOrAdd(Name) |= GetLodBit(Lod);
+
+                DescendantComponents.Reset();
+                FeatureComponent->GetChildrenComponents(true, DescendantComponents);
+                for (const auto& DescendantComponent : DescendantComponents) {
+                    AddRecord(DescendantComponent, Package, Lod, FeatureRecord, FeatureTypeTable);
+                }
+            }
+        }
+
+        for (const auto& [FeatureRecord, Name] : FeatureNames) {
+            Records[FeatureRecord].FeatureLods = NameToLods[Name];
+        }
+    }
+
+    // 地物タイプで非表示化されたコンポーネントを含むため、現在の表示状態ではなくレコードから求める
+    UpdateLodVisibility();
+}
+
+void FPLATEAUModelFilterIndex::Reset() {
+    bBuilt = false;
+    Records.Empty();
+    LodVisibility.Empty();
+}
+
+bool FPLATEAUModelFilterIndex::IsInLodRange(const FRecord& Record, const FLodRange& LodRange, const bool bOnlyMaxLod) {
+    if (Record.Lod < LodRange.MinLod || Record.Lod > LodRange.MaxLod)
+        return false;
+
+    if (!bOnlyMaxLod)
+        return true;
+
+    const uint32 HigherLods = ~((2u << Record.Lod) - 1) & ((2u << FMath::Clamp(LodRange.MaxLod, 0, 15)) - 1);
+    return (Record.FeatureLods & HigherLods) == 0;
+}
+
+void FPLATEAUModelFilterIndex::UpdateLodVisibility() {
+    const FLodRange DefaultLodRange;
+    LodVisibility.Init(false, Records.Num());
+
+    // レコードはGML毎に並んでいるため、直前のパッケージのLod範囲を使い回す
+    auto LodRangePackage = plateau::dataset::PredefinedCityModelPackage::None;
+    const FLodRange* LodRange = bFilterByLod ? nullptr : &DefaultLodRange;
+    for (int32 i = 0; i < Records.Num(); ++i) {
+        const auto& Record = Records[i];
+        if (!(Record.Flags & ERecordFlags::RecordFeature))
+            continue;
+
+        if (bFilterByLod && Record.Package != LodRangePackage) {
+            LodRangePackage = Record.Package;
+            LodRange = LodRanges.Find(Record.Package);
+        }
+
+        LodVisibility[i] = LodRange != nullptr && IsInLodRange(Record, *LodRange, bFilterByLod ? bOnlyMaxLod : true);
+    }
+}
+
+int32 FPLATEAUModelFilterIndex::AddRecord(USceneComponent* Component, const plateau::dataset::PredefinedCityModelPackage Package, const int Lod, const int32 FeatureRecord, const FPLATEAUFeatureTypeTable* FeatureTypeTable) {
+    const int32 Index = Records.Num();
+    auto& Record = Records.AddDefaulted_GetRef();
+    Record.Component = Component;
+    Record.Package = Package;
+    Record.Lod = static_cast<uint8>(FMath::Clamp(Lod, 0, 15));
+    Record.Feature = FeatureRecord == INDEX_NONE ? Index : FeatureRecord;
+    if (FeatureRecord == INDEX_NONE)
+        Record.Flags |= ERecordFlags::RecordFeature;
+
+    // 起伏は重いため意図的に地物タイプによるフィルタリングから除外
+    if (Package == plateau::dataset::PredefinedCityModelPackage::Relief)
+        return Index;
+
+    // 属性情報のツリーは作らず、最上位のシティオブジェクトが1つの場合のみその地物タイプを保持
+    if (const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Component); CityObjectGroup != nullptr) {
+        const auto CityObjectsBinary = CityObjectGroup->GetCityObjectsBinary();
+        if (CityObjectsBinary.GetRootCount() == 1) {
+            Record.Type = UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(CityObjectsBinary.GetType(0));
+            Record.Flags |= ERecordFlags::RecordTypeFilterable;
+        }
+    }
+    // インスタンスはコンポーネント単位でしか非表示化できないため、全インスタンスの地物タイプが一致する場合のみ保持
+    else if (const auto InstancedGroup = Cast<UPLATEAUInstancedCityObjectGroup>(Component); InstancedGroup != nullptr) {
+        bool bHasType = false;
+        for (int32 i = 0; i < InstancedGroup->GetInstanceCount(); ++i) {
+            int64 Type = 0;
+            const auto CityObjectsBinary = InstancedGroup->GetCityObjectsBinary(i);
+            if (CityObjectsBinary.GetRootCount() == 1)
+                Type = UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(CityObjectsBinary.GetType(0));
+            else if (FeatureTypeTable == nullptr || !FeatureTypeTable->TryGetType(InstancedGroup->GetInstanceNodeName(i), Type))
+                return Index;
+
+            if (bHasType && Type != Record.Type)
+                return Index;
+            Record.Type = Type;
+            bHasType = true;
+        }
+        if (bHasType)
+            Record.Flags |= ERecordFlags::RecordTypeFilterable;
+    }
+    // 属性情報がない場合はコンポーネント名(最小地物の場合は末尾の番号を除いた名前)をGML IDとして地物タイプの表から検索
+    else if (FeatureTypeTable != nullptr) {
+        if (FeatureTypeTable->TryGetType(Component->GetName(), Record.Type) ||
+            FeatureTypeTable->TryGetType(FPLATEAUComponentUtil::GetOriginalComponentName(Component), Record.Type))
+            Record.Flags |= ERecordFlags::RecordTypeFilterable;
+    }
+    return Index;
+}
@@ -43,148 +43,82 @@ void FPLATEAUModelFiltering::ApplyCollisionResponseBlockToChannel(USceneComponen
 }
 
 void FPLATEAUModelFiltering::FilterLowLods(const USceneComponent* const InGmlComponent, const int MinLod, const int MaxLod) {
-    const TArray<USceneComponent*>& AttachedLodChildren = InGmlComponent->GetAttachChildren();
-
-    // 各LODに対して形状データ(コンポーネント)が存在するコンポーネント名を検索
-    TMap<int, TSet<FString>> NameMap;
-    for (const auto& LodComponent : AttachedLodChildren) {
-        const auto Lod = FPLATEAUComponentUtil::ParseLodComponent(LodComponent);
-        auto& Value = NameMap.Add(Lod);
-
-        if (Lod < MinLod || Lod > MaxLod)
-            continue;
-
-        TArray<USceneComponent*> FeatureComponents;
-        LodComponent->GetChildrenComponents(false, FeatureComponents);
-        for (const auto FeatureComponent : FeatureComponents) {
-            Value.Add(FPLATEAUComponentUtil::GetOriginalComponentName(FeatureComponent));
-        }
-    }
-
-    // フィルタリング実行
-    for (const auto& LodComponent : AttachedLodChildren) {
-        const TArray<USceneComponent*>& AttachedFeatureChildren = LodComponent->GetAttachChildren();
-        const auto Lod = FPLATEAUComponentUtil::ParseLodComponent(LodComponent);
-
-        if (Lod < MinLod || Lod > MaxLod) {
-            // LOD範囲外のLOD形状は非表示化
-            for (const auto& FeatureComponent : AttachedFeatureChildren) {
-                ApplyCollisionResponseBlockToChannel(FeatureComponent, false, true);
-                FeatureComponent->SetVisibility(false, true);
-            }
-            continue;
-        }
-
-        for (const auto& FeatureComponent : AttachedFeatureChildren) {
-            auto ComponentName = FPLATEAUComponentUtil::GetOriginalComponentName(FeatureComponent);
-            TArray<int> Keys;
-            NameMap.GetKeys(Keys);
-            auto bIsMaxLod = true;
-            for (const auto Key : Keys) {
-                if (Key <= Lod)
-                    continue;
-
-                // コンポーネントのLODよりも大きいLODが存在する場合非表示
-                if (NameMap[Key].Contains(ComponentName))
-                    bIsMaxLod = false;
-            }
-
-            ApplyCollisionResponseBlockToChannel(FeatureComponent, bIsMaxLod, true);
-            FeatureComponent->SetVisibility(bIsMaxLod, true);
-        }
+    FPLATEAUModelFilterIndex Index;
+    Index.Build({ const_cast<USceneComponent*>(InGmlComponent) });
+
+    const FPLATEAUModelFilterIndex::FLodRange LodRange{ MinLod, MaxLod };
+    for (int32 i = 0; i < Index.Records.Num(); ++i) {
+        const auto& Record = Index.Records[i];
+        if (Record.Flags & FPLATEAUModelFilterIndex::RecordFeature)
+            Index.LodVisibility[i] = FPLATEAUModelFilterIndex::IsInLodRange(Record, LodRange, true);
     }
+    ApplyVisibility(Index);
 }
 
 void FPLATEAUModelFiltering::FilterByLods(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const plateau::dataset::PredefinedCityModelPackage InPackage, 
     const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod) {
+    FPLATEAUModelFilterIndex Index;
+    Index.Build(GmlComponents);
+    FilterByLods(Index, InPackage, PackageToLodRangeMap, bOnlyMaxLod);
+}
 
-    for (const auto& GmlComponent : GmlComponents) {
-        const TArray<USceneComponent*>& AttachedLodChildren = GmlComponent->GetAttachChildren();
-
-        // 一度全ての地物メッシュを不可視にする
-        for (const auto& LodComponent : AttachedLodChildren) {
-            const TArray<USceneComponent*>& AttachedFeatureChildren = LodComponent->GetAttachChildren();
-            for (const auto& FeatureComponent : AttachedFeatureChildren) {
-                ApplyCollisionResponseBlockToChannel(FeatureComponent, false, true);
-                FeatureComponent->SetVisibility(false, true);
-            }
-        }
+void FPLATEAUModelFiltering::FilterByFeatureTypes(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const citygml::CityObject::CityObjectsType InCityObjectType) {
+    // 一時的な索引のため、Lodによる表示状態はインポート直後と同じく最大Lodのみ表示とみなす
+    FPLATEAUModelFilterIndex Index;
+    Index.Build(GmlComponents);
+    FilterByFeatureTypes(Index, InCityObjectType);
+}
 
-        // 選択されていないパッケージを除外
-        const auto Package = FPLATEAUGmlUtil::GetCityModelPackage(GmlComponent);
-        if ((Package & InPackage) == plateau::dataset::PredefinedCityModelPackage::None)
-            continue;
+int32 FPLATEAUModelFiltering::FilterByLods(FPLATEAUModelFilterIndex& Index, const plateau::dataset::PredefinedCityModelPackage InPackage,
+    const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod) {
+    UpdateLodVisibility(Index, InPackage, PackageToLodRangeMap, bOnlyMaxLod);
+    Index.bFilterByType = false;
+    return ApplyVisibility(Index);
+}
 
-        const auto MinLod = PackageToLodRangeMap[Package].MinLod;
-        const auto MaxLod = PackageToLodRangeMap[Package].MaxLod;
+int32 FPLATEAUModelFiltering::FilterByFeatureTypes(FPLATEAUModelFilterIndex& Index, const citygml::CityObject::CityObjectsType InCityObjectType) {
+    Index.bFilterByType = true;
+    Index.VisibleTypes = static_cast<int64>(InCityObjectType);
+    return ApplyVisibility(Index);
+}
 
-        // 各地物について全てのLODを表示する場合の処理
-        if (!bOnlyMaxLod) {
-            for (const auto& LodComponent : AttachedLodChildren) {
-                const auto Lod = FPLATEAUComponentUtil::ParseLodComponent(LodComponent);
-                if (MinLod <= Lod && Lod <= MaxLod) {
-                    for (const auto& FeatureComponent : LodComponent->GetAttachChildren()) {
-                        ApplyCollisionResponseBlockToChannel(FeatureComponent, true, true);
-                        FeatureComponent->SetVisibility(true, true);
-                    }
-                }
-                else {
-                    for (const auto& FeatureComponent : LodComponent->GetAttachChildren()) {
-                        ApplyCollisionResponseBlockToChannel(FeatureComponent, false, true);
-                        FeatureComponent->SetVisibility(false, true);
-                    }
-                }
-            }
-            continue;
-        }
+int32 FPLATEAUModelFiltering::FilterByLodsAndFeatureTypes(FPLATEAUModelFilterIndex& Index, const plateau::dataset::PredefinedCityModelPackage InPackage,
+    const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod, const citygml::CityObject::CityObjectsType InCityObjectType) {
+    UpdateLodVisibility(Index, InPackage, PackageToLodRangeMap, bOnlyMaxLod);
+    Index.bFilterByType = true;
+    Index.VisibleTypes = static_cast<int64>(InCityObjectType);
+    return ApplyVisibility(Index);
+}
 
-        // 各地物について最大LODのみを表示する場合の処理
-        FilterLowLods(GmlComponent, MinLod, MaxLod);
+void FPLATEAUModelFiltering::UpdateLodVisibility(FPLATEAUModelFilterIndex& Index, const plateau::dataset::PredefinedCityModelPackage InPackage,
+    const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod) {
+    // 索引を作り直しても同じ条件を適用できるよう、選択されたパッケージのLod範囲のみ索引に保持する
+    Index.bFilterByLod = true;
+    Index.bOnlyMaxLod = bOnlyMaxLod;
+    Index.LodRanges.Reset();
+    for (const auto& [Package, LodRange] : PackageToLodRangeMap) {
+        if ((Package & InPackage) != plateau::dataset::PredefinedCityModelPackage::None)
+            Index.LodRanges.Add(Package, { LodRange.MinLod, LodRange.MaxLod });
     }
+    Index.UpdateLodVisibility();
 }
 
-void FPLATEAUModelFiltering::FilterByFeatureTypes(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const citygml::CityObject::CityObjectsType InCityObjectType) {
+int32 FPLATEAUModelFiltering::ApplyVisibility(const FPLATEAUModelFilterIndex& Index) {
+    // 表示状態の変更はレンダリングステートを更新対象として登録するのみで、実際の更新はフレームの終わりにまとめて行われる
+    int32 ChangedCount = 0;
+    for (const auto& Record : Index.Records) {
+        const bool bVisible = Index.IsLodVisible(Record.Feature) && Index.IsTypeVisible(Record);
 
-    for (const auto& GmlComponent : GmlComponents) {
-        // BillboardComponentを無視
-        if (GmlComponent.GetName().Contains("BillboardComponent"))
+        const auto Component = Record.Component.Get();
+        if (Component == nullptr || Component->GetVisibleFlag() == bVisible)
             continue;
 
-        // 起伏は重いため意図的に除外
-        const auto Package = FPLATEAUGmlUtil::GetCityModelPackage(GmlComponent);
-        if (Package == plateau::dataset::PredefinedCityModelPackage::Relief)
-            continue;
-
-        for (const auto& LodComponent : GmlComponent->GetAttachChildren()) {
-            TArray<USceneComponent*> FeatureComponents;
-            LodComponent->GetChildrenComponents(true, FeatureComponents);
-            for (const auto& FeatureComponent : FeatureComponents) {
-                //この時点で不可視状態ならLodフィルタリングで不可視化されたことになるので無視
-                if (!FeatureComponent->IsVisible())
-                    continue;
-
-                auto FeatureID = FeatureComponent->GetName();
-                // BillboardComponentも混ざってるので無視
-                if (FeatureID.Contains("BillboardComponent"))
-                    continue;
-
-                if (!FeatureComponent->IsA(UPLATEAUCityObjectGroup::StaticClass()))
-                    continue;
-
-                const auto CityObjGrp = StaticCast<UPLATEAUCityObjectGroup*>(FeatureComponent);
-                const auto ObjList = CityObjGrp->GetAllRootCityObjects();
-                if (ObjList.Num() != 1)
-                    continue;
-
-                const int64 CityObjectType = UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(ObjList[0].Type);
-                if (static_cast<int64>(InCityObjectType) & CityObjectType)
-                    continue;
-
-                ApplyCollisionResponseBlockToChannel(FeatureComponent, false);
-                FeatureComponent->SetVisibility(false);
-            }
-        }
+        // 子コンポーネントもレコードを持つため伝播させない
+        ApplyCollisionResponseBlockToChannel(Component, bVisible);
+        Component->SetVisibility(bVisible);
+        ++ChangedCount;
     }
+    return ChangedCount;
 }
 
 void FPLATEAUModelFiltering::FilterByFeatureTypesLegacyCacheCityGml(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const citygml::CityObject::CityObjectsType InCityObjectType, const FString DatasetName) {
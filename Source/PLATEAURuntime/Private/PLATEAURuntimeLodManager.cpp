@@ -0,0 +1,195 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAURuntimeLodManager.h"
+#include "PLATEAUModelFiltering.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "Util/PLATEAUComponentUtil.h"
+
+namespace {
+    int64 GetTriangleCount(const UPrimitiveComponent* Component) {
+        const auto StaticMeshComponent = Cast<UStaticMeshComponent>(Component);
+        if (StaticMeshComponent == nullptr || StaticMeshComponent->GetStaticMesh() == nullptr)
+            return 0;
+
+        const auto RenderData = StaticMeshComponent->GetStaticMesh()->GetRenderData();
+        if (RenderData == nullptr || RenderData->LODResources.Num() == 0)
+            return 0;
+        return RenderData->LODResources[0].GetNumTriangles();
+    }
+
+    int32 ClampLod(const int32 Lod) {
+        return FMath::Clamp(Lod, 0, 4);
+    }
+}
+
+void FPLATEAURuntimeLodManager::Build(const FPLATEAUModelFilterIndex& Index) {
+    Reset();
+    bBuilt = true;
+
+    struct FFeatureBuildData {
+        TArray<FFeatureLod, TInlineAllocator<4>> Lods;
+        FBox Bounds = FBox(ForceInit);
+        bool bLodVisible = false;
+    };
+
+    // GMLコンポーネントと地物名から地物への対応
+    const auto& Records = Index.GetRecords();
+    TMap<TPair<const USceneComponent*, FString>, int32> NameToFeature;
+    TArray<FFeatureBuildData> BuildData;
+    for (int32 FirstRecord = 0; FirstRecord < Records.Num();) {
+        int32 EndRecord = FirstRecord + 1;
+        while (EndRecord < Records.Num() && !(Records[EndRecord].Flags & FPLATEAUModelFilterIndex::RecordFeature))
+            ++EndRecord;
+
+        const auto& Record = Records[FirstRecord];
+        const auto Component = Record.Component.Get();
+        // インスタンス化したコンポーネントはGML全体に渡るため切り替えの対象外
+        if (Component == nullptr || !(Record.Flags & FPLATEAUModelFilterIndex::RecordFeature) ||
+            Component->GetAttachParent() == nullptr || Component->IsA<UPLATEAUInstancedCityObjectGroup>()) {
+            FirstRecord = EndRecord;
+            continue;
+        }
+
+        const auto Key = MakeTuple(static_cast<const USceneComponent*>(Component->GetAttachParent()->GetAttachParent()), FPLATEAUComponentUtil::GetOriginalComponentName(Component));
+        int32 Feature;
+        if (const auto Found = NameToFeature.Find(Key)) {
+            Feature = *Found;
+        }
+        else {
+            Feature = BuildData.AddDefaulted();
+            NameToFeature.Add(Key, Feature);
+        }
+
+        auto& Data = BuildData[Feature];
+        auto& FeatureLod = Data.Lods.AddDefaulted_GetRef();
+        FeatureLod.FirstRecord = FirstRecord;
+        FeatureLod.EndRecord = EndRecord;
+        FeatureLod.Lod = Record.Lod;
+        for (int32 i = FirstRecord; i < EndRecord; ++i) {
+            const auto PrimitiveComponent = Cast<UPrimitiveComponent>(Records[i].Component.Get());
+            if (PrimitiveComponent == nullptr)
+                continue;
+
+            Data.Bounds += PrimitiveComponent->Bounds.GetBox();
+            if (Index.IsTypeVisible(Records[i]))
+                FeatureLod.Triangles += GetTriangleCount(PrimitiveComponent);
+        }
+        Data.bLodVisible |= Index.IsLodVisible(FirstRecord);
+        FirstRecord = EndRecord;
+    }
+
+    for (auto& Data : BuildData) {
+        // パッケージのフィルタリングで非表示の地物は対象外
+        if (!Data.bLodVisible || !Data.Bounds.IsValid)
+            continue;
+
+        Data.Lods.Sort([](const FFeatureLod& A, const FFeatureLod& B) {
+            return A.Lod < B.Lod;
+            });
+
+        auto& Feature = Features.AddDefaulted_GetRef();
+        Feature.Center = Data.Bounds.GetCenter();
+        Feature.Radius = Data.Bounds.GetExtent().Size();
+        Feature.FirstLod = FeatureLods.Num();
+        Feature.LodCount = Data.Lods.Num();
+        FeatureLods.Append(Data.Lods);
+
+        // 表示中の最大のLodのみを表示した状態から開始する
+        for (int32 i = Feature.FirstLod + Feature.LodCount - 1; i >= Feature.FirstLod; --i) {
+            const auto& Record = Records[FeatureLods[i].FirstRecord];
+            if (Feature.CurrentLod == INDEX_NONE && Record.Component.IsValid() && Record.Component->GetVisibleFlag())
+                Feature.CurrentLod = i;
+            else
+                SetLodVisibility(Index, FeatureLods[i], false);
+        }
+
+        ++Stats.Features;
+        if (Feature.CurrentLod != INDEX_NONE) {
+            ++Stats.FeaturesPerLod[ClampLod(FeatureLods[Feature.CurrentLod].Lod)];
+            Stats.VisibleTriangles += FeatureLods[Feature.CurrentLod].Triangles;
+        }
+    }
+}
+
+void FPLATEAURuntimeLodManager::Reset() {
+    bBuilt = false;
+    Features.Empty();
+    FeatureLods.Empty();
+    NextFeature = 0;
+    Stats = FPLATEAURuntimeLodStats();
+}
+
+int32 FPLATEAURuntimeLodManager::Update(const FPLATEAUModelFilterIndex& Index, const FVector& ViewOrigin, const float FOVDegrees, const FPLATEAURuntimeLodSettings& Settings) {
+    const double StartSeconds = FPlatformTime::Seconds();
+    const double EndSeconds = StartSeconds + Settings.TimeBudgetMs / 1000.0;
+    Stats.EvaluatedFeatures = 0;
+    Stats.SwitchedFeatures = 0;
+
+    const int32 FeatureCount = Features.Num();
+    for (int32 Evaluated = 0; Evaluated < FeatureCount; ++Evaluated) {
+        // 時刻の取得を減らすため、一定数の地物毎に時間予算を確認する
+        if ((Evaluated & 63) == 63 && FPlatformTime::Seconds() >= EndSeconds)
+            break;
+
+        auto& Feature = Features[NextFeature];
+        NextFeature = NextFeature + 1 < FeatureCount ? NextFeature + 1 : 0;
+        ++Stats.EvaluatedFeatures;
+
+        const float ScreenSize = ComputeScreenSize(Feature.Center, Feature.Radius, ViewOrigin, FOVDegrees);
+        const int32 NewLod = SelectLod(Feature, ScreenSize, Settings);
+        if (NewLod == Feature.CurrentLod)
+            continue;
+
+        if (Feature.CurrentLod != INDEX_NONE) {
+            const auto& CurrentLod = FeatureLods[Feature.CurrentLod];
+            SetLodVisibility(Index, CurrentLod, false);
+            --Stats.FeaturesPerLod[ClampLod(CurrentLod.Lod)];
+            Stats.VisibleTriangles -= CurrentLod.Triangles;
+        }
+
+        const auto& FeatureLod = FeatureLods[NewLod];
+        SetLodVisibility(Index, FeatureLod, true);
+        ++Stats.FeaturesPerLod[ClampLod(FeatureLod.Lod)];
+        Stats.VisibleTriangles += FeatureLod.Triangles;
+        Feature.CurrentLod = NewLod;
+        ++Stats.SwitchedFeatures;
+    }
+
+    Stats.UpdateSeconds = FPlatformTime::Seconds() - StartSeconds;
+    return Stats.SwitchedFeatures;
+}
+
+float FPLATEAURuntimeLodManager::ComputeScreenSize(const FVector& Center, const float Radius, const FVector& ViewOrigin, const float FOVDegrees) {
+    const double Distance = FMath::Max(FVector::Dist(Center, ViewOrigin), 1.0);
+    const double HalfFOV = FMath::DegreesToRadians(FMath::Clamp(FOVDegrees, 1.0f, 179.0f) * 0.5);
+    // 境界球の直径 / 視点からの距離での画面の幅
+    return static_cast<float>(Radius / (Distance * FMath::Tan(HalfFOV)));
+}
+
+int32 FPLATEAURuntimeLodManager::SelectLod(const FFeature& Feature, const float ScreenSize, const FPLATEAURuntimeLodSettings& Settings) const {
+    // 画面サイズが閾値以上の最大のLod。いずれも満たさない場合は最小のLod
+    int32 Selected = Feature.FirstLod;
+    for (int32 i = Feature.FirstLod; i < Feature.FirstLod + Feature.LodCount; ++i) {
+        float Threshold = Settings.GetScreenSize(FeatureLods[i].Lod);
+        if (Feature.CurrentLod != INDEX_NONE && i <= Feature.CurrentLod)
+            Threshold *= 1.0f - Settings.Hysteresis;
+        if (ScreenSize >= Threshold)
+            Selected = i;
+    }
+    return Selected;
+}
+
+void FPLATEAURuntimeLodManager::SetLodVisibility(const FPLATEAUModelFilterIndex& Index, const FFeatureLod& FeatureLod, const bool bVisible) const {
+    const auto& Records = Index.GetRecords();
+    FPLATEAUModelFiltering Filter;
+    for (int32 i = FeatureLod.FirstRecord; i < FeatureLod.EndRecord; ++i) {
+        const auto Component = Records[i].Component.Get();
+        const bool bRecordVisible = bVisible && Index.IsTypeVisible(Records[i]);
+        if (Component == nullptr || Component->GetVisibleFlag() == bRecordVisible)
+            continue;
+
+        // 子コンポーネントもレコードを持つため伝播させない
+        Filter.ApplyCollisionResponseBlockToChannel(Component, bRecordVisible);
+        Component->SetVisibility(bRecordVisible);
+    }
+}
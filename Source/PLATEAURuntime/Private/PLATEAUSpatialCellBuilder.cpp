@@ -0,0 +1,344 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUSpatialCellBuilder.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUCityModelCellProxy.h"
+#include "PLATEAUMeshExporter.h"
+#include "PLATEAUExportSettings.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "Reconstruct/PLATEAUMeshLoaderForReconstruct.h"
+#include "Util/PLATEAUComponentUtil.h"
+#include "Util/PLATEAUGmlUtil.h"
+#include <plateau/dataset/grid_code.h>
+#include <plateau/granularity_convert/granularity_converter.h>
+#include <plateau/polygon_mesh/mesh_merger.h>
+
+using namespace plateau::granularityConvert;
+
+namespace {
+    /**
+     * @brief メッシュコードの区画の範囲を3D都市モデルのローカル座標で返します。
+     * @return メッシュコードとして不正な場合はfalse
+     */
+    bool TryGetGridCodeExtent(plateau::geometry::GeoReference& GeoReference, const FString& GridCode, FBox2D& OutExtent) {
+        if (GridCode.IsEmpty() || !GridCode.IsNumeric())
+            return false;
+
+        try {
+            const auto NativeGridCode = plateau::dataset::GridCode::create(TCHAR_TO_UTF8(*GridCode));
+            if (!NativeGridCode->isValid())
+                return false;
+
+            const auto Extent = NativeGridCode->getExtent();
+            const auto Min = GeoReference.project(Extent.min);
+            const auto Max = GeoReference.project(Extent.max);
+            // ESUでは緯度の大小とYの大小が逆になるため、両端を含む範囲として求める
+            OutExtent = FBox2D(ForceInit);
+            OutExtent += FVector2D(Min.x, Min.y);
+            OutExtent += FVector2D(Max.x, Max.y);
+            return OutExtent.bIsValid;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    void GetPrimitiveComponents(USceneComponent* Feature, TArray<UPrimitiveComponent*>& OutComponents) {
+        TArray<USceneComponent*> Components;
+        Feature->GetChildrenComponents(true, Components);
+        Components.Add(Feature);
+        for (const auto& Component : Components) {
+            if (const auto PrimitiveComponent = Cast<UPrimitiveComponent>(Component))
+                OutComponents.Add(PrimitiveComponent);
+        }
+    }
+
+    FBox GetFeatureBounds(USceneComponent* Feature, const FTransform& WorldToActor) {
+        TArray<UPrimitiveComponent*> Components;
+        GetPrimitiveComponents(Feature, Components);
+        FBox Bounds(ForceInit);
+        for (const auto& Component : Components) {
+            Bounds += Component->Bounds.GetBox();
+        }
+        return Bounds.IsValid ? Bounds.TransformBy(WorldToActor) : Bounds;
+    }
+
+    int64 GetTriangleCount(const UStaticMesh* StaticMesh) {
+        if (StaticMesh == nullptr || StaticMesh->GetRenderData() == nullptr || StaticMesh->GetRenderData()->LODResources.Num() == 0)
+            return 0;
+        return StaticMesh->GetRenderData()->LODResources[0].GetNumTriangles();
+    }
+
+    void MergeMeshesRecursive(const plateau::polygonMesh::Node& Node, plateau::polygonMesh::Mesh& OutMesh, const bool bIncludeTextures) {
+        if (const auto Mesh = Node.getMesh(); Mesh != nullptr && !Mesh->getVertices().empty())
+            plateau::polygonMesh::MeshMerger::mergeMesh(OutMesh, *Mesh, false, bIncludeTextures);
+
+        for (size_t i = 0; i < Node.getChildCount(); ++i) {
+            MergeMeshesRecursive(Node.getChildAt(i), OutMesh, bIncludeTextures);
+        }
+    }
+
+    struct FGmlFeatures {
+        FString GridCode;
+        TArray<USceneComponent*> Features;
+        TArray<FBox> Bounds;
+    };
+}
+
+FPLATEAUSpatialCellBuilder::FPLATEAUSpatialCellBuilder(APLATEAUInstancedCityModel* Actor, const FPLATEAUSpatialCellSettings& InSettings)
+    : CityModelActor(Actor)
+    , Settings(InSettings) {}
+
+TArray<FPLATEAUSpatialCell> FPLATEAUSpatialCellBuilder::Partition() const {
+    check(IsInGameThread());
+    check(CityModelActor != nullptr);
+
+    const int32 Subdivision = FMath::Max(Settings.Subdivision, 1);
+    const FTransform WorldToActor = CityModelActor->GetActorTransform().Inverse();
+
+    // GMLファイル毎の地物コンポーネントとその範囲
+    TArray<FGmlFeatures> GmlFeaturesArray;
+    for (const auto& GmlComponent : CityModelActor->GetRootComponent()->GetAttachChildren()) {
+        auto& GmlFeatures = GmlFeaturesArray.AddDefaulted_GetRef();
+        // GMLファイル名は{メッシュコード}_{パッケージ}_...
+        const auto GmlName = FPaths::GetBaseFilename(FPLATEAUGmlUtil::GetGmlFileName(GmlComponent));
+        if (!GmlName.Split(TEXT("_"), &GmlFeatures.GridCode, nullptr))
+            GmlFeatures.GridCode = GmlName;
+
+        for (const auto& LodComponent : GmlComponent->GetAttachChildren()) {
+            for (const auto& Feature : LodComponent->GetAttachChildren()) {
+                // インスタンス化したコンポーネントはGML全体に渡るため、セルに割り当てない
+                if (Feature->IsA<UPLATEAUInstancedCityObjectGroup>())
+                    continue;
+
+                const auto Bounds = GetFeatureBounds(Feature, WorldToActor);
+                if (!Bounds.IsValid)
+                    continue;
+
+                GmlFeatures.Features.Add(Feature);
+                GmlFeatures.Bounds.Add(Bounds);
+            }
+        }
+    }
+
+    TArray<FPLATEAUSpatialCell> Cells;
+    // メッシュコードからセルの範囲・先頭のセルの番号への対応(同じメッシュコードの別パッケージのGMLは同じセルに割り当てる)
+    TMap<FString, TPair<FBox2D, int32>> GridCodeToCells;
+    auto& GeoReference = CityModelActor->GeoReference.GetData();
+    for (auto& GmlFeatures : GmlFeaturesArray) {
+        if (GmlFeatures.Features.Num() == 0)
+            continue;
+
+        auto* GridCells = GridCodeToCells.Find(GmlFeatures.GridCode);
+        if (GridCells == nullptr) {
+            FBox2D Extent;
+            if (!TryGetGridCodeExtent(GeoReference, GmlFeatures.GridCode, Extent)) {
+                // メッシュコードが得られない場合はGML内の地物の範囲をセルとする
+                Extent = FBox2D(ForceInit);
+                for (const auto& Bounds : GmlFeatures.Bounds) {
+                    Extent += FVector2D(Bounds.Min);
+                    Extent += FVector2D(Bounds.Max);
+                }
+            }
+
+            GridCells = &GridCodeToCells.Add(GmlFeatures.GridCode, TPair<FBox2D, int32>(Extent, Cells.Num()));
+            const auto CellSize = Extent.GetSize() / Subdivision;
+            for (int32 Y = 0; Y < Subdivision; ++Y) {
+                for (int32 X = 0; X < Subdivision; ++X) {
+                    auto& Cell = Cells.AddDefaulted_GetRef();
+                    Cell.GridCode = GmlFeatures.GridCode;
+                    Cell.CellCode = Subdivision == 1 ? GmlFeatures.GridCode : FString::Printf(TEXT("%s_%d_%d"), *GmlFeatures.GridCode, X, Y);
+                    const FVector2D CellMin = Extent.Min + CellSize * FVector2D(X, Y);
+                    Cell.Bounds = FBox(FVector(CellMin, 0.0), FVector(CellMin + CellSize, 0.0));
+                }
+            }
+        }
+
+        const auto& [Extent, FirstCell] = *GridCells;
+        const auto CellSize = Extent.GetSize() / Subdivision;
+        for (int32 i = 0; i < GmlFeatures.Features.Num(); ++i) {
+            const auto& Bounds = GmlFeatures.Bounds[i];
+            const FVector2D Center(Bounds.GetCenter());
+            // 区画からはみ出した地物は最も近いセルに割り当てる
+            const int32 X = FMath::Clamp(CellSize.X > 0.0 ? FMath::FloorToInt32((Center.X - Extent.Min.X) / CellSize.X) : 0, 0, Subdivision - 1);
+            const int32 Y = FMath::Clamp(CellSize.Y > 0.0 ? FMath::FloorToInt32((Center.Y - Extent.Min.Y) / CellSize.Y) : 0, 0, Subdivision - 1);
+            auto& Cell = Cells[FirstCell + Y * Subdivision + X];
+            if (Cell.Features.Num() == 0) {
+                Cell.Bounds.Min.Z = Bounds.Min.Z;
+                Cell.Bounds.Max.Z = Bounds.Max.Z;
+            }
+            Cell.Bounds += Bounds;
+            Cell.Features.Add(GmlFeatures.Features[i]);
+        }
+    }
+
+    Cells.RemoveAll([](const FPLATEAUSpatialCell& Cell) {
+        return Cell.Features.Num() == 0;
+        });
+    return Cells;
+}
+
+TArray<UPLATEAUCityObjectGroup*> FPLATEAUSpatialCellBuilder::CollectProxySources(const FPLATEAUSpatialCell& Cell) const {
+    check(IsInGameThread());
+
+    // 地物毎に、LOD1以上で最小のLodのコンポーネントを選ぶ(LOD0は平面のため、他のLodが無い場合のみ使用する)
+    TMap<FString, TPair<int32, USceneComponent*>> FeatureToLowestLod;
+    for (const auto& Feature : Cell.Features) {
+        if (!IsValid(Feature) || Feature->GetAttachParent() == nullptr)
+            continue;
+
+        const int32 Lod = FPLATEAUComponentUtil::ParseLodComponent(Feature->GetAttachParent());
+        const int32 Priority = Lod == 0 ? MAX_int32 : Lod;
+        const auto FeatureName = FPLATEAUComponentUtil::GetOriginalComponentName(Feature->GetAttachParent()->GetAttachParent()) / FPLATEAUComponentUtil::GetOriginalComponentName(Feature);
+        const auto Found = FeatureToLowestLod.Find(FeatureName);
+        if (Found == nullptr || Priority < Found->Key)
+            FeatureToLowestLod.Add(FeatureName, TPair<int32, USceneComponent*>(Priority, Feature));
+    }
+
+    TArray<UPLATEAUCityObjectGroup*> Sources;
+    for (const auto& [FeatureName, LowestLod] : FeatureToLowestLod) {
+        TArray<UPrimitiveComponent*> Components;
+        GetPrimitiveComponents(LowestLod.Value, Components);
+        for (const auto& Component : Components) {
+            const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Component);
+            if (CityObjectGroup != nullptr && CityObjectGroup->GetStaticMesh() != nullptr)
+                Sources.Add(CityObjectGroup);
+        }
+    }
+    return Sources;
+}
+
+bool FPLATEAUSpatialCellBuilder::GenerateProxy(FPLATEAUSpatialCell& Cell, const TArray<UPLATEAUCityObjectGroup*>& Sources) const {
+    if (Sources.Num() == 0)
+        return false;
+
+    // Lod切り替えで非表示の地物もプロキシに含める
+    FPLATEAUMeshExportOptions ExtOptions;
+    ExtOptions.bExportHiddenObjects = true;
+    ExtOptions.bExportTexture = Settings.bProxyTextures;
+    ExtOptions.TransformType = EMeshTransformType::Local;
+    ExtOptions.CoordinateSystem = ECoordinateSystem::ESU;
+
+    // コンポーネントの読み出しはゲームスレッドで行い、Modelの作成のみこのスレッドで行う
+    FPLATEAUMeshExporter MeshExporter;
+    TArray<FPLATEAUExportNodeSnapshot> SourceNodes;
+    FFunctionGraphTask::CreateAndDispatchWhenReady([&] {
+        const auto ValidSources = Sources.FilterByPredicate([](const UPLATEAUCityObjectGroup* Source) {
+            return IsValid(Source);
+            });
+        SourceNodes = MeshExporter.CreateSnapshotFromComponents(CityModelActor, ValidSources, ExtOptions);
+        }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+    const auto SourceModel = MeshExporter.CreateModelFromSnapshot(SourceNodes, ExtOptions);
+    SourceNodes.Empty();
+    const FPLATEAUCachedMaterialArray CachedMaterials = MeshExporter.GetCachedMaterials();
+
+    // GML・Lod毎に地域単位に結合した後、セル内で1つのメッシュにまとめる
+    GranularityConverter Converter;
+    const auto AreaModel = Converter.convert(*SourceModel, GranularityConvertOption(ConvertGranularity::PerCityModelArea, 0));
+    auto ProxyMesh = std::make_unique<plateau::polygonMesh::Mesh>();
+    for (size_t i = 0; i < AreaModel.getRootNodeCount(); ++i) {
+        MergeMeshesRecursive(AreaModel.getRootNodeAt(i), *ProxyMesh, Settings.bProxyTextures);
+    }
+    if (ProxyMesh->getVertices().empty())
+        return false;
+
+    const auto ProxyName = FString::Printf(TEXT("HLOD_%s"), *Cell.CellCode);
+    plateau::polygonMesh::Model ProxyModel;
+    ProxyModel.addNode(plateau::polygonMesh::Node(TCHAR_TO_UTF8(*ProxyName), std::move(ProxyMesh)));
+    ProxyModel.assignNodeHierarchy();
+
+    // プロキシ用のアクターの作成とコンポーネントの読み込みはゲームスレッドで行う
+    FFunctionGraphTask::CreateAndDispatchWhenReady([&] {
+        const FTransform ActorTransform = CityModelActor->GetActorTransform();
+        const auto Proxy = CityModelActor->GetWorld()->SpawnActor<APLATEAUCityModelCellProxy>(APLATEAUCityModelCellProxy::StaticClass(), &ActorTransform);
+        Proxy->CellCode = Cell.CellCode;
+        Proxy->GetRootComponent()->SetMobility(CityModelActor->GetRootComponent()->Mobility);
+        Proxy->AttachToActor(CityModelActor, FAttachmentTransformRules::KeepWorldTransform);
+#if WITH_EDITOR
+        Proxy->SetActorLabel(ProxyName);
+#endif
+
+        FPLATEAUMeshLoaderForReconstruct MeshLoader(false, CachedMaterials);
+        MeshLoader.ReloadComponentFromNode(Proxy->GetRootComponent(), ProxyModel.getRootNodeAt(0), ConvertGranularity::PerCityModelArea, {}, *Proxy);
+        Cell.Proxy = Proxy;
+        }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
+    return true;
+}
+
+FPLATEAUSpatialCellStats FPLATEAUSpatialCellBuilder::Finalize(TArray<FPLATEAUSpatialCell>& Cells) const {
+    check(IsInGameThread());
+
+    FPLATEAUSpatialCellStats Stats;
+    Stats.Cells = Cells.Num();
+    for (auto& Cell : Cells) {
+        Cell.SourceComponents = 0;
+        Cell.SourceTriangles = Cell.ProxyTriangles = 0;
+        Cell.SourceBytes = Cell.ProxyBytes = 0;
+
+        TSet<UStaticMesh*> SourceMeshes;
+        for (const auto& Feature : Cell.Features) {
+            if (!IsValid(Feature))
+                continue;
+
+            TArray<UPrimitiveComponent*> Components;
+            GetPrimitiveComponents(Feature, Components);
+            for (const auto& Component : Components) {
+                const auto StaticMeshComponent = Cast<UStaticMeshComponent>(Component);
+                if (StaticMeshComponent == nullptr || StaticMeshComponent->GetStaticMesh() == nullptr)
+                    continue;
+
+                ++Cell.SourceComponents;
+                SourceMeshes.Add(StaticMeshComponent->GetStaticMesh());
+                if (StaticMeshComponent->IsVisible())
+                    Cell.SourceTriangles += GetTriangleCount(StaticMeshComponent->GetStaticMesh());
+                if (Cell.Proxy != nullptr && Settings.ProxyDrawDistance > 0.0f)
+                    StaticMeshComponent->SetCullDistance(Settings.ProxyDrawDistance);
+            }
+        }
+        for (const auto& StaticMesh : SourceMeshes) {
+            Cell.SourceBytes += StaticMesh->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+        }
+
+        if (IsValid(Cell.Proxy)) {
+            TInlineComponentArray<UStaticMeshComponent*> ProxyComponents(Cell.Proxy.Get());
+            for (const auto& ProxyComponent : ProxyComponents) {
+                if (ProxyComponent->GetStaticMesh() == nullptr)
+                    continue;
+
+                ++Stats.ProxyComponents;
+                Cell.ProxyTriangles += GetTriangleCount(ProxyComponent->GetStaticMesh());
+                Cell.ProxyBytes += ProxyComponent->GetStaticMesh()->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+                if (Settings.ProxyDrawDistance > 0.0f) {
+                    ProxyComponent->MinDrawDistance = Settings.ProxyDrawDistance;
+                    ProxyComponent->MarkRenderStateDirty();
+                }
+            }
+            ++Stats.ProxyCells;
+        }
+
+        Stats.SourceComponents += Cell.SourceComponents;
+        Stats.SourceTriangles += Cell.SourceTriangles;
+        Stats.ProxyTriangles += Cell.ProxyTriangles;
+        Stats.MaxCellTriangles = FMath::Max(Stats.MaxCellTriangles, Cell.SourceTriangles);
+        Stats.SourceBytes += Cell.SourceBytes;
+        Stats.ProxyBytes += Cell.ProxyBytes;
+    }
+    return Stats;
+}
+
+void FPLATEAUSpatialCellBuilder::ResetDrawDistances(const FPLATEAUSpatialCell& Cell) {
+    if (Cell.Proxy == nullptr)
+        return;
+
+    for (const auto& Feature : Cell.Features) {
+        if (!IsValid(Feature))
+            continue;
+
+        TArray<UPrimitiveComponent*> Components;
+        GetPrimitiveComponents(Feature, Components);
+        for (const auto& Component : Components) {
+            Component->SetCullDistance(0.0f);
+        }
+    }
+}
@@ -0,0 +1,315 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTextureCache.h"
+#include "PLATEAUImportProfiler.h"
+#include "Async/Async.h"
+#include "HAL/Event.h"
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+
+FPLATEAUTextureCache::FPLATEAUTextureCache(const int64 InCapacityBytes, const int32 InMaxWorkerCount,
+    const FPLATEAUTextureDecodeOptions& InDecodeOptions)
+    : CapacityBytes(InCapacityBytes)
+    , MaxWorkerCount(InMaxWorkerCount > 0
+        ? InMaxWorkerCount
+        : FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 2, 1, 8))
+    , DecodeOptions(InDecodeOptions) {
+}
+
+TArray<FString> FPLATEAUTextureCache::CollectTexturePaths(const plateau::polygonMesh::Model& Model) {
+    TSet<FString> TexturePaths;
+    for (const auto Mesh : Model.getAllMeshes()) {
+        if (Mesh == nullptr)
+            continue;
+
+        for (const auto& SubMesh : Mesh->getSubMeshes()) {
+            const auto& TexturePath = SubMesh.getTexturePath();
+            if (TexturePath.empty())
+                continue;
+
+            TexturePaths.Add(FPLATEAUTextureLoader::NormalizeTexturePath(UTF8_TO_TCHAR(TexturePath.c_str())));
+        }
+    }
+    return TexturePaths.Array();
+}
+
+void FPLATEAUTextureCache::Prefetch(const TArray<FString>& TexturePaths) {
+    FScopeLock Lock(&EntriesSection);
+    for (const auto& TexturePath : TexturePaths) {
+        const auto NormalizedPath = FPLATEAUTextureLoader::NormalizeTexturePath(TexturePath);
+        if (NormalizedPath.IsEmpty())
+            continue;
+
+        // LRUから破棄されたがテクスチャ未作成のものは再度先読みする
+        const auto Entry = Entries.Find(NormalizedPath);
+        if (Entry != nullptr && !Entry->bEvicted) {
+            if (Entry->LruNode != nullptr)
+                Touch(*Entry);
+            continue;
+        }
+
+        MarkPending(Entry != nullptr ? *Entry : Entries.Add(NormalizedPath));
+        Queue.Add(NormalizedPath);
+    }
+    StartWorkersIfNeeded();
+}
+
+void FPLATEAUTextureCache::Wait(const TArray<FString>& TexturePaths) {
+    check(!IsInGameThread());
+
+    TArray<TSharedPtr<FEvent, ESPMode::ThreadSafe>> Events;
+    {
+        FScopeLock Lock(&EntriesSection);
+        for (const auto& TexturePath : TexturePaths) {
+            if (auto Event = Request(FPLATEAUTextureLoader::NormalizeTexturePath(TexturePath)))
+                Events.Add(MoveTemp(Event));
+        }
+        StartWorkersIfNeeded();
+    }
+
+    for (const auto& Event : Events)
+        Event->Wait();
+}
+
+UTexture2D* FPLATEAUTextureCache::FindOrCreateTexture(const FString& TexturePath, const bool bOverwriteTexture, bool& bOutCreated) {
+    check(IsInGameThread());
+    bOutCreated = false;
+
+    const auto NormalizedPath = FPLATEAUTextureLoader::NormalizeTexturePath(TexturePath);
+    if (NormalizedPath.IsEmpty())
+        return nullptr;
+
+    ++LookupCount;
+
+    // 他のGMLで作成済みのテクスチャは使い回す
+    if (const auto CreatedTexture = CreatedTextures.Find(NormalizedPath)) {
+        ++HitCount;
+        return *CreatedTexture;
+    }
+
+    bool bFound = false;
+    TSharedPtr<FEvent, ESPMode::ThreadSafe> DecodedEvent;
+    {
+        FScopeLock Lock(&EntriesSection);
+        const auto Entry = Entries.Find(NormalizedPath);
+        bFound = Entry != nullptr && !Entry->bEvicted;
+        // LRUから破棄済みの場合はワーカーで再度デコードする
+        DecodedEvent = Request(NormalizedPath);
+        StartWorkersIfNeeded();
+    }
+
+    // デコード中の場合は完了を待つ
+    if (DecodedEvent.IsValid())
+        DecodedEvent->Wait();
+
+    TSharedPtr<const FPLATEAUDecodedTexture, ESPMode::ThreadSafe> DecodedTexture;
+    {
+        FScopeLock Lock(&EntriesSection);
+        if (const auto Entry = Entries.Find(NormalizedPath)) {
+            DecodedTexture = Entry->DecodedTexture;
+            // 待機後に他のデコードで破棄された
+            if (Entry->bEvicted)
+                bFound = false;
+        }
+    }
+    if (bFound) {
+        ++HitCount;
+    }
+    else {
+        ++MissCount;
+        // 先読みされていない場合はその場でデコード
+        if (!DecodedTexture.IsValid())
+            DecodedTexture = DecodeAndRecord(NormalizedPath);
+    }
+
+    UTexture2D* Texture = DecodedTexture.IsValid()
+        ? FPLATEAUTextureLoader::CreateTexture(NormalizedPath, *DecodedTexture, bOverwriteTexture)
+        : nullptr;
+    CreatedTextures.Add(NormalizedPath, Texture);
+    bOutCreated = Texture != nullptr;
+
+    // テクスチャ作成後はデコード済みの画像は不要なためLRUから外し、止めていた先読みを再開する。エントリは再度デコードされないように残す。
+    {
+        FScopeLock Lock(&EntriesSection);
+        auto& Entry = Entries.FindOrAdd(NormalizedPath);
+        Entry.bPending = false;
+        Entry.bEvicted = false;
+        Entry.bCreated = true;
+        if (Entry.LruNode != nullptr)
+            RemoveFromLru(Entry);
+        StartWorkersIfNeeded();
+    }
+
+    return Texture;
+}
+
+FString FPLATEAUTextureCache::GetStatsString() const {
+    const int64 Lookups = LookupCount.Load();
+    FScopeLock Lock(&EntriesSection);
+    return FString::Printf(
+        TEXT("Decoded: %lld, Decode time: %.3f s, Bytes read: %.2f MB, Cache hit: %.1f%% (%lld/%lld), Miss: %lld, Evicted: %lld (%.2f MB), ")
+        TEXT("LRU peak: %.2f MB / %.2f MB, Throttled: %lld, Estimated VRAM: %.2f MB -> %.2f MB"),
+        DecodedCount.Load(), DecodeMicroseconds.Load() / 1000000.0, BytesRead.Load() / (1024.0 * 1024.0),
+        Lookups > 0 ? 100.0 * HitCount.Load() / Lookups : 0.0, HitCount.Load(), Lookups, MissCount.Load(),
+        EvictedCount, EvictedBytes / (1024.0 * 1024.0), PeakCachedBytes / (1024.0 * 1024.0), CapacityBytes / (1024.0 * 1024.0),
+        ThrottledCount.Load(), UncompressedGPUBytes.Load() / (1024.0 * 1024.0), GPUBytes.Load() / (1024.0 * 1024.0));
+}
+
+int64 FPLATEAUTextureCache::GetEvictedCount() const {
+    FScopeLock Lock(&EntriesSection);
+    return EvictedCount;
+}
+
+void FPLATEAUTextureCache::SetProfiler(const TSharedPtr<FPLATEAUImportProfiler, ESPMode::ThreadSafe>& InProfiler) {
+    Profiler = InProfiler;
+}
+
+void FPLATEAUTextureCache::StartWorkersIfNeeded() {
+    // EntriesSectionのロック中に呼び出される
+    const int32 RunnableCount = RequestedQueue.Num() + (CachedBytes < CapacityBytes ? Queue.Num() : 0);
+    while (ActiveWorkerCount < MaxWorkerCount && ActiveWorkerCount < RunnableCount) {
+        ++ActiveWorkerCount;
+        Async(EAsyncExecution::ThreadPool, [Self = AsShared()] {
+            Self->DrainQueue();
+        });
+    }
+}
+
+bool FPLATEAUTextureCache::DequeueNext(FString& OutTexturePath) {
+    // EntriesSectionのロック中に呼び出される
+    // 先に依頼されたものから処理
+    if (RequestedQueue.Num() > 0) {
+        OutTexturePath = MoveTemp(RequestedQueue[0]);
+        RequestedQueue.RemoveAt(0);
+        return true;
+    }
+    if (Queue.Num() == 0)
+        return false;
+    if (CachedBytes >= CapacityBytes) {
+        // テクスチャの作成で解放されるまで先読みを止める
+        ++ThrottledCount;
+        return false;
+    }
+    OutTexturePath = MoveTemp(Queue[0]);
+    Queue.RemoveAt(0);
+    return true;
+}
+
+TSharedPtr<FEvent, ESPMode::ThreadSafe> FPLATEAUTextureCache::Request(const FString& NormalizedPath) {
+    // EntriesSectionのロック中に呼び出される
+    const auto Entry = Entries.Find(NormalizedPath);
+    if (Entry == nullptr)
+        return nullptr;
+
+    // 使用予定のデコード済み画像は破棄されにくくする
+    if (Entry->LruNode != nullptr)
+        Touch(*Entry);
+    if (Entry->bEvicted) {
+        MarkPending(*Entry);
+        RequestedQueue.Add(NormalizedPath);
+        return Entry->DecodedEvent;
+    }
+    if (!Entry->bPending)
+        return nullptr;
+
+    // 先読みのデコード待ちであれば優先して処理する
+    if (Queue.RemoveSingle(NormalizedPath) > 0)
+        RequestedQueue.Add(NormalizedPath);
+    return Entry->DecodedEvent;
+}
+
+void FPLATEAUTextureCache::DrainQueue() {
+    while (true) {
+        FString TexturePath;
+        {
+            FScopeLock Lock(&EntriesSection);
+            if (!DequeueNext(TexturePath)) {
+                --ActiveWorkerCount;
+                return;
+            }
+        }
+
+        const auto DecodedTexture = DecodeAndRecord(TexturePath);
+
+        FScopeLock Lock(&EntriesSection);
+        if (const auto Entry = Entries.Find(TexturePath)) {
+            Entry->DecodedTexture = DecodedTexture;
+            Entry->bPending = false;
+            if (DecodedTexture.IsValid()) {
+                AddToLru(TexturePath, *Entry);
+                Evict(TexturePath);
+            }
+            Entry->DecodedEvent->Trigger();
+        }
+    }
+}
+
+void FPLATEAUTextureCache::AddToLru(const FString& NormalizedPath, FEntry& Entry) {
+    Lru.AddHead(NormalizedPath);
+    Entry.LruNode = Lru.GetHead();
+    CachedBytes += Entry.DecodedTexture->GetMemorySize();
+    PeakCachedBytes = FMath::Max(PeakCachedBytes, CachedBytes);
+}
+
+void FPLATEAUTextureCache::RemoveFromLru(FEntry& Entry) {
+    CachedBytes -= Entry.DecodedTexture->GetMemorySize();
+    Lru.RemoveNode(Entry.LruNode);
+    Entry.LruNode = nullptr;
+    Entry.DecodedTexture.Reset();
+}
+
+void FPLATEAUTextureCache::Touch(FEntry& Entry) {
+    Lru.RemoveNode(Entry.LruNode, false);
+    Lru.AddHead(Entry.LruNode);
+}
+
+void FPLATEAUTextureCache::Evict(const FString& KeepPath) {
+    while (CachedBytes > CapacityBytes && Lru.GetTail() != nullptr) {
+        const FString TexturePath = Lru.GetTail()->GetValue();
+        if (TexturePath == KeepPath)
+            break;
+
+        auto& Entry = Entries[TexturePath];
+        ++EvictedCount;
+        EvictedBytes += Entry.DecodedTexture->GetMemorySize();
+        RemoveFromLru(Entry);
+        Entry.bEvicted = true;
+    }
+}
+
+void FPLATEAUTextureCache::MarkPending(FEntry& Entry) {
+    Entry.bPending = true;
+    Entry.bEvicted = false;
+    if (Entry.DecodedEvent.IsValid()) {
+        Entry.DecodedEvent->Reset();
+        return;
+    }
+    Entry.DecodedEvent = TSharedPtr<FEvent, ESPMode::ThreadSafe>(FPlatformProcess::GetSynchEventFromPool(true), [](FEvent* Event) {
+        FPlatformProcess::ReturnSynchEventToPool(Event);
+    });
+}
+
+TSharedPtr<const FPLATEAUDecodedTexture, ESPMode::ThreadSafe> FPLATEAUTextureCache::DecodeAndRecord(const FString& TexturePath) {
+    const double StartSeconds = FPlatformTime::Seconds();
+    const auto DecodedTexture = MakeShared<FPLATEAUDecodedTexture, ESPMode::ThreadSafe>();
+    const bool bSucceeded = FPLATEAUTextureLoader::Decode(TexturePath, *DecodedTexture, DecodeOptions);
+    const double EndSeconds = FPlatformTime::Seconds();
+    DecodeMicroseconds += static_cast<int64>((EndSeconds - StartSeconds) * 1000000.0);
+    BytesRead += DecodedTexture->FileSize;
+
+    // テクスチャはGML間で共有されるため、GMLに割り当てずに記録
+    if (Profiler.IsValid()) {
+        Profiler->AddEvent(EPLATEAUImportStage::DecodeTexture, FString(), StartSeconds, EndSeconds);
+        Profiler->AddCounter(FString(), EPLATEAUImportCounter::Bytes, DecodedTexture->FileSize);
+        if (bSucceeded)
+            Profiler->AddCounter(FString(), EPLATEAUImportCounter::Textures, 1);
+    }
+
+    if (!bSucceeded)
+        return nullptr;
+
+    ++DecodedCount;
+    UncompressedGPUBytes += DecodedTexture->UncompressedSize;
+    GPUBytes += DecodedTexture->GetGPUSize();
+    return DecodedTexture;
+}
@@ -1,6 +1,7 @@
 // Copyright © 2023 Ministry of Land, Infrastructure and Transport
 
 #include "PLATEAUTextureLoader.h"
+#include "Util/PLATEAUTextureUtil.h"
 
 #include "IImageWrapper.h"
 #include "IImageWrapperModule.h"
@@ -25,7 +26,7 @@ DECLARE_CYCLE_STAT(TEXT("Texture.UpdateResource"), STAT_Texture_UpdateResource,
 
 namespace {
     bool TryLoadAndUncompressImageFile(const FString& TexturePath,
-        TArray64<uint8>& OutUncompressedData, int32& OutWidth, int32& OutHeight, EPixelFormat& OutPixelFormat) {
+        TArray64<uint8>& OutUncompressedData, int32& OutWidth, int32& OutHeight, EPixelFormat& OutPixelFormat, int64* OutFileSize = nullptr) {
         if (TexturePath.IsEmpty()) {
             UE_LOG(LogTemp, Error, TEXT("Failed to load texture : path is empty."));
             return false;
@@ -38,6 +39,8 @@ namespace {
             UE_LOG(LogTemp, Error, TEXT("Failed to load texture file : %s"), *TexturePath);
             return false;
         }
+        if (OutFileSize != nullptr)
+            *OutFileSize = Buffer.Num();
 
         const EImageFormat Format = ImageWrapperModule.DetectImageFormat(Buffer.GetData(), Buffer.Num());
 
@@ -107,62 +110,70 @@ namespace {
         }
 
         // GPU上でテクスチャ構築
+        SCOPE_CYCLE_COUNTER(STAT_Texture_UpdateResource);
         Texture->UpdateResource();
     }
 
-    void SetTexturePlatformData(UTexture2D* Texture, const TArray64<uint8>& UncompressedImageData,
-        const int32 Mip0Size, const int32 Width, const int32 Height, const EPixelFormat PixelFormat) {
+    void SetTexturePlatformData(UTexture2D* Texture, const FPLATEAUDecodedTexture& DecodedTexture) {
+        const int32 Width = DecodedTexture.Width;
+        const int32 Height = DecodedTexture.Height;
         Texture->SetPlatformData(new FTexturePlatformData());
         Texture->GetPlatformData()->SizeX = Width;
         Texture->GetPlatformData()->SizeY = Height;
-        Texture->GetPlatformData()->PixelFormat = PixelFormat;
-        FTexture2DMipMap* Mip = new FTexture2DMipMap();
-        Texture->GetPlatformData()->Mips.Add(Mip);
-        Mip->SizeX = Width;
-        Mip->SizeY = Height;
-        {
-            Mip->BulkData.Lock(LOCK_READ_WRITE);
-
-            void* TextureData = Mip->BulkData.Realloc(Mip0Size);
-            FMemory::Memcpy(TextureData, UncompressedImageData.GetData(), Mip0Size);
-
-            Mip->BulkData.Unlock();
+        Texture->GetPlatformData()->PixelFormat = DecodedTexture.PixelFormat;
+        for (int32 MipIndex = 0; MipIndex < DecodedTexture.GetNumMips(); ++MipIndex) {
+            const auto& MipData = MipIndex == 0 ? DecodedTexture.Data : DecodedTexture.MipChain[MipIndex - 1];
+            FTexture2DMipMap* Mip = new FTexture2DMipMap();
+            Texture->GetPlatformData()->Mips.Add(Mip);
+            Mip->SizeX = FMath::Max(1, Width >> MipIndex);
+            Mip->SizeY = FMath::Max(1, Height >> MipIndex);
+            {
+                Mip->BulkData.Lock(LOCK_READ_WRITE);
+
+                void* TextureData = Mip->BulkData.Realloc(MipData.Num());
+                FMemory::Memcpy(TextureData, MipData.GetData(), MipData.Num());
+
+                Mip->BulkData.Unlock();
+            }
         }
     }
 
-    void UpdateTextureGPUResourceAsync(
-        const TArray64<uint8>& UncompressedImageData, UTexture2D* const Texture,
-        const int32 Mip0Size, const int32 Width, const int32 Height, const EPixelFormat PixelFormat, ERHIAccess InResourceState) {
+    void UpdateTextureGPUResourceAsync(const FPLATEAUDecodedTexture& DecodedTexture, UTexture2D* const Texture, ERHIAccess InResourceState) {
+        const int32 NumMips = DecodedTexture.GetNumMips();
 
         TArray<void*, TInlineAllocator<MAX_TEXTURE_MIP_COUNT>> MipData;
-        MipData.Add(FMemory::Malloc(Mip0Size));
-        // TODO: 動的メモリ確保不要?
-        FMemory::Memcpy(MipData[0], UncompressedImageData.GetData(), Mip0Size);
+        for (int32 MipIndex = 0; MipIndex < NumMips; ++MipIndex) {
+            const auto& SrcMipData = MipIndex == 0 ? DecodedTexture.Data : DecodedTexture.MipChain[MipIndex - 1];
+            // TODO: 動的メモリ確保不要?
+            MipData.Add(FMemory::Malloc(SrcMipData.Num()));
+            FMemory::Memcpy(MipData.Last(), SrcMipData.GetData(), SrcMipData.Num());
+        }
 
         if (!GRHISupportsAsyncTextureCreation) {
+            SCOPE_CYCLE_COUNTER(STAT_Texture_UpdateResource);
             Texture->UpdateResource();
         }
 
 #if UE_VERSION_NEWER_THAN(5, 5, 0)
         FGraphEventRef CompletionEvent;
         FTextureRHIRef RHITexture2D = RHIAsyncCreateTexture2D(
-            Width, Height,
-            PixelFormat,
-            1,
+            DecodedTexture.Width, DecodedTexture.Height,
+            DecodedTexture.PixelFormat,
+            NumMips,
             TexCreate_ShaderResource,
             InResourceState,
-            MipData.GetData(), 1,
+            MipData.GetData(), NumMips,
             TEXT("RHIAsyncCreateTexture2D"),
             CompletionEvent
         );
 #else
         FGraphEventRef CompletionEvent;
         FTextureRHIRef RHITexture2D = RHIAsyncCreateTexture2D(
-            Width, Height,
-            PixelFormat,
-            1,
+            DecodedTexture.Width, DecodedTexture.Height,
+            DecodedTexture.PixelFormat,
+            NumMips,
             TexCreate_ShaderResource,
-            MipData.GetData(), 1,
+            MipData.GetData(), NumMips,
             CompletionEvent
         );
 #endif
@@ -183,6 +194,50 @@ namespace {
         );
     }
 
+    /**
+     * @brief 8bitの画像に対してミップ生成、ブロック圧縮を行います。
+     */
+    void ProcessDecodedTexture(FPLATEAUDecodedTexture& DecodedTexture, const FPLATEAUTextureDecodeOptions& Options) {
+        if (DecodedTexture.PixelFormat != PF_B8G8R8A8)
+            return;
+
+        auto Compression = Options.Compression;
+        // BCはブロック単位のため、Mip0の幅と高さが4の倍数でない場合は非圧縮とする
+        if (DecodedTexture.Width % 4 != 0 || DecodedTexture.Height % 4 != 0)
+            Compression = EPLATEAUTextureCompression::Uncompressed;
+        if (Compression == EPLATEAUTextureCompression::Auto) {
+            Compression = FPLATEAUTextureUtil::HasTransparentPixel(DecodedTexture.Data)
+                ? EPLATEAUTextureCompression::BC3
+                : EPLATEAUTextureCompression::BC1;
+        }
+
+        if (Options.bGenerateMips) {
+            FPLATEAUTextureUtil::BuildMipChain(DecodedTexture.Data, DecodedTexture.Width, DecodedTexture.Height, DecodedTexture.MipChain);
+        }
+
+        if (Compression == EPLATEAUTextureCompression::Uncompressed)
+            return;
+
+        // エディタ上のSourceは非圧縮のものを保持
+        DecodedTexture.SourceData = DecodedTexture.Data;
+        for (const auto& Mip : DecodedTexture.MipChain) {
+            DecodedTexture.SourceData.Append(Mip);
+        }
+
+        const bool bWithAlpha = Compression == EPLATEAUTextureCompression::BC3;
+        TArray64<uint8> Blocks;
+        FPLATEAUTextureUtil::CompressBC(DecodedTexture.Data.GetData(), DecodedTexture.Width, DecodedTexture.Height, bWithAlpha, Blocks);
+        DecodedTexture.Data = MoveTemp(Blocks);
+        for (int32 MipIndex = 0; MipIndex < DecodedTexture.MipChain.Num(); ++MipIndex) {
+            auto& Mip = DecodedTexture.MipChain[MipIndex];
+            FPLATEAUTextureUtil::CompressBC(Mip.GetData(),
+                FMath::Max(1, DecodedTexture.Width >> (MipIndex + 1)), FMath::Max(1, DecodedTexture.Height >> (MipIndex + 1)),
+                bWithAlpha, Blocks);
+            Mip = MoveTemp(Blocks);
+        }
+        DecodedTexture.PixelFormat = bWithAlpha ? PF_DXT5 : PF_DXT1;
+    }
+
     bool SaveTexturePackage(UTexture2D* Texture, const FString TexturePath, UPackage* Package, FString PackageName) {
 
         // 3Dファイルエクスポート用にテクスチャファイルのパスを保持
@@ -202,24 +257,45 @@ namespace {
     }
 }
 
-UTexture2D* FPLATEAUTextureLoader::Load(const FString& TexturePath_SlashOrBackSlash, bool OverwriteTextre) {
-    int32 Width, Height;
-    EPixelFormat PixelFormat;
-    TArray64<uint8> UncompressedData;
-    if (TexturePath_SlashOrBackSlash.IsEmpty()) return nullptr;
+FString FPLATEAUTextureLoader::NormalizeTexturePath(const FString& TexturePath_SlashOrBackSlash) {
+    if (TexturePath_SlashOrBackSlash.IsEmpty())
+        return FString();
 
     // パスに ".." が含まれる場合は、std::filesystem の機能を使って適用します。
     fs::path TexturePathCpp = fs::path(*TexturePath_SlashOrBackSlash).lexically_normal();
 
     const FString TexturePath_Normalized = TexturePathCpp.c_str();
     // 引数のパスのセパレーターはOSによって "/" か "¥" なので "/" に統一します。
-    const auto TexturePath = TexturePath_Normalized.Replace(*FString("\\"), *FString("/"));
+    return TexturePath_Normalized.Replace(*FString("\\"), *FString("/"));
+}
+
+bool FPLATEAUTextureLoader::Decode(const FString& TexturePath, FPLATEAUDecodedTexture& OutDecodedTexture,
+    const FPLATEAUTextureDecodeOptions& Options) {
+    if (!TryLoadAndUncompressImageFile(TexturePath, OutDecodedTexture.Data, OutDecodedTexture.Width, OutDecodedTexture.Height,
+        OutDecodedTexture.PixelFormat, &OutDecodedTexture.FileSize))
+        return false;
+
+    OutDecodedTexture.UncompressedSize = OutDecodedTexture.Data.Num();
+    ProcessDecodedTexture(OutDecodedTexture, Options);
+    return true;
+}
 
-    if (!TryLoadAndUncompressImageFile(TexturePath, UncompressedData, Width, Height, PixelFormat))
+UTexture2D* FPLATEAUTextureLoader::Load(const FString& TexturePath_SlashOrBackSlash, bool OverwriteTextre) {
+    if (TexturePath_SlashOrBackSlash.IsEmpty()) return nullptr;
+
+    const auto TexturePath = NormalizeTexturePath(TexturePath_SlashOrBackSlash);
+    FPLATEAUDecodedTexture DecodedTexture;
+    if (!Decode(TexturePath, DecodedTexture))
         return nullptr;
 
-    // Mip0Data
-    const int32 Mip0Size = Width * Height * GPixelFormats[PixelFormat].BlockBytes;
+    return CreateTexture(TexturePath, DecodedTexture, OverwriteTextre);
+}
+
+UTexture2D* FPLATEAUTextureLoader::CreateTexture(const FString& TexturePath, const FPLATEAUDecodedTexture& DecodedTexture, bool OverwriteTextre) {
+    const int32 Width = DecodedTexture.Width;
+    const int32 Height = DecodedTexture.Height;
+    const EPixelFormat PixelFormat = DecodedTexture.PixelFormat;
+    const int32 NumMips = DecodedTexture.GetNumMips();
 
     // テクスチャ作成
     UTexture2D* NewTexture = nullptr;
@@ -241,13 +317,15 @@ UTexture2D* FPLATEAUTextureLoader::Load(const FString& TexturePath_SlashOrBackSl
         }
         NewTexture->Rename(*TextureName, nullptr, REN_DontCreateRedirectors);
 
-        NewTexture->NeverStream = true; // NeverStreamをtrueにしないと、レベルを保存して開き直したときにテクスチャ解像度が極端に低く見えます。
-
         NewTexture->AddToRoot();
     }
     else if (!OverwriteTextre) {
         return NewTexture;
     }
+
+    // ミップがない場合、NeverStreamをtrueにしないと、レベルを保存して開き直したときにテクスチャ解像度が極端に低く見えます。
+    // ミップを生成した場合はテクスチャストリーミングの対象とします。
+    NewTexture->NeverStream = NumMips <= 1;
 #if WITH_EDITOR
     // テクスチャ上書き開始
     NewTexture->PreEditChange(nullptr);
@@ -263,13 +341,32 @@ UTexture2D* FPLATEAUTextureLoader::Load(const FString& TexturePath_SlashOrBackSl
         UpdateTextureGPUResourceWithDummy(NewTexture, PixelFormat);
 
     // アセットとして保存するデータで上書き
-    SetTexturePlatformData(NewTexture, UncompressedData, Mip0Size, Width, Height, PixelFormat);
+    SetTexturePlatformData(NewTexture, DecodedTexture);
 
     // GPUがRHIに対応している場合描画自体はRHIで行うため、NewTexture->UpdateResourceは実行しない。
-    if (!GRHISupportsAsyncTextureCreation)
+    if (!GRHISupportsAsyncTextureCreation) {
+        SCOPE_CYCLE_COUNTER(STAT_Texture_UpdateResource);
         NewTexture->UpdateResource();
+    }
 
-    NewTexture->Source.Init(Width, Height, 1, 1, ETextureSourceFormat::TSF_BGRA8, UncompressedData.GetData());
+    if (NumMips > 1) {
+        // 生成済みのミップをそのまま使用する
+        NewTexture->MipGenSettings = TMGS_LeaveExistingMips;
+        if (DecodedTexture.SourceData.Num() > 0) {
+            NewTexture->Source.Init(Width, Height, 1, NumMips, ETextureSourceFormat::TSF_BGRA8, DecodedTexture.SourceData.GetData());
+        }
+        else {
+            TArray64<uint8> SourceData = DecodedTexture.Data;
+            for (const auto& Mip : DecodedTexture.MipChain) {
+                SourceData.Append(Mip);
+            }
+            NewTexture->Source.Init(Width, Height, 1, NumMips, ETextureSourceFormat::TSF_BGRA8, SourceData.GetData());
+        }
+    }
+    else {
+        const auto& SourceData = DecodedTexture.SourceData.Num() > 0 ? DecodedTexture.SourceData : DecodedTexture.Data;
+        NewTexture->Source.Init(Width, Height, 1, 1, ETextureSourceFormat::TSF_BGRA8, SourceData.GetData());
+    }
 
     // テクスチャ上書き終了
     NewTexture->PostEditChange();
@@ -279,20 +376,16 @@ UTexture2D* FPLATEAUTextureLoader::Load(const FString& TexturePath_SlashOrBackSl
     check(IsValid(NewTexture));
 
     if (GRHISupportsAsyncTextureCreation)
-        UpdateTextureGPUResourceAsync(UncompressedData, NewTexture, Mip0Size, Width, Height, PixelFormat, ERHIAccess::SRVMask);
+        UpdateTextureGPUResourceAsync(DecodedTexture, NewTexture, ERHIAccess::SRVMask);
 
     return NewTexture;
 }
 
 UTexture2D* FPLATEAUTextureLoader::LoadTransient(const FString& TexturePath) {
-    int32 Width, Height;
-    EPixelFormat PixelFormat;
-    TArray64<uint8> UncompressedData;
-    if (!TryLoadAndUncompressImageFile(TexturePath, UncompressedData, Width, Height, PixelFormat))
+    FPLATEAUDecodedTexture DecodedTexture;
+    if (!TryLoadAndUncompressImageFile(TexturePath, DecodedTexture.Data, DecodedTexture.Width, DecodedTexture.Height, DecodedTexture.PixelFormat))
         return nullptr;
-
-    // Mip0Data
-    const int32 Mip0Size = Width * Height * GPixelFormats[PixelFormat].BlockBytes;
+    const EPixelFormat PixelFormat = DecodedTexture.PixelFormat;
 
     // テクスチャ作成
     UTexture2D* NewTexture = nullptr;
@@ -312,7 +405,8 @@ UTexture2D* FPLATEAUTextureLoader::LoadTransient(const FString& TexturePath) {
                 if (GRHISupportsAsyncTextureCreation)
                     UpdateTextureGPUResourceWithDummy(NewTexture, PixelFormat);
                 else {
-                    SetTexturePlatformData(NewTexture, UncompressedData, Mip0Size, Width, Height, PixelFormat);
+                    SetTexturePlatformData(NewTexture, DecodedTexture);
+                    SCOPE_CYCLE_COUNTER(STAT_Texture_UpdateResource);
                     NewTexture->UpdateResource();
                 }
 
@@ -322,7 +416,7 @@ UTexture2D* FPLATEAUTextureLoader::LoadTransient(const FString& TexturePath) {
     check(IsValid(NewTexture));
 
     if (GRHISupportsAsyncTextureCreation)
-        UpdateTextureGPUResourceAsync(UncompressedData, NewTexture, Mip0Size, Width, Height, PixelFormat, ERHIAccess::SRVMask);
+        UpdateTextureGPUResourceAsync(DecodedTexture, NewTexture, ERHIAccess::SRVMask);
 
     return NewTexture;
 }
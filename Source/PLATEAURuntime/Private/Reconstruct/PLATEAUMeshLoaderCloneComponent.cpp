@@ -66,7 +66,7 @@ UStaticMeshComponent* FPLATEAUMeshLoaderCloneComponent::GetStaticMeshComponentFo
     // Originalコンポーネントの属性をそのまま利用
     const auto& OriginalComponent = GetOriginalComponent(NodeHier.NodePath);
     if (OriginalComponent) {
-        PLATEAUCityObjectGroup->SerializedCityObjects = OriginalComponent->SerializedCityObjects;
+        PLATEAUCityObjectGroup->CopySerializedCityObjects(*OriginalComponent);
         PLATEAUCityObjectGroup->OutsideChildren = OriginalComponent->OutsideChildren;
         PLATEAUCityObjectGroup->OutsideParent = OriginalComponent->OutsideParent;
         PLATEAUCityObjectGroup->MeshGranularityIntValue = OriginalComponent->MeshGranularityIntValue;
@@ -129,6 +129,11 @@ bool FPLATEAUMeshLoaderCloneComponent::MergeTriangles() {
     return IsSmooth;
 }
 
+// Originalコンポーネントと同一階層に配置するため、ReloadNodeでノード毎に作成する
+bool FPLATEAUMeshLoaderCloneComponent::UseBatchedReload() {
+    return false;
+}
+
 void FPLATEAUMeshLoaderCloneComponent::ModifyMeshDescription(FMeshDescription& MeshDescription) {
 
     if (!IsSmooth) return;
@@ -91,7 +91,7 @@ void FPLATEAUMeshLoaderForHeightmap::CreateReference(ALandscape* Landscape, AAct
 
         // Originalコンポーネントの属性をそのまま利用
         if (OriginalComponent) {
-            RefComponent->SerializedCityObjects = OriginalComponent->SerializedCityObjects;
+            RefComponent->CopySerializedCityObjects(*OriginalComponent);
             RefComponent->OutsideChildren = OriginalComponent->OutsideChildren;
             RefComponent->OutsideParent = OriginalComponent->OutsideParent;
             RefComponent->MeshGranularityIntValue = OriginalComponent->MeshGranularityIntValue;  
@@ -101,7 +101,7 @@ UStaticMeshComponent* FPLATEAUMeshLoaderForLandscapeMesh::GetStaticMeshComponent
     const FString ReplacedName = NodeName.Replace(*FString("Mesh_"), *FString());
     const auto& OriginalComponent = FPLATEAUComponentUtil::GetCityObjectGroupByName(&Actor, ReplacedName);
     if (OriginalComponent) {
-        PLATEAUCityObjectGroup->SerializedCityObjects = OriginalComponent->SerializedCityObjects;
+        PLATEAUCityObjectGroup->CopySerializedCityObjects(*OriginalComponent);
         PLATEAUCityObjectGroup->OutsideChildren = OriginalComponent->OutsideChildren;
         PLATEAUCityObjectGroup->OutsideParent = OriginalComponent->OutsideParent;
         PLATEAUCityObjectGroup->MeshGranularityIntValue = OriginalComponent->MeshGranularityIntValue;
@@ -5,6 +5,13 @@
 #include "Component/PLATEAUCityObjectGroup.h"
 #include "Util/PLATEAUComponentUtil.h"
 #include "Materials/MaterialInstance.h"
+#include "PLATEAUComponentCommandBuffer.h"
+
+namespace {
+    // 結合・分離時に1Tickで作成する最大Component数と最大時間(ミリ秒)
+    constexpr int32 ReloadBatchSize = 64;
+    constexpr float ReloadTimeBudgetMs = 8.0f;
+}
 
 FPLATEAUMeshLoaderForReconstruct::FPLATEAUMeshLoaderForReconstruct(const FPLATEAUCachedMaterialArray& CachedMaterials) : BeforeConvertCachedMaterials(CachedMaterials) {
     bAutomationTest = false;
@@ -38,7 +45,33 @@ void FPLATEAUMeshLoaderForReconstruct::ReloadComponentFromNode(
     ConvGranularity = Granularity;
     LastCreatedComponents.Empty();
 
-    ReloadNodeRecursive(InParentComponent, InNode, Granularity, InActor);
+    if (UseBatchedReload()) {
+        // 作成元のメッシュを保持し、次回の結合・分離では描画用データを読み戻さずにメッシュを作成する
+        bRetainMeshSourceData = true;
+        TAtomic<bool> bCanceled(false);
+        PrepareMeshesInParallel(InNode, &bCanceled);
+
+        plateau::polygonMesh::MeshExtractOptions MeshExtractOptions{};
+        MeshExtractOptions.mesh_granularity = FPLATEAUReconstructUtil::ConvertGranularityToMeshGranularity(Granularity);
+        FLoadInputData LoadInputData
+        {
+            MeshExtractOptions,
+            std::vector<plateau::geometry::Extent>{},
+            FString(),
+            false,
+            nullptr
+        };
+
+        // Component作成をノード毎にゲームスレッドで待機せず、Tick毎にまとめて実行する
+        FPLATEAUComponentCommandBuffer CommandBuffer(ReloadBatchSize, ReloadTimeBudgetMs);
+        EnqueueReloadNodeRecursive(CommandBuffer, MakeShared<USceneComponent*, ESPMode::ThreadSafe>(InParentComponent),
+            InNode, LoadInputData, Granularity, InActor);
+        CommandBuffer.Flush();
+        PreparedMeshes.Reset();
+    }
+    else {
+        ReloadNodeRecursive(InParentComponent, InNode, Granularity, InActor);
+    }
 
     // メッシュをワールド内にビルド
     const auto CopiedStaticMeshes = StaticMeshes;
@@ -69,41 +102,9 @@ USceneComponent* FPLATEAUMeshLoaderForReconstruct::ReloadNode(USceneComponent* P
     FNodeHierarchy NodeHier(Node);
     if (Node.getMesh() == nullptr || Node.getMesh()->getVertices().size() == 0) {
         USceneComponent* Comp = nullptr;
-        UClass* StaticClass;      
-        const FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([&, NodeHier] {
-
-            // すでに同名、同階層のComponentが存在する場合は再利用
-            if (const auto ExistComponent = FPLATEAUComponentUtil::FindChildComponentWithOriginalName(ParentComponent, NodeHier.NodeName)) {
-                Comp = ExistComponent;
-                return;
-            }
-
-            StaticClass = UPLATEAUCityObjectGroup::StaticClass();
-            const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
-            Comp = PLATEAUCityObjectGroup;
-
-            auto cityObjRef = CityObjMap.Find(NodeHier.NodeName);
-            if (cityObjRef != nullptr) {
-                const FPLATEAUCityObject cityObj = *cityObjRef;
-                PLATEAUCityObjectGroup->SerializeCityObject(Node, cityObj, Granularity);
-            }
-
-            const FString NewUniqueName = FPLATEAUComponentUtil::MakeUniqueGmlObjectName(&Actor, StaticClass, NodeHier.NodeName);
-            Comp->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
-
-            check(Comp != nullptr);
-            if (bAutomationTest) {
-                Comp->Mobility = EComponentMobility::Movable;
-            }
-            else {
-                Comp->Mobility = EComponentMobility::Static;
-            }
-
-            Actor.AddInstanceComponent(Comp);
-            Comp->RegisterComponent();
-            Comp->AttachToComponent(ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
-            }, TStatId(), nullptr, ENamedThreads::GameThread);
-        Task->Wait();
+        FFunctionGraphTask::CreateAndDispatchWhenReady([&] {
+            Comp = ReloadSceneComponentInGameThread(ParentComponent, Node, Granularity, Actor);
+            }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
         return Comp;
     }
 
@@ -121,6 +122,78 @@ USceneComponent* FPLATEAUMeshLoaderForReconstruct::ReloadNode(USceneComponent* P
         NodeHier);
 }
 
+USceneComponent* FPLATEAUMeshLoaderForReconstruct::ReloadSceneComponentInGameThread(USceneComponent* ParentComponent,
+    const plateau::polygonMesh::Node& Node,
+    ConvertGranularity Granularity,
+    AActor& Actor) {
+    check(IsInGameThread());
+
+    const FNodeHierarchy NodeHier(Node);
+
+    // すでに同名、同階層のComponentが存在する場合は再利用
+    if (const auto ExistComponent = FPLATEAUComponentUtil::FindChildComponentWithOriginalName(ParentComponent, NodeHier.NodeName))
+        return ExistComponent;
+
+    const auto StaticClass = UPLATEAUCityObjectGroup::StaticClass();
+    const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
+    USceneComponent* Comp = PLATEAUCityObjectGroup;
+
+    auto cityObjRef = CityObjMap.Find(NodeHier.NodeName);
+    if (cityObjRef != nullptr) {
+        const FPLATEAUCityObject cityObj = *cityObjRef;
+        PLATEAUCityObjectGroup->SerializeCityObject(Node, cityObj, Granularity);
+    }
+
+    const FString NewUniqueName = FPLATEAUComponentUtil::MakeUniqueGmlObjectName(&Actor, StaticClass, NodeHier.NodeName);
+    Comp->Rename(*NewUniqueName, nullptr, REN_DontCreateRedirectors);
+
+    check(Comp != nullptr);
+    if (bAutomationTest) {
+        Comp->Mobility = EComponentMobility::Movable;
+    }
+    else {
+        Comp->Mobility = EComponentMobility::Static;
+    }
+
+    Actor.AddInstanceComponent(Comp);
+    Comp->RegisterComponent();
+    Comp->AttachToComponent(ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
+    return Comp;
+}
+
+void FPLATEAUMeshLoaderForReconstruct::EnqueueReloadNodeRecursive(
+    FPLATEAUComponentCommandBuffer& CommandBuffer,
+    const TSharedRef<USceneComponent*, ESPMode::ThreadSafe>& ParentSlot,
+    const plateau::polygonMesh::Node& InNode,
+    const FLoadInputData& LoadInputData,
+    ConvertGranularity Granularity,
+    AActor& InActor) {
+    const auto Slot = MakeShared<USceneComponent*, ESPMode::ThreadSafe>(nullptr);
+    CommandBuffer.Enqueue([this, Slot, ParentSlot, &InNode, &LoadInputData, Granularity, &InActor] {
+        const auto Mesh = InNode.getMesh();
+        if (Mesh == nullptr || Mesh->getVertices().size() == 0) {
+            *Slot = ReloadSceneComponentInGameThread(*ParentSlot, InNode, Granularity, InActor);
+            return;
+        }
+        if (*ParentSlot == nullptr)
+            return;
+
+        TSharedPtr<FPLATEAUPreparedMesh> PreparedMesh;
+        if (!PreparedMeshes.RemoveAndCopyValue(Mesh, PreparedMesh))
+            PreparedMesh = PrepareMesh(*Mesh);
+        *Slot = CreateStaticMeshComponentInGameThread(InActor, **ParentSlot, *Mesh, LoadInputData, nullptr, FNodeHierarchy(InNode), *PreparedMesh);
+        });
+
+    const size_t ChildNodeCount = InNode.getChildCount();
+    for (int i = 0; i < ChildNodeCount; i++) {
+        EnqueueReloadNodeRecursive(CommandBuffer, Slot, InNode.getChildAt(i), LoadInputData, Granularity, InActor);
+    }
+}
+
+bool FPLATEAUMeshLoaderForReconstruct::UseBatchedReload() {
+    return true;
+}
+
 UMaterialInterface* FPLATEAUMeshLoaderForReconstruct::GetMaterialForSubMesh(const FSubMeshMaterialSet& SubMeshValue, UStaticMeshComponent* Component,
     const FLoadInputData& LoadInputData, UTexture2D* Texture, FNodeHierarchy NodeHier, UObject* Outer) {
 
@@ -10,7 +10,7 @@
 namespace {
 
     bool HasCityObjectsType(UPLATEAUCityObjectGroup* CityObj, EPLATEAUCityObjectsType Type) {
-        const auto& found = CityObj->GetAllRootCityObjects().FindByPredicate([&](FPLATEAUCityObject obj) {
+        const auto& found = CityObj->GetRootCityObjects().FindByPredicate([&](const FPLATEAUCityObject& obj) {
             return obj.Type == Type;
             });
         return found != nullptr;
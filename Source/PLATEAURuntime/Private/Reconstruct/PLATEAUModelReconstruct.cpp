@@ -5,6 +5,8 @@
 #include <PLATEAUMeshExporter.h>
 #include <PLATEAUExportSettings.h>
 #include "Util/PLATEAUReconstructUtil.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "Async/TaskGraphInterfaces.h"
 
 using namespace plateau::granularityConvert;
 
@@ -21,11 +23,20 @@ FPLATEAUModelReconstruct::FPLATEAUModelReconstruct(APLATEAUInstancedCityModel* A
 */
 TArray<UPLATEAUCityObjectGroup*> FPLATEAUModelReconstruct::GetUPLATEAUCityObjectGroupsFromSceneComponents(TArray<USceneComponent*> TargetComponents) {
     TSet<UPLATEAUCityObjectGroup*> UniqueComponents;
+    // インスタンス化されたコンポーネントは、インスタンス毎のUPLATEAUCityObjectGroupに展開してから対象とする
+    TSet<UPLATEAUInstancedCityObjectGroup*> InstancedGroups;
+    const auto CollectInstancedGroup = [&InstancedGroups](USceneComponent* Component) {
+        const auto InstancedGroup = Cast<UPLATEAUInstancedCityObjectGroup>(Component);
+        if (InstancedGroup != nullptr && InstancedGroup->IsVisible() && InstancedGroup->GetStaticMesh() != nullptr)
+            InstancedGroups.Add(InstancedGroup);
+    };
+
     for (auto comp : TargetComponents) {
         if (comp->IsA(UActorComponent::StaticClass()) || comp->IsA(UStaticMeshComponent::StaticClass()) && StaticCast<UStaticMeshComponent*>(comp)->GetStaticMesh() == nullptr && comp->IsVisible()) {
             TArray<USceneComponent*> children;
             comp->GetChildrenComponents(true, children);
             for (auto child : children) {
+                CollectInstancedGroup(child);
                 if (child->IsA(UPLATEAUCityObjectGroup::StaticClass()) && child->IsVisible()) {
                     auto childCityObj = StaticCast<UPLATEAUCityObjectGroup*>(child);
                     if (childCityObj->GetStaticMesh() != nullptr) {
@@ -36,6 +47,24 @@ TArray<UPLATEAUCityObjectGroup*> FPLATEAUModelReconstruct::GetUPLATEAUCityObject
         }
         if (comp->IsA(UPLATEAUCityObjectGroup::StaticClass()) && comp->IsVisible())
             UniqueComponents.Add(StaticCast<UPLATEAUCityObjectGroup*>(comp));
+        CollectInstancedGroup(comp);
+    }
+
+    if (InstancedGroups.Num() > 0) {
+        const auto ExpandInGameThread = [this, &InstancedGroups, &UniqueComponents] {
+            for (const auto InstancedGroup : InstancedGroups) {
+                UniqueComponents.Append(InstancedGroup->CollectInstancedGroupInGameThread());
+            }
+            // コンポーネントを置き換えたため索引を作り直す
+            if (CityModelActor != nullptr) {
+                CityModelActor->InvalidateCityObjectIndex();
+                CityModelActor->InvalidateFilterIndex();
+            }
+        };
+        if (IsInGameThread())
+            ExpandInGameThread();
+        else
+            FFunctionGraphTask::CreateAndDispatchWhenReady(ExpandInGameThread, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
     }
     return UniqueComponents.Array();
 }
@@ -5,6 +5,9 @@
 #include <plateau/dataset/i_dataset_accessor.h>
 
 #include "Algo/Count.h"
+#include "Async/ParallelFor.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
 #include "RoadNetwork/CityObject/PLATEAUSubDividedCityObjectGroup.h"
 #include "RoadNetwork/CityObject/SubDividedCityObjectFactory.h"
 #include "RoadNetwork/GeoGraph/GeoGraph2d.h"
@@ -150,7 +153,11 @@ namespace
 
         void BuildConnection();
 
+        // 輪郭線を隣接するFTran毎に分割する. URnPoint/URnWayは作成しないため, FTran毎に並列に実行できる
         bool BuildLine();
+
+        // 輪郭線のWayを作成する. URnPointを共有するため, 全てのFTranで同じ順に1スレッドで実行する
+        void CreateLineWays();
         float GetMedianLength(FTranLine& line)
         {
 
@@ -519,17 +526,30 @@ namespace
         }
 
 
-        FTran* FindTranOrDefault(URFace* Face)
+        // TranMapの追加後に呼び出す
+        void BuildFaceTranMap()
         {
+            FaceTranMap.Reset();
             for (auto& Pair : TranMap)
             {
-                if (Pair.Key->GetFaces().Contains(Face)) {
-                    return Pair.Value.Get();
+                for (auto& Face : Pair.Key->GetFaces()) {
+                    if (FaceTranMap.Contains(Face) == false)
+                        FaceTranMap.Add(Face, Pair.Value.Get());
                 }
             }
+        }
+
+        FTran* FindTranOrDefault(URFace* Face) const
+        {
+            if (auto Found = FaceTranMap.Find(Face))
+                return *Found;
             return nullptr;
         }
 
+    private:
+        // 面 -> 面を含むFTran. BuildLineから並列に参照するため, 作成後は変更しない
+        TMap<RGraphRef_t<URFace>, FTran*> FaceTranMap;
+
     };
 
     TRnRef_T<URnRoadBase> FTran::CreateRoad()
@@ -778,11 +798,14 @@ namespace
             line->Next = Lines[0];
             Lines[0]->Prev = line;
         }
+        return Success;
+    }
 
+    void FTran::CreateLineWays()
+    {
         // Wayを先に作っておく
         for(auto l : Lines)
             l->Way = Work.CreateWay(l->Vertices);
-        return Success;
     }
 }
 
@@ -854,7 +877,7 @@ TRnRef_T<URnModel> FRoadNetworkFactoryEx::CreateRnModel(
         work.TerminateAllowEdgeAngle = Self.TerminateAllowEdgeAngle;
         work.TerminateSkipAngleDeg = Self.TerminateSkipAngle;
     
-        
+        TArray<RGraphRef_t<URFaceGroup>> tranFaceGroups;
         for(auto&& faceGroup : faceGroups) {
             auto&& roadType = faceGroup->GetRoadTypes();
 
@@ -866,12 +889,28 @@ TRnRef_T<URnModel> FRoadNetworkFactoryEx::CreateRnModel(
             // ignoreHighway=trueの時は高速道路も無視
             if (FRRoadTypeMaskEx::IsHighWay(roadType) && Self.bIgnoreHighway)
                 continue;
-            work.TranMap.Add(faceGroup, MakeShared<FTran>(work, Graph, faceGroup));
+            tranFaceGroups.Add(faceGroup);
         }
 
+        // 輪郭の計算, 輪郭線の分割はグラフを参照するだけでFTran毎に独立しているため並列に行う.
+        // UObject(URnPoint/URnWay/道路)の作成はTranMapの順に1スレッドで行い, スレッド数によらず同じ結果にする
+        const auto parallelFlags = Self.bParallelBuild ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+        TArray<TSharedPtr<FTran>> trans;
+        trans.SetNum(tranFaceGroups.Num());
+        ParallelFor(trans.Num(), [&](int32 i) {
+            trans[i] = MakeShared<FTran>(work, Graph, tranFaceGroups[i]);
+            }, parallelFlags);
+        for (auto i = 0; i < trans.Num(); ++i)
+            work.TranMap.Add(tranFaceGroups[i], trans[i]);
+        work.BuildFaceTranMap();
+
         // 作成したFTranを元にRoadを作成
+        ParallelFor(trans.Num(), [&](int32 i) {
+            trans[i]->BuildLine();
+            }, parallelFlags);
+
         for(auto&& pair : work.TranMap)
-            pair.Value->BuildLine();
+            pair.Value->CreateLineWays();
 
         for(auto&& pair : work.TranMap) {
             auto&& tran = pair.Value;
@@ -1063,12 +1102,9 @@ TRnRef_T<URnModel> FRoadNetworkFactoryEx::CreateRnModel(
     return Model;
 }
 
-void FRoadNetworkFactoryEx::CreateSubDividedCityObjects(
-    const FRoadNetworkFactory& Self
-    , APLATEAUInstancedCityModel* Actor
-    , AActor* DestActor
-    , USceneComponent* Root
-    , TArray<UPLATEAUCityObjectGroup*>& CityObjectGroups
+void FRoadNetworkFactoryEx::ConvertSubDividedCityObjects(
+    APLATEAUInstancedCityModel* Actor
+    , const TArray<UPLATEAUCityObjectGroup*>& CityObjectGroups
     , TArray<FSubDividedCityObject>& OutSubDividedCityObjects)
 {
     // 一番子のオブジェクトだけが必要なのでそれを抽出する
@@ -1094,6 +1130,17 @@ void FRoadNetworkFactoryEx::CreateSubDividedCityObjects(
     for (auto C : SubDividedObjectResult->ConvertedCityObjects) {
         FSubDividedObjectVisitor::Visit(*C, OutSubDividedCityObjects);
     }
+}
+
+void FRoadNetworkFactoryEx::CreateSubDividedCityObjects(
+    const FRoadNetworkFactory& Self
+    , APLATEAUInstancedCityModel* Actor
+    , AActor* DestActor
+    , USceneComponent* Root
+    , TArray<UPLATEAUCityObjectGroup*>& CityObjectGroups
+    , TArray<FSubDividedCityObject>& OutSubDividedCityObjects)
+{
+    ConvertSubDividedCityObjects(Actor, CityObjectGroups, OutSubDividedCityObjects);
 
     const auto SubDividedObjectName = TEXT("SubDivided");
     
@@ -1126,6 +1173,35 @@ void FRoadNetworkFactoryEx::CreateSubDividedCityObjects(
 
 }
 
+void FRoadNetworkFactoryEx::UpdateSubDividedCityObjects(
+    const FRoadNetworkFactory& Self
+    , AActor* DestActor
+    , const TSet<UPLATEAUCityObjectGroup*>& Trans
+    , const TArray<FSubDividedCityObject>& SubDividedCityObjects)
+{
+    if (!Self.bSaveTmpData)
+        return;
+    const auto SubDividedCityObjectGroup = DestActor->GetComponentByClass<UPLATEAUSubDividedCityObjectGroup>();
+    if (!SubDividedCityObjectGroup)
+        return;
+
+    // 作り直した地物と削除された地物の最小地物は削除する
+    for (const auto& C : SubDividedCityObjectGroup->GetCityObjects()) {
+        const auto CityObjectGroup = C->CityObject.CityObjectGroup.Get();
+        if (CityObjectGroup && !Trans.Contains(CityObjectGroup))
+            continue;
+        C->DestroyComponent(false);
+        DestActor->RemoveInstanceComponent(C);
+    }
+
+    for (const auto& So : SubDividedCityObjects) {
+        auto UniqueName = MakeUniqueObjectName(DestActor, UPLATEAUSubDividedCityObject::StaticClass(), FName(So.Name));
+        auto NewCityObject = NewObject<UPLATEAUSubDividedCityObject>(DestActor, UniqueName);
+        NewCityObject->CityObject = So;
+        FPLATEAURnEx::AddChildInstanceComponent(DestActor, SubDividedCityObjectGroup, NewCityObject);
+    }
+}
+
 void FRoadNetworkFactoryEx::CreateRGraph(const FRoadNetworkFactory& Self, APLATEAUInstancedCityModel* Actor, AActor* DestActor, USceneComponent* Root, TArray<FSubDividedCityObject>& SubDividedCityObjects,
     RGraphRef_t<URGraph>& OutGraph)
 {
@@ -1253,4 +1329,496 @@ void FRoadNetworkFactoryEx::CreateRnModel(const FRoadNetworkFactory& Self, APLAT
     TArray<UPLATEAUCityObjectGroup*> CityObjectGroups;
     Actor->GetComponents(CityObjectGroups);
     auto res = CreateRoadNetwork(Self, Actor, DestActor, CityObjectGroups);
+    // 差分更新用に生成元の地物の状態を保存する
+    DestActor->SourceStates = CreateSourceStates(CityObjectGroups);
+}
+
+namespace
+{
+    // 接続先として読み込む地物の, 作り直す地物からの距離[m]
+    constexpr float UpdateContextMargin = 1.0f;
+
+    bool IsIntersect2D(const FBox& A, const FBox& B)
+    {
+        return A.Min.X <= B.Max.X && B.Min.X <= A.Max.X && A.Min.Y <= B.Max.Y && B.Min.Y <= A.Max.Y;
+    }
+
+    bool IsIntersect2D(const FBox& A, const TArray<FBox>& Boxes)
+    {
+        return Boxes.ContainsByPredicate([&A](const FBox& B) { return IsIntersect2D(A, B); });
+    }
+
+    TArray<FBox> ExpandBy2D(const TArray<FBox>& Boxes, float Size)
+    {
+        TArray<FBox> Result;
+        Result.Reserve(Boxes.Num());
+        for (const auto& Box : Boxes)
+            Result.Add(Box.ExpandBy(FVector(Size, Size, 0.f)));
+        return Result;
+    }
+
+    TArray<URnRoadBase*> GetRoadBases(const URnModel& Model)
+    {
+        TArray<URnRoadBase*> Result;
+        Result.Reserve(Model.GetRoads().Num() + Model.GetIntersections().Num());
+        for (auto Road : Model.GetRoads())
+            Result.Add(Road);
+        for (auto Intersection : Model.GetIntersections())
+            Result.Add(Intersection);
+        return Result;
+    }
+
+    bool ContainsTargetTran(const URnRoadBase* RoadBase, const TSet<UPLATEAUCityObjectGroup*>& Trans)
+    {
+        return RoadBase->GetTargetTrans().ContainsByPredicate([&Trans](const TWeakObjectPtr<UPLATEAUCityObjectGroup>& Tran) {
+            return Trans.Contains(Tran.Get());
+            });
+    }
+
+    bool IsShareTargetTran(const URnRoadBase* A, const URnRoadBase* B)
+    {
+        return A->GetTargetTrans().ContainsByPredicate([B](const TWeakObjectPtr<UPLATEAUCityObjectGroup>& Tran) {
+            return Tran.IsValid() && B->GetTargetTrans().Contains(Tran);
+            });
+    }
+
+    /*
+     * RegionTransの地物から作られた道路構造を集める.
+     * 統合された道路は複数の地物にまたがるので, それらの地物もRegionTransに加えて繰り返す.
+     * 削除済みの地物から作られた道路構造も対象にする
+     */
+    TArray<URnRoadBase*> CollectRegionRoadBases(const URnModel& Model, TSet<UPLATEAUCityObjectGroup*>& RegionTrans)
+    {
+        const auto RoadBases = GetRoadBases(Model);
+        TMultiMap<UPLATEAUCityObjectGroup*, int32> TranRoadBases;
+        TArray<int32> Stack;
+        for (int32 i = 0; i < RoadBases.Num(); ++i) {
+            for (const auto& Tran : RoadBases[i]->GetTargetTrans()) {
+                if (const auto Target = Tran.Get())
+                    TranRoadBases.Add(Target, i);
+                else
+                    Stack.Add(i);
+            }
+        }
+        for (const auto Tran : RegionTrans)
+            TranRoadBases.MultiFind(Tran, Stack);
+
+        TArray<URnRoadBase*> Result;
+        TBitArray<> Visited(false, RoadBases.Num());
+        while (Stack.Num() > 0) {
+            const auto Index = Stack.Pop();
+            if (Visited[Index])
+                continue;
+            Visited[Index] = true;
+            Result.Add(RoadBases[Index]);
+            for (const auto& Tran : RoadBases[Index]->GetTargetTrans()) {
+                const auto Target = Tran.Get();
+                if (Target == nullptr || RegionTrans.Contains(Target))
+                    continue;
+                RegionTrans.Add(Target);
+                TranRoadBases.MultiFind(Target, Stack);
+            }
+        }
+        return Result;
+    }
+
+    // 道路のBorderType側の各レーンの境界線. 隣接する道路/交差点と線を共有するため, 向きを揃えたコピーではなくレーンが持つものを返す
+    TArray<URnWay*> GetLaneBorders(const URnRoad* Road, EPLATEAURnLaneBorderType BorderType)
+    {
+        TArray<URnWay*> Result;
+        for (const auto Lane : Road->GetAllLanesWithMedian()) {
+            const auto LaneBorderType = Road->IsLeftLane(Lane) ? BorderType : FPLATEAURnLaneBorderTypeEx::GetOpposite(BorderType);
+            if (const auto Border = Lane->GetBorder(LaneBorderType))
+                Result.Add(Border);
+        }
+        return Result;
+    }
+
+    // RoadBaseのNeighborとの境界線
+    TArray<URnWay*> GetBordersTo(URnRoadBase* RoadBase, URnRoadBase* Neighbor)
+    {
+        TArray<URnWay*> Result;
+        if (const auto Road = RoadBase->CastToRoad()) {
+            if (Road->GetPrev() == Neighbor)
+                Result.Append(GetLaneBorders(Road, EPLATEAURnLaneBorderType::Prev));
+            if (Road->GetNext() == Neighbor)
+                Result.Append(GetLaneBorders(Road, EPLATEAURnLaneBorderType::Next));
+        }
+        else if (const auto Intersection = RoadBase->CastToIntersection()) {
+            for (const auto Edge : Intersection->GetEdgesBy(Neighbor))
+                Result.Add(Edge->GetBorder());
+        }
+        Result.Remove(nullptr);
+        return Result;
+    }
+
+    FVector GetBordersCenter(const TArray<URnWay*>& Borders)
+    {
+        FVector Sum = FVector::ZeroVector;
+        for (const auto Border : Borders)
+            Sum += Border->GetLerpPoint(0.5f);
+        return Borders.Num() > 0 ? Sum / Borders.Num() : Sum;
+    }
+
+    // 残す道路構造の, 削除する道路構造との継ぎ目
+    struct FRnModelSeam {
+        URnRoadBase* Kept = nullptr;
+        // Keptが道路の場合の境界の向き
+        EPLATEAURnLaneBorderType BorderType = EPLATEAURnLaneBorderType::Prev;
+        // Keptが交差点の場合の境界の辺
+        TArray<URnIntersectionEdge*> Edges;
+        TArray<URnWay*> Borders;
+        FVector Center = FVector::ZeroVector;
+        bool bLinked = false;
+
+        void Link(URnRoadBase* To)
+        {
+            if (const auto Road = Kept->CastToRoad()) {
+                if (BorderType == EPLATEAURnLaneBorderType::Prev)
+                    Road->SetPrev(To);
+                else
+                    Road->SetNext(To);
+            }
+            for (const auto Edge : Edges)
+                Edge->SetRoad(To);
+            bLinked = true;
+        }
+    };
+
+    TArray<FRnModelSeam> CollectSeams(const TArray<URnRoadBase*>& RemovedRoadBases)
+    {
+        const TSet<URnRoadBase*> Removed(RemovedRoadBases);
+        TSet<TPair<URnRoadBase*, URnRoadBase*>> Visited;
+        TArray<FRnModelSeam> Result;
+        for (const auto RoadBase : RemovedRoadBases) {
+            for (const auto Neighbor : RoadBase->GetNeighborRoads()) {
+                if (!Neighbor || Removed.Contains(Neighbor))
+                    continue;
+                bool bIsVisited = false;
+                Visited.Add(TPair<URnRoadBase*, URnRoadBase*>(Neighbor, RoadBase), &bIsVisited);
+                if (bIsVisited)
+                    continue;
+                if (const auto Road = Neighbor->CastToRoad()) {
+                    for (const auto BorderType : { EPLATEAURnLaneBorderType::Prev, EPLATEAURnLaneBorderType::Next }) {
+                        const auto Other = BorderType == EPLATEAURnLaneBorderType::Prev ? Road->GetPrev() : Road->GetNext();
+                        auto Borders = GetLaneBorders(Road, BorderType);
+                        if (Other != RoadBase || Borders.Num() == 0)
+                            continue;
+                        auto& Seam = Result.AddDefaulted_GetRef();
+                        Seam.Kept = Neighbor;
+                        Seam.BorderType = BorderType;
+                        Seam.Borders = MoveTemp(Borders);
+                    }
+                }
+                else if (const auto Intersection = Neighbor->CastToIntersection()) {
+                    const auto Edges = Intersection->GetEdgesBy(RoadBase);
+                    if (Edges.Num() == 0)
+                        continue;
+                    auto& Seam = Result.AddDefaulted_GetRef();
+                    Seam.Kept = Neighbor;
+                    for (const auto Edge : Edges) {
+                        Seam.Edges.Add(Edge);
+                        if (Edge->GetBorder())
+                            Seam.Borders.Add(Edge->GetBorder());
+                    }
+                }
+            }
+        }
+        for (auto& Seam : Result)
+            Seam.Center = GetBordersCenter(Seam.Borders);
+        return Result;
+    }
+
+    // Bordersの各境界線を端点の一致するToの境界線と同じ線に置き換え, 全体生成と同様に境界線を共有させる
+    // 置き換えた端点はRoadBaseの他の線でも置き換える. 一致する境界線が無かった数を返す
+    int32 ShareBorders(URnRoadBase* RoadBase, const TArray<URnWay*>& Borders, const TArray<URnWay*>& To, float Tolerance)
+    {
+        int32 UnmatchedCount = 0;
+        TSet<const URnWay*> Used;
+        for (const auto Border : Borders) {
+            if (Border->Count() < 2)
+                continue;
+            const auto First = Border->GetPoint(0);
+            const auto Last = Border->GetPoint(-1);
+            float MinSqrDistance = FMath::Square(Tolerance) * 2.f;
+            URnWay* Nearest = nullptr;
+            bool bIsSameDirection = true;
+            for (const auto Way : To) {
+                if (Way->Count() < 2 || Used.Contains(Way))
+                    continue;
+                const auto& WayFirst = Way->GetPoint(0)->Vertex;
+                const auto& WayLast = Way->GetPoint(-1)->Vertex;
+                const float SameSqrDistance = FMath::Max(FVector::DistSquared(First->Vertex, WayFirst), FVector::DistSquared(Last->Vertex, WayLast));
+                const float ReverseSqrDistance = FMath::Max(FVector::DistSquared(First->Vertex, WayLast), FVector::DistSquared(Last->Vertex, WayFirst));
+                const float SqrDistance = FMath::Min(SameSqrDistance, ReverseSqrDistance);
+                if (SqrDistance <= FMath::Square(Tolerance) && SqrDistance < MinSqrDistance) {
+                    MinSqrDistance = SqrDistance;
+                    Nearest = Way;
+                    bIsSameDirection = SameSqrDistance <= ReverseSqrDistance;
+                }
+            }
+            if (!Nearest) {
+                UnmatchedCount++;
+                continue;
+            }
+            Used.Add(Nearest);
+
+            const auto NewFirst = bIsSameDirection ? Nearest->GetPoint(0) : Nearest->GetPoint(-1);
+            const auto NewLast = bIsSameDirection ? Nearest->GetPoint(-1) : Nearest->GetPoint(0);
+            for (const auto& LineString : RoadBase->GetAllLineStringsDistinct()) {
+                LineString->ReplacePoint(First, NewFirst);
+                LineString->ReplacePoint(Last, NewLast);
+            }
+            Border->Init(Nearest->GetLineString(), bIsSameDirection ? Nearest->IsReversed : !Nearest->IsReversed, Border->IsReverseNormal);
+        }
+        return UnmatchedCount;
+    }
+}
+
+FRnModelSourceState FRoadNetworkFactoryEx::CreateSourceState(UPLATEAUCityObjectGroup* Target)
+{
+    FRnModelSourceState State;
+    State.CityObjectGroup = Target;
+    State.Bounds = Target->Bounds.GetBox();
+
+    const auto& Transform = Target->GetComponentTransform();
+    const FVector Values[] = { Transform.GetLocation(), Transform.GetRotation().Euler(), Transform.GetScale3D() };
+    State.Hash = FCrc::MemCrc32(Values, sizeof(Values));
+    const auto Mesh = Target->GetStaticMesh();
+    if (Mesh && Mesh->HasValidRenderData()) {
+        const auto& Positions = Mesh->GetLODForExport(0).VertexBuffers.PositionVertexBuffer;
+        if (Positions.GetNumVertices() > 0)
+            State.Hash = FCrc::MemCrc32(&Positions.VertexPosition(0), Positions.GetNumVertices() * Positions.GetStride(), State.Hash);
+    }
+    return State;
+}
+
+TArray<FRnModelSourceState> FRoadNetworkFactoryEx::CreateSourceStates(const TArray<UPLATEAUCityObjectGroup*>& CityObjectGroups)
+{
+    TArray<FRnModelSourceState> Result;
+    for (const auto CityObjectGroup : CityObjectGroups) {
+        if (IsConvertTarget(CityObjectGroup))
+            Result.Add(CreateSourceState(CityObjectGroup));
+    }
+    return Result;
+}
+
+FRoadNetworkFactoryEx::FUpdateRnModelRequest FRoadNetworkFactoryEx::CreateUpdateRequest(
+    const TArray<FRnModelSourceState>& OldStates
+    , const TArray<FRnModelSourceState>& NewStates)
+{
+    FUpdateRnModelRequest Request;
+    TMap<UPLATEAUCityObjectGroup*, const FRnModelSourceState*> OldStateMap;
+    for (const auto& State : OldStates) {
+        if (const auto CityObjectGroup = State.CityObjectGroup.Get())
+            OldStateMap.Add(CityObjectGroup, &State);
+        else
+            Request.ChangedBounds.Add(State.Bounds);
+    }
+    for (const auto& State : NewStates) {
+        const auto CityObjectGroup = State.CityObjectGroup.Get();
+        Request.TargetBounds.Add(CityObjectGroup, State.Bounds);
+        const FRnModelSourceState* OldState = nullptr;
+        OldStateMap.RemoveAndCopyValue(CityObjectGroup, OldState);
+        if (OldState && OldState->Hash == State.Hash)
+            continue;
+        Request.ChangedTrans.Add(CityObjectGroup);
+        Request.ChangedBounds.Add(State.Bounds);
+        if (OldState)
+            Request.ChangedBounds.Add(OldState->Bounds);
+    }
+    // 非表示などで生成対象でなくなった地物
+    for (const auto& OldState : OldStateMap) {
+        Request.ChangedTrans.Add(OldState.Key);
+        Request.ChangedBounds.Add(OldState.Value->Bounds);
+    }
+    return Request;
+}
+
+FRoadNetworkFactoryEx::FUpdateRnModelResult FRoadNetworkFactoryEx::UpdateRnModel(
+    const FRoadNetworkFactory& Self
+    , APLATEAUInstancedCityModel* Actor
+    , APLATEAURnStructureModel* DestActor)
+{
+    FUpdateRnModelResult Result;
+#if WITH_EDITOR
+    const double StartSeconds = FPlatformTime::Seconds();
+    TArray<UPLATEAUCityObjectGroup*> CityObjectGroups;
+    Actor->GetComponents(CityObjectGroups);
+
+    // 前回の生成情報が無い場合は全体を作り直す
+    if (!DestActor->Model || DestActor->SourceStates.Num() == 0) {
+        CreateRnModel(Self, Actor, DestActor);
+        Result.bFullRebuild = true;
+        Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+        UE_LOG(LogTemp, Log, TEXT("UpdateRnModel : full rebuild %.3f ms"), Result.Seconds * 1000.0);
+        return Result;
+    }
+
+    auto States = CreateSourceStates(CityObjectGroups);
+    const auto Request = CreateUpdateRequest(DestActor->SourceStates, States);
+
+    if (Request.ChangedBounds.Num() > 0) {
+        // 最後に作り直した地物の最小地物で保存済みの最小地物を更新する
+        TSet<UPLATEAUCityObjectGroup*> SubDividedTrans;
+        TArray<FSubDividedCityObject> SubDividedCityObjects;
+        FPLATEAURnDef::SetNewObjectWorld(DestActor->GetWorld());
+        Result = UpdateRnModel(Self, DestActor->Model, Request
+            , [Actor, &SubDividedTrans, &SubDividedCityObjects](const TArray<UPLATEAUCityObjectGroup*>& Targets, TArray<FSubDividedCityObject>& OutSubDividedCityObjects) {
+                ConvertSubDividedCityObjects(Actor, Targets, OutSubDividedCityObjects);
+                SubDividedTrans = TSet<UPLATEAUCityObjectGroup*>(Targets);
+                SubDividedCityObjects = OutSubDividedCityObjects;
+            });
+        FPLATEAURnDef::SetNewObjectWorld(nullptr);
+        SubDividedTrans.Append(Request.ChangedTrans);
+        UpdateSubDividedCityObjects(Self, DestActor, SubDividedTrans, SubDividedCityObjects);
+    }
+    DestActor->SourceStates = MoveTemp(States);
+
+    Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+    UE_LOG(LogTemp, Log, TEXT("UpdateRnModel : %d changed, %d rebuilt (+%d context) trans, %d -> %d road bases, %.3f ms")
+        , Result.ChangedTranCount, Result.RegionTranCount, Result.ContextTranCount
+        , Result.RemovedRoadBaseCount, Result.AddedRoadBaseCount, Result.Seconds * 1000.0);
+#endif
+    return Result;
+}
+
+FRoadNetworkFactoryEx::FUpdateRnModelResult FRoadNetworkFactoryEx::UpdateRnModel(
+    const FRoadNetworkFactory& Self
+    , URnModel* Model
+    , const FUpdateRnModelRequest& Request
+    , FSubDivideFunc SubDivide)
+{
+    FUpdateRnModelResult Result;
+    if (!Model)
+        return Result;
+    const double StartSeconds = FPlatformTime::Seconds();
+    Result.ChangedTranCount = Request.ChangedTrans.Num();
+
+    // 変更された範囲からUpdateHaloSize以内の地物を作り直す
+    TSet<UPLATEAUCityObjectGroup*> RegionTrans = Request.ChangedTrans;
+    const auto HaloBounds = ExpandBy2D(Request.ChangedBounds, Self.UpdateHaloSize * FPLATEAURnDef::Meter2Unit);
+    for (const auto& Target : Request.TargetBounds) {
+        if (IsIntersect2D(Target.Value, HaloBounds))
+            RegionTrans.Add(Target.Key);
+    }
+
+    TArray<URnRoadBase*> RemovedRoadBases;
+    TArray<UPLATEAUCityObjectGroup*> BuildTrans;
+    TSet<UPLATEAUCityObjectGroup*> ContextTrans;
+    URnModel* RegionModel = nullptr;
+    while (true) {
+        RemovedRoadBases = CollectRegionRoadBases(*Model, RegionTrans);
+
+        // 作り直す地物に隣接する地物も接続先として読み込む. 境界の形状と道路/交差点の判定を全体生成と合わせるため
+        TArray<FBox> RegionBounds;
+        for (const auto Tran : RegionTrans) {
+            if (const auto Bounds = Request.TargetBounds.Find(Tran))
+                RegionBounds.Add(*Bounds);
+        }
+        RegionBounds = ExpandBy2D(RegionBounds, UpdateContextMargin * FPLATEAURnDef::Meter2Unit);
+        BuildTrans.Reset();
+        ContextTrans.Reset();
+        for (const auto& Target : Request.TargetBounds) {
+            if (RegionTrans.Contains(Target.Key)) {
+                BuildTrans.Add(Target.Key);
+            }
+            else if (IsIntersect2D(Target.Value, RegionBounds)) {
+                BuildTrans.Add(Target.Key);
+                ContextTrans.Add(Target.Key);
+            }
+        }
+
+        RegionModel = NewObject<URnModel>(GetTransientPackage());
+        TArray<FSubDividedCityObject> SubDividedCityObjects;
+        SubDivide(BuildTrans, SubDividedCityObjects);
+        if (SubDividedCityObjects.Num() > 0)
+            CreateRnModel(Self, FRGraphFactoryEx::CreateGraph(Self.GraphFactory, SubDividedCityObjects), RegionModel);
+
+        // 作り直した道路が接続先の地物と統合された場合は, その地物も作り直す
+        TSet<UPLATEAUCityObjectGroup*> LeakedTrans;
+        for (const auto RoadBase : GetRoadBases(*RegionModel)) {
+            if (!ContainsTargetTran(RoadBase, RegionTrans))
+                continue;
+            for (const auto& Tran : RoadBase->GetTargetTrans()) {
+                if (ContextTrans.Contains(Tran.Get()))
+                    LeakedTrans.Add(Tran.Get());
+            }
+        }
+        if (LeakedTrans.Num() == 0)
+            break;
+        RegionTrans.Append(LeakedTrans);
+    }
+    Result.RegionTranCount = BuildTrans.Num() - ContextTrans.Num();
+    Result.ContextTranCount = ContextTrans.Num();
+    Result.RemovedRoadBaseCount = RemovedRoadBases.Num();
+
+    // 既存の道路構造から作り直す範囲を削除する. 削除した道路構造と繋がっていた境界線は継ぎ目として残す
+    auto Seams = CollectSeams(RemovedRoadBases);
+    for (const auto RoadBase : RemovedRoadBases)
+        RoadBase->DisConnect(true);
+
+    // 作り直した道路構造のうち, 作り直す地物を含むものだけを追加する. 接続先の地物だけのものは既存の道路構造と繋ぎ替える
+    TArray<URnRoadBase*> AddedRoadBases;
+    for (const auto RoadBase : GetRoadBases(*RegionModel)) {
+        if (ContainsTargetTran(RoadBase, RegionTrans))
+            AddedRoadBases.Add(RoadBase);
+    }
+    const TSet<URnRoadBase*> Added(AddedRoadBases);
+    const float SnapTolerance = Self.GraphFactory.MergeCellSize * FPLATEAURnDef::Meter2Unit;
+    TSet<URnIntersection*> RelinkedIntersections;
+    for (const auto RoadBase : AddedRoadBases) {
+        for (const auto Neighbor : RoadBase->GetNeighborRoads()) {
+            if (!Neighbor || Added.Contains(Neighbor))
+                continue;
+
+            // 同じ地物から作られた既存の道路構造の継ぎ目のうち, 境界線が一番近いものと繋ぐ
+            const auto Borders = GetBordersTo(RoadBase, Neighbor);
+            const auto Center = GetBordersCenter(Borders);
+            FRnModelSeam* Nearest = nullptr;
+            for (auto& Seam : Seams) {
+                if (Seam.bLinked || !IsShareTargetTran(Seam.Kept, Neighbor))
+                    continue;
+                if (!Nearest || FVector::DistSquared(Seam.Center, Center) < FVector::DistSquared(Nearest->Center, Center))
+                    Nearest = &Seam;
+            }
+
+            if (!Nearest) {
+                RoadBase->ReplaceNeighbor(Neighbor, nullptr);
+                continue;
+            }
+            if (const auto UnmatchedCount = ShareBorders(RoadBase, Borders, Nearest->Borders, SnapTolerance); UnmatchedCount > 0) {
+                UE_LOG(LogTemp, Warning, TEXT("UpdateRnModel : %d borders of %s are not shared with %s")
+                    , UnmatchedCount, *RoadBase->GetTargetTransName(), *Nearest->Kept->GetTargetTransName());
+            }
+            RoadBase->ReplaceNeighbor(Neighbor, Nearest->Kept);
+            Nearest->Link(RoadBase);
+            if (const auto Intersection = Nearest->Kept->CastToIntersection())
+                RelinkedIntersections.Add(Intersection);
+        }
+    }
+
+    for (const auto RoadBase : AddedRoadBases) {
+        Model->AddRoadBase(RoadBase);
+        for (const auto SideWalk : RoadBase->GetSideWalks())
+            Model->AddSideWalk(SideWalk);
+    }
+    Result.AddedRoadBaseCount = AddedRoadBases.Num();
+
+    // 繋ぎ替えた交差点のトラックを作り直す
+    if (Self.bBuildTracks) {
+        for (const auto Intersection : RelinkedIntersections)
+            Intersection->BuildTracks();
+        for (const auto RoadBase : AddedRoadBases) {
+            if (const auto Intersection = RoadBase->CastToIntersection())
+                Intersection->BuildTracks();
+        }
+    }
+
+    Result.bIsValid = Model->Check();
+    if (!Result.bIsValid)
+        UE_LOG(LogTemp, Warning, TEXT("UpdateRnModel : updated RnModel is invalid"));
+
+    Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+    return Result;
 }
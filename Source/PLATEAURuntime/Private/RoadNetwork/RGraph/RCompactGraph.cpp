@@ -0,0 +1,204 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "RoadNetwork/RGraph/RCompactGraph.h"
+
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "RoadNetwork/RGraph/RGraph.h"
+
+namespace
+{
+    uint64 MakeEdgeKey(int32 V0, int32 V1) {
+        if (V0 > V1)
+            Swap(V0, V1);
+        return (static_cast<uint64>(static_cast<uint32>(V0)) << 32) | static_cast<uint32>(V1);
+    }
+
+    // Counts[i]を要素iの範囲の開始位置に変換し、末尾に総数を追加する
+    void CountsToOffsets(TArray<int32>& Counts) {
+        int32 Sum = 0;
+        for (auto& Count : Counts) {
+            const int32 Num = Count;
+            Count = Sum;
+            Sum += Num;
+        }
+        Counts.Add(Sum);
+    }
+}
+
+int32 FRCompactGraph::AddVertex(const FVector& Position) {
+    return VertexPositions.Add(Position);
+}
+
+int32 FRCompactGraph::FindOrAddEdge(const int32 V0, const int32 V1) {
+    if (const auto Found = EdgeMap.Find(MakeEdgeKey(V0, V1)))
+        return *Found;
+
+    const int32 Edge = EdgeV0.Add(FMath::Min(V0, V1));
+    EdgeV1.Add(FMath::Max(V0, V1));
+    EdgeLastFace.Add(INDEX_NONE);
+    EdgeMap.Add(MakeEdgeKey(V0, V1), Edge);
+    return Edge;
+}
+
+int32 FRCompactGraph::AddFace(UPLATEAUCityObjectGroup* CityObjectGroup, const ERRoadTypeMask RoadTypes, const int32 LodLevel) {
+    FaceCityObjectGroups.Add(CityObjectGroup);
+    FaceLodLevels.Add(LodLevel);
+    FaceEdgeOffsets.Add(FaceEdges.Num());
+    return FaceRoadTypes.Add(RoadTypes);
+}
+
+void FRCompactGraph::AddFaceEdge(const int32 Edge) {
+    const int32 Face = GetFaceCount() - 1;
+    if (EdgeLastFace[Edge] == Face)
+        return;
+
+    EdgeLastFace[Edge] = Face;
+    FaceEdges.Add(Edge);
+    FaceEdgeOffsets.Last() = FaceEdges.Num();
+}
+
+void FRCompactGraph::BuildAdjacency() {
+    // 頂点 -> 辺
+    VertexEdgeOffsets.Init(0, GetVertexCount());
+    for (int32 Edge = 0; Edge < GetEdgeCount(); ++Edge) {
+        ++VertexEdgeOffsets[EdgeV0[Edge]];
+        if (EdgeV1[Edge] != EdgeV0[Edge])
+            ++VertexEdgeOffsets[EdgeV1[Edge]];
+    }
+    CountsToOffsets(VertexEdgeOffsets);
+    VertexEdges.SetNumUninitialized(VertexEdgeOffsets.Last());
+    {
+        TArray<int32> Cursors(VertexEdgeOffsets.GetData(), GetVertexCount());
+        for (int32 Edge = 0; Edge < GetEdgeCount(); ++Edge) {
+            VertexEdges[Cursors[EdgeV0[Edge]]++] = Edge;
+            if (EdgeV1[Edge] != EdgeV0[Edge])
+                VertexEdges[Cursors[EdgeV1[Edge]]++] = Edge;
+        }
+    }
+
+    // 辺 -> 面
+    EdgeFaceOffsets.Init(0, GetEdgeCount());
+    for (const auto Edge : FaceEdges)
+        ++EdgeFaceOffsets[Edge];
+    CountsToOffsets(EdgeFaceOffsets);
+    EdgeFaces.SetNumUninitialized(EdgeFaceOffsets.Last());
+    {
+        TArray<int32> Cursors(EdgeFaceOffsets.GetData(), GetEdgeCount());
+        for (int32 Face = 0; Face < GetFaceCount(); ++Face) {
+            for (const auto Edge : GetFaceEdges(Face))
+                EdgeFaces[Cursors[Edge]++] = Face;
+        }
+    }
+
+    // 道路タイプ
+    EdgeRoadTypes.Init(ERRoadTypeMask::Empty, GetEdgeCount());
+    VertexRoadTypes.Init(ERRoadTypeMask::Empty, GetVertexCount());
+    for (int32 Edge = 0; Edge < GetEdgeCount(); ++Edge) {
+        for (const auto Face : GetEdgeFaces(Edge))
+            EdgeRoadTypes[Edge] |= FaceRoadTypes[Face];
+        VertexRoadTypes[EdgeV0[Edge]] |= EdgeRoadTypes[Edge];
+        VertexRoadTypes[EdgeV1[Edge]] |= EdgeRoadTypes[Edge];
+    }
+}
+
+int32 FRCompactGraph::GetVertexMaxLodLevel(const int32 Vertex) const {
+    int32 MaxLevel = -1;
+    for (const auto Edge : GetVertexEdges(Vertex)) {
+        for (const auto Face : GetEdgeFaces(Edge))
+            MaxLevel = FMath::Max(MaxLevel, FaceLodLevels[Face]);
+    }
+    return MaxLevel;
+}
+
+FRCompactGraph FRCompactGraph::CopyVertices() const {
+    FRCompactGraph Result;
+    Result.VertexPositions = VertexPositions;
+    return Result;
+}
+
+int32 FRCompactGraph::AddFaceFrom(const FRCompactGraph& Src, const int32 SrcFace) {
+    FaceCityObjectGroups.Add(Src.FaceCityObjectGroups[SrcFace]);
+    FaceLodLevels.Add(Src.FaceLodLevels[SrcFace]);
+    FaceEdgeOffsets.Add(FaceEdges.Num());
+    return FaceRoadTypes.Add(Src.FaceRoadTypes[SrcFace]);
+}
+
+void FRCompactGraph::MergeVertices(const TArray<int32>& VertexRemap) {
+    auto Resolve = [&VertexRemap](int32 Vertex) {
+        while (VertexRemap[Vertex] != Vertex)
+            Vertex = VertexRemap[Vertex];
+        return Vertex;
+        };
+
+    auto Result = CopyVertices();
+    for (int32 Face = 0; Face < GetFaceCount(); ++Face) {
+        Result.AddFaceFrom(*this, Face);
+        for (const auto Edge : GetFaceEdges(Face)) {
+            const int32 V0 = Resolve(EdgeV0[Edge]);
+            const int32 V1 = Resolve(EdgeV1[Edge]);
+            // 両端が同じ頂点になった辺は削除する
+            if (V0 != V1)
+                Result.AddFaceEdge(Result.FindOrAddEdge(V0, V1));
+        }
+    }
+    Result.BuildAdjacency();
+    *this = MoveTemp(Result);
+}
+
+SIZE_T FRCompactGraph::GetAllocatedSize() const {
+    return VertexPositions.GetAllocatedSize() + EdgeV0.GetAllocatedSize() + EdgeV1.GetAllocatedSize()
+        + FaceCityObjectGroups.GetAllocatedSize() + FaceRoadTypes.GetAllocatedSize() + FaceLodLevels.GetAllocatedSize()
+        + FaceEdgeOffsets.GetAllocatedSize() + FaceEdges.GetAllocatedSize()
+        + VertexEdgeOffsets.GetAllocatedSize() + VertexEdges.GetAllocatedSize()
+        + EdgeFaceOffsets.GetAllocatedSize() + EdgeFaces.GetAllocatedSize()
+        + VertexRoadTypes.GetAllocatedSize() + EdgeRoadTypes.GetAllocatedSize()
+        + EdgeMap.GetAllocatedSize() + EdgeLastFace.GetAllocatedSize();
+}
+
+FRCompactGraph FRCompactGraph::FromGraph(const URGraph& Graph) {
+    FRCompactGraph Result;
+    TMap<const URVertex*, int32> VertexHandles;
+    auto GetVertexHandle = [&](const URVertex* Vertex) {
+        if (const auto Found = VertexHandles.Find(Vertex))
+            return *Found;
+        return VertexHandles.Add(Vertex, Result.AddVertex(Vertex->GetPosition()));
+    };
+
+    for (const auto& Face : Graph.GetFaces()) {
+        Result.AddFace(Face->GetCityObjectGroup().Get(), Face->GetRoadTypes(), Face->GetLodLevel());
+        for (const auto& Edge : Face->GetEdges()) {
+            if (!Edge->IsValid())
+                continue;
+            const int32 V0 = GetVertexHandle(Edge->GetV0());
+            const int32 V1 = GetVertexHandle(Edge->GetV1());
+            Result.AddFaceEdge(Result.FindOrAddEdge(V0, V1));
+        }
+    }
+    Result.BuildAdjacency();
+    return Result;
+}
+
+URGraph* FRCompactGraph::ToGraph() const {
+    auto Graph = RGraphNew<URGraph>();
+
+    TArray<RGraphRef_t<URVertex>> Vertices;
+    Vertices.SetNumZeroed(GetVertexCount());
+    for (int32 Vertex = 0; Vertex < GetVertexCount(); ++Vertex) {
+        if (VertexEdgeOffsets.IsEmpty() || VertexEdgeOffsets[Vertex] != VertexEdgeOffsets[Vertex + 1])
+            Vertices[Vertex] = RGraphNew<URVertex>(VertexPositions[Vertex]);
+    }
+
+    TArray<RGraphRef_t<UREdge>> Edges;
+    Edges.SetNumUninitialized(GetEdgeCount());
+    for (int32 Edge = 0; Edge < GetEdgeCount(); ++Edge) {
+        Edges[Edge] = RGraphNew<UREdge>(Vertices[EdgeV0[Edge]], Vertices[EdgeV1[Edge]]);
+    }
+
+    for (int32 Face = 0; Face < GetFaceCount(); ++Face) {
+        auto NewFace = RGraphNew<URFace>(Graph, FaceCityObjectGroups[Face].Get(), FaceRoadTypes[Face], FaceLodLevels[Face]);
+        for (const auto Edge : GetFaceEdges(Face))
+            NewFace->AddEdge(Edges[Edge]);
+        Graph->AddFace(NewFace);
+    }
+    return Graph;
+}
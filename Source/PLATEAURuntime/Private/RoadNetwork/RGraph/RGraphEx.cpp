@@ -4,18 +4,327 @@
 
 #include <array>
 
-#include "Algo/Count.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Reverse.h"
+#include "Algo/Unique.h"
 #include "Component/PLATEAUCityObjectGroup.h"
 #include "RoadNetwork/GeoGraph/GeoGraph2d.h"
 #include "RoadNetwork/CityObject/SubDividedCityObject.h"
 #include "RoadNetwork/GeoGraph/GeoGraphEx.h"
+#include "RoadNetwork/RGraph/RCompactGraph.h"
 #include "Algo/AnyOf.h"
+#include "RoadNetwork/Util/PLATEAUIntVectorEx.h"
 #include "RoadNetwork/Util/PLATEAURay2DEx.h"
 #include "RoadNetwork/Util/PLATEAURnDebugEx.h"
 #include "RoadNetwork/Util/PLATEAURnLinq.h"
 
 namespace
 {
+    /**
+     * 頂点を走査順(Vector3Comparer)に並べ, 各辺が走査中に保持される範囲を求めたもの
+     * 辺は開始点(走査順が前の頂点)の処理後に追加され, 終了点の処理で取り除かれる
+     */
+    struct FRVertexSweep {
+        TArray<RGraphRef_t<URVertex>> Vertices;
+        TArray<RGraphRef_t<UREdge>> Edges;
+        TMap<RGraphRef_t<UREdge>, int32> EdgeIndices;
+        // 辺の開始点・終了点の頂点のインデックス. ない場合はMAX_int32
+        TArray<int32> StartIndices;
+        TArray<int32> EndIndices;
+
+        explicit FRVertexSweep(RGraphRef_t<URGraph> Graph) {
+            Vertices = Graph->GetAllVertices().Array();
+
+            constexpr auto Comp = FPLATEAURnDef::Vector3Comparer();
+            // #NOTE : UEのバグ？ ポインタのTArrayをソートしようとするとラムダ式にはポインタを消したうえで行う必要がある模様
+            Vertices.Sort([&](const URVertex& A, const URVertex& B) {
+                return Comp(A.Position, B.Position) < 0;
+                });
+
+            for (auto i = 0; i < Vertices.Num(); i++) {
+                auto V = Vertices[i];
+                for (auto&& E : V->GetEdges()) {
+                    // vと反対側の点を見る
+                    auto o = E->GetOppositeVertex(V);
+                    if (!o)
+                        continue;
+                    auto d = Comp(V->Position, o->Position);
+                    if (d == 0)
+                        continue;
+
+                    int32 Index;
+                    if (const auto Found = EdgeIndices.Find(E)) {
+                        Index = *Found;
+                    }
+                    else {
+                        Index = Edges.Add(E);
+                        EdgeIndices.Add(E, Index);
+                        StartIndices.Add(MAX_int32);
+                        EndIndices.Add(MAX_int32);
+                    }
+                    // vが開始点/終了点
+                    if (d < 0)
+                        StartIndices[Index] = i;
+                    else
+                        EndIndices[Index] = i;
+                }
+            }
+        }
+
+        // VertexIndex番目の頂点の処理時に, 走査中の辺として保持されているか(終了点がVertexIndexの辺は含まない)
+        bool IsActive(const int32 Edge, const int32 VertexIndex) const {
+            return StartIndices[Edge] < VertexIndex && VertexIndex < EndIndices[Edge];
+        }
+    };
+
+    /**
+     * FRVertexSweepのFRCompactGraph版
+     * 辺のインデックスは辺のハンドルと同じ
+     */
+    struct FRCompactVertexSweep {
+        TArray<int32> Vertices;
+        TArray<int32> StartIndices;
+        TArray<int32> EndIndices;
+
+        explicit FRCompactVertexSweep(const FRCompactGraph& Graph) {
+            const auto& Positions = Graph.VertexPositions;
+            for (int32 V = 0; V < Graph.GetVertexCount(); V++) {
+                if (Graph.GetVertexEdges(V).Num() > 0)
+                    Vertices.Add(V);
+            }
+
+            constexpr auto Comp = FPLATEAURnDef::Vector3Comparer();
+            Vertices.Sort([&](const int32 A, const int32 B) {
+                return Comp(Positions[A], Positions[B]) < 0;
+                });
+
+            StartIndices.Init(MAX_int32, Graph.GetEdgeCount());
+            EndIndices.Init(MAX_int32, Graph.GetEdgeCount());
+            for (auto i = 0; i < Vertices.Num(); i++) {
+                const auto V = Vertices[i];
+                for (const auto E : Graph.GetVertexEdges(V)) {
+                    const auto d = Comp(Positions[V], Positions[Graph.GetOppositeVertex(E, V)]);
+                    if (d == 0)
+                        continue;
+                    if (d < 0)
+                        StartIndices[E] = i;
+                    else
+                        EndIndices[E] = i;
+                }
+            }
+        }
+
+        bool IsActive(const int32 Edge, const int32 VertexIndex) const {
+            return StartIndices[Edge] < VertexIndex && VertexIndex < EndIndices[Edge];
+        }
+    };
+
+    /**
+     * 辺を通過するセルに登録する2D(FPLATEAURnDef::Plane)の一様グリッド
+     * 走査中の全ての辺と比較する代わりに, 近傍のセルに登録された辺のみを候補とする
+     */
+    class FREdgeGrid {
+    public:
+        FREdgeGrid(const TArray<RGraphRef_t<UREdge>>& InEdges, const double InMargin)
+            : Margin(InMargin) {
+            Segments.Reserve(InEdges.Num());
+            for (auto&& E : InEdges)
+                Segments.Add({ FPLATEAURnDef::To2D(E->GetV0()->GetPosition()), FPLATEAURnDef::To2D(E->GetV1()->GetPosition()) });
+            Build();
+        }
+
+        // FRCompactGraphの全ての辺を辺のハンドル順に登録する
+        FREdgeGrid(const FRCompactGraph& Graph, const double InMargin)
+            : Margin(InMargin) {
+            Segments.Reserve(Graph.GetEdgeCount());
+            for (auto E = 0; E < Graph.GetEdgeCount(); E++)
+                Segments.Add({ FPLATEAURnDef::To2D(Graph.VertexPositions[Graph.EdgeV0[E]]), FPLATEAURnDef::To2D(Graph.VertexPositions[Graph.EdgeV1[E]]) });
+            Build();
+        }
+
+        // 点からMargin以内を通過する可能性のある辺をインデックス順に返す
+        void QueryPoint(const FVector& Point, TArray<int32>& OutEdges) {
+            BeginQuery(OutEdges);
+            const auto P = FPLATEAURnDef::To2D(Point);
+            const FIntVector2 Min(FMath::FloorToInt((P.X - Margin) / CellSize), FMath::FloorToInt((P.Y - Margin) / CellSize));
+            const FIntVector2 Max(FMath::FloorToInt((P.X + Margin) / CellSize), FMath::FloorToInt((P.Y + Margin) / CellSize));
+            for (auto X = Min.X; X <= Max.X; X++) {
+                for (auto Y = Min.Y; Y <= Max.Y; Y++)
+                    CollectCell(FIntVector2(X, Y), OutEdges);
+            }
+            OutEdges.Sort();
+        }
+
+        // Edge番目の辺と交差する可能性のある辺をインデックス順に返す
+        void QueryEdge(const int32 Edge, TArray<int32>& OutEdges) {
+            BeginQuery(OutEdges);
+            ForEachSegmentCell(Segments[Edge].Key, Segments[Edge].Value, [&](const FIntVector2& Cell) {
+                CollectCell(Cell, OutEdges);
+                });
+            OutEdges.Sort();
+        }
+
+    private:
+        void Build() {
+            double TotalLength = 0.0;
+            for (auto&& Segment : Segments)
+                TotalLength += (Segment.Value - Segment.Key).Size();
+            // セルの大きさは辺の平均の長さとする(長い辺は通過するセル全てに登録する)
+            CellSize = FMath::Max3(Segments.Num() > 0 ? TotalLength / Segments.Num() : 0.0, Margin * 2.0, 1.0);
+
+            for (auto i = 0; i < Segments.Num(); i++) {
+                ForEachSegmentCell(Segments[i].Key, Segments[i].Value, [&](const FIntVector2& Cell) {
+                    Cells.FindOrAdd(Cell).Add(i);
+                    });
+            }
+            Stamps.Init(0, Segments.Num());
+        }
+
+        // 線分A-BからMargin以内のセルを列挙する
+        template<typename TFunc>
+        void ForEachSegmentCell(const FVector2D& A, const FVector2D& B, TFunc&& Func) const {
+            const auto MinX = FMath::Min(A.X, B.X) - Margin;
+            const auto MaxX = FMath::Max(A.X, B.X) + Margin;
+            const auto DX = B.X - A.X;
+            for (auto X = FMath::FloorToInt(MinX / CellSize); X <= FMath::FloorToInt(MaxX / CellSize); X++) {
+                // 列の範囲での線分のYの範囲
+                const auto Left = FMath::Max(X * CellSize, MinX);
+                const auto Right = FMath::Min((X + 1) * CellSize, MaxX);
+                auto Y0 = A.Y;
+                auto Y1 = B.Y;
+                if (FMath::Abs(DX) > UE_DOUBLE_SMALL_NUMBER) {
+                    Y0 = FMath::Lerp(A.Y, B.Y, FMath::Clamp((Left - A.X) / DX, 0.0, 1.0));
+                    Y1 = FMath::Lerp(A.Y, B.Y, FMath::Clamp((Right - A.X) / DX, 0.0, 1.0));
+                }
+                const auto MinY = FMath::FloorToInt((FMath::Min(Y0, Y1) - Margin) / CellSize);
+                const auto MaxY = FMath::FloorToInt((FMath::Max(Y0, Y1) + Margin) / CellSize);
+                for (auto Y = MinY; Y <= MaxY; Y++)
+                    Func(FIntVector2(X, Y));
+            }
+        }
+
+        void BeginQuery(TArray<int32>& OutEdges) {
+            OutEdges.Reset();
+            Stamp++;
+        }
+
+        void CollectCell(const FIntVector2& Cell, TArray<int32>& OutEdges) {
+            const auto Found = Cells.Find(Cell);
+            if (!Found)
+                return;
+            for (auto Edge : *Found) {
+                if (Stamps[Edge] == Stamp)
+                    continue;
+                Stamps[Edge] = Stamp;
+                OutEdges.Add(Edge);
+            }
+        }
+
+        double Margin;
+        double CellSize = 1.0;
+        TArray<TPair<FVector2D, FVector2D>> Segments;
+        TMap<FIntVector2, TArray<int32>> Cells;
+        // クエリ毎の重複除去用
+        TArray<int32> Stamps;
+        int32 Stamp = 0;
+    };
+
+    /**
+     * FRCompactGraphの面・辺を絞り込んで作り直す
+     * KeepFace(面)がfalseの面と, KeepFaceEdge(面, 面の辺のFaceEdges上のインデックス)がfalseの面の辺を除き, どの面にも含まれなくなった辺は削除する
+     */
+    void FilterCompactGraph(FRCompactGraph& Graph, TFunctionRef<bool(int32)> KeepFace, TFunctionRef<bool(int32, int32)> KeepFaceEdge) {
+        auto Result = Graph.CopyVertices();
+        for (auto Face = 0; Face < Graph.GetFaceCount(); Face++) {
+            if (!KeepFace(Face))
+                continue;
+            Result.AddFaceFrom(Graph, Face);
+            for (auto i = Graph.FaceEdgeOffsets[Face]; i < Graph.FaceEdgeOffsets[Face + 1]; i++) {
+                const auto Edge = Graph.FaceEdges[i];
+                if (KeepFaceEdge(Face, i))
+                    Result.AddFaceEdge(Result.FindOrAddEdge(Graph.EdgeV0[Edge], Graph.EdgeV1[Edge]));
+            }
+        }
+        Result.BuildAdjacency();
+        Graph = MoveTemp(Result);
+    }
+
+    /**
+     * 位置をCellSizeのセルに分け, FGeoGraphEx::MergeVerticesと同じ規則でセルをまとめる
+     * ソート順に未統合のセルを起点Kとし, Kからのマンハッタン距離がMergeCellLength以内で繋がっているセルをKに統合する(起点から離れたセルまで連鎖しない)
+     * セルのキーはソート済みの配列で保持し, 隣接セルは二分探索で求める
+     * OutGroups[i]にPositions[i]のグループ(0～グループ数-1)を格納し, グループ数を返す
+     */
+    int32 GroupPositionsByCell(const TArray<FVector>& Positions, const float CellSize, const int32 MergeCellLength, TArray<int32>& OutGroups) {
+        auto Less = [](const FIntVector& A, const FIntVector& B) {
+            if (A.X != B.X) return A.X < B.X;
+            if (A.Y != B.Y) return A.Y < B.Y;
+            return A.Z < B.Z;
+            };
+
+        TArray<FIntVector> PositionCells;
+        PositionCells.Reserve(Positions.Num());
+        for (auto&& P : Positions)
+            PositionCells.Add(FIntVector(FMath::FloorToInt(P.X / CellSize), FMath::FloorToInt(P.Y / CellSize), FMath::FloorToInt(P.Z / CellSize)));
+
+        auto Keys = PositionCells;
+        Keys.Sort(Less);
+        Keys.SetNum(Algo::Unique(Keys));
+
+        const auto Offsets = FGeoGraphEx::GetNeighborDistance3D(1);
+
+        // Parents[i] : セルiの統合先のセル. 統合されていないセルは自身
+        TArray<int32> Parents;
+        Parents.SetNumUninitialized(Keys.Num());
+        for (auto i = 0; i < Keys.Num(); i++)
+            Parents[i] = i;
+        auto FindRoot = [&Parents](int32 X) {
+            while (Parents[X] != X) {
+                Parents[X] = Parents[Parents[X]];
+                X = Parents[X];
+            }
+            return X;
+            };
+
+        // 起点として統合済みのセルも, 後の起点の範囲内であればまとめて統合される(MergeVerticesと同じ)
+        TArray<int32> Queue;
+        for (auto k = 0; k < Keys.Num(); k++) {
+            if (Parents[k] != k)
+                continue;
+            const auto K = Keys[k];
+            Queue.Reset();
+            Queue.Add(k);
+            for (auto q = 0; q < Queue.Num(); q++) {
+                const auto C = Keys[Queue[q]];
+                for (auto&& D : Offsets) {
+                    const auto N = C + D;
+                    if (N == K || FPLATEAUIntVectorEx::Sum(FPLATEAUIntVectorEx::Abs(K - N)) > MergeCellLength)
+                        continue;
+                    const auto n = Algo::BinarySearch(Keys, N, Less);
+                    if (n == INDEX_NONE || Parents[n] != n)
+                        continue;
+                    Parents[n] = k;
+                    Queue.Add(n);
+                }
+            }
+        }
+
+        // ルートのセル順にグループ番号を割り当てる
+        TArray<int32> CellGroups;
+        CellGroups.Init(INDEX_NONE, Keys.Num());
+        int32 GroupNum = 0;
+        for (auto i = 0; i < Keys.Num(); i++) {
+            auto& Group = CellGroups[FindRoot(i)];
+            if (Group == INDEX_NONE)
+                Group = GroupNum++;
+            CellGroups[i] = Group;
+        }
+
+        OutGroups.SetNumUninitialized(Positions.Num());
+        for (auto i = 0; i < Positions.Num(); i++)
+            OutGroups[i] = CellGroups[Algo::BinarySearch(Keys, PositionCells[i], Less)];
+        return GroupNum;
+    }
 }
 
 void FRGraphEx::RemoveInnerVertex(RGraphRef_t<URFace> Face) {
@@ -98,6 +407,58 @@ TSet<RGraphRef_t<URVertex>> FRGraphEx::AdjustSmallLodHeight(
     return Result;
 }
 
+TArray<int32> FRGraphEx::AdjustSmallLodHeight(
+    FRCompactGraph& Graph,
+    float MergeCellSizeMeter,
+    int32 MergeCellLength,
+    float HeightToleranceMeter) {
+    TArray<int32> Result;
+
+    auto MergeCellSize = MergeCellSizeMeter * FPLATEAURnDef::Meter2Unit;
+    auto HeightTolerance = HeightToleranceMeter * FPLATEAURnDef::Meter2Unit;
+    TMap<FIntVector2, TArray<int32>> Grid;
+    for (int32 Vertex = 0; Vertex < Graph.GetVertexCount(); ++Vertex) {
+        // 辺を持たない頂点はURGraphの頂点に含まれない
+        if (Graph.GetVertexEdges(Vertex).Num() == 0)
+            continue;
+        FVector2D Pos2D = FPLATEAURnDef::To2D(Graph.VertexPositions[Vertex]);
+        FIntVector2 GridPos(
+            FMath::FloorToInt(Pos2D.X / MergeCellSize),
+            FMath::FloorToInt(Pos2D.Y / MergeCellSize)
+        );
+        Grid.FindOrAdd(GridPos).Add(Vertex);
+    }
+
+    for (auto& GridPair : Grid) {
+        auto& CellVertices = GridPair.Value;
+        if (CellVertices.Num() <= 1) continue;
+
+        TMap<int32, TArray<int32>> LodGroups;
+        for (auto Vertex : CellVertices) {
+            LodGroups.FindOrAdd(Graph.GetVertexMaxLodLevel(Vertex)).Add(Vertex);
+        }
+
+        for (auto& LodPair : LodGroups) {
+            if (LodPair.Value.Num() <= 1) continue;
+
+            float AverageHeight = 0.0f;
+            for (auto Vertex : LodPair.Value) {
+                AverageHeight += Graph.VertexPositions[Vertex].Z;
+            }
+            AverageHeight /= LodPair.Value.Num();
+
+            for (auto Vertex : LodPair.Value) {
+                if (FMath::Abs(Graph.VertexPositions[Vertex].Z - AverageHeight) <= HeightTolerance) {
+                    Graph.VertexPositions[Vertex].Z = AverageHeight;
+                    Result.Add(Vertex);
+                }
+            }
+        }
+    }
+
+    return Result;
+}
+
 void FRGraphEx::VertexReduction(
     RGraphRef_t<URGraph> Graph,
     float MergeCellSizeMeter,
@@ -105,67 +466,207 @@ void FRGraphEx::VertexReduction(
     float MidPointToleranceMeter) {
     if (!Graph) return;
 
-    //auto&& Vertices = Graph->GetAllVertices();
-    TMap<FIntVector2, TArray<RGraphRef_t<URVertex>>> Grid;
-
     auto MergeCellSize = MergeCellSizeMeter * FPLATEAURnDef::Meter2Unit;
     auto MidPointTolerance = MidPointToleranceMeter * FPLATEAURnDef::Meter2Unit;
-    while(true)
-    {
-        auto Vertices = Graph->GetAllVertices();
-        TArray<FVector> Positions;
-        for (auto V : Vertices)
-            Positions.Add(V->Position);
-        auto Map = FGeoGraphEx::MergeVertices(Positions, MergeCellSize, MergeCellLength);
-        TSet<FVector> Keys;
-        for (auto& Pair : Map) {
-            Keys.Add(Pair.Value);
+
+    // 近傍のセルにある頂点をまとめて中心に統合する.
+    // 統合後の中心同士が再び近傍のセルに入る場合があるため, まとまらなくなるまで位置の配列上で繰り返し, グラフは最後に1度だけ変更する
+    auto Vertices = Graph->GetAllVertices().Array();
+    TArray<FVector> Centers;
+    TArray<int32> VertexGroups;
+    Centers.Reserve(Vertices.Num());
+    VertexGroups.Reserve(Vertices.Num());
+    for (auto i = 0; i < Vertices.Num(); i++) {
+        Centers.Add(Vertices[i]->Position);
+        VertexGroups.Add(i);
+    }
+
+    while (true) {
+        TArray<int32> Groups;
+        const auto GroupNum = GroupPositionsByCell(Centers, MergeCellSize, MergeCellLength, Groups);
+        if (GroupNum == Centers.Num())
+            break;
+
+        TArray<FVector> NewCenters;
+        TArray<int32> Counts;
+        NewCenters.Init(FVector::ZeroVector, GroupNum);
+        Counts.Init(0, GroupNum);
+        for (auto i = 0; i < Centers.Num(); i++) {
+            NewCenters[Groups[i]] += Centers[i];
+            Counts[Groups[i]]++;
         }
+        for (auto i = 0; i < GroupNum; i++)
+            NewCenters[i] /= Counts[i];
 
-        TMap<FVector, RGraphRef_t<URVertex>> Vertex2RVertex;
-        for (auto V : Keys)
-            Vertex2RVertex.Add(V, RGraphNew<URVertex>(V));
+        for (auto& Group : VertexGroups)
+            Group = Groups[Group];
+        Centers = MoveTemp(NewCenters);
+    }
 
-        auto AfterCount = Vertex2RVertex.Num() + Algo::CountIf(Vertices, [&Vertex2RVertex](RGraphRef_t<URVertex> V) {return !Vertex2RVertex.Contains(V->Position); });
-        
-        for (auto V : Vertices) {
-            auto Pos = V->Position;
-            if (Map.Contains(Pos)) {
-                auto NewVertex = Vertex2RVertex[Map[Pos]];
-                V->MergeTo(NewVertex);
+    // グループ毎に最初の頂点を残して中心に移動し, 他の頂点をそこに統合する
+    TArray<RGraphRef_t<URVertex>> Representatives;
+    Representatives.SetNumZeroed(Centers.Num());
+    for (auto i = 0; i < Vertices.Num(); i++) {
+        auto& Representative = Representatives[VertexGroups[i]];
+        if (!Representative) {
+            Representative = Vertices[i];
+            Representative->Position = Centers[VertexGroups[i]];
+        }
+        else {
+            Vertices[i]->MergeTo(Representative);
+        }
+    }
+
+    // a-b-cのような直線状の頂点を削除する.
+    // 頂点を削除すると両隣の頂点の接続だけが変わるため, それらを再度確認対象に追加する
+    const auto SqrLen = MidPointTolerance * MidPointTolerance;
+    TArray<RGraphRef_t<URVertex>> WorkList = Graph->GetAllVertices().Array();
+    Algo::Reverse(WorkList);
+    TSet<RGraphRef_t<URVertex>> Queued(WorkList);
+    while (WorkList.Num() > 0) 
+    {
+        auto V = WorkList.Pop(EAllowShrinking::No);
+        Queued.Remove(V);
+        // 2つのエッジにしか繋がっていない頂点を探す
+        if (V->GetEdges().Num() != 2)
+            continue;
+        // 隣接する頂点が2つしかない頂点を探す
+        auto Neighbors = V->GetNeighborVertices();
+        if (Neighbors.Num() != 2)
+            continue;
+        // 中間点があってもほぼ直線だった場合は中間点は削除する
+        auto segment = FLineSegment3D(Neighbors[0]->GetPosition(), Neighbors[1]->GetPosition());
+        auto p = segment.GetNearestPoint(V->GetPosition());
+        if ((p - V->GetPosition()).SquaredLength() >= SqrLen)
+            continue;
+        // とりあえずNeighbors[0]にマージする
+        V->MergeTo(Neighbors[0]);
+        for (auto&& N : Neighbors) {
+            if (N && !Queued.Contains(N)) {
+                Queued.Add(N);
+                WorkList.Add(N);
             }
         }
+    }
+}
+
+void FRGraphEx::VertexReduction(
+    FRCompactGraph& Graph,
+    float MergeCellSizeMeter,
+    int32 MergeCellLength,
+    float MidPointToleranceMeter) {
+    auto MergeCellSize = MergeCellSizeMeter * FPLATEAURnDef::Meter2Unit;
+    auto MidPointTolerance = MidPointToleranceMeter * FPLATEAURnDef::Meter2Unit;
+    auto& Positions = Graph.VertexPositions;
+
+    // URGraph版と同じく, 近傍のセルにある頂点を中心に統合する処理をまとまらなくなるまで位置の配列上で繰り返し, グラフは最後に1度だけ作り直す
+    TArray<int32> Vertices;
+    TArray<FVector> Centers;
+    TArray<int32> VertexGroups;
+    for (auto V = 0; V < Graph.GetVertexCount(); V++) {
+        if (Graph.GetVertexEdges(V).Num() == 0)
+            continue;
+        VertexGroups.Add(Vertices.Num());
+        Vertices.Add(V);
+        Centers.Add(Positions[V]);
+    }
 
-        if(AfterCount == Vertices.Num())
+    while (true) {
+        TArray<int32> Groups;
+        const auto GroupNum = GroupPositionsByCell(Centers, MergeCellSize, MergeCellLength, Groups);
+        if (GroupNum == Centers.Num())
             break;
+
+        TArray<FVector> NewCenters;
+        TArray<int32> Counts;
+        NewCenters.Init(FVector::ZeroVector, GroupNum);
+        Counts.Init(0, GroupNum);
+        for (auto i = 0; i < Centers.Num(); i++) {
+            NewCenters[Groups[i]] += Centers[i];
+            Counts[Groups[i]]++;
+        }
+        for (auto i = 0; i < GroupNum; i++)
+            NewCenters[i] /= Counts[i];
+
+        for (auto& Group : VertexGroups)
+            Group = Groups[Group];
+        Centers = MoveTemp(NewCenters);
     }
 
-    // a-b-cのような直線状の頂点を削除する
-    while (true) 
-    {
-        const auto SqrLen = MidPointTolerance * MidPointTolerance;
-        auto Count = 0;
-        for(auto&& V : Graph->GetAllVertices())
-        {
-            // 2つのエッジにしか繋がっていない頂点を探す
-            if (V->GetEdges().Num() != 2)
-                continue;
-            // 隣接する頂点が2つしかない頂点を探す
-            auto Neighbors = V->GetNeighborVertices();
-            if (Neighbors.Num() != 2)
+    // グループ毎に最初の頂点を残して中心に移動し, 他の頂点をそこに統合する
+    TArray<int32> VertexRemap;
+    VertexRemap.SetNumUninitialized(Graph.GetVertexCount());
+    for (auto V = 0; V < VertexRemap.Num(); V++)
+        VertexRemap[V] = V;
+    TArray<int32> Representatives;
+    Representatives.Init(INDEX_NONE, Centers.Num());
+    for (auto i = 0; i < Vertices.Num(); i++) {
+        auto& Representative = Representatives[VertexGroups[i]];
+        if (Representative == INDEX_NONE) {
+            Representative = Vertices[i];
+            Positions[Representative] = Centers[VertexGroups[i]];
+        }
+        else {
+            VertexRemap[Vertices[i]] = Representative;
+        }
+    }
+    Graph.MergeVertices(VertexRemap);
+
+    // a-b-cのような直線状の頂点を削除する.
+    // 頂点を削除すると自身と両隣の頂点の接続が変わるため, それらが他の削除と重ならない頂点をまとめて削除してグラフを作り直す.
+    // 重なって削除できなかった頂点と, 削除した頂点の両隣を次の回で再度確認する
+    const auto SqrLen = MidPointTolerance * MidPointTolerance;
+    TArray<int32> WorkList;
+    for (auto V = 0; V < Graph.GetVertexCount(); V++) {
+        if (Graph.GetVertexEdges(V).Num() > 0)
+            WorkList.Add(V);
+    }
+    TBitArray<> Locked(false, Graph.GetVertexCount());
+    TBitArray<> Queued(false, Graph.GetVertexCount());
+    TArray<int32> NextWorkList;
+    while (WorkList.Num() > 0) {
+        NextWorkList.Reset();
+        auto bMerged = false;
+        for (const auto V : WorkList) {
+            // 2つのエッジにしか繋がっていない頂点を探す(同じ頂点の組の辺は1つにまとまっているため, 隣接する頂点も2つ)
+            const auto Edges = Graph.GetVertexEdges(V);
+            if (Edges.Num() != 2)
                 continue;
+            const auto N0 = Graph.GetOppositeVertex(Edges[0], V);
+            const auto N1 = Graph.GetOppositeVertex(Edges[1], V);
             // 中間点があってもほぼ直線だった場合は中間点は削除する
-            auto segment = FLineSegment3D(Neighbors[0]->GetPosition(), Neighbors[1]->GetPosition());
-            auto p = segment.GetNearestPoint(V->GetPosition());
-            // とりあえずNeighbors[0]にマージする
-            if ((p - V->GetPosition()).SquaredLength() < SqrLen) {
-                V->MergeTo(Neighbors[0]);
-                Count++;
+            auto segment = FLineSegment3D(Positions[N0], Positions[N1]);
+            auto p = segment.GetNearestPoint(Positions[V]);
+            if ((p - Positions[V]).SquaredLength() >= SqrLen)
+                continue;
+            if (Locked[V] || Locked[N0] || Locked[N1]) {
+                NextWorkList.Add(V);
+                continue;
             }
+            Locked[V] = true;
+            Locked[N0] = true;
+            Locked[N1] = true;
+            // とりあえずN0にマージする
+            VertexRemap[V] = N0;
+            bMerged = true;
+            NextWorkList.Add(N0);
+            NextWorkList.Add(N1);
         }
-        if (Count == 0)
+        if (!bMerged)
             break;
-    }    
+        Graph.MergeVertices(VertexRemap);
+        Locked.SetRange(0, Locked.Num(), false);
+
+        WorkList.Reset();
+        for (const auto V : NextWorkList) {
+            if (Queued[V])
+                continue;
+            Queued[V] = true;
+            WorkList.Add(V);
+        }
+        for (const auto V : WorkList)
+            Queued[V] = false;
+    }
 }
 
 void FRGraphEx::EdgeReduction(RGraphRef_t<URGraph> Graph) {
@@ -182,6 +683,37 @@ void FRGraphEx::EdgeReduction(RGraphRef_t<URGraph> Graph) {
     }
 }
 
+void FRGraphEx::EdgeReduction(FRCompactGraph& Graph) {
+    // 辺の集合が同じ面は, 先の面に統合する
+    TArray<TArray<int32>> SortedFaceEdges;
+    SortedFaceEdges.SetNum(Graph.GetFaceCount());
+    TMap<uint32, TArray<int32>> HashToFaces;
+    TBitArray<> Merged(false, Graph.GetFaceCount());
+    auto bMerged = false;
+    for (auto Face = 0; Face < Graph.GetFaceCount(); Face++) {
+        const auto FaceEdges = Graph.GetFaceEdges(Face);
+        if (FaceEdges.Num() == 0)
+            continue;
+
+        auto& Sorted = SortedFaceEdges[Face];
+        Sorted.Append(FaceEdges.GetData(), FaceEdges.Num());
+        Sorted.Sort();
+        auto& SameHashFaces = HashToFaces.FindOrAdd(FCrc::MemCrc32(Sorted.GetData(), Sorted.Num() * sizeof(int32)));
+        if (Algo::AnyOf(SameHashFaces, [&](const int32 Other) { return SortedFaceEdges[Other] == Sorted; })) {
+            Merged[Face] = true;
+            bMerged = true;
+            continue;
+        }
+        SameHashFaces.Add(Face);
+    }
+    if (!bMerged)
+        return;
+
+    FilterCompactGraph(Graph
+        , [&Merged](const int32 Face) { return !Merged[Face]; }
+        , [](const int32 Face, const int32 FaceEdge) { return true; });
+}
+
 void FRGraphEx::MergeIsolatedVertices(RGraphRef_t<URGraph> Graph) {
     if (!Graph) return;
 
@@ -274,46 +806,22 @@ void FRGraphEx::InsertVertexInNearEdge(RGraphRef_t<URGraph> Graph, float Toleran
         return;
     auto Tolerance = ToleranceMeter * FPLATEAURnDef::Meter2Unit;
 
-    auto&& Vertices = Graph->GetAllVertices().Array();
-
-    constexpr auto Comp = FPLATEAURnDef::Vector3Comparer();
-
-    auto Comparer = [&](const RGraphRef_t<URVertex>& A, const RGraphRef_t<URVertex>& B) {
-        return Comp(A->Position, B->Position);
-        };
-    // #NOTE : UEのバグ？ ポインタのTArrayをソートしようとするとラムダ式にはポインタを消したうえで行う必要がある模様
-    Vertices.Sort([&](const URVertex& A, const URVertex& B)
-    {
-            return Comp(A.Position, B.Position) < 0;
-    });
-
-    TSet<RGraphRef_t<UREdge>> queue;
+    // 頂点を走査し, 走査中の辺(開始点が処理済みで終了点が未処理の辺)のうち頂点に近いものに頂点を挿入する
+    FRVertexSweep Sweep(Graph);
+    FREdgeGrid Grid(Sweep.Edges, Tolerance);
 
     TMap<RGraphRef_t<UREdge>, TSet<RGraphRef_t<URVertex>>> edgeInsertMap;
     auto Threshold = Tolerance * Tolerance;
 
-    for (auto i = 0; i < Vertices.Num(); i++) {
-        auto V = Vertices[i];
-        // 新規追加分
-        TArray<RGraphRef_t<UREdge>> addEdges;
-        TSet<RGraphRef_t<UREdge>> removeEdges;
-        for(auto&& E : V->GetEdges()) 
-        {
-            // vと反対側の点を見る
-            auto o = E->GetOppositeVertex(V);
-            auto d = Comparer(V, o);
-            // vが開始点の辺を追加する
-            if (d < 0)
-                addEdges.Add(E);
-            // vが終了点の辺を取り出す
-            else if (d > 0)
-                removeEdges.Add(E);
-        }
-        for(auto&& remove : removeEdges)
-            queue.Remove(remove);
-
-        for(auto e : queue) 
+    TArray<int32> candidates;
+    for (auto i = 0; i < Sweep.Vertices.Num(); i++) {
+        auto V = Sweep.Vertices[i];
+        Grid.QueryPoint(V->GetPosition(), candidates);
+        for (auto c : candidates) 
         {
+            if (!Sweep.IsActive(c, i))
+                continue;
+            auto e = Sweep.Edges[c];
             if (e->GetV0() == V || e->GetV1() == V)
                 continue;
 
@@ -324,9 +832,6 @@ void FRGraphEx::InsertVertexInNearEdge(RGraphRef_t<URGraph> Graph, float Toleran
                 edgeInsertMap.FindOrAdd(e).Add(V);
             }
         }
-
-        for(auto&& add : addEdges)
-            queue.Add(add);
     }
 
     for(auto&& e : edgeInsertMap) {
@@ -335,76 +840,104 @@ void FRGraphEx::InsertVertexInNearEdge(RGraphRef_t<URGraph> Graph, float Toleran
     }
 }
 
-void FRGraphEx::InsertVerticesInEdgeIntersection(RGraphRef_t<URGraph> Graph, float HeightToleranceMeter) {
-    if (!Graph) return;
+void FRGraphEx::InsertVertexInNearEdge(FRCompactGraph& Graph, float ToleranceMeter)
+{
+    auto Tolerance = ToleranceMeter * FPLATEAURnDef::Meter2Unit;
+    const auto& Positions = Graph.VertexPositions;
 
-    auto HeightTolerance = HeightToleranceMeter * FPLATEAURnDef::Meter2Unit;
+    // URGraph版と同じく, 頂点を走査し, 走査中の辺のうち頂点に近いものに頂点を挿入する
+    FRCompactVertexSweep Sweep(Graph);
+    FREdgeGrid Grid(Graph, Tolerance);
 
-    auto&& Vertices = Graph->GetAllVertices().Array();
+    TMap<int32, TArray<int32>> edgeInsertMap;
+    auto Threshold = Tolerance * Tolerance;
 
-    constexpr auto Comp = FPLATEAURnDef::Vector3Comparer();
+    TArray<int32> candidates;
+    for (auto i = 0; i < Sweep.Vertices.Num(); i++) {
+        auto V = Sweep.Vertices[i];
+        Grid.QueryPoint(Positions[V], candidates);
+        for (auto e : candidates)
+        {
+            if (!Sweep.IsActive(e, i))
+                continue;
+            if (Graph.EdgeV0[e] == V || Graph.EdgeV1[e] == V)
+                continue;
 
-    auto Comparer = [&](const RGraphRef_t<URVertex>& A, const RGraphRef_t<URVertex>& B) {
-        return Comp(A->Position, B->Position);
-        };
-    // #NOTE : UEのバグ？ ポインタのTArrayをソートしようとするとラムダ式にはポインタを消したうえで行う必要がある模様
-    Vertices.Sort([&](const URVertex& A, const URVertex& B) {
-        return Comp(A.Position, B.Position) < 0;
-        });
+            auto s = FLineSegment3D(Positions[Graph.EdgeV0[e]], Positions[Graph.EdgeV1[e]]);
+            auto near = s.GetNearestPoint(Positions[V]);
+            if ((near - Positions[V]).SquaredLength() < Threshold)
+            {
+                edgeInsertMap.FindOrAdd(e).AddUnique(V);
+            }
+        }
+    }
+    if (edgeInsertMap.IsEmpty())
+        return;
+
+    // V0 -> V1の順に並べた頂点で辺を分割し, 元の辺を持つ全ての面に追加する(UREdge::SplitEdgeと同じ)
+    for (auto&& e : edgeInsertMap) {
+        const auto& O = Positions[Graph.EdgeV0[e.Key]];
+        e.Value.Sort([&](const int32 A, const int32 B) {
+            return (Positions[A] - O).SquaredLength() < (Positions[B] - O).SquaredLength();
+            });
+    }
+
+    auto Result = Graph.CopyVertices();
+    for (auto Face = 0; Face < Graph.GetFaceCount(); Face++) {
+        Result.AddFaceFrom(Graph, Face);
+        for (const auto Edge : Graph.GetFaceEdges(Face)) {
+            auto Last = Graph.EdgeV0[Edge];
+            if (const auto Vertices = edgeInsertMap.Find(Edge)) {
+                for (const auto V : *Vertices) {
+                    Result.AddFaceEdge(Result.FindOrAddEdge(Last, V));
+                    Last = V;
+                }
+            }
+            Result.AddFaceEdge(Result.FindOrAddEdge(Last, Graph.EdgeV1[Edge]));
+        }
+    }
+    Result.BuildAdjacency();
+    Graph = MoveTemp(Result);
+}
+
+void FRGraphEx::InsertVerticesInEdgeIntersection(RGraphRef_t<URGraph> Graph, float HeightToleranceMeter) {
+    if (!Graph) return;
 
-    TSet<RGraphRef_t<UREdge>> queue;
+    auto HeightTolerance = HeightToleranceMeter * FPLATEAURnDef::Meter2Unit;
+
+    // 頂点を走査し, 終了点が頂点の辺と走査中の辺との交点を両方の辺に挿入する
+    FRVertexSweep Sweep(Graph);
+    FREdgeGrid Grid(Sweep.Edges, 1.0);
 
     TMap<RGraphRef_t<UREdge>, TSet<RGraphRef_t<URVertex>>> edgeInsertMap;
 
     TMap<FVector, RGraphRef_t<URVertex>> vertexMap;
-    for (auto i = 0; i < Vertices.Num(); i++) {
-        auto V = Vertices[i];
-        // 新規追加分
-        TArray<RGraphRef_t<UREdge>> addEdges;
-        TSet<RGraphRef_t<UREdge>> removeEdges;
-        for (auto&& E : V->GetEdges()) {
-            // vと反対側の点を見る
-            auto o = E->GetOppositeVertex(V);
-            auto d = Comparer(V, o);
-            // vが開始点の辺を追加する
-            if (d < 0)
-                addEdges.Add(E);
+    auto NearlyEqual = [](float a, float b) {
+        return FMath::Abs(a - b) < 1e-3f;
+        };
+    TArray<int32> candidates;
+    for (auto i = 0; i < Sweep.Vertices.Num(); i++) {
+        auto V = Sweep.Vertices[i];
+        for (auto&& e0 : V->GetEdges()) {
             // vが終了点の辺を取り出す
-            else if (d > 0)
-                removeEdges.Add(E);
-        }
-
-        auto NearlyEqual = [](float a, float b) {
-            return FMath::Abs(a - b) < 1e-3f;
-            };
-        TArray<RGraphRef_t<UREdge>> targets;
-        for(auto&& t : queue)
-        {
-            // vを端点に持つ辺は無視
-            if (t->GetV0() == V || t->GetV1() == V)
+            auto o = e0->GetOppositeVertex(V);
+            if (!o || FPLATEAURnDef::Vector3Comparer()(V->Position, o->Position) <= 0)
                 continue;
-            if (removeEdges.Contains(t))
-                continue;
-            targets.Add(t);
-        }
 
-        for(auto e0 : removeEdges) {
             auto s0 = FLineSegment3D(e0->GetV0()->GetPosition(), e0->GetV1()->GetPosition());
-            for(auto e1 : targets) {
+            Grid.QueryEdge(Sweep.EdgeIndices[e0], candidates);
+            for (auto c : candidates) {
+                if (!Sweep.IsActive(c, i))
+                    continue;
+                auto e1 = Sweep.Edges[c];
+                // vを端点に持つ辺は無視
+                if (e1->GetV0() == V || e1->GetV1() == V)
+                    continue;
                 auto s1 = FLineSegment3D(e1->GetV0()->GetPosition(), e1->GetV1()->Position);
                 // e0とe1が共有している頂点がある場合は無視
                 RGraphRef_t<URVertex> shareV;
-                if (e0->IsShareAnyVertex(e1, shareV)) {
-                    //auto (sv, s) = s0.Magnitude < s1.Magnitude
-                    //    ? (e0->GetOppositeVertex(shareV), s1)
-                    //    : (e1->GetOppositeVertex(shareV), s0);
-                    //if ((s.GetNearestPoint(sv.Position) - sv.Position).sqrMagnitude < shareMid)
-                    //{
-                    //    edgeInsertMap.GetValueOrCreate(e0).Add(sv);
-                    //}
-
+                if (e0->IsShareAnyVertex(e1, shareV))
                     continue;
-                }
                 FVector intersection;
                 float t1;
                 float t2;
@@ -422,13 +955,6 @@ void FRGraphEx::InsertVerticesInEdgeIntersection(RGraphRef_t<URGraph> Graph, flo
                 }
             }
         }
-
-        for (auto&& add : addEdges)
-            queue.Add(add);
-
-        for (auto&& remove : removeEdges)
-            queue.Remove(remove);
-
     }
 
     for (auto&& e : edgeInsertMap) {
@@ -472,6 +998,67 @@ void FRGraphEx::SeparateFaces(RGraphRef_t<URGraph> Graph) {
         SeparateFace(Face);
 }
 
+void FRGraphEx::SeparateFaces(FRCompactGraph& Graph)
+{
+    // 面の辺を頂点で繋がっている集合に分ける. 最初の辺を含む集合は元の面に残し, 他の集合は新しい面にする
+    struct FSeparatedFace {
+        int32 Face;
+        TArray<int32> Edges;
+    };
+    TArray<FSeparatedFace> SeparatedFaces;
+
+    // 面の頂点の統合先. 面毎に面の頂点のみ初期化して使う
+    TArray<int32> Parents;
+    Parents.SetNumUninitialized(Graph.GetVertexCount());
+    auto FindRoot = [&Parents](int32 X) {
+        while (Parents[X] != X) {
+            Parents[X] = Parents[Parents[X]];
+            X = Parents[X];
+        }
+        return X;
+        };
+
+    auto Result = Graph.CopyVertices();
+    TMap<int32, int32> RootToSeparatedFace;
+    for (auto Face = 0; Face < Graph.GetFaceCount(); Face++) {
+        Result.AddFaceFrom(Graph, Face);
+        const auto Edges = Graph.GetFaceEdges(Face);
+        if (Edges.Num() == 0)
+            continue;
+
+        for (const auto E : Edges) {
+            Parents[Graph.EdgeV0[E]] = Graph.EdgeV0[E];
+            Parents[Graph.EdgeV1[E]] = Graph.EdgeV1[E];
+        }
+        for (const auto E : Edges)
+            Parents[FindRoot(Graph.EdgeV0[E])] = FindRoot(Graph.EdgeV1[E]);
+
+        const auto FirstRoot = FindRoot(Graph.EdgeV0[Edges[0]]);
+        RootToSeparatedFace.Reset();
+        for (const auto E : Edges) {
+            const auto Root = FindRoot(Graph.EdgeV0[E]);
+            if (Root == FirstRoot) {
+                Result.AddFaceEdge(Result.FindOrAddEdge(Graph.EdgeV0[E], Graph.EdgeV1[E]));
+                continue;
+            }
+            auto Separated = RootToSeparatedFace.Find(Root);
+            if (!Separated)
+                Separated = &RootToSeparatedFace.Add(Root, SeparatedFaces.Add({ Face, {} }));
+            SeparatedFaces[*Separated].Edges.Add(E);
+        }
+    }
+    if (SeparatedFaces.Num() == 0)
+        return;
+
+    for (const auto& Separated : SeparatedFaces) {
+        Result.AddFaceFrom(Graph, Separated.Face);
+        for (const auto E : Separated.Edges)
+            Result.AddFaceEdge(Result.FindOrAddEdge(Graph.EdgeV0[E], Graph.EdgeV1[E]));
+    }
+    Result.BuildAdjacency();
+    Graph = MoveTemp(Result);
+}
+
 void FRGraphEx::SeparateFace(RGraphRef_t<URFace> Face)
 {
     // コピーする
@@ -668,6 +1255,56 @@ void FRGraphEx::RemoveIsolatedEdgeFromFace(RGraphRef_t<URGraph> Self)
     }
 }
 
+void FRGraphEx::RemoveIsolatedEdgeFromFace(FRCompactGraph& Self)
+{
+    // 面毎に, どちらかの頂点が他の面の辺と繋がっていない辺を取り除く.
+    // 辺を取り除くと隣の辺も孤立する場合があるため, 取り除く辺がなくなるまで繰り返す(取り除く順序によらず結果は同じ)
+    TBitArray<> Removed(false, Self.FaceEdges.Num());
+    TBitArray<> KeepFaces(false, Self.GetFaceCount());
+    // 面の辺のうち頂点に繋がっている辺の数. 面毎に面の頂点のみ使い, 0に戻す
+    TArray<int32> Degrees;
+    Degrees.Init(0, Self.GetVertexCount());
+    auto bRemoved = false;
+    for (auto Face = 0; Face < Self.GetFaceCount(); Face++) {
+        const auto Begin = Self.FaceEdgeOffsets[Face];
+        const auto End = Self.FaceEdgeOffsets[Face + 1];
+        for (auto i = Begin; i < End; i++) {
+            Degrees[Self.EdgeV0[Self.FaceEdges[i]]]++;
+            Degrees[Self.EdgeV1[Self.FaceEdges[i]]]++;
+        }
+
+        auto bChanged = true;
+        while (bChanged) {
+            bChanged = false;
+            for (auto i = Begin; i < End; i++) {
+                const auto Edge = Self.FaceEdges[i];
+                if (Removed[i] || (Degrees[Self.EdgeV0[Edge]] > 1 && Degrees[Self.EdgeV1[Edge]] > 1))
+                    continue;
+                Removed[i] = true;
+                Degrees[Self.EdgeV0[Edge]]--;
+                Degrees[Self.EdgeV1[Edge]]--;
+                bChanged = bRemoved = true;
+            }
+        }
+
+        for (auto i = Begin; i < End; i++) {
+            Degrees[Self.EdgeV0[Self.FaceEdges[i]]] = 0;
+            Degrees[Self.EdgeV1[Self.FaceEdges[i]]] = 0;
+            if (!Removed[i])
+                KeepFaces[Face] = true;
+        }
+        // 辺を持たない面は削除する
+        if (!KeepFaces[Face])
+            bRemoved = true;
+    }
+    if (!bRemoved)
+        return;
+
+    FilterCompactGraph(Self
+        , [&KeepFaces](const int32 Face) { return static_cast<bool>(KeepFaces[Face]); }
+        , [&Removed](const int32 Face, const int32 FaceEdge) { return !Removed[FaceEdge]; });
+}
+
 TSet<RGraphRef_t<UREdge>> FRGraphEx::RemoveIsolatedEdge(RGraphRef_t<URFace> Self)
 {
     auto IsIsolatedEdge = [Self](RGraphRef_t<UREdge> Edge) -> bool {
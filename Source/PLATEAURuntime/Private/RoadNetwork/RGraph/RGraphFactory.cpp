@@ -7,40 +7,30 @@
 #include "RoadNetwork/CityObject/SubDividedCityObject.h"
 #include "RoadNetwork/RGraph/RGraph.h"
 #include "RoadNetwork/RGraph/RGraphEx.h"
+#include "RoadNetwork/RGraph/RCompactGraph.h"
 
-namespace
+RGraphRef_t<URGraph> FRGraphFactoryEx::CreateGraph(const FRGraphFactory& Factory,
+    const TArray<FSubDividedCityObject>& CityObjects)
 {
-    struct FEdgeKey {
-        RGraphRef_t<URVertex> V0;
-        RGraphRef_t<URVertex> V1;
-
-        FEdgeKey(RGraphRef_t<URVertex> InV0, RGraphRef_t<URVertex> InV1)
-            : V0(InV0), V1(InV1)
-        {
-            if (V0 > V1) {
-                Swap(V0, V1);
-            }
-        }
-
-        bool operator==(const FEdgeKey& Other) const {
-            return (V0 == Other.V0 && V1 == Other.V1) || (V0 == Other.V1 && V1 == Other.V0);
-        }
+    auto Graph = CreateCompactGraph(Factory, CityObjects);
+    if (Factory.bOptAdjustSmallLodHeight) {
+        FRGraphEx::AdjustSmallLodHeight(Graph, Factory.MergeCellSize, Factory.MergeCellLength, Factory.RemoveMidPointTolerance);
+    }
+    // 同じ頂点を持つ辺はCreateCompactGraphで1つにまとめているため、最初のEdgeReductionは不要
+    if (!Factory.bOptimizeCompactGraph)
+        return Optimize(Factory, Graph.ToGraph());
 
-        friend uint32 GetTypeHash(const FEdgeKey& Key) {
-            return HashCombine(GetTypeHash(Key.V0), GetTypeHash(Key.V1));
-        }
-    };
+    // 要素毎にUObjectを作成するURGraphへの変換は、頂点・辺の削減と面の分割の後に1度だけ行う
+    Optimize(Factory, Graph);
+    return OptimizeFaces(Factory, Graph.ToGraph());
 }
 
-RGraphRef_t<URGraph> FRGraphFactoryEx::CreateGraph(const FRGraphFactory& Factory,
+FRCompactGraph FRGraphFactoryEx::CreateCompactGraph(const FRGraphFactory& Factory,
     const TArray<FSubDividedCityObject>& CityObjects)
 {
-    auto Graph = RGraphNew<URGraph>();
+    FRCompactGraph Graph;
 
-    TMap<FVector, RGraphRef_t<URVertex>> VertexMap;
-    TMap<FEdgeKey, RGraphRef_t<UREdge>> EdgeMap;
-    auto OrigVertexCount = 0;
-    auto OrigEdgeCount = 0;
+    TMap<FVector, int32> VertexMap;
     for (auto& CityObject : CityObjects) {
         if (CityObject.CityObjectGroup == nullptr) {
             continue;
@@ -51,45 +41,22 @@ RGraphRef_t<URGraph> FRGraphFactoryEx::CreateGraph(const FRGraphFactory& Factory
         // transformを適用する
         auto&& tr = CityObject.CityObjectGroup->GetComponentTransform();
         for (auto&& mesh : CityObject.Meshes) {
-            auto&& face = RGraphNew<URFace>(Graph, CityObject.CityObjectGroup.Get(), RoadType, LODLevel);
+            Graph.AddFace(CityObject.CityObjectGroup.Get(), RoadType, LODLevel);
 
-            TArray<RGraphRef_t<URVertex>> vertices;
+            TArray<int32> vertices;
+            vertices.Reserve(mesh.Vertices.Num());
             for (auto&& LocalPos : mesh.Vertices) {
                 auto WorldPos = tr.TransformPosition(LocalPos);
-
-                if (VertexMap.Contains(WorldPos) == false) {
-                    VertexMap.Add(WorldPos, RGraphNew<URVertex>(WorldPos));
+                if (const auto Found = VertexMap.Find(WorldPos)) {
+                    vertices.Add(*Found);
+                }
+                else {
+                    vertices.Add(VertexMap.Add(WorldPos, Graph.AddVertex(WorldPos)));
                 }
-
-                vertices.Add(VertexMap[WorldPos]);
             }
-            OrigVertexCount += mesh.Vertices.Num();
             for (auto&& s : mesh.SubMeshes) {
-                auto AddEdge = [&EdgeMap, &face, &OrigEdgeCount](RGraphRef_t<URVertex> V0, RGraphRef_t<URVertex> V1) {
-
-                    auto key = FEdgeKey(V0, V1);
-                    if (EdgeMap.Contains(key) == false) {
-                        auto Found = false;
-                        for(auto& Pair : EdgeMap)
-                        {
-                            auto K = Pair.Key;
-
-                            if((K.V0 == V0 && K.V1 == V1)
-                                || (K.V0 == V1 && K.V1 == V0))
-                            {
-                                Found = true;
-                                break;
-                            }
-                        }
-
-                        if(Found)
-                        {
-                            auto Tmp = 0;
-                        }
-                        EdgeMap.Add(key, RGraphNew<UREdge>(key.V0, key.V1));
-                    }
-                    face->AddEdge(EdgeMap[key]);
-                    OrigEdgeCount++;
+                auto AddEdge = [&Graph](int32 V0, int32 V1) {
+                    Graph.AddFaceEdge(Graph.FindOrAddEdge(V0, V1));
                     };
 
                 if (Factory.bUseCityObjectOutline) {
@@ -107,11 +74,15 @@ RGraphRef_t<URGraph> FRGraphFactoryEx::CreateGraph(const FRGraphFactory& Factory
                         AddEdge(vertices[s.Triangles[i + 2]], vertices[s.Triangles[i]]);
                     }
                 }
-
             }
-            Graph->AddFace(face);
         }
     }
+    Graph.BuildAdjacency();
+    return Graph;
+}
+
+RGraphRef_t<URGraph> FRGraphFactoryEx::Optimize(const FRGraphFactory& Factory, RGraphRef_t<URGraph> Graph)
+{
 #if false
     auto CheckVertices = [&]() {
         auto Vertices = Graph->GetAllVertices().Array();
@@ -140,12 +111,34 @@ RGraphRef_t<URGraph> FRGraphFactoryEx::CreateGraph(const FRGraphFactory& Factory
         }
     };
 #endif
-    if (Factory.bOptAdjustSmallLodHeight) {
-        FRGraphEx::AdjustSmallLodHeight(Graph, Factory.MergeCellSize, Factory.MergeCellLength, Factory.RemoveMidPointTolerance);
+    if (Factory.bOptVertexReduction) {
+        FRGraphEx::VertexReduction(Graph, Factory.MergeCellSize, Factory.MergeCellLength, Factory.RemoveMidPointTolerance);
+    }
+    if (Factory.bOptRemoveIsolatedEdgeFromFace) {
+        FRGraphEx::RemoveIsolatedEdgeFromFace(Graph);
+    }
+    if (Factory.bOptEdgeReduction) {
+        FRGraphEx::EdgeReduction(Graph);
+    }
+    if (Factory.bOptInsertVertexInNearEdge) {
+        FRGraphEx::InsertVertexInNearEdge(Graph, Factory.RemoveMidPointTolerance);
     }
     if (Factory.bOptEdgeReduction) {
         FRGraphEx::EdgeReduction(Graph);
     }
+    if (Factory.bOptSeparateFaces) {
+        FRGraphEx::SeparateFaces(Graph);
+    }
+
+    if (Factory.bOptRemoveIsolatedEdgeFromFace) {
+        FRGraphEx::RemoveIsolatedEdgeFromFace(Graph);
+    }
+    return OptimizeFaces(Factory, Graph);
+}
+
+void FRGraphFactoryEx::Optimize(const FRGraphFactory& Factory, FRCompactGraph& Graph)
+{
+    // URGraph版のOptimizeと同じ順序で行う
     if (Factory.bOptVertexReduction) {
         FRGraphEx::VertexReduction(Graph, Factory.MergeCellSize, Factory.MergeCellLength, Factory.RemoveMidPointTolerance);
     }
@@ -164,11 +157,13 @@ RGraphRef_t<URGraph> FRGraphFactoryEx::CreateGraph(const FRGraphFactory& Factory
     if (Factory.bOptSeparateFaces) {
         FRGraphEx::SeparateFaces(Graph);
     }
-
     if (Factory.bOptRemoveIsolatedEdgeFromFace) {
         FRGraphEx::RemoveIsolatedEdgeFromFace(Graph);
     }
+}
 
+RGraphRef_t<URGraph> FRGraphFactoryEx::OptimizeFaces(const FRGraphFactory& Factory, RGraphRef_t<URGraph> Graph)
+{
     if (Factory.bOptModifySideWalkShape) {
         FRGraphEx::ModifySideWalkShape(Graph);
     }
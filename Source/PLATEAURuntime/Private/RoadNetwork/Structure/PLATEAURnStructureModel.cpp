@@ -46,4 +46,11 @@ UE::Tasks::TTask<APLATEAURnStructureModel*> APLATEAURnStructureModel::CreateRnMo
         });
     return CreateRnModelTask;
 #endif
-}
\ No newline at end of file
+}
+
+void APLATEAURnStructureModel::UpdateRnModel(APLATEAUInstancedCityModel* TargetActor)
+{
+    FRoadNetworkFactoryEx::UpdateRnModel(Factory, TargetActor, this);
+    //終了イベント通知
+    OnCreateRnModelFinished.Broadcast();
+}
@@ -2,6 +2,7 @@
 
 #include "Util/PLATEAUComponentUtil.h"
 #include "Util/PLATEAUGmlUtil.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
 #include <Misc/DefaultValueHelper.h>
 #include <PLATEAUImportSettings.h>
 #include "Internationalization/Regex.h"
@@ -9,11 +10,14 @@
 namespace {
     void GetRootCityObjectsRecursive(USceneComponent* SceneComponent, TArray<FPLATEAUCityObject>& RootCityObjects) {
         if (const auto& CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(SceneComponent)) {
-            const auto& AllRootCityObjects = CityObjectGroup->GetAllRootCityObjects();
+            const auto& AllRootCityObjects = CityObjectGroup->GetRootCityObjects();
             for (const auto& CityObject : AllRootCityObjects) {
                 RootCityObjects.Add(CityObject);
             }
         }
+        else if (const auto& InstancedGroup = Cast<UPLATEAUInstancedCityObjectGroup>(SceneComponent)) {
+            RootCityObjects.Append(InstancedGroup->GetRootCityObjects());
+        }
 
         for (const auto& AttachedComponent : SceneComponent->GetAttachChildren()) {
             GetRootCityObjectsRecursive(AttachedComponent, RootCityObjects);
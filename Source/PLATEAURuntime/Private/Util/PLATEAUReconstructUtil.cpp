@@ -8,17 +8,17 @@ TMap<FString, FPLATEAUCityObject> FPLATEAUReconstructUtil::CreateMapFromCityObje
     TMap<FString, FPLATEAUCityObject> OutCityObjMap;
     for (auto Comp : TargetCityObjectGroups) {
 
-        if (Comp->SerializedCityObjects.IsEmpty())
+        if (!Comp->HasSerializedCityObjects())
             continue;
 
-        for (auto CityObj : Comp->GetAllRootCityObjects()) {
+        for (const auto& CityObj : Comp->GetRootCityObjects()) {
             if (!Comp->OutsideParent.IsEmpty() && !OutCityObjMap.Contains(Comp->OutsideParent)) {
                 // 親を探す
                 TArray<USceneComponent*> Parents;
                 Comp->GetParentComponents(Parents);
                 for (const auto& Parent : Parents) {
                     if (Parent->GetName().Contains(Comp->OutsideParent)) {
-                        for (auto Pobj : Cast<UPLATEAUCityObjectGroup>(Parent)->GetAllRootCityObjects()) {
+                        for (const auto& Pobj : Cast<UPLATEAUCityObjectGroup>(Parent)->GetRootCityObjects()) {
                             OutCityObjMap.Add(Pobj.GmlID, Pobj);
                         }
                         break;
@@ -27,7 +27,7 @@ TMap<FString, FPLATEAUCityObject> FPLATEAUReconstructUtil::CreateMapFromCityObje
             }
 
             OutCityObjMap.Add(CityObj.GmlID, CityObj);
-            for (auto Child : CityObj.Children) {
+            for (const auto& Child : CityObj.Children) {
                 OutCityObjMap.Add(Child.GmlID, Child);
             }
         }
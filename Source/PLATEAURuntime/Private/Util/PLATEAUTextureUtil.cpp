@@ -0,0 +1,257 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Util/PLATEAUTextureUtil.h"
+#include "Async/ParallelFor.h"
+
+namespace {
+    // BGRA8の1画素を16bit x 4レーンに展開(B, R, G, Aの順)
+    FORCEINLINE uint64 ExpandPixel(const uint32 Pixel) {
+        return static_cast<uint64>(Pixel & 0x00FF00FFu) | (static_cast<uint64>(Pixel & 0xFF00FF00u) << 24);
+    }
+
+    FORCEINLINE uint32 PackPixel(const uint64 Lanes) {
+        return static_cast<uint32>(Lanes & 0x00FF00FFull) | static_cast<uint32>((Lanes >> 24) & 0xFF00FF00ull);
+    }
+
+    FORCEINLINE uint16 ToRGB565(const int32 R, const int32 G, const int32 B) {
+        return static_cast<uint16>(((R * 31 + 127) / 255) << 11 | ((G * 63 + 127) / 255) << 5 | ((B * 31 + 127) / 255));
+    }
+
+    FORCEINLINE void FromRGB565(const uint16 Color, int32* OutRGB) {
+        const int32 R = (Color >> 11) & 31;
+        const int32 G = (Color >> 5) & 63;
+        const int32 B = Color & 31;
+        OutRGB[0] = (R << 3) | (R >> 2);
+        OutRGB[1] = (G << 2) | (G >> 4);
+        OutRGB[2] = (B << 3) | (B >> 2);
+    }
+
+    void WriteLittleEndian(uint8* Out, uint64 Value, const int32 ByteCount) {
+        for (int32 i = 0; i < ByteCount; ++i) {
+            Out[i] = static_cast<uint8>(Value & 0xFF);
+            Value >>= 8;
+        }
+    }
+
+    /**
+     * 4x4ブロックの色をBC1形式(8バイト)で書き込みます。
+     * 主成分方向へ射影した最小・最大の色を端点とします。
+     */
+    void EncodeColorBlock(const uint8 (&Block)[16][4], uint8* Out) {
+        // 画素はBGRAの順
+        float Mean[3] = { 0, 0, 0 };
+        for (int32 i = 0; i < 16; ++i) {
+            Mean[0] += Block[i][2];
+            Mean[1] += Block[i][1];
+            Mean[2] += Block[i][0];
+        }
+        for (float& Value : Mean)
+            Value /= 16.0f;
+
+        float Cov[6] = { 0, 0, 0, 0, 0, 0 };
+        for (int32 i = 0; i < 16; ++i) {
+            const float R = Block[i][2] - Mean[0];
+            const float G = Block[i][1] - Mean[1];
+            const float B = Block[i][0] - Mean[2];
+            Cov[0] += R * R;
+            Cov[1] += R * G;
+            Cov[2] += R * B;
+            Cov[3] += G * G;
+            Cov[4] += G * B;
+            Cov[5] += B * B;
+        }
+
+        // べき乗法で主成分方向を求める
+        float Axis[3] = { 1, 1, 1 };
+        for (int32 Iteration = 0; Iteration < 4; ++Iteration) {
+            const float X = Cov[0] * Axis[0] + Cov[1] * Axis[1] + Cov[2] * Axis[2];
+            const float Y = Cov[1] * Axis[0] + Cov[3] * Axis[1] + Cov[4] * Axis[2];
+            const float Z = Cov[2] * Axis[0] + Cov[4] * Axis[1] + Cov[5] * Axis[2];
+            const float Length = FMath::Max3(FMath::Abs(X), FMath::Abs(Y), FMath::Abs(Z));
+            if (Length < UE_KINDA_SMALL_NUMBER)
+                break;
+            Axis[0] = X / Length;
+            Axis[1] = Y / Length;
+            Axis[2] = Z / Length;
+        }
+
+        int32 MinIndex = 0;
+        int32 MaxIndex = 0;
+        float MinProjection = TNumericLimits<float>::Max();
+        float MaxProjection = TNumericLimits<float>::Lowest();
+        for (int32 i = 0; i < 16; ++i) {
+            const float Projection = Block[i][2] * Axis[0] + Block[i][1] * Axis[1] + Block[i][0] * Axis[2];
+            if (Projection < MinProjection) {
+                MinProjection = Projection;
+                MinIndex = i;
+            }
+            if (Projection > MaxProjection) {
+                MaxProjection = Projection;
+                MaxIndex = i;
+            }
+        }
+
+        // 端点を内側に寄せて量子化誤差を減らす
+        int32 MaxColor[3] = { Block[MaxIndex][2], Block[MaxIndex][1], Block[MaxIndex][0] };
+        int32 MinColor[3] = { Block[MinIndex][2], Block[MinIndex][1], Block[MinIndex][0] };
+        for (int32 Channel = 0; Channel < 3; ++Channel) {
+            const int32 Inset = (MaxColor[Channel] - MinColor[Channel]) / 16;
+            MaxColor[Channel] = FMath::Clamp(MaxColor[Channel] - Inset, 0, 255);
+            MinColor[Channel] = FMath::Clamp(MinColor[Channel] + Inset, 0, 255);
+        }
+
+        uint16 Color0 = ToRGB565(MaxColor[0], MaxColor[1], MaxColor[2]);
+        uint16 Color1 = ToRGB565(MinColor[0], MinColor[1], MinColor[2]);
+        // 4色モードにするため Color0 > Color1 とする
+        if (Color0 < Color1)
+            Swap(Color0, Color1);
+
+        uint32 Indices = 0;
+        if (Color0 != Color1) {
+            int32 Palette[4][3];
+            FromRGB565(Color0, Palette[0]);
+            FromRGB565(Color1, Palette[1]);
+            for (int32 Channel = 0; Channel < 3; ++Channel) {
+                Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+                Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+            }
+
+            for (int32 i = 0; i < 16; ++i) {
+                int32 BestIndex = 0;
+                int32 BestDistance = MAX_int32;
+                for (int32 PaletteIndex = 0; PaletteIndex < 4; ++PaletteIndex) {
+                    const int32 DR = Palette[PaletteIndex][0] - Block[i][2];
+                    const int32 DG = Palette[PaletteIndex][1] - Block[i][1];
+                    const int32 DB = Palette[PaletteIndex][2] - Block[i][0];
+                    const int32 Distance = DR * DR + DG * DG + DB * DB;
+                    if (Distance < BestDistance) {
+                        BestDistance = Distance;
+                        BestIndex = PaletteIndex;
+                    }
+                }
+                Indices |= static_cast<uint32>(BestIndex) << (i * 2);
+            }
+        }
+
+        WriteLittleEndian(Out, Color0, 2);
+        WriteLittleEndian(Out + 2, Color1, 2);
+        WriteLittleEndian(Out + 4, Indices, 4);
+    }
+
+    /**
+     * 4x4ブロックのアルファをBC3のアルファブロック形式(8バイト)で書き込みます。
+     */
+    void EncodeAlphaBlock(const uint8 (&Block)[16][4], uint8* Out) {
+        int32 Alpha0 = 0;
+        int32 Alpha1 = 255;
+        for (int32 i = 0; i < 16; ++i) {
+            Alpha0 = FMath::Max<int32>(Alpha0, Block[i][3]);
+            Alpha1 = FMath::Min<int32>(Alpha1, Block[i][3]);
+        }
+
+        uint64 Bits = static_cast<uint64>(Alpha0) | (static_cast<uint64>(Alpha1) << 8);
+        if (Alpha0 > Alpha1) {
+            // 8段階モード
+            int32 Palette[8];
+            Palette[0] = Alpha0;
+            Palette[1] = Alpha1;
+            for (int32 i = 1; i < 7; ++i) {
+                Palette[i + 1] = ((7 - i) * Alpha0 + i * Alpha1) / 7;
+            }
+
+            for (int32 i = 0; i < 16; ++i) {
+                int32 BestIndex = 0;
+                int32 BestDistance = MAX_int32;
+                for (int32 PaletteIndex = 0; PaletteIndex < 8; ++PaletteIndex) {
+                    const int32 Distance = FMath::Abs(Palette[PaletteIndex] - Block[i][3]);
+                    if (Distance < BestDistance) {
+                        BestDistance = Distance;
+                        BestIndex = PaletteIndex;
+                    }
+                }
+                Bits |= static_cast<uint64>(BestIndex) << (16 + i * 3);
+            }
+        }
+
+        WriteLittleEndian(Out, Bits, 8);
+    }
+}
+
+void FPLATEAUTextureUtil::DownsampleBGRA8(const uint8* Src, const int32 SrcWidth, const int32 SrcHeight,
+    uint8* Dst, const int32 DstWidth, const int32 DstHeight) {
+    const uint32* SrcPixels = reinterpret_cast<const uint32*>(Src);
+    uint32* DstPixels = reinterpret_cast<uint32*>(Dst);
+
+    ParallelFor(DstHeight, [&](const int32 Y) {
+        const int32 Y0 = FMath::Min(Y * 2, SrcHeight - 1);
+        const int32 Y1 = FMath::Min(Y * 2 + 1, SrcHeight - 1);
+        const uint32* Row0 = SrcPixels + static_cast<int64>(Y0) * SrcWidth;
+        const uint32* Row1 = SrcPixels + static_cast<int64>(Y1) * SrcWidth;
+        uint32* DstRow = DstPixels + static_cast<int64>(Y) * DstWidth;
+        for (int32 X = 0; X < DstWidth; ++X) {
+            const int32 X0 = FMath::Min(X * 2, SrcWidth - 1);
+            const int32 X1 = FMath::Min(X * 2 + 1, SrcWidth - 1);
+            // 4画素の各チャンネルを16bitレーンで加算し、四捨五入して平均
+            const uint64 Sum = ExpandPixel(Row0[X0]) + ExpandPixel(Row0[X1]) + ExpandPixel(Row1[X0]) + ExpandPixel(Row1[X1])
+                + 0x0002000200020002ull;
+            DstRow[X] = PackPixel(Sum >> 2);
+        }
+        }, DstHeight < 64);
+}
+
+void FPLATEAUTextureUtil::BuildMipChain(const TArray64<uint8>& Mip0, const int32 Width, const int32 Height, TArray<TArray64<uint8>>& OutMipChain) {
+    OutMipChain.Reset();
+
+    const uint8* Src = Mip0.GetData();
+    int32 SrcWidth = Width;
+    int32 SrcHeight = Height;
+    while (SrcWidth > 1 || SrcHeight > 1) {
+        const int32 DstWidth = FMath::Max(1, SrcWidth / 2);
+        const int32 DstHeight = FMath::Max(1, SrcHeight / 2);
+        auto& Mip = OutMipChain.AddDefaulted_GetRef();
+        Mip.SetNumUninitialized(static_cast<int64>(DstWidth) * DstHeight * 4);
+        DownsampleBGRA8(Src, SrcWidth, SrcHeight, Mip.GetData(), DstWidth, DstHeight);
+
+        Src = Mip.GetData();
+        SrcWidth = DstWidth;
+        SrcHeight = DstHeight;
+    }
+}
+
+bool FPLATEAUTextureUtil::HasTransparentPixel(const TArray64<uint8>& Image) {
+    for (int64 Index = 3; Index < Image.Num(); Index += 4) {
+        if (Image[Index] != 255)
+            return true;
+    }
+    return false;
+}
+
+void FPLATEAUTextureUtil::CompressBC(const uint8* Image, const int32 Width, const int32 Height, const bool bWithAlpha, TArray64<uint8>& OutBlocks) {
+    const int32 BlockCountX = FMath::DivideAndRoundUp(Width, 4);
+    const int32 BlockCountY = FMath::DivideAndRoundUp(Height, 4);
+    const int32 BlockBytes = bWithAlpha ? 16 : 8;
+    OutBlocks.SetNumUninitialized(static_cast<int64>(BlockCountX) * BlockCountY * BlockBytes);
+
+    ParallelFor(BlockCountY, [&](const int32 BlockY) {
+        uint8 Block[16][4];
+        for (int32 BlockX = 0; BlockX < BlockCountX; ++BlockX) {
+            // 画像の端を超える画素は端の画素で埋める
+            for (int32 PixelY = 0; PixelY < 4; ++PixelY) {
+                const int32 Y = FMath::Min(BlockY * 4 + PixelY, Height - 1);
+                for (int32 PixelX = 0; PixelX < 4; ++PixelX) {
+                    const int32 X = FMath::Min(BlockX * 4 + PixelX, Width - 1);
+                    FMemory::Memcpy(Block[PixelY * 4 + PixelX], Image + (static_cast<int64>(Y) * Width + X) * 4, 4);
+                }
+            }
+
+            uint8* Out = OutBlocks.GetData() + (static_cast<int64>(BlockY) * BlockCountX + BlockX) * BlockBytes;
+            if (bWithAlpha) {
+                EncodeAlphaBlock(Block, Out);
+                EncodeColorBlock(Block, Out + 8);
+            }
+            else {
+                EncodeColorBlock(Block, Out);
+            }
+        }
+        }, BlockCountY < 16);
+}
@@ -0,0 +1,56 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "PLATEAUFeatureTypeTable.generated.h"
+
+namespace citygml {
+    class CityModel;
+}
+
+/**
+ * @brief GMLファイル内の全シティオブジェクトのGML IDから地物タイプへの表です。
+ * 属性情報を含めずにインポートした場合にAPLATEAUInstancedCityModelに保存し、地物タイプによるフィルタリング時にGMLファイルを再度パースせずに済むようにします。
+ * GML IDはUTF-8のバイト順にソートして連結し、二分探索で検索します。
+ */
+USTRUCT()
+struct PLATEAURUNTIME_API FPLATEAUFeatureTypeTable {
+    GENERATED_USTRUCT_BODY()
+
+public:
+    /**
+     * @brief CityModel内の全シティオブジェクトについて表を作成します。同じGML IDが複数ある場合は先に見つかったものを使用します。
+     */
+    static FPLATEAUFeatureTypeTable Create(const citygml::CityModel& CityModel);
+
+    /**
+     * @brief GML IDの地物タイプ(citygml::CityObject::CityObjectsType)を検索します。
+     * @return 見つからない場合はfalse
+     */
+    bool TryGetType(const FString& GmlID, int64& OutType) const;
+
+    int32 Num() const {
+        return Types.Num();
+    }
+
+    bool IsEmpty() const {
+        return Types.IsEmpty();
+    }
+
+    SIZE_T GetAllocatedSize() const {
+        return GmlIDBytes.GetAllocatedSize() + GmlIDEnds.GetAllocatedSize() + Types.GetAllocatedSize();
+    }
+
+    // ソート済みのGML IDを連結したUTF-8のバイト列
+    UPROPERTY()
+        TArray<uint8> GmlIDBytes;
+
+    // 各GML IDの終端オフセット
+    UPROPERTY()
+        TArray<int32> GmlIDEnds;
+
+    UPROPERTY()
+        TArray<int64> Types;
+};
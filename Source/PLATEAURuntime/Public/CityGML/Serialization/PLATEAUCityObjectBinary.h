@@ -0,0 +1,147 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CityGML/PLATEAUCityObject.h"
+
+/**
+ * @brief FStringのキーは既定で大文字小文字を区別しないため、GML IDや文字列テーブルなど区別が必要なマップのキーに使用します。
+ */
+template <typename ValueType>
+struct TPLATEAUCaseSensitiveStringKeyFuncs : TDefaultMapKeyFuncs<FString, ValueType, false> {
+    static bool Matches(const FString& A, const FString& B) {
+        return A.Equals(B, ESearchCase::CaseSensitive);
+    }
+
+    static uint32 GetKeyHash(const FString& Key) {
+        return FCrc::StrCrc32(*Key);
+    }
+};
+
+/**
+ * @brief シティオブジェクト情報のバイナリ形式です。UPLATEAUCityObjectGroupはJSONの代わりにこの形式で属性情報を保持します。
+ *
+ * 構成(リトルエンディアン、各セクションは8バイト境界に揃えます):
+ *   ヘッダ         : Magic, Version, 各テーブルの要素数, OutsideParent
+ *   OutsideChildren: 文字列番号の配列
+ *   文字列テーブル : 各文字列の終端オフセットとUTF-8のバイト列。GML ID・属性キー・属性値を重複なく格納します
+ *   オブジェクト表 : 固定長のレコード(GML ID, インデックス, 種類, 属性の範囲, 子の範囲)。ルートを先頭に格納し、子は連続して格納します
+ *   属性列         : キー, 型, 参照(文字列番号または入れ子の属性の先頭), 入れ子の属性数, 数値 の列毎の配列
+ *
+ * インスタンスはバイト列への参照のみを保持し、FPLATEAUCityObjectのツリーを作らずに検索・参照できます。
+ * 参照先のバイト列が変更・解放されると無効になります。
+ */
+class PLATEAURUNTIME_API FPLATEAUCityObjectBinary {
+public:
+    static constexpr uint32 Magic = 0x424F4350; // "PCOB"
+    static constexpr uint32 Version = 1;
+
+    /**
+     * @brief ルートのシティオブジェクトをバイナリ形式で書き出します。
+     */
+    static void Write(const TArray<FPLATEAUCityObject>& RootCityObjects, const FString& OutsideParent, const TArray<FString>& OutsideChildren, TArray<uint8>& OutBytes);
+
+    /**
+     * @brief シリアライズ済みのJSON(旧形式のUPLATEAUCityObjectGroup::SerializedCityObjects)をバイナリ形式に変換します。
+     * @return JSONとして読み込めない場合はfalse
+     */
+    static bool FromJson(const FString& SerializedCityObjects, TArray<uint8>& OutBytes);
+
+    /**
+     * @brief 一度検証済みのバイト列からビューを作成します。ヘッダ以外の範囲の検証を省略します。
+     * 同じバイト列を繰り返し参照する場合に使用してください。
+     */
+    static FPLATEAUCityObjectBinary FromValidatedBytes(const TConstArrayView<uint8> InBytes);
+
+    FPLATEAUCityObjectBinary() = default;
+    // 全レコードの範囲を検証し、不正な場合は無効なビューになります
+    explicit FPLATEAUCityObjectBinary(const TConstArrayView<uint8> InBytes);
+
+    // ヘッダとテーブルの範囲が正しい場合true
+    bool IsValid() const {
+        return Header != nullptr;
+    }
+
+    int32 GetObjectCount() const;
+    int32 GetRootCount() const;
+
+    FString GetOutsideParent() const;
+    TArray<FString> GetOutsideChildren() const;
+
+    /**
+     * @brief インデックスが一致するシティオブジェクトの番号を返します。
+     * @return 見つからない場合はINDEX_NONE
+     */
+    int32 FindByIndex(const FPLATEAUCityObjectIndex& Index) const;
+
+    /**
+     * @brief GML IDが一致するシティオブジェクトの番号を返します。
+     * @return 見つからない場合はINDEX_NONE
+     */
+    int32 FindByGmlID(const FString& GmlID) const;
+
+    FString GetGmlID(const int32 Object) const;
+    FPLATEAUCityObjectIndex GetCityObjectIndex(const int32 Object) const;
+    EPLATEAUCityObjectsType GetType(const int32 Object) const;
+    int32 GetChildCount(const int32 Object) const;
+    int32 GetChild(const int32 Object, const int32 ChildIndex) const;
+
+    /**
+     * @brief シティオブジェクトの属性をキーで検索します。入れ子の属性は対象外です。
+     * @return 見つからない場合はfalse
+     */
+    bool TryGetAttribute(const int32 Object, const FString& Key, FPLATEAUAttributeValue& OutValue) const;
+
+    // 子を含むシティオブジェクトを作成します
+    FPLATEAUCityObject ToCityObject(const int32 Object) const;
+    void ToCityObjects(TArray<FPLATEAUCityObject>& OutRootCityObjects) const;
+
+    // 旧形式のUPLATEAUCityObjectGroup::SerializedCityObjectsと同じ形式のJSONを作成します
+    FString ToJson() const;
+
+    struct FHeader {
+        uint32 Magic;
+        uint32 Version;
+        int32 StringCount;
+        int32 StringBytes;
+        int32 ObjectCount;
+        int32 RootCount;
+        int32 AttributeCount;
+        int32 OutsideParent;
+        int32 OutsideChildrenCount;
+        int32 Reserved;
+    };
+
+    struct FObjectRecord {
+        int32 GmlID;
+        int32 PrimaryIndex;
+        int32 AtomicIndex;
+        int32 Type;
+        int32 FirstAttribute;
+        int32 AttributeCount;
+        int32 FirstChild;
+        int32 ChildCount;
+    };
+
+private:
+    static const FHeader* GetHeader(const TConstArrayView<uint8> InBytes);
+    void Bind(const uint8* Data);
+
+    FString GetString(const int32 String) const;
+    bool EqualsString(const int32 String, const ANSICHAR* Utf8, const int32 Length) const;
+    double GetAttributeNumber(const int32 Attribute) const;
+    void GetAttributeMap(const int32 FirstAttribute, const int32 AttributeCount, FPLATEAUAttributeMap& OutAttributeMap) const;
+    FPLATEAUAttributeValue GetAttributeValue(const int32 Attribute) const;
+
+    const FHeader* Header = nullptr;
+    const int32* OutsideChildren = nullptr;
+    const int32* StringEnds = nullptr;
+    const ANSICHAR* StringBytes = nullptr;
+    const FObjectRecord* Objects = nullptr;
+    const int32* AttributeKeys = nullptr;
+    const uint8* AttributeTypes = nullptr;
+    const int32* AttributeRefs = nullptr;
+    const int32* AttributeCounts = nullptr;
+    const uint8* AttributeNumbers = nullptr;
+};
@@ -19,6 +19,12 @@ public:
 
     void DeserializeCityObjects(const FString InSerializedCityObjects, const TArray<TObjectPtr<USceneComponent>> InAttachChildren, TArray<FPLATEAUCityObject>& OutRootCityObjects, FString& OutOutsideParent );
 
+    /**
+    * @brief 子コンポーネントを参照せずにJsonをデシリアライズ
+    * @return Jsonとして読み込めない場合はfalse
+    */
+    bool DeserializeCityObjects(const FString& InSerializedCityObjects, TArray<FPLATEAUCityObject>& OutRootCityObjects, FString& OutOutsideParent, TArray<FString>& OutOutsideChildren);
+
 protected:
 
     /**
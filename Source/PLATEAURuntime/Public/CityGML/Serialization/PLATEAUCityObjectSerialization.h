@@ -9,7 +9,7 @@
 #include "CityGML/PLATEAUCityObject.h"
 
 /**
-* @brief FPLATEAUCityObjectをJsonにシリアライズ
+* @brief FPLATEAUCityObjectをFPLATEAUCityObjectBinary形式にシリアライズ
 * 
 */
 class PLATEAURUNTIME_API FPLATEAUCityObjectSerialization : public IPLATEAUCityObjectSerializationBase {
@@ -23,27 +23,24 @@ public:
      * @param Granularity メッシュの結合単位を確認するために用いる
      * @param CityObjMap 結合・分割前に保存したFPLATEAUCityObjectのMap
      */
-    FString SerializeCityObject(const FString& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const plateau::polygonMesh::MeshGranularity& Granularity, TMap<FString, FPLATEAUCityObject> CityObjMap);
+    TArray<uint8> SerializeCityObject(const FString& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const plateau::polygonMesh::MeshGranularity& Granularity, const TMap<FString, FPLATEAUCityObject>& CityObjMap);
 
     /**
      * @brief 結合・分割時のメッシュを持たないノードをシリアライズ
      * @param InNode シリアライズ対象ノード
      * @param InCityObject 結合・分割前に保存したFPLATEAUCityObject
      */
-    FString SerializeCityObject(const plateau::polygonMesh::Node& InNode, const FPLATEAUCityObject& InCityObject);
+    TArray<uint8> SerializeCityObject(const plateau::polygonMesh::Node& InNode, const FPLATEAUCityObject& InCityObject);
 
     /**
      * @brief FPLATEAUCityObjectのシンプルなシリアライズ
      * @param InCityObject FPLATEAUCityObject
      */
-    FString SerializeCityObject(const FPLATEAUCityObject& InCityObject, const FString InOutsideParent, const TArray<FString> InOutsideChildren);
+    TArray<uint8> SerializeCityObject(const FPLATEAUCityObject& InCityObject, const FString InOutsideParent, const TArray<FString> InOutsideChildren);
 
 protected:
 
-    void GetAttributesJsonObjectRecursive(const FPLATEAUAttributeMap& InAttributesMap, TArray<TSharedPtr<FJsonValue>>& InAttributesJsonObjectArray);
-    TSharedRef<FJsonObject> GetCityJsonObject(const FPLATEAUCityObject& InCityObject);
-    TSharedRef<FJsonObject> GetCityJsonObject(const FPLATEAUCityObject& InCityObject, const plateau::polygonMesh::CityObjectIndex& CityObjectIndex);
-    TSharedRef<FJsonObject> GetCityJsonObjectWithChildren(const FPLATEAUCityObject& InCityObject);
+    // 子を含まないシティオブジェクトを作成
+    FPLATEAUCityObject GetCityObject(const FPLATEAUCityObject& InCityObject);
+    FPLATEAUCityObject GetCityObject(const FPLATEAUCityObject& InCityObject, const plateau::polygonMesh::CityObjectIndex& CityObjectIndex);
 };
-
-
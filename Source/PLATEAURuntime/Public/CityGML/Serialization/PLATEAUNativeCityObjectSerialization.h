@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "PLATEAUCityObjectSerializationBase.h"
 #include "CityGML/PLATEAUAttributeValue.h"
+#include "CityGML/PLATEAUCityObject.h"
 
 namespace plateau::polygonMesh {
     class Mesh;
@@ -19,20 +20,20 @@ namespace citygml
 }
 
 /**
-* @brief citygml::CityModelをJsonにシリアライズ
+* @brief citygml::CityModelをFPLATEAUCityObjectBinary形式にシリアライズ
 *
 */
 class PLATEAURUNTIME_API FPLATEAUNativeCityObjectSerialization : public IPLATEAUCityObjectSerializationBase {
 
 public:
 
-    FString SerializeCityObject(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const plateau::polygonMesh::MeshGranularity& Granularity, std::shared_ptr<const citygml::CityModel> InCityModel);
-    FString SerializeCityObject(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject, const plateau::polygonMesh::MeshGranularity& Granularity);
+    TArray<uint8> SerializeCityObject(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const plateau::polygonMesh::MeshGranularity& Granularity, std::shared_ptr<const citygml::CityModel> InCityModel);
+    TArray<uint8> SerializeCityObject(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject, const plateau::polygonMesh::MeshGranularity& Granularity);
 
 protected:
 
-    void GetAttributesJsonObjectRecursive(const citygml::AttributesMap& InAttributesMap, TArray<TSharedPtr<FJsonValue>>& InAttributesJsonObjectArray);
-    TSharedRef<FJsonObject> GetCityJsonObject(const citygml::CityObject* InCityObject);
-    TSharedRef<FJsonObject> GetCityJsonObject(const citygml::CityObject* InCityObject, const plateau::polygonMesh::CityObjectIndex& CityObjectIndex);
+    void GetAttributesRecursive(const citygml::AttributesMap& InAttributesMap, FPLATEAUAttributeMap& OutAttributeMap);
+    FPLATEAUCityObject GetCityObject(const citygml::CityObject* InCityObject);
+    FPLATEAUCityObject GetCityObject(const citygml::CityObject* InCityObject, const plateau::polygonMesh::CityObjectIndex& CityObjectIndex);
 
 };
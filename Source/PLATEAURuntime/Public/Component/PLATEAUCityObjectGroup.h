@@ -12,6 +12,8 @@
 #include "CityGML/Serialization/PLATEAUNativeCityObjectSerialization.h"
 #include "CityGML/Serialization/PLATEAUCityObjectSerialization.h"
 #include "CityGML/Serialization/PLATEAUCityObjectDeserialization.h"
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
+#include "PLATEAUMeshSourceData.h"
 #include "PLATEAUCityObjectGroup.generated.h"
 
 namespace plateau::CityObjectGroup {
@@ -88,6 +90,12 @@ public:
     void SerializeCityObject(const FString& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const plateau::granularityConvert::ConvertGranularity& Granularity, TMap<FString, FPLATEAUCityObject> CityObjMap);
     void SerializeCityObject(const FString& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const plateau::polygonMesh::MeshGranularity& Granularity, TMap<FString, FPLATEAUCityObject> CityObjMap);
 
+    /**
+     * @brief シリアライズ済みの属性情報を設定
+     * @param InSerializedCityObjects モデルキャッシュに保存されていたFPLATEAUCityObjectBinary形式の属性情報
+     */
+    void SetSerializedCityObjects(const TArray<uint8>& InSerializedCityObjects, const plateau::polygonMesh::MeshGranularity& Granularity);
+
     /**
      * @brief FPLATEAUCityObjectのシンプルなシリアライズ
      * @param InCityObject FPLATEAUCityObject
@@ -118,9 +126,72 @@ public:
     UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
     TArray<FPLATEAUCityObject> GetAllRootCityObjects();
 
-    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU")
+    /**
+     * @brief ルートのシティオブジェクトを複製せずに返します。属性情報を変更すると無効になります。
+     */
+    const TArray<FPLATEAUCityObject>& GetRootCityObjects();
+
+    /**
+     * @brief インデックスが一致するシティオブジェクトを返します。初回呼び出し時に検索用のマップを作成します。
+     * @return 見つからない場合はnullptr
+     */
+    const FPLATEAUCityObject* FindCityObjectByIndex(const FPLATEAUCityObjectIndex& Index);
+
+    /**
+     * @brief GML IDが完全一致するシティオブジェクトを返します。初回呼び出し時に検索用のマップを作成します。
+     * @return 見つからない場合はnullptr
+     */
+    const FPLATEAUCityObject* FindCityObjectByID(const FString& GmlID);
+
+    /**
+     * @brief 属性情報をFPLATEAUCityObjectのツリーを作らずに参照するためのビューを返します。
+     * バイト列の検証は読み込み時・移行時の一度のみ行います。属性情報を変更すると無効になります。
+     */
+    FPLATEAUCityObjectBinary GetCityObjectsBinary();
+
+    /**
+     * @brief 属性情報を旧形式のSerializedCityObjectsと同じJson形式で返します。表示・デバッグ用です。
+     */
+    UFUNCTION(BlueprintPure, meta = (Category = "PLATEAU|CityGML"))
+    FString GetSerializedCityObjectsJson();
+
+    /**
+     * @brief 属性情報を持つ場合true
+     */
+    bool HasSerializedCityObjects() const;
+
+    /**
+     * @brief 別のコンポーネントの属性情報を複製
+     */
+    void CopySerializedCityObjects(const UPLATEAUCityObjectGroup& Source);
+
+    virtual void PostLoad() override;
+
+    /**
+     * @brief StaticMeshの作成元のメッシュを返します。保存はされないため、保持していない場合はnullptrです。
+     */
+    const TSharedPtr<const FPLATEAUMeshSourceData, ESPMode::ThreadSafe>& GetMeshSourceData() const {
+        return MeshSourceData;
+    }
+
+    void SetMeshSourceData(const TSharedPtr<const FPLATEAUMeshSourceData, ESPMode::ThreadSafe>& InMeshSourceData) {
+        MeshSourceData = InMeshSourceData;
+    }
+
+    /**
+     * @brief 旧形式(Json)の属性情報です。
+     * 値が設定されている場合は読み込み時・参照時にSerializedCityObjectsBinaryに移行して空にするため、読み出しには使用できません。
+     * 属性情報のJsonはGetSerializedCityObjectsJsonで取得してください。
+     */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU", meta = (DeprecatedProperty, DeprecationMessage = "SerializedCityObjects is empty after migration. Use GetSerializedCityObjectsJson instead."))
     FString SerializedCityObjects;
 
+    /**
+     * @brief FPLATEAUCityObjectBinary形式の属性情報
+     */
+    UPROPERTY()
+    TArray<uint8> SerializedCityObjectsBinary;
+
     UPROPERTY(BlueprintReadOnly, Category = "PLATEAU")
     FString OutsideParent;
 
@@ -137,7 +208,24 @@ private:
     TArray<FPLATEAUCityObject> RootCityObjects;
     void SetMeshGranularity(const plateau::polygonMesh::MeshGranularity Granularity);
 
+    // シティオブジェクトのツリーと検索用のマップ。値はRootCityObjectsの要素を指す
+    bool bCityObjectCacheBuilt = false;
+    TMap<FPLATEAUCityObjectIndex, const FPLATEAUCityObject*> CityObjectIndexMap;
+    TMap<FString, const FPLATEAUCityObject*, FDefaultSetAllocator, TPLATEAUCaseSensitiveStringKeyFuncs<const FPLATEAUCityObject*>> CityObjectIdMap;
+    void BuildCityObjectCache();
+    void ResetCityObjectCache();
+
+    // シリアライズしたバイナリ形式の属性情報を検証済みとして保持
+    void SetSerializedCityObjectsBinary(TArray<uint8>&& InSerializedCityObjects);
+    // 旧形式の属性情報が設定されていればバイナリ形式に移行
+    void MigrateSerializedCityObjects();
+    // 移行後、未検証のバイナリ形式の属性情報を一度だけ検証し、不正な場合は破棄
+    void ValidateSerializedCityObjects();
+    bool bSerializedCityObjectsValidated = false;
+
     FPLATEAUNativeCityObjectSerialization CityModelSerializer;
     FPLATEAUCityObjectSerialization PlateauSerializer;
-    FPLATEAUCityObjectDeserialization Deserializer;
+
+    // 結合・分離時に描画用データを読み戻さないよう保持する作成元のメッシュ
+    TSharedPtr<const FPLATEAUMeshSourceData, ESPMode::ThreadSafe> MeshSourceData;
 };
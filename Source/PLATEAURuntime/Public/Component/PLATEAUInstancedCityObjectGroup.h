@@ -0,0 +1,115 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "PLATEAUComponentInterface.h"
+#include "CityGML/PLATEAUCityObject.h"
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
+#include "PLATEAUInstancedCityObjectGroup.generated.h"
+
+class UPLATEAUCityObjectGroup;
+
+/**
+ * @brief 同じ形状を持つ複数のノードをインスタンスとしてまとめたコンポーネントです。
+ * インポート時にインスタンス化を有効にした場合、UPLATEAUCityObjectGroupの代わりに使用します。
+ *
+ * 各インスタンスのカスタムデータ(0番目)には、このコンポーネントが保持するシティオブジェクトの番号を格納します。
+ * インスタンスの削除で番号が詰められても、カスタムデータから元のノード名・属性情報を参照できます。
+ * 他のLodに同じ名前の地物が存在するノードはインスタンス化しないため、Lodによるフィルタリングではコンポーネント単位で扱えます。
+ */
+UCLASS()
+class PLATEAURUNTIME_API UPLATEAUInstancedCityObjectGroup : public UHierarchicalInstancedStaticMeshComponent, public IPLATEAUComponentInterface {
+    GENERATED_BODY()
+
+public:
+    UPLATEAUInstancedCityObjectGroup(const FObjectInitializer& ObjectInitializer);
+
+    /**
+     * @brief コンポーネントのローカル座標でインスタンスを追加し、ノード名と属性情報(FPLATEAUCityObjectBinary形式、空の場合は属性情報なし)を関連付けます。
+     * 属性情報は追加時に検証し、不正な場合は属性情報なしとして扱います。
+     * @return 追加したインスタンスの番号
+     */
+    int32 AddCityObjectInstance(const FTransform& InstanceTransform, const FString& NodeName, const TArray<uint8>& SerializedCityObjects);
+
+    virtual void PostLoad() override;
+
+    /**
+     * @brief インスタンスに関連付けたシティオブジェクトの番号を返します。
+     * @return 見つからない場合はINDEX_NONE
+     */
+    int32 GetCityObjectEntry(const int32 InstanceIndex) const;
+
+    int32 GetCityObjectEntryCount() const {
+        return CityObjectNames.Num();
+    }
+
+    // インスタンスのノード名(インスタンス化しない場合のコンポーネント名)を返します
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+    FString GetInstanceNodeName(const int32 InstanceIndex) const;
+
+    /**
+     * @brief インスタンスの属性情報をFPLATEAUCityObjectのツリーを作らずに参照するためのビューを返します。
+     */
+    FPLATEAUCityObjectBinary GetCityObjectsBinary(const int32 InstanceIndex) const;
+
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+    FPLATEAUCityObject GetCityObjectByInstance(const int32 InstanceIndex) const;
+
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+    FPLATEAUCityObject GetPrimaryCityObjectByRaycast(const FHitResult& HitResult) const;
+
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+    FPLATEAUCityObject GetAtomicCityObjectByRaycast(const FHitResult& HitResult) const;
+
+    /**
+     * @brief 全シティオブジェクトのルートのシティオブジェクトを複製せずに返します。インスタンスを追加すると無効になります。
+     */
+    const TArray<FPLATEAUCityObject>& GetRootCityObjects();
+
+    /**
+     * @brief GML IDが完全一致するシティオブジェクトを返します。初回呼び出し時に検索用のマップを作成します。
+     * @return 見つからない場合はnullptr
+     */
+    const FPLATEAUCityObject* FindCityObjectByID(const FString& GmlID);
+
+    /**
+     * @brief 各インスタンスを同じStaticMesh・属性情報を持つUPLATEAUCityObjectGroupに置き換え、このコンポーネントを破棄します。
+     * 結合・分離等、UPLATEAUCityObjectGroup単位で処理する場合に使用します。ゲームスレッドから呼び出してください。
+     * @return 作成したコンポーネント
+     */
+    TArray<UPLATEAUCityObjectGroup*> ExpandInstancesInGameThread();
+
+    /**
+     * @brief MeshGranularityのintの値
+     */
+    UPROPERTY(BlueprintReadOnly, Category = "PLATEAU")
+    int MeshGranularityIntValue = 0;
+
+    // シティオブジェクト毎のノード名
+    UPROPERTY()
+    TArray<FString> CityObjectNames;
+
+    // シティオブジェクト毎の属性情報を8バイト境界に揃えて連結したバイト列
+    UPROPERTY()
+    TArray<uint8> SerializedCityObjectsBinary;
+
+    // シティオブジェクト毎の属性情報の開始・終端オフセット
+    UPROPERTY()
+    TArray<int32> SerializedCityObjectsBegins;
+
+    UPROPERTY()
+    TArray<int32> SerializedCityObjectsEnds;
+
+private:
+    // シティオブジェクトの属性情報のバイト列。範囲外の場合は空
+    TConstArrayView<uint8> GetSerializedCityObjects(const int32 Entry) const;
+
+    // シティオブジェクトのツリーと検索用のマップ。値はRootCityObjectsの要素を指す
+    bool bCityObjectCacheBuilt = false;
+    TArray<FPLATEAUCityObject> RootCityObjects;
+    TMap<FString, const FPLATEAUCityObject*, FDefaultSetAllocator, TPLATEAUCaseSensitiveStringKeyFuncs<const FPLATEAUCityObject*>> CityObjectIdMap;
+    void BuildCityObjectCache();
+    void ResetCityObjectCache();
+};
@@ -0,0 +1,26 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PLATEAUCityModelCellProxy.generated.h"
+
+/**
+ * @brief 3D都市モデルのセル内の地物を結合したプロキシ(遠景用のメッシュ)を保持するアクターです。
+ * APLATEAUInstancedCityModel::BuildSpatialCellsで生成されて3D都市モデルのアクターにアタッチされ、ClearSpatialCellsで破棄されます。
+ *
+ * プロキシを3D都市モデルのアクターとは別のアクターに置くことで、GMLファイル単位のコンポーネント構造を前提とする
+ * フィルタリング・エクスポート・分割結合の対象に含まれないようにしています。
+ */
+UCLASS()
+class PLATEAURUNTIME_API APLATEAUCityModelCellProxy : public AActor {
+    GENERATED_BODY()
+
+public:
+    APLATEAUCityModelCellProxy();
+
+    // プロキシが表すセルのコード
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        FString CellCode;
+};
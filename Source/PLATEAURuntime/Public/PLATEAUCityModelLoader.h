@@ -8,6 +8,12 @@
 #include "GameFramework/Actor.h"
 #include "PLATEAUGeometry.h"
 #include "PLATEAUImportSettings.h"
+#include "PLATEAUMaterialKeyTable.h"
+#include "PLATEAUTextureCache.h"
+#include "PLATEAUModelCache.h"
+#include "PLATEAUMemoryBudget.h"
+#include "PLATEAUImportScheduler.h"
+#include "PLATEAUImportProfiler.h"
 #include <plateau/network/client.h>
 
 #include "PLATEAUCityModelLoader.generated.h"
@@ -31,6 +37,23 @@ struct FLoadInputData {
     FString GmlPath;
     bool bIncludeAttrInfo;
     UMaterialInterface* FallbackMaterial;
+    // 0より大きい場合、Component作成をまとめてゲームスレッドのTick毎に実行します
+    int32 ComponentCreationBatchSize = 0;
+    float ComponentCreationTimeBudgetMs = 0.f;
+    // 同じ形状のメッシュをインスタンスとしてまとめます
+    bool bInstanceRepeatedMeshes = false;
+    // 作成したUPLATEAUCityObjectGroupに作成元のメッシュを保持します
+    bool bRetainMeshSourceData = false;
+    // インポート全体で共有するマテリアルキーのテーブル
+    TSharedPtr<FPLATEAUMaterialKeyTable, ESPMode::ThreadSafe> MaterialKeyTable;
+    // インポート全体で共有するテクスチャキャッシュ
+    TSharedPtr<FPLATEAUTextureCache, ESPMode::ThreadSafe> TextureCache;
+    // 抽出済みモデルのキャッシュ。無効な場合はnullptr
+    TSharedPtr<FPLATEAUModelCache, ESPMode::ThreadSafe> ModelCache;
+    // インポート全体で共有するメモリ予算。無制限の場合はnullptr
+    TSharedPtr<FPLATEAUMemoryBudget, ESPMode::ThreadSafe> MemoryBudget;
+    // インポート全体で共有するプロファイラ。計測しない場合はnullptr
+    TSharedPtr<FPLATEAUImportProfiler, ESPMode::ThreadSafe> Profiler;
 };
 
 UENUM(BlueprintType)
@@ -141,8 +164,8 @@ protected:
     virtual void BeginPlay() override;
 
     TAtomic<bool> bCanceled;
-
-    FCriticalSection LoadMeshSection;
+    // 実行中のインポートのスケジューラ。キャンセル時に開始前のGMLを即座に破棄するために保持する
+    TSharedPtr<FPLATEAUImportScheduler, ESPMode::ThreadSafe> ImportScheduler;
 
 public:
     // Called every frame
@@ -0,0 +1,62 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+
+/**
+ * @brief ワーカースレッドから積まれたゲームスレッド処理(Component作成、メッシュのコミット、マテリアル設定、アタッチ等)を
+ * ゲームスレッドのTick毎に一定数・一定時間ずつまとめて実行するコマンドバッファです。
+ *
+ * コマンドは積まれた順に実行されるため、後続のコマンドは先行するコマンドの結果(親Component等)を参照できます。
+ */
+class PLATEAURUNTIME_API FPLATEAUComponentCommandBuffer {
+public:
+    /**
+     * @param InBatchSize 1Tickで実行する最大コマンド数
+     * @param InTimeBudgetMs 1Tickで実行に費やす最大時間(ミリ秒)
+     */
+    FPLATEAUComponentCommandBuffer(const int32 InBatchSize, const float InTimeBudgetMs);
+    ~FPLATEAUComponentCommandBuffer();
+
+    FPLATEAUComponentCommandBuffer(const FPLATEAUComponentCommandBuffer&) = delete;
+    FPLATEAUComponentCommandBuffer& operator=(const FPLATEAUComponentCommandBuffer&) = delete;
+
+    /**
+     * @brief ゲームスレッドで実行するコマンドを積みます。
+     */
+    void Enqueue(TUniqueFunction<void()>&& Command);
+
+    /**
+     * @brief 積まれたコマンドがすべて実行されるまで待機します。
+     * ゲームスレッドから呼ばれた場合はその場で全て実行します。
+     */
+    void Flush();
+
+    int32 GetBatchSize() const {
+        return BatchSize;
+    }
+
+    float GetTimeBudgetMs() const {
+        return TimeBudgetMs;
+    }
+
+private:
+    struct FState {
+        TQueue<TUniqueFunction<void()>, EQueueMode::Mpsc> Commands;
+        TAtomic<int32> PendingCount{ 0 };
+        FEvent* DrainedEvent = nullptr;
+
+        FState();
+        ~FState();
+    };
+
+    static bool ExecuteBatch(FState& State, const int32 MaxCount, const double TimeBudgetSeconds);
+
+    int32 BatchSize;
+    float TimeBudgetMs;
+    TSharedRef<FState, ESPMode::ThreadSafe> State;
+    FTSTicker::FDelegateHandle TickerHandle;
+};
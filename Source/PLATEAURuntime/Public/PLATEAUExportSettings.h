@@ -44,7 +44,8 @@ struct FPLATEAUMeshExportOptions {
         , bExportTexture(true)
         , CoordinateSystem(ECoordinateSystem::ENU)
         , FileFormat(EMeshFileFormat::FBX)
-        , bExportAsBinary(false) {
+        , bExportAsBinary(false)
+        , bWeldVertices(false) {
     }
 
     UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ExportSettings")
@@ -64,6 +65,10 @@ struct FPLATEAUMeshExportOptions {
 
     UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ExportSettings")
     bool bExportAsBinary;
+
+    //! 位置・UV・都市オブジェクトのインデックスが同じ頂点を1つにまとめて出力します。
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ExportSettings")
+    bool bWeldVertices;
 };
 
 namespace plateau::Export {
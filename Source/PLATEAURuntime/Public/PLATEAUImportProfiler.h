@@ -0,0 +1,124 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// インポートの処理段階
+enum class EPLATEAUImportStage : uint8 {
+    // GML1つ分の処理全体
+    Import,
+    CopyGml,
+    ModelCache,
+    ParseGml,
+    ExtractMesh,
+    ConvertMesh,
+    CreateComponent,
+    CreateMaterial,
+    BuildMesh,
+    DecodeTexture,
+    Count
+};
+
+// インポートで処理した量
+enum class EPLATEAUImportCounter : uint8 {
+    Vertices,
+    Triangles,
+    Components,
+    Materials,
+    Textures,
+    Bytes,
+    // インスタンス化した形状の数
+    InstancedMeshes,
+    // インスタンス化したメッシュの数
+    Instances,
+    // インスタンス化により削減したドローコール数(マテリアル毎のセクション数)
+    SavedDrawCalls,
+    Count
+};
+
+/**
+ * @brief インポートの処理段階毎の時間と処理量を記録します。
+ * 記録はGML毎・パッケージ毎に集計され、インポート後にChromeのトレースイベント形式(chrome://tracing, Perfetto)のJSONと集計表として出力できます。
+ * 任意のスレッドから記録できます。
+ */
+class PLATEAURUNTIME_API FPLATEAUImportProfiler {
+public:
+    /**
+     * @brief スコープの開始から終了までの時間を記録します。Profilerがnullptrの場合は何もしません。
+     */
+    class PLATEAURUNTIME_API FScope {
+    public:
+        FScope(FPLATEAUImportProfiler* InProfiler, const EPLATEAUImportStage InStage, const FString& InGmlName);
+        ~FScope();
+
+        FScope(const FScope&) = delete;
+        FScope& operator=(const FScope&) = delete;
+
+    private:
+        FPLATEAUImportProfiler* Profiler;
+        EPLATEAUImportStage Stage;
+        FString GmlName;
+        double StartSeconds = 0.0;
+    };
+
+    FPLATEAUImportProfiler();
+
+    /**
+     * @brief GMLが属するパッケージを登録します。登録されていないGML、GML名が空の記録は"(shared)"として集計されます。
+     */
+    void RegisterGml(const FString& GmlName, const FString& PackageName);
+
+    void AddEvent(const EPLATEAUImportStage Stage, const FString& GmlName, const double StartSeconds, const double EndSeconds);
+    void AddCounter(const FString& GmlName, const EPLATEAUImportCounter Counter, const int64 Value);
+
+    static const TCHAR* GetStageName(const EPLATEAUImportStage Stage);
+    static const TCHAR* GetCounterName(const EPLATEAUImportCounter Counter);
+
+    // 処理段階の合計時間(秒)。GmlNameが空の場合は全GMLの合計
+    double GetStageSeconds(const EPLATEAUImportStage Stage, const FString& GmlName = FString()) const;
+    // 処理量の合計。GmlNameが空の場合は全GMLの合計
+    int64 GetCounter(const EPLATEAUImportCounter Counter, const FString& GmlName = FString()) const;
+
+    // Chromeのトレースイベント形式のJSONを返します
+    FString GetChromeTrace() const;
+    // パッケージ毎・GML毎の集計表を返します
+    FString GetSummaryTable() const;
+
+    /**
+     * @brief Chromeトレース(.json)と集計表(.txt)をDirectoryに出力します。
+     * @return 出力に成功した場合true
+     */
+    bool WriteReport(const FString& Directory, const FString& BaseName) const;
+
+private:
+    struct FTraceEvent {
+        EPLATEAUImportStage Stage;
+        int32 GmlIndex;
+        uint32 ThreadId;
+        double StartSeconds;
+        double EndSeconds;
+    };
+
+    struct FStats {
+        double StageSeconds[static_cast<int32>(EPLATEAUImportStage::Count)] = {};
+        int64 Counters[static_cast<int32>(EPLATEAUImportCounter::Count)] = {};
+
+        void Append(const FStats& Other);
+    };
+
+    struct FGmlStats {
+        FString PackageName;
+        FStats Stats;
+    };
+
+    FGmlStats& FindOrAddGml(const FString& GmlName, int32* OutGmlIndex = nullptr);
+
+    const double StartSeconds;
+
+    mutable FCriticalSection Section;
+    TArray<FString> GmlNames;
+    TMap<FString, int32> GmlNameToIndex;
+    TArray<FGmlStats> GmlStats;
+    TArray<FTraceEvent> Events;
+};
@@ -0,0 +1,98 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PLATEAUMemoryBudget.h"
+
+class FQueuedThreadPool;
+
+/**
+ * @brief インポートするGMLの処理を固定数のワーカースレッドで実行するスケジューラです。
+ *
+ * ジョブは積まれた順に、実行中のジョブ数がワーカー数未満かつ見積もりメモリ量をメモリ予算から確保できる場合に開始されます。
+ * ジョブの完了とメモリの返却はイベントで通知され、Runを呼んだスレッドはポーリングせずに待機します。
+ * Cancelを呼ぶと開始前のジョブは即座に破棄されます。
+ */
+class PLATEAURUNTIME_API FPLATEAUImportScheduler {
+public:
+    using FReservationPtr = TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe>;
+    // ワーカースレッドで実行する処理。確保したメモリはジョブ内でShrinkして早めに返却できます。
+    using FJob = TUniqueFunction<void(const FReservationPtr& Reservation)>;
+    // 開始前にキャンセルされた場合に呼ばれます
+    using FOnCanceled = TUniqueFunction<void()>;
+    // 実行中のジョブID一覧と完了したジョブ数を受け取ります。完了数には失敗したジョブと開始前にキャンセルされたジョブも含みます
+    using FOnProgress = TFunctionRef<void(const TArray<int32>& RunningJobIds, const int32 CompletedCount)>;
+
+    /**
+     * @param InNumWorkers ワーカースレッド数。0以下の場合はCPUのコア数
+     * @param InMemoryBudget 同時に実行するジョブの見積もりメモリ量の上限。nullptrの場合は空き物理メモリの半分
+     */
+    explicit FPLATEAUImportScheduler(const int32 InNumWorkers = 0, const TSharedPtr<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>& InMemoryBudget = nullptr);
+    ~FPLATEAUImportScheduler();
+
+    FPLATEAUImportScheduler(const FPLATEAUImportScheduler&) = delete;
+    FPLATEAUImportScheduler& operator=(const FPLATEAUImportScheduler&) = delete;
+
+    /**
+     * @brief ジョブを積みます。Run実行中にも呼べます。
+     * @param EstimatedBytes ジョブの見積もりメモリ量
+     * @return ジョブID(積んだ順の連番)
+     */
+    int32 Enqueue(const int64 EstimatedBytes, FJob&& Job, FOnCanceled&& OnCanceled = nullptr);
+
+    /**
+     * @brief 積まれたジョブがすべて完了またはキャンセルされるまで待機します。
+     * @param bExternalCanceled trueになった場合はCancelと同様に開始前のジョブを破棄します。
+     * @param OnProgress ジョブの開始・完了毎にRunを呼んだスレッドで呼ばれます。
+     */
+    void Run(const TAtomic<bool>* bExternalCanceled, FOnProgress OnProgress);
+
+    /**
+     * @brief 開始前のジョブを破棄し、Runの待機を解除します。実行中のジョブは完了まで待ちます。任意のスレッドから呼べます。
+     */
+    void Cancel();
+
+    int32 GetNumWorkers() const {
+        return NumWorkers;
+    }
+
+    // 同時に実行したジョブ数の最大値
+    int32 GetPeakRunningJobs() const;
+    // 同時に実行したジョブの見積もりメモリ量の最大値
+    int64 GetPeakBytes() const;
+
+    // 統計情報をログ出力用の文字列で返します
+    FString GetStatsString() const;
+
+private:
+    struct FPendingJob {
+        int32 JobId;
+        int64 EstimatedBytes;
+        FJob Job;
+        FOnCanceled OnCanceled;
+    };
+
+    class FWork;
+
+    void DispatchJobs();
+    void OnJobFinished(const int32 JobId);
+    void CancelPendingJobs();
+
+    const int32 NumWorkers;
+    TSharedRef<FPLATEAUMemoryBudget, ESPMode::ThreadSafe> MemoryBudget;
+    FQueuedThreadPool* ThreadPool = nullptr;
+    FEvent* WakeEvent = nullptr;
+
+    mutable FCriticalSection Section;
+    TArray<FPendingJob> PendingJobs;
+    int32 PendingHead = 0;
+    TArray<int32> RunningJobIds;
+    int32 NextJobId = 0;
+    // 実行を終えたジョブと開始前にキャンセルされたジョブの数
+    int32 CompletedCount = 0;
+    int32 CanceledCount = 0;
+    int32 PeakRunningJobs = 0;
+    bool bCanceled = false;
+    double WallSeconds = 0.0;
+};
@@ -6,6 +6,7 @@
 #include "CoreMinimal.h"
 #include "Materials/MaterialInterface.h"
 #include <plateau/dataset/city_model_package.h>
+#include "PLATEAUSpatialCellBuilder.h"
 #include "PLATEAUImportSettings.generated.h"
 
 #define LOCTEXT_NAMESPACE "PLATEAUImportSettings"
@@ -37,6 +38,16 @@ enum class EPLATEAUTexturePackingResolution : uint8 {
     H8192W8192 = 2 UMETA(DisplayName = "8192x8192")
 };
 
+UENUM(BlueprintType)
+enum class EPLATEAUTextureCompression : uint8 {
+    //! 非圧縮(BGRA8)
+    Uncompressed = 0 UMETA(DisplayName = "Uncompressed"),
+    //! アルファの有無に応じてBC1またはBC3
+    Auto = 1 UMETA(DisplayName = "Auto (BC1/BC3)"),
+    BC1 = 2 UMETA(DisplayName = "BC1 (DXT1)"),
+    BC3 = 3 UMETA(DisplayName = "BC3 (DXT5)")
+};
+
 UENUM(BlueprintType, meta = (Bitflags))
 enum class EPLATEAUCityModelPackage : uint8 {
     None = 0,
@@ -278,6 +289,47 @@ public:
     UPROPERTY(EditAnywhere, Category = "Import Settings")
         FPLATEAUFeatureImportSettings Unknown;
 
+    // ゲームスレッドで1Tickに作成するComponentの最大数。0以下の場合はComponent毎にゲームスレッドを待機します。
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance", meta = (ClampMin = 0, UIMin = 0))
+        int32 ComponentCreationBatchSize = 64;
+    // ゲームスレッドで1TickにComponent作成に費やす最大時間(ミリ秒)
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance", meta = (ClampMin = 0.1, UIMin = 0.1))
+        float ComponentCreationTimeBudgetMs = 8.0f;
+    // インポート時にテクスチャのミップマップを生成し、テクスチャストリーミングの対象とします
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance")
+        bool bGenerateTextureMips = false;
+    // インポート時のテクスチャ圧縮形式。圧縮はワーカースレッドで行います。
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance")
+        EPLATEAUTextureCompression TextureCompression = EPLATEAUTextureCompression::Uncompressed;
+    // 抽出済みのモデルをSaved/PLATEAU/ModelCacheに保存し、同じGML・設定での再インポート時にパースとメッシュ抽出を省略します
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance")
+        bool bUseModelCache = false;
+    // インポート中にGMLのパース・メッシュ変換に使用するメモリ量の上限(MB)。
+    // GMLはファイルサイズから見積もったメモリを確保できるまで開始を待機します。0の場合は空き物理メモリの半分を上限とします。
+    // 設定した場合、不要になったデータは処理中に解放します。
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance", meta = (ClampMin = 0, UIMin = 0))
+        int32 ImportMemoryBudgetMB = 0;
+    // GMLを並列に処理するワーカースレッド数。0の場合はCPUのコア数です。
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance", meta = (ClampMin = 0, UIMin = 0))
+        int32 ImportWorkerCount = 0;
+    // インポートの処理段階毎の時間と処理量を計測し、インポート後にSaved/PLATEAU/ImportProfileへChromeトレース(.json)と集計表(.txt)を出力します
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance")
+        bool bEnableImportProfiling = false;
+    // GML内で平行移動を除いて同じ形状・マテリアルを持つ末端のメッシュ(都市設備・植生・LOD1の建物等)を、UPLATEAUInstancedCityObjectGroupのインスタンスとしてまとめます。
+    // 作成するStaticMesh・コンポーネント・ドローコールを削減します。属性情報はインスタンス毎に保持します。
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance")
+        bool bInstanceRepeatedMeshes = false;
+    // 作成したコンポーネントに作成元のメッシュをメモリ上に保持し、結合・分離時に描画用データを読み戻さずに変換します。
+    // メッシュのメモリ使用量が増えます。保存はされないため、レベルを開き直した後は描画用データから変換します。
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance")
+        bool bRetainMeshSourceData = false;
+    // インポート完了後に3D都市モデルをメッシュコードの区画に揃えたセルに分割し、セル毎に遠景用のプロキシを生成します(APLATEAUInstancedCityModel::BuildSpatialCells)
+    // 遠景の描画コストを減らすもので、元の地物はアンロードされずプロキシの分だけメモリが増えます
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance")
+        bool bBuildSpatialCells = false;
+    UPROPERTY(EditAnywhere, Category = "Import Settings|Performance", meta = (EditCondition = "bBuildSpatialCells"))
+        FPLATEAUSpatialCellSettings SpatialCellSettings;
+
     FPLATEAUFeatureImportSettings GetFeatureSettings(plateau::dataset::PredefinedCityModelPackage Package) const {
         switch (Package) {
         case plateau::dataset::PredefinedCityModelPackage::Building: return Building;
@@ -9,6 +9,10 @@
 #include <plateau/polygon_mesh/model.h>
 #include <plateau/dataset/city_model_package.h>
 #include <PLATEAUImportSettings.h>
+#include <PLATEAUModelFilterIndex.h>
+#include "PLATEAURuntimeLodManager.h"
+#include "CityGML/PLATEAUFeatureTypeTable.h"
+#include "PLATEAUSpatialCellBuilder.h"
 #include "Tasks/Task.h"
 #include "Reconstruct/PLATEAUMeshLoaderForHeightmap.h"
 #include "PLATEAUInstancedCityModel.generated.h"
@@ -45,6 +49,7 @@ enum class EPLATEAULandscapeCreationResult : uint8 {
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnReconstructFinishedDelegate);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnClassifyFinishedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSpatialCellsBuiltDelegate);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLandscapeCreationFinishedDelegate, EPLATEAULandscapeCreationResult, Result);
 
 /**
@@ -81,6 +86,12 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "PLATEAU|BPLibraries")
     FOnLandscapeCreationFinishedDelegate OnLandscapeCreationFinished;
 
+    /**
+     * @brief セル分割・プロキシ生成処理終了イベント
+     */
+    UPROPERTY(BlueprintAssignable, Category = "PLATEAU|BPLibraries")
+    FOnSpatialCellsBuiltDelegate OnSpatialCellsBuilt;
+
     // Sets default values for this actor's properties
     APLATEAUInstancedCityModel();
 
@@ -102,6 +113,13 @@ public:
     UPROPERTY(EditAnywhere, Category = "PLATEAU")
         TArray<FString> GridCodes;
 
+    // 実行中に、地物毎に視点からの画面サイズに応じたLodを表示します。有効な場合はLodの範囲によるフィルタリングより優先されます。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|RuntimeLod")
+        bool bEnableRuntimeLod = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|RuntimeLod")
+        FPLATEAURuntimeLodSettings RuntimeLodSettings;
+
     UFUNCTION(BlueprintGetter)
         double GetLatitude();
 
@@ -114,6 +132,56 @@ public:
     UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
         TArray<FPLATEAUCityObject>& GetAllRootCityObjects();
 
+    /**
+     * @brief GML IDからシティオブジェクトとそれを持つコンポーネントを検索します。
+     * @return 見つからない場合はfalse
+     */
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+        bool GetCityObjectByGmlID(const FString& GmlID, UPLATEAUCityObjectGroup*& OutComponent, FPLATEAUCityObject& OutCityObject);
+
+    /**
+     * @brief GML IDからシティオブジェクトを検索します。初回呼び出し時にアクター内の全コンポーネントの索引を作成します。
+     * GML IDは大文字小文字を区別します。索引はインポートでコンポーネントが追加された時点で破棄されます。
+     * 同じGML IDを持つコンポーネントが複数ある場合(複数Lod等)は可視のコンポーネントを優先します。
+     * @param OutComponent シティオブジェクトを持つコンポーネント。インスタンス化されたコンポーネントで見つかった場合はnullptr
+     * @return 見つからない場合はnullptr
+     */
+    const FPLATEAUCityObject* FindCityObjectByGmlID(const FString& GmlID, UPLATEAUCityObjectGroup** OutComponent = nullptr);
+
+    /**
+     * @brief GML IDからシティオブジェクトを検索します。
+     * @param OutComponent シティオブジェクトを持つUPLATEAUCityObjectGroupまたはUPLATEAUInstancedCityObjectGroup
+     */
+    const FPLATEAUCityObject* FindCityObjectByGmlID(const FString& GmlID, USceneComponent*& OutComponent);
+
+    /**
+     * @brief GML IDの索引を破棄します。次回の検索時に作り直されます。
+     */
+    void InvalidateCityObjectIndex();
+
+    /**
+     * @brief フィルタリング用の索引と実行時のLod切り替えを破棄します。
+     * コンポーネントを追加・削除・再構築した場合はInvalidateCityObjectIndexと合わせて呼び出してください。
+     */
+    void InvalidateFilterIndex();
+
+    /**
+     * @brief フィルタリング用の索引を作成します。インポート完了時に呼び出されます。作成済みの場合は何もしません。
+     */
+    void BuildFilterIndex();
+
+    /**
+     * @brief GMLファイルの地物タイプの表を登録します。属性情報を含めずにインポートした場合にインポート時に呼び出されます。
+     * @param GmlFileName 拡張子付きのGMLファイル名
+     */
+    void AddFeatureTypeTable(const FString& GmlFileName, FPLATEAUFeatureTypeTable&& FeatureTypeTable);
+
+    /**
+     * @brief GMLファイルの地物タイプの表を返します。
+     * @return 登録されていない場合はnullptr
+     */
+    const FPLATEAUFeatureTypeTable* FindFeatureTypeTable(const FString& GmlFileName) const;
+
     /**
      * @brief パッケージ種を含むコンポーネントを返します
      */
@@ -140,7 +208,14 @@ public:
      * @return thisを返します。
      */
     APLATEAUInstancedCityModel* FilterByFeatureTypes(const citygml::CityObject::CityObjectsType InCityObjectType);
-    APLATEAUInstancedCityModel* FilterByFeatureTypesLegacy(const citygml::CityObject::CityObjectsType InCityObjectType); //属性情報がない場合Modelを取得して判定
+    APLATEAUInstancedCityModel* FilterByFeatureTypesLegacy(const citygml::CityObject::CityObjectsType InCityObjectType); //属性情報・地物タイプの表がない場合Modelを取得して判定
+
+    /**
+     * @brief FilterByLods, FilterByFeatureTypesを続けて呼んだ場合と同じ表示状態に変更します。
+     * 属性情報がある場合は表示状態の差分の反映を一度で行います。
+     * @return thisを返します。
+     */
+    APLATEAUInstancedCityModel* FilterByLodsAndFeatureTypes(const plateau::dataset::PredefinedCityModelPackage InPackage, const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod, const citygml::CityObject::CityObjectsType InCityObjectType);
 
     /**
      * @brief 3D都市モデル内に含まれるLodを取得します。
@@ -179,6 +254,40 @@ public:
      */
 	UE::Tasks::FTask CreateLandscape(const TArray<USceneComponent*>& TargetComponents, FPLATEAULandscapeParam Param, bool bDestroyOriginal);
 
+    /**
+     * @brief 視点からの画面サイズに従って、RuntimeLodSettingsの時間予算内で地物のLodを切り替えます。
+     * bEnableRuntimeLodが有効な場合、Tick毎にプレイヤーのカメラを視点として呼び出されます。
+     * @param FOVDegrees 水平方向の視野角
+     * @return 表示するLodを切り替えた地物数
+     */
+    int32 UpdateRuntimeLod(const FVector& ViewOrigin, const float FOVDegrees);
+
+    /**
+     * @brief 実行時のLod切り替えの集計を返します。
+     */
+    const FPLATEAURuntimeLodStats& GetRuntimeLodStats() const {
+        return RuntimeLod.GetStats();
+    }
+
+    /**
+     * @brief 3D都市モデルをメッシュコードの区画に揃えたセルに分割し、セル毎に遠景用のプロキシを生成します。
+     * 作成済みのセルは破棄して作り直します。分割・結合等でコンポーネントを作り直した場合は再度呼び出してください。
+     * @return セル分割・プロキシ生成の集計
+     */
+    UE::Tasks::TTask<FPLATEAUSpatialCellStats> BuildSpatialCells(const FPLATEAUSpatialCellSettings& Settings);
+
+    /**
+     * @brief セルとプロキシを破棄し、元の地物の描画距離を戻します。
+     */
+    void ClearSpatialCells();
+
+    /**
+     * @brief BuildSpatialCellsで作成したセルの一覧を返します。
+     */
+    const TArray<FPLATEAUSpatialCell>& GetSpatialCells() const {
+        return SpatialCells;
+    }
+
 protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
@@ -208,6 +317,11 @@ protected:
      */
     bool HasAttributeInfo();
 
+    /**
+     * @brief 全てのGMLファイル(起伏を除く)について地物タイプの表があるかどうかを取得します。
+     */
+    bool HasFeatureTypeTables() const;
+
 public:
     // Called every frame
     virtual void Tick(float DeltaTime) override;
@@ -215,4 +329,25 @@ public:
 private:
     TAtomic<bool> bIsFiltering;
     TArray<FPLATEAUCityObject> RootCityObjects;
+
+    // GMLファイル名から地物タイプの表への対応(属性情報を含めずにインポートした場合のみ)
+    UPROPERTY()
+        TMap<FString, FPLATEAUFeatureTypeTable> FeatureTypeTables;
+
+    // GML IDからコンポーネントへの索引
+    bool bCityObjectIndexBuilt = false;
+    // 値はUPLATEAUCityObjectGroupまたはUPLATEAUInstancedCityObjectGroup
+    TMap<FString, TArray<TWeakObjectPtr<USceneComponent>, TInlineAllocator<1>>, FDefaultSetAllocator,
+        TPLATEAUCaseSensitiveStringKeyFuncs<TArray<TWeakObjectPtr<USceneComponent>, TInlineAllocator<1>>>> GmlIdToComponents;
+    void BuildCityObjectIndex();
+
+    // フィルタリング用の地物の索引
+    FPLATEAUModelFilterIndex FilterIndex;
+
+    // 実行時のLod切り替え(フィルタリング用の索引から作成)
+    FPLATEAURuntimeLodManager RuntimeLod;
+
+    // セル分割の結果
+    UPROPERTY()
+        TArray<FPLATEAUSpatialCell> SpatialCells;
 };
@@ -0,0 +1,118 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <memory>
+
+namespace citygml {
+    class Material;
+}
+
+/**
+ * @brief SubMeshのマテリアル情報を量子化した比較・ハッシュ用のキーです。
+ * テクスチャパスは FPLATEAUMaterialKeyTable でインターンされた整数IDとして保持し、ハッシュは生成時に計算済みです。
+ */
+struct PLATEAURUNTIME_API FPLATEAUMaterialKey {
+    enum : int32 {
+        DiffuseOffset = 0,
+        SpecularOffset = 3,
+        EmissiveOffset = 6,
+        ShininessOffset = 9,
+        TransparencyOffset = 10,
+        AmbientOffset = 11,
+        ParameterCount = 12
+    };
+
+    int32 QuantizedParameters[ParameterCount] = {};
+    int32 TexturePathID = INDEX_NONE;
+    int32 GameMaterialID = 0;
+    uint8 bHasMaterial = 0;
+    uint8 bIsSmooth = 0;
+    uint16 Padding = 0;
+    uint32 Hash = 0;
+
+    // Hash以外のメンバーからハッシュを計算します。
+    void UpdateHash();
+
+    bool operator==(const FPLATEAUMaterialKey& Other) const {
+        return Hash == Other.Hash && FMemory::Memcmp(this, &Other, STRUCT_OFFSET(FPLATEAUMaterialKey, Hash)) == 0;
+    }
+
+    bool operator!=(const FPLATEAUMaterialKey& Other) const {
+        return !(*this == Other);
+    }
+
+    friend uint32 GetTypeHash(const FPLATEAUMaterialKey& Key) {
+        return Key.Hash;
+    }
+};
+
+/**
+ * @brief インポート全体で共有するマテリアルキーのテーブルです。
+ * テクスチャパスを整数IDへインターンし、マテリアルの重複排除の統計を集計します。
+ * 複数のGMLのワーカースレッドから同時に利用できます。
+ */
+class PLATEAURUNTIME_API FPLATEAUMaterialKeyTable {
+public:
+    // マテリアルパラメータの量子化単位の逆数
+    static constexpr float QuantizationScale = 65536.0f;
+
+    /**
+     * @brief テクスチャパスを整数IDに変換します。空のパスは INDEX_NONE になります。
+     */
+    int32 InternTexturePath(const FString& TexturePath);
+
+    /**
+     * @brief マテリアル情報からキーを作成します。マテリアルがない場合はパラメータを0として扱います。
+     */
+    FPLATEAUMaterialKey MakeKey(const std::shared_ptr<const citygml::Material>& Material, const FString& TexturePath, const int32 GameMaterialID);
+
+    // ConvertMeshでのSubMesh毎のマテリアル検索結果を記録します
+    void RecordSubMeshLookup(const bool bHit) {
+        ++SubMeshLookupCount;
+        if (bHit)
+            ++SubMeshHitCount;
+    }
+
+    // 作成済みマテリアルのキャッシュ検索結果を記録します
+    void RecordMaterialCacheLookup(const bool bHit) {
+        ++MaterialCacheLookupCount;
+        if (bHit)
+            ++MaterialCacheHitCount;
+    }
+
+    // マテリアルインスタンスの作成を記録します
+    void RecordMaterialInstanceCreated() {
+        ++MaterialInstanceCount;
+    }
+
+    int32 GetTexturePathCount() const;
+
+    int64 GetMaterialInstanceCount() const {
+        return MaterialInstanceCount.Load();
+    }
+
+    double GetSubMeshHitRate() const {
+        const int64 LookupCount = SubMeshLookupCount.Load();
+        return LookupCount > 0 ? static_cast<double>(SubMeshHitCount.Load()) / LookupCount : 0.0;
+    }
+
+    double GetMaterialCacheHitRate() const {
+        const int64 LookupCount = MaterialCacheLookupCount.Load();
+        return LookupCount > 0 ? static_cast<double>(MaterialCacheHitCount.Load()) / LookupCount : 0.0;
+    }
+
+    // 統計情報をログ出力用の文字列で返します
+    FString GetStatsString() const;
+
+private:
+    mutable FRWLock TexturePathLock;
+    TMap<FString, int32> TexturePathToID;
+
+    TAtomic<int64> SubMeshLookupCount{ 0 };
+    TAtomic<int64> SubMeshHitCount{ 0 };
+    TAtomic<int64> MaterialCacheLookupCount{ 0 };
+    TAtomic<int64> MaterialCacheHitCount{ 0 };
+    TAtomic<int64> MaterialInstanceCount{ 0 };
+};
@@ -0,0 +1,104 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace plateau::polygonMesh {
+    class Model;
+}
+
+class FEvent;
+class FPLATEAUMemoryBudget;
+
+/**
+ * @brief FPLATEAUMemoryBudgetから確保したメモリ量です。破棄時に解放されます。
+ * 処理が進んで不要になったメモリはShrinkで先に返却し、待機中の他のGMLに譲ります。
+ */
+class PLATEAURUNTIME_API FPLATEAUMemoryReservation {
+public:
+    FPLATEAUMemoryReservation(const TSharedRef<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>& InBudget, const int64 InBytes);
+    ~FPLATEAUMemoryReservation();
+
+    FPLATEAUMemoryReservation(const FPLATEAUMemoryReservation&) = delete;
+    FPLATEAUMemoryReservation& operator=(const FPLATEAUMemoryReservation&) = delete;
+
+    /**
+     * @brief 確保量をNewBytesまで減らします。現在の確保量より大きい場合は何もしません。
+     */
+    void Shrink(const int64 NewBytes);
+
+    int64 GetBytes() const {
+        return Bytes;
+    }
+
+private:
+    TSharedRef<FPLATEAUMemoryBudget, ESPMode::ThreadSafe> Budget;
+    int64 Bytes;
+};
+
+/**
+ * @brief インポート全体で共有するメモリ予算です。
+ * 各GMLはパース前にファイルサイズから見積もったメモリ量を確保し、予算に空きができるまで待機します。
+ * これにより同時に処理するGMLの数がファイルサイズではなく予算で制限されます。
+ */
+class PLATEAURUNTIME_API FPLATEAUMemoryBudget : public TSharedFromThis<FPLATEAUMemoryBudget, ESPMode::ThreadSafe> {
+public:
+    explicit FPLATEAUMemoryBudget(const int64 InBudgetBytes);
+
+    /**
+     * @brief メモリを確保します。予算に空きがない場合はメモリが返却されるまでポーリングせずに待機します。
+     * 予算を超える量を要求した場合は他の確保が全て返却されるまで待機してから要求量をそのまま確保し、警告を出力します。
+     * この間は他のGMLと同時には処理せず、確保量と最大値は予算を超えます。
+     * @return bCanceledがtrueになった場合はnullptr
+     */
+    TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe> Acquire(const int64 Bytes, const TAtomic<bool>* bCanceled = nullptr);
+
+    /**
+     * @brief 待機せずにメモリを確保します。予算に空きがない場合はnullptrを返します。
+     * 予算を超える量の扱いはAcquireと同じです。
+     */
+    TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe> TryAcquire(const int64 Bytes);
+
+    /**
+     * @brief メモリが返却された時に呼ばれる関数を設定します。返却したスレッドでロック外から呼ばれます。
+     */
+    void SetOnReleased(TFunction<void()> InOnReleased);
+
+    // GMLのパースとメッシュ抽出に必要なメモリ量をファイルサイズから見積もります
+    static int64 EstimateGmlBytes(const FString& GmlPath);
+    // Modelが保持しているメッシュのメモリ量を見積もります
+    static int64 EstimateModelBytes(const plateau::polygonMesh::Model& Model);
+
+    int64 GetBudgetBytes() const {
+        return BudgetBytes;
+    }
+    int64 GetUsedBytes() const;
+    // これまでの確保量の最大値。予算を超える量を確保した場合は予算より大きくなります
+    int64 GetPeakBytes() const;
+    // 予算を超える量を確保した回数
+    int32 GetOversizedCount() const;
+
+    // 統計情報をログ出力用の文字列で返します
+    FString GetStatsString() const;
+
+private:
+    friend class FPLATEAUMemoryReservation;
+    void Release(const int64 Bytes);
+    // ロック内で呼び、予算に空きがあれば確保量に加えます。予算を超える量は確保量が0の場合のみ加えます
+    bool TryReserveLocked(const int64 RequestedBytes);
+    // 予算を超える要求を警告します
+    void WarnIfOversized(const int64 RequestedBytes) const;
+
+    const int64 BudgetBytes;
+    mutable FCriticalSection Section;
+    int64 UsedBytes = 0;
+    int64 PeakBytes = 0;
+    int64 WaitMicroseconds = 0;
+    int32 OversizedCount = 0;
+    // 予算を超える確保での超過量の合計
+    int64 OversizedBytes = 0;
+    TFunction<void()> OnReleased;
+    // Acquireで待機中のスレッドのイベント。メモリの返却時に全て通知する
+    TArray<FEvent*> Waiters;
+};
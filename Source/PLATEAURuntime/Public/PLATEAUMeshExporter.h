@@ -12,7 +12,9 @@ enum class ECoordinateSystem : uint8;
 enum class EMeshFileFormat : uint8_t;
 
 class APLATEAUInstancedCityModel;
+class UPLATEAUInstancedCityObjectGroup;
 struct FPLATEAUMeshExportOptions;
+struct FPLATEAUMeshSourceData;
 
 namespace plateau {
     namespace polygonMesh {
@@ -20,23 +22,82 @@ namespace plateau {
     }
 }
 
+/**
+ * @brief plateauのMeshの作成に必要なコンポーネントのデータです。
+ * ゲームスレッドで読み出しておき、UObjectを参照せずに任意のスレッドでMeshを作成するために使います。
+ */
+struct FPLATEAUExportMeshSnapshot {
+    // 作成元のメッシュ。保持していない場合は描画用データ(LOD0)から読み出したPositions, UV1, UV4, Indicesを使います
+    TSharedPtr<const FPLATEAUMeshSourceData, ESPMode::ThreadSafe> SourceData;
+    TArray<FVector3f> Positions;
+    TArray<FVector2f> UV1;
+    // 都市オブジェクトのインデックス
+    TArray<FVector2f> UV4;
+    TArray<uint32> Indices;
+
+    // SubMesh毎のインデックスの範囲([Start, End])、テクスチャの元ファイルのパス、CachedMaterialsのインデックス(マテリアルがなければ-1)
+    TArray<int32> SubMeshStarts;
+    TArray<int32> SubMeshEnds;
+    TArray<FString> SubMeshTextureFilePaths;
+    TArray<int32> SubMeshMaterialIDs;
+
+    // CityObjectListに設定する都市オブジェクト
+    TArray<FPLATEAUCityObjectIndex> CityObjectIndices;
+    TArray<FString> CityObjectGmlIDs;
+};
+
+/**
+ * @brief plateauのNodeに対応するスナップショットです。
+ */
+struct FPLATEAUExportNodeSnapshot {
+    FString Name;
+    TOptional<FPLATEAUExportMeshSnapshot> Mesh;
+    TArray<FPLATEAUExportNodeSnapshot> Children;
+};
+
 class PLATEAURUNTIME_API FPLATEAUMeshExporter {
 public:
     bool Export(const FString& ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option);
     std::shared_ptr<plateau::polygonMesh::Model> CreateModelFromComponents(APLATEAUInstancedCityModel* ModelActor, const TArray<UPLATEAUCityObjectGroup*> ModelComponents, const FPLATEAUMeshExportOptions Option);
+
+    /**
+     * @brief CreateModelFromComponentsのうち、コンポーネントからの読み出しのみを行います。ゲームスレッドから呼び出してください。
+     * マテリアルはこの時点でCachedMaterialsに登録されます。
+     */
+    TArray<FPLATEAUExportNodeSnapshot> CreateSnapshotFromComponents(APLATEAUInstancedCityModel* ModelActor, const TArray<UPLATEAUCityObjectGroup*>& ModelComponents, const FPLATEAUMeshExportOptions& Option);
+
+    /**
+     * @brief CreateSnapshotFromComponentsで読み出したデータからModelを作成します。UObjectを参照しないため任意のスレッドから呼び出せます。
+     */
+    std::shared_ptr<plateau::polygonMesh::Model> CreateModelFromSnapshot(const TArray<FPLATEAUExportNodeSnapshot>& RootNodes, const FPLATEAUMeshExportOptions& Option) const;
     const FPLATEAUCachedMaterialArray& GetCachedMaterials(){ return CachedMaterials; }
 
 private:
     bool ExportAsOBJ(const FString& ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option);
     bool ExportAsFBX(const FString& ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option);
     bool ExportAsGLTF(const FString& ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option);
-    TArray<std::shared_ptr<plateau::polygonMesh::Model>> CreateModelFromActor(APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions Option);
-    std::shared_ptr<plateau::polygonMesh::Model> CreateModel(USceneComponent* ModelRootComponent, const FPLATEAUMeshExportOptions Option);
-    void CreateNode(plateau::polygonMesh::Node& OutNode, USceneComponent* NodeRootComponent, const FPLATEAUMeshExportOptions Option);
-    void CreateMesh(plateau::polygonMesh::Mesh& OutMesh, USceneComponent* MeshComponent, const FPLATEAUMeshExportOptions Option);
+
+    /**
+     * @brief GMLのコンポーネント毎にModelを作成し、作成できたものから書き出して解放します。
+     * コンポーネントの読み出しはゲームスレッドで行い、Modelの作成と書き出しのみワーカー数分のGML毎に並列に行います。
+     * @param WriteModel GMLのコンポーネント名とModelを受け取り、ファイルを書き出します。複数のスレッドから呼ばれます。
+     */
+    bool ExportModels(APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option,
+                      const TFunction<bool(const FString&, const plateau::polygonMesh::Model&)>& WriteModel);
+    TArray<USceneComponent*> GetModelComponents(APLATEAUInstancedCityModel* ModelActor);
+    TArray<FPLATEAUExportNodeSnapshot> CreateModelSnapshot(USceneComponent* ModelRootComponent, const FPLATEAUMeshExportOptions& Option);
+    void CreateMeshSnapshot(FPLATEAUExportMeshSnapshot& OutSnapshot, USceneComponent* MeshComponent, const FPLATEAUMeshExportOptions& Option);
+    // インスタンス毎に、インスタンス化しない場合と同じノードのスナップショットを追加します
+    void AddInstanceSnapshots(TArray<FPLATEAUExportNodeSnapshot>& OutNodes, UPLATEAUInstancedCityObjectGroup* InstancedGroup, const FPLATEAUMeshExportOptions& Option);
+    static void AddCityObjectsToSnapshot(FPLATEAUExportMeshSnapshot& OutSnapshot, UPLATEAUCityObjectGroup* CityObjectGroup);
+    void CreateNode(plateau::polygonMesh::Node& OutNode, const FPLATEAUExportNodeSnapshot& Snapshot, const FPLATEAUMeshExportOptions& Option) const;
+    void CreateMesh(plateau::polygonMesh::Mesh& OutMesh, const FPLATEAUExportMeshSnapshot& Snapshot, const FPLATEAUMeshExportOptions& Option) const;
+    void CreateMeshFromRenderData(plateau::polygonMesh::Mesh& OutMesh, const FPLATEAUExportMeshSnapshot& Snapshot, const FPLATEAUMeshExportOptions& Option) const;
+    // 作成元のメッシュ(FPLATEAUMeshSourceData)から、描画用データを読まずにMeshを作成します
+    void CreateMeshFromSourceData(plateau::polygonMesh::Mesh& OutMesh, const FPLATEAUMeshSourceData& SourceData, const FPLATEAUMeshExportOptions& Option) const;
 
     TArray<FString> ModelNames;
-    FVector ReferencePoint;
+    FVector ReferencePoint = FVector::ZeroVector;
     APLATEAUInstancedCityModel* TargetActor = nullptr;
     FPLATEAUCachedMaterialArray CachedMaterials = FPLATEAUCachedMaterialArray();
 };
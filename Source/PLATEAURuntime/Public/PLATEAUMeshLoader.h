@@ -10,11 +10,19 @@
 #include "StaticMeshAttributes.h"
 #include "Materials/MaterialInterface.h"
 #include "Engine/StaticMesh.h"
+#include "PLATEAUMaterialKeyTable.h"
+#include "PLATEAUMeshSourceData.h"
 
 struct FPLATEAUCityObject;
 struct FLoadInputData;
 class UPLATEAUCityObjectGroup;
 class FStaticMeshAttributes;
+class FPLATEAUComponentCommandBuffer;
+class FPLATEAUTextureCache;
+struct FPLATEAUCachedCityObjects;
+class FPLATEAUMemoryReservation;
+class FPLATEAUImportProfiler;
+class UPLATEAUInstancedCityObjectGroup;
 
 namespace citygml {
     class CityModel;
@@ -31,26 +39,30 @@ namespace plateau::polygonMesh {
 // SubMesh情報保持
 struct FSubMeshMaterialSet {
 public:
-    bool hasMaterial;
-    FVector3f Diffuse;
-    FVector3f Specular;
-    FVector3f Emissive;
-    float Shininess;
-    float Transparency;
-    float Ambient;
-    bool isSmooth;
+    bool hasMaterial = false;
+    FVector3f Diffuse = FVector3f::ZeroVector;
+    FVector3f Specular = FVector3f::ZeroVector;
+    FVector3f Emissive = FVector3f::ZeroVector;
+    float Shininess = 0.f;
+    float Transparency = 0.f;
+    float Ambient = 0.f;
+    bool isSmooth = false;
     FString TexturePath;
     FPolygonGroupID PolygonGroupID = 0;
     FString MaterialSlot = FString("");
     int GameMaterialID = 0;
+    // 比較・ハッシュに利用するキー
+    FPLATEAUMaterialKey Key;
 
     FSubMeshMaterialSet();
-    FSubMeshMaterialSet(std::shared_ptr<const citygml::Material> mat, FString texPath, int matId);
+    FSubMeshMaterialSet(std::shared_ptr<const citygml::Material> mat, FString texPath, int matId, FPLATEAUMaterialKeyTable& KeyTable);
     bool operator==(const FSubMeshMaterialSet& Other) const;
     bool Equals(const FSubMeshMaterialSet& Other) const;
 private:
 };
-FORCEINLINE uint32 GetTypeHash(const FSubMeshMaterialSet& Value);
+FORCEINLINE uint32 GetTypeHash(const FSubMeshMaterialSet& Value) {
+    return GetTypeHash(Value.Key);
+}
 
 // Nodeから、Node名、Nodeパスを取得し保持
 struct FNodeHierarchy {
@@ -64,6 +76,52 @@ public:
     std::string GetNameAsStandardString();
 };
 
+// ワーカースレッドで変換済みのメッシュ情報を保持
+struct FPLATEAUPreparedMesh {
+    FMeshDescription MeshDescription;
+    TArray<FSubMeshMaterialSet> SubMeshMaterialSets;
+    bool bHasPolygons = false;
+    // 作成元のメッシュを保持する場合のみ有効
+    TSharedPtr<const FPLATEAUMeshSourceData, ESPMode::ThreadSafe> SourceData;
+};
+
+// 同じ形状を持ち、1つのStaticMeshのインスタンスとしてまとめるメッシュのグループ
+struct FPLATEAUInstancedMeshGroup {
+    // StaticMeshの作成に利用するメッシュ(最初に見つかったもの)
+    const plateau::polygonMesh::Mesh* Representative = nullptr;
+    // 形状の基準位置を原点として変換済みのメッシュ
+    TSharedPtr<FPLATEAUPreparedMesh> PreparedMesh;
+    int32 MeshCount = 0;
+    int32 SectionCount = 0;
+    // 以下はゲームスレッドのみで更新
+    UStaticMesh* StaticMesh = nullptr;
+    TMap<USceneComponent*, UPLATEAUInstancedCityObjectGroup*> ParentToComponent;
+    // ビルド後にStaticMeshを設定するコンポーネント
+    TSharedRef<TArray<TWeakObjectPtr<UPLATEAUInstancedCityObjectGroup>>> Components = MakeShared<TArray<TWeakObjectPtr<UPLATEAUInstancedCityObjectGroup>>>();
+};
+
+// インスタンス化したメッシュの所属グループと、形状の基準位置
+struct FPLATEAUMeshInstance {
+    int32 Group = INDEX_NONE;
+    FVector Origin = FVector::ZeroVector;
+};
+
+// インスタンス化の結果
+struct FPLATEAUInstancingStats {
+    // インスタンス化した形状(StaticMesh)の数
+    int64 InstancedMeshes = 0;
+    int64 Instances = 0;
+    // 作成しなかったコンポーネントの数
+    int64 SavedComponents = 0;
+    // 作成しなかったコンポーネントのセクション数の合計
+    int64 SavedDrawCalls = 0;
+
+    FString ToString() const {
+        return FString::Printf(TEXT("%lld instances of %lld unique meshes, components -%lld, draw calls -%lld"),
+            Instances, InstancedMeshes, SavedComponents, SavedDrawCalls);
+    }
+};
+
 class PLATEAURUNTIME_API FPLATEAUMeshLoader {
     using FPathToTexture = TMap<FString, UTexture2D*>;
 public:
@@ -86,9 +144,26 @@ public:
         const std::shared_ptr<const citygml::CityModel> CityModel,
         TAtomic<bool>* bCanceled);
 
+    /**
+     * @brief シリアライズ済みの属性情報を設定します。設定されている場合、属性情報はCityModelではなくこちらから取得します。
+     * モデルキャッシュから読み込んだ場合など、CityModelがない状態でLoadModelを呼び出すために利用します。
+     */
+    void SetCachedCityObjects(const TSharedPtr<const FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>& InCachedCityObjects);
+
+    /**
+     * @brief メモリ予算から確保済みのメモリを設定します。設定されている場合、LoadModelはルートノード毎にComponentを作成した後、
+     * そのノード以下のメッシュを解放して確保量を減らします。
+     */
+    void SetMemoryReservation(const TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe>& InMemoryReservation);
+
     //前回のロードで作成されたComponentのリストを返します
     TArray<USceneComponent*> GetLastCreatedComponents();
 
+    // 前回のLoadModelでのインスタンス化の結果を返します
+    const FPLATEAUInstancingStats& GetLastInstancingStats() const {
+        return InstancingStats;
+    }
+
 protected:
     // SubMesh情報等に応じてMaterialを作成します。
     virtual UMaterialInterface* GetMaterialForSubMesh(const FSubMeshMaterialSet& SubMeshValue, UStaticMeshComponent* Component, const FLoadInputData& LoadInputData, UTexture2D* Texture, FNodeHierarchy NodeHier, UObject* Outer);
@@ -106,6 +181,21 @@ protected:
     bool bAutomationTest;
     TArray<UStaticMesh*> StaticMeshes;
     TMap<FSubMeshMaterialSet, UMaterialInterface*> CachedMaterials;
+    // マテリアルキーのテーブル。LoadModelではFLoadInputDataで指定されたインポート全体で共有のテーブルを利用します。
+    TSharedRef<FPLATEAUMaterialKeyTable, ESPMode::ThreadSafe> MaterialKeyTable = MakeShared<FPLATEAUMaterialKeyTable, ESPMode::ThreadSafe>();
+    // インポート全体で共有するテクスチャキャッシュ。LoadModelでFLoadInputDataに指定されている場合のみ利用します。
+    TSharedPtr<FPLATEAUTextureCache, ESPMode::ThreadSafe> TextureCache;
+    // シリアライズ済みの属性情報
+    TSharedPtr<const FPLATEAUCachedCityObjects, ESPMode::ThreadSafe> CachedCityObjects;
+    // メモリ予算から確保済みのメモリ
+    TSharedPtr<FPLATEAUMemoryReservation, ESPMode::ThreadSafe> MemoryReservation;
+    // インポートのプロファイラ。LoadModelでFLoadInputDataに指定されている場合のみ記録します。
+    TSharedPtr<FPLATEAUImportProfiler, ESPMode::ThreadSafe> Profiler;
+    FString ProfileGmlName;
+    // LoadModelで作成したComponent、マテリアル、テクスチャの数(ゲームスレッドのみで更新)
+    int64 CreatedComponentCount = 0;
+    int64 CreatedMaterialCount = 0;
+    int64 CreatedTextureCount = 0;
 
     /// 何度も同じテクスチャをロードすると重いので使い回せるように覚えておきます
      FPathToTexture PathToTexture;
@@ -113,6 +203,116 @@ protected:
     // 前回のLoadModel, ReloadComponentFromNode実行時に作成されたComponentを保持しておきます
     TArray<USceneComponent*> LastCreatedComponents;
 
+    // ワーカースレッドで事前変換したメッシュ。LoadModel中のみ有効で、Component作成時に取り出されます。
+    TMap<const plateau::polygonMesh::Mesh*, TSharedPtr<FPLATEAUPreparedMesh>> PreparedMeshes;
+
+    // FLoadInputData::bInstanceRepeatedMeshesの値。LoadModel中のみ有効です。
+    bool bInstanceRepeatedMeshes = false;
+    // trueの場合、PrepareMeshで作成元のメッシュを複製し、作成したUPLATEAUCityObjectGroupに保持させます
+    bool bRetainMeshSourceData = false;
+    // インスタンス化するメッシュのグループと各メッシュの所属。ルートノード毎に作成します。
+    TArray<FPLATEAUInstancedMeshGroup> InstancedMeshGroups;
+    TMap<const plateau::polygonMesh::Mesh*, FPLATEAUMeshInstance> MeshInstances;
+    // 複数のLodに存在する地物のノード名。インスタンス化の対象から除外します。LoadModel中のみ有効です。
+    TSet<FString> MultiLodNodeNames;
+    FPLATEAUInstancingStats InstancingStats;
+
+    /**
+     * @brief InstanceableMeshesで指定された末端のノードのメッシュのうち、基準位置(頂点の最小座標)からの頂点座標・インデックス・UV・マテリアルが一致するものをグループにまとめます。
+     * 2つ以上のメッシュを持つグループのみInstancedMeshGroupsに追加します。
+     */
+    void GroupInstancedMeshes(const TArray<const plateau::polygonMesh::Mesh*>& Meshes, const TBitArray<>& InstanceableMeshes, TAtomic<bool>* bCanceled);
+
+    /**
+     * @brief ノード以下の全メッシュをFMeshDescriptionへ並列変換し、PreparedMeshesに格納します。
+     * 変換処理は共有状態を持たないため、ゲームスレッドを介さずに実行できます。
+     */
+    void PrepareMeshesInParallel(const plateau::polygonMesh::Node& RootNode, TAtomic<bool>* bCanceled);
+
+    // メッシュをFMeshDescriptionへ変換します。頂点座標はOriginからの相対座標になります。ゲームスレッド以外から呼び出せます。
+    TSharedPtr<FPLATEAUPreparedMesh> PrepareMesh(const plateau::polygonMesh::Mesh& InMesh, const FVector& Origin = FVector::ZeroVector);
+
+    /**
+     * @brief 変換済みメッシュからStaticMeshComponentを作成し、マテリアル設定、アタッチまでを一度に行います。
+     * ゲームスレッドから呼び出してください。
+     */
+    UStaticMeshComponent* CreateStaticMeshComponentInGameThread(
+        AActor& Actor,
+        USceneComponent& ParentComponent,
+        const plateau::polygonMesh::Mesh& InMesh,
+        const FLoadInputData& LoadInputData,
+        const std::shared_ptr<const citygml::CityModel> CityModel,
+        const FNodeHierarchy& NodeHier,
+        FPLATEAUPreparedMesh& PreparedMesh);
+
+    /**
+     * @brief インスタンス化するノードを親Component毎のUPLATEAUInstancedCityObjectGroupにインスタンスとして追加します。
+     * ゲームスレッドから呼び出してください。
+     */
+    UPLATEAUInstancedCityObjectGroup* AddInstanceInGameThread(
+        AActor& Actor,
+        USceneComponent& ParentComponent,
+        const plateau::polygonMesh::Node& Node,
+        const FPLATEAUMeshInstance& Instance,
+        const FLoadInputData& LoadInputData,
+        const std::shared_ptr<const citygml::CityModel> CityModel);
+
+    // 作成したStaticMeshにSubMesh毎のマテリアルを設定します。ゲームスレッドから呼び出してください。
+    void AddMaterialsInGameThread(
+        UStaticMesh& StaticMesh,
+        UStaticMeshComponent& Component,
+        USceneComponent& ParentComponent,
+        const TArray<FSubMeshMaterialSet>& SubMeshMaterialSets,
+        const FMeshDescription& MeshDescription,
+        const FLoadInputData& LoadInputData,
+        const FNodeHierarchy& NodeHier);
+
+    /**
+     * @brief メッシュを持たないノードのComponent(UPLATEAUCityObjectGroupまたはUPLATEAUSceneComponent)を作成します。
+     * ゲームスレッドから呼び出してください。
+     */
+    USceneComponent* CreateSceneComponentInGameThread(
+        USceneComponent* ParentComponent,
+        const plateau::polygonMesh::Node& Node,
+        const FLoadInputData& LoadInputData,
+        const std::shared_ptr<const citygml::CityModel> CityModel,
+        AActor& Actor);
+
+    /**
+     * @brief LoadNodeとLoadNodeInGameThreadで共通の、StaticMeshComponentを作成しないノードの処理です。
+     * メッシュを持たないノードとインスタンス化するノードはComponentを作成し、空のメッシュのノードはOutComponentをnullptrとします。
+     * @param bInGameThread ゲームスレッドから呼び出す場合はtrue。falseの場合はComponentの作成をゲームスレッドで待機します。
+     * @return 処理した場合はtrue。StaticMeshComponentを作成するノードの場合はfalse
+     */
+    bool TryLoadNodeWithoutStaticMesh(
+        USceneComponent* ParentComponent,
+        const plateau::polygonMesh::Node& Node,
+        const FLoadInputData& LoadInputData,
+        const std::shared_ptr<const citygml::CityModel> CityModel,
+        AActor& Actor,
+        bool bInGameThread,
+        USceneComponent*& OutComponent);
+
+    // ノードに対応するComponentを作成します。ゲームスレッドから呼び出してください。
+    USceneComponent* LoadNodeInGameThread(
+        USceneComponent* ParentComponent,
+        const plateau::polygonMesh::Node& Node,
+        const FLoadInputData& LoadInputData,
+        const std::shared_ptr<const citygml::CityModel> CityModel,
+        AActor& Actor);
+
+    /**
+     * @brief ノード以下のComponent作成をコマンドバッファに積みます。
+     * 親Componentは先に積まれたコマンドで作成されるため、ParentSlot経由で参照します。
+     */
+    void EnqueueNodeRecursive(
+        FPLATEAUComponentCommandBuffer& CommandBuffer,
+        const TSharedRef<USceneComponent*, ESPMode::ThreadSafe>& ParentSlot,
+        const plateau::polygonMesh::Node& InNode,
+        const FLoadInputData& InLoadInputData,
+        const std::shared_ptr<const citygml::CityModel> InCityModel,
+        AActor& InActor);
+
     virtual UStaticMeshComponent* CreateStaticMeshComponent(
         AActor& Actor,
         USceneComponent& ParentComponent,
@@ -139,8 +339,9 @@ protected:
     virtual bool OverwriteTexture();
 
     virtual void ComputeNormals(FStaticMeshAttributes& Attributes, bool InvertNormal);
+    // 頂点座標はOriginからの相対座標とします
     virtual bool ConvertMesh(const plateau::polygonMesh::Mesh& InMesh, FMeshDescription& OutMeshDescription,
-        TArray<FSubMeshMaterialSet>& SubMeshMaterialSets, bool InvertNormal, bool MergeTriangles);
+        TArray<FSubMeshMaterialSet>& SubMeshMaterialSets, bool InvertNormal, bool MergeTriangles, const FVector& Origin = FVector::ZeroVector);
     virtual UStaticMesh* CreateStaticMesh(const plateau::polygonMesh::Mesh& InMesh, UObject* InOuter, FName Name);
 
 };
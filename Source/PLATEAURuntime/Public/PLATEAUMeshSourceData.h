@@ -0,0 +1,37 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace plateau::polygonMesh {
+    class Mesh;
+}
+
+/**
+ * @brief StaticMeshの作成元となったメッシュの頂点・インデックス・SubMeshを、要素毎の連続した配列で保持します。
+ *
+ * 結合・分離等でメッシュを再変換する際に、描画用データ(GetLODForExport)を読み戻さずにplateauのMeshを作成するために使います。
+ * 頂点はUnreal Engineの座標系(ESU, cm)で、面毎の頂点の複製を行う前のものです。
+ */
+struct PLATEAURUNTIME_API FPLATEAUMeshSourceData {
+    TArray<FVector3f> Positions;
+    TArray<FVector2f> UV1;
+    // 都市オブジェクトのインデックス
+    TArray<FVector2f> UV4;
+    TArray<uint32> Indices;
+
+    // SubMesh毎のインデックスの範囲([Start, End])とマテリアルスロット
+    TArray<int32> SubMeshStarts;
+    TArray<int32> SubMeshEnds;
+    TArray<int32> SubMeshMaterialSlots;
+
+    /**
+     * @brief plateauのMeshから作成します。
+     * @param MaterialSlots SubMesh毎のマテリアルスロット(StaticMeshのPolygonGroup)
+     */
+    static TSharedRef<const FPLATEAUMeshSourceData, ESPMode::ThreadSafe> Create(const plateau::polygonMesh::Mesh& InMesh, const TArray<int32>& MaterialSlots);
+
+    int32 GetMaterialSlotCount() const;
+    SIZE_T GetAllocatedSize() const;
+};
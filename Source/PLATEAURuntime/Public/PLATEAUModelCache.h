@@ -0,0 +1,102 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include <plateau/polygon_mesh/mesh_extract_options.h>
+
+namespace citygml {
+    class CityModel;
+}
+
+struct FPLATEAUFeatureTypeTable;
+
+namespace plateau::polygonMesh {
+    class Model;
+    class Node;
+    class Mesh;
+}
+
+/**
+ * @brief ノード毎にシリアライズ済みの属性情報(FPLATEAUCityObjectBinary形式)です。
+ * キャッシュから読み込んだ場合、CityModelなしで属性情報付きのComponentを作成するために利用します。
+ */
+struct PLATEAURUNTIME_API FPLATEAUCachedCityObjects {
+    // メッシュを持たないノード
+    TMap<const plateau::polygonMesh::Node*, TArray<uint8>> NodeToSerializedCityObjects;
+    // メッシュを持つノード
+    TMap<const plateau::polygonMesh::Mesh*, TArray<uint8>> MeshToSerializedCityObjects;
+};
+
+/**
+ * @brief 抽出済みのModelをディスクに保存し、再インポート時にGMLのパースとメッシュ抽出を省略するためのキャッシュです。
+ * キーはGMLファイルの内容のハッシュ、抽出設定、インポート範囲から作成します。
+ * キーにGMLの場所は含まないため、テクスチャのパスはGMLのディレクトリからの相対パスで保存し、読み込み時のGMLの場所から解決します。
+ * 保存形式は頂点などの配列をそのまま並べたバイナリで、読み込み時はファイルをメモリマップして復元します。
+ * 複数のGMLから同時に呼び出せます。
+ */
+class PLATEAURUNTIME_API FPLATEAUModelCache {
+public:
+    explicit FPLATEAUModelCache(const FString& InCacheDirectory = GetDefaultCacheDirectory());
+
+    // <Project>/Saved/PLATEAU/ModelCache
+    static FString GetDefaultCacheDirectory();
+
+    /**
+     * @brief キャッシュのキーを作成します。GMLファイルを読み込んでハッシュを計算するため、ゲームスレッド以外から呼び出してください。
+     * @return GMLファイルが読み込めない場合は空文字
+     */
+    static FString MakeKey(const FString& GmlPath, const plateau::polygonMesh::MeshExtractOptions& ExtractOptions,
+        const std::vector<plateau::geometry::Extent>& Extents, const bool bIncludeAttrInfo);
+
+    /**
+     * @brief Modelの全ノードについて、Component作成時と同じ方法で属性情報をシリアライズします。
+     */
+    static TSharedRef<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe> SerializeCityObjects(
+        const plateau::polygonMesh::Model& Model, const std::shared_ptr<const citygml::CityModel>& CityModel,
+        const plateau::polygonMesh::MeshGranularity Granularity);
+
+    /**
+     * @brief キャッシュからModelを読み込みます。
+     * @param GmlPath 読み込むGMLのパス。テクスチャのパスはこのGMLのディレクトリを基準に解決します。
+     * @param OutCityObjects 属性情報を保存していた場合のみ設定されます。
+     * @param OutFeatureTypes 地物タイプの表を保存していた場合のみ設定されます。
+     * @return キャッシュが存在しない、または読み込めない場合はfalse
+     */
+    bool TryLoad(const FString& Key, const FString& GmlPath, std::shared_ptr<plateau::polygonMesh::Model>& OutModel,
+        TSharedPtr<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>& OutCityObjects, FPLATEAUFeatureTypeTable* OutFeatureTypes = nullptr);
+
+    /**
+     * @brief Modelをキャッシュに保存します。
+     * @param GmlPath Modelを抽出したGMLのパス。テクスチャのパスはこのGMLのディレクトリからの相対パスで保存します。
+     * @param CityObjects nullptrの場合は属性情報を保存しません。
+     * @param FeatureTypes nullptrの場合は地物タイプの表を保存しません。
+     */
+    bool Save(const FString& Key, const FString& GmlPath, const plateau::polygonMesh::Model& Model, const FPLATEAUCachedCityObjects* CityObjects, const FPLATEAUFeatureTypeTable* FeatureTypes = nullptr);
+
+    // GmlDirectoryが空でない場合、テクスチャのパスはGmlDirectoryからの相対パスで保存・解決します
+    static void Serialize(const plateau::polygonMesh::Model& Model, const FPLATEAUCachedCityObjects* CityObjects, TArray64<uint8>& OutData,
+        const FPLATEAUFeatureTypeTable* FeatureTypes = nullptr, const FString& GmlDirectory = FString());
+    static bool Deserialize(const uint8* Data, const int64 Size, std::shared_ptr<plateau::polygonMesh::Model>& OutModel,
+        TSharedPtr<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe>& OutCityObjects, FPLATEAUFeatureTypeTable* OutFeatureTypes = nullptr,
+        const FString& GmlDirectory = FString());
+
+    // 統計情報をログ出力用の文字列で返します
+    FString GetStatsString() const;
+
+private:
+    FString GetCacheFilePath(const FString& Key) const;
+    // テクスチャのパスの基準とするGMLのディレクトリ(絶対パス)
+    static FString GetGmlDirectory(const FString& GmlPath);
+
+    const FString CacheDirectory;
+
+    TAtomic<int64> HitCount{ 0 };
+    TAtomic<int64> MissCount{ 0 };
+    TAtomic<int64> BytesRead{ 0 };
+    TAtomic<int64> BytesWritten{ 0 };
+    TAtomic<int64> LoadMicroseconds{ 0 };
+};
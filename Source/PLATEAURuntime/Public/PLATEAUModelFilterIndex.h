@@ -0,0 +1,104 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <plateau/dataset/city_model_package.h>
+
+struct FPLATEAUFeatureTypeTable;
+
+/**
+ * @brief モデルのON/OFF処理用の地物の索引です。
+ *
+ * Lodコンポーネント以下の全コンポーネントについて、パッケージ・Lod・地物タイプ・同じ地物が存在するLodを固定長のレコードとして保持します。
+ * フィルタリングはレコードのみから表示状態を求め、現在の表示状態と異なるコンポーネントのみ変更します(FPLATEAUModelFiltering参照)。
+ * コンポーネントを追加・削除した場合はResetしてから作り直してください。フィルタリング条件はResetしても保持され、作り直したレコードに適用されます。
+ */
+class PLATEAURUNTIME_API FPLATEAUModelFilterIndex {
+public:
+    enum ERecordFlags : uint8 {
+        // Lodコンポーネント直下の地物コンポーネント
+        RecordFeature = 1 << 0,
+        // 地物タイプによるフィルタリング対象
+        RecordTypeFilterable = 1 << 1,
+    };
+
+    struct FRecord {
+        TWeakObjectPtr<USceneComponent> Component;
+        // 属性情報の最上位のシティオブジェクト、または地物タイプの表から求めた地物タイプ(RecordTypeFilterableの場合のみ)
+        int64 Type = 0;
+        plateau::dataset::PredefinedCityModelPackage Package = plateau::dataset::PredefinedCityModelPackage::None;
+        // Lodによる表示状態を決める地物レコードの番号(地物レコード自身の場合は自身の番号)
+        int32 Feature = INDEX_NONE;
+        // 同じ名前の地物が存在するLodのビットマスク
+        uint16 FeatureLods = 0;
+        uint8 Lod = 0;
+        uint8 Flags = 0;
+    };
+
+    struct FLodRange {
+        int32 MinLod = 0;
+        int32 MaxLod = 4;
+    };
+
+    /**
+     * @brief GMLファイルに相当するコンポーネント以下の索引を作成します。
+     * Lodによる表示状態は最後に適用したパッケージ・Lodの条件から求め、条件が未適用の場合はインポート直後と同じく0~4の内最大Lodのみ表示とします。
+     * @param FeatureTypeTables 属性情報を持たないコンポーネントの地物タイプを検索するための、GMLファイル名から地物タイプの表への対応
+     */
+    void Build(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const TMap<FString, FPLATEAUFeatureTypeTable>* FeatureTypeTables = nullptr);
+    void Reset();
+
+    bool IsBuilt() const {
+        return bBuilt;
+    }
+
+    const TArray<FRecord>& GetRecords() const {
+        return Records;
+    }
+
+    /**
+     * @brief パッケージ・Lodによるフィルタリングで地物レコードが表示対象かどうかを返します。
+     */
+    bool IsLodVisible(const int32 FeatureRecord) const {
+        return LodVisibility[FeatureRecord];
+    }
+
+    /**
+     * @brief 地物タイプによるフィルタリングでレコードが表示対象かどうかを返します。
+     */
+    bool IsTypeVisible(const FRecord& Record) const {
+        return !bFilterByType || !(Record.Flags & RecordTypeFilterable) || (VisibleTypes & Record.Type);
+    }
+
+    static uint16 GetLodBit(const int Lod) {
+        return static_cast<uint16>(1u << FMath::Clamp(Lod, 0, 15));
+    }
+
+    /**
+     * @brief 地物レコードがLodの範囲内かつ、bOnlyMaxLodの場合は範囲内のより大きいLodに同じ地物が存在しない場合trueを返します。
+     */
+    static bool IsInLodRange(const FRecord& Record, const FLodRange& LodRange, const bool bOnlyMaxLod);
+
+private:
+    friend class FPLATEAUModelFiltering;
+
+    int32 AddRecord(USceneComponent* Component, const plateau::dataset::PredefinedCityModelPackage Package, const int Lod, const int32 FeatureRecord, const FPLATEAUFeatureTypeTable* FeatureTypeTable);
+
+    /**
+     * @brief パッケージ・Lodによるフィルタリング条件から地物レコード毎のLodによる表示状態を求めます。
+     */
+    void UpdateLodVisibility();
+
+    bool bBuilt = false;
+    TArray<FRecord> Records;
+    // 地物レコード毎のLodによる表示状態
+    TBitArray<> LodVisibility;
+    // パッケージ・Lodによるフィルタリング条件(表示対象のパッケージ毎のLodの範囲)。未適用の場合はインポート直後の表示状態
+    bool bFilterByLod = false;
+    TMap<plateau::dataset::PredefinedCityModelPackage, FLodRange> LodRanges;
+    bool bOnlyMaxLod = true;
+    // 地物タイプによるフィルタリング条件
+    bool bFilterByType = false;
+    int64 VisibleTypes = 0;
+};
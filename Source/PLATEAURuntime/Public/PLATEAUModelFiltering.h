@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include <PLATEAUInstancedCityModel.h>
+#include <PLATEAUModelFilterIndex.h>
 
 //モデル ON/OFF処理
 class PLATEAURUNTIME_API FPLATEAUModelFiltering {
@@ -27,10 +28,38 @@ public:
      */
     void ApplyCollisionResponseBlockToChannel(USceneComponent* ParentComponent, const bool bCollisionResponseBlock, const bool bPropagateToChildren = false);
 
+    /**
+     * @brief 索引を用いて、パッケージとLodの範囲に従って各地物を可視化・非可視化します。地物タイプによる非表示化は解除されます。
+     * 表示状態が変わるコンポーネントのみ変更します。
+     * @return 表示状態を変更したコンポーネント数
+     */
+    int32 FilterByLods(FPLATEAUModelFilterIndex& Index, const plateau::dataset::PredefinedCityModelPackage InPackage, const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod);
+
+    /**
+     * @brief 索引を用いて、Lodによって可視化されている地物の内、地物タイプが含まれないものを非表示化します。
+     * @return 表示状態を変更したコンポーネント数
+     */
+    int32 FilterByFeatureTypes(FPLATEAUModelFilterIndex& Index, const citygml::CityObject::CityObjectsType InCityObjectType);
+
+    /**
+     * @brief FilterByLods, FilterByFeatureTypesを続けて呼んだ場合と同じ表示状態に、一度の差分の反映で変更します。
+     * @return 表示状態を変更したコンポーネント数
+     */
+    int32 FilterByLodsAndFeatureTypes(FPLATEAUModelFilterIndex& Index, const plateau::dataset::PredefinedCityModelPackage InPackage, const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod, const citygml::CityObject::CityObjectsType InCityObjectType);
+
     void FilterByLods(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const plateau::dataset::PredefinedCityModelPackage InPackage, const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod);
 
     void FilterByFeatureTypes(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const citygml::CityObject::CityObjectsType InCityObjectType);
 
     void FilterByFeatureTypesLegacyCacheCityGml(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const citygml::CityObject::CityObjectsType InCityObjectType, const FString DatasetName);
     void FilterByFeatureTypesLegacyMain(const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const citygml::CityObject::CityObjectsType InCityObjectType, const FString DatasetName);
+
+private:
+    void UpdateLodVisibility(FPLATEAUModelFilterIndex& Index, const plateau::dataset::PredefinedCityModelPackage InPackage, const TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod>& PackageToLodRangeMap, const bool bOnlyMaxLod);
+
+    /**
+     * @brief 索引のフィルタリング条件から求めた表示状態と現在の表示状態が異なるコンポーネントのみ変更します。
+     * @return 表示状態を変更したコンポーネント数
+     */
+    int32 ApplyVisibility(const FPLATEAUModelFilterIndex& Index);
 };
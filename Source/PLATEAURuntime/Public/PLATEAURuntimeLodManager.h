@@ -0,0 +1,137 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PLATEAUModelFilterIndex.h"
+#include "PLATEAURuntimeLodManager.generated.h"
+
+/**
+ * @brief 実行時のLod切り替えの設定です。
+ * 画面サイズは地物の境界球の直径が画面の幅(または高さ)に占める割合です。
+ */
+USTRUCT(BlueprintType)
+struct PLATEAURUNTIME_API FPLATEAURuntimeLodSettings {
+    GENERATED_USTRUCT_BODY()
+
+public:
+    // LOD2を表示する最小の画面サイズ。これより小さい場合はLOD1を表示します。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU", meta = (ClampMin = 0, UIMin = 0, UIMax = 1))
+        float Lod2ScreenSize = 0.05f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU", meta = (ClampMin = 0, UIMin = 0, UIMax = 1))
+        float Lod3ScreenSize = 0.2f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU", meta = (ClampMin = 0, UIMin = 0, UIMax = 1))
+        float Lod4ScreenSize = 0.5f;
+
+    // 詳細なLodから切り替える際に閾値を下げる割合。境界付近でLodが毎フレーム切り替わるのを防ぎます。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU", meta = (ClampMin = 0, ClampMax = 0.9, UIMin = 0, UIMax = 0.9))
+        float Hysteresis = 0.1f;
+
+    // 1フレームで地物の評価・切り替えに費やす最大時間(ミリ秒)。評価しきれなかった地物は次のフレームで続きから評価します。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU", meta = (ClampMin = 0.01, UIMin = 0.01))
+        float TimeBudgetMs = 0.5f;
+
+    /**
+     * @brief Lodを表示する最小の画面サイズを返します。LOD0, LOD1は常に0です。
+     */
+    float GetScreenSize(const int32 Lod) const {
+        switch (Lod) {
+        case 2: return Lod2ScreenSize;
+        case 3: return Lod3ScreenSize;
+        case 4: return Lod4ScreenSize;
+        default: return Lod > 4 ? Lod4ScreenSize : 0.0f;
+        }
+    }
+};
+
+/**
+ * @brief 実行時のLod切り替えの集計です。
+ */
+struct FPLATEAURuntimeLodStats {
+    int32 Features = 0;
+    // 表示中のLod毎の地物数
+    int32 FeaturesPerLod[5] = {};
+    // 表示中の三角形数
+    int64 VisibleTriangles = 0;
+    // 直近のUpdateで評価・切り替えた地物数と処理時間
+    int32 EvaluatedFeatures = 0;
+    int32 SwitchedFeatures = 0;
+    double UpdateSeconds = 0.0;
+
+    FString ToString() const {
+        return FString::Printf(TEXT("%d features (LOD0-4: %d/%d/%d/%d/%d), %lld triangles, last update %d evaluated, %d switched in %.3f ms"),
+            Features, FeaturesPerLod[0], FeaturesPerLod[1], FeaturesPerLod[2], FeaturesPerLod[3], FeaturesPerLod[4],
+            VisibleTriangles, EvaluatedFeatures, SwitchedFeatures, UpdateSeconds * 1000.0);
+    }
+};
+
+/**
+ * @brief 地物毎に、視点からの画面サイズに応じてインポートされたLod(LOD0-LOD4)の内1つを表示します。
+ *
+ * フィルタリング用の索引(FPLATEAUModelFilterIndex)から、同じ名前の地物のLod毎のコンポーネントと境界球を作成します。
+ * パッケージのフィルタリングで非表示の地物は対象外とし、地物タイプのフィルタリングで非表示のコンポーネントは表示しません。
+ * Lodの範囲によるフィルタリング(最大Lodのみの表示等)は、対象の地物についてはこのクラスの切り替えで置き換えられます。
+ *
+ * Updateは前回の続きから時間予算内で地物を評価し、表示するLodが変わった地物のみ表示状態を変更します。
+ * フィルタリングの条件を変更した場合、コンポーネントを追加・削除した場合はResetしてから作り直してください。
+ */
+class PLATEAURUNTIME_API FPLATEAURuntimeLodManager {
+public:
+    /**
+     * @brief 索引から地物毎のLodを作成します。現在表示中のLodを表示中として扱います。
+     */
+    void Build(const FPLATEAUModelFilterIndex& Index);
+    void Reset();
+
+    bool IsBuilt() const {
+        return bBuilt;
+    }
+
+    /**
+     * @brief 視点からの画面サイズに従って、時間予算内で地物を評価してLodを切り替えます。
+     * @param Index Buildに使用した索引
+     * @param FOVDegrees 水平方向の視野角
+     * @return 表示するLodを切り替えた地物数
+     */
+    int32 Update(const FPLATEAUModelFilterIndex& Index, const FVector& ViewOrigin, const float FOVDegrees, const FPLATEAURuntimeLodSettings& Settings);
+
+    const FPLATEAURuntimeLodStats& GetStats() const {
+        return Stats;
+    }
+
+    /**
+     * @brief 地物の境界球が画面に占める割合を返します。
+     */
+    static float ComputeScreenSize(const FVector& Center, const float Radius, const FVector& ViewOrigin, const float FOVDegrees);
+
+private:
+    struct FFeatureLod {
+        // 索引のレコードの範囲(地物レコードとその子孫のレコードは連続している)
+        int32 FirstRecord = 0;
+        int32 EndRecord = 0;
+        int64 Triangles = 0;
+        uint8 Lod = 0;
+    };
+
+    struct FFeature {
+        FVector Center = FVector::ZeroVector;
+        float Radius = 0.0f;
+        // FeatureLodsの範囲(Lodの昇順)
+        int32 FirstLod = 0;
+        int32 LodCount = 0;
+        // 表示中のLodのFeatureLodsの番号
+        int32 CurrentLod = INDEX_NONE;
+    };
+
+    int32 SelectLod(const FFeature& Feature, const float ScreenSize, const FPLATEAURuntimeLodSettings& Settings) const;
+    void SetLodVisibility(const FPLATEAUModelFilterIndex& Index, const FFeatureLod& FeatureLod, const bool bVisible) const;
+
+    bool bBuilt = false;
+    TArray<FFeature> Features;
+    TArray<FFeatureLod> FeatureLods;
+    // 次のUpdateで最初に評価する地物
+    int32 NextFeature = 0;
+    FPLATEAURuntimeLodStats Stats;
+};
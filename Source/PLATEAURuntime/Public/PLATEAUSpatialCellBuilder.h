@@ -0,0 +1,158 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PLATEAUSpatialCellBuilder.generated.h"
+
+class APLATEAUInstancedCityModel;
+class APLATEAUCityModelCellProxy;
+class UPLATEAUCityObjectGroup;
+
+/**
+ * @brief 3D都市モデルのセル分割・プロキシ生成の設定です。
+ */
+USTRUCT(BlueprintType)
+struct PLATEAURUNTIME_API FPLATEAUSpatialCellSettings {
+    GENERATED_USTRUCT_BODY()
+
+public:
+    // GMLファイルのメッシュコードの区画を縦横に分割する数。1の場合はメッシュコードの区画をそのままセルとします。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU", meta = (ClampMin = 1, UIMin = 1, UIMax = 8))
+        int32 Subdivision = 1;
+
+    // セル毎に地物を結合したプロキシを生成します
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+        bool bGenerateProxies = true;
+
+    // プロキシにテクスチャを含めます。含めない場合はプロキシのメモリ量が減ります。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+        bool bProxyTextures = true;
+
+    // プロキシに切り替える距離(cm)。元の地物はこの距離より遠くで非表示、プロキシは近くで非表示になります。0以下の場合は描画距離を変更しません。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU", meta = (ClampMin = 0, UIMin = 0))
+        float ProxyDrawDistance = 100000.0f;
+};
+
+/**
+ * @brief 3D都市モデルを分割したセルです。
+ * 座標・範囲は3D都市モデルのアクターのローカル座標です。
+ */
+USTRUCT(BlueprintType)
+struct PLATEAURUNTIME_API FPLATEAUSpatialCell {
+    GENERATED_USTRUCT_BODY()
+
+public:
+    // {メッシュコード}、分割した場合は{メッシュコード}_{x}_{y}
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        FString CellCode;
+
+    // セルの属するメッシュコード。メッシュコードが得られないGMLファイルの場合はGMLファイル名
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        FString GridCode;
+
+    // メッシュコードの区画の範囲と、セル内の地物の範囲を合わせた範囲
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        FBox Bounds = FBox(ForceInit);
+
+    // セル内の地物コンポーネント(Lodコンポーネント直下)。同じ地物の各Lodのコンポーネントを含みます。
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        TArray<TObjectPtr<USceneComponent>> Features;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        TObjectPtr<APLATEAUCityModelCellProxy> Proxy;
+
+    // セル内の地物のメッシュを持つコンポーネント数
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        int32 SourceComponents = 0;
+
+    // セル内の表示中の地物の三角形数
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        int64 SourceTriangles = 0;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        int64 ProxyTriangles = 0;
+
+    // セル内の地物(全Lod)のStaticMeshの見積もりメモリ量。元の地物はアンロードされないため常に常駐します。
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        int64 SourceBytes = 0;
+
+    // プロキシのStaticMeshの見積もりメモリ量。元の地物に加えて常駐します。
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        int64 ProxyBytes = 0;
+};
+
+/**
+ * @brief セル分割・プロキシ生成の集計です。
+ */
+struct FPLATEAUSpatialCellStats {
+    int32 Cells = 0;
+    int32 ProxyCells = 0;
+    int64 SourceComponents = 0;
+    int64 ProxyComponents = 0;
+    int64 SourceTriangles = 0;
+    int64 ProxyTriangles = 0;
+    // 表示中の三角形数が最大のセルの三角形数
+    int64 MaxCellTriangles = 0;
+    int64 SourceBytes = 0;
+    int64 ProxyBytes = 0;
+
+    // 常駐するメモリ量。元の地物はアンロードされないため、プロキシの分だけ増えます。
+    int64 GetResidentBytes() const {
+        return SourceBytes + ProxyBytes;
+    }
+
+    FString ToString() const {
+        return FString::Printf(TEXT("%d cells (%d proxies), components %lld -> %lld, triangles %lld -> %lld (max %lld per cell), resident memory %.1f MB + proxies %.1f MB = %.1f MB"),
+            Cells, ProxyCells, SourceComponents, ProxyComponents, SourceTriangles, ProxyTriangles, MaxCellTriangles,
+            SourceBytes / (1024.0 * 1024.0), ProxyBytes / (1024.0 * 1024.0), GetResidentBytes() / (1024.0 * 1024.0));
+    }
+};
+
+/**
+ * @brief インポート後の3D都市モデルをGMLファイルのメッシュコードの区画に揃えたセルに分割し、セル毎に遠景用のプロキシを生成します。
+ *
+ * 地物はコンポーネントの範囲の中心が含まれるセルに割り当てます。
+ * プロキシは各地物のLOD1以上で最小のLod(無い場合は存在する最小のLod)のメッシュを、粒度変換で地域単位に結合した後に
+ * MeshMergerで1つのメッシュにまとめたものです。プロキシは遠景表示専用のため属性情報を持ちません。
+ *
+ * セルは描画の切り替え単位であり、ストリーミングの単位ではありません。元の地物は描画距離(CullDistance)で遠景では描画されなくなりますが、
+ * コンポーネントとメッシュはロードされたままです。インポート直後の地物はGMLファイル毎のコンポーネント階層として
+ * 1つのアクターに属しており、セル単位でアンロード・再ロードするにはセル毎のアクターへの再構成と元データからの再読み込みが必要になるためです。
+ * 削減されるのは遠景の描画コスト(三角形数・コンポーネント数)で、メモリはプロキシの分だけ増えます。
+ */
+class PLATEAURUNTIME_API FPLATEAUSpatialCellBuilder {
+public:
+    FPLATEAUSpatialCellBuilder(APLATEAUInstancedCityModel* Actor, const FPLATEAUSpatialCellSettings& InSettings);
+
+    /**
+     * @brief 地物コンポーネントをセルに分割します。地物の無いセルは含みません。ゲームスレッドで呼び出してください。
+     */
+    TArray<FPLATEAUSpatialCell> Partition() const;
+
+    /**
+     * @brief セルのプロキシの元となるコンポーネントを返します。ゲームスレッドで呼び出してください。
+     */
+    TArray<UPLATEAUCityObjectGroup*> CollectProxySources(const FPLATEAUSpatialCell& Cell) const;
+
+    /**
+     * @brief プロキシを生成し、プロキシ用のアクターに読み込みます。ワーカースレッドで呼び出してください。
+     * コンポーネントの読み出しとアクターへの読み込みはゲームスレッドで行い、メッシュの結合のみ呼び出し元のスレッドで行います。
+     * @return 生成した場合はtrue
+     */
+    bool GenerateProxy(FPLATEAUSpatialCell& Cell, const TArray<UPLATEAUCityObjectGroup*>& Sources) const;
+
+    /**
+     * @brief 元の地物とプロキシの描画距離を設定し、セル毎の計測値と集計を求めます。ゲームスレッドで呼び出してください。
+     */
+    FPLATEAUSpatialCellStats Finalize(TArray<FPLATEAUSpatialCell>& Cells) const;
+
+    /**
+     * @brief Finalizeで設定した元の地物の描画距離を戻します。
+     */
+    static void ResetDrawDistances(const FPLATEAUSpatialCell& Cell);
+
+private:
+    APLATEAUInstancedCityModel* CityModelActor;
+    FPLATEAUSpatialCellSettings Settings;
+};
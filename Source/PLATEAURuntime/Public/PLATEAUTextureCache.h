@@ -0,0 +1,131 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PLATEAUTextureLoader.h"
+
+class FPLATEAUImportProfiler;
+
+namespace plateau::polygonMesh {
+    class Model;
+}
+
+/**
+ * @brief インポート全体で共有するテクスチャキャッシュです。
+ * Modelが参照するテクスチャを抽出直後に先読みし、上限付きのワーカーでデコードして、パスをキーとしたLRUに保持します。
+ * LRUはデコード済み画像のバイト数で上限を持ち、待機中のテクスチャのデコードで上限を超えた場合は最も長く使われていない画像を破棄します。
+ * 破棄された画像は必要になった時点で再度デコードします(ミス)。保持量が上限を超えている間は先読みを止めます。
+ * デコード済みの画像はUTexture2Dの作成後にLRUから外し、以降は作成済みのテクスチャをGML間で使い回します。
+ * ゲームスレッドではデコード済みの画像からUTexture2Dを作成するのみとなります。
+ */
+class PLATEAURUNTIME_API FPLATEAUTextureCache : public TSharedFromThis<FPLATEAUTextureCache, ESPMode::ThreadSafe> {
+public:
+    /**
+     * @param InCapacityBytes LRUに保持するデコード済み画像の最大バイト数
+     * @param InMaxWorkerCount 同時にデコードするワーカー数の上限。0以下の場合はコア数から決定します。
+     * @param InDecodeOptions デコード時に行うミップ生成、ブロック圧縮の設定
+     */
+    explicit FPLATEAUTextureCache(const int64 InCapacityBytes = 1024ll * 1024 * 1024, const int32 InMaxWorkerCount = 0,
+        const FPLATEAUTextureDecodeOptions& InDecodeOptions = FPLATEAUTextureDecodeOptions());
+
+    // Modelのサブメッシュが参照するテクスチャパス(正規化済み)を重複なく返します
+    static TArray<FString> CollectTexturePaths(const plateau::polygonMesh::Model& Model);
+
+    /**
+     * @brief テクスチャのデコードをワーカーに依頼します。キャッシュ済み、デコード中のパスは無視されます。
+     */
+    void Prefetch(const TArray<FString>& TexturePaths);
+
+    /**
+     * @brief 指定したパスのデコードが完了するまで待機します。ゲームスレッド以外から呼び出してください。
+     */
+    void Wait(const TArray<FString>& TexturePaths);
+
+    /**
+     * @brief テクスチャを取得します。インポート中に作成済みであればそれを返し、なければデコード済みの画像から作成します。
+     * ゲームスレッドから呼び出してください。
+     * @param bOutCreated 新たにテクスチャを作成した場合はtrue
+     */
+    UTexture2D* FindOrCreateTexture(const FString& TexturePath, const bool bOverwriteTexture, bool& bOutCreated);
+
+    // 統計情報をログ出力用の文字列で返します
+    FString GetStatsString() const;
+
+    int64 GetHitCount() const {
+        return HitCount.Load();
+    }
+    int64 GetMissCount() const {
+        return MissCount.Load();
+    }
+    // LRUから破棄したデコード済み画像の数
+    int64 GetEvictedCount() const;
+
+    // デコード時間、テクスチャ数、読み込みバイト数を記録するプロファイラを設定します。Prefetch前に呼び出してください。
+    void SetProfiler(const TSharedPtr<FPLATEAUImportProfiler, ESPMode::ThreadSafe>& InProfiler);
+
+private:
+    struct FEntry {
+        TSharedPtr<const FPLATEAUDecodedTexture, ESPMode::ThreadSafe> DecodedTexture;
+        // デコード完了時にトリガーされます
+        TSharedPtr<FEvent, ESPMode::ThreadSafe> DecodedEvent;
+        // DecodedTextureを保持している間のLRU上の位置
+        TDoubleLinkedList<FString>::TDoubleLinkedListNode* LruNode = nullptr;
+        bool bPending = false;
+        // UTexture2Dを作成済み
+        bool bCreated = false;
+        // テクスチャ作成前にLRUから破棄された
+        bool bEvicted = false;
+    };
+
+    void StartWorkersIfNeeded();
+    void DrainQueue();
+    // 次にデコードするパスを取り出します。先読みの保持量が上限を超えている場合は待機中のパスのみ取り出します。
+    bool DequeueNext(FString& OutTexturePath);
+    // デコード待ちのパスを待機中として優先して処理します。LRUから破棄済みの場合は再度デコードします。デコード完了を待つイベントを返します。
+    TSharedPtr<FEvent, ESPMode::ThreadSafe> Request(const FString& NormalizedPath);
+    TSharedPtr<const FPLATEAUDecodedTexture, ESPMode::ThreadSafe> DecodeAndRecord(const FString& TexturePath);
+    // エントリをデコード待ちにします
+    void MarkPending(FEntry& Entry);
+    // LRUの操作。EntriesSectionのロック中に呼び出します。
+    void AddToLru(const FString& NormalizedPath, FEntry& Entry);
+    void RemoveFromLru(FEntry& Entry);
+    void Touch(FEntry& Entry);
+    // 保持量が上限以下になるまで最も長く使われていない画像を破棄します。KeepPathは破棄しません。
+    void Evict(const FString& KeepPath);
+
+    const int64 CapacityBytes;
+    const int32 MaxWorkerCount;
+    const FPLATEAUTextureDecodeOptions DecodeOptions;
+    TSharedPtr<FPLATEAUImportProfiler, ESPMode::ThreadSafe> Profiler;
+
+    mutable FCriticalSection EntriesSection;
+    TMap<FString, FEntry> Entries;
+    // 先読みのデコード待ち
+    TArray<FString> Queue;
+    // 待機中のデコード待ち。保持量の上限によらず先に処理します。
+    TArray<FString> RequestedQueue;
+    int32 ActiveWorkerCount = 0;
+    // デコード済み画像のパス。先頭が最近使われたもの
+    TDoubleLinkedList<FString> Lru;
+    int64 CachedBytes = 0;
+    int64 PeakCachedBytes = 0;
+    int64 EvictedCount = 0;
+    int64 EvictedBytes = 0;
+
+    // インポート中に作成したテクスチャ(ゲームスレッドのみでアクセス)
+    TMap<FString, UTexture2D*> CreatedTextures;
+
+    TAtomic<int64> DecodeMicroseconds{ 0 };
+    TAtomic<int64> BytesRead{ 0 };
+    TAtomic<int64> DecodedCount{ 0 };
+    TAtomic<int64> LookupCount{ 0 };
+    TAtomic<int64> HitCount{ 0 };
+    // ゲームスレッドでデコードした回数(先読みされていない、または破棄済み)
+    TAtomic<int64> MissCount{ 0 };
+    // 保持量の上限により先読みを止めた回数
+    TAtomic<int64> ThrottledCount{ 0 };
+    // ミップ生成・圧縮前後のGPUメモリ使用量の見積もり
+    TAtomic<int64> UncompressedGPUBytes{ 0 };
+    TAtomic<int64> GPUBytes{ 0 };
+};
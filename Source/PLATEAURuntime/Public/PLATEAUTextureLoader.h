@@ -4,10 +4,65 @@
 
 #include "CoreMinimal.h"
 #include "Engine/Texture2D.h"
+#include "PLATEAUImportSettings.h"
+
+// デコード時に行う加工の設定
+struct FPLATEAUTextureDecodeOptions {
+    // Mip1以降を生成するか
+    bool bGenerateMips = false;
+    EPLATEAUTextureCompression Compression = EPLATEAUTextureCompression::Uncompressed;
+};
+
+// ワーカースレッドでデコード済みのテクスチャ画像
+struct FPLATEAUDecodedTexture {
+    // Mip0(PixelFormatの形式)
+    TArray64<uint8> Data;
+    // Mip1以降(PixelFormatの形式)
+    TArray<TArray64<uint8>> MipChain;
+    // ブロック圧縮した場合のみ、テクスチャのSourceに設定する非圧縮(BGRA8)の全ミップを連結したもの
+    TArray64<uint8> SourceData;
+    int32 Width = 0;
+    int32 Height = 0;
+    EPixelFormat PixelFormat = PF_Unknown;
+    // 読み込んだファイルのサイズ
+    int64 FileSize = 0;
+    // ミップ生成・圧縮を行わない場合のGPUメモリ使用量
+    int64 UncompressedSize = 0;
+
+    int32 GetNumMips() const {
+        return 1 + MipChain.Num();
+    }
+
+    // 全ミップのGPUメモリ使用量
+    int64 GetGPUSize() const {
+        int64 Size = Data.Num();
+        for (const auto& Mip : MipChain) {
+            Size += Mip.Num();
+        }
+        return Size;
+    }
+
+    // 保持しているメモリ量
+    int64 GetMemorySize() const {
+        return GetGPUSize() + SourceData.Num();
+    }
+};
 
 class PLATEAURUNTIME_API FPLATEAUTextureLoader {
 public:
     static UTexture2D* Load(const FString& TexturePath, bool OverwriteTextre);
+    /**
+     * @brief テクスチャファイルを読み込み、画像にデコードします。ゲームスレッド以外から呼び出せます。
+     * Optionsに応じてミップの生成、ブロック圧縮も行います。ブロック圧縮は8bitの画像かつ幅と高さが4の倍数の場合のみ行います。
+     */
+    static bool Decode(const FString& TexturePath, FPLATEAUDecodedTexture& OutDecodedTexture,
+        const FPLATEAUTextureDecodeOptions& Options = FPLATEAUTextureDecodeOptions());
+    /**
+     * @brief デコード済みの画像からテクスチャアセットを作成します。ゲームスレッドから呼び出してください。
+     */
+    static UTexture2D* CreateTexture(const FString& TexturePath, const FPLATEAUDecodedTexture& DecodedTexture, bool OverwriteTextre);
+    // ".."を解決し、区切り文字を"/"に統一したパスを返します。
+    static FString NormalizeTexturePath(const FString& TexturePath);
     static UTexture2D* LoadTransient(const FString& TexturePath);
     static bool SaveTexture(UTexture2D* Texture, const FString& TexturePath);
 };
@@ -47,6 +47,7 @@ protected:
 
     virtual bool UseCachedMaterial() override;
     virtual bool MergeTriangles() override;
+    virtual bool UseBatchedReload() override;
     virtual void ModifyMeshDescription(FMeshDescription& MeshDescription) override;
 
 private:
@@ -9,6 +9,8 @@
 #include "PLATEAUMeshLoader.h"
 #include "Util/PLATEAUReconstructUtil.h"
 
+class FPLATEAUComponentCommandBuffer;
+
 //結合分離処理用MeshLoader
 class PLATEAURUNTIME_API FPLATEAUMeshLoaderForReconstruct : public FPLATEAUMeshLoader {
 
@@ -42,6 +44,28 @@ protected:
         ConvertGranularity Granularity,
         AActor& Actor);
 
+    // メッシュを持たないノードのComponentを作成します。同名、同階層のComponentが存在する場合は再利用します。ゲームスレッドから呼び出してください。
+    USceneComponent* ReloadSceneComponentInGameThread(
+        USceneComponent* ParentComponent,
+        const plateau::polygonMesh::Node& Node,
+        ConvertGranularity Granularity,
+        AActor& Actor);
+
+    /**
+     * @brief ノード以下のComponent作成をコマンドバッファに積みます。メッシュはPrepareMeshesInParallelで変換済みのものを利用します。
+     * 親Componentは先に積まれたコマンドで作成されるため、ParentSlot経由で参照します。
+     */
+    void EnqueueReloadNodeRecursive(
+        FPLATEAUComponentCommandBuffer& CommandBuffer,
+        const TSharedRef<USceneComponent*, ESPMode::ThreadSafe>& ParentSlot,
+        const plateau::polygonMesh::Node& InNode,
+        const FLoadInputData& LoadInputData,
+        ConvertGranularity Granularity,
+        AActor& InActor);
+
+    // メッシュの並列変換とComponent作成のバッチ化を行うか。ReloadNodeを上書きする場合はfalseを返してください。
+    virtual bool UseBatchedReload();
+
     UMaterialInterface* GetMaterialForSubMesh(const FSubMeshMaterialSet& SubMeshValue, UStaticMeshComponent* Component, const FLoadInputData& LoadInputData, UTexture2D* Texture, FNodeHierarchy NodeHier, UObject* Outer) override;
 
     UStaticMeshComponent* GetStaticMeshComponentForCondition(AActor& Actor, EName Name, FNodeHierarchy NodeHier,
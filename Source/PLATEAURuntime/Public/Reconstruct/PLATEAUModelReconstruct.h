@@ -18,6 +18,7 @@ public:
     virtual ~FPLATEAUModelReconstruct() = default;
     /**
      * @brief ComponentのChildrenからUPLATEAUCityObjectGroupを探してリストに追加します
+     * 可視のUPLATEAUInstancedCityObjectGroupは、インスタンス毎のUPLATEAUCityObjectGroupに置き換えてから追加します。
      */
     virtual TArray<UPLATEAUCityObjectGroup*> GetUPLATEAUCityObjectGroupsFromSceneComponents(TArray<USceneComponent*> TargetComponents);
 
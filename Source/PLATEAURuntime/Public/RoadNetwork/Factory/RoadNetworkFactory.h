@@ -87,6 +87,14 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
     bool bCheckLane = true;
 
+    // 道路毎の輪郭線の解析を並列に行う. 結果はスレッド数によらず同じ
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+    bool bParallelBuild = true;
+
+    // 差分更新で, 変更された地物から作り直す範囲を広げる距離[m]
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+    float UpdateHaloSize = 10.0f;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
     FRGraphFactory GraphFactory;
 
@@ -95,7 +103,25 @@ public:
 
 };
 
-struct FRoadNetworkFactoryEx
+// 道路構造の生成元の地物の状態. 差分更新で変更された地物の検出に使う
+USTRUCT()
+struct PLATEAURUNTIME_API FRnModelSourceState
+{
+    GENERATED_BODY()
+public:
+    UPROPERTY()
+    TWeakObjectPtr<UPLATEAUCityObjectGroup> CityObjectGroup;
+
+    // Transformとメッシュの頂点のハッシュ
+    UPROPERTY()
+    uint32 Hash = 0;
+
+    // ワールド座標での範囲
+    UPROPERTY()
+    FBox Bounds = FBox(ForceInit);
+};
+
+struct PLATEAURUNTIME_API FRoadNetworkFactoryEx
 {
    
     struct FCreateRnModelRequest {
@@ -105,10 +131,65 @@ struct FRoadNetworkFactoryEx
         //PLATEAURnStructureModel* OriginalMesh;
     };
 
+    // 差分更新の対象
+    struct FUpdateRnModelRequest {
+        // 現在の生成対象の地物とその範囲
+        TMap<UPLATEAUCityObjectGroup*, FBox> TargetBounds;
+        // 追加/変更/削除された地物
+        TSet<UPLATEAUCityObjectGroup*> ChangedTrans;
+        // 追加/変更/削除された範囲. 変更前の範囲も含む
+        TArray<FBox> ChangedBounds;
+    };
+
+    // 差分更新の結果
+    struct FUpdateRnModelResult {
+        // 以前の生成情報が無いため全体を作り直した
+        bool bFullRebuild = false;
+        // 追加/変更/削除された地物の数
+        int32 ChangedTranCount = 0;
+        // 作り直した地物の数
+        int32 RegionTranCount = 0;
+        // 接続先として読み込んだ地物の数
+        int32 ContextTranCount = 0;
+        // 削除/追加した道路と交差点の数
+        int32 RemovedRoadBaseCount = 0;
+        int32 AddedRoadBaseCount = 0;
+        // 更新後の道路構造がURnModel::Checkを満たすか
+        bool bIsValid = true;
+        // 処理時間[秒]
+        double Seconds = 0.0;
+    };
+
+    // 地物から最小地物を作成する関数
+    using FSubDivideFunc = TFunctionRef<void(const TArray<UPLATEAUCityObjectGroup*>&, TArray<FSubDividedCityObject>&)>;
+
     static void CreateRnModel(const FRoadNetworkFactory& Self, APLATEAUInstancedCityModel* Actor, APLATEAURnStructureModel* DestActor);
 
+    // 前回の生成から追加/変更/削除された地物の周辺だけ道路構造を作り直す
+    // 前回の生成情報が無い場合は全体を作り直す. bSaveTmpDataの場合は作り直した地物の最小地物(SubDivided)も置き換える
+    static FUpdateRnModelResult UpdateRnModel(const FRoadNetworkFactory& Self, APLATEAUInstancedCityModel* Actor, APLATEAURnStructureModel* DestActor);
+
+    // Request.ChangedBoundsの周辺の地物から作られた道路構造をModelから削除し, SubDivideで作成した最小地物から作り直して既存の道路構造と境界線を共有して繋ぐ
+    static FUpdateRnModelResult UpdateRnModel(
+        const FRoadNetworkFactory& Self
+        , URnModel* Model
+        , const FUpdateRnModelRequest& Request
+        , FSubDivideFunc SubDivide);
+
+    // 地物のTransformとメッシュから状態を作成する
+    static FRnModelSourceState CreateSourceState(UPLATEAUCityObjectGroup* Target);
+
+    // 前回の生成時の状態OldStatesと現在の状態NewStatesを比較して, 追加/変更/削除された地物を差分更新の対象にする
+    static FUpdateRnModelRequest CreateUpdateRequest(const TArray<FRnModelSourceState>& OldStates, const TArray<FRnModelSourceState>& NewStates);
+
     // Targetが生成対象かどうか
     static bool IsConvertTarget(UPLATEAUCityObjectGroup* Target);
+
+    // GraphからOutModelにRnModelを作成する
+    static  TRnRef_T<URnModel> CreateRnModel(
+        const FRoadNetworkFactory& Self
+        , RGraphRef_t<URGraph> Graph
+        , URnModel* OutModel);
 private:
 
     static TRnRef_T<URnModel> CreateRoadNetwork(
@@ -118,6 +199,20 @@ private:
         , TArray<UPLATEAUCityObjectGroup*>& CityObjectGroups
     );
 
+    // 保存済みの最小地物のうちTransから作られたものをSubDividedCityObjectsで置き換える
+    static void UpdateSubDividedCityObjects(const FRoadNetworkFactory& Self
+        , AActor* DestActor
+        , const TSet<UPLATEAUCityObjectGroup*>& Trans
+        , const TArray<FSubDividedCityObject>& SubDividedCityObjects);
+
+    // 生成対象の地物を最小地物に分解する
+    static void ConvertSubDividedCityObjects(APLATEAUInstancedCityModel* Actor
+        , const TArray<UPLATEAUCityObjectGroup*>& CityObjectGroups
+        , TArray<FSubDividedCityObject>& OutSubDividedCityObjects);
+
+    // 生成対象の地物の状態を作成する
+    static TArray<FRnModelSourceState> CreateSourceStates(const TArray<UPLATEAUCityObjectGroup*>& CityObjectGroups);
+
     // 最小地物に分解する
     static void CreateSubDividedCityObjects(const FRoadNetworkFactory& Self, APLATEAUInstancedCityModel* Actor
         , AActor* DestActor
@@ -131,12 +226,6 @@ private:
         , USceneComponent* Root
         , TArray<FSubDividedCityObject>& SubDividedCityObjects
         , RGraphRef_t<URGraph>& OutGraph);
-
-    // RnModelを作成する
-    static  TRnRef_T<URnModel> CreateRnModel(
-        const FRoadNetworkFactory& Self
-        , RGraphRef_t<URGraph> Graph
-        , URnModel* OutModel);
 };
 
 
@@ -0,0 +1,121 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RGraphDef.h"
+
+class UPLATEAUCityObjectGroup;
+class URGraph;
+
+/**
+ * @brief URGraphと同じ頂点・辺・面の接続を、要素毎の連続した配列と整数のハンドル(配列のインデックス)で保持するグラフです。
+ *
+ * 要素毎にUObjectを作成しないため、都市全体の道路のようにURGraphでは数百万のUObjectとなる場合でも、GCやポインタのハッシュ計算の負荷がかかりません。
+ * 面 -> 辺の接続は追加時に、頂点 -> 辺、辺 -> 面の接続はBuildAdjacencyでCSR形式(要素iの範囲は Offsets[i] ～ Offsets[i + 1])で作成します。
+ * 道路タイプは面毎に保持し、頂点・辺毎のマスク(接続する面の道路タイプのor)はBuildAdjacencyで別の配列に作成します。
+ *
+ * 同じ頂点の組の辺は常に1つにまとめます。頂点・辺の削減や面の分割(FRGraphExのFRCompactGraph版)は、CopyVerticesで作成したグラフに
+ * 変更後の面・辺を追加して置き換えるため、処理の前後で辺・面のハンドルは変わります(頂点のハンドルは変わりません)。
+ * URGraphとの変換(FromGraph, ToGraph)はFRGraphExの処理の境界でのみ行います。
+ */
+struct PLATEAURUNTIME_API FRCompactGraph {
+    // 頂点
+    TArray<FVector> VertexPositions;
+
+    // 辺毎の頂点(V0, V1)
+    TArray<int32> EdgeV0;
+    TArray<int32> EdgeV1;
+
+    // 面
+    TArray<TWeakObjectPtr<UPLATEAUCityObjectGroup>> FaceCityObjectGroups;
+    TArray<ERRoadTypeMask> FaceRoadTypes;
+    TArray<int32> FaceLodLevels;
+
+    // 面 -> 辺 (CSR)
+    TArray<int32> FaceEdgeOffsets = { 0 };
+    TArray<int32> FaceEdges;
+
+    // 頂点 -> 辺, 辺 -> 面 (CSR, BuildAdjacencyで作成)
+    TArray<int32> VertexEdgeOffsets;
+    TArray<int32> VertexEdges;
+    TArray<int32> EdgeFaceOffsets;
+    TArray<int32> EdgeFaces;
+
+    // 頂点・辺に接続する面の道路タイプのor (BuildAdjacencyで作成)
+    TArray<ERRoadTypeMask> VertexRoadTypes;
+    TArray<ERRoadTypeMask> EdgeRoadTypes;
+
+    int32 GetVertexCount() const { return VertexPositions.Num(); }
+    int32 GetEdgeCount() const { return EdgeV0.Num(); }
+    int32 GetFaceCount() const { return FaceRoadTypes.Num(); }
+
+    int32 AddVertex(const FVector& Position);
+
+    // 同じ頂点の組の辺がすでにあればそれを返します
+    int32 FindOrAddEdge(const int32 V0, const int32 V1);
+
+    /**
+     * @brief 面を追加します。続けてAddFaceEdgeで面の辺を追加してください。
+     */
+    int32 AddFace(UPLATEAUCityObjectGroup* CityObjectGroup, const ERRoadTypeMask RoadTypes, const int32 LodLevel);
+
+    // 最後に追加した面に辺を追加します。同じ辺は1度だけ追加されます。
+    void AddFaceEdge(const int32 Edge);
+
+    // 頂点 -> 辺、辺 -> 面の接続と頂点・辺の道路タイプを作成します。面・辺の追加後に呼び出してください。
+    void BuildAdjacency();
+
+    TConstArrayView<int32> GetFaceEdges(const int32 Face) const {
+        return MakeArrayView(FaceEdges.GetData() + FaceEdgeOffsets[Face], FaceEdgeOffsets[Face + 1] - FaceEdgeOffsets[Face]);
+    }
+
+    TConstArrayView<int32> GetVertexEdges(const int32 Vertex) const {
+        return MakeArrayView(VertexEdges.GetData() + VertexEdgeOffsets[Vertex], VertexEdgeOffsets[Vertex + 1] - VertexEdgeOffsets[Vertex]);
+    }
+
+    TConstArrayView<int32> GetEdgeFaces(const int32 Edge) const {
+        return MakeArrayView(EdgeFaces.GetData() + EdgeFaceOffsets[Edge], EdgeFaceOffsets[Edge + 1] - EdgeFaceOffsets[Edge]);
+    }
+
+    // 辺の頂点のうちVertexでない方を返します
+    int32 GetOppositeVertex(const int32 Edge, const int32 Vertex) const {
+        return EdgeV0[Edge] == Vertex ? EdgeV1[Edge] : EdgeV0[Edge];
+    }
+
+    // 頂点に接続する面の最大のLODを返します。接続する面がない場合は-1です。
+    int32 GetVertexMaxLodLevel(const int32 Vertex) const;
+
+    /**
+     * @brief 頂点の位置のみを引き継いだ、面・辺を持たないグラフを作成します。
+     * 面・辺を追加してBuildAdjacencyを呼び出した後、元のグラフと置き換えてください。
+     */
+    FRCompactGraph CopyVertices() const;
+
+    // SrcのSrcFace番目の面と同じCityObjectGroup・道路タイプ・LODの面を追加します。続けてAddFaceEdgeで面の辺を追加してください。
+    int32 AddFaceFrom(const FRCompactGraph& Src, const int32 SrcFace);
+
+    /**
+     * @brief 頂点をVertexRemap[頂点]に統合して辺・面を作り直します(URVertex::MergeToに相当します)。
+     * 両端が同じ頂点になった辺は削除し、同じ頂点の組になった辺は1つにまとめます。統合先がさらに統合される場合は最後の統合先に統合します。
+     */
+    void MergeVertices(const TArray<int32>& VertexRemap);
+
+    SIZE_T GetAllocatedSize() const;
+
+    /**
+     * @brief URGraphから作成します。頂点・辺のハンドルは面・辺の列挙順に割り当てます。
+     */
+    static FRCompactGraph FromGraph(const URGraph& Graph);
+
+    /**
+     * @brief URGraphを作成します。辺を持たない頂点は作成しません。
+     */
+    URGraph* ToGraph() const;
+
+private:
+    // 頂点の組(小さい方が上位) -> 辺
+    TMap<uint64, int32> EdgeMap;
+    // 辺を最後に追加した面。面への同じ辺の重複追加を防ぎます
+    TArray<int32> EdgeLastFace;
+};
@@ -13,20 +13,31 @@
 
 class FSubDividedCityObject;
 class UPLATEAUCityObjectGroup;
-class FRGraphEx {
+struct FRCompactGraph;
+class PLATEAURUNTIME_API FRGraphEx {
 public:
     static void RemoveInnerVertex(RGraphRef_t<URFace> Face);
     static void RemoveInnerVertex(RGraphRef_t<URGraph> Graph);
     static TSet<RGraphRef_t<URVertex>> AdjustSmallLodHeight(RGraphRef_t<URGraph> Graph, float MergeCellSizeMeter, int32 MergeCellLength, float HeightToleranceMeter);
+    // FRCompactGraph版. 高さを調整した頂点のハンドルを返す
+    static TArray<int32> AdjustSmallLodHeight(FRCompactGraph& Graph, float MergeCellSizeMeter, int32 MergeCellLength, float HeightToleranceMeter);
     static void VertexReduction(RGraphRef_t<URGraph> Graph, float MergeCellSizeMeter, int32 MergeCellLength, float MidPointToleranceMeter);
+    // FRCompactGraph版. 直線状の頂点の削除は, 接続が変わる頂点が重ならないものをまとめて行う
+    static void VertexReduction(FRCompactGraph& Graph, float MergeCellSizeMeter, int32 MergeCellLength, float MidPointToleranceMeter);
     static void EdgeReduction(RGraphRef_t<URGraph> Graph);
+    // FRCompactGraph版. 同じ頂点の組の辺は常に1つにまとまっているため, 同じ辺の集合を持つ面の統合(UREdge::MergeToの面の統合)のみ行う
+    static void EdgeReduction(FRCompactGraph& Graph);
     static void MergeIsolatedVertices(RGraphRef_t<URGraph> Graph);
     static void MergeIsolatedVertex(RGraphRef_t<URFace> Face);
     static TArray<RGraphRef_t<URFaceGroup>> GroupBy(RGraphRef_t<URGraph> Graph, TFunction<bool(RGraphRef_t<URFace>, RGraphRef_t<URFace>)> IsMatch);
     static void InsertVertexInNearEdge(RGraphRef_t<URGraph> Graph, float ToleranceMeter);
+    // FRCompactGraph版
+    static void InsertVertexInNearEdge(FRCompactGraph& Graph, float ToleranceMeter);
     static void InsertVerticesInEdgeIntersection(RGraphRef_t<URGraph> Graph, float HeightToleranceMeter);
     static TArray<RGraphRef_t<UREdge>> InsertVertices(RGraphRef_t<UREdge> Edge, TArray<RGraphRef_t<URVertex>> Vertices);
     static void SeparateFaces(RGraphRef_t<URGraph> Graph);
+    // FRCompactGraph版. 分離した面は全ての面の後に追加する
+    static void SeparateFaces(FRCompactGraph& Graph);
     static void SeparateFace(RGraphRef_t<URFace> Face);
     static TArray<RGraphRef_t<URVertex>> ComputeOutlineVertices(const TArray<RGraphRef_t<URFace>>& Faces);
     static TArray<RGraphRef_t<URVertex>> ComputeOutlineVertices(RGraphRef_t<URFace> Face);
@@ -36,6 +47,8 @@ public:
     static bool IsShareEdge(RGraphRef_t<URFace> A, RGraphRef_t<URFace> B);
     static TSet<RGraphRef_t<URVertex>> CreateVertexSet(RGraphRef_t<URFace> Face);
     static void RemoveIsolatedEdgeFromFace(RGraphRef_t<URGraph> Self);
+    // FRCompactGraph版
+    static void RemoveIsolatedEdgeFromFace(FRCompactGraph& Self);
     static TSet<RGraphRef_t<UREdge>> RemoveIsolatedEdge(RGraphRef_t<URFace> Self);
 
     // Edgesで表現された線分を頂点配列に分解
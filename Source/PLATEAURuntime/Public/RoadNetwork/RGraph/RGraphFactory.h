@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "RGraph.h"
+#include "RCompactGraph.h"
 #include "RGraphFactory.generated.h"
 struct FSubDividedCityObject;
 class UPLATEAUCityObjectGroup;
@@ -57,9 +58,25 @@ public:
     // 全く同じ辺を持つFaceを統合する
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|Factory|Optimize")
     bool bFaceReduction = true;
+
+    // 頂点・辺の削減と面の分割をFRCompactGraph上で行い, URGraphへの変換は最後に1度だけ行う. falseの場合は変換後のURGraph上で行う(比較用)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|Factory|Optimize")
+    bool bOptimizeCompactGraph = true;
 };
 
-struct FRGraphFactoryEx
+struct PLATEAURUNTIME_API FRGraphFactoryEx
 {
     static RGraphRef_t<URGraph> CreateGraph(const FRGraphFactory& Factory, const TArray<FSubDividedCityObject>& CityObjects);
+
+    // CityObjectsの頂点・辺・面をFRCompactGraphとして作成します. 同じ位置の頂点, 同じ頂点を持つ辺は1つにまとめます
+    static FRCompactGraph CreateCompactGraph(const FRGraphFactory& Factory, const TArray<FSubDividedCityObject>& CityObjects);
+
+    // URGraphに対して頂点・辺の削減や面の分割等の最適化を行います
+    static RGraphRef_t<URGraph> Optimize(const FRGraphFactory& Factory, RGraphRef_t<URGraph> Graph);
+
+    // FRCompactGraphに対して頂点・辺の削減と面の分割を行います. 残りの最適化はURGraphに変換後OptimizeFacesで行います
+    static void Optimize(const FRGraphFactory& Factory, FRCompactGraph& Graph);
+
+    // URGraphに対して歩道の形状の調整と面の統合を行います
+    static RGraphRef_t<URGraph> OptimizeFaces(const FRGraphFactory& Factory, RGraphRef_t<URGraph> Graph);
 };
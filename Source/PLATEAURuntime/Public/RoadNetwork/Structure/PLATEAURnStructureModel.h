@@ -27,6 +27,10 @@ public:
     UPROPERTY(EditAnywhere, Category = "PLATEAU|Debug")
     FPLATEAURnModelDrawerDebug Debug;
 
+    // 道路構造を生成した時の地物の状態. 差分更新で変更された地物の検出に使う
+    UPROPERTY()
+    TArray<FRnModelSourceState> SourceStates;
+
     /**
      * @brief 道路構造生成処理終了イベント
      */
@@ -38,6 +42,13 @@ public:
      * @param
      */
     UE::Tasks::TTask<APLATEAURnStructureModel*> CreateRnModelAsync(APLATEAUInstancedCityModel* TargetActor);
+
+    /**
+     * @brief 前回の生成から変更された地物の周辺だけ道路構造を作り直します。前回の生成情報が無い場合は全体を作り直します
+     * @param TargetActor 道路構造の生成元のモデル
+     */
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries")
+    void UpdateRnModel(APLATEAUInstancedCityModel* TargetActor);
 public:
     virtual void Tick(float DeltaTime) override;
 };
@@ -39,7 +39,7 @@ public:
 };
 
 UCLASS(ClassGroup = (Custom), BlueprintType, Blueprintable, meta = (BlueprintSpawnableComponent))
-class URnModel : public UPLATEAUSceneComponent
+class PLATEAURUNTIME_API URnModel : public UPLATEAUSceneComponent
 {
 public:
     const FString& GetFactoryVersion() const;
@@ -18,7 +18,7 @@ class URnRoad;
 class URnIntersection;
 
 UCLASS(ClassGroup = (Custom), BlueprintType, Blueprintable, meta = (BlueprintSpawnableComponent))
-class URnRoadBase : public UObject
+class PLATEAURUNTIME_API URnRoadBase : public UObject
 {
     GENERATED_BODY()
 public:
@@ -17,7 +17,7 @@
 #include "RnWay.generated.h"
 
 UCLASS(ClassGroup = (Custom), BlueprintType, Blueprintable, meta = (BlueprintSpawnableComponent))
-class URnWay : public UObject
+class PLATEAURUNTIME_API URnWay : public UObject
 {
     GENERATED_BODY()
 public:
@@ -0,0 +1,33 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief インポート時のテクスチャ加工(ミップマップ生成、ブロック圧縮)を行います。
+ * いずれもBGRA8の画像を対象とし、ワーカースレッドから呼び出せます。
+ */
+class PLATEAURUNTIME_API FPLATEAUTextureUtil {
+public:
+    /**
+     * @brief 2x2のボックスフィルタで縮小した画像を作成します。奇数サイズの端は端の画素を繰り返します。
+     * 4チャンネルを64bitレジスタ内で同時に計算します。
+     */
+    static void DownsampleBGRA8(const uint8* Src, const int32 SrcWidth, const int32 SrcHeight,
+        uint8* Dst, const int32 DstWidth, const int32 DstHeight);
+
+    /**
+     * @brief Mip1から1x1までのミップを生成します。
+     */
+    static void BuildMipChain(const TArray64<uint8>& Mip0, const int32 Width, const int32 Height, TArray<TArray64<uint8>>& OutMipChain);
+
+    // 不透明でない画素があるか
+    static bool HasTransparentPixel(const TArray64<uint8>& Image);
+
+    /**
+     * @brief BC1(DXT1)またはBC3(DXT5)にブロック圧縮します。
+     * @param bWithAlpha trueの場合BC3、falseの場合BC1
+     */
+    static void CompressBC(const uint8* Image, const int32 Width, const int32 Height, const bool bWithAlpha, TArray64<uint8>& OutBlocks);
+};
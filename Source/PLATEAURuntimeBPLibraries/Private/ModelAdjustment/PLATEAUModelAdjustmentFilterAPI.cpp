@@ -60,7 +60,7 @@ void UPLATEAUModelAdjustmentFilterAPI::ApplyFilter(APLATEAUInstancedCityModel* T
     for (const auto& Entity : PackageToLodRangeMap) {
         CastPackageToLodRangeMap.Add(static_cast<plateau::dataset::PredefinedCityModelPackage>(Entity.Key), { Entity.Value.MinLod, Entity.Value.MaxLod });
     }
-    TargetCityModel->FilterByLods(static_cast<plateau::dataset::PredefinedCityModelPackage>(EnablePackage), CastPackageToLodRangeMap, bOnlyMaxLod)->FilterByFeatureTypes(static_cast<CityObject::CityObjectsType>(EnableCityObject | HiddenFeatureTypes));
+    TargetCityModel->FilterByLodsAndFeatureTypes(static_cast<plateau::dataset::PredefinedCityModelPackage>(EnablePackage), CastPackageToLodRangeMap, bOnlyMaxLod, static_cast<CityObject::CityObjectsType>(EnableCityObject | HiddenFeatureTypes));
 }
 
 void UPLATEAUModelAdjustmentFilterAPI::FilterModel(APLATEAUInstancedCityModel* TargetCityModel, const TArray<EPLATEAUCityModelPackage> EnablePackages, const TMap<EPLATEAUCityModelPackage, FPLATEAUPackageLod>& PackageToLodRangeMap, const bool bOnlyMaxLod, const TArray<EPLATEAUCityObjectsType> EnableCityObjects) {
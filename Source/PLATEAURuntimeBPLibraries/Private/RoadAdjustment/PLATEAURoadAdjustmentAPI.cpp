@@ -15,3 +15,13 @@ void UPLATEAURoadAdjustmentAPI::CreateRnModel(APLATEAUInstancedCityModel* Target
     FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(TEXT("この機能は、エディタのみでご利用いただけます。")));
 #endif
 }
+
+void UPLATEAURoadAdjustmentAPI::UpdateRnModel(APLATEAUInstancedCityModel* TargetCityModel,
+                                              APLATEAURnStructureModel* DestActor)
+{
+#if WITH_EDITOR
+    DestActor->UpdateRnModel(TargetCityModel);
+#else
+    FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(TEXT("この機能は、エディタのみでご利用いただけます。")));
+#endif
+}
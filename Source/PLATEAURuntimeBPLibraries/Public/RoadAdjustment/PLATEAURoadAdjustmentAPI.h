@@ -17,4 +17,8 @@ class PLATEAURUNTIMEBPLIBRARIES_API UPLATEAURoadAdjustmentAPI : public UBlueprin
 public:
     UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|RoadAdjustmentAPI")
     static void CreateRnModel(APLATEAUInstancedCityModel* TargetCityModel, APLATEAURnStructureModel* DestActor);
+
+    // 前回の生成から変更された道路の地物の周辺だけ道路構造を作り直します
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|RoadAdjustmentAPI")
+    static void UpdateRnModel(APLATEAUInstancedCityModel* TargetCityModel, APLATEAURnStructureModel* DestActor);
 };
@@ -0,0 +1,194 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUModelCache.h"
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
+#include "CityGML/Serialization/PLATEAUCityObjectDeserialization.h"
+#include "citygml/citygml.h"
+#include "plateau/polygon_mesh/mesh_extractor.h"
+#include <plateau/polygon_mesh/model.h>
+
+namespace FPLATEAUTest_Benchmark_CityObjectBinary_Local {
+    bool EqualsAttributeMap(const FPLATEAUAttributeMap& A, const FPLATEAUAttributeMap& B) {
+        if (A.AttributeMap.Num() != B.AttributeMap.Num())
+            return false;
+
+        for (const auto& [Key, Value] : A.AttributeMap) {
+            const auto Other = B.AttributeMap.Find(Key);
+            if (Other == nullptr || Other->Type != Value.Type || Other->StringValue != Value.StringValue ||
+                Other->IntValue != Value.IntValue || Other->DoubleValue != Value.DoubleValue)
+                return false;
+
+            if (Value.Type == EPLATEAUAttributeType::AttributeSets &&
+                (!Value.Attributes.IsValid() || !Other->Attributes.IsValid() || !EqualsAttributeMap(*Value.Attributes, *Other->Attributes)))
+                return false;
+        }
+        return true;
+    }
+
+    bool EqualsCityObject(const FPLATEAUCityObject& A, const FPLATEAUCityObject& B) {
+        if (A.GmlID != B.GmlID || !(A.CityObjectIndex == B.CityObjectIndex) || A.Type != B.Type ||
+            A.Children.Num() != B.Children.Num() || !EqualsAttributeMap(A.Attributes, B.Attributes))
+            return false;
+
+        for (int32 i = 0; i < A.Children.Num(); ++i) {
+            if (!EqualsCityObject(A.Children[i], B.Children[i]))
+                return false;
+        }
+        return true;
+    }
+}
+
+/// <summary>
+/// 属性情報のバイナリ形式の計測
+/// 同梱テストデータのGMLについて、Json形式とバイナリ形式のサイズ、シリアライズ・変換時間、インデックスによる検索時間を出力し、
+/// 直接シリアライズしたバイナリがJsonからの変換結果と一致すること、バイナリ形式から復元した属性情報がJsonから復元したものと一致することを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_CityObjectBinary, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.CityObjectBinary",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_CityObjectBinary::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_CityObjectBinary_Local;
+    InitializeTest("Benchmark.CityObjectBinary");
+
+    const FString GmlPath = FPLATEAURuntimeModule::GetContentDir().Append("/TestData/data/udx/bldg/53392642_bldg_6697_op2.gml");
+    citygml::ParserParams ParserParams;
+    ParserParams.tesselate = true;
+    const auto CityModel = citygml::load(TCHAR_TO_UTF8(*GmlPath), ParserParams);
+    if (CityModel == nullptr) {
+        FinishTest(false, "Failed to load CityModel");
+        return true;
+    }
+
+    plateau::polygonMesh::MeshExtractOptions ExtractOptions;
+    ExtractOptions.mesh_granularity = plateau::polygonMesh::MeshGranularity::PerPrimaryFeatureObject;
+    ExtractOptions.mesh_axes = plateau::geometry::CoordinateSystem::ESU;
+    ExtractOptions.coordinate_zone_id = 9;
+    ExtractOptions.attach_map_tile = false;
+    const auto Model = plateau::polygonMesh::MeshExtractor::extract(*CityModel, ExtractOptions);
+    const double SerializeStartSeconds = FPlatformTime::Seconds();
+    const auto CityObjects = FPLATEAUModelCache::SerializeCityObjects(*Model, CityModel, ExtractOptions.mesh_granularity);
+    const double SerializeSeconds = FPlatformTime::Seconds() - SerializeStartSeconds;
+
+    // シリアライザが直接作成したバイナリと、比較用の旧形式のJson
+    TArray<TArray<uint8>> SerializedBinaries;
+    CityObjects->MeshToSerializedCityObjects.GenerateValueArray(SerializedBinaries);
+    for (const auto& [Node, Serialized] : CityObjects->NodeToSerializedCityObjects) {
+        SerializedBinaries.Add(Serialized);
+    }
+    TArray<FString> Jsons;
+    for (const auto& Serialized : SerializedBinaries) {
+        Jsons.Add(FPLATEAUCityObjectBinary(Serialized).ToJson());
+    }
+
+    // サイズと旧形式からの移行時間
+    int64 JsonBytes = 0;
+    int64 BinaryBytes = 0;
+    TArray<TArray<uint8>> Binaries;
+    const double ConvertStartSeconds = FPlatformTime::Seconds();
+    for (const auto& Json : Jsons) {
+        JsonBytes += FTCHARToUTF8(*Json).Length();
+        if (!FPLATEAUCityObjectBinary::FromJson(Json, Binaries.AddDefaulted_GetRef())) {
+            FinishTest(false, "Failed to convert Json");
+            return true;
+        }
+        BinaryBytes += Binaries.Last().Num();
+    }
+    const double ConvertSeconds = FPlatformTime::Seconds() - ConvertStartSeconds;
+
+    // Jsonを経由せずに作成したバイナリがJsonから変換したものと一致すること
+    for (int32 i = 0; i < Binaries.Num(); ++i) {
+        if (Binaries[i] != SerializedBinaries[i]) {
+            FinishTest(false, FString::Printf(TEXT("Serialized binary differs from Json conversion: %d"), i));
+            return true;
+        }
+    }
+
+    // ツリーの復元時間
+    FPLATEAUCityObjectDeserialization Deserializer;
+    TArray<TArray<FPLATEAUCityObject>> JsonRootCityObjects;
+    const double JsonTreeStartSeconds = FPlatformTime::Seconds();
+    for (const auto& Json : Jsons) {
+        FString OutsideParent;
+        TArray<FString> OutsideChildren;
+        Deserializer.DeserializeCityObjects(Json, JsonRootCityObjects.AddDefaulted_GetRef(), OutsideParent, OutsideChildren);
+    }
+    const double JsonTreeSeconds = FPlatformTime::Seconds() - JsonTreeStartSeconds;
+
+    TArray<TArray<FPLATEAUCityObject>> BinaryRootCityObjects;
+    const double BinaryTreeStartSeconds = FPlatformTime::Seconds();
+    for (const auto& Binary : Binaries) {
+        FPLATEAUCityObjectBinary(Binary).ToCityObjects(BinaryRootCityObjects.AddDefaulted_GetRef());
+    }
+    const double BinaryTreeSeconds = FPlatformTime::Seconds() - BinaryTreeStartSeconds;
+
+    // 読み込み直後のコンポーネントでの検索(Json: 復元してから走査、バイナリ: ツリーを作らずに検索)
+    int32 LookupCount = 0;
+    const double JsonLookupStartSeconds = FPlatformTime::Seconds();
+    for (const auto& Json : Jsons) {
+        TArray<FPLATEAUCityObject> Roots;
+        FString OutsideParent;
+        TArray<FString> OutsideChildren;
+        Deserializer.DeserializeCityObjects(Json, Roots, OutsideParent, OutsideChildren);
+        for (const auto& Root : Roots) {
+            for (const auto& Candidate : Roots) {
+                if (Candidate.CityObjectIndex == Root.CityObjectIndex)
+                    break;
+            }
+            ++LookupCount;
+        }
+    }
+    const double JsonLookupSeconds = FPlatformTime::Seconds() - JsonLookupStartSeconds;
+
+    const double BinaryLookupStartSeconds = FPlatformTime::Seconds();
+    for (const auto& Binary : Binaries) {
+        const FPLATEAUCityObjectBinary CityObjectsBinary(Binary);
+        for (int32 i = 0; i < CityObjectsBinary.GetRootCount(); ++i) {
+            FPLATEAUAttributeValue Value;
+            CityObjectsBinary.TryGetAttribute(CityObjectsBinary.FindByIndex(CityObjectsBinary.GetCityObjectIndex(i)), TEXT("bldg:measuredHeight"), Value);
+        }
+    }
+    const double BinaryLookupSeconds = FPlatformTime::Seconds() - BinaryLookupStartSeconds;
+
+    AddInfo(FString::Printf(TEXT("Components: %d, Size: Json %.1f KB -> Binary %.1f KB (%.1f%%)"), Jsons.Num(),
+        JsonBytes / 1024.0, BinaryBytes / 1024.0, 100.0 * BinaryBytes / FMath::Max<int64>(JsonBytes, 1)));
+    AddInfo(FString::Printf(TEXT("Serialize: %.3f ms, Convert from Json: %.3f ms, Tree: Json %.3f ms / Binary %.3f ms"),
+        SerializeSeconds * 1000.0, ConvertSeconds * 1000.0, JsonTreeSeconds * 1000.0, BinaryTreeSeconds * 1000.0));
+    AddInfo(FString::Printf(TEXT("Lookup (%d): Json %.3f us / Binary %.3f us per lookup"), LookupCount,
+        JsonLookupSeconds * 1e6 / FMath::Max(LookupCount, 1), BinaryLookupSeconds * 1e6 / FMath::Max(LookupCount, 1)));
+
+    // Jsonから復元したものと一致すること
+    for (int32 i = 0; i < Jsons.Num(); ++i) {
+        if (JsonRootCityObjects[i].Num() != BinaryRootCityObjects[i].Num()) {
+            FinishTest(false, FString::Printf(TEXT("Root count differs: %d"), i));
+            return true;
+        }
+        for (int32 j = 0; j < JsonRootCityObjects[i].Num(); ++j) {
+            if (!EqualsCityObject(JsonRootCityObjects[i][j], BinaryRootCityObjects[i][j])) {
+                FinishTest(false, FString::Printf(TEXT("City object differs: %s"), *JsonRootCityObjects[i][j].GmlID));
+                return true;
+            }
+        }
+
+        // Jsonに戻して再変換しても同じバイナリとなること
+        TArray<uint8> Reconverted;
+        if (!FPLATEAUCityObjectBinary::FromJson(FPLATEAUCityObjectBinary(Binaries[i]).ToJson(), Reconverted) || Reconverted != Binaries[i]) {
+            FinishTest(false, FString::Printf(TEXT("Json round trip differs: %d"), i));
+            return true;
+        }
+    }
+
+    // 壊れたデータは無効として扱うこと
+    if (0 < Binaries.Num() && 0 < Binaries[0].Num()) {
+        TArray<uint8> Truncated = Binaries[0];
+        Truncated.SetNum(Truncated.Num() / 2);
+        if (FPLATEAUCityObjectBinary(Truncated).IsValid()) {
+            FinishTest(false, "Truncated binary is valid");
+            return true;
+        }
+    }
+
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,141 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "PLATEAUInstancedCityModel.h"
+
+namespace FPLATEAUTest_Benchmark_CityObjectLookup_Local {
+    constexpr int32 ChildCount = 5000;
+    constexpr int32 LookupCount = 100000;
+
+    FString MakeChildGmlID(const int32 Index) {
+        return FString::Printf(TEXT("bldg_%08d"), Index);
+    }
+
+    // 索引導入前のGetCityObjectByIndexと同じ線形探索
+    const FPLATEAUCityObject* FindByLinearScan(const TArray<FPLATEAUCityObject>& RootCityObjects, const FPLATEAUCityObjectIndex& Index) {
+        for (const auto& RootCityObject : RootCityObjects) {
+            if (RootCityObject.CityObjectIndex == Index)
+                return &RootCityObject;
+
+            for (const auto& ChildCityObject : RootCityObject.Children) {
+                if (ChildCityObject.CityObjectIndex == Index)
+                    return &ChildCityObject;
+            }
+        }
+        return nullptr;
+    }
+}
+
+/// <summary>
+/// シティオブジェクト検索の計測
+/// 地域単位相当の多数のシティオブジェクトを持つコンポーネントについて、線形探索とインデックス・GML IDの索引による検索の
+/// 1秒あたりの検索回数を出力し、検索結果が一致することを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_CityObjectLookup, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.CityObjectLookup",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_CityObjectLookup::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_CityObjectLookup_Local;
+    InitializeTest("Benchmark.CityObjectLookup");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto ModelActor = PLATEAUAutomationTestUtil::Fixtures::CreateActor(*GetWorld());
+    const auto CityObjectGroup = ModelActor->FindComponentByTag<UPLATEAUCityObjectGroup>(PLATEAUAutomationTestUtil::Fixtures::TEST_OBJ_TAG);
+    if (CityObjectGroup == nullptr) {
+        FinishTest(false, "CityObjectGroup not found");
+        return true;
+    }
+
+    FPLATEAUCityObject RootCityObject;
+    PLATEAUAutomationTestUtil::Fixtures::CreateCityObjectBuilding(RootCityObject);
+    RootCityObject.Children.Empty();
+    for (int32 i = 0; i < ChildCount; ++i) {
+        auto& Child = RootCityObject.Children.AddDefaulted_GetRef();
+        Child.SetGmlID(MakeChildGmlID(i));
+        Child.CityObjectIndex = FPLATEAUCityObjectIndex(i + 1, -1);
+        Child.SetCityObjectsType(PLATEAUAutomationTestUtil::Fixtures::TEST_CITYOBJ_TYPE);
+    }
+    CityObjectGroup->SerializeCityObject(RootCityObject);
+
+    TArray<FPLATEAUCityObjectIndex> Queries;
+    FRandomStream RandomStream(0);
+    for (int32 i = 0; i < LookupCount; ++i) {
+        Queries.Add(FPLATEAUCityObjectIndex(RandomStream.RandRange(1, ChildCount), -1));
+    }
+
+    // 線形探索
+    const auto RootCityObjects = CityObjectGroup->GetAllRootCityObjects();
+    int32 LinearFoundCount = 0;
+    const double LinearStartSeconds = FPlatformTime::Seconds();
+    for (const auto& Query : Queries) {
+        if (FindByLinearScan(RootCityObjects, Query) != nullptr)
+            ++LinearFoundCount;
+    }
+    const double LinearSeconds = FPlatformTime::Seconds() - LinearStartSeconds;
+
+    // インデックスの索引(初回の索引作成を含む)
+    int32 IndexedFoundCount = 0;
+    const double IndexedStartSeconds = FPlatformTime::Seconds();
+    for (const auto& Query : Queries) {
+        if (CityObjectGroup->FindCityObjectByIndex(Query) != nullptr)
+            ++IndexedFoundCount;
+    }
+    const double IndexedSeconds = FPlatformTime::Seconds() - IndexedStartSeconds;
+
+    // アクター全体のGML IDの索引
+    TArray<FString> GmlIDQueries;
+    for (const auto& Query : Queries) {
+        GmlIDQueries.Add(MakeChildGmlID(Query.PrimaryIndex - 1));
+    }
+    int32 ActorFoundCount = 0;
+    const double ActorStartSeconds = FPlatformTime::Seconds();
+    for (const auto& GmlID : GmlIDQueries) {
+        UPLATEAUCityObjectGroup* FoundComponent = nullptr;
+        if (ModelActor->FindCityObjectByGmlID(GmlID, &FoundComponent) != nullptr && FoundComponent == CityObjectGroup)
+            ++ActorFoundCount;
+    }
+    const double ActorSeconds = FPlatformTime::Seconds() - ActorStartSeconds;
+
+    AddInfo(FString::Printf(TEXT("City objects: %d, Lookups: %d"), ChildCount + 1, LookupCount));
+    AddInfo(FString::Printf(TEXT("Linear scan: %.0f lookups/s, Index: %.0f lookups/s, Actor GmlID index: %.0f lookups/s"),
+        LookupCount / FMath::Max(LinearSeconds, UE_SMALL_NUMBER),
+        LookupCount / FMath::Max(IndexedSeconds, UE_SMALL_NUMBER),
+        LookupCount / FMath::Max(ActorSeconds, UE_SMALL_NUMBER)));
+
+    if (LinearFoundCount != LookupCount || IndexedFoundCount != LookupCount || ActorFoundCount != LookupCount) {
+        FinishTest(false, FString::Printf(TEXT("Found: linear %d, index %d, actor %d"), LinearFoundCount, IndexedFoundCount, ActorFoundCount));
+        return true;
+    }
+
+    // 線形探索と同じシティオブジェクトを返すこと
+    for (int32 i = 0; i < 100; ++i) {
+        const auto Expected = FindByLinearScan(RootCityObjects, Queries[i]);
+        const auto Actual = CityObjectGroup->FindCityObjectByIndex(Queries[i]);
+        if (Expected->GmlID != Actual->GmlID || CityObjectGroup->FindCityObjectByID(Expected->GmlID) != Actual) {
+            FinishTest(false, FString::Printf(TEXT("Different city object: %s"), *Expected->GmlID));
+            return true;
+        }
+    }
+
+    // GML IDは大文字小文字を区別すること
+    const auto UpperGmlID = MakeChildGmlID(0).ToUpper();
+    if (ModelActor->FindCityObjectByGmlID(UpperGmlID) != nullptr || CityObjectGroup->FindCityObjectByID(UpperGmlID) != nullptr) {
+        FinishTest(false, FString::Printf(TEXT("Found case-insensitively: %s"), *UpperGmlID));
+        return true;
+    }
+
+    // 属性情報を変更すると索引が作り直されること
+    RootCityObject.Children.SetNum(1);
+    CityObjectGroup->SerializeCityObject(RootCityObject);
+    if (CityObjectGroup->FindCityObjectByIndex(FPLATEAUCityObjectIndex(2, -1)) != nullptr ||
+        CityObjectGroup->FindCityObjectByIndex(FPLATEAUCityObjectIndex(1, -1)) == nullptr) {
+        FinishTest(false, "Index is not rebuilt");
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
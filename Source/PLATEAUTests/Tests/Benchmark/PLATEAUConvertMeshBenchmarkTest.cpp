@@ -0,0 +1,209 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUMeshLoader.h"
+#include "MeshDescription.h"
+#include "MeshElementRemappings.h"
+#include "StaticMeshAttributes.h"
+#include <plateau/polygon_mesh/mesh.h>
+
+namespace {
+    /// <summary>
+    /// ConvertMeshを外部から呼び出すためのMeshLoader
+    /// </summary>
+    class FPLATEAUMeshLoaderForConvertBenchmark : public FPLATEAUMeshLoader {
+    public:
+        bool Convert(const plateau::polygonMesh::Mesh& InMesh, FMeshDescription& OutMeshDescription, TArray<FSubMeshMaterialSet>& SubMeshMaterialSets) {
+            FStaticMeshAttributes(OutMeshDescription).Register();
+            return ConvertMesh(InMesh, OutMeshDescription, SubMeshMaterialSets, InvertMeshNormal(), MergeTriangles());
+        }
+
+        /// 要素毎にPolygonを生成していた従来の変換処理(比較用)
+        void ConvertLegacy(const plateau::polygonMesh::Mesh& InMesh, FMeshDescription& OutMeshDescription) {
+            FStaticMeshAttributes Attributes(OutMeshDescription);
+            Attributes.Register();
+            const auto VertexInstanceUVs = Attributes.GetVertexInstanceUVs();
+            VertexInstanceUVs.SetNumChannels(4);
+            const bool InvertNormal = InvertMeshNormal();
+
+            const auto& InIndices = InMesh.getIndices();
+            const auto VertexPositions = Attributes.GetVertexPositions();
+            for (const auto& Vertex : InMesh.getVertices()) {
+                VertexPositions[OutMeshDescription.CreateVertex()] = FVector3f(Vertex.x, Vertex.y, Vertex.z);
+            }
+
+            TSet<unsigned> UsedVertexIDs;
+            TMap<FString, FPolygonGroupID> PolygonGroups;
+            for (const auto& SubMesh : InMesh.getSubMeshes()) {
+                const FString TexturePath = UTF8_TO_TCHAR(SubMesh.getTexturePath().c_str());
+                if (!PolygonGroups.Contains(TexturePath))
+                    PolygonGroups.Add(TexturePath, OutMeshDescription.CreatePolygonGroup());
+                const FPolygonGroupID PolygonGroupID = PolygonGroups[TexturePath];
+
+                TArray<FVertexInstanceID> VertexInstanceIDs;
+                for (int InIndexIndex = SubMesh.getStartIndex(); InIndexIndex <= SubMesh.getEndIndex(); ++InIndexIndex) {
+                    auto VertexID = InIndices[InIndexIndex];
+                    if (UsedVertexIDs.Contains(VertexID)) {
+                        const auto NewVertexID = OutMeshDescription.CreateVertex();
+                        VertexPositions[NewVertexID] = VertexPositions[VertexID];
+                        VertexID = NewVertexID;
+                    }
+                    const auto NewVertexInstanceID = OutMeshDescription.CreateVertexInstance(VertexID);
+                    VertexInstanceIDs.Add(NewVertexInstanceID);
+                    const auto InUV1 = InMesh.getUV1()[InIndices[InIndexIndex]];
+                    VertexInstanceUVs.Set(NewVertexInstanceID, 0, FVector2f(InUV1.x, 1.0f - InUV1.y));
+                    const auto InUV4 = InMesh.getUV4()[InIndices[InIndexIndex]];
+                    VertexInstanceUVs.Set(NewVertexInstanceID, 3, FVector2f(InUV4.x, InUV4.y));
+                    UsedVertexIDs.Add(VertexID);
+                }
+
+                TArray<FVertexInstanceID> Triangle;
+                Triangle.SetNumUninitialized(3);
+                for (int32 TriangleIndex = 0; TriangleIndex < VertexInstanceIDs.Num() / 3; ++TriangleIndex) {
+                    FMemory::Memcpy(Triangle.GetData(), VertexInstanceIDs.GetData() + TriangleIndex * 3, sizeof(FVertexInstanceID) * 3);
+                    if (InvertNormal)
+                        Triangle.Swap(0, 2);
+                    const FPolygonID NewPolygonID = OutMeshDescription.CreatePolygon(PolygonGroupID, Triangle);
+                    OutMeshDescription.ComputePolygonTriangulation(NewPolygonID);
+                }
+            }
+
+            const auto Normals = Attributes.GetVertexInstanceNormals();
+            const auto Indices = Attributes.GetVertexInstanceVertexIndices();
+            for (int32 FaceOffset = 0; FaceOffset + 2 < Indices.GetNumElements(); FaceOffset += 3) {
+                const FVector3f P0 = VertexPositions[Indices[FaceOffset]];
+                const FVector3f P1 = VertexPositions[Indices[FaceOffset + 1]];
+                const FVector3f P2 = VertexPositions[Indices[FaceOffset + 2]];
+                FVector3f N = InvertNormal ? FVector3f::CrossProduct(P0 - P1, P0 - P2) : FVector3f::CrossProduct(P0 - P2, P0 - P1);
+                N.Normalize();
+                for (int32 i = 0; i < 3; ++i)
+                    Normals[FaceOffset + i] += N;
+            }
+            for (int i = 0; i < Normals.GetNumElements(); ++i) {
+                Normals[i].Normalize();
+            }
+
+            FElementIDRemappings ElementIDRemappings;
+            OutMeshDescription.Compact(ElementIDRemappings);
+        }
+    };
+
+    /// <summary>
+    /// 頂点を共有する格子状のメッシュを生成します。前半と後半で異なるテクスチャのSubMeshを持ちます。
+    /// </summary>
+    void CreateGridMesh(plateau::polygonMesh::Mesh& Mesh, const int32 Side) {
+        std::vector<TVec3d> Vertices;
+        std::vector<TVec2f> UV1;
+        std::vector<TVec2f> UV4;
+        std::vector<unsigned> Indices;
+        Vertices.reserve((Side + 1) * (Side + 1));
+        Indices.reserve(Side * Side * 6);
+        for (int32 Y = 0; Y <= Side; ++Y) {
+            for (int32 X = 0; X <= Side; ++X) {
+                Vertices.emplace_back(X * 100.0, Y * 100.0, FMath::Sin(X * 0.1) * FMath::Cos(Y * 0.1) * 500.0);
+                UV1.emplace_back(static_cast<float>(X) / Side, static_cast<float>(Y) / Side);
+                UV4.emplace_back(0.f, static_cast<float>(X % 7));
+            }
+        }
+        for (int32 Y = 0; Y < Side; ++Y) {
+            for (int32 X = 0; X < Side; ++X) {
+                const unsigned V0 = Y * (Side + 1) + X;
+                const unsigned V1 = V0 + 1;
+                const unsigned V2 = V0 + Side + 1;
+                const unsigned V3 = V2 + 1;
+                Indices.insert(Indices.end(), { V0, V2, V1, V1, V2, V3 });
+            }
+        }
+
+        const size_t HalfIndexCount = Indices.size() / 6 / 2 * 6;
+        Mesh.addVerticesList(Vertices);
+        Mesh.addIndicesList(Indices, 0, false);
+        Mesh.addSubMesh("texture_a.jpg", nullptr, 0, HalfIndexCount - 1, 0);
+        Mesh.addSubMesh("texture_b.jpg", nullptr, HalfIndexCount, Indices.size() - 1, 0);
+        Mesh.addUV1(UV1, Vertices.size());
+        Mesh.addUV4(UV4, Vertices.size());
+    }
+
+    bool IsIdentical(const FMeshDescription& A, const FMeshDescription& B, FString& OutReason) {
+        if (A.Vertices().Num() != B.Vertices().Num() || A.VertexInstances().Num() != B.VertexInstances().Num() ||
+            A.Triangles().Num() != B.Triangles().Num() || A.PolygonGroups().Num() != B.PolygonGroups().Num()) {
+            OutReason = TEXT("Element count mismatch");
+            return false;
+        }
+
+        const FStaticMeshConstAttributes AttrA(A);
+        const FStaticMeshConstAttributes AttrB(B);
+        for (const FVertexID VertexID : A.Vertices().GetElementIDs()) {
+            if (AttrA.GetVertexPositions()[VertexID] != AttrB.GetVertexPositions()[VertexID]) {
+                OutReason = FString::Printf(TEXT("Position mismatch at %d"), VertexID.GetValue());
+                return false;
+            }
+        }
+        for (const FVertexInstanceID InstanceID : A.VertexInstances().GetElementIDs()) {
+            if (A.GetVertexInstanceVertex(InstanceID) != B.GetVertexInstanceVertex(InstanceID) ||
+                AttrA.GetVertexInstanceNormals()[InstanceID] != AttrB.GetVertexInstanceNormals()[InstanceID] ||
+                AttrA.GetVertexInstanceUVs().Get(InstanceID, 0) != AttrB.GetVertexInstanceUVs().Get(InstanceID, 0) ||
+                AttrA.GetVertexInstanceUVs().Get(InstanceID, 3) != AttrB.GetVertexInstanceUVs().Get(InstanceID, 3)) {
+                OutReason = FString::Printf(TEXT("Vertex instance mismatch at %d"), InstanceID.GetValue());
+                return false;
+            }
+        }
+        for (const FTriangleID TriangleID : A.Triangles().GetElementIDs()) {
+            if (A.GetTriangleVertexInstances(TriangleID) != B.GetTriangleVertexInstances(TriangleID) ||
+                A.GetTrianglePolygonGroup(TriangleID) != B.GetTrianglePolygonGroup(TriangleID)) {
+                OutReason = FString::Printf(TEXT("Triangle mismatch at %d"), TriangleID.GetValue());
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/// <summary>
+/// ConvertMeshのマイクロベンチマーク
+/// 100万面以上のメッシュを変換し、従来の要素毎の変換と結果が一致すること、および所要時間を出力します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_ConvertMesh, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.ConvertMesh",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_ConvertMesh::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark.ConvertMesh");
+
+    // 710 * 710 * 2 = 1,008,200 面
+    constexpr int32 GridSide = 710;
+    plateau::polygonMesh::Mesh Mesh;
+    CreateGridMesh(Mesh, GridSide);
+    const int32 TriangleCount = Mesh.getIndices().size() / 3;
+
+    FPLATEAUMeshLoaderForConvertBenchmark MeshLoader;
+
+    FMeshDescription Converted;
+    TArray<FSubMeshMaterialSet> SubMeshMaterialSets;
+    double StartSeconds = FPlatformTime::Seconds();
+    MeshLoader.Convert(Mesh, Converted, SubMeshMaterialSets);
+    const double BulkSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+    FMeshDescription Reference;
+    StartSeconds = FPlatformTime::Seconds();
+    MeshLoader.ConvertLegacy(Mesh, Reference);
+    const double LegacySeconds = FPlatformTime::Seconds() - StartSeconds;
+
+    AddInfo(FString::Printf(TEXT("ConvertMesh: %d triangles, bulk %.3f s (%.2f Mtris/s), legacy %.3f s, speedup x%.2f"),
+        TriangleCount, BulkSeconds, TriangleCount / FMath::Max(BulkSeconds, UE_SMALL_NUMBER) / 1000000.0,
+        LegacySeconds, LegacySeconds / FMath::Max(BulkSeconds, UE_SMALL_NUMBER)));
+
+    FString Reason;
+    if (!IsIdentical(Converted, Reference, Reason)) {
+        FinishTest(false, Reason);
+        return true;
+    }
+
+    if (SubMeshMaterialSets.Num() != 2) {
+        FinishTest(false, "SubMeshMaterialSets.Num() != 2");
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
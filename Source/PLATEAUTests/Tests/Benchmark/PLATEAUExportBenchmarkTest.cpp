@@ -0,0 +1,129 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUMeshLoader.h"
+#include "PLATEAUMeshExporter.h"
+#include "PLATEAUExportSettings.h"
+#include "Component/PLATEAUSceneComponent.h"
+#include "HAL/FileManagerGeneric.h"
+#include "Tests/AutomationCommon.h"
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+
+namespace FPLATEAUTest_Benchmark_Export_Local {
+    constexpr int32 GmlCount = 8;
+    constexpr int32 FeaturesPerGml = 400;
+    constexpr int32 FeaturesPerRow = 20;
+
+    FString GetGmlName(const int32 GmlIndex) {
+        return FString::Printf(TEXT("5339264%d_bldg_6697_op"), GmlIndex);
+    }
+
+    std::shared_ptr<plateau::polygonMesh::Model> CreateModel(const int32 GmlIndex) {
+        return PLATEAUAutomationTestUtil::BuildingFixtures::CreateModel(2, 2, FeaturesPerGml, FeaturesPerRow, 4000.0, TVec3d(0.0, GmlIndex * 100000.0, 0.0));
+    }
+
+    APLATEAUInstancedCityModel* CreateCityModel(UWorld& World) {
+        TArray<FString> GmlNames;
+        for (int32 GmlIndex = 0; GmlIndex < GmlCount; ++GmlIndex) {
+            GmlNames.Add(GetGmlName(GmlIndex));
+        }
+        return PLATEAUAutomationTestUtil::BuildingFixtures::CreateCityModel(World, GmlNames);
+    }
+
+    int64 GetTotalFileSize(const TArray<FString>& Files) {
+        int64 Size = 0;
+        for (const auto& File : Files) {
+            Size += FMath::Max<int64>(IFileManager::Get().FileSize(*File), 0);
+        }
+        return Size;
+    }
+}
+
+/// <summary>
+/// モデルの出力の計測
+/// 複数のGMLに並べた建物をOBJ, FBX, glTFで頂点の溶接の有無毎に出力し、出力時間とファイルサイズを出力し、
+/// GML毎にファイルが出力されていること、溶接によりOBJ, glTFのファイルサイズが小さくなることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_Export, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.Export",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_Export::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_Export_Local;
+    InitializeTest("Benchmark.Export");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Actor = CreateCityModel(*GetWorld());
+    TArray<USceneComponent*> GmlComponents(Actor->GetRootComponent()->GetAttachChildren());
+    const auto LoadFuture = MakeShared<TFuture<void>>(Async(EAsyncExecution::Thread, [Actor, GmlComponents] {
+        for (int32 GmlIndex = 0; GmlIndex < GmlComponents.Num(); ++GmlIndex) {
+            FLoadInputData LoadInputData;
+            LoadInputData.GmlPath = GetGmlName(GmlIndex) + TEXT(".gml");
+            LoadInputData.bIncludeAttrInfo = false;
+            LoadInputData.FallbackMaterial = nullptr;
+
+            FPLATEAUMeshLoader MeshLoader(true);
+            TAtomic<bool> bCanceled(false);
+            MeshLoader.LoadModel(Actor, GmlComponents[GmlIndex], CreateModel(GmlIndex), LoadInputData, nullptr, &bCanceled);
+        }
+    }));
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Actor, LoadFuture] {
+        if (!LoadFuture->IsReady())
+            return false;
+
+        const FString TestDir = FPaths::ProjectSavedDir() / TEXT("Tests/Benchmark/Export");
+        for (const auto FileFormat : { EMeshFileFormat::OBJ, EMeshFileFormat::FBX, EMeshFileFormat::GLTF }) {
+            int64 FileSizes[2] = {};
+            for (const bool bWeldVertices : { false, true }) {
+                const FString ExportPath = TestDir / plateau::Export::MeshFileFormatToStr(FileFormat) / (bWeldVertices ? TEXT("Welded") : TEXT("Default"));
+                FFileManagerGeneric::Get().DeleteDirectory(*ExportPath, false, true);
+                FFileManagerGeneric::Get().MakeDirectory(*ExportPath, true);
+
+                FPLATEAUMeshExportOptions Options;
+                Options.FileFormat = FileFormat;
+                Options.bExportAsBinary = true;
+                Options.bExportHiddenObjects = true;
+                Options.bExportTexture = true;
+                Options.TransformType = EMeshTransformType::Local;
+                Options.CoordinateSystem = ECoordinateSystem::ENU;
+                Options.bWeldVertices = bWeldVertices;
+
+                const double StartSeconds = FPlatformTime::Seconds();
+                FPLATEAUMeshExporter MeshExporter;
+                const bool bSucceeded = MeshExporter.Export(ExportPath, Actor, Options);
+                const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+                TArray<FString> FoundFiles;
+                for (const auto& FoundFile : plateau::Export::GetFoundFiles(FileFormat, ExportPath)) {
+                    FoundFiles.Add(FileFormat == EMeshFileFormat::GLTF ? FoundFile : ExportPath / FoundFile);
+                }
+                FileSizes[bWeldVertices] = GetTotalFileSize(FoundFiles);
+                AddInfo(FString::Printf(TEXT("%s%s: %d GML, %d features, %.3f s, %d files, %.1f KB"),
+                    *plateau::Export::MeshFileFormatToStr(FileFormat), bWeldVertices ? TEXT(" (welded)") : TEXT(""),
+                    GmlCount, GmlCount * FeaturesPerGml, Seconds, FoundFiles.Num(), FileSizes[bWeldVertices] / 1024.0));
+
+                if (!bSucceeded || FoundFiles.Num() != GmlCount) {
+                    FinishTest(false, FString::Printf(TEXT("Failed to export %s"), *plateau::Export::MeshFileFormatToStr(FileFormat)));
+                    return true;
+                }
+            }
+
+            // 面毎に複製された頂点が結合されてファイルが小さくなること
+            if (FileFormat != EMeshFileFormat::FBX && FileSizes[1] >= FileSizes[0]) {
+                FinishTest(false, FString::Printf(TEXT("Welding did not reduce %s size"), *plateau::Export::MeshFileFormatToStr(FileFormat)));
+                return true;
+            }
+        }
+
+        FFileManagerGeneric::Get().DeleteDirectory(*TestDir, false, true);
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
@@ -0,0 +1,106 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUModelCache.h"
+#include "CityGML/PLATEAUFeatureTypeTable.h"
+#include "citygml/citygml.h"
+#include "citygml/citymodel.h"
+#include "plateau/polygon_mesh/mesh_extractor.h"
+#include <plateau/polygon_mesh/model.h>
+
+namespace FPLATEAUTest_Benchmark_FeatureTypeTable_Local {
+    void CollectGmlIDsRecursive(const citygml::CityObject& CityObject, TArray<FString>& OutGmlIDs) {
+        OutGmlIDs.Add(UTF8_TO_TCHAR(CityObject.getId().c_str()));
+        for (unsigned int i = 0; i < CityObject.getChildCityObjectsCount(); ++i) {
+            CollectGmlIDsRecursive(CityObject.getChildCityObject(i), OutGmlIDs);
+        }
+    }
+}
+
+/// <summary>
+/// 地物タイプの表の計測
+/// 同梱テストデータのGMLについて、従来の地物タイプによるフィルタリング(GMLのパース+IDによる検索)と地物タイプの表による検索の時間、表のサイズを出力し、
+/// 検索結果が一致すること、モデルキャッシュに保存・復元できることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_FeatureTypeTable, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.FeatureTypeTable",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_FeatureTypeTable::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_FeatureTypeTable_Local;
+    InitializeTest("Benchmark.FeatureTypeTable");
+
+    const FString GmlPath = FPLATEAURuntimeModule::GetContentDir().Append("/TestData/data/udx/bldg/53392642_bldg_6697_op2.gml");
+
+    // 従来の処理(UPLATEAUCityGmlProxy::Loadと同じ設定でパースし、IDで検索)
+    const double LegacyStartSeconds = FPlatformTime::Seconds();
+    citygml::ParserParams ParserParams;
+    ParserParams.tesselate = false;
+    ParserParams.ignoreGeometries = true;
+    const auto CityModel = citygml::load(TCHAR_TO_UTF8(*GmlPath), ParserParams);
+    if (CityModel == nullptr) {
+        FinishTest(false, "Failed to load CityModel");
+        return true;
+    }
+    const double LegacyParseSeconds = FPlatformTime::Seconds() - LegacyStartSeconds;
+
+    TArray<FString> GmlIDs;
+    for (const auto& RootCityObject : CityModel->getRootCityObjects()) {
+        CollectGmlIDsRecursive(*RootCityObject, GmlIDs);
+    }
+    GmlIDs.Add(TEXT("not_found_id"));
+
+    TArray<int64> LegacyTypes;
+    const double LegacyLookupStartSeconds = FPlatformTime::Seconds();
+    for (const auto& GmlID : GmlIDs) {
+        const auto CityObject = CityModel->getCityObjectById(TCHAR_TO_UTF8(*GmlID));
+        LegacyTypes.Add(CityObject != nullptr ? static_cast<int64>(CityObject->getType()) : -1);
+    }
+    const double LegacyLookupSeconds = FPlatformTime::Seconds() - LegacyLookupStartSeconds;
+
+    // 地物タイプの表(インポート時に作成)
+    const double CreateStartSeconds = FPlatformTime::Seconds();
+    const auto FeatureTypes = FPLATEAUFeatureTypeTable::Create(*CityModel);
+    const double CreateSeconds = FPlatformTime::Seconds() - CreateStartSeconds;
+
+    TArray<int64> TableTypes;
+    const double TableLookupStartSeconds = FPlatformTime::Seconds();
+    for (const auto& GmlID : GmlIDs) {
+        int64 Type;
+        TableTypes.Add(FeatureTypes.TryGetType(GmlID, Type) ? Type : -1);
+    }
+    const double TableLookupSeconds = FPlatformTime::Seconds() - TableLookupStartSeconds;
+
+    const int64 GmlBytes = IFileManager::Get().FileSize(*GmlPath);
+    AddInfo(FString::Printf(TEXT("City objects: %d, GML: %.1f KB, Table: %.1f KB"), FeatureTypes.Num(),
+        GmlBytes / 1024.0, FeatureTypes.GetAllocatedSize() / 1024.0));
+    AddInfo(FString::Printf(TEXT("Legacy: parse %.3f ms + lookup %.3f ms, Table: create %.3f ms (import), lookup %.3f ms"),
+        LegacyParseSeconds * 1000.0, LegacyLookupSeconds * 1000.0, CreateSeconds * 1000.0, TableLookupSeconds * 1000.0));
+
+    if (LegacyTypes != TableTypes) {
+        FinishTest(false, "Types differ from CityModel");
+        return true;
+    }
+
+    // モデルキャッシュに保存した表が復元できること
+    plateau::polygonMesh::MeshExtractOptions ExtractOptions;
+    ExtractOptions.mesh_axes = plateau::geometry::CoordinateSystem::ESU;
+    ExtractOptions.coordinate_zone_id = 9;
+    ExtractOptions.attach_map_tile = false;
+    const auto Model = plateau::polygonMesh::MeshExtractor::extract(*CityModel, ExtractOptions);
+    TArray64<uint8> CacheData;
+    FPLATEAUModelCache::Serialize(*Model, nullptr, CacheData, &FeatureTypes);
+
+    std::shared_ptr<plateau::polygonMesh::Model> CachedModel;
+    TSharedPtr<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe> CachedCityObjects;
+    FPLATEAUFeatureTypeTable CachedFeatureTypes;
+    if (!FPLATEAUModelCache::Deserialize(CacheData.GetData(), CacheData.Num(), CachedModel, CachedCityObjects, &CachedFeatureTypes) ||
+        CachedFeatureTypes.GmlIDBytes != FeatureTypes.GmlIDBytes || CachedFeatureTypes.GmlIDEnds != FeatureTypes.GmlIDEnds ||
+        CachedFeatureTypes.Types != FeatureTypes.Types) {
+        FinishTest(false, "Failed to restore feature type table from model cache");
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,60 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "FileHelpers.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUCityModelLoader.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "Components/StaticMeshComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Tests/AutomationCommon.h"
+
+/// <summary>
+/// インポートのスループット計測
+/// 同梱テストデータをインポートし、メッシュ/秒 と GML/秒 を出力します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_ImportThroughput, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.ImportThroughput",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_ImportThroughput::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark.ImportThroughput");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    if (Loader == nullptr)
+        return false;
+
+    const double StartSeconds = FPlatformTime::Seconds();
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, StartSeconds] {
+        if (Loader->Phase != ECityModelLoadingPhase::Cancelling && Loader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        const double ElapsedSeconds = FMath::Max(FPlatformTime::Seconds() - StartSeconds, UE_SMALL_NUMBER);
+
+        int32 MeshCount = 0;
+        TArray<AActor*> CityModelActors;
+        UGameplayStatics::GetAllActorsOfClass(Loader->GetWorld(), APLATEAUInstancedCityModel::StaticClass(), CityModelActors);
+        for (const auto& CityModelActor : CityModelActors) {
+            TArray<UStaticMeshComponent*> StaticMeshComponents;
+            CityModelActor->GetComponents<UStaticMeshComponent>(StaticMeshComponents);
+            MeshCount += StaticMeshComponents.Num();
+        }
+
+        const int32 GmlCount = Loader->Status.TotalGmlCount;
+        AddInfo(FString::Printf(TEXT("Import: %d GMLs, %d meshes in %.3f s"), GmlCount, MeshCount, ElapsedSeconds));
+        AddInfo(FString::Printf(TEXT("Throughput: %.2f meshes/s, %.3f GMLs/s"), MeshCount / ElapsedSeconds, GmlCount / ElapsedSeconds));
+
+        if (MeshCount <= 0) {
+            FinishTest(false, "MeshCount <= 0");
+            return true;
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
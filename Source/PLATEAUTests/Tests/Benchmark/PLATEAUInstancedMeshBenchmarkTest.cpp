@@ -0,0 +1,135 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "PLATEAUCityModelLoader.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUMeshLoader.h"
+#include "Component/PLATEAUInstancedCityObjectGroup.h"
+#include "Component/PLATEAUSceneComponent.h"
+#include "Tests/AutomationCommon.h"
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+
+namespace FPLATEAUTest_Benchmark_InstancedMesh_Local {
+    constexpr int32 FeatureCount = 1000;
+    constexpr int32 ShapeCount = 4;
+
+    /**
+     * @brief 形状の種類毎に大きさの異なる直方体のメッシュを、位置をずらして作成します。
+     */
+    std::unique_ptr<plateau::polygonMesh::Mesh> CreateBoxMesh(const int32 Shape, const TVec3d& Offset) {
+        return PLATEAUAutomationTestUtil::BuildingFixtures::CreateBoxMesh(Offset, TVec3d(100.0 + Shape * 50.0, 100.0, 200.0 + Shape * 25.0));
+    }
+
+    std::shared_ptr<plateau::polygonMesh::Model> CreateModel() {
+        auto Model = std::make_shared<plateau::polygonMesh::Model>();
+        auto& LodNode = Model->addEmptyNode("LOD1");
+        for (int32 i = 0; i < FeatureCount; ++i) {
+            const TVec3d Offset((i % 40) * 1000.0, (i / 40) * 1000.0, 0.0);
+            LodNode.addChildNode(plateau::polygonMesh::Node(TCHAR_TO_UTF8(*FString::Printf(TEXT("frn_%06d"), i)), CreateBoxMesh(i % ShapeCount, Offset)));
+        }
+        Model->assignNodeHierarchy();
+        return Model;
+    }
+
+    struct FLoadResult {
+        double Seconds = 0.0;
+        FPLATEAUInstancingStats Stats;
+    };
+
+    TFuture<FLoadResult> LoadModelAsync(AActor* Actor, const bool bInstanceRepeatedMeshes) {
+        return Async(EAsyncExecution::Thread, [Actor, bInstanceRepeatedMeshes] {
+            FLoadInputData LoadInputData;
+            LoadInputData.GmlPath = TEXT("53392642_frn_6697_op.gml");
+            LoadInputData.bIncludeAttrInfo = false;
+            LoadInputData.FallbackMaterial = nullptr;
+            LoadInputData.bInstanceRepeatedMeshes = bInstanceRepeatedMeshes;
+
+            FPLATEAUMeshLoader MeshLoader(true);
+            TAtomic<bool> bCanceled(false);
+            FLoadResult Result;
+            const double StartSeconds = FPlatformTime::Seconds();
+            MeshLoader.LoadModel(Actor, Actor->GetRootComponent(), CreateModel(), LoadInputData, nullptr, &bCanceled);
+            Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+            Result.Stats = MeshLoader.GetLastInstancingStats();
+            return Result;
+        });
+    }
+
+    // 描画されるメッシュのコンポーネント数とセクション数(ドローコール数の目安)を数えます
+    void CountDrawCalls(const AActor& Actor, int32& OutComponents, int32& OutDrawCalls) {
+        TInlineComponentArray<UStaticMeshComponent*> StaticMeshComponents(&Actor);
+        OutComponents = StaticMeshComponents.Num();
+        OutDrawCalls = 0;
+        for (const auto& StaticMeshComponent : StaticMeshComponents) {
+            OutDrawCalls += StaticMeshComponent->GetNumMaterials();
+        }
+    }
+}
+
+/// <summary>
+/// 同じ形状のメッシュのインスタンス化の計測
+/// 同じ形状を繰り返し持つモデルについて、通常のインポートとインスタンス化したインポートの処理時間・コンポーネント数・ドローコール数を出力し、
+/// 全てのノードがインスタンスとして作成され、カスタムデータから元のノード名を参照できることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_InstancedMesh, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.InstancedMesh",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_InstancedMesh::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_InstancedMesh_Local;
+    InitializeTest("Benchmark.InstancedMesh");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto DefaultActor = PLATEAUAutomationTestUtil::BuildingFixtures::CreateCityModel(*GetWorld(), {});
+    const auto InstancedActor = PLATEAUAutomationTestUtil::BuildingFixtures::CreateCityModel(*GetWorld(), {});
+    auto DefaultFuture = MakeShared<TFuture<FLoadResult>>(LoadModelAsync(DefaultActor, false));
+    auto InstancedFuture = MakeShared<TFuture<FLoadResult>>();
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, DefaultActor, InstancedActor, DefaultFuture, InstancedFuture] {
+        // 計測が重ならないよう順に実行する
+        if (!DefaultFuture->IsReady())
+            return false;
+        if (!InstancedFuture->IsValid())
+            *InstancedFuture = LoadModelAsync(InstancedActor, true);
+        if (!InstancedFuture->IsReady())
+            return false;
+
+        const auto DefaultResult = DefaultFuture->Get();
+        const auto InstancedResult = InstancedFuture->Get();
+        int32 DefaultComponents, DefaultDrawCalls, InstancedComponents, InstancedDrawCalls;
+        CountDrawCalls(*DefaultActor, DefaultComponents, DefaultDrawCalls);
+        CountDrawCalls(*InstancedActor, InstancedComponents, InstancedDrawCalls);
+
+        AddInfo(FString::Printf(TEXT("Default: %.3f s, %d components, %d draw calls"), DefaultResult.Seconds, DefaultComponents, DefaultDrawCalls));
+        AddInfo(FString::Printf(TEXT("Instanced: %.3f s, %d components, %d draw calls (%s)"), InstancedResult.Seconds, InstancedComponents, InstancedDrawCalls,
+            *InstancedResult.Stats.ToString()));
+
+        const auto& Stats = InstancedResult.Stats;
+        if (DefaultResult.Stats.Instances != 0 || Stats.InstancedMeshes != ShapeCount || Stats.Instances != FeatureCount ||
+            Stats.SavedComponents != FeatureCount - ShapeCount || InstancedComponents != ShapeCount || DefaultComponents != FeatureCount) {
+            FinishTest(false, FString::Printf(TEXT("Unexpected instancing result: %s"), *Stats.ToString()));
+            return true;
+        }
+
+        // カスタムデータから全てのノード名を参照できること
+        TSet<FString> NodeNames;
+        TInlineComponentArray<UPLATEAUInstancedCityObjectGroup*> InstancedComponentArray(InstancedActor);
+        for (const auto& Component : InstancedComponentArray) {
+            for (int32 i = 0; i < Component->GetInstanceCount(); ++i) {
+                NodeNames.Add(Component->GetInstanceNodeName(i));
+            }
+        }
+        if (NodeNames.Num() != FeatureCount || NodeNames.Contains(FString())) {
+            FinishTest(false, FString::Printf(TEXT("Instance node names are missing: %d"), NodeNames.Num()));
+            return true;
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
@@ -0,0 +1,146 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUModelCache.h"
+#include "citygml/citygml.h"
+#include "plateau/polygon_mesh/mesh_extractor.h"
+#include <plateau/polygon_mesh/model.h>
+
+/// <summary>
+/// モデルキャッシュの計測
+/// 同梱テストデータのGMLについて、キャッシュミス時(パース+メッシュ抽出+保存)とキャッシュヒット時(読み込み)の時間を出力し、
+/// キャッシュから復元したModelが抽出結果と一致することを確認します。
+/// また、GMLを別のディレクトリに移動した場合にテクスチャのパスが移動先のGMLの場所から解決されることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_ModelCache, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.ModelCache",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_ModelCache::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark.ModelCache");
+
+    const FString GmlPath = FPLATEAURuntimeModule::GetContentDir().Append("/TestData/data/udx/bldg/53392642_bldg_6697_op2.gml");
+    const FString CacheDirectory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("PLATEAUModelCache"));
+    IFileManager::Get().DeleteDirectory(*CacheDirectory, false, true);
+    FPLATEAUModelCache ModelCache(CacheDirectory);
+
+    plateau::polygonMesh::MeshExtractOptions ExtractOptions;
+    ExtractOptions.mesh_granularity = plateau::polygonMesh::MeshGranularity::PerPrimaryFeatureObject;
+    ExtractOptions.mesh_axes = plateau::geometry::CoordinateSystem::ESU;
+    ExtractOptions.coordinate_zone_id = 9;
+    ExtractOptions.export_appearance = true;
+    ExtractOptions.attach_map_tile = false;
+    const std::vector<plateau::geometry::Extent> Extents = { plateau::geometry::Extent::all() };
+
+    // キャッシュミス
+    const double MissStartSeconds = FPlatformTime::Seconds();
+    const FString Key = FPLATEAUModelCache::MakeKey(GmlPath, ExtractOptions, Extents, true);
+    std::shared_ptr<plateau::polygonMesh::Model> CachedModel;
+    TSharedPtr<FPLATEAUCachedCityObjects, ESPMode::ThreadSafe> CachedCityObjects;
+    if (Key.IsEmpty() || ModelCache.TryLoad(Key, GmlPath, CachedModel, CachedCityObjects)) {
+        FinishTest(false, "Unexpected cache state before saving");
+        return true;
+    }
+
+    citygml::ParserParams ParserParams;
+    ParserParams.tesselate = true;
+    const auto CityModel = citygml::load(TCHAR_TO_UTF8(*GmlPath), ParserParams);
+    if (CityModel == nullptr) {
+        FinishTest(false, "Failed to load CityModel");
+        return true;
+    }
+    const auto Model = plateau::polygonMesh::MeshExtractor::extractInExtents(*CityModel, ExtractOptions, Extents);
+    const auto CityObjects = FPLATEAUModelCache::SerializeCityObjects(*Model, CityModel, ExtractOptions.mesh_granularity);
+    if (!ModelCache.Save(Key, GmlPath, *Model, &CityObjects.Get())) {
+        FinishTest(false, "Failed to save model cache");
+        return true;
+    }
+    const double MissSeconds = FPlatformTime::Seconds() - MissStartSeconds;
+
+    // キャッシュヒット
+    const double HitStartSeconds = FPlatformTime::Seconds();
+    if (!ModelCache.TryLoad(FPLATEAUModelCache::MakeKey(GmlPath, ExtractOptions, Extents, true), GmlPath, CachedModel, CachedCityObjects)) {
+        FinishTest(false, "Failed to load model cache");
+        return true;
+    }
+    const double HitSeconds = FPlatformTime::Seconds() - HitStartSeconds;
+
+    AddInfo(FString::Printf(TEXT("Cache miss: %.3f s, Cache hit: %.3f s (x%.1f)"), MissSeconds, HitSeconds,
+        MissSeconds / FMath::Max(HitSeconds, UE_SMALL_NUMBER)));
+    AddInfo(ModelCache.GetStatsString());
+
+    // 抽出結果と一致すること
+    const auto Meshes = Model->getAllMeshes();
+    const auto CachedMeshes = CachedModel->getAllMeshes();
+    if (Meshes.size() != CachedMeshes.size()) {
+        FinishTest(false, FString::Printf(TEXT("Mesh count: %d != %d"), static_cast<int32>(Meshes.size()), static_cast<int32>(CachedMeshes.size())));
+        return true;
+    }
+    for (size_t i = 0; i < Meshes.size(); ++i) {
+        if (Meshes[i]->getVertices() != CachedMeshes[i]->getVertices() ||
+            Meshes[i]->getIndices() != CachedMeshes[i]->getIndices() ||
+            Meshes[i]->getSubMeshes().size() != CachedMeshes[i]->getSubMeshes().size() ||
+            Meshes[i]->getCityObjectList().size() != CachedMeshes[i]->getCityObjectList().size()) {
+            FinishTest(false, FString::Printf(TEXT("Mesh %d differs"), static_cast<int32>(i)));
+            return true;
+        }
+        for (size_t j = 0; j < Meshes[i]->getSubMeshes().size(); ++j) {
+            if (!FPaths::IsSamePath(UTF8_TO_TCHAR(Meshes[i]->getSubMeshes()[j].getTexturePath().c_str()),
+                UTF8_TO_TCHAR(CachedMeshes[i]->getSubMeshes()[j].getTexturePath().c_str()))) {
+                FinishTest(false, FString::Printf(TEXT("Texture path of mesh %d differs"), static_cast<int32>(i)));
+                return true;
+            }
+        }
+    }
+
+    if (!CachedCityObjects.IsValid() ||
+        CachedCityObjects->MeshToSerializedCityObjects.Num() != CityObjects->MeshToSerializedCityObjects.Num() ||
+        CachedCityObjects->NodeToSerializedCityObjects.Num() != CityObjects->NodeToSerializedCityObjects.Num()) {
+        FinishTest(false, "Cached city objects differ");
+        return true;
+    }
+
+    // GMLを移動してもキャッシュヒットし、テクスチャのパスが移動先のGMLのディレクトリから解決されること
+    const FString GmlDirectory = FPaths::ConvertRelativePathToFull(FPaths::GetPath(GmlPath));
+    const FString MovedGmlDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("PLATEAUModelCacheMoved")));
+    const FString MovedGmlPath = FPaths::Combine(MovedGmlDirectory, FPaths::GetCleanFilename(GmlPath));
+    IFileManager::Get().DeleteDirectory(*MovedGmlDirectory, false, true);
+    if (IFileManager::Get().Copy(*MovedGmlPath, *GmlPath) != COPY_OK ||
+        !ModelCache.TryLoad(FPLATEAUModelCache::MakeKey(MovedGmlPath, ExtractOptions, Extents, true), MovedGmlPath, CachedModel, CachedCityObjects)) {
+        FinishTest(false, "Failed to load model cache for moved gml");
+        return true;
+    }
+    int32 NumMovedTextures = 0;
+    const auto MovedMeshes = CachedModel->getAllMeshes();
+    for (size_t i = 0; i < Meshes.size(); ++i) {
+        for (size_t j = 0; j < Meshes[i]->getSubMeshes().size(); ++j) {
+            FString TexturePath = UTF8_TO_TCHAR(Meshes[i]->getSubMeshes()[j].getTexturePath().c_str());
+            FPaths::NormalizeFilename(TexturePath);
+            if (TexturePath.IsEmpty() || FPaths::IsRelative(TexturePath) || !FPaths::MakePathRelativeTo(TexturePath, *(GmlDirectory / TEXT(""))))
+                continue;
+
+            const FString ExpectedPath = FPaths::Combine(MovedGmlDirectory, TexturePath);
+            if (!FPaths::IsSamePath(ExpectedPath, UTF8_TO_TCHAR(MovedMeshes[i]->getSubMeshes()[j].getTexturePath().c_str()))) {
+                FinishTest(false, FString::Printf(TEXT("Texture path is not resolved from moved gml: %s"), *ExpectedPath));
+                return true;
+            }
+            ++NumMovedTextures;
+        }
+    }
+    IFileManager::Get().DeleteDirectory(*MovedGmlDirectory, false, true);
+    if (NumMovedTextures == 0) {
+        FinishTest(false, "No texture path relative to gml");
+        return true;
+    }
+
+    // 抽出設定が異なる場合はキャッシュミスとなること
+    ExtractOptions.max_lod = 1;
+    if (ModelCache.TryLoad(FPLATEAUModelCache::MakeKey(GmlPath, ExtractOptions, Extents, true), GmlPath, CachedModel, CachedCityObjects)) {
+        FinishTest(false, "Cache hit with different extract options");
+        return true;
+    }
+
+    IFileManager::Get().DeleteDirectory(*CacheDirectory, false, true);
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,194 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUModelFiltering.h"
+#include "Component/PLATEAUSceneComponent.h"
+#include "Util/PLATEAUComponentUtil.h"
+#include "Util/PLATEAUGmlUtil.h"
+
+namespace FPLATEAUTest_Benchmark_ModelFiltering_Local {
+    constexpr int32 FeatureCount = 2000;
+    const FString GmlName = TEXT("53392642_bldg_6697_op");
+
+    template <typename T>
+    T* CreateAttachedComponent(AActor* Actor, USceneComponent* Parent, const FString& Name) {
+        const auto Component = NewObject<T>(Actor, FName(Name));
+        Component->AttachToComponent(Parent, FAttachmentTransformRules::KeepWorldTransform);
+        Actor->AddInstanceComponent(Component);
+        Component->RegisterComponent();
+        return Component;
+    }
+
+    /**
+     * @brief Lod1に全ての地物、Lod2に半数の地物を持ち、地物タイプが交互に異なるGMLを1つ持つアクターを作成します。
+     */
+    APLATEAUInstancedCityModel* CreateCityModel(UWorld& World) {
+        const auto Actor = PLATEAUAutomationTestUtil::BuildingFixtures::CreateCityModel(World, { GmlName });
+        const auto GmlComponent = Actor->GetRootComponent()->GetAttachChildren()[0].Get();
+        for (int Lod = 1; Lod <= 2; ++Lod) {
+            const auto LodComponent = CreateAttachedComponent<UPLATEAUSceneComponent>(Actor, GmlComponent, FString::Printf(TEXT("LOD%d"), Lod));
+            const int32 LodFeatureCount = Lod == 1 ? FeatureCount : FeatureCount / 2;
+            for (int32 i = 0; i < LodFeatureCount; ++i) {
+                const auto GmlID = FString::Printf(TEXT("bldg_%06d"), i);
+                const auto FeatureComponent = CreateAttachedComponent<UPLATEAUCityObjectGroup>(Actor, LodComponent, FString::Printf(TEXT("%s__%d"), *GmlID, Lod));
+
+                FPLATEAUCityObject CityObject;
+                CityObject.SetGmlID(GmlID);
+                CityObject.CityObjectIndex = FPLATEAUCityObjectIndex(0, -1);
+                CityObject.SetCityObjectsType(i % 2 == 0 ? PLATEAUAutomationTestUtil::Fixtures::TEST_CITYOBJ_TYPE : PLATEAUAutomationTestUtil::Fixtures::TEST_CITYOBJ_WALL_TYPE);
+                FeatureComponent->SerializeCityObject(CityObject);
+            }
+        }
+        return Actor;
+    }
+
+    // 索引導入前のFilterLowLods, FilterByLods, FilterByFeatureTypesと同じ処理
+    void FilterLowLodsLegacy(FPLATEAUModelFiltering& Filter, const USceneComponent* const InGmlComponent, const int MinLod, const int MaxLod) {
+        const TArray<USceneComponent*>& AttachedLodChildren = InGmlComponent->GetAttachChildren();
+        TMap<int, TSet<FString>> NameMap;
+        for (const auto& LodComponent : AttachedLodChildren) {
+            const auto Lod = FPLATEAUComponentUtil::ParseLodComponent(LodComponent);
+            auto& Value = NameMap.Add(Lod);
+            if (Lod < MinLod || Lod > MaxLod)
+                continue;
+
+            TArray<USceneComponent*> FeatureComponents;
+            LodComponent->GetChildrenComponents(false, FeatureComponents);
+            for (const auto FeatureComponent : FeatureComponents) {
+                Value.Add(FPLATEAUComponentUtil::GetOriginalComponentName(FeatureComponent));
+            }
+        }
+
+        for (const auto& LodComponent : AttachedLodChildren) {
+            const auto Lod = FPLATEAUComponentUtil::ParseLodComponent(LodComponent);
+            for (const auto& FeatureComponent : LodComponent->GetAttachChildren()) {
+                auto bIsMaxLod = MinLod <= Lod && Lod <= MaxLod;
+                const auto ComponentName = FPLATEAUComponentUtil::GetOriginalComponentName(FeatureComponent);
+                TArray<int> Keys;
+                NameMap.GetKeys(Keys);
+                for (const auto Key : Keys) {
+                    if (Key > Lod && NameMap[Key].Contains(ComponentName))
+                        bIsMaxLod = false;
+                }
+                Filter.ApplyCollisionResponseBlockToChannel(FeatureComponent, bIsMaxLod, true);
+                FeatureComponent->SetVisibility(bIsMaxLod, true);
+            }
+        }
+    }
+
+    void FilterLegacy(FPLATEAUModelFiltering& Filter, const TArray<TObjectPtr<USceneComponent>>& GmlComponents, const int MinLod, const int MaxLod, const citygml::CityObject::CityObjectsType InCityObjectType) {
+        for (const auto& GmlComponent : GmlComponents) {
+            for (const auto& LodComponent : GmlComponent->GetAttachChildren()) {
+                for (const auto& FeatureComponent : LodComponent->GetAttachChildren()) {
+                    Filter.ApplyCollisionResponseBlockToChannel(FeatureComponent, false, true);
+                    FeatureComponent->SetVisibility(false, true);
+                }
+            }
+            FilterLowLodsLegacy(Filter, GmlComponent, MinLod, MaxLod);
+        }
+
+        for (const auto& GmlComponent : GmlComponents) {
+            for (const auto& LodComponent : GmlComponent->GetAttachChildren()) {
+                TArray<USceneComponent*> FeatureComponents;
+                LodComponent->GetChildrenComponents(true, FeatureComponents);
+                for (const auto& FeatureComponent : FeatureComponents) {
+                    if (!FeatureComponent->IsVisible() || !FeatureComponent->IsA(UPLATEAUCityObjectGroup::StaticClass()))
+                        continue;
+
+                    const auto ObjList = StaticCast<UPLATEAUCityObjectGroup*>(FeatureComponent)->GetAllRootCityObjects();
+                    if (ObjList.Num() != 1 || (static_cast<int64>(InCityObjectType) & UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(ObjList[0].Type)))
+                        continue;
+
+                    Filter.ApplyCollisionResponseBlockToChannel(FeatureComponent, false);
+                    FeatureComponent->SetVisibility(false);
+                }
+            }
+        }
+    }
+
+    TArray<bool> GetVisibilities(const AActor& Actor) {
+        TInlineComponentArray<UPLATEAUCityObjectGroup*> CityObjectGroups(&Actor);
+        TArray<bool> Visibilities;
+        for (const auto& CityObjectGroup : CityObjectGroups) {
+            Visibilities.Add(CityObjectGroup->GetVisibleFlag());
+        }
+        return Visibilities;
+    }
+}
+
+/// <summary>
+/// 索引によるフィルタリングの計測
+/// 多数の地物を持つアクターについて、従来の全コンポーネントを走査するフィルタリングと索引によるフィルタリングの処理時間・変更コンポーネント数を出力し、
+/// 表示状態が一致すること、同じ条件で再度フィルタリングした場合にコンポーネントを変更しないことを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_ModelFiltering, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.ModelFiltering",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_ModelFiltering::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_ModelFiltering_Local;
+    InitializeTest("Benchmark.ModelFiltering");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto ModelActor = CreateCityModel(*GetWorld());
+    const auto& GmlComponents = ModelActor->GetRootComponent()->GetAttachChildren();
+    const auto Package = FPLATEAUGmlUtil::GetCityModelPackage(GmlComponents[0]);
+    TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod> PackageToLodRangeMap;
+    PackageToLodRangeMap.Add(Package, { 1, 2 });
+    const auto BuildingType = static_cast<citygml::CityObject::CityObjectsType>(UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(EPLATEAUCityObjectsType::COT_Building));
+    const auto AllTypes = static_cast<citygml::CityObject::CityObjectsType>(~0ll);
+
+    FPLATEAUModelFiltering Filter;
+
+    // 従来の処理
+    const double LegacyStartSeconds = FPlatformTime::Seconds();
+    FilterLegacy(Filter, GmlComponents, 1, 2, BuildingType);
+    const double LegacySeconds = FPlatformTime::Seconds() - LegacyStartSeconds;
+    const auto LegacyVisibilities = GetVisibilities(*ModelActor);
+    FilterLegacy(Filter, GmlComponents, 1, 2, AllTypes);
+    const auto LegacyAllTypesVisibilities = GetVisibilities(*ModelActor);
+
+    // 索引による処理(従来の処理の結果から条件を変更)
+    FPLATEAUModelFilterIndex Index;
+    const double BuildStartSeconds = FPlatformTime::Seconds();
+    Index.Build(GmlComponents);
+    const double BuildSeconds = FPlatformTime::Seconds() - BuildStartSeconds;
+
+    const double IndexedStartSeconds = FPlatformTime::Seconds();
+    const int32 ChangedCount = Filter.FilterByLodsAndFeatureTypes(Index, Package, PackageToLodRangeMap, true, BuildingType);
+    const double IndexedSeconds = FPlatformTime::Seconds() - IndexedStartSeconds;
+    const auto IndexedVisibilities = GetVisibilities(*ModelActor);
+
+    const double UnchangedStartSeconds = FPlatformTime::Seconds();
+    const int32 UnchangedCount = Filter.FilterByLodsAndFeatureTypes(Index, Package, PackageToLodRangeMap, true, BuildingType);
+    const double UnchangedSeconds = FPlatformTime::Seconds() - UnchangedStartSeconds;
+
+    Filter.FilterByLods(Index, Package, PackageToLodRangeMap, true);
+    const auto IndexedAllTypesVisibilities = GetVisibilities(*ModelActor);
+
+    // 地物タイプで非表示化した状態で索引を作り直しても、Lodによる表示状態は保持される
+    Filter.FilterByFeatureTypes(Index, BuildingType);
+    Index.Build(GmlComponents);
+    Filter.FilterByFeatureTypes(Index, AllTypes);
+    const auto RebuiltAllTypesVisibilities = GetVisibilities(*ModelActor);
+
+    AddInfo(FString::Printf(TEXT("Components: %d, Records: %d"), IndexedVisibilities.Num(), Index.GetRecords().Num()));
+    AddInfo(FString::Printf(TEXT("Legacy: %.3f ms, Index build: %.3f ms, Indexed: %.3f ms (%d changed), Unchanged: %.3f ms (%d changed)"),
+        LegacySeconds * 1000.0, BuildSeconds * 1000.0, IndexedSeconds * 1000.0, ChangedCount, UnchangedSeconds * 1000.0, UnchangedCount));
+
+    if (LegacyVisibilities != IndexedVisibilities || LegacyAllTypesVisibilities != IndexedAllTypesVisibilities || LegacyAllTypesVisibilities != RebuiltAllTypesVisibilities) {
+        FinishTest(false, "Visibilities differ from legacy filtering");
+        return true;
+    }
+
+    if (ChangedCount != FeatureCount / 2 || UnchangedCount != 0) {
+        FinishTest(false, FString::Printf(TEXT("Unexpected changed count: %d, %d"), ChangedCount, UnchangedCount));
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
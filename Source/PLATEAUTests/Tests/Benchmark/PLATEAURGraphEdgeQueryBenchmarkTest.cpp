@@ -0,0 +1,90 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "RoadNetwork/PLATEAURnDef.h"
+#include "RoadNetwork/RGraph/RGraphEx.h"
+#include "RoadNetwork/RGraph/RCompactGraph.h"
+
+namespace FPLATEAUTest_Benchmark_RGraphEdgeQuery_Local {
+    constexpr double CellSize = 1000.0;
+    // 長い辺の格子の行からのずれ. InsertVertexInNearEdgeの許容誤差(0.3m)以内とする
+    constexpr double LongEdgeOffset = 10.0;
+    constexpr float ToleranceMeter = 0.3f;
+
+    /**
+     * @brief N x Nの四角形の格子と, 内側の行毎に行の頂点の近くを通る長い辺を持つグラフを作成します。
+     * 長い辺は走査中ずっと保持されるため, 全ての辺と比較する場合は処理時間が辺の数の2乗に比例します。
+     */
+    FRCompactGraph CreateGraph(const int32 N) {
+        FRCompactGraph Graph;
+        for (int32 Y = 0; Y <= N; ++Y) {
+            for (int32 X = 0; X <= N; ++X)
+                Graph.AddVertex(FVector(X * CellSize, Y * CellSize, 0.0));
+        }
+        auto GetVertex = [N](const int32 X, const int32 Y) { return Y * (N + 1) + X; };
+        for (int32 Y = 0; Y < N; ++Y) {
+            for (int32 X = 0; X < N; ++X) {
+                Graph.AddFace(nullptr, ERRoadTypeMask::Road, 1);
+                Graph.AddFaceEdge(Graph.FindOrAddEdge(GetVertex(X, Y), GetVertex(X + 1, Y)));
+                Graph.AddFaceEdge(Graph.FindOrAddEdge(GetVertex(X + 1, Y), GetVertex(X + 1, Y + 1)));
+                Graph.AddFaceEdge(Graph.FindOrAddEdge(GetVertex(X + 1, Y + 1), GetVertex(X, Y + 1)));
+                Graph.AddFaceEdge(Graph.FindOrAddEdge(GetVertex(X, Y + 1), GetVertex(X, Y)));
+            }
+        }
+        for (int32 Y = 1; Y < N; ++Y) {
+            const auto V0 = Graph.AddVertex(FVector(CellSize * 0.5, Y * CellSize + LongEdgeOffset, 0.0));
+            const auto V1 = Graph.AddVertex(FVector((N - 0.5) * CellSize, Y * CellSize + LongEdgeOffset, 0.0));
+            Graph.AddFace(nullptr, ERRoadTypeMask::Road, 1);
+            Graph.AddFaceEdge(Graph.FindOrAddEdge(V0, V1));
+        }
+        Graph.BuildAdjacency();
+        return Graph;
+    }
+}
+
+/// <summary>
+/// FRGraphEx::InsertVertexInNearEdge, InsertVerticesInEdgeIntersectionの計測
+/// 辺の数を1k～1Mに変えて処理時間を出力し, 挿入された辺の数が格子から求めた数と一致することを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_RGraphEdgeQuery, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.RGraphEdgeQuery",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_RGraphEdgeQuery::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RGraphEdgeQuery_Local;
+    InitializeTest("Benchmark.RGraphEdgeQuery");
+
+    for (const int32 TargetEdges : { 1000, 10000, 100000, 1000000 }) {
+        const int32 N = FMath::RoundToInt(FMath::Sqrt(TargetEdges * 0.5));
+        const auto Graph = CreateGraph(N);
+
+        // 長い辺に行の内側の頂点(N - 1個)が, 長い辺の両端が格子の辺に挿入される
+        const int32 ExpectedNearEdges = Graph.GetEdgeCount() + (N - 1) * (N + 1);
+        auto NearGraph = Graph.ToGraph();
+        double StartSeconds = FPlatformTime::Seconds();
+        FRGraphEx::InsertVertexInNearEdge(NearGraph, ToleranceMeter);
+        const double NearSeconds = FPlatformTime::Seconds() - StartSeconds;
+        const int32 NearEdges = FRCompactGraph::FromGraph(*NearGraph).GetEdgeCount();
+
+        // 長い辺と内側の縦の辺(N - 1本)の交点が両方の辺に挿入される
+        const int32 ExpectedIntersectionEdges = Graph.GetEdgeCount() + (N - 1) * (N - 1) * 2;
+        auto IntersectionGraph = Graph.ToGraph();
+        StartSeconds = FPlatformTime::Seconds();
+        FRGraphEx::InsertVerticesInEdgeIntersection(IntersectionGraph, ToleranceMeter);
+        const double IntersectionSeconds = FPlatformTime::Seconds() - StartSeconds;
+        const int32 IntersectionEdges = FRCompactGraph::FromGraph(*IntersectionGraph).GetEdgeCount();
+
+        AddInfo(FString::Printf(TEXT("%d edges: InsertVertexInNearEdge %.3f ms, InsertVerticesInEdgeIntersection %.3f ms"),
+            Graph.GetEdgeCount(), NearSeconds * 1000.0, IntersectionSeconds * 1000.0));
+
+        if (NearEdges != ExpectedNearEdges || IntersectionEdges != ExpectedIntersectionEdges) {
+            FinishTest(false, FString::Printf(TEXT("Unexpected edge count: near %d (expected %d), intersection %d (expected %d)"),
+                NearEdges, ExpectedNearEdges, IntersectionEdges, ExpectedIntersectionEdges));
+            return true;
+        }
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+    }
+
+    FinishTest(true, "");
+    return true;
+}
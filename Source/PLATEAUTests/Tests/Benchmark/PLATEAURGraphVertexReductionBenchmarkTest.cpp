@@ -0,0 +1,218 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "RoadNetwork/CityObject/SubDividedCityObject.h"
+#include "RoadNetwork/GeoGraph/GeoGraphEx.h"
+#include "RoadNetwork/RGraph/RGraphEx.h"
+#include "RoadNetwork/RGraph/RGraphFactory.h"
+#include "RoadNetwork/RGraph/RCompactGraph.h"
+#include "citygml/citygml.h"
+#include "plateau/polygon_mesh/mesh_extractor.h"
+#include <plateau/polygon_mesh/model.h>
+
+namespace FPLATEAUTest_Benchmark_RGraphVertexReduction_Local {
+    void CollectCityObjects(const FSubDividedCityObject& CityObject, TArray<FSubDividedCityObject>& OutCityObjects) {
+        if (CityObject.Meshes.Num() > 0) {
+            auto& Added = OutCityObjects.Add_GetRef(CityObject);
+            Added.Children.Empty();
+            Added.SelfRoadType = ERRoadTypeMask::Road;
+        }
+        for (auto& Child : CityObject.Children)
+            CollectCityObjects(Child, OutCityObjects);
+    }
+
+    /**
+     * @brief 変更前のVertexReductionの統合処理(頂点が減らなくなるまでFGeoGraphEx::MergeVerticesを繰り返す)を位置の配列上で行います。
+     * グラフの変更は含まないため、変更前の処理時間の下限となります。統合後の位置を返します。
+     */
+    TArray<FVector> MergeVerticesUntilStable(TArray<FVector> Positions, const float CellSize, const int32 MergeCellLength, int32& OutRounds) {
+        OutRounds = 0;
+        while (true) {
+            OutRounds++;
+            const auto Map = FGeoGraphEx::MergeVertices(Positions, CellSize, MergeCellLength);
+            TSet<FVector> Merged;
+            for (auto& Position : Positions) {
+                const auto Found = Map.Find(Position);
+                Merged.Add(Found ? *Found : Position);
+            }
+            if (Merged.Num() == Positions.Num())
+                return Positions;
+            Positions = Merged.Array();
+        }
+    }
+
+    /**
+     * @brief 同梱テストデータの道路(tran)のGMLを最小地物単位で読み込み, メッシュを持つ地物を道路として集めます。
+     */
+    void LoadCityObjects(UObject& Outer, TArray<FSubDividedCityObject>& OutCityObjects, bool& bOutSuccess) {
+        bOutSuccess = false;
+        const FString GmlPath = FPLATEAURuntimeModule::GetContentDir().Append("/TestData/data/udx/tran/533925_tran_6697_op.gml");
+        citygml::ParserParams ParserParams;
+        ParserParams.tesselate = true;
+        const auto CityModel = citygml::load(TCHAR_TO_UTF8(*GmlPath), ParserParams);
+        if (CityModel == nullptr)
+            return;
+
+        plateau::polygonMesh::MeshExtractOptions ExtractOptions;
+        ExtractOptions.mesh_granularity = plateau::polygonMesh::MeshGranularity::PerAtomicFeatureObject;
+        ExtractOptions.mesh_axes = plateau::geometry::CoordinateSystem::ESU;
+        ExtractOptions.unit_scale = 0.01f;
+        ExtractOptions.coordinate_zone_id = 9;
+        ExtractOptions.export_appearance = false;
+        ExtractOptions.attach_map_tile = false;
+        const auto Model = plateau::polygonMesh::MeshExtractor::extract(*CityModel, ExtractOptions);
+
+        const auto CityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Outer);
+        TMap<FString, FPLATEAUCityObject> CityObjMap;
+        for (int32 i = 0; i < Model->getRootNodeCount(); ++i) {
+            const FSubDividedCityObject Root(CityObjectGroup, Model->getRootNodeAt(i), CityObjMap, ERRoadTypeMask::Empty);
+            CollectCityObjects(Root, OutCityObjects);
+        }
+        bOutSuccess = OutCityObjects.Num() > 0;
+    }
+
+    /**
+     * @brief PositionsのうちToleranceの範囲内にTargetsの位置があるものの数を返します。
+     */
+    int32 CountMatchedPositions(const TArray<FVector>& Positions, const TArray<FVector>& Targets, const double Tolerance) {
+        // 位置をToleranceの格子に分けて近傍の格子のみ比較する
+        TMultiMap<FIntVector, FVector> Cells;
+        const auto ToCell = [Tolerance](const FVector& Position) {
+            return FIntVector(FMath::FloorToInt(Position.X / Tolerance), FMath::FloorToInt(Position.Y / Tolerance), FMath::FloorToInt(Position.Z / Tolerance));
+        };
+        for (const auto& Target : Targets)
+            Cells.Add(ToCell(Target), Target);
+
+        int32 Count = 0;
+        TArray<FVector> Candidates;
+        for (const auto& Position : Positions) {
+            const auto Cell = ToCell(Position);
+            bool bFound = false;
+            for (int32 X = -1; X <= 1 && !bFound; ++X) {
+                for (int32 Y = -1; Y <= 1 && !bFound; ++Y) {
+                    for (int32 Z = -1; Z <= 1 && !bFound; ++Z) {
+                        Candidates.Reset();
+                        Cells.MultiFind(Cell + FIntVector(X, Y, Z), Candidates);
+                        bFound = Candidates.ContainsByPredicate([&Position, Tolerance](const FVector& Candidate) {
+                            return FVector::Dist(Position, Candidate) <= Tolerance;
+                        });
+                    }
+                }
+            }
+            if (bFound)
+                ++Count;
+        }
+        return Count;
+    }
+}
+
+/// <summary>
+/// FRGraphEx::VertexReductionの計測
+/// 同梱テストデータの道路(tran)のGMLから作成したグラフについて、変更前の統合処理とVertexReductionの処理時間を出力し、
+/// VertexReductionを再度実行しても頂点数が変わらない(1回で収束している)ことを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_RGraphVertexReduction, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.RGraphVertexReduction",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_RGraphVertexReduction::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RGraphVertexReduction_Local;
+    InitializeTest("Benchmark.RGraphVertexReduction");
+
+    const auto Outer = NewObject<UPackage>(nullptr, TEXT("/Temp/PLATEAUTest_RGraphVertexReduction"));
+    Outer->AddToRoot();
+    TArray<FSubDividedCityObject> CityObjects;
+    bool bLoaded;
+    LoadCityObjects(*Outer, CityObjects, bLoaded);
+    if (!bLoaded) {
+        Outer->RemoveFromRoot();
+        FinishTest(false, "Failed to load CityModel");
+        return true;
+    }
+
+    FRGraphFactory Factory;
+    const auto CompactGraph = FRGraphFactoryEx::CreateCompactGraph(Factory, CityObjects);
+    const float CellSize = Factory.MergeCellSize * FPLATEAURnDef::Meter2Unit;
+
+    // 変更前
+    int32 Rounds = 0;
+    double StartSeconds = FPlatformTime::Seconds();
+    const int32 StableCount = MergeVerticesUntilStable(CompactGraph.VertexPositions, CellSize, Factory.MergeCellLength, Rounds).Num();
+    const double BeforeSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+    // 変更後
+    const auto Graph = CompactGraph.ToGraph();
+    StartSeconds = FPlatformTime::Seconds();
+    FRGraphEx::VertexReduction(Graph, Factory.MergeCellSize, Factory.MergeCellLength, Factory.RemoveMidPointTolerance);
+    const double AfterSeconds = FPlatformTime::Seconds() - StartSeconds;
+    const int32 ReducedCount = FRCompactGraph::FromGraph(*Graph).GetVertexCount();
+
+    AddInfo(FString::Printf(TEXT("%d vertices: MergeVertices x%d rounds %.3f ms (%d vertices), VertexReduction %.3f ms (%d vertices)"),
+        CompactGraph.GetVertexCount(), Rounds, BeforeSeconds * 1000.0, StableCount, AfterSeconds * 1000.0, ReducedCount));
+
+    FRGraphEx::VertexReduction(Graph, Factory.MergeCellSize, Factory.MergeCellLength, Factory.RemoveMidPointTolerance);
+    const int32 SecondCount = FRCompactGraph::FromGraph(*Graph).GetVertexCount();
+    Outer->RemoveFromRoot();
+
+    if (ReducedCount == 0 || SecondCount != ReducedCount) {
+        FinishTest(false, FString::Printf(TEXT("VertexReduction did not converge: %d -> %d vertices"), ReducedCount, SecondCount));
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
+
+/// <summary>
+/// FRGraphEx::VertexReductionの統合結果の確認
+/// 同梱テストデータの道路(tran)のGMLから作成したグラフについて、VertexReductionで統合した頂点の位置が
+/// 変更前の統合処理(FGeoGraphEx::MergeVerticesの繰り返し)の結果と一致することを確認します。
+/// 直線状の頂点の削除は比較の対象外とするため、中間点の許容誤差は0にします。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_RGraph_VertexReductionMatchesMergeVertices, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.RGraph.VertexReductionMatchesMergeVertices",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_RGraph_VertexReductionMatchesMergeVertices::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RGraphVertexReduction_Local;
+    InitializeTest("RGraph.VertexReductionMatchesMergeVertices");
+
+    const auto Outer = NewObject<UPackage>(nullptr, TEXT("/Temp/PLATEAUTest_RGraphVertexReductionMatches"));
+    Outer->AddToRoot();
+    TArray<FSubDividedCityObject> CityObjects;
+    bool bLoaded;
+    LoadCityObjects(*Outer, CityObjects, bLoaded);
+    if (!bLoaded) {
+        Outer->RemoveFromRoot();
+        FinishTest(false, "Failed to load CityModel");
+        return true;
+    }
+
+    FRGraphFactory Factory;
+    const auto CompactGraph = FRGraphFactoryEx::CreateCompactGraph(Factory, CityObjects);
+    const float CellSize = Factory.MergeCellSize * FPLATEAURnDef::Meter2Unit;
+
+    int32 Rounds = 0;
+    const auto Expected = MergeVerticesUntilStable(CompactGraph.VertexPositions, CellSize, Factory.MergeCellLength, Rounds);
+
+    const auto Graph = CompactGraph.ToGraph();
+    FRGraphEx::VertexReduction(Graph, Factory.MergeCellSize, Factory.MergeCellLength, 0.f);
+    const auto Actual = FRCompactGraph::FromGraph(*Graph).VertexPositions;
+    Outer->RemoveFromRoot();
+
+    // 統合後の頂点は全て変更前の統合結果の位置にある. 両端が統合されて無効になった辺の頂点はグラフから外れるため, 逆方向は数のみ出力する
+    constexpr double Tolerance = 0.01;
+    const int32 Matched = CountMatchedPositions(Actual, Expected, Tolerance);
+    const int32 Covered = CountMatchedPositions(Expected, Actual, Tolerance);
+    AddInfo(FString::Printf(TEXT("%d vertices: MergeVertices %d vertices (%d in graph), VertexReduction %d vertices (%d matched)"),
+        CompactGraph.GetVertexCount(), Expected.Num(), Covered, Actual.Num(), Matched));
+
+    if (Actual.Num() == 0 || Matched != Actual.Num()) {
+        FinishTest(false, FString::Printf(TEXT("VertexReduction differs from MergeVertices: %d of %d vertices matched"), Matched, Actual.Num()));
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,129 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUMeshLoader.h"
+#include "PLATEAUMeshExporter.h"
+#include "PLATEAUExportSettings.h"
+#include "Component/PLATEAUSceneComponent.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "Tests/AutomationCommon.h"
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+
+namespace FPLATEAUTest_Benchmark_Reconstruct_Local {
+    using namespace PLATEAUAutomationTestUtil::BuildingFixtures;
+
+    const FString GmlName = TEXT("53392642_bldg_6697_op");
+    constexpr int32 FeatureCount = 1000;
+    constexpr int32 FeaturesPerRow = 25;
+
+    void LoadModel(APLATEAUInstancedCityModel* Actor, const bool bRetainMeshSourceData) {
+        FLoadInputData LoadInputData;
+        LoadInputData.GmlPath = GmlName + TEXT(".gml");
+        LoadInputData.bIncludeAttrInfo = true;
+        LoadInputData.FallbackMaterial = nullptr;
+        LoadInputData.bRetainMeshSourceData = bRetainMeshSourceData;
+
+        FPLATEAUMeshLoader MeshLoader(true);
+        TAtomic<bool> bCanceled(false);
+        MeshLoader.LoadModel(Actor, Actor->GetRootComponent()->GetAttachChildren()[0], CreateModel(2, 2, FeatureCount, FeaturesPerRow, 4000.0), LoadInputData, nullptr, &bCanceled);
+    }
+
+    TArray<UPLATEAUCityObjectGroup*> GetCityObjectGroups(const AActor& Actor) {
+        TInlineComponentArray<UPLATEAUCityObjectGroup*> Components(&Actor);
+        return TArray<UPLATEAUCityObjectGroup*>(Components);
+    }
+
+    void CountModel(const plateau::polygonMesh::Node& Node, int64& OutVertices, int64& OutTriangles) {
+        if (Node.getMesh() != nullptr) {
+            OutVertices += Node.getMesh()->getVertices().size();
+            OutTriangles += Node.getMesh()->getIndices().size() / 3;
+        }
+        for (int i = 0; i < Node.getChildCount(); ++i)
+            CountModel(Node.getChildAt(i), OutVertices, OutTriangles);
+    }
+}
+
+/// <summary>
+/// 結合・分離の計測
+/// 作成元のメッシュを保持しない場合(描画用データの読み戻し)と保持する場合について、結合・分離前のモデル作成時間と頂点数、
+/// 地域単位への結合時間を出力し、三角形数が一致すること、結合後のComponentが作成元のメッシュを保持していることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_Reconstruct, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.Reconstruct",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_Reconstruct::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_Reconstruct_Local;
+    InitializeTest("Benchmark.Reconstruct");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    // [0]: 描画用データから作成, [1]: 作成元のメッシュから作成
+    const TArray<APLATEAUInstancedCityModel*> Actors = { CreateCityModel(*GetWorld(), { GmlName }), CreateCityModel(*GetWorld(), { GmlName }) };
+    const auto LoadFuture = MakeShared<TFuture<void>>(Async(EAsyncExecution::Thread, [Actors] {
+        LoadModel(Actors[0], false);
+        LoadModel(Actors[1], true);
+    }));
+    const auto Failure = MakeShared<FString>();
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Actors, LoadFuture, Failure] {
+        if (!LoadFuture->IsReady())
+            return false;
+
+        FPLATEAUMeshExportOptions Options;
+        Options.bExportHiddenObjects = false;
+        Options.bExportTexture = true;
+        Options.TransformType = EMeshTransformType::Local;
+        Options.CoordinateSystem = ECoordinateSystem::ESU;
+
+        int64 Triangles[2] = {};
+        for (int32 i = 0; i < Actors.Num(); ++i) {
+            const auto Components = GetCityObjectGroups(*Actors[i]);
+            const double StartSeconds = FPlatformTime::Seconds();
+            FPLATEAUMeshExporter MeshExporter;
+            const auto Model = MeshExporter.CreateModelFromComponents(Actors[i], Components, Options);
+            const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+            int64 Vertices = 0;
+            for (int j = 0; j < Model->getRootNodeCount(); ++j)
+                CountModel(Model->getRootNodeAt(j), Vertices, Triangles[i]);
+            AddInfo(FString::Printf(TEXT("%s: %d components, %.3f ms, %lld vertices, %lld triangles"),
+                i == 0 ? TEXT("Render data") : TEXT("Source data"), Components.Num(), Seconds * 1000.0, Vertices, Triangles[i]));
+        }
+
+        if (Triangles[0] == 0 || Triangles[0] != Triangles[1])
+            *Failure = TEXT("Triangle count mismatch between render data and source data");
+        return true;
+    }));
+
+    ADD_LATENT_AUTOMATION_COMMAND(FThreadedAutomationLatentCommand([this, Actors, Failure] {
+        for (int32 i = 0; i < Actors.Num(); ++i) {
+            const auto Components = GetCityObjectGroups(*Actors[i]);
+            const TArray<USceneComponent*> TargetComponents(Components);
+            const double StartSeconds = FPlatformTime::Seconds();
+            auto Task = Actors[i]->ReconstructModel(TargetComponents, EPLATEAUMeshGranularity::PerCityModelArea, false);
+            Task.Wait();
+            const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+            const auto& CreatedComponents = Task.GetResult();
+            AddInfo(FString::Printf(TEXT("%s: reconstruct %.3f ms, %d components created"),
+                i == 0 ? TEXT("Render data") : TEXT("Source data"), Seconds * 1000.0, CreatedComponents.Num()));
+
+            for (const auto& Created : CreatedComponents) {
+                const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Created);
+                if (CityObjectGroup != nullptr && !CityObjectGroup->GetMeshSourceData().IsValid())
+                    *Failure = TEXT("Reconstructed component does not retain mesh source data");
+            }
+        }
+        }));
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Failure] {
+        FinishTest(Failure->IsEmpty(), *Failure);
+        return true;
+    }));
+
+    return true;
+}
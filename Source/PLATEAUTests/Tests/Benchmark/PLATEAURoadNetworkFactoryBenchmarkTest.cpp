@@ -0,0 +1,129 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "RoadNetwork/CityObject/SubDividedCityObject.h"
+#include "RoadNetwork/Factory/RoadNetworkFactory.h"
+#include "RoadNetwork/RGraph/RGraphFactory.h"
+#include "RoadNetwork/RGraph/RCompactGraph.h"
+#include "RoadNetwork/Structure/RnModel.h"
+#include "RoadNetwork/Structure/RnRoad.h"
+#include "RoadNetwork/Structure/RnIntersection.h"
+#include "RoadNetwork/Structure/RnWay.h"
+
+namespace FPLATEAUTest_Benchmark_RoadNetworkFactory_Local {
+    using namespace PLATEAUAutomationTestUtil::RoadNetwork;
+
+    URnModel* CreateModel(UObject& Outer, const FRoadNetworkFactory& Factory, const FRCompactGraph& CompactGraph, double& OutSeconds) {
+        auto OptimizedGraph = CompactGraph;
+        FRGraphFactoryEx::Optimize(Factory.GraphFactory, OptimizedGraph);
+        const auto Graph = FRGraphFactoryEx::OptimizeFaces(Factory.GraphFactory, OptimizedGraph.ToGraph());
+        const auto Model = NewObject<URnModel>(&Outer);
+        const double StartSeconds = FPlatformTime::Seconds();
+        FRoadNetworkFactoryEx::CreateRnModel(Factory, Graph, Model);
+        OutSeconds = FPlatformTime::Seconds() - StartSeconds;
+        return Model;
+    }
+
+    // 道路/交差点毎の対象の地物名とWayの頂点を列挙した文字列
+    FString DescribeModel(const URnModel& Model) {
+        FString Result = FString::Printf(TEXT("Roads %d, Intersections %d, SideWalks %d\n"),
+            Model.GetRoads().Num(), Model.GetIntersections().Num(), Model.GetSideWalks().Num());
+        auto AppendRoadBase = [&Result](const URnRoadBase* RoadBase) {
+            Result += RoadBase->GetTargetTransName();
+            for (const auto& Way : RoadBase->GetAllWays()) {
+                Result += TEXT(" |");
+                if (!Way)
+                    continue;
+                for (int32 i = 0; i < Way->Count(); ++i) {
+                    const auto Vertex = Way->GetVertex(i);
+                    Result += FString::Printf(TEXT(" %.1f,%.1f,%.1f"), Vertex.X, Vertex.Y, Vertex.Z);
+                }
+            }
+            Result += TEXT("\n");
+            };
+        for (const auto Road : Model.GetRoads())
+            AppendRoadBase(Road);
+        for (const auto Intersection : Model.GetIntersections())
+            AppendRoadBase(Intersection);
+        return Result;
+    }
+}
+
+/// <summary>
+/// 道路構造の並列生成の決定性テスト
+/// 碁盤目状の道路から1スレッドと並列でRnModelを作成し, 道路/交差点/歩道の構成とWayの頂点が一致することを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_RoadNetworkFactory_Determinism, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.RoadNetworkFactory.Determinism",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_RoadNetworkFactory_Determinism::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RoadNetworkFactory_Local;
+    InitializeTest("RoadNetworkFactory.Determinism");
+
+    const auto Outer = NewObject<UPackage>(nullptr, TEXT("/Temp/PLATEAUTest_RoadNetworkFactoryDeterminism"));
+    Outer->AddToRoot();
+    const auto CityObjects = CreateGridCityObjects(*Outer, 6);
+
+    FRoadNetworkFactory Factory;
+    const auto CompactGraph = FRGraphFactoryEx::CreateCompactGraph(Factory.GraphFactory, CityObjects);
+
+    double Seconds;
+    Factory.bParallelBuild = false;
+    const auto Expected = DescribeModel(*CreateModel(*Outer, Factory, CompactGraph, Seconds));
+    Factory.bParallelBuild = true;
+    const auto Parallel0 = DescribeModel(*CreateModel(*Outer, Factory, CompactGraph, Seconds));
+    const auto Parallel1 = DescribeModel(*CreateModel(*Outer, Factory, CompactGraph, Seconds));
+    Outer->RemoveFromRoot();
+
+    if (Expected.IsEmpty() || Expected != Parallel0 || Expected != Parallel1) {
+        AddError(FString::Printf(TEXT("Single thread:\n%s\nParallel:\n%s\nParallel (2nd):\n%s"), *Expected, *Parallel0, *Parallel1));
+        FinishTest(false, "RnModel differs between single-threaded and parallel builds");
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
+
+/// <summary>
+/// 道路構造の並列生成の計測
+/// 碁盤目状の道路の大きさを変えて, 1スレッドと並列でのFRoadNetworkFactoryEx::CreateRnModelの処理時間を出力します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_RoadNetworkFactory, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.RoadNetworkFactory",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_RoadNetworkFactory::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RoadNetworkFactory_Local;
+    InitializeTest("Benchmark.RoadNetworkFactory");
+
+    for (const int32 N : { 8, 16, 32 }) {
+        const auto Outer = NewObject<UPackage>(nullptr, *FString::Printf(TEXT("/Temp/PLATEAUTest_RoadNetworkFactory_%d"), N));
+        Outer->AddToRoot();
+        const auto CityObjects = CreateGridCityObjects(*Outer, N);
+
+        FRoadNetworkFactory Factory;
+        const auto CompactGraph = FRGraphFactoryEx::CreateCompactGraph(Factory.GraphFactory, CityObjects);
+
+        double SingleSeconds;
+        Factory.bParallelBuild = false;
+        CreateModel(*Outer, Factory, CompactGraph, SingleSeconds);
+
+        double ParallelSeconds;
+        Factory.bParallelBuild = true;
+        CreateModel(*Outer, Factory, CompactGraph, ParallelSeconds);
+
+        AddInfo(FString::Printf(TEXT("%d trans (%d threads): single thread %.3f ms, parallel %.3f ms (x%.2f)"),
+            CityObjects.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, SingleSeconds * 1000.0, ParallelSeconds * 1000.0,
+            SingleSeconds / FMath::Max(ParallelSeconds, UE_SMALL_NUMBER)));
+
+        Outer->RemoveFromRoot();
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+    }
+
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,165 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "RoadNetwork/CityObject/SubDividedCityObject.h"
+#include "RoadNetwork/Factory/RoadNetworkFactory.h"
+#include "RoadNetwork/RGraph/RGraphFactory.h"
+#include "RoadNetwork/RGraph/RCompactGraph.h"
+#include "RoadNetwork/Structure/RnModel.h"
+#include "UObject/UObjectArray.h"
+
+namespace FPLATEAUTest_Benchmark_RoadNetworkGraph_Local {
+    // 1辺の区画数. 区画毎に道路の四角形を1つ作成する
+    constexpr int32 CellsPerRow = 200;
+    constexpr double CellSize = 1000.0;
+    // 道路の地物毎の区画数
+    constexpr int32 CellsPerCityObject = 100;
+
+    TArray<FSubDividedCityObject> CreateCityObjects(UObject& Outer) {
+        TArray<FSubDividedCityObject> CityObjects;
+        for (int32 First = 0; First < CellsPerRow * CellsPerRow; First += CellsPerCityObject) {
+            auto& CityObject = CityObjects.AddDefaulted_GetRef();
+            CityObject.Name = FString::Printf(TEXT("tran_%06d"), CityObjects.Num());
+            CityObject.SelfRoadType = ERRoadTypeMask::Road;
+            CityObject.CityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Outer);
+
+            for (int32 Cell = First; Cell < First + CellsPerCityObject; ++Cell) {
+                const double X = (Cell % CellsPerRow) * CellSize;
+                const double Y = (Cell / CellsPerRow) * CellSize;
+                auto& Mesh = CityObject.Meshes.AddDefaulted_GetRef();
+                Mesh.Vertices = { FVector(X, Y, 0.0), FVector(X + CellSize, Y, 0.0), FVector(X + CellSize, Y + CellSize, 0.0), FVector(X, Y + CellSize, 0.0) };
+                Mesh.SubMeshes.AddDefaulted_GetRef().Triangles = { 0, 1, 2, 0, 2, 3 };
+            }
+        }
+        return CityObjects;
+    }
+
+    int64 GetUsedPhysicalMemory() {
+        return static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+    }
+
+    struct FCreateRoadNetworkResult {
+        double GraphSeconds = 0.0;
+        double ModelSeconds = 0.0;
+        int32 CreatedObjects = 0;
+        int32 Faces = 0;
+        int32 Roads = 0;
+        int32 Intersections = 0;
+        int32 SideWalks = 0;
+
+        FString ToString() const {
+            return FString::Printf(TEXT("graph %.3f ms (%d faces), model %.3f ms, total %.3f ms, %d UObjects, roads %d, intersections %d, sidewalks %d"),
+                GraphSeconds * 1000.0, Faces, ModelSeconds * 1000.0, (GraphSeconds + ModelSeconds) * 1000.0, CreatedObjects, Roads, Intersections, SideWalks);
+        }
+    };
+
+    // 道路ネットワークの作成(グラフの作成・最適化とRnModelの作成)を計測する
+    FCreateRoadNetworkResult CreateRoadNetwork(UObject& Outer, FRoadNetworkFactory Factory, const TArray<FSubDividedCityObject>& CityObjects, const bool bOptimizeCompactGraph) {
+        Factory.GraphFactory.bOptimizeCompactGraph = bOptimizeCompactGraph;
+        FCreateRoadNetworkResult Result;
+        const int32 ObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+        double StartSeconds = FPlatformTime::Seconds();
+        const auto Graph = FRGraphFactoryEx::CreateGraph(Factory.GraphFactory, CityObjects);
+        Result.GraphSeconds = FPlatformTime::Seconds() - StartSeconds;
+        Result.Faces = Graph->GetFaces().Num();
+
+        const auto Model = NewObject<URnModel>(&Outer);
+        StartSeconds = FPlatformTime::Seconds();
+        FRoadNetworkFactoryEx::CreateRnModel(Factory, Graph, Model);
+        Result.ModelSeconds = FPlatformTime::Seconds() - StartSeconds;
+        Result.CreatedObjects = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore;
+        Result.Roads = Model->GetRoads().Num();
+        Result.Intersections = Model->GetIntersections().Num();
+        Result.SideWalks = Model->GetSideWalks().Num();
+        return Result;
+    }
+}
+
+/// <summary>
+/// 道路ネットワーク用グラフの作成の計測
+/// 道路の四角形を並べた地物からFRCompactGraphを作成し、URGraphへの変換について時間とメモリ使用量を出力し、
+/// URGraphとの相互変換で頂点・辺・面の数が変わらないことを確認します。
+/// また、碁盤目状の道路について、最適化をURGraph上で行う場合(旧)とFRCompactGraph上で行う場合(新)の道路ネットワーク作成全体の時間を出力し、
+/// 作成される道路・交差点・歩道の数が一致することを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_RoadNetworkGraph, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.RoadNetworkGraph",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_RoadNetworkGraph::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RoadNetworkGraph_Local;
+    InitializeTest("Benchmark.RoadNetworkGraph");
+
+    const auto Outer = NewObject<UPackage>(nullptr, TEXT("/Temp/PLATEAUTest_RoadNetworkGraph"));
+    Outer->AddToRoot();
+    const auto CityObjects = CreateCityObjects(*Outer);
+
+    FRGraphFactory Factory;
+    double StartSeconds = FPlatformTime::Seconds();
+    const auto CompactGraph = FRGraphFactoryEx::CreateCompactGraph(Factory, CityObjects);
+    const double CompactSeconds = FPlatformTime::Seconds() - StartSeconds;
+    AddInfo(FString::Printf(TEXT("Compact graph: %d vertices, %d edges, %d faces, %.3f ms, %.1f KB"),
+        CompactGraph.GetVertexCount(), CompactGraph.GetEdgeCount(), CompactGraph.GetFaceCount(),
+        CompactSeconds * 1000.0, CompactGraph.GetAllocatedSize() / 1024.0));
+
+    // URGraphは要素毎にUObjectを作成する
+    const int32 ObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+    const int64 MemoryBefore = GetUsedPhysicalMemory();
+    StartSeconds = FPlatformTime::Seconds();
+    const auto Graph = CompactGraph.ToGraph();
+    const double ToGraphSeconds = FPlatformTime::Seconds() - StartSeconds;
+    const int32 CreatedObjects = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore;
+    AddInfo(FString::Printf(TEXT("URGraph: %d UObjects, %.3f ms, about %.1f KB"),
+        CreatedObjects, ToGraphSeconds * 1000.0, FMath::Max<int64>(GetUsedPhysicalMemory() - MemoryBefore, 0) / 1024.0));
+
+    StartSeconds = FPlatformTime::Seconds();
+    const auto RoundTrip = FRCompactGraph::FromGraph(*Graph);
+    AddInfo(FString::Printf(TEXT("URGraph -> compact graph: %.3f ms"), (FPlatformTime::Seconds() - StartSeconds) * 1000.0));
+
+    if (RoundTrip.GetVertexCount() != CompactGraph.GetVertexCount() || RoundTrip.GetEdgeCount() != CompactGraph.GetEdgeCount()
+        || RoundTrip.GetFaceCount() != CompactGraph.GetFaceCount()) {
+        Outer->RemoveFromRoot();
+        FinishTest(false, "Graph conversion changed the number of elements");
+        return true;
+    }
+
+    // グラフの最適化: URGraph上(旧) / FRCompactGraph上(新)
+    for (const bool bOptimizeCompactGraph : { false, true }) {
+        Factory.bOptimizeCompactGraph = bOptimizeCompactGraph;
+        const int32 GraphObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+        StartSeconds = FPlatformTime::Seconds();
+        const auto OptimizedGraph = FRGraphFactoryEx::CreateGraph(Factory, CityObjects);
+        AddInfo(FString::Printf(TEXT("CreateGraph (%s): %.3f ms, %d faces, %d UObjects"), bOptimizeCompactGraph ? TEXT("compact") : TEXT("URGraph"),
+            (FPlatformTime::Seconds() - StartSeconds) * 1000.0, OptimizedGraph->GetFaces().Num(),
+            GUObjectArray.GetObjectArrayNumMinusAvailable() - GraphObjectsBefore));
+    }
+    Outer->RemoveFromRoot();
+    CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+    // 道路ネットワーク作成全体
+    for (const int32 N : { 8, 16, 32 }) {
+        const auto GridOuter = NewObject<UPackage>(nullptr, *FString::Printf(TEXT("/Temp/PLATEAUTest_RoadNetworkGraph_%d"), N));
+        GridOuter->AddToRoot();
+        const auto GridCityObjects = PLATEAUAutomationTestUtil::RoadNetwork::CreateGridCityObjects(*GridOuter, N);
+
+        const FRoadNetworkFactory RoadNetworkFactory;
+        const auto Old = CreateRoadNetwork(*GridOuter, RoadNetworkFactory, GridCityObjects, false);
+        const auto New = CreateRoadNetwork(*GridOuter, RoadNetworkFactory, GridCityObjects, true);
+        AddInfo(FString::Printf(TEXT("%d trans, URGraph: %s"), GridCityObjects.Num(), *Old.ToString()));
+        AddInfo(FString::Printf(TEXT("%d trans, compact: %s (x%.2f)"), GridCityObjects.Num(), *New.ToString(),
+            (Old.GraphSeconds + Old.ModelSeconds) / FMath::Max(New.GraphSeconds + New.ModelSeconds, UE_SMALL_NUMBER)));
+
+        GridOuter->RemoveFromRoot();
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+        if (Old.Faces != New.Faces || Old.Roads != New.Roads || Old.Intersections != New.Intersections || Old.SideWalks != New.SideWalks) {
+            FinishTest(false, FString::Printf(TEXT("Road network differs between URGraph and compact graph optimization (%d trans)"), GridCityObjects.Num()));
+            return true;
+        }
+    }
+
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,165 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "RoadNetwork/CityObject/SubDividedCityObject.h"
+#include "RoadNetwork/Factory/RoadNetworkFactory.h"
+#include "RoadNetwork/RGraph/RGraphFactory.h"
+#include "RoadNetwork/Structure/RnModel.h"
+#include "RoadNetwork/Structure/RnRoad.h"
+#include "RoadNetwork/Structure/RnIntersection.h"
+#include "RoadNetwork/Structure/RnWay.h"
+
+namespace FPLATEAUTest_Benchmark_RoadNetworkUpdate_Local {
+    using namespace PLATEAUAutomationTestUtil::RoadNetwork;
+
+    FBox GetBounds(const FSubDividedCityObject& CityObject) {
+        FBox Bounds(ForceInit);
+        for (const auto& Mesh : CityObject.Meshes)
+            Bounds += FBox(Mesh.Vertices);
+        return Bounds;
+    }
+
+    URnModel* CreateModel(UObject& Outer, const FRoadNetworkFactory& Factory, const TArray<FSubDividedCityObject>& CityObjects, double& OutSeconds) {
+        const auto Model = NewObject<URnModel>(&Outer);
+        const double StartSeconds = FPlatformTime::Seconds();
+        FRoadNetworkFactoryEx::CreateRnModel(Factory, FRGraphFactoryEx::CreateGraph(Factory.GraphFactory, CityObjects), Model);
+        OutSeconds = FPlatformTime::Seconds() - StartSeconds;
+        return Model;
+    }
+
+    // CityObjectsの地物のうちChangedを変更された地物としてModelを差分更新する
+    FRoadNetworkFactoryEx::FUpdateRnModelResult UpdateModel(URnModel& Model, const FRoadNetworkFactory& Factory, const TArray<FSubDividedCityObject>& CityObjects, const FSubDividedCityObject& Changed) {
+        FRoadNetworkFactoryEx::FUpdateRnModelRequest Request;
+        for (const auto& CityObject : CityObjects)
+            Request.TargetBounds.Add(CityObject.CityObjectGroup.Get(), GetBounds(CityObject));
+        Request.ChangedTrans.Add(Changed.CityObjectGroup.Get());
+        Request.ChangedBounds.Add(GetBounds(Changed));
+
+        return FRoadNetworkFactoryEx::UpdateRnModel(Factory, &Model, Request
+            , [&CityObjects](const TArray<UPLATEAUCityObjectGroup*>& Targets, TArray<FSubDividedCityObject>& OutCityObjects) {
+                for (const auto& CityObject : CityObjects) {
+                    if (Targets.Contains(CityObject.CityObjectGroup.Get()))
+                        OutCityObjects.Add(CityObject);
+                }
+            });
+    }
+
+    // 隣接する道路/交差点と同じ線を参照していない道路のレーンの境界線の数. 全体生成では境界線は共有される
+    int32 CountUnsharedBorders(const URnModel& Model) {
+        int32 Count = 0;
+        for (const auto Road : Model.GetRoads()) {
+            for (const auto BorderType : { EPLATEAURnLaneBorderType::Prev, EPLATEAURnLaneBorderType::Next }) {
+                const auto Neighbor = Road->GetNeighborRoad(BorderType);
+                if (!Neighbor)
+                    continue;
+                const auto NeighborBorders = Neighbor->GetBorders();
+                for (const auto Border : Road->GetBorderWays(BorderType)) {
+                    if (!NeighborBorders.ContainsByPredicate([Border](const URnWay* Way) { return Way->IsSameLineReference(Border); }))
+                        Count++;
+                }
+            }
+        }
+        return Count;
+    }
+
+    // 道路/交差点毎の対象の地物名と隣接する道路/交差点の地物名を列挙した文字列. 生成順によらない
+    FString DescribeTopology(const URnModel& Model, bool& bOutIsClosed) {
+        TArray<const URnRoadBase*> RoadBases;
+        for (const auto Road : Model.GetRoads())
+            RoadBases.Add(Road);
+        for (const auto Intersection : Model.GetIntersections())
+            RoadBases.Add(Intersection);
+        const TSet<const URnRoadBase*> RoadBaseSet(RoadBases);
+
+        bOutIsClosed = true;
+        TArray<FString> Lines;
+        for (const auto RoadBase : RoadBases) {
+            TArray<FString> Neighbors;
+            for (const auto Neighbor : RoadBase->GetNeighborRoads()) {
+                if (!Neighbor)
+                    continue;
+                // モデルに含まれない道路/交差点と繋がっている
+                bOutIsClosed &= RoadBaseSet.Contains(Neighbor);
+                Neighbors.Add(Neighbor->GetTargetTransName());
+            }
+            Neighbors.Sort();
+            Lines.Add(RoadBase->GetTargetTransName() + TEXT(" -> ") + FString::Join(Neighbors, TEXT(", ")));
+        }
+        Lines.Sort();
+        return FString::Printf(TEXT("Roads %d, Intersections %d, SideWalks %d\n"),
+            Model.GetRoads().Num(), Model.GetIntersections().Num(), Model.GetSideWalks().Num()) + FString::Join(Lines, TEXT("\n"));
+    }
+}
+
+/// <summary>
+/// 道路構造の差分更新の計測
+/// 碁盤目状の道路の中央の道路を削除/再追加してFRoadNetworkFactoryEx::UpdateRnModelと全体生成の処理時間を出力し,
+/// 差分更新した道路構造の道路/交差点/歩道の数と接続関係が全体生成と一致し, 継ぎ目の境界線が共有されていることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_RoadNetworkUpdate, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.RoadNetworkUpdate",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_RoadNetworkUpdate::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RoadNetworkUpdate_Local;
+    InitializeTest("Benchmark.RoadNetworkUpdate");
+
+    constexpr int32 N = 12;
+    const auto Outer = NewObject<UPackage>(nullptr, TEXT("/Temp/PLATEAUTest_RoadNetworkUpdate"));
+    Outer->AddToRoot();
+    const auto CityObjects = CreateGridCityObjects(*Outer, N);
+    const auto EditedIndex = CityObjects.IndexOfByPredicate([](const FSubDividedCityObject& CityObject) {
+        return CityObject.Name == FString::Printf(TEXT("tran_x_%d_%d"), N / 2, N / 2);
+        });
+    const auto& Edited = CityObjects[EditedIndex];
+    auto RemovedCityObjects = CityObjects;
+    RemovedCityObjects.RemoveAt(EditedIndex);
+
+    FRoadNetworkFactory Factory;
+    double FullSeconds;
+    const auto Model = CreateModel(*Outer, Factory, CityObjects, FullSeconds);
+
+    // 道路の削除と再追加
+    const struct {
+        const TCHAR* Name;
+        const TArray<FSubDividedCityObject>& CityObjects;
+    } Edits[] = { { TEXT("remove"), RemovedCityObjects }, { TEXT("add"), CityObjects } };
+
+    bool bSuccess = true;
+    for (const auto& Edit : Edits) {
+        const auto Result = UpdateModel(*Model, Factory, Edit.CityObjects, Edited);
+
+        double ExpectedSeconds;
+        bool bIsClosed, bIsExpectedClosed;
+        const auto Expected = DescribeTopology(*CreateModel(*Outer, Factory, Edit.CityObjects, ExpectedSeconds), bIsExpectedClosed);
+        const auto Actual = DescribeTopology(*Model, bIsClosed);
+
+        AddInfo(FString::Printf(TEXT("%s 1 of %d trans: full %.3f ms, update %.3f ms (%d rebuilt, %d context trans, %d -> %d road bases)"),
+            Edit.Name, Edit.CityObjects.Num(), ExpectedSeconds * 1000.0, Result.Seconds * 1000.0,
+            Result.RegionTranCount, Result.ContextTranCount, Result.RemovedRoadBaseCount, Result.AddedRoadBaseCount));
+
+        if (!bIsClosed || Actual != Expected) {
+            AddError(FString::Printf(TEXT("%s\nExpected:\n%s\nActual:\n%s"), Edit.Name, *Expected, *Actual));
+            bSuccess = false;
+        }
+        const auto UnsharedBorderCount = CountUnsharedBorders(*Model);
+        if (!Result.bIsValid || UnsharedBorderCount > 0) {
+            AddError(FString::Printf(TEXT("%s: %d borders are not shared with neighbors (Check %s)"),
+                Edit.Name, UnsharedBorderCount, Result.bIsValid ? TEXT("passed") : TEXT("failed")));
+            bSuccess = false;
+        }
+    }
+    AddInfo(FString::Printf(TEXT("initial full build %.3f ms"), FullSeconds * 1000.0));
+    Outer->RemoveFromRoot();
+    CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+    if (!bSuccess) {
+        FinishTest(false, "Updated RnModel differs from full build");
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
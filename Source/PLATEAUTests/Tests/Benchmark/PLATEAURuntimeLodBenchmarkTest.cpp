@@ -0,0 +1,133 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUMeshLoader.h"
+#include "PLATEAURuntimeLodManager.h"
+#include "Component/PLATEAUSceneComponent.h"
+#include "Util/PLATEAUComponentUtil.h"
+#include "Tests/AutomationCommon.h"
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+
+namespace FPLATEAUTest_Benchmark_RuntimeLod_Local {
+    const FString GmlName = TEXT("53392642_bldg_6697_op");
+    constexpr int32 FeaturesPerRow = 30;
+    constexpr int32 FeatureCount = FeaturesPerRow * FeaturesPerRow;
+    constexpr double FeatureSpacing = 5000.0;
+    constexpr int32 FrameCount = 600;
+    constexpr float FOVDegrees = 90.0f;
+
+    int64 CountVisibleTriangles(const AActor& Actor) {
+        int64 Triangles = 0;
+        TInlineComponentArray<UStaticMeshComponent*> StaticMeshComponents(&Actor);
+        for (const auto& StaticMeshComponent : StaticMeshComponents) {
+            if (!StaticMeshComponent->IsVisible() || StaticMeshComponent->GetStaticMesh() == nullptr || StaticMeshComponent->GetStaticMesh()->GetRenderData() == nullptr)
+                continue;
+            Triangles += StaticMeshComponent->GetStaticMesh()->GetRenderData()->LODResources[0].GetNumTriangles();
+        }
+        return Triangles;
+    }
+
+    // 地物毎に表示中のLodの数を数え、1つでない地物の数を返します
+    int32 CountInvalidFeatures(const APLATEAUInstancedCityModel& Actor) {
+        TMap<FString, int32> VisibleLods;
+        for (const auto& LodComponent : Actor.GetRootComponent()->GetAttachChildren()[0]->GetAttachChildren()) {
+            for (const auto& FeatureComponent : LodComponent->GetAttachChildren()) {
+                VisibleLods.FindOrAdd(FPLATEAUComponentUtil::GetOriginalComponentName(FeatureComponent)) += FeatureComponent->IsVisible() ? 1 : 0;
+            }
+        }
+        int32 InvalidFeatures = FeatureCount - VisibleLods.Num();
+        for (const auto& [Name, Count] : VisibleLods) {
+            InvalidFeatures += Count != 1 ? 1 : 0;
+        }
+        return InvalidFeatures;
+    }
+}
+
+/// <summary>
+/// 実行時のLod切り替えの計測
+/// LOD1-LOD3の建物を並べた区画の上空を通過する視点について、最大Lodのみ表示した場合と画面サイズによるLod切り替えを行った場合の
+/// 表示中の三角形数と1フレームあたりの切り替え処理時間を出力し、切り替え後に各地物のLodが1つのみ表示されていることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_RuntimeLod, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.RuntimeLod",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_RuntimeLod::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_RuntimeLod_Local;
+    InitializeTest("Benchmark.RuntimeLod");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Actor = PLATEAUAutomationTestUtil::BuildingFixtures::CreateCityModel(*GetWorld(), { GmlName });
+    const auto LoadFuture = MakeShared<TFuture<void>>(Async(EAsyncExecution::Thread, [Actor, GmlComponent = Actor->GetRootComponent()->GetAttachChildren()[0].Get()] {
+        FLoadInputData LoadInputData;
+        LoadInputData.GmlPath = GmlName + TEXT(".gml");
+        LoadInputData.bIncludeAttrInfo = false;
+        LoadInputData.FallbackMaterial = nullptr;
+
+        FPLATEAUMeshLoader MeshLoader(true);
+        TAtomic<bool> bCanceled(false);
+        // LOD1~3の建物を原点を中心に並べる
+        const double Half = FeaturesPerRow * FeatureSpacing * 0.5;
+        const auto Model = PLATEAUAutomationTestUtil::BuildingFixtures::CreateModel(1, 3, FeatureCount, FeaturesPerRow, FeatureSpacing, TVec3d(-Half, -Half, 0.0));
+        MeshLoader.LoadModel(Actor, GmlComponent, Model, LoadInputData, nullptr, &bCanceled);
+    }));
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Actor, LoadFuture] {
+        if (!LoadFuture->IsReady())
+            return false;
+
+        // 従来の最大Lodのみの表示
+        TMap<plateau::dataset::PredefinedCityModelPackage, FPLATEAUMinMaxLod> PackageToLodRangeMap;
+        PackageToLodRangeMap.Add(plateau::dataset::PredefinedCityModelPackage::Building, FPLATEAUMinMaxLod{ 0, 4 });
+        Actor->FilterByLods(plateau::dataset::PredefinedCityModelPackage::Building, PackageToLodRangeMap, true);
+        const int64 MaxLodTriangles = CountVisibleTriangles(*Actor);
+
+        // 区画の対角線上を高度30mで通過する
+        const double Half = FeaturesPerRow * FeatureSpacing * 0.5;
+        const FVector Start(-Half * 1.2, -Half * 1.2, 3000.0);
+        const FVector End(Half * 1.2, Half * 1.2, 3000.0);
+        double TotalSeconds = 0.0, MaxSeconds = 0.0;
+        int64 TotalTriangles = 0, MinTriangles = MAX_int64, MaxTriangles = 0, TotalSwitched = 0;
+        for (int32 Frame = 0; Frame < FrameCount; ++Frame) {
+            const FVector ViewOrigin = FMath::Lerp(Start, End, static_cast<double>(Frame) / (FrameCount - 1));
+            TotalSwitched += Actor->UpdateRuntimeLod(ViewOrigin, FOVDegrees);
+
+            const auto& Stats = Actor->GetRuntimeLodStats();
+            TotalSeconds += Stats.UpdateSeconds;
+            MaxSeconds = FMath::Max(MaxSeconds, Stats.UpdateSeconds);
+            TotalTriangles += Stats.VisibleTriangles;
+            MinTriangles = FMath::Min(MinTriangles, Stats.VisibleTriangles);
+            MaxTriangles = FMath::Max(MaxTriangles, Stats.VisibleTriangles);
+        }
+
+        AddInfo(FString::Printf(TEXT("Max LOD only: %lld triangles"), MaxLodTriangles));
+        AddInfo(FString::Printf(TEXT("Runtime LOD: %d frames, triangles avg %lld (min %lld, max %lld), update avg %.3f ms (max %.3f ms, budget %.3f ms), %lld switches"),
+            FrameCount, TotalTriangles / FrameCount, MinTriangles, MaxTriangles, TotalSeconds * 1000.0 / FrameCount, MaxSeconds * 1000.0,
+            Actor->RuntimeLodSettings.TimeBudgetMs, TotalSwitched));
+
+        // 区画の中心で時間予算を外して全地物を評価し、集計と表示状態が一致すること
+        Actor->RuntimeLodSettings.TimeBudgetMs = 1000.0f;
+        Actor->UpdateRuntimeLod(FVector(0.0, 0.0, 3000.0), FOVDegrees);
+        const auto& Stats = Actor->GetRuntimeLodStats();
+        AddInfo(Stats.ToString());
+
+        const int32 InvalidFeatures = CountInvalidFeatures(*Actor);
+        if (InvalidFeatures != 0 || Stats.Features != FeatureCount || Stats.VisibleTriangles != CountVisibleTriangles(*Actor)) {
+            FinishTest(false, FString::Printf(TEXT("Unexpected LOD state: %d invalid features"), InvalidFeatures));
+            return true;
+        }
+        if (Stats.FeaturesPerLod[1] == 0 || Stats.FeaturesPerLod[3] == 0 || TotalTriangles / FrameCount >= MaxLodTriangles) {
+            FinishTest(false, "Runtime LOD did not reduce triangles");
+            return true;
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
@@ -0,0 +1,114 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUMeshLoader.h"
+#include "PLATEAUCityModelCellProxy.h"
+#include "PLATEAUSpatialCellBuilder.h"
+#include "Component/PLATEAUSceneComponent.h"
+#include "Tests/AutomationCommon.h"
+#include <plateau/dataset/grid_code.h>
+#include <plateau/polygon_mesh/model.h>
+#include <plateau/polygon_mesh/mesh.h>
+
+namespace FPLATEAUTest_Benchmark_SpatialCell_Local {
+    const FString GridCode = TEXT("53392642");
+    constexpr int32 FeaturesPerRow = 20;
+    constexpr int32 FeatureCount = FeaturesPerRow * FeaturesPerRow;
+    constexpr int32 Subdivision = 2;
+
+    APLATEAUInstancedCityModel* CreateCityModel(UWorld& World) {
+        const auto Actor = PLATEAUAutomationTestUtil::BuildingFixtures::CreateCityModel(World, { FString::Printf(TEXT("%s_bldg_6697_op"), *GridCode) });
+
+        // メッシュコードの区画の中心を基準点とする
+        const auto Extent = plateau::dataset::GridCode::create(TCHAR_TO_UTF8(*GridCode))->getExtent();
+        const auto Min = Actor->GeoReference.GetData().project(Extent.min);
+        const auto Max = Actor->GeoReference.GetData().project(Extent.max);
+        Actor->GeoReference.ReferencePoint = FVector((Min.x + Max.x) * 0.5, (Min.y + Max.y) * 0.5, 0.0);
+        return Actor;
+    }
+}
+
+/// <summary>
+/// セル分割・プロキシ生成の計測
+/// メッシュコードの区画内に並べたLOD1・LOD2の建物について、セル分割・プロキシ生成の時間、セル毎のコンポーネント数・三角形数・常駐するメモリ量を出力し、
+/// 全ての地物がいずれかのセルに割り当てられ、各セルのプロキシがLOD1のメッシュから作成されていることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Benchmark_SpatialCell, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Benchmark.SpatialCell",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Benchmark_SpatialCell::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_Benchmark_SpatialCell_Local;
+    InitializeTest("Benchmark.SpatialCell");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Actor = CreateCityModel(*GetWorld());
+    const auto LoadFuture = MakeShared<TFuture<void>>(Async(EAsyncExecution::Thread, [Actor, GmlComponent = Actor->GetRootComponent()->GetAttachChildren()[0].Get()] {
+        FLoadInputData LoadInputData;
+        LoadInputData.GmlPath = FString::Printf(TEXT("%s_bldg_6697_op.gml"), *GridCode);
+        LoadInputData.bIncludeAttrInfo = false;
+        LoadInputData.FallbackMaterial = nullptr;
+
+        FPLATEAUMeshLoader MeshLoader(true);
+        TAtomic<bool> bCanceled(false);
+        // メッシュコードの区画の中心を原点として、区画内に建物を並べる
+        const auto Model = PLATEAUAutomationTestUtil::BuildingFixtures::CreateModel(1, 2, FeatureCount, FeaturesPerRow, 4000.0, TVec3d(-38000.0, -38000.0, 0.0));
+        MeshLoader.LoadModel(Actor, GmlComponent, Model, LoadInputData, nullptr, &bCanceled);
+    }));
+    const auto BuildTask = MakeShared<UE::Tasks::TTask<FPLATEAUSpatialCellStats>>();
+    const auto StartSeconds = MakeShared<double>(0.0);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Actor, LoadFuture, BuildTask, StartSeconds] {
+        if (!LoadFuture->IsReady())
+            return false;
+        if (!BuildTask->IsValid()) {
+            FPLATEAUSpatialCellSettings Settings;
+            Settings.Subdivision = Subdivision;
+            *StartSeconds = FPlatformTime::Seconds();
+            *BuildTask = Actor->BuildSpatialCells(Settings);
+        }
+        if (!BuildTask->IsCompleted())
+            return false;
+
+        const double Seconds = FPlatformTime::Seconds() - *StartSeconds;
+        const auto& Stats = BuildTask->GetResult();
+        AddInfo(FString::Printf(TEXT("Build: %.3f s, %s"), Seconds, *Stats.ToString()));
+
+        const auto& Cells = Actor->GetSpatialCells();
+        int32 AssignedFeatures = 0;
+        for (const auto& Cell : Cells) {
+            AddInfo(FString::Printf(TEXT("%s: %d features, %d components, triangles %lld -> %lld, resident memory %.1f KB + proxy %.1f KB"),
+                *Cell.CellCode, Cell.Features.Num(), Cell.SourceComponents, Cell.SourceTriangles, Cell.ProxyTriangles,
+                Cell.SourceBytes / 1024.0, Cell.ProxyBytes / 1024.0));
+            AssignedFeatures += Cell.Features.Num();
+
+            // プロキシはセル内のLOD1(1地物あたり12三角形)のみから作成される
+            if (!IsValid(Cell.Proxy) || Cell.ProxyTriangles != Cell.Features.Num() / 2 * 12) {
+                FinishTest(false, FString::Printf(TEXT("Unexpected proxy: %s"), *Cell.CellCode));
+                return true;
+            }
+        }
+
+        if (Cells.Num() != Subdivision * Subdivision || AssignedFeatures != FeatureCount * 2 ||
+            Stats.ProxyComponents != Cells.Num() || Stats.ProxyTriangles >= Stats.SourceTriangles) {
+            FinishTest(false, FString::Printf(TEXT("Unexpected cells: %d cells, %d features"), Cells.Num(), AssignedFeatures));
+            return true;
+        }
+
+        // 破棄でプロキシが削除されること
+        const TWeakObjectPtr<APLATEAUCityModelCellProxy> Proxy = Cells[0].Proxy.Get();
+        Actor->ClearSpatialCells();
+        if (Actor->GetSpatialCells().Num() != 0 || (Proxy.IsValid() && !Proxy->IsActorBeingDestroyed())) {
+            FinishTest(false, "Failed to clear spatial cells");
+            return true;
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
@@ -7,6 +7,7 @@
 #include <PLATEAURuntime.h>
 #include "CityGML/Serialization/PLATEAUCityObjectSerialization.h"
 #include "CityGML/Serialization//PLATEAUCityObjectDeserialization.h"
+#include "CityGML/Serialization/PLATEAUCityObjectBinary.h"
 
 
 namespace FPLATEAUTest_CityObjectGroup_Serialize_Local {
@@ -46,7 +47,7 @@ bool FPLATEAUTest_CityObjectGroup_Serialize::RunTest(const FString& Parameters)
     // Simple Serialize    
     TArray<FString> Children;
     FPLATEAUCityObjectSerialization Serializer;
-    FString Serialized = Serializer.SerializeCityObject(CityObject, OutsideParent, Children);
+    FString Serialized = FPLATEAUCityObjectBinary(Serializer.SerializeCityObject(CityObject, OutsideParent, Children)).ToJson();
 
     // Assertions Serialize
     FString SerializedFormatted = Serialized.Replace(TEXT("\n"), TEXT("")).Replace(TEXT("\r"), TEXT("")).Replace(TEXT("\t"), TEXT("")).Replace(TEXT(" "), TEXT("")); //改行、Tab, スペース
@@ -104,7 +104,8 @@ protected:
         return FEditorFileUtils::LoadMap(Map, false, true);
     }
     
-    APLATEAUCityModelLoader* GetInstancedCityLoader(const UWorld& World) {
+    // SourcePathが空の場合は同梱テストデータをインポートする
+    APLATEAUCityModelLoader* GetInstancedCityLoader(const UWorld& World, const FString& SourcePath = FString()) {
         TArray<AActor*> FoundActors;
         UGameplayStatics::GetAllActorsOfClass(&World, APLATEAUInstancedCityModel::StaticClass(), FoundActors);
         if (0 < FoundActors.Num()) {
@@ -113,12 +114,11 @@ protected:
             constexpr int ZoneId = 9;
             const FVector ReferencePoint = FVector(-472281.96875, 5131018, 0);
             constexpr int64 PackageMask = static_cast<int64>(plateau::dataset::PredefinedCityModelPackage::Building);
-            const FString SourcePath = GetTestDataPath();
             const auto defaultMat = UPLATEAUImportAreaSelectBtn::GetDefaultFallbackMaterial(static_cast<int64>(plateau::dataset::PredefinedCityModelPackage::Building));
             const FPackageInfoSettings PackageInfoSettings(true, true, true, true, EPLATEAUTexturePackingResolution::H4096W4096, 0, 4, 1, defaultMat, false, "", 7);
             TMap<int64, FPackageInfoSettings> PackageInfoSettingsData;
             PackageInfoSettingsData.Add(static_cast<int64>(plateau::dataset::PredefinedCityModelPackage::Building), PackageInfoSettings);
-            const auto& Loader = GetLocalCityModelLoader(ZoneId, ReferencePoint, PackageMask, SourcePath, PackageInfoSettingsData);
+            const auto& Loader = GetLocalCityModelLoader(ZoneId, ReferencePoint, PackageMask, SourcePath.IsEmpty() ? GetTestDataPath() : SourcePath, PackageInfoSettingsData);
             if (Loader) {
                 return Loader;
             }
@@ -11,6 +11,8 @@
 #include <CityGML/PLATEAUCityGmlProxy.h>
 #include "Misc/Paths.h"
 #include "HAL/PlatformFilemanager.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "RoadNetwork/CityObject/SubDividedCityObject.h"
 
 //ダイナミック生成等のテスト用共通処理
 namespace PLATEAUAutomationTestUtil {
@@ -445,6 +447,101 @@ namespace PLATEAUAutomationTestUtil {
         }
     }
 
+    //ベンチマーク用　直方体を並べた建物のモデル生成
+    namespace BuildingFixtures {
+
+        /// <summary>
+        /// Minを原点とする大きさSizeの直方体の頂点とインデックスを追加
+        /// </summary>
+        inline void AddBox(std::vector<TVec3d>& Vertices, std::vector<unsigned>& Indices, const TVec3d& Min, const TVec3d& Size) {
+            const unsigned Base = static_cast<unsigned>(Vertices.size());
+            for (int32 i = 0; i < 8; ++i) {
+                Vertices.emplace_back(Min.x + (i & 1 ? Size.x : 0.0), Min.y + (i & 2 ? Size.y : 0.0), Min.z + (i & 4 ? Size.z : 0.0));
+            }
+            for (const unsigned Index : { 0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 }) {
+                Indices.push_back(Base + Index);
+            }
+        }
+
+        /// <summary>
+        /// 頂点とインデックスから1つのSubMeshを持つMesh生成
+        /// </summary>
+        inline std::unique_ptr<plateau::polygonMesh::Mesh> CreateMesh(const std::vector<TVec3d>& Vertices, const std::vector<unsigned>& Indices) {
+            const std::vector<TVec2f> UV1(Vertices.size(), TVec2f(0.f, 0.f));
+            const std::vector<TVec2f> UV4(Vertices.size(), TVec2f(0.f, 0.f));
+            auto Mesh = std::make_unique<plateau::polygonMesh::Mesh>();
+            Mesh->addVerticesList(Vertices);
+            Mesh->addIndicesList(Indices, 0, false);
+            Mesh->addSubMesh("", nullptr, 0, Indices.size() - 1, 0);
+            Mesh->addUV1(UV1, Vertices.size());
+            Mesh->addUV4(UV4, Vertices.size());
+            return Mesh;
+        }
+
+        /// <summary>
+        /// 直方体1つのMesh生成
+        /// </summary>
+        inline std::unique_ptr<plateau::polygonMesh::Mesh> CreateBoxMesh(const TVec3d& Offset, const TVec3d& Size) {
+            std::vector<TVec3d> Vertices;
+            std::vector<unsigned> Indices;
+            AddBox(Vertices, Indices, Offset, Size);
+            return CreateMesh(Vertices, Indices);
+        }
+
+        /// <summary>
+        /// Lodが高いほど三角形数の多い建物のMesh生成(LOD1: 直方体, LOD2: 屋根付き, LOD3: 屋根と外壁の付属物付き)
+        /// </summary>
+        inline std::unique_ptr<plateau::polygonMesh::Mesh> CreateBuildingMesh(const int32 Lod, const TVec3d& Offset) {
+            std::vector<TVec3d> Vertices;
+            std::vector<unsigned> Indices;
+            AddBox(Vertices, Indices, Offset, TVec3d(1000.0, 1000.0, 1500.0));
+            if (Lod >= 2)
+                AddBox(Vertices, Indices, TVec3d(Offset.x + 250.0, Offset.y + 250.0, Offset.z + 1500.0), TVec3d(500.0, 500.0, 300.0));
+            if (Lod >= 3) {
+                for (int32 Floor = 0; Floor < 10; ++Floor) {
+                    AddBox(Vertices, Indices, TVec3d(Offset.x - 50.0, Offset.y + 100.0, Offset.z + Floor * 150.0), TVec3d(50.0, 800.0, 20.0));
+                }
+            }
+            return CreateMesh(Vertices, Indices);
+        }
+
+        /// <summary>
+        /// MinLod~MaxLodのLodNode毎に、Originから格子状に建物を並べたModel生成
+        /// </summary>
+        inline std::shared_ptr<plateau::polygonMesh::Model> CreateModel(const int32 MinLod, const int32 MaxLod, const int32 FeatureCount,
+            const int32 FeaturesPerRow, const double Spacing, const TVec3d& Origin = TVec3d(0.0, 0.0, 0.0)) {
+            auto Model = std::make_shared<plateau::polygonMesh::Model>();
+            for (int32 Lod = MinLod; Lod <= MaxLod; ++Lod) {
+                auto& LodNode = Model->addEmptyNode(TCHAR_TO_UTF8(*FString::Printf(TEXT("LOD%d"), Lod)));
+                for (int32 i = 0; i < FeatureCount; ++i) {
+                    const TVec3d Offset(Origin.x + (i % FeaturesPerRow) * Spacing, Origin.y + (i / FeaturesPerRow) * Spacing, Origin.z);
+                    LodNode.addChildNode(plateau::polygonMesh::Node(TCHAR_TO_UTF8(*FString::Printf(TEXT("bldg_%06d"), i)), CreateBuildingMesh(Lod, Offset)));
+                }
+            }
+            Model->assignNodeHierarchy();
+            return Model;
+        }
+
+        /// <summary>
+        /// GmlNames毎のGMLのComponentを持つActor生成
+        /// </summary>
+        inline APLATEAUInstancedCityModel* CreateCityModel(UWorld& World, const TArray<FString>& GmlNames) {
+            const auto Actor = World.SpawnActor<APLATEAUInstancedCityModel>();
+            const auto SceneRoot = NewObject<UPLATEAUSceneComponent>(Actor, USceneComponent::GetDefaultSceneRootVariableName());
+            Actor->AddInstanceComponent(SceneRoot);
+            Actor->SetRootComponent(SceneRoot);
+            SceneRoot->RegisterComponent();
+
+            for (const auto& GmlName : GmlNames) {
+                const auto GmlComponent = NewObject<UPLATEAUSceneComponent>(Actor, FName(GmlName));
+                Actor->AddInstanceComponent(GmlComponent);
+                GmlComponent->RegisterComponent();
+                GmlComponent->AttachToComponent(SceneRoot, FAttachmentTransformRules::KeepRelativeTransform);
+            }
+            return Actor;
+        }
+    }
+
     //Landscape/Heightmap用　ダイナミック生成等のテスト用共通処理
     namespace LandscapeFixtures {
 
@@ -614,4 +711,46 @@ namespace PLATEAUAutomationTestUtil {
         }
     }
 
+    //道路ネットワーク用　テスト用の道路の地物の生成
+    namespace RoadNetwork {
+
+        // 交差点の間隔と道路の幅
+        constexpr double Pitch = 5000.0;
+        constexpr double Width = 1000.0;
+
+        /// <summary>
+        /// Min-Maxの四角形のメッシュを持つ道路の地物を追加
+        /// </summary>
+        inline void AddQuad(TArray<FSubDividedCityObject>& CityObjects, UObject& Outer, const FString& Name, const FVector2D& Min, const FVector2D& Max) {
+            auto& CityObject = CityObjects.AddDefaulted_GetRef();
+            CityObject.Name = Name;
+            CityObject.SelfRoadType = ERRoadTypeMask::Road;
+            const auto CityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Outer, FName(Name));
+            CityObjectGroup->MinLOD = 1;
+            CityObject.CityObjectGroup = CityObjectGroup;
+
+            auto& Mesh = CityObject.Meshes.AddDefaulted_GetRef();
+            Mesh.Vertices = { FVector(Min.X, Min.Y, 0.0), FVector(Max.X, Min.Y, 0.0), FVector(Max.X, Max.Y, 0.0), FVector(Min.X, Max.Y, 0.0) };
+            Mesh.SubMeshes.AddDefaulted_GetRef().Triangles = { 0, 1, 2, 0, 2, 3 };
+        }
+
+        /// <summary>
+        /// N x Nの交差点と, 隣り合う交差点の間の道路を地物とした碁盤目状の道路を作成
+        /// </summary>
+        inline TArray<FSubDividedCityObject> CreateGridCityObjects(UObject& Outer, const int32 N) {
+            TArray<FSubDividedCityObject> CityObjects;
+            for (int32 Y = 0; Y < N; ++Y) {
+                for (int32 X = 0; X < N; ++X) {
+                    const FVector2D Origin(X * Pitch, Y * Pitch);
+                    AddQuad(CityObjects, Outer, FString::Printf(TEXT("tran_i_%d_%d"), X, Y), Origin, Origin + FVector2D(Width, Width));
+                    if (X + 1 < N)
+                        AddQuad(CityObjects, Outer, FString::Printf(TEXT("tran_x_%d_%d"), X, Y), Origin + FVector2D(Width, 0.0), Origin + FVector2D(Pitch, Width));
+                    if (Y + 1 < N)
+                        AddQuad(CityObjects, Outer, FString::Printf(TEXT("tran_y_%d_%d"), X, Y), Origin + FVector2D(0.0, Width), Origin + FVector2D(Width, Pitch));
+                }
+            }
+            return CityObjects;
+        }
+    }
+
 };
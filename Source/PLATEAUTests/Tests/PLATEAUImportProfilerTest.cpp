@@ -0,0 +1,83 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUImportProfiler.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+/// <summary>
+/// インポートのプロファイラがGML毎・パッケージ毎に集計し、Chromeトレース形式で出力できることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_ImportProfiler, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.ImportProfiler",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_ImportProfiler::RunTest(const FString& Parameters) {
+    InitializeTest("ImportProfiler");
+
+    const FString BldgGml = TEXT("53392642_bldg_6697_op2.gml");
+    const FString TranGml = TEXT("53392642_tran_6697_op.gml");
+    FPLATEAUImportProfiler Profiler;
+    Profiler.RegisterGml(BldgGml, TEXT("bldg"));
+    Profiler.RegisterGml(TranGml, TEXT("tran"));
+
+    // 複数スレッドから記録
+    ParallelFor(8, [&](const int32 Index) {
+        const auto& GmlName = Index % 2 == 0 ? BldgGml : TranGml;
+        {
+            FPLATEAUImportProfiler::FScope Scope(&Profiler, EPLATEAUImportStage::ParseGml, GmlName);
+            FPlatformProcess::Sleep(0.002f);
+        }
+        Profiler.AddCounter(GmlName, EPLATEAUImportCounter::Triangles, 100);
+        Profiler.AddCounter(FString(), EPLATEAUImportCounter::Textures, 1);
+        });
+    Profiler.AddEvent(EPLATEAUImportStage::DecodeTexture, FString(), FPlatformTime::Seconds(), FPlatformTime::Seconds() + 0.5);
+
+    // Profilerがnullptrの場合は何もしない
+    {
+        FPLATEAUImportProfiler::FScope Scope(nullptr, EPLATEAUImportStage::Import, BldgGml);
+    }
+
+    if (Profiler.GetCounter(EPLATEAUImportCounter::Triangles, BldgGml) != 400 ||
+        Profiler.GetCounter(EPLATEAUImportCounter::Triangles) != 800 ||
+        Profiler.GetCounter(EPLATEAUImportCounter::Textures) != 8) {
+        FinishTest(false, "Counters are not aggregated per GML");
+        return true;
+    }
+
+    if (Profiler.GetStageSeconds(EPLATEAUImportStage::ParseGml, BldgGml) <= 0.0 ||
+        !FMath::IsNearlyEqual(Profiler.GetStageSeconds(EPLATEAUImportStage::DecodeTexture), 0.5, 0.001) ||
+        Profiler.GetStageSeconds(EPLATEAUImportStage::Import) != 0.0) {
+        FinishTest(false, "Stage times are not aggregated");
+        return true;
+    }
+
+    const auto Summary = Profiler.GetSummaryTable();
+    AddInfo(Summary);
+    if (!Summary.Contains(TEXT("[bldg] (1)")) || !Summary.Contains(TEXT("[tran] (1)")) || !Summary.Contains(TEXT("[(shared)] (1)"))) {
+        FinishTest(false, "Summary table does not contain package rows");
+        return true;
+    }
+
+    // ParseGml x8, DecodeTexture x1の完了イベントと、GML毎の処理量イベント
+    TSharedPtr<FJsonObject> Trace;
+    if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Profiler.GetChromeTrace()), Trace) || !Trace.IsValid()) {
+        FinishTest(false, "Chrome trace is not valid JSON");
+        return true;
+    }
+    const auto& TraceEvents = Trace->GetArrayField(TEXT("traceEvents"));
+    int32 CompleteEventCount = 0;
+    for (const auto& TraceEvent : TraceEvents) {
+        if (TraceEvent->AsObject()->GetStringField(TEXT("ph")) == TEXT("X"))
+            ++CompleteEventCount;
+    }
+    if (CompleteEventCount != 9 || TraceEvents.Num() != 9 + 3) {
+        FinishTest(false, FString::Printf(TEXT("Unexpected trace events: %d"), TraceEvents.Num()));
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,130 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUImportScheduler.h"
+#include "citygml/citygml.h"
+#include "plateau/polygon_mesh/mesh_extractor.h"
+#include <plateau/polygon_mesh/model.h>
+
+namespace {
+    constexpr int32 SyntheticGmlCount = 12;
+    constexpr int32 NumWorkers = 4;
+}
+
+/// <summary>
+/// 同梱テストデータを複製したGMLをスケジューラでパース・メッシュ抽出し、
+/// 同時実行数がワーカー数以下、見積もりメモリ量がメモリ予算以下であることを確認します。
+/// インポート時間とメモリ使用量のピークを出力します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_ImportScheduler, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.ImportScheduler",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_ImportScheduler::RunTest(const FString& Parameters) {
+    InitializeTest("ImportScheduler");
+
+    const FString SourceGmlPath = FPLATEAURuntimeModule::GetContentDir().Append("/TestData/data/udx/bldg/53392642_bldg_6697_op2.gml");
+    const FString WorkDirectory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("PLATEAUImportScheduler"));
+    IFileManager::Get().DeleteDirectory(*WorkDirectory, false, true);
+
+    TArray<FString> GmlPaths;
+    for (int32 i = 0; i < SyntheticGmlCount; ++i) {
+        const auto GmlPath = FPaths::Combine(WorkDirectory, FString::Printf(TEXT("53392642_bldg_6697_%02d_op2.gml"), i));
+        if (IFileManager::Get().Copy(*GmlPath, *SourceGmlPath) != COPY_OK) {
+            FinishTest(false, "Failed to copy GML");
+            return true;
+        }
+        GmlPaths.Add(GmlPath);
+    }
+
+    // 2つのGMLが同時に収まる程度のメモリ予算
+    const int64 EstimatedBytes = FPLATEAUMemoryBudget::EstimateGmlBytes(GmlPaths[0]);
+    const int64 BudgetBytes = EstimatedBytes * 2 + EstimatedBytes / 2;
+    const auto MemoryBudget = MakeShared<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>(BudgetBytes);
+    FPLATEAUImportScheduler Scheduler(NumWorkers, MemoryBudget);
+
+    plateau::polygonMesh::MeshExtractOptions ExtractOptions;
+    ExtractOptions.mesh_granularity = plateau::polygonMesh::MeshGranularity::PerPrimaryFeatureObject;
+    ExtractOptions.mesh_axes = plateau::geometry::CoordinateSystem::ESU;
+    ExtractOptions.coordinate_zone_id = 9;
+    ExtractOptions.attach_map_tile = false;
+
+    TAtomic<int32> RunningCount(0);
+    TAtomic<int32> PeakRunningCount(0);
+    TAtomic<int32> ExtractedCount(0);
+    for (const auto& GmlPath : GmlPaths) {
+        Scheduler.Enqueue(FPLATEAUMemoryBudget::EstimateGmlBytes(GmlPath),
+            [GmlPath, ExtractOptions, &RunningCount, &PeakRunningCount, &ExtractedCount](const FPLATEAUImportScheduler::FReservationPtr& Reservation) {
+                const int32 CurrentRunningCount = ++RunningCount;
+                int32 Observed = PeakRunningCount.Load();
+                while (CurrentRunningCount > Observed && !PeakRunningCount.CompareExchange(Observed, CurrentRunningCount)) {
+                }
+
+                citygml::ParserParams ParserParams;
+                ParserParams.tesselate = true;
+                const auto CityModel = citygml::load(TCHAR_TO_UTF8(*GmlPath), ParserParams);
+                if (CityModel != nullptr) {
+                    const auto Model = plateau::polygonMesh::MeshExtractor::extract(*CityModel, ExtractOptions);
+                    Reservation->Shrink(FPLATEAUMemoryBudget::EstimateModelBytes(*Model));
+                    ++ExtractedCount;
+                }
+                --RunningCount;
+            });
+    }
+
+    const uint64 StartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+    uint64 PeakUsedPhysical = StartUsedPhysical;
+    Scheduler.Run(nullptr, [&PeakUsedPhysical](const TArray<int32>&, const int32) {
+        PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+    });
+
+    AddInfo(Scheduler.GetStatsString());
+    AddInfo(FString::Printf(TEXT("Used physical memory: +%.2f MB at peak"),
+        (PeakUsedPhysical - StartUsedPhysical) / (1024.0 * 1024.0)));
+    IFileManager::Get().DeleteDirectory(*WorkDirectory, false, true);
+
+    if (ExtractedCount.Load() != SyntheticGmlCount) {
+        FinishTest(false, FString::Printf(TEXT("Extracted: %d/%d"), ExtractedCount.Load(), SyntheticGmlCount));
+        return true;
+    }
+
+    if (PeakRunningCount.Load() > NumWorkers || Scheduler.GetPeakRunningJobs() > NumWorkers) {
+        FinishTest(false, FString::Printf(TEXT("Running jobs exceed workers: %d"), PeakRunningCount.Load()));
+        return true;
+    }
+
+    if (Scheduler.GetPeakBytes() > BudgetBytes) {
+        FinishTest(false, FString::Printf(TEXT("In-flight memory exceeds budget: %lld > %lld"), Scheduler.GetPeakBytes(), BudgetBytes));
+        return true;
+    }
+
+    // キャンセルすると開始前のジョブは実行されずに即座に破棄されること
+    FPLATEAUImportScheduler CancelScheduler(1);
+    TAtomic<int32> ExecutedCount(0);
+    TAtomic<int32> CanceledCount(0);
+    for (int32 i = 0; i < SyntheticGmlCount; ++i) {
+        CancelScheduler.Enqueue(0,
+            [&CancelScheduler, &ExecutedCount](const FPLATEAUImportScheduler::FReservationPtr&) {
+                ++ExecutedCount;
+                CancelScheduler.Cancel();
+                FPlatformProcess::Sleep(0.1f);
+            },
+            [&CanceledCount] {
+                ++CanceledCount;
+            });
+    }
+    // キャンセルされたジョブも完了数に含まれ、進捗が全ジョブ数に達すること
+    int32 LastCompletedCount = 0;
+    CancelScheduler.Run(nullptr, [&LastCompletedCount](const TArray<int32>&, const int32 CompletedCount) {
+        LastCompletedCount = CompletedCount;
+    });
+
+    if (ExecutedCount.Load() != 1 || CanceledCount.Load() != SyntheticGmlCount - 1 || LastCompletedCount != SyntheticGmlCount) {
+        FinishTest(false, FString::Printf(TEXT("Cancel: executed %d, canceled %d, completed %d"),
+            ExecutedCount.Load(), CanceledCount.Load(), LastCompletedCount));
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
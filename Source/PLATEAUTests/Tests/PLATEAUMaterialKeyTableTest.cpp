@@ -0,0 +1,52 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUMeshLoader.h"
+#include "PLATEAUMaterialKeyTable.h"
+
+/// <summary>
+/// FSubMeshMaterialSetのハッシュ・比較がテクスチャパスの文字列バッファに依存せず、重複排除されることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_MaterialKeyTable, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.MaterialKeyTable",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_MaterialKeyTable::RunTest(const FString& Parameters) {
+    InitializeTest("MaterialKeyTable");
+
+    FPLATEAUMaterialKeyTable KeyTable;
+    // 同じ内容で別々に確保された文字列
+    const FString TexturePathA = FString(TEXT("appearance/texture_")) + TEXT("0001.jpg");
+    const FString TexturePathB = FString::Printf(TEXT("appearance/texture_%04d.jpg"), 1);
+    const FString OtherTexturePath = TEXT("appearance/texture_0002.jpg");
+
+    const FSubMeshMaterialSet SetA(nullptr, TexturePathA, 0, KeyTable);
+    const FSubMeshMaterialSet SetB(nullptr, TexturePathB, 0, KeyTable);
+    const FSubMeshMaterialSet SetOther(nullptr, OtherTexturePath, 0, KeyTable);
+
+    if (GetTypeHash(SetA) != GetTypeHash(SetB) || !(SetA == SetB)) {
+        FinishTest(false, "Equal material sets have different keys");
+        return true;
+    }
+
+    if (SetA == SetOther) {
+        FinishTest(false, "Different texture paths have the same key");
+        return true;
+    }
+
+    TMap<FSubMeshMaterialSet, int32> CachedMaterials;
+    CachedMaterials.Add(SetA, 0);
+    if (CachedMaterials.Find(SetB) == nullptr) {
+        FinishTest(false, "CachedMaterials does not dedup equal material sets");
+        return true;
+    }
+
+    if (KeyTable.GetTexturePathCount() != 2) {
+        FinishTest(false, FString::Printf(TEXT("TexturePathCount: %d"), KeyTable.GetTexturePathCount()));
+        return true;
+    }
+
+    AddInfo(KeyTable.GetStatsString());
+    FinishTest(true, "");
+    return true;
+}
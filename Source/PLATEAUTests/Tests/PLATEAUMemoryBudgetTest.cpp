@@ -0,0 +1,228 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUMemoryBudget.h"
+#include "Async/Async.h"
+#include "Components/StaticMeshComponent.h"
+#include "Tests/AutomationCommon.h"
+
+namespace FPLATEAUTest_MemoryBudget_Local {
+    constexpr int64 MB = 1024 * 1024;
+    constexpr int32 SyntheticGmlCount = 8;
+    constexpr int32 NumWorkers = 4;
+    // プロセスのメモリ使用量の計測間隔
+    constexpr float SampleIntervalSeconds = 0.002f;
+
+    int64 GetUsedPhysicalMemory() {
+        return static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+    }
+
+    /// <summary>
+    /// インポート中のプロセスのメモリ使用量をバックグラウンドで計測し、最大値を記録します。
+    /// </summary>
+    struct FMemorySampler {
+        TAtomic<bool> bStop{ false };
+        TAtomic<int64> PeakUsedPhysical{ 0 };
+        TFuture<void> Future;
+
+        void Start() {
+            PeakUsedPhysical = GetUsedPhysicalMemory();
+            Future = Async(EAsyncExecution::Thread, [this] {
+                while (!bStop.Load()) {
+                    const int64 UsedPhysical = GetUsedPhysicalMemory();
+                    if (UsedPhysical > PeakUsedPhysical.Load())
+                        PeakUsedPhysical = UsedPhysical;
+                    FPlatformProcess::Sleep(SampleIntervalSeconds);
+                }
+            });
+        }
+
+        void Stop() {
+            bStop = true;
+            Future.Wait();
+        }
+    };
+
+    /// <summary>
+    /// 同梱の建物GMLを複製したデータセットを作成します。
+    /// </summary>
+    bool CreateSyntheticDataset(const FString& SourceDirectory, const FString& DatasetDirectory) {
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        const FString SourceBldgDirectory = FPaths::Combine(SourceDirectory, TEXT("udx/bldg"));
+        const FString BldgDirectory = FPaths::Combine(DatasetDirectory, TEXT("udx/bldg"));
+        if (!PlatformFile.CreateDirectoryTree(*BldgDirectory)
+            || !PlatformFile.CopyDirectoryTree(*FPaths::Combine(DatasetDirectory, TEXT("codelists")), *FPaths::Combine(SourceDirectory, TEXT("codelists")), true)
+            || !PlatformFile.CopyDirectoryTree(*FPaths::Combine(BldgDirectory, TEXT("53392642_bldg_6697_appearance")),
+                *FPaths::Combine(SourceBldgDirectory, TEXT("53392642_bldg_6697_appearance")), true))
+            return false;
+
+        const FString SourceGmlPath = FPaths::Combine(SourceBldgDirectory, TEXT("53392642_bldg_6697_op2.gml"));
+        for (int32 i = 0; i < SyntheticGmlCount; ++i) {
+            const auto GmlPath = FPaths::Combine(BldgDirectory, FString::Printf(TEXT("53392642_bldg_6697_%02d_op2.gml"), i));
+            if (IFileManager::Get().Copy(*GmlPath, *SourceGmlPath) != COPY_OK)
+                return false;
+        }
+        return true;
+    }
+}
+
+/// <summary>
+/// 複数のGMLを模したタスクが同時にメモリを確保しても予算内で実行され、
+/// 予算を超える要求は切り詰められずに単独で確保・記録されることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_MemoryBudget, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.MemoryBudget",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_MemoryBudget::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_MemoryBudget_Local;
+    InitializeTest("MemoryBudget");
+
+    constexpr int64 BudgetBytes = 100 * MB;
+    const auto MemoryBudget = MakeShared<FPLATEAUMemoryBudget, ESPMode::ThreadSafe>(BudgetBytes);
+
+    // 予算を超えるものを含むサイズのGML
+    const TArray<int64> RequestedBytes = { 10 * MB, 60 * MB, 30 * MB, 45 * MB, 200 * MB, 25 * MB, 80 * MB, 5 * MB,
+        55 * MB, 15 * MB, 40 * MB, 70 * MB, 20 * MB, 35 * MB, 50 * MB, 65 * MB };
+    TAtomic<int32> CompletedCount(0);
+    TAtomic<int32> ViolationCount(0);
+    TArray<TFuture<void>> Futures;
+    for (const auto Bytes : RequestedBytes) {
+        Futures.Add(Async(EAsyncExecution::Thread, [MemoryBudget, Bytes, BudgetBytes, &CompletedCount, &ViolationCount] {
+            const auto Reservation = MemoryBudget->Acquire(Bytes);
+            if (!Reservation.IsValid())
+                return;
+
+            // パース中: 予算内の要求は他と合わせて予算以下、予算を超える要求は要求量をそのまま単独で確保している
+            const int64 UsedBytes = MemoryBudget->GetUsedBytes();
+            const bool bValid = Bytes > BudgetBytes
+                ? Reservation->GetBytes() == Bytes && UsedBytes == Bytes
+                : UsedBytes <= BudgetBytes;
+            if (!bValid)
+                ++ViolationCount;
+            FPlatformProcess::Sleep(0.005f);
+
+            // CityModel解放後はメッシュ分のみ保持
+            Reservation->Shrink(Reservation->GetBytes() / 4);
+            FPlatformProcess::Sleep(0.005f);
+            ++CompletedCount;
+        }));
+    }
+    for (auto& Future : Futures) {
+        Future.Wait();
+    }
+
+    if (CompletedCount.Load() != RequestedBytes.Num()) {
+        FinishTest(false, FString::Printf(TEXT("Completed: %d/%d"), CompletedCount.Load(), RequestedBytes.Num()));
+        return true;
+    }
+
+    if (ViolationCount.Load() > 0) {
+        FinishTest(false, FString::Printf(TEXT("Reserved memory exceeds budget: %d times"), ViolationCount.Load()));
+        return true;
+    }
+
+    if (MemoryBudget->GetOversizedCount() != 1 || MemoryBudget->GetPeakBytes() != 200 * MB) {
+        FinishTest(false, FString::Printf(TEXT("Oversized request is not accounted: %d, peak %lld"), MemoryBudget->GetOversizedCount(), MemoryBudget->GetPeakBytes()));
+        return true;
+    }
+
+    if (MemoryBudget->GetUsedBytes() != 0) {
+        FinishTest(false, FString::Printf(TEXT("Memory is not released: %lld"), MemoryBudget->GetUsedBytes()));
+        return true;
+    }
+
+    // キャンセル時は確保せずに戻る
+    const auto Reservation = MemoryBudget->Acquire(BudgetBytes);
+    TAtomic<bool> bCanceled(true);
+    if (MemoryBudget->Acquire(MB, &bCanceled).IsValid()) {
+        FinishTest(false, "Acquired after cancel");
+        return true;
+    }
+
+    AddInfo(MemoryBudget->GetStatsString());
+    FinishTest(true, "");
+    return true;
+}
+
+/// <summary>
+/// 同梱テストデータを複製したGMLを小さいメモリ予算でインポートし、
+/// インポート中に増えたプロセスのメモリ使用量のうち、インポート後に残らない分が予算以下であることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_MemoryBudget_Import, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.MemoryBudget.Import",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_MemoryBudget_Import::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_MemoryBudget_Local;
+    InitializeTest("MemoryBudget.Import");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const FString SourceDirectory = FPLATEAURuntimeModule::GetContentDir().Append("/TestData/data");
+    const FString DatasetDirectory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("PLATEAUMemoryBudget"));
+    IFileManager::Get().DeleteDirectory(*DatasetDirectory, false, true);
+    if (!CreateSyntheticDataset(SourceDirectory, DatasetDirectory)) {
+        FinishTest(false, "Failed to create dataset");
+        return true;
+    }
+
+    const auto& Loader = GetInstancedCityLoader(*GetWorld(), DatasetDirectory);
+    if (Loader == nullptr)
+        return false;
+
+    // 2つのGMLが同時に収まる程度のメモリ予算
+    const int64 EstimatedBytes = FPLATEAUMemoryBudget::EstimateGmlBytes(FPaths::Combine(DatasetDirectory, TEXT("udx/bldg/53392642_bldg_6697_00_op2.gml")));
+    const int32 BudgetMB = FMath::Max(1, static_cast<int32>(FMath::DivideAndRoundUp(EstimatedBytes * 2, MB)));
+    const int64 BudgetBytes = BudgetMB * MB;
+    Loader->ImportSettings->ImportMemoryBudgetMB = BudgetMB;
+    Loader->ImportSettings->ImportWorkerCount = NumWorkers;
+
+    const auto Sampler = MakeShared<FMemorySampler, ESPMode::ThreadSafe>();
+    const int64 StartUsedPhysical = GetUsedPhysicalMemory();
+    Sampler->Start();
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, Sampler, StartUsedPhysical, BudgetBytes, DatasetDirectory] {
+        if (Loader->Phase != ECityModelLoadingPhase::Cancelling && Loader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        Sampler->Stop();
+        const int64 PeakDeltaBytes = Sampler->PeakUsedPhysical.Load() - StartUsedPhysical;
+        const int64 RetainedBytes = GetUsedPhysicalMemory() - StartUsedPhysical;
+        const int64 TransientBytes = PeakDeltaBytes - RetainedBytes;
+        AddInfo(FString::Printf(TEXT("Used physical memory: peak +%.2f MB, retained +%.2f MB, transient %.2f MB / budget %.2f MB"),
+            PeakDeltaBytes / static_cast<double>(MB), RetainedBytes / static_cast<double>(MB),
+            TransientBytes / static_cast<double>(MB), BudgetBytes / static_cast<double>(MB)));
+        IFileManager::Get().DeleteDirectory(*DatasetDirectory, false, true);
+
+        if (Loader->Status.TotalGmlCount != SyntheticGmlCount) {
+            FinishTest(false, FString::Printf(TEXT("Imported GMLs: %d/%d"), Loader->Status.TotalGmlCount, SyntheticGmlCount));
+            return true;
+        }
+
+        int32 MeshCount = 0;
+        TArray<AActor*> CityModelActors;
+        UGameplayStatics::GetAllActorsOfClass(Loader->GetWorld(), APLATEAUInstancedCityModel::StaticClass(), CityModelActors);
+        for (const auto& CityModelActor : CityModelActors) {
+            TArray<UStaticMeshComponent*> StaticMeshComponents;
+            CityModelActor->GetComponents<UStaticMeshComponent>(StaticMeshComponents);
+            MeshCount += StaticMeshComponents.Num();
+        }
+        if (MeshCount <= 0) {
+            FinishTest(false, "MeshCount <= 0");
+            return true;
+        }
+
+        // パース結果など、インポート後に解放されるメモリが予算に収まっていること
+        if (TransientBytes > BudgetBytes) {
+            FinishTest(false, FString::Printf(TEXT("Transient memory exceeds budget: %lld > %lld"), TransientBytes, BudgetBytes));
+            return true;
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
@@ -0,0 +1,131 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestUtil.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "RoadNetwork/CityObject/SubDividedCityObject.h"
+#include "RoadNetwork/Factory/RoadNetworkFactory.h"
+#include "RoadNetwork/RGraph/RGraphFactory.h"
+#include "RoadNetwork/Structure/RnModel.h"
+
+namespace FPLATEAUTest_RoadNetworkUpdate_Local {
+    using namespace PLATEAUAutomationTestUtil::RoadNetwork;
+
+    constexpr int32 N = 6;
+    // Fixtures::CreateStaticMeshで作成される四角形の一辺の長さ
+    constexpr double QuadMeshSize = 200.0;
+
+    /// <summary>
+    /// 最小地物のメッシュと同じ範囲になるよう、碁盤目状の道路の地物をActorのコンポーネントとして登録
+    /// </summary>
+    void RegisterComponents(AActor& Actor, UStaticMesh* QuadMesh, const TArray<FSubDividedCityObject>& CityObjects) {
+        for (const auto& CityObject : CityObjects) {
+            const auto CityObjectGroup = CityObject.CityObjectGroup.Get();
+            const FBox Bounds(CityObject.Meshes[0].Vertices);
+            CityObjectGroup->SetMobility(EComponentMobility::Movable);
+            CityObjectGroup->SetStaticMesh(QuadMesh);
+            Actor.AddInstanceComponent(CityObjectGroup);
+            CityObjectGroup->AttachToComponent(Actor.GetRootComponent(), FAttachmentTransformRules::KeepWorldTransform);
+            CityObjectGroup->SetWorldTransform(FTransform(FQuat::Identity, Bounds.GetCenter(),
+                FVector(Bounds.GetSize().X / QuadMeshSize, Bounds.GetSize().Y / QuadMeshSize, 1.0)));
+            CityObjectGroup->RegisterComponent();
+        }
+    }
+
+    TArray<FRnModelSourceState> CreateSourceStates(const TArray<FSubDividedCityObject>& CityObjects) {
+        TArray<FRnModelSourceState> States;
+        for (const auto& CityObject : CityObjects)
+            States.Add(FRoadNetworkFactoryEx::CreateSourceState(CityObject.CityObjectGroup.Get()));
+        return States;
+    }
+
+    const FSubDividedCityObject& FindCityObject(const TArray<FSubDividedCityObject>& CityObjects, const FString& Name) {
+        return *CityObjects.FindByPredicate([&Name](const FSubDividedCityObject& CityObject) {
+            return CityObject.Name == Name;
+            });
+    }
+}
+
+/// <summary>
+/// 碁盤目状の道路の地物をコンポーネントとして登録して道路構造を生成し、
+/// 1つの地物のTransform、別の地物のメッシュを変更した時に、FRoadNetworkFactoryEx::CreateSourceStateとCreateUpdateRequestで
+/// その地物のみが変更として検出され、差分更新でその地物の周辺のみが作り直されることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_RoadNetworkUpdate, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.RoadNetworkUpdate",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_RoadNetworkUpdate::RunTest(const FString& Parameters) {
+    using namespace FPLATEAUTest_RoadNetworkUpdate_Local;
+    InitializeTest("RoadNetworkUpdate");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Actor = GetWorld()->SpawnActor<AActor>();
+    const auto SceneRoot = NewObject<USceneComponent>(Actor, USceneComponent::GetDefaultSceneRootVariableName());
+    Actor->AddInstanceComponent(SceneRoot);
+    Actor->SetRootComponent(SceneRoot);
+    SceneRoot->RegisterComponent();
+
+    const auto CityObjects = CreateGridCityObjects(*Actor, N);
+    RegisterComponents(*Actor, PLATEAUAutomationTestUtil::Fixtures::CreateStaticMesh(Actor, TEXT("QuadMesh")), CityObjects);
+
+    FRoadNetworkFactory Factory;
+    const auto Model = NewObject<URnModel>(Actor);
+    FRoadNetworkFactoryEx::CreateRnModel(Factory, FRGraphFactoryEx::CreateGraph(Factory.GraphFactory, CityObjects), Model);
+    auto States = CreateSourceStates(CityObjects);
+
+    // 変更が無い場合は何も作り直さない
+    if (FRoadNetworkFactoryEx::CreateUpdateRequest(States, CreateSourceStates(CityObjects)).ChangedBounds.Num() > 0) {
+        FinishTest(false, "Unchanged trans are detected as changed");
+        return true;
+    }
+
+    // Editedのみが変更として検出され、その周辺のみ作り直されること
+    const auto CheckUpdate = [this, &Factory, Model, &CityObjects, &States](const FSubDividedCityObject& Edited, const TCHAR* EditName) {
+        auto NewStates = CreateSourceStates(CityObjects);
+        const auto Request = FRoadNetworkFactoryEx::CreateUpdateRequest(States, NewStates);
+        States = MoveTemp(NewStates);
+        if (Request.ChangedTrans.Num() != 1 || !Request.ChangedTrans.Contains(Edited.CityObjectGroup.Get())) {
+            AddError(FString::Printf(TEXT("%s: %d trans are detected as changed"), EditName, Request.ChangedTrans.Num()));
+            return false;
+        }
+
+        int32 SubDividedCount = 0;
+        const auto Result = FRoadNetworkFactoryEx::UpdateRnModel(Factory, Model, Request
+            , [&CityObjects, &SubDividedCount](const TArray<UPLATEAUCityObjectGroup*>& Targets, TArray<FSubDividedCityObject>& OutCityObjects) {
+                for (const auto& CityObject : CityObjects) {
+                    if (Targets.Contains(CityObject.CityObjectGroup.Get()))
+                        OutCityObjects.Add(CityObject);
+                }
+                SubDividedCount = OutCityObjects.Num();
+            });
+        AddInfo(FString::Printf(TEXT("%s %s: %d rebuilt (+%d context) of %d trans, %d -> %d road bases, %.3f ms"),
+            EditName, *Edited.Name, Result.RegionTranCount, Result.ContextTranCount, CityObjects.Num(),
+            Result.RemovedRoadBaseCount, Result.AddedRoadBaseCount, Result.Seconds * 1000.0));
+
+        if (Result.ChangedTranCount != 1 || Result.RegionTranCount <= 0 || SubDividedCount >= CityObjects.Num()) {
+            AddError(FString::Printf(TEXT("%s: not only the edited tran is rebuilt (%d rebuilt, %d subdivided)"), EditName, Result.RegionTranCount, SubDividedCount));
+            return false;
+        }
+        if (!Result.bIsValid) {
+            AddError(FString::Printf(TEXT("%s: updated model is invalid"), EditName));
+            return false;
+        }
+        return true;
+    };
+
+    // Transformの変更
+    const auto& Moved = FindCityObject(CityObjects, FString::Printf(TEXT("tran_x_%d_%d"), N / 2, N / 2));
+    Moved.CityObjectGroup->AddWorldOffset(FVector(0.0, 0.0, 10.0));
+    const bool bMoveSucceeded = CheckUpdate(Moved, TEXT("transform"));
+
+    // メッシュの変更
+    const auto& Reshaped = FindCityObject(CityObjects, FString::Printf(TEXT("tran_y_%d_%d"), 1, N / 2));
+    Reshaped.CityObjectGroup->SetStaticMesh(PLATEAUAutomationTestUtil::Fixtures::CreateStaticMesh(Actor, TEXT("RaisedQuadMesh"), FVector3f(0.0f, 0.0f, 10.0f)));
+    const bool bReshapeSucceeded = CheckUpdate(Reshaped, TEXT("mesh"));
+
+    Actor->Destroy();
+    FinishTest(bMoveSucceeded && bReshapeSucceeded, "Only the edited tran should be rebuilt");
+    return true;
+}
@@ -0,0 +1,76 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "PLATEAUTextureCache.h"
+#include "Async/Async.h"
+
+/// <summary>
+/// デコード済み画像1枚分に満たない上限でテクスチャキャッシュを使用し、
+/// LRUから最も長く使われていない画像が破棄され、破棄された画像はミスとして再度デコードされること、
+/// 作成済みのテクスチャは以降のヒットとして使い回されることを確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_TextureCache, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.TextureCache",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_TextureCache::RunTest(const FString& Parameters) {
+    InitializeTest("TextureCache");
+
+    const FString AppearanceDirectory = FPLATEAURuntimeModule::GetContentDir().Append("/TestData/data/udx/bldg/53392642_bldg_6697_appearance");
+    TArray<FString> FileNames;
+    IFileManager::Get().FindFiles(FileNames, *AppearanceDirectory, TEXT("tif"));
+    TArray<FString> TexturePaths;
+    for (const auto& FileName : FileNames) {
+        TexturePaths.Add(FPaths::Combine(AppearanceDirectory, FileName));
+    }
+    if (TexturePaths.Num() < 2) {
+        FinishTest(false, "Test textures are not found");
+        return true;
+    }
+
+    const auto TextureCache = MakeShared<FPLATEAUTextureCache, ESPMode::ThreadSafe>(1, 2);
+    TextureCache->Prefetch(TexturePaths);
+    // 待機中のテクスチャは上限を超えてもデコードされ、それ以外の画像は破棄される
+    Async(EAsyncExecution::Thread, [TextureCache, TexturePaths] {
+        TextureCache->Wait(TexturePaths);
+    }).Wait();
+
+    if (TextureCache->GetEvictedCount() < TexturePaths.Num() - 1) {
+        FinishTest(false, FString::Printf(TEXT("Evicted: %lld/%d"), TextureCache->GetEvictedCount(), TexturePaths.Num() - 1));
+        return true;
+    }
+
+    TArray<UTexture2D*> Textures;
+    for (const auto& TexturePath : TexturePaths) {
+        bool bCreated = false;
+        Textures.Add(TextureCache->FindOrCreateTexture(TexturePath, false, bCreated));
+        if (Textures.Last() == nullptr) {
+            FinishTest(false, FString::Printf(TEXT("Failed to create texture: %s"), *TexturePath));
+            return true;
+        }
+    }
+
+    // LRUに残っているのは最後にデコードした1枚のみ
+    if (TextureCache->GetMissCount() < TexturePaths.Num() - 1) {
+        FinishTest(false, FString::Printf(TEXT("Miss: %lld/%d"), TextureCache->GetMissCount(), TexturePaths.Num() - 1));
+        return true;
+    }
+
+    // 作成済みのテクスチャはデコードせずに使い回す
+    const int64 HitCountBefore = TextureCache->GetHitCount();
+    for (int32 i = 0; i < TexturePaths.Num(); ++i) {
+        bool bCreated = false;
+        if (TextureCache->FindOrCreateTexture(TexturePaths[i], false, bCreated) != Textures[i] || bCreated) {
+            FinishTest(false, FString::Printf(TEXT("Created texture is not reused: %s"), *TexturePaths[i]));
+            return true;
+        }
+    }
+    if (TextureCache->GetHitCount() - HitCountBefore != TexturePaths.Num()) {
+        FinishTest(false, FString::Printf(TEXT("Hit: %lld/%d"), TextureCache->GetHitCount() - HitCountBefore, TexturePaths.Num()));
+        return true;
+    }
+
+    AddInfo(TextureCache->GetStatsString());
+    FinishTest(true, "");
+    return true;
+}
@@ -0,0 +1,75 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTests/Tests/PLATEAUAutomationTestBase.h"
+#include "Util/PLATEAUTextureUtil.h"
+
+/// <summary>
+/// ミップ生成とBC1/BC3圧縮の結果を確認します。
+/// </summary>
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_TextureUtil, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.TextureUtil",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_TextureUtil::RunTest(const FString& Parameters) {
+    InitializeTest("TextureUtil");
+
+    // 左半分が黒、右半分が白の8x6画像
+    constexpr int32 Width = 8;
+    constexpr int32 Height = 6;
+    TArray64<uint8> Mip0;
+    Mip0.SetNumUninitialized(Width * Height * 4);
+    for (int32 Y = 0; Y < Height; ++Y) {
+        for (int32 X = 0; X < Width; ++X) {
+            const uint8 Value = X < Width / 2 ? 0 : 255;
+            uint8* Pixel = &Mip0[(Y * Width + X) * 4];
+            Pixel[0] = Pixel[1] = Pixel[2] = Value;
+            Pixel[3] = 255;
+        }
+    }
+
+    TArray<TArray64<uint8>> MipChain;
+    FPLATEAUTextureUtil::BuildMipChain(Mip0, Width, Height, MipChain);
+    // 4x3, 2x1, 1x1
+    if (MipChain.Num() != 3 || MipChain[0].Num() != 4 * 3 * 4 || MipChain.Last().Num() != 4) {
+        FinishTest(false, FString::Printf(TEXT("Unexpected mip chain. Num: %d"), MipChain.Num()));
+        return true;
+    }
+
+    // 1x1は黒と白の平均
+    const uint8 Average = MipChain.Last()[0];
+    if (Average < 127 || Average > 128 || MipChain.Last()[3] != 255) {
+        FinishTest(false, FString::Printf(TEXT("Unexpected 1x1 mip value: %d"), Average));
+        return true;
+    }
+
+    if (FPLATEAUTextureUtil::HasTransparentPixel(Mip0)) {
+        FinishTest(false, "Opaque image is detected as transparent");
+        return true;
+    }
+
+    TArray64<uint8> Blocks;
+    FPLATEAUTextureUtil::CompressBC(Mip0.GetData(), Width, Height, false, Blocks);
+    // 2x2ブロック
+    if (Blocks.Num() != 2 * 2 * 8) {
+        FinishTest(false, FString::Printf(TEXT("BC1 size: %lld"), Blocks.Num()));
+        return true;
+    }
+
+    // 左上のブロックは黒一色のため、端点は同じ色となる
+    const uint16 Color0 = Blocks[0] | (Blocks[1] << 8);
+    const uint16 Color1 = Blocks[2] | (Blocks[3] << 8);
+    if (Color0 != 0 || Color1 != 0) {
+        FinishTest(false, FString::Printf(TEXT("BC1 endpoints of black block: %04x %04x"), Color0, Color1));
+        return true;
+    }
+
+    FPLATEAUTextureUtil::CompressBC(Mip0.GetData(), Width, Height, true, Blocks);
+    // アルファブロックは不透明一色
+    if (Blocks.Num() != 2 * 2 * 16 || Blocks[0] != 255 || Blocks[1] != 255) {
+        FinishTest(false, "Unexpected BC3 alpha block");
+        return true;
+    }
+
+    FinishTest(true, "");
+    return true;
+}
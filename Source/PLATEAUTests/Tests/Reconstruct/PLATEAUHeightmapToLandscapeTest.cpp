@@ -96,7 +96,7 @@ bool FPLATEAUTest_Heightmap_LandscapeMesh::RunTest(const FString& Parameters) {
     //Created Terrain Mesh
     auto MeshComponent = (UPLATEAUCityObjectGroup*)*MeshComponentPtr; 
 
-    TestEqual("Attr are the same ", MeshComponent->SerializedCityObjects, OriginalItem->SerializedCityObjects);
+    TestEqual("Attr are the same ", MeshComponent->GetSerializedCityObjectsJson(), OriginalItem->GetSerializedCityObjectsJson());
 
     // Static Mesh　生成まで待機
     ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, MeshComponent, OriginalItem] {
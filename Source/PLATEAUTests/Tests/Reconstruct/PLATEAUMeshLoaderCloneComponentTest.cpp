@@ -81,7 +81,7 @@ bool FPLATEAUTest_MeshLoader_CloneComponent::RunTest(const FString& Parameters)
                 TestEqual("Vertex sizes are the same as Models", CityObjGrp->GetStaticMesh()->GetNumVertices(0), NumIndices);
                 TestEqual("Material is same as original", CityObjGrp->GetMaterial(0), OriginalItem->GetMaterial(0));
 
-                TestEqual("Json is same as original", CityObjGrp->SerializedCityObjects, OriginalItem->SerializedCityObjects);
+                TestEqual("Json is same as original", CityObjGrp->GetSerializedCityObjectsJson(), OriginalItem->GetSerializedCityObjectsJson());
                 TestEqual("Granularity is same as LoadInputData", CityObjGrp->GetConvertGranularity(), ConvertGranularity::PerPrimaryFeatureObject);
                 AddInfo(FString::Format(TEXT("MeshGranularity: {0}"), { CityObjGrp->MeshGranularityIntValue }));
                 AddInfo("StaticMesh Test Finished.");